@@ -1,8 +1,11 @@
 import abc
+import ctypes
+import errno
 import logging
 import os
 import random
 import shutil
+import sys
 import time
 import urllib
 import uuid
@@ -69,6 +72,39 @@ def parse_url_with_offset(url_with_offset: str) -> Tuple[str, int, int]:
     return ParsedURL(base_url=base_url, offset=offset, size=size)
 
 
+# fallocate(2) flags to release a byte range without changing the file size.
+_FALLOC_FL_KEEP_SIZE = 0x01
+_FALLOC_FL_PUNCH_HOLE = 0x02
+_libc = None
+
+
+def _punch_hole(path: str, offset: int, size: int):
+    """Release the disk space of a byte range of a file.
+
+    The range reads back as zeros afterwards. This is a no-op on platforms
+    other than Linux.
+    """
+    global _libc
+    if not sys.platform.startswith("linux"):
+        return
+    if _libc is None:
+        _libc = ctypes.CDLL(None, use_errno=True)
+        _libc.fallocate.argtypes = [
+            ctypes.c_int,
+            ctypes.c_int,
+            ctypes.c_longlong,
+            ctypes.c_longlong,
+        ]
+    fd = os.open(path, os.O_WRONLY)
+    try:
+        mode = _FALLOC_FL_PUNCH_HOLE | _FALLOC_FL_KEEP_SIZE
+        if _libc.fallocate(fd, mode, offset, size) != 0:
+            err = ctypes.get_errno()
+            raise OSError(err, os.strerror(err), path)
+    finally:
+        os.close(fd)
+
+
 class ExternalStorage(metaclass=abc.ABCMeta):
     """The base class for external storage.
 
@@ -218,6 +254,17 @@ class ExternalStorage(metaclass=abc.ABCMeta):
         do not exist.
         """
 
+    def reclaim_spilled_objects(self, urls: List[str]):
+        """Release the space of freed objects in files that still hold
+        other objects.
+
+        Args:
+            urls: URLs with offsets of the freed objects.
+
+        NOTE: This is best effort. Storages that cannot release part of a
+        file keep the space until the whole file is deleted.
+        """
+
     @abc.abstractmethod
     def destroy_external_storage(self):
         """Destroy external storage when a head node is down.
@@ -340,6 +387,22 @@ class FileSystemStorage(ExternalStorage):
                 # Occurs when the urls are retried during worker crash/failure.
                 pass
 
+    def reclaim_spilled_objects(self, urls: List[str]):
+        for url in urls:
+            parsed_result = parse_url_with_offset(url.decode())
+            try:
+                _punch_hole(
+                    parsed_result.base_url, parsed_result.offset, parsed_result.size
+                )
+            except FileNotFoundError:
+                # The file was deleted after its last object was freed.
+                pass
+            except OSError as e:
+                if e.errno != errno.EOPNOTSUPP:
+                    raise
+                # The filesystem cannot release part of a file.
+                return
+
     def destroy_external_storage(self):
         for directory_path in self._directory_paths:
             self._destroy_external_storage(directory_path)
@@ -689,6 +752,16 @@ def delete_spilled_objects(urls: List[str]):
     _external_storage.delete_spilled_objects(urls)
 
 
+def reclaim_spilled_objects(urls: List[str]):
+    """Release the space of freed objects in spill files that still hold
+    other objects.
+
+    Args:
+        urls: URLs with offsets of the freed objects.
+    """
+    _external_storage.reclaim_spilled_objects(urls)
+
+
 def _get_unique_spill_filename(object_refs: List[ObjectRef]):
     """Generate a unqiue spill file name.
 
@@ -144,6 +144,12 @@ parser.add_argument(
     required=False,
     help="The address of web ui",
 )
+parser.add_argument(
+    "--zygote-socket",
+    required=False,
+    default=None,
+    help="If set, start as a zygote which forks workers on requests to this socket.",
+)
 
 
 if __name__ == "__main__":
@@ -152,6 +158,11 @@ if __name__ == "__main__":
     # as a step function. For more details, check out
     # https://github.com/ray-project/ray/pull/12225#issue-525059663.
     args = parser.parse_args()
+    if args.zygote_socket:
+        # Only returns in the forked workers, with their own arguments.
+        from ray._private.workers import zygote
+
+        args = parser.parse_args(zygote.serve(args.zygote_socket))
     ray._private.ray_logging.setup_logger(args.logging_level, args.logging_format)
 
     if args.worker_type == "WORKER":
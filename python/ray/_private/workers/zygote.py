@@ -0,0 +1,118 @@
+"""A fork server for Python workers.
+
+The raylet starts `default_worker.py` with `--zygote-socket=<path>` to create a
+zygote. The zygote has imported Ray but doesn't connect to the cluster. It listens
+on the socket and forks a child per request. The child returns from `serve` with the
+requested command line arguments and environment, and continues to start as a
+normal worker. The zygote exits when the raylet closes the control connection or
+dies.
+
+See `src/ray/raylet/worker_zygote.h` for the request format.
+"""
+
+import logging
+import os
+import select
+import signal
+import socket
+import struct
+import sys
+from typing import List, Tuple
+
+import ray._private.utils
+
+logger = logging.getLogger(__name__)
+
+# The types of the connections from the raylet.
+_FORK_REQUEST = 0
+_CONTROL_CONNECTION = 1
+
+
+def _recv_exactly(conn: socket.socket, size: int) -> bytes:
+    data = bytearray()
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("The raylet closed the zygote connection.")
+        data.extend(chunk)
+    return bytes(data)
+
+
+def _recv_uint32(conn: socket.socket) -> int:
+    return struct.unpack("<I", _recv_exactly(conn, 4))[0]
+
+
+def _recv_string(conn: socket.socket) -> str:
+    return _recv_exactly(conn, _recv_uint32(conn)).decode()
+
+
+def _recv_request(conn: socket.socket) -> Tuple[List[str], dict]:
+    args = [_recv_string(conn) for _ in range(_recv_uint32(conn))]
+    env = {}
+    for _ in range(_recv_uint32(conn)):
+        key = _recv_string(conn)
+        env[key] = _recv_string(conn)
+    return args, env
+
+
+def serve(socket_path: str) -> List[str]:
+    """Serve fork requests on the socket until the raylet goes away.
+
+    Returns:
+        The command line arguments of the worker, after the worker script. It only
+        returns in the forked children.
+    """
+    # Exit with the raylet, including before it opens the control connection.
+    if ray._private.utils.detect_fate_sharing_support_linux():
+        ray._private.utils.set_kill_on_parent_death_linux()
+    # Let the children be reaped automatically. They are monitored by the raylet.
+    signal.signal(signal.SIGCHLD, signal.SIG_IGN)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    server.bind(socket_path)
+    server.listen(128)
+    logger.info(f"Worker zygote is listening on {socket_path}.")
+    control = None
+    while True:
+        readable = [server] if control is None else [server, control]
+        ready, _, _ = select.select(readable, [], [])
+        if control is not None and control in ready:
+            # The raylet never sends anything on the control connection, so it's
+            # readable only when the raylet closed it.
+            logger.info("The raylet closed the control connection, exiting.")
+            sys.exit(0)
+        if server not in ready:
+            continue
+        conn, _ = server.accept()
+        try:
+            connection_type = _recv_uint32(conn)
+            if connection_type == _CONTROL_CONNECTION:
+                if control is not None:
+                    control.close()
+                control = conn
+                continue
+            if connection_type != _FORK_REQUEST:
+                raise ValueError(f"Unknown connection type {connection_type}.")
+            args, env = _recv_request(conn)
+        except Exception:
+            logger.exception("Failed to read a fork request.")
+            conn.close()
+            continue
+        pid = os.fork()
+        if pid == 0:
+            conn.close()
+            server.close()
+            if control is not None:
+                control.close()
+            signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+            # The request carries the complete environment of the worker. Don't keep
+            # the variables the zygote itself was started with.
+            os.environ.clear()
+            os.environ.update(env)
+            # The arguments start with the interpreter and the worker script.
+            return args[args.index(sys.argv[0]) + 1 :]
+        try:
+            conn.sendall(struct.pack("<i", pid))
+        except OSError:
+            logger.exception(f"Failed to reply the pid of worker {pid}.")
+        finally:
+            conn.close()
@@ -1378,6 +1378,22 @@ cdef void delete_spilled_objects_handler(
                 job_id=None)
 
 
+cdef void reclaim_spilled_objects_handler(
+        const c_vector[c_string]& object_urls) nogil:
+    with gil:
+        urls = []
+        size = object_urls.size()
+        for i in range(size):
+            urls.append(object_urls[i])
+        try:
+            external_storage.reclaim_spilled_objects(urls)
+        except Exception:
+            # The space is released anyway once the whole file is deleted.
+            logger.exception(
+                "An unexpected internal error occurred while the IO worker "
+                "was reclaiming the space of spilled objects.")
+
+
 cdef void unhandled_exception_handler(const CRayObject& error) nogil:
     with gil:
         worker = ray._private.worker.global_worker
@@ -1542,6 +1558,7 @@ cdef class CoreWorker:
         options.spill_objects = spill_objects_handler
         options.restore_spilled_objects = restore_spilled_objects_handler
         options.delete_spilled_objects = delete_spilled_objects_handler
+        options.reclaim_spilled_objects = reclaim_spilled_objects_handler
         options.unhandled_exception_handler = unhandled_exception_handler
         options.get_lang_stack = get_py_stack
         options.is_local_mode = local_mode
@@ -308,6 +308,8 @@ cdef extern from "ray/core_worker/core_worker.h" nogil:
         (void(
             const c_vector[c_string]&,
             CWorkerType) nogil) delete_spilled_objects
+        (void(
+            const c_vector[c_string]&) nogil) reclaim_spilled_objects
         (void(
             const c_string&,
             const c_vector[c_string]&) nogil) run_on_util_worker_handler
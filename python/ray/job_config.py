@@ -20,6 +20,9 @@ class JobConfig:
         default_actor_lifetime: The default value of actor lifetime.
         py_driver_sys_path: A list of directories that
             specify the search path for python workers.
+        task_events_sampling_rate: The fraction of the tasks of the job whose
+            task events (states and profiling) are recorded, from 0 to 1. If
+            not set, the cluster wide ``RAY_task_events_sampling_rate`` applies.
     """
 
     def __init__(
@@ -32,6 +35,7 @@ class JobConfig:
         ray_namespace: Optional[str] = None,
         default_actor_lifetime: str = "non_detached",
         py_driver_sys_path: List[str] = None,
+        task_events_sampling_rate: Optional[float] = None,
     ):
         self.jvm_options = jvm_options or []
         self.code_search_path = code_search_path or []
@@ -46,6 +50,14 @@ class JobConfig:
         self.set_runtime_env(runtime_env)
         self.set_default_actor_lifetime(default_actor_lifetime)
         self.py_driver_sys_path = py_driver_sys_path or []
+        if task_events_sampling_rate is not None and not (
+            0 <= task_events_sampling_rate <= 1
+        ):
+            raise ValueError(
+                "task_events_sampling_rate must be between 0 and 1, got "
+                f"{task_events_sampling_rate}"
+            )
+        self.task_events_sampling_rate = task_events_sampling_rate
 
     def set_metadata(self, key: str, value: str) -> None:
         self.metadata[key] = value
@@ -127,6 +139,8 @@ class JobConfig:
 
             if self._default_actor_lifetime is not None:
                 pb.default_actor_lifetime = self._default_actor_lifetime
+            if self.task_events_sampling_rate is not None:
+                pb.task_events_sampling_rate = self.task_events_sampling_rate
             self._cached_pb = pb
 
         return self._cached_pb
@@ -155,4 +169,7 @@ class JobConfig:
             metadata=job_config_json.get("metadata", None),
             ray_namespace=job_config_json.get("ray_namespace", None),
             py_driver_sys_path=job_config_json.get("py_driver_sys_path", None),
+            task_events_sampling_rate=job_config_json.get(
+                "task_events_sampling_rate", None
+            ),
         )
@@ -0,0 +1,70 @@
+"""Benchmark the worker startup with and without the worker zygote.
+
+It measures the time to the first task on a fresh node, and the number of workers
+started per second when a burst of actors is created.
+
+    python test_worker_startup.py --num-actors=200
+"""
+import json
+import os
+import time
+
+import click
+import ray
+
+
+@ray.remote(num_cpus=0)
+class Actor:
+    def ready(self):
+        return os.getpid()
+
+
+@ray.remote(num_cpus=0)
+def task():
+    return os.getpid()
+
+
+def run(zygote: bool, num_actors: int) -> dict:
+    ray.init(
+        _system_config={
+            "worker_zygote_enabled": zygote,
+            "enable_worker_prestart": False,
+        }
+    )
+    try:
+        start = time.time()
+        ray.get(task.remote())
+        time_to_first_task = time.time() - start
+
+        # Give the zygote some time to finish loading, so that the burst below is
+        # served by it.
+        time.sleep(5)
+
+        start = time.time()
+        actors = [Actor.remote() for _ in range(num_actors)]
+        ray.get([actor.ready.remote() for actor in actors])
+        workers_per_second = num_actors / (time.time() - start)
+    finally:
+        ray.shutdown()
+    return {
+        "time_to_first_task_s": time_to_first_task,
+        "workers_per_second": workers_per_second,
+    }
+
+
+@click.command()
+@click.option("--num-actors", type=int, default=200, help="Number of actors to start.")
+def main(num_actors):
+    results = {}
+    for zygote in [False, True]:
+        name = "zygote" if zygote else "no_zygote"
+        results[name] = run(zygote, num_actors)
+        print(f"{name}: {results[name]}")
+
+    if "TEST_OUTPUT_JSON" in os.environ:
+        with open(os.environ["TEST_OUTPUT_JSON"], "w") as out_file:
+            json.dump(results, out_file)
+
+
+if __name__ == "__main__":
+    main()
@@ -45,6 +45,11 @@ class MockLeasePolicyInterface : public LeasePolicyInterface {
               GetBestNodeForTask,
               (const TaskSpecification &spec),
               (override));
+  MOCK_METHOD(void,
+              OnTaskPushed,
+              (const TaskSpecification &spec, const NodeID &node_id),
+              (override));
+  MOCK_METHOD(void, OnTaskFinished, (const TaskID &task_id), (override));
 };
 
 }  // namespace core
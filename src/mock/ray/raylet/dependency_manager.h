@@ -23,6 +23,16 @@ class MockTaskDependencyManagerInterface : public TaskDependencyManagerInterface
                const std::vector<rpc::ObjectReference> &required_objects),
               (override));
   MOCK_METHOD(void, RemoveTaskDependencies, (const TaskID &task_id), (override));
+  MOCK_METHOD(void,
+              PrefetchTaskDependencies,
+              (const TaskID &task_id,
+               const std::vector<rpc::ObjectReference> &required_objects,
+               const TaskMetricsKey &task_key),
+              (override));
+  MOCK_METHOD(void,
+              CancelPrefetchTaskDependencies,
+              (const TaskID &task_id),
+              (override));
   MOCK_METHOD(bool, TaskDependenciesBlocked, (const TaskID &task_id), (const, override));
   MOCK_METHOD(bool, CheckObjectLocal, (const ObjectID &object_id), (const, override));
 };
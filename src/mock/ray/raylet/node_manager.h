@@ -69,6 +69,12 @@ class MockNodeManager : public NodeManager {
                rpc::RequestWorkerLeaseReply *reply,
                rpc::SendReplyCallback send_reply_callback),
               (override));
+  MOCK_METHOD(void,
+              HandleRequestWorkerLeases,
+              (rpc::RequestWorkerLeasesRequest request,
+               rpc::RequestWorkerLeasesReply *reply,
+               rpc::SendReplyCallback send_reply_callback),
+              (override));
   MOCK_METHOD(void,
               HandleReportWorkerBacklog,
               (rpc::ReportWorkerBacklogRequest request,
@@ -52,6 +52,13 @@ class MockClusterTaskManagerInterface : public ClusterTaskManagerInterface {
                rpc::RequestWorkerLeaseReply *reply,
                rpc::SendReplyCallback send_reply_callback),
               (override));
+  MOCK_METHOD(void,
+              QueueAndScheduleTasks,
+              (const std::vector<RayTask> &tasks,
+               bool is_selected_based_on_locality,
+               const std::vector<rpc::RequestWorkerLeaseReply *> &replies,
+               const std::vector<rpc::SendReplyCallback> &send_reply_callbacks),
+              (override));
   MOCK_METHOD(bool,
               AnyPendingTasksForResourceAcquisition,
               (RayTask * exemplar,
@@ -160,9 +160,16 @@ RAY_CONFIG(int64_t, reconstruct_objects_period_milliseconds, 100)
 /// If we reach this limit, 50% of the current lineage will be evicted and
 /// objects that are still in scope will no longer be reconstructed if lost.
 /// Each task spec is on the order of 1KB but can be much larger if it has many
-/// inlined args.
+/// inlined args. The specs are counted at their full serialized size, even though
+/// the fields they have in common are only kept in memory once.
 RAY_CONFIG(int64_t, max_lineage_bytes, 1024 * 1024 * 1024)
 
+/// If not empty, the directory to offload lineage to instead of evicting it when
+/// max_lineage_bytes is reached. The oldest lineage is appended to a file per
+/// worker in this directory, and is only read back to reconstruct objects.
+/// Offloaded lineage no longer counts toward max_lineage_bytes.
+RAY_CONFIG(std::string, lineage_offload_dir, "")
+
 /// Whether to re-populate plasma memory. This avoids memory allocation failures
 /// at runtime (SIGBUS errors creating new objects), however it will use more memory
 /// upfront and can slow down Ray startup.
@@ -290,6 +297,22 @@ RAY_CONFIG(int64_t, kill_worker_timeout_milliseconds, 100)
 /// starting_worker_timeout_callback() is called.
 RAY_CONFIG(int64_t, worker_register_timeout_seconds, 60)
 
+/// The number of times in a row that the raylet may fail to start a worker for a
+/// scheduling class, e.g. because the worker command can't be executed, before it
+/// fails the tasks of that class as unschedulable instead of retrying them.
+RAY_CONFIG(int64_t, worker_start_max_failures, 10)
+
+/// Whether to fork Python workers from a pre-initialized zygote process instead of
+/// starting them from scratch. A zygote is started per runtime env hash on the first
+/// worker start, and only workers without runtime env context are forked from it.
+/// NOTE: POSIX only.
+RAY_CONFIG(bool, worker_zygote_enabled, false)
+
+/// How long to wait for a worker zygote to reply to a fork request. The raylet
+/// starts the worker from scratch if the zygote doesn't reply in time, and kills the
+/// zygote.
+RAY_CONFIG(int64_t, worker_zygote_fork_timeout_ms, 1000)
+
 /// The maximum number of workers to iterate whenever we analyze the resources usage.
 RAY_CONFIG(uint32_t, worker_max_resource_analysis_iteration, 128)
 
@@ -342,6 +365,13 @@ RAY_CONFIG(uint32_t, maximum_gcs_deletion_batch_size, 1000)
 /// Maximum number of items in one batch to scan/get/delete from GCS storage.
 RAY_CONFIG(uint32_t, maximum_gcs_storage_operation_batch_size, 1000)
 
+/// The flush window of the write-behind batching in the redis store client, in
+/// milliseconds. Puts and deletes issued within a window are merged per key and
+/// sent to redis as one batch command per shard. 0 means flushing at the end of the
+/// current event loop iteration and a negative value disables the batching, so
+/// every write is sent to redis right away.
+RAY_CONFIG(int64_t, gcs_redis_write_batch_window_ms, -1)
+
 /// When getting objects from object store, max number of ids to print in the warning
 /// message.
 RAY_CONFIG(uint32_t, object_store_get_max_ids_to_print_in_warning, 20)
@@ -349,6 +379,11 @@ RAY_CONFIG(uint32_t, object_store_get_max_ids_to_print_in_warning, 20)
 RAY_CONFIG(uint32_t,
            gcs_server_rpc_server_thread_num,
            std::max(1U, std::thread::hardware_concurrency() / 4U))
+/// Number of threads that run the object location and pubsub long polling handlers of
+/// the core worker. If 0, they run on the main io service of the core worker.
+RAY_CONFIG(uint32_t, core_worker_object_info_threads, 0)
+/// Number of threads that run the pubsub handlers in gcs server.
+RAY_CONFIG(uint32_t, gcs_server_pubsub_thread_num, 1)
 /// Number of threads used by rpc server in gcs server.
 RAY_CONFIG(uint32_t,
            gcs_server_rpc_client_thread_num,
@@ -377,12 +412,62 @@ RAY_CONFIG(uint32_t, maximum_gcs_dead_node_cached_count, 1000)
 RAY_CONFIG(int, gcs_resource_report_poll_period_ms, 100)
 // The number of concurrent polls to polls to GCS.
 RAY_CONFIG(uint64_t, gcs_max_concurrent_resource_pulls, 100)
-// The storage backend to use for the GCS. It can be either 'redis' or 'memory'.
+// The storage backend to use for the GCS. It can be 'redis', 'memory' or 'file'.
 RAY_CONFIG(std::string, gcs_storage, "memory")
+/// The directory where the GCS persists its tables when `gcs_storage` is 'file'.
+RAY_CONFIG(std::string, gcs_file_storage_dir, "")
+/// The size of the write log after which the file storage writes a new snapshot and
+/// truncates the log.
+RAY_CONFIG(int64_t, gcs_file_storage_compaction_threshold_bytes, 256 * 1024 * 1024)
+/// Whether the file storage fsyncs the write log after every group of writes, before
+/// their callbacks are called. If false, writes survive GCS process failures but may
+/// be lost on machine failures.
+RAY_CONFIG(bool, gcs_file_storage_fsync, false)
+/// The number of threads to parse the GCS tables on when the GCS server starts. If 0,
+/// the tables are parsed in the storage callbacks.
+RAY_CONFIG(int64_t, gcs_init_data_load_threads, 4)
+/// The maximum number of pages of a GCS table that are queued or being parsed on those
+/// threads. The pages read past that are parsed in the storage callbacks, so that the
+/// raw pages don't pile up in memory when reading is faster than parsing.
+RAY_CONFIG(int64_t, gcs_init_data_max_pages_in_flight, 16)
 
 /// Duration to sleep after failing to put an object in plasma because it is full.
 RAY_CONFIG(uint32_t, object_store_full_delay_ms, 10)
 
+/// The number of threads that serve the plasma store clients: they read the requests
+/// and send the replies, and share the object store state. If 1, the clients are
+/// served on the plasma store thread.
+RAY_CONFIG(uint32_t, plasma_store_num_client_threads, 1)
+
+/// The number of slots of the shared memory index of sealed objects that the plasma
+/// store publishes, so that its clients get and release the objects in use without
+/// sending messages to the store. 0 disables the index.
+RAY_CONFIG(int64_t, plasma_object_index_num_slots, 0)
+
+/// Whether the plasma store allocates objects with size classes for small objects and
+/// coalesced extents for large ones, instead of dlmalloc. This resists the
+/// fragmentation that makes large objects fall back to disk while there is free memory.
+RAY_CONFIG(bool, plasma_size_class_allocator_enabled, false)
+
+/// The bytes per second that the plasma store copies in the background to move the
+/// objects no client uses toward the start of its memory, which coalesces the free
+/// space left between them. It's copied in slices every 100ms, and the objects larger
+/// than a slice are never moved. 0 disables the compaction.
+RAY_CONFIG(int64_t, plasma_compaction_bandwidth_bytes_per_s, 0)
+
+/// The bytes of the fallback tier of the plasma store, in the fallback directory,
+/// which should be on a local NVMe drive. When the memory is full, the objects no
+/// client uses are demoted to this tier instead of being evicted, and the ones that
+/// get used again are promoted back. 0 disables the tier.
+RAY_CONFIG(int64_t, plasma_fallback_tier_bytes, 0)
+
+/// The most bytes that the plasma store copies between its memory and the fallback
+/// tier at a time, since it holds its lock while copying. When making space, the
+/// objects past this budget are evicted instead of demoted. Promotions are done in
+/// the background within this budget every 100ms, and larger objects stay in the
+/// fallback tier.
+RAY_CONFIG(int64_t, plasma_fallback_tier_max_move_bytes, 64 * 1024 * 1024)
+
 /// The threshold to trigger a global gc
 RAY_CONFIG(double, high_plasma_storage_usage, 0.7)
 
@@ -450,6 +535,18 @@ RAY_CONFIG(int64_t, ray_syncer_message_refresh_interval_ms, 3000)
 /// requests can run in flight for syncing.
 RAY_CONFIG(int64_t, ray_syncer_polling_buffer, 5)
 
+/// The fan-out of the ray syncer aggregation tree. When it's at least 2, raylets
+/// are arranged in a tree where only a few raylets sync with the GCS and every other
+/// raylet syncs with a parent raylet, which relays the messages of its subtree. See
+/// syncer::GetAggregationUpstream. 0 means every raylet syncs with the GCS directly.
+RAY_CONFIG(int64_t, ray_syncer_aggregation_fanout, 0)
+
+/// The max number of sync messages merged into one write on a ray syncer
+/// connection. Messages are merged when they pile up while a write is in flight,
+/// which is the common case for relays in the aggregation tree. 1 means that
+/// every message is sent with its own write.
+RAY_CONFIG(int64_t, ray_syncer_max_batch_size, 1)
+
 /// The interval at which the gcs client will check if the address of gcs service has
 /// changed. When the address changed, we will resubscribe again.
 RAY_CONFIG(uint64_t, gcs_service_address_check_interval_milliseconds, 1000)
@@ -482,6 +579,12 @@ RAY_CONFIG(uint64_t, task_events_send_batch_size, 10 * 1000)
 /// Setting the value to -1 allows unlimited profile events to be sent.
 RAY_CONFIG(int64_t, task_events_max_num_profile_events_for_task, 100)
 
+/// The fraction of tasks whose events are recorded, from 0 to 1. Whether a task is
+/// sampled depends on its task id only, so that either all or none of its events are
+/// recorded. Jobs can override it with the `task_events_sampling_rate` of their job
+/// config.
+RAY_CONFIG(double, task_events_sampling_rate, 1.0)
+
 /// The delay in ms that GCS should mark any running tasks from a job as failed.
 /// Setting this value too smaller might result in some finished tasks marked as failed by
 /// GCS.
@@ -498,6 +601,18 @@ RAY_CONFIG(int64_t, task_rpc_inlined_bytes_limit, 10 * 1024 * 1024)
 /// the cluster.
 RAY_CONFIG(int64_t, max_pending_lease_requests_per_scheduling_category, -1)
 
+/// Maximum number of workers a worker asks the raylet for in a single lease request,
+/// when it has that many queued tasks of the same scheduling class. The pending
+/// request limit above applies to requests, not workers. 1 means one worker per
+/// request.
+RAY_CONFIG(int64_t, max_leases_per_request, 1)
+
+/// The leases of a multi-lease request that the raylet can't grant right away are
+/// rejected. The worker waits before it asks for them again, starting with the
+/// initial delay and doubling it on each rejection in a row, up to the maximum.
+RAY_CONFIG(uint64_t, lease_rejection_retry_initial_delay_ms, 10)
+RAY_CONFIG(uint64_t, lease_rejection_retry_max_delay_ms, 1000)
+
 /// Wait timeout for dashboard agent register.
 #ifdef _WIN32
 // agent startup time can involve creating conda environments
@@ -575,15 +690,38 @@ RAY_CONFIG(float, object_spilling_threshold, 0.8)
 /// Maximum number of objects that can be fused into a single file.
 RAY_CONFIG(int64_t, max_fused_object_count, 2000)
 
+/// Whether to fuse objects with the same owner and a similar size into the same
+/// spill file, so that the file can be deleted once they go out of scope together.
+RAY_CONFIG(bool, object_spilling_fuse_by_locality, true)
+
+/// Once the in-scope bytes of a local spill file drop below this fraction of the
+/// file, the space of its freed objects is released without waiting for the
+/// whole file to be deleted. Set to 0 to disable.
+RAY_CONFIG(float, spilled_file_reclaim_threshold, 0.5)
+
 /// Grace period until we throw the OOM error to the application in seconds.
 /// In unlimited allocation mode, this is the time delay prior to fallback allocating.
 RAY_CONFIG(int64_t, oom_grace_period_s, 2)
 
+/// How long the plasma store may hold the creation of a task's return object while
+/// it waits for space, before creating it with the fallback allocator even within the
+/// OOM grace period. The worker that returns it holds its resources meanwhile.
+/// -1 means no deadline.
+RAY_CONFIG(int64_t, task_return_create_deadline_ms, -1)
+
 /// Whether or not the external storage is the local file system.
 /// Note that this value should be overridden based on the storage type
 /// specified by object_spilling_config.
 RAY_CONFIG(bool, is_external_storage_type_fs, true)
 
+/// Whether the object manager restores objects spilled to the local file system
+/// by streaming their chunks into the object store, instead of through an IO worker.
+RAY_CONFIG(bool, restore_spilled_objects_from_local_disk, true)
+
+/// The number of chunks to read ahead when reading a spilled object from the
+/// local file system, to push it or restore it. Set to 0 to disable.
+RAY_CONFIG(uint64_t, spilled_object_readahead_chunks, 4)
+
 /// Control the capacity threshold for ray local file system (for object store).
 /// Once we are over the capacity, all subsequent object creation will fail.
 RAY_CONFIG(float, local_fs_capacity_threshold, 0.95)
@@ -596,6 +734,20 @@ RAY_CONFIG(uint64_t, local_fs_monitor_interval_ms, 100)
 /// dependency locality when choosing a worker for leasing.
 RAY_CONFIG(bool, locality_aware_leasing_enabled, true)
 
+/// Whether locality-aware leasing picks the node with the lowest estimated cost
+/// instead of the node with the most argument bytes local. The cost of a node
+/// accounts for the argument bytes it has to fetch or restore from spilled copies,
+/// the argument bytes pulled to it for this worker's tasks that haven't finished, and
+/// the number of those tasks.
+RAY_CONFIG(bool, locality_aware_leasing_cost_model_enabled, false)
+
+/// The cost of restoring a byte from a spilled copy, relative to the cost of
+/// transferring a byte from another node's memory.
+RAY_CONFIG(float, locality_aware_leasing_spilled_cost_ratio, 0.5)
+
+/// The cost, in bytes, of each of this worker's tasks already running on a node.
+RAY_CONFIG(uint64_t, locality_aware_leasing_task_load_cost_bytes, 10 * 1024 * 1024)
+
 /* Configuration parameters for logging */
 /// Parameters for log rotation. This value is equivalent to RotatingFileHandler's
 /// maxBytes argument.
@@ -617,6 +769,23 @@ RAY_CONFIG(int64_t, core_worker_internal_heartbeat_ms, 1000)
 /// Maximum amount of memory that will be used by running tasks' args.
 RAY_CONFIG(float, max_task_args_memory_fraction, 0.7)
 
+/// Whether to prefetch the arguments of tasks that are queued for scheduling
+/// but can't be placed on any node yet, including the leases of multi-lease
+/// requests that are rejected, so that the transfers overlap with the
+/// execution of earlier tasks. Prefetches have the lowest pull priority.
+RAY_CONFIG(bool, prefetch_queued_task_args, false)
+
+/// The maximum fraction of the memory available for pulls that may be used
+/// by prefetched task arguments.
+RAY_CONFIG(float, prefetch_queued_task_args_max_fraction, 0.2)
+
+/// The maximum number of queued tasks whose arguments are prefetched at once.
+RAY_CONFIG(uint64_t, prefetch_queued_task_args_max_tasks, 100)
+
+/// The time after which the prefetch of a task's arguments is canceled if the
+/// task hasn't been queued on this node.
+RAY_CONFIG(int64_t, prefetch_queued_task_args_timeout_ms, 10000)
+
 /// The maximum number of objects to publish for each publish calls.
 RAY_CONFIG(int, publish_batch_size, 5000)
 
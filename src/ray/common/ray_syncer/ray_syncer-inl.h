@@ -157,13 +157,16 @@ class RaySyncerBidiReactorBase : public RaySyncerBidiReactor, public T {
   /// \param message_processor The callback for the message received.
   /// \param cleanup_cb When the connection terminates, it'll be called to cleanup
   ///     the environment.
+  /// \param max_batch_size The max number of buffered messages merged into one write.
   RaySyncerBidiReactorBase(
       instrumented_io_context &io_context,
       const std::string &remote_node_id,
-      std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor)
+      std::function<void(std::shared_ptr<const RaySyncMessage>)> message_processor,
+      size_t max_batch_size = 1)
       : RaySyncerBidiReactor(remote_node_id),
         io_context_(io_context),
-        message_processor_(std::move(message_processor)) {}
+        message_processor_(std::move(message_processor)),
+        max_batch_size_(std::max<size_t>(max_batch_size, 1)) {}
 
   bool PushToSendingQueue(std::shared_ptr<const RaySyncMessage> message) override {
     // Try to filter out the messages the target node already has.
@@ -231,12 +234,28 @@ class RaySyncerBidiReactorBase : public RaySyncerBidiReactor, public T {
       return;
     }
 
-    if (sending_buffer_.size() != 0) {
+    if (sending_buffer_.empty()) {
+      return;
+    }
+
+    if (sending_buffer_.size() == 1 || max_batch_size_ == 1) {
       auto iter = sending_buffer_.begin();
       auto msg = std::move(iter->second);
       sending_buffer_.erase(iter);
       Send(std::move(msg), sending_buffer_.empty());
       sending_ = true;
+    } else {
+      // Merge the messages piled up since the last write into one envelope, so
+      // a relay forwards the updates of its subtree with a single write.
+      auto batch = std::make_shared<RaySyncMessage>();
+      while (!sending_buffer_.empty() &&
+             static_cast<size_t>(batch->batched_messages_size()) < max_batch_size_) {
+        auto iter = sending_buffer_.begin();
+        *batch->add_batched_messages() = *iter->second;
+        sending_buffer_.erase(iter);
+      }
+      Send(std::move(batch), sending_buffer_.empty());
+      sending_ = true;
     }
   }
 
@@ -254,7 +273,9 @@ class RaySyncerBidiReactorBase : public RaySyncerBidiReactor, public T {
     }
     RAY_LOG(DEBUG) << "[BidiReactor] Sending message to "
                    << NodeID::FromBinary(GetRemoteNodeID()) << " about node "
-                   << NodeID::FromBinary(sending_message_->node_id());
+                   << NodeID::FromBinary(sending_message_->node_id())
+                   << ", batched messages: "
+                   << sending_message_->batched_messages_size();
     StartWrite(sending_message_.get(), opts);
   }
 
@@ -277,8 +298,17 @@ class RaySyncerBidiReactorBase : public RaySyncerBidiReactor, public T {
     if (ok) {
       io_context_.dispatch(
           [this, msg = std::move(receiving_message_)]() mutable {
-            RAY_CHECK(!msg->node_id().empty());
-            ReceiveUpdate(std::move(msg));
+            if (msg->batched_messages_size() != 0) {
+              for (auto &batched_message : *msg->mutable_batched_messages()) {
+                RAY_CHECK(!batched_message.node_id().empty());
+                auto update = std::make_shared<RaySyncMessage>();
+                update->Swap(&batched_message);
+                ReceiveUpdate(std::move(update));
+              }
+            } else {
+              RAY_CHECK(!msg->node_id().empty());
+              ReceiveUpdate(std::move(msg));
+            }
             StartPull();
           },
           "");
@@ -295,6 +325,7 @@ class RaySyncerBidiReactorBase : public RaySyncerBidiReactor, public T {
 
   // For testing
   FRIEND_TEST(RaySyncerTest, RaySyncerBidiReactorBase);
+  FRIEND_TEST(RaySyncerTest, RaySyncerBidiReactorBaseBatch);
   friend struct SyncerServerTest;
 
   std::array<int64_t, kComponentArraySize> &GetNodeComponentVersions(
@@ -323,6 +354,9 @@ class RaySyncerBidiReactorBase : public RaySyncerBidiReactor, public T {
   absl::flat_hash_map<std::string, std::array<int64_t, kComponentArraySize>>
       node_versions_;
 
+  /// The max number of messages merged into one write.
+  const size_t max_batch_size_;
+
   bool sending_ = false;
 };
 
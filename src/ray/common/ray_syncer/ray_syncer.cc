@@ -14,6 +14,7 @@
 
 #include "ray/common/ray_syncer/ray_syncer.h"
 
+#include <algorithm>
 #include <functional>
 
 #include "ray/common/ray_config.h"
@@ -75,6 +76,49 @@ bool NodeState::ConsumeSyncMessage(std::shared_ptr<const RaySyncMessage> message
 
 namespace {
 
+/// The level of a node in the aggregation tree: the number of trailing zero digits of
+/// the hash of its id in base `fanout`. It's at least l with probability fanout^-l.
+/// The hash is seeded the same way on every node, so all the nodes agree on it.
+int64_t GetAggregationLevel(const std::string &node_id, int64_t fanout) {
+  uint64_t hash = MurmurHash64A(node_id.data(), node_id.size(), 0);
+  int64_t level = 0;
+  while (hash != 0 && hash % fanout == 0) {
+    hash /= fanout;
+    level++;
+  }
+  return level;
+}
+
+}  // namespace
+
+std::optional<std::string> GetAggregationUpstream(std::vector<std::string> node_ids,
+                                                  const std::string &local_node_id,
+                                                  int64_t fanout) {
+  if (fanout < 2) {
+    return std::nullopt;
+  }
+  const int64_t local_level = GetAggregationLevel(local_node_id, fanout);
+  std::optional<std::string> upstream;
+  uint64_t upstream_weight = 0;
+  std::string key;
+  for (auto &node_id : node_ids) {
+    if (GetAggregationLevel(node_id, fanout) <= local_level) {
+      continue;
+    }
+    // Rendezvous hashing, so that a node joining or leaving only moves the nodes
+    // that pick it, or picked it, among the candidates.
+    key = node_id + local_node_id;
+    const uint64_t weight = MurmurHash64A(key.data(), key.size(), 0);
+    if (!upstream || weight > upstream_weight) {
+      upstream = std::move(node_id);
+      upstream_weight = weight;
+    }
+  }
+  return upstream;
+}
+
+namespace {
+
 std::string GetNodeIDFromServerContext(grpc::CallbackServerContext *server_context) {
   const auto &metadata = server_context->client_metadata();
   auto iter = metadata.find("node_id");
@@ -93,7 +137,8 @@ RayServerBidiReactor::RayServerBidiReactor(
     : RaySyncerBidiReactorBase<ServerBidiReactor>(
           io_context,
           GetNodeIDFromServerContext(server_context),
-          std::move(message_processor)),
+          std::move(message_processor),
+          RayConfig::instance().ray_syncer_max_batch_size()),
       cleanup_cb_(std::move(cleanup_cb)),
       server_context_(server_context) {
   // Send the local node id to the remote
@@ -134,7 +179,10 @@ RayClientBidiReactor::RayClientBidiReactor(
     std::function<void(const std::string &, bool)> cleanup_cb,
     std::unique_ptr<ray::rpc::syncer::RaySyncer::Stub> stub)
     : RaySyncerBidiReactorBase<ClientBidiReactor>(
-          io_context, remote_node_id, std::move(message_processor)),
+          io_context,
+          remote_node_id,
+          std::move(message_processor),
+          RayConfig::instance().ray_syncer_max_batch_size()),
       cleanup_cb_(std::move(cleanup_cb)),
       stub_(std::move(stub)) {
   client_context_.AddMetadata("node_id", NodeID::FromBinary(local_node_id).Hex());
@@ -69,6 +69,26 @@ struct ReceiverInterface {
   virtual ~ReceiverInterface() {}
 };
 
+/// Get the upstream of a node in the ray syncer aggregation tree, rooted at the GCS.
+///
+/// Each node gets a level from the hash of its id, which is at least l with
+/// probability fanout^-l, and picks its parent among the nodes of a higher level by
+/// rendezvous hashing. The nodes of the highest level sync with the GCS. A node
+/// relays the messages of about `fanout - 1` children per level below its own. The
+/// parent of a node only depends on the nodes of a higher level, and changes when one
+/// of them joins and wins the rendezvous, or the parent leaves, so a node joining a
+/// large cluster moves only a few others.
+///
+/// \param node_ids The ids of all the alive nodes, including `local_node_id`.
+/// \param local_node_id The id of the node to get the upstream for.
+/// \param fanout The fan-out of the tree. Below 2, every node syncs with the GCS.
+///
+/// \return The id of the parent node, or std::nullopt if the node should sync with
+/// the GCS directly.
+std::optional<std::string> GetAggregationUpstream(std::vector<std::string> node_ids,
+                                                  const std::string &local_node_id,
+                                                  int64_t fanout);
+
 // Forward declaration of internal structures
 class NodeState;
 class RaySyncerBidiReactor;
@@ -198,6 +198,105 @@ TEST_F(RaySyncerTest, RaySyncerBidiReactorBase) {
       3, sync_reactor.node_versions_[from_node_id.Binary()][MessageType::RESOURCE_VIEW]);
 }
 
+TEST_F(RaySyncerTest, RaySyncerBidiReactorBaseBatch) {
+  auto node_id = NodeID::FromRandom();
+  std::vector<std::shared_ptr<const RaySyncMessage>> processed;
+  MockRaySyncerBidiReactorBase<MockReactor> sync_reactor(
+      io_context_,
+      node_id.Binary(),
+      [&processed](std::shared_ptr<const RaySyncMessage> msg) {
+        processed.push_back(std::move(msg));
+      },
+      /*max_batch_size=*/2);
+
+  std::vector<NodeID> from_node_ids;
+  for (size_t i = 0; i < 4; ++i) {
+    from_node_ids.push_back(NodeID::FromRandom());
+    ASSERT_TRUE(sync_reactor.PushToSendingQueue(std::make_shared<RaySyncMessage>(
+        MakeMessage(MessageType::RESOURCE_VIEW, 1, from_node_ids.back()))));
+  }
+  // The first message is sent directly and the rest are buffered.
+  ASSERT_EQ(1, sync_reactor.write_cnt);
+  ASSERT_EQ(0, sync_reactor.sending_message_->batched_messages_size());
+  ASSERT_EQ(3, sync_reactor.sending_buffer_.size());
+
+  // The buffered messages are merged into batches of at most 2.
+  sync_reactor.SendNext();
+  ASSERT_EQ(2, sync_reactor.write_cnt);
+  ASSERT_EQ(2, sync_reactor.sending_message_->batched_messages_size());
+  ASSERT_EQ(1, sync_reactor.sending_buffer_.size());
+  sync_reactor.SendNext();
+  ASSERT_EQ(3, sync_reactor.write_cnt);
+  ASSERT_EQ(0, sync_reactor.sending_message_->batched_messages_size());
+  ASSERT_TRUE(sync_reactor.sending_buffer_.empty());
+
+  // A received batch is unpacked and each message is processed on its own.
+  auto batch = std::make_shared<RaySyncMessage>();
+  *batch->add_batched_messages() =
+      MakeMessage(MessageType::RESOURCE_VIEW, 2, from_node_ids[0]);
+  *batch->add_batched_messages() =
+      MakeMessage(MessageType::RESOURCE_VIEW, 2, from_node_ids[1]);
+  sync_reactor.receiving_message_ = batch;
+  std::promise<void> read_done;
+  sync_reactor.OnReadDone(true);
+  io_context_.post([&read_done]() { read_done.set_value(); }, "TEST");
+  read_done.get_future().get();
+  ASSERT_EQ(2, processed.size());
+  ASSERT_EQ(from_node_ids[0].Binary(), processed[0]->node_id());
+  ASSERT_EQ(from_node_ids[1].Binary(), processed[1]->node_id());
+  ASSERT_EQ(2, processed[1]->version());
+}
+
+TEST_F(RaySyncerTest, GetAggregationUpstream) {
+  const int64_t kFanout = 4;
+  std::vector<std::string> node_ids;
+  for (size_t i = 0; i < 1000; ++i) {
+    node_ids.push_back(NodeID::FromRandom().Binary());
+  }
+  auto get_upstreams = [&]() {
+    absl::flat_hash_map<std::string, std::optional<std::string>> upstreams;
+    for (const auto &node_id : node_ids) {
+      upstreams[node_id] = GetAggregationUpstream(node_ids, node_id, kFanout);
+    }
+    return upstreams;
+  };
+  auto upstreams = get_upstreams();
+
+  // The upstreams form a tree rooted at the GCS, which only a few nodes sync with.
+  int num_roots = 0;
+  for (const auto &node_id : node_ids) {
+    auto upstream = upstreams[node_id];
+    if (!upstream) {
+      num_roots++;
+    }
+    for (size_t depth = 0; upstream; ++depth) {
+      ASSERT_LT(depth, node_ids.size());
+      ASSERT_TRUE(upstreams.contains(*upstream));
+      upstream = upstreams[*upstream];
+    }
+  }
+  ASSERT_GT(num_roots, 0);
+  ASSERT_LT(num_roots, 100);
+
+  // Nodes joining move only a few of the other nodes to another upstream.
+  for (size_t i = 0; i < 10; ++i) {
+    node_ids.push_back(NodeID::FromRandom().Binary());
+  }
+  auto new_upstreams = get_upstreams();
+  int num_moved = 0;
+  for (const auto &[node_id, upstream] : upstreams) {
+    if (new_upstreams[node_id] != upstream) {
+      num_moved++;
+    }
+  }
+  ASSERT_LT(num_moved, 100);
+
+  // A fan-out below 2 means every node syncs with the GCS.
+  for (const auto &node_id : node_ids) {
+    ASSERT_EQ(std::nullopt, GetAggregationUpstream(node_ids, node_id, 1));
+  }
+}
+
 struct SyncerServerTest {
   SyncerServerTest(std::string port) : work_guard(io_context.get_executor()) {
     this->server_port = port;
@@ -0,0 +1,243 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A multi-process test of the ray syncer aggregation tree. The main process plays
+// the GCS. It forks one process per group of `fanout` synthetic reporters and, when
+// the aggregation is enabled, one relay process per group that the reporters sync
+// with. After the test duration, the GCS process reports its CPU usage and the
+// staleness of the messages it received.
+//
+// Usage:
+//   ./syncer_aggregation_e2e_test num_reporters fanout base_port duration_s aggregate
+//
+// For example, to compare 5000 reporters syncing with the GCS directly and through
+// relays:
+//   ./syncer_aggregation_e2e_test 5000 64 30000 60 0
+//   RAY_ray_syncer_max_batch_size=64 ./syncer_aggregation_e2e_test 5000 64 30000 60 1
+
+#include <grpc/grpc.h>
+#include <grpcpp/create_channel.h>
+#include <grpcpp/security/credentials.h>
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "ray/common/asio/periodical_runner.h"
+#include "ray/common/id.h"
+#include "ray/common/ray_config.h"
+#include "ray/common/ray_syncer/ray_syncer.h"
+#include "ray/util/util.h"
+
+using namespace ray::syncer;
+
+namespace {
+
+/// A synthetic reporter which bumps its version and stamps the current time into
+/// the message every period.
+class SyntheticReporter : public ReporterInterface {
+ public:
+  SyntheticReporter(instrumented_io_context &io_context,
+                    const ray::NodeID &node_id,
+                    uint64_t period_ms)
+      : node_id_(node_id), timer_(io_context) {
+    timer_.RunFnPeriodically([this]() { ++version_; }, period_ms);
+  }
+
+  std::optional<RaySyncMessage> CreateSyncMessage(int64_t current_version,
+                                                  MessageType) const override {
+    if (current_version >= version_) {
+      return std::nullopt;
+    }
+    RaySyncMessage msg;
+    msg.set_message_type(MessageType::RESOURCE_VIEW);
+    msg.set_version(version_);
+    auto now_ms = current_time_ms();
+    msg.set_sync_message(
+        std::string(reinterpret_cast<const char *>(&now_ms), sizeof(now_ms)));
+    msg.set_node_id(node_id_.Binary());
+    return msg;
+  }
+
+ private:
+  const ray::NodeID node_id_;
+  int64_t version_ = 0;
+  ray::PeriodicalRunner timer_;
+};
+
+/// The receiver in the GCS process. It records the staleness of the messages, i.e.
+/// the time between a reporter taking the snapshot and the GCS consuming it.
+class StalenessRecorder : public ReceiverInterface {
+ public:
+  void ConsumeSyncMessage(std::shared_ptr<const RaySyncMessage> msg) override {
+    int64_t created_ms = 0;
+    std::memcpy(&created_ms, msg->sync_message().data(), sizeof(created_ms));
+    staleness_ms_.push_back(current_time_ms() - created_ms);
+    nodes_.insert(msg->node_id());
+  }
+
+  void Report(std::ostream &os) {
+    std::sort(staleness_ms_.begin(), staleness_ms_.end());
+    auto percentile = [this](double p) {
+      if (staleness_ms_.empty()) {
+        return int64_t{0};
+      }
+      return staleness_ms_[static_cast<size_t>(p * (staleness_ms_.size() - 1))];
+    };
+    os << "nodes seen: " << nodes_.size() << ", messages: " << staleness_ms_.size()
+       << ", staleness ms p50: " << percentile(0.5) << ", p99: " << percentile(0.99)
+       << ", max: " << percentile(1.0) << std::endl;
+  }
+
+ private:
+  std::vector<int64_t> staleness_ms_;
+  absl::flat_hash_set<std::string> nodes_;
+};
+
+std::unique_ptr<grpc::Server> StartServer(RaySyncerService &service, int port) {
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("0.0.0.0:" + std::to_string(port),
+                           grpc::InsecureServerCredentials());
+  builder.RegisterService(&service);
+  return builder.BuildAndStart();
+}
+
+std::shared_ptr<grpc::Channel> MakeChannel(int port) {
+  grpc::ChannelArguments argument;
+  argument.SetMaxSendMessageSize(::RayConfig::instance().max_grpc_message_size());
+  argument.SetMaxReceiveMessageSize(::RayConfig::instance().max_grpc_message_size());
+  return grpc::CreateCustomChannel("localhost:" + std::to_string(port),
+                                   grpc::InsecureChannelCredentials(),
+                                   argument);
+}
+
+/// Run a relay which listens on `port` and syncs with the node listening on
+/// `upstream_port`. It never returns.
+void RunRelay(int port, int upstream_port) {
+  instrumented_io_context io_context;
+  RaySyncer syncer(io_context, ray::NodeID::FromRandom().Binary());
+  RaySyncerService service(syncer);
+  auto server = StartServer(service, port);
+  syncer.Connect(ray::NodeID::FromRandom().Binary(), MakeChannel(upstream_port));
+  boost::asio::io_context::work work(io_context);
+  io_context.run();
+}
+
+/// Run `num_reporters` synthetic nodes which sync with the node listening on
+/// `upstream_port`. It never returns.
+void RunReporters(size_t num_reporters, int upstream_port) {
+  instrumented_io_context io_context;
+  std::vector<std::unique_ptr<SyntheticReporter>> reporters;
+  std::vector<std::unique_ptr<RaySyncer>> syncers;
+  auto channel = MakeChannel(upstream_port);
+  auto period_ms = RayConfig::instance().raylet_report_resources_period_milliseconds();
+  for (size_t i = 0; i < num_reporters; ++i) {
+    auto node_id = ray::NodeID::FromRandom();
+    reporters.emplace_back(
+        std::make_unique<SyntheticReporter>(io_context, node_id, period_ms));
+    syncers.emplace_back(std::make_unique<RaySyncer>(io_context, node_id.Binary()));
+    syncers.back()->Register(
+        MessageType::RESOURCE_VIEW, reporters.back().get(), nullptr, period_ms);
+    syncers.back()->Connect(ray::NodeID::FromRandom().Binary(), channel);
+  }
+  boost::asio::io_context::work work(io_context);
+  io_context.run();
+}
+
+double CpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  RAY_CHECK(argc == 6) << "./syncer_aggregation_e2e_test num_reporters fanout "
+                          "base_port duration_s aggregate";
+  auto num_reporters = static_cast<size_t>(std::stoul(argv[1]));
+  auto fanout = static_cast<size_t>(std::stoul(argv[2]));
+  auto base_port = std::stoi(argv[3]);
+  auto duration_s = std::stoi(argv[4]);
+  auto aggregate = std::string(argv[5]) == "1";
+  RAY_CHECK(fanout > 0);
+
+  std::vector<pid_t> children;
+  auto num_groups = (num_reporters + fanout - 1) / fanout;
+  for (size_t group = 0; group < num_groups; ++group) {
+    auto group_size = std::min(fanout, num_reporters - group * fanout);
+    auto upstream_port = base_port;
+    if (aggregate) {
+      upstream_port = base_port + 1 + static_cast<int>(group);
+      auto pid = fork();
+      RAY_CHECK(pid >= 0);
+      if (pid == 0) {
+        RunRelay(upstream_port, base_port);
+        return 0;
+      }
+      children.push_back(pid);
+    }
+    auto pid = fork();
+    RAY_CHECK(pid >= 0);
+    if (pid == 0) {
+      RunReporters(group_size, upstream_port);
+      return 0;
+    }
+    children.push_back(pid);
+  }
+
+  instrumented_io_context io_context;
+  StalenessRecorder recorder;
+  RaySyncer syncer(io_context, ray::NodeID::FromRandom().Binary());
+  syncer.Register(MessageType::RESOURCE_VIEW, nullptr, &recorder, 0);
+  RaySyncerService service(syncer);
+  auto server = StartServer(service, base_port);
+
+  auto cpu_start = CpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+  size_t num_connections = 0;
+  boost::asio::steady_timer timer(io_context, std::chrono::seconds(duration_s));
+  timer.async_wait([&](const boost::system::error_code &) {
+    // It's called in the io context thread, so it won't block.
+    num_connections = syncer.GetAllConnectedNodeIDs().size();
+    io_context.stop();
+  });
+  io_context.run();
+  auto wall_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "reporters: " << num_reporters << ", fanout: " << fanout
+            << ", aggregate: " << aggregate << ", GCS connections: " << num_connections
+            << std::endl;
+  std::cout << "GCS CPU utilization: " << (CpuSeconds() - cpu_start) / wall_s
+            << std::endl;
+  recorder.Report(std::cout);
+
+  for (auto pid : children) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+  server->Shutdown();
+  return 0;
+}
@@ -32,6 +32,7 @@
 #include "ray/stats/metric_defs.h"
 #include "ray/stats/stats.h"
 #include "ray/util/event.h"
+#include "ray/util/filesystem.h"
 #include "ray/util/util.h"
 
 namespace ray {
@@ -115,7 +116,11 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       task_queue_length_(0),
       num_executed_tasks_(0),
       resource_ids_(new ResourceMappingType()),
-      grpc_service_(io_service_, *this),
+      grpc_service_(io_service_,
+                    RayConfig::instance().core_worker_object_info_threads() > 0
+                        ? object_info_io_service_
+                        : io_service_,
+                    *this),
       task_execution_service_work_(task_execution_service_) {
   RAY_LOG(DEBUG) << "Constructing CoreWorker, worker_id: " << worker_id;
 
@@ -197,6 +202,13 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
 
   RAY_CHECK(assigned_port >= 0);
 
+  if (RayConfig::instance().core_worker_object_info_threads() > 0) {
+    object_info_executor_ = std::make_unique<rpc::ServiceExecutor>(
+        object_info_io_service_,
+        RayConfig::instance().core_worker_object_info_threads(),
+        "worker.object_info");
+  }
+
   // Start RPC server after all the task receivers are properly initialized and we have
   // our assigned port from the raylet.
   core_worker_server_ =
@@ -230,6 +242,14 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       RAY_CHECK(!task_event_buffer_->Enabled()) << "TaskEventBuffer should be disabled.";
     }
   }
+  if (options_.worker_type == WorkerType::DRIVER) {
+    // Workers get the job config, with the sampling rate, with their first task.
+    auto job_config = worker_context_.GetCurrentJobConfig();
+    if (job_config.has_task_events_sampling_rate()) {
+      task_event_buffer_->SetSamplingRate(worker_context_.GetCurrentJobID(),
+                                          job_config.task_events_sampling_rate());
+    }
+  }
 
   core_worker_client_pool_ =
       std::make_shared<rpc::CoreWorkerClientPool>(*client_call_manager_);
@@ -364,7 +384,11 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       },
       push_error_callback,
       RayConfig::instance().max_lineage_bytes(),
-      *task_event_buffer_.get()));
+      *task_event_buffer_.get(),
+      RayConfig::instance().lineage_offload_dir().empty()
+          ? ""
+          : JoinPaths(RayConfig::instance().lineage_offload_dir(),
+                      "lineage_" + GetWorkerID().Hex())));
 
   // Create an entry for the driver task in the task table. This task is
   // added immediately with status RUNNING. This allows us to push errors
@@ -462,6 +486,7 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       actor_creator_,
       worker_context_.GetCurrentJobID(),
       lease_request_rate_limiter_,
+      boost::asio::steady_timer(io_service_),
       boost::asio::steady_timer(io_service_));
   auto report_locality_data_callback = [this](
                                            const ObjectID &object_id,
@@ -653,6 +678,9 @@ void CoreWorker::Shutdown() {
   if (io_thread_.joinable()) {
     io_thread_.join();
   }
+  if (object_info_executor_) {
+    object_info_executor_->Stop();
+  }
 
   // Shutdown gRPC server
   core_worker_server_->Shutdown();
@@ -2446,12 +2474,15 @@ Status CoreWorker::AllocateReturnObject(const ObjectID &object_id,
       data_buffer = std::make_shared<LocalMemoryBuffer>(data_size);
       *task_output_inlined_bytes += static_cast<int64_t>(data_size);
     } else {
-      RAY_RETURN_NOT_OK(CreateExisting(metadata,
-                                       data_size,
-                                       object_id,
-                                       owner_address,
-                                       &data_buffer,
-                                       /*created_by_worker=*/true));
+      RAY_RETURN_NOT_OK(plasma_store_provider_->Create(
+          metadata,
+          data_size,
+          object_id,
+          owner_address,
+          &data_buffer,
+          /*created_by_worker=*/true,
+          plasma::flatbuf::CreatePriority::TaskReturn,
+          RayConfig::instance().task_return_create_deadline_ms()));
       object_already_exists = !data_buffer;
     }
   }
@@ -2585,16 +2616,19 @@ Status CoreWorker::ExecuteTask(
   // task) are still borrowing. It will also notify the caller of any new IDs
   // that were contained in a borrowed ID that we (or a nested task) are now
   // borrowing.
+  // The dynamic returns are popped in the same call, so that their nested
+  // references are collected in one pass over the reference table.
   std::vector<ObjectID> deleted;
-  if (!borrowed_ids.empty()) {
-    reference_counter_->PopAndClearLocalBorrowers(borrowed_ids, borrowed_refs, &deleted);
-  }
+  std::vector<ObjectID> ids_to_pop = std::move(borrowed_ids);
   if (dynamic_return_objects != NULL) {
+    ids_to_pop.reserve(ids_to_pop.size() + dynamic_return_objects->size());
     for (const auto &dynamic_return : *dynamic_return_objects) {
-      reference_counter_->PopAndClearLocalBorrowers(
-          {dynamic_return.first}, borrowed_refs, &deleted);
+      ids_to_pop.push_back(dynamic_return.first);
     }
   }
+  if (!ids_to_pop.empty()) {
+    reference_counter_->PopAndClearLocalBorrowers(ids_to_pop, borrowed_refs, &deleted);
+  }
   memory_store_->Delete(deleted);
 
   if (task_spec.IsNormalTask() && reference_counter_->NumObjectIDsInScope() != 0) {
@@ -2878,6 +2912,10 @@ void CoreWorker::HandlePushTask(rpc::PushTaskRequest request,
     auto job_id = JobID::FromBinary(request.task_spec().job_id());
     worker_context_.MaybeInitializeJobInfo(job_id, request.task_spec().job_config());
     task_counter_.SetJobId(job_id);
+    if (request.task_spec().job_config().has_task_events_sampling_rate()) {
+      task_event_buffer_->SetSamplingRate(
+          job_id, request.task_spec().job_config().task_events_sampling_rate());
+    }
   }
   // Increment the task_queue_length and per function counter.
   task_queue_length_ += 1;
@@ -3571,6 +3609,12 @@ void CoreWorker::HandleDeleteSpilledObjects(rpc::DeleteSpilledObjectsRequest req
       spilled_objects_url.push_back(url);
     }
     options_.delete_spilled_objects(spilled_objects_url, worker_context_.GetWorkerType());
+    if (request.reclaimed_objects_url_size() > 0 &&
+        options_.reclaim_spilled_objects != nullptr) {
+      std::vector<std::string> reclaimed_objects_url(
+          request.reclaimed_objects_url().begin(), request.reclaimed_objects_url().end());
+      options_.reclaim_spilled_objects(reclaimed_objects_url);
+    }
     send_reply_callback(Status::OK(), nullptr, nullptr);
   } else {
     send_reply_callback(
@@ -1003,6 +1003,7 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
                                     rpc::SendReplyCallback send_reply_callback) override;
 
   // Implements gRPC server handler.
+  // This may run on the object info executor, so it must only use thread-safe state.
   void HandlePubsubLongPolling(rpc::PubsubLongPollingRequest request,
                                rpc::PubsubLongPollingReply *reply,
                                rpc::SendReplyCallback send_reply_callback) override;
@@ -1019,6 +1020,7 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
       rpc::SendReplyCallback send_reply_callback) override;
 
   /// Implements gRPC server handler.
+  /// This may run on the object info executor, so it must only use thread-safe state.
   void HandleGetObjectLocationsOwner(rpc::GetObjectLocationsOwnerRequest request,
                                      rpc::GetObjectLocationsOwnerReply *reply,
                                      rpc::SendReplyCallback send_reply_callback) override;
@@ -1518,6 +1520,13 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   /// of that resource allocated for this worker. This is set on task assignment.
   std::shared_ptr<ResourceMappingType> resource_ids_ GUARDED_BY(mutex_);
 
+  /// The event loop of the object location and pubsub long polling handlers, if they
+  /// run on their own threads. See `core_worker_object_info_threads`.
+  instrumented_io_context object_info_io_service_;
+
+  /// Runs `object_info_io_service_`.
+  std::unique_ptr<rpc::ServiceExecutor> object_info_executor_;
+
   /// Common rpc service for all worker modules.
   rpc::CoreWorkerGrpcService grpc_service_;
 
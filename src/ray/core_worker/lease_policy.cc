@@ -14,6 +14,8 @@
 
 #include "ray/core_worker/lease_policy.h"
 
+#include "ray/common/ray_config.h"
+
 namespace ray {
 namespace core {
 
@@ -44,9 +46,13 @@ std::pair<rpc::Address, bool> LocalityAwareLeasePolicy::GetBestNodeForTask(
   return std::make_pair(fallback_rpc_address_, false);
 }
 
-/// Criteria for "best" node: The node with the most object bytes (from object_ids) local.
+/// Criteria for "best" node: The node with the most object bytes (from object_ids) local,
+/// or the node with the lowest estimated cost if the cost model is enabled.
 absl::optional<NodeID> LocalityAwareLeasePolicy::GetBestNodeIdForTask(
     const TaskSpecification &spec) {
+  if (RayConfig::instance().locality_aware_leasing_cost_model_enabled()) {
+    return GetLowestCostNodeIdForTask(spec);
+  }
   const auto object_ids = spec.GetDependencyIds();
   // Number of object bytes (from object_ids) that a given node has local.
   absl::flat_hash_map<NodeID, uint64_t> bytes_local_table;
@@ -72,6 +78,117 @@ absl::optional<NodeID> LocalityAwareLeasePolicy::GetBestNodeIdForTask(
   return max_bytes_node;
 }
 
+absl::optional<NodeID> LocalityAwareLeasePolicy::GetLowestCostNodeIdForTask(
+    const TaskSpecification &spec) {
+  const auto object_ids = spec.GetDependencyIds();
+  std::vector<LocalityData> args_locality_data;
+  args_locality_data.reserve(object_ids.size());
+  // Only nodes that hold a copy of some argument are considered, as in the
+  // bytes-local policy.
+  absl::flat_hash_set<NodeID> candidate_nodes;
+  for (const ObjectID &object_id : object_ids) {
+    if (auto locality_data = locality_data_provider_->GetLocalityData(object_id)) {
+      candidate_nodes.insert(locality_data->nodes_containing_object.begin(),
+                             locality_data->nodes_containing_object.end());
+      if (!locality_data->spilled_node_id.IsNil()) {
+        candidate_nodes.insert(locality_data->spilled_node_id);
+      }
+      args_locality_data.push_back(std::move(*locality_data));
+    } else {
+      RAY_LOG(WARNING) << "No locality data available for object " << object_id
+                       << ", won't be included in locality cost";
+    }
+  }
+
+  const double task_load_cost =
+      RayConfig::instance().locality_aware_leasing_task_load_cost_bytes();
+  absl::optional<NodeID> best_node;
+  double best_cost = 0;
+  for (const NodeID &node_id : candidate_nodes) {
+    double cost = 0;
+    for (const auto &locality_data : args_locality_data) {
+      cost += ObjectCost(locality_data, node_id);
+    }
+    auto load_it = node_loads_.find(node_id);
+    if (load_it != node_loads_.end()) {
+      cost += load_it->second.pulled_arg_bytes;
+      cost += load_it->second.num_tasks_in_flight * task_load_cost;
+    }
+    // Break ties by node ID so that the choice doesn't depend on the hash order.
+    if (!best_node.has_value() || cost < best_cost ||
+        (cost == best_cost && node_id.Binary() < best_node->Binary())) {
+      best_node = node_id;
+      best_cost = cost;
+    }
+  }
+  return best_node;
+}
+
+double LocalityAwareLeasePolicy::ObjectCost(const LocalityData &locality_data,
+                                            const NodeID &node_id) {
+  const double object_size = locality_data.object_size;
+  const double spilled_cost_ratio =
+      RayConfig::instance().locality_aware_leasing_spilled_cost_ratio();
+  const bool only_on_local_disk = locality_data.spilled &&
+                                  locality_data.spilled_node_id == node_id &&
+                                  !locality_data.spilled_copy_in_memory;
+  if (locality_data.nodes_containing_object.contains(node_id) && !only_on_local_disk) {
+    return 0;
+  }
+  if (only_on_local_disk) {
+    return object_size * spilled_cost_ratio;
+  }
+  if (locality_data.spilled && locality_data.spilled_node_id.IsNil()) {
+    // Any node can restore the object from external storage directly.
+    return object_size * std::min(1.0, static_cast<double>(spilled_cost_ratio));
+  }
+  // If the only copy is the spilled one, it has to be restored before it can be
+  // transferred.
+  const bool only_copy_spilled = locality_data.spilled &&
+                                 !locality_data.spilled_copy_in_memory &&
+                                 locality_data.nodes_containing_object.size() <= 1;
+  return only_copy_spilled ? object_size * (1 + spilled_cost_ratio) : object_size;
+}
+
+void LocalityAwareLeasePolicy::OnTaskPushed(const TaskSpecification &spec,
+                                            const NodeID &node_id) {
+  if (!RayConfig::instance().locality_aware_leasing_cost_model_enabled()) {
+    return;
+  }
+  uint64_t pulled_arg_bytes = 0;
+  for (const ObjectID &object_id : spec.GetDependencyIds()) {
+    if (auto locality_data = locality_data_provider_->GetLocalityData(object_id)) {
+      if (ObjectCost(*locality_data, node_id) > 0) {
+        pulled_arg_bytes += locality_data->object_size;
+      }
+    }
+  }
+  if (!tasks_in_flight_
+           .emplace(spec.TaskId(), std::make_pair(node_id, pulled_arg_bytes))
+           .second) {
+    return;
+  }
+  auto &node_load = node_loads_[node_id];
+  node_load.num_tasks_in_flight++;
+  node_load.pulled_arg_bytes += pulled_arg_bytes;
+}
+
+void LocalityAwareLeasePolicy::OnTaskFinished(const TaskID &task_id) {
+  auto it = tasks_in_flight_.find(task_id);
+  if (it == tasks_in_flight_.end()) {
+    return;
+  }
+  const auto &[node_id, pulled_arg_bytes] = it->second;
+  auto load_it = node_loads_.find(node_id);
+  RAY_CHECK(load_it != node_loads_.end());
+  load_it->second.num_tasks_in_flight--;
+  load_it->second.pulled_arg_bytes -= pulled_arg_bytes;
+  if (load_it->second.num_tasks_in_flight == 0) {
+    node_loads_.erase(load_it);
+  }
+  tasks_in_flight_.erase(it);
+}
+
 std::pair<rpc::Address, bool> LocalLeasePolicy::GetBestNodeForTask(
     const TaskSpecification &spec) {
   // Always return the local node.
@@ -26,7 +26,16 @@ namespace core {
 
 struct LocalityData {
   uint64_t object_size;
+  /// The nodes that hold a copy in memory, plus the node of the primary copy even
+  /// if it has been spilled.
   absl::flat_hash_set<NodeID> nodes_containing_object;
+  /// Whether the primary copy of the object has been spilled.
+  bool spilled = false;
+  /// The node whose local disk holds the spilled copy. Nil if the object has not
+  /// been spilled or has been spilled to distributed external storage.
+  NodeID spilled_node_id = NodeID::Nil();
+  /// Whether the node in spilled_node_id also still holds a copy in memory.
+  bool spilled_copy_in_memory = false;
 };
 
 /// Interface for providers of locality data to the lease policy.
@@ -45,6 +54,12 @@ class LeasePolicyInterface {
   virtual std::pair<rpc::Address, bool> GetBestNodeForTask(
       const TaskSpecification &spec) = 0;
 
+  /// Notify the policy that a task was pushed to a worker leased from the given node.
+  virtual void OnTaskPushed(const TaskSpecification &spec, const NodeID &node_id) = 0;
+
+  /// Notify the policy that a task previously passed to OnTaskPushed has finished.
+  virtual void OnTaskFinished(const TaskID &task_id) = 0;
+
   virtual ~LeasePolicyInterface() {}
 };
 
@@ -69,10 +84,43 @@ class LocalityAwareLeasePolicy : public LeasePolicyInterface {
   std::pair<rpc::Address, bool> GetBestNodeForTask(
       const TaskSpecification &spec) override;
 
+  /// Track the bytes that the task's node pulls for its arguments, if the cost model
+  /// is enabled.
+  void OnTaskPushed(const TaskSpecification &spec, const NodeID &node_id) override;
+
+  void OnTaskFinished(const TaskID &task_id) override;
+
  private:
   /// Get the best worker node for a lease request for the provided task.
   absl::optional<NodeID> GetBestNodeIdForTask(const TaskSpecification &spec);
 
+  /// Get the worker node with the lowest estimated cost for the provided task. The
+  /// cost of a node is the cost of fetching the arguments that are not in its memory,
+  /// plus the argument bytes pulled to it for this worker's tasks in flight there,
+  /// plus a fixed cost for each of those tasks.
+  absl::optional<NodeID> GetLowestCostNodeIdForTask(const TaskSpecification &spec);
+
+  /// Estimate the cost, in bytes transferred, of making an object available on a
+  /// node. Restoring a spilled copy is weighted by
+  /// locality_aware_leasing_spilled_cost_ratio.
+  static double ObjectCost(const LocalityData &locality_data, const NodeID &node_id);
+
+  struct NodeLoad {
+    /// Number of this worker's tasks pushed to the node and not yet finished.
+    uint64_t num_tasks_in_flight = 0;
+    /// Bytes of arguments that were not in the node's memory when those tasks were
+    /// pushed. They are subtracted when the tasks finish, not when the pulls
+    /// complete, so this also counts the memory that the pulled arguments take.
+    uint64_t pulled_arg_bytes = 0;
+  };
+
+  /// The owner's view of the load on each node, from the tasks it pushed there.
+  absl::flat_hash_map<NodeID, NodeLoad> node_loads_;
+
+  /// The node and pulled argument bytes of each task in flight, so that they can be
+  /// subtracted from node_loads_ when the task finishes.
+  absl::flat_hash_map<TaskID, std::pair<NodeID, uint64_t>> tasks_in_flight_;
+
   /// Provider of locality data that will be used in choosing the best lessor.
   std::shared_ptr<LocalityDataProviderInterface> locality_data_provider_;
 
@@ -96,6 +144,10 @@ class LocalLeasePolicy : public LeasePolicyInterface {
   std::pair<rpc::Address, bool> GetBestNodeForTask(
       const TaskSpecification &spec) override;
 
+  void OnTaskPushed(const TaskSpecification &spec, const NodeID &node_id) override {}
+
+  void OnTaskFinished(const TaskID &task_id) override {}
+
  private:
   /// RPC address of the local node.
   const rpc::Address local_node_rpc_address_;
@@ -0,0 +1,443 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/lineage_store.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+/// Serialize with a deterministic order of map entries, so that equal shared fields
+/// have equal bytes.
+std::string SerializeDeterministic(const rpc::TaskSpec &message) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_stream);
+  }
+  return serialized;
+}
+
+/// Move the fields that are usually the same across tasks from `spec` to `shared`.
+/// Since they are cleared in `spec`, merging the serialized `shared` into `spec`
+/// restores the original message.
+void MoveSharedFields(rpc::TaskSpec *spec, rpc::TaskSpec *shared) {
+  shared->mutable_name()->swap(*spec->mutable_name());
+  shared->mutable_concurrency_group_name()->swap(
+      *spec->mutable_concurrency_group_name());
+  shared->mutable_serialized_retry_exception_allowlist()->swap(
+      *spec->mutable_serialized_retry_exception_allowlist());
+  shared->mutable_required_resources()->swap(*spec->mutable_required_resources());
+  shared->mutable_required_placement_resources()->swap(
+      *spec->mutable_required_placement_resources());
+  if (spec->has_function_descriptor()) {
+    shared->set_allocated_function_descriptor(spec->release_function_descriptor());
+  }
+  if (spec->has_caller_address()) {
+    shared->set_allocated_caller_address(spec->release_caller_address());
+  }
+  if (spec->has_runtime_env_info()) {
+    shared->set_allocated_runtime_env_info(spec->release_runtime_env_info());
+  }
+  if (spec->has_scheduling_strategy()) {
+    shared->set_allocated_scheduling_strategy(spec->release_scheduling_strategy());
+  }
+  if (spec->has_job_config()) {
+    shared->set_allocated_job_config(spec->release_job_config());
+  }
+}
+
+std::vector<ObjectID> CollectDependencies(const TaskSpecification &spec) {
+  std::vector<ObjectID> dependencies;
+  for (size_t i = 0; i < spec.NumArgs(); i++) {
+    if (spec.ArgByRef(i)) {
+      dependencies.push_back(spec.ArgId(i));
+    } else {
+      for (const auto &inlined_ref : spec.ArgInlinedRefs(i)) {
+        dependencies.push_back(ObjectID::FromBinary(inlined_ref.object_id()));
+      }
+    }
+  }
+  return dependencies;
+}
+
+}  // namespace
+
+LineageStore::OffloadFile::~OffloadFile() {
+  std::fclose(file);
+#ifndef _WIN32
+  if (read_fd != -1) {
+    close(read_fd);
+  }
+#endif
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+}
+
+int64_t LineageStore::OffloadFile::Append(const std::string &data) {
+  if (std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+    return -1;
+  }
+  int64_t offset = size;
+  size += data.size();
+  return offset;
+}
+
+bool LineageStore::OffloadFile::ReadAt(int64_t offset, std::string *data) const {
+#ifdef _WIN32
+  // There's no pread, so open the file for each read instead.
+  std::FILE *read_file = std::fopen(path.c_str(), "rb");
+  if (read_file == nullptr) {
+    return false;
+  }
+  bool ok = std::fseek(read_file, offset, SEEK_SET) == 0 &&
+            std::fread(data->data(), 1, data->size(), read_file) == data->size();
+  std::fclose(read_file);
+  return ok;
+#else
+  size_t bytes_read = 0;
+  while (bytes_read < data->size()) {
+    ssize_t n = pread(read_fd,
+                      data->data() + bytes_read,
+                      data->size() - bytes_read,
+                      offset + bytes_read);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes_read += n;
+  }
+  return true;
+#endif
+}
+
+TaskSpecification LineageStore::SpecReader::Read() const {
+  if (file_ == nullptr) {
+    rpc::TaskSpec message;
+    RAY_CHECK(message.ParseFromString(spec_));
+    RAY_CHECK(message.MergeFromString(shared_fields_));
+    return TaskSpecification(std::move(message));
+  }
+
+  std::string serialized(size_, '\0');
+  RAY_CHECK(file_->ReadAt(offset_, &serialized))
+      << "Failed to read the lineage of a task from " << file_->path << ": "
+      << strerror(errno);
+  return TaskSpecification(serialized);
+}
+
+void LineageStore::Compaction::Run() {
+  for (auto &spec : specs_) {
+    std::string data(spec.size, '\0');
+    RAY_CHECK(file_->ReadAt(spec.offset, &data))
+        << "Failed to read the lineage of task " << spec.task_id << " from "
+        << file_->path << ": " << strerror(errno);
+    spec.new_offset = new_file_->Append(data);
+    if (spec.new_offset == -1) {
+      failed_ = true;
+      return;
+    }
+  }
+}
+
+LineageStore::LineageStore(std::string offload_path, int64_t min_compaction_bytes)
+    : offload_path_(std::move(offload_path)),
+      min_compaction_bytes_(min_compaction_bytes) {}
+
+void LineageStore::Put(const TaskSpecification &spec) {
+  const auto task_id = spec.TaskId();
+  Remove(task_id);
+
+  rpc::TaskSpec stripped = spec.GetMessage();
+  rpc::TaskSpec shared;
+  MoveSharedFields(&stripped, &shared);
+
+  Entry &entry = entries_[task_id];
+  entry.spec = stripped.SerializeAsString();
+  entry.shared_fields = AddSharedFields(SerializeDeterministic(shared));
+  entry.dependencies = CollectDependencies(spec);
+  entry.attempt_number = spec.AttemptNumber();
+  entry.order_it = in_memory_order_.insert(in_memory_order_.end(), task_id);
+  memory_bytes_ += EntryBytes(entry);
+  spec_bytes_ += entry.spec.size() + entry.shared_fields->size();
+}
+
+bool LineageStore::Contains(const TaskID &task_id) const {
+  return entries_.contains(task_id);
+}
+
+TaskSpecification LineageStore::Get(const TaskID &task_id) const {
+  return GetReader(task_id).Read();
+}
+
+LineageStore::SpecReader LineageStore::GetReader(const TaskID &task_id) const {
+  auto it = entries_.find(task_id);
+  RAY_CHECK(it != entries_.end()) << "No lineage for task " << task_id;
+  const Entry &entry = it->second;
+  SpecReader reader;
+  if (entry.offset == -1) {
+    reader.spec_ = entry.spec;
+    reader.shared_fields_ = *entry.shared_fields;
+    return reader;
+  }
+
+  FlushOffloadFile();
+  reader.file_ = offload_file_;
+  reader.offset_ = entry.offset;
+  reader.size_ = entry.size;
+  return reader;
+}
+
+int32_t LineageStore::GetAttemptNumber(const TaskID &task_id) const {
+  auto it = entries_.find(task_id);
+  RAY_CHECK(it != entries_.end()) << "No lineage for task " << task_id;
+  return it->second.attempt_number;
+}
+
+const std::vector<ObjectID> &LineageStore::GetDependencies(const TaskID &task_id) const {
+  auto it = entries_.find(task_id);
+  RAY_CHECK(it != entries_.end()) << "No lineage for task " << task_id;
+  return it->second.dependencies;
+}
+
+void LineageStore::Remove(const TaskID &task_id) {
+  auto it = entries_.find(task_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  Entry &entry = it->second;
+  memory_bytes_ -= EntryBytes(entry);
+  if (entry.offset == -1) {
+    spec_bytes_ -= entry.spec.size() + entry.shared_fields->size();
+    ReleaseSharedFields(entry.shared_fields);
+    in_memory_order_.erase(entry.order_it);
+  } else {
+    num_offloaded_--;
+    offloaded_live_bytes_ -= entry.size;
+  }
+  entries_.erase(it);
+
+  if (num_offloaded_ == 0) {
+    // Nothing refers to the offload file anymore, so start it over. This also
+    // drops a running compaction of it.
+    offload_file_ = nullptr;
+  }
+}
+
+std::unique_ptr<LineageStore::Compaction> LineageStore::StartCompaction() {
+  if (offload_file_ == nullptr || !OffloadEnabled() || compacting_) {
+    return nullptr;
+  }
+  const int64_t removed_bytes = offload_file_->size - offloaded_live_bytes_;
+  if (removed_bytes < min_compaction_bytes_ || removed_bytes < offloaded_live_bytes_) {
+    return nullptr;
+  }
+  auto new_file = OpenOffloadFile();
+  if (new_file == nullptr) {
+    return nullptr;
+  }
+  FlushOffloadFile();
+  auto compaction = std::make_unique<Compaction>();
+  compaction->file_ = offload_file_;
+  compaction->new_file_ = std::move(new_file);
+  compaction->file_size_ = offload_file_->size;
+  compaction->specs_.reserve(num_offloaded_);
+  for (const auto &[task_id, entry] : entries_) {
+    if (entry.offset != -1) {
+      compaction->specs_.push_back({task_id, entry.offset, entry.size});
+    }
+  }
+  // Copy the specs in the order of the file, so that it's read sequentially.
+  std::sort(compaction->specs_.begin(),
+            compaction->specs_.end(),
+            [](const Compaction::Spec &a, const Compaction::Spec &b) {
+              return a.offset < b.offset;
+            });
+  compacting_ = true;
+  return compaction;
+}
+
+void LineageStore::FinishCompaction(Compaction &compaction) {
+  compacting_ = false;
+  if (compaction.file_ != offload_file_ || !OffloadEnabled()) {
+    // The file was dropped, or offloading was disabled, in the meantime.
+    return;
+  }
+  OffloadFile &new_file = *compaction.new_file_;
+  if (compaction.failed_) {
+    RAY_LOG(WARNING) << "Failed to write to the lineage offload file " << new_file.path
+                     << ", disabling lineage offloading.";
+    offload_failed_ = true;
+    return;
+  }
+  // Copy the specs that were offloaded while the others were copied. There are
+  // only a few, so this is done here. Only switch any entry to the new file once
+  // all of them are copied, so that a failed write leaves them in the old one.
+  std::vector<std::pair<Entry *, int64_t>> new_offsets;
+  if (offload_file_->size > compaction.file_size_) {
+    FlushOffloadFile();
+    for (auto &[task_id, entry] : entries_) {
+      if (entry.offset < compaction.file_size_) {
+        continue;
+      }
+      std::string data(entry.size, '\0');
+      RAY_CHECK(offload_file_->ReadAt(entry.offset, &data))
+          << "Failed to read the lineage of task " << task_id << " from "
+          << offload_file_->path << ": " << strerror(errno);
+      const int64_t offset = AppendToOffloadFile(new_file, data);
+      if (offset == -1) {
+        return;
+      }
+      new_offsets.emplace_back(&entry, offset);
+    }
+  }
+  for (const auto &spec : compaction.specs_) {
+    // Skip the specs that were removed in the meantime. Offsets only grow, so an
+    // entry at the same offset is still the spec that was copied.
+    auto it = entries_.find(spec.task_id);
+    if (it != entries_.end() && it->second.offset == spec.offset) {
+      it->second.offset = spec.new_offset;
+    }
+  }
+  for (auto &[entry, offset] : new_offsets) {
+    entry->offset = offset;
+  }
+  RAY_LOG(DEBUG) << "Compacted the lineage offload file from " << offload_file_->size
+                 << " to " << new_file.size << " bytes.";
+  // The old file is removed once the readers that use it are done.
+  offload_file_ = std::move(compaction.new_file_);
+}
+
+int64_t LineageStore::Offload(int64_t min_bytes_to_offload) {
+  if (!OffloadEnabled()) {
+    return 0;
+  }
+  if (offload_file_ == nullptr) {
+    offload_file_ = OpenOffloadFile();
+    if (offload_file_ == nullptr) {
+      return 0;
+    }
+  }
+  int64_t bytes_offloaded = 0;
+  while (bytes_offloaded < min_bytes_to_offload && !in_memory_order_.empty()) {
+    const TaskID task_id = in_memory_order_.front();
+    Entry &entry = entries_.at(task_id);
+    std::string serialized = entry.spec + *entry.shared_fields;
+    int64_t offset = AppendToOffloadFile(*offload_file_, serialized);
+    if (offset == -1) {
+      break;
+    }
+
+    memory_bytes_ -= EntryBytes(entry);
+    spec_bytes_ -= serialized.size();
+    bytes_offloaded += serialized.size();
+    in_memory_order_.pop_front();
+    ReleaseSharedFields(entry.shared_fields);
+    entry.shared_fields = nullptr;
+    std::string().swap(entry.spec);
+    entry.offset = offset;
+    entry.size = serialized.size();
+    num_offloaded_++;
+    offloaded_live_bytes_ += entry.size;
+  }
+  return bytes_offloaded;
+}
+
+int64_t LineageStore::EntryBytes(const Entry &entry) { return entry.spec.size(); }
+
+const std::string *LineageStore::AddSharedFields(std::string shared_fields) {
+  auto it = shared_fields_.find(shared_fields);
+  if (it == shared_fields_.end()) {
+    shared_bytes_ += shared_fields.size();
+    it = shared_fields_.emplace(std::move(shared_fields), 0).first;
+  }
+  it->second++;
+  return &it->first;
+}
+
+void LineageStore::ReleaseSharedFields(const std::string *shared_fields) {
+  auto it = shared_fields_.find(*shared_fields);
+  RAY_CHECK(it != shared_fields_.end());
+  if (--it->second == 0) {
+    shared_bytes_ -= it->first.size();
+    shared_fields_.erase(it);
+  }
+}
+
+std::shared_ptr<LineageStore::OffloadFile> LineageStore::OpenOffloadFile() {
+  // A reader may still use the previous file, so each file gets its own path.
+  std::string path = num_offload_files_ == 0
+                         ? offload_path_
+                         : offload_path_ + "." + std::to_string(num_offload_files_);
+  num_offload_files_++;
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    RAY_LOG(WARNING) << "Failed to open the lineage offload file " << path
+                     << ", disabling lineage offloading: " << strerror(errno);
+    offload_failed_ = true;
+    return nullptr;
+  }
+  int read_fd = -1;
+#ifndef _WIN32
+  read_fd = open(path.c_str(), O_RDONLY);
+  if (read_fd == -1) {
+    RAY_LOG(WARNING) << "Failed to open the lineage offload file " << path
+                     << " for reading, disabling lineage offloading: "
+                     << strerror(errno);
+    std::fclose(file);
+    offload_failed_ = true;
+    return nullptr;
+  }
+#endif
+  return std::make_shared<OffloadFile>(std::move(path), file, read_fd);
+}
+
+int64_t LineageStore::AppendToOffloadFile(OffloadFile &file, const std::string &data) {
+  int64_t offset = file.Append(data);
+  if (offset == -1) {
+    // The file may end with a partial spec now, so stop appending to it.
+    RAY_LOG(WARNING) << "Failed to write to the lineage offload file " << file.path
+                     << ", disabling lineage offloading: " << strerror(errno);
+    offload_failed_ = true;
+  }
+  return offset;
+}
+
+void LineageStore::FlushOffloadFile() const {
+  RAY_CHECK(std::fflush(offload_file_->file) == 0)
+      << "Failed to flush " << offload_file_->path << ": " << strerror(errno);
+}
+
+}  // namespace core
+}  // namespace ray
@@ -0,0 +1,277 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "ray/common/id.h"
+#include "ray/common/task/task_spec.h"
+
+namespace ray {
+namespace core {
+
+/// A compact store for the specs of finished tasks that are kept for lineage
+/// reconstruction.
+///
+/// Each spec is kept serialized, and the fields that are usually the same across
+/// tasks (function descriptor, runtime env, resources, scheduling strategy, etc.) are
+/// stored once and shared by all the specs that have the same values. Optionally,
+/// the oldest specs can be offloaded to a local append-only file, which is only read
+/// back when the spec is needed again, e.g. to reconstruct an object. Once most of
+/// the file belongs to removed specs, the live ones are copied to a new file by a
+/// Compaction.
+///
+/// This class is not thread safe, but the specs can be read through a SpecReader,
+/// and the offload file compacted, without synchronizing with the store.
+class LineageStore {
+ private:
+  struct OffloadFile;
+
+ public:
+  /// A reference to the spec of a task. Reading it back doesn't use the store, so
+  /// the caller doesn't need to hold the lock of the store, and the store may change
+  /// in the meantime.
+  class SpecReader {
+   public:
+    /// Parse the spec, reading it back from the offload file if it was offloaded.
+    TaskSpecification Read() const;
+
+   private:
+    friend class LineageStore;
+
+    /// The serialized spec and the serialized shared fields, if the spec is in
+    /// memory.
+    std::string spec_;
+    std::string shared_fields_;
+    /// The offload file and the location of the spec in it, if it was offloaded.
+    std::shared_ptr<const OffloadFile> file_;
+    int64_t offset_ = -1;
+    int64_t size_ = 0;
+  };
+
+  /// A copy of the live specs of the offload file to a new file. It's started and
+  /// finished by the store, but Run() doesn't use the store, so that the caller can
+  /// release the lock of the store while the specs are copied.
+  class Compaction {
+   public:
+    /// Copy the specs to the new file.
+    void Run();
+
+   private:
+    friend class LineageStore;
+
+    struct Spec {
+      TaskID task_id;
+      /// The location of the spec in the previous file.
+      int64_t offset;
+      int64_t size;
+      /// The location of the spec in the new file, once it's copied.
+      int64_t new_offset = -1;
+    };
+
+    std::shared_ptr<const OffloadFile> file_;
+    std::shared_ptr<OffloadFile> new_file_;
+    /// The specs to copy, by offset in the previous file.
+    std::vector<Spec> specs_;
+    /// The size of the previous file when the compaction started. The specs that
+    /// are offloaded after that are copied when the compaction finishes.
+    int64_t file_size_ = 0;
+    bool failed_ = false;
+  };
+
+  /// Create a lineage store.
+  ///
+  /// \param offload_path The file to offload lineage to. Offloading is disabled if
+  /// empty.
+  /// \param min_compaction_bytes The bytes of removed specs in the offload file from
+  /// which it is compacted, once they are also at least the bytes of the live ones.
+  explicit LineageStore(std::string offload_path = "",
+                        int64_t min_compaction_bytes = 16 * 1024 * 1024);
+
+  /// Add the spec of a task. The spec is copied, so later changes to it are not
+  /// reflected in the store.
+  ///
+  /// \param spec The task spec.
+  void Put(const TaskSpecification &spec);
+
+  /// Whether the spec of the task is in the store.
+  bool Contains(const TaskID &task_id) const;
+
+  /// Read back the spec of a task. The task must be in the store.
+  TaskSpecification Get(const TaskID &task_id) const;
+
+  /// Get a reader of the spec of a task, to read it back later. The task must be in
+  /// the store. This copies the serialized spec but doesn't parse or read it.
+  SpecReader GetReader(const TaskID &task_id) const;
+
+  /// The attempt number of a task, without reading back its spec. The task must be
+  /// in the store.
+  int32_t GetAttemptNumber(const TaskID &task_id) const;
+
+  /// The objects that the task depends on, i.e. its arguments and the objects
+  /// inlined in them. These are kept in memory even if the spec is offloaded.
+  const std::vector<ObjectID> &GetDependencies(const TaskID &task_id) const;
+
+  /// Remove the spec of a task. This is a no-op if the task is not in the store.
+  void Remove(const TaskID &task_id);
+
+  /// Start to compact the offload file, if the removed specs take most of it and it
+  /// isn't being compacted already.
+  ///
+  /// \return The compaction to run and then pass to FinishCompaction(), or null.
+  std::unique_ptr<Compaction> StartCompaction();
+
+  /// Switch the specs that are still offloaded to the file written by a compaction.
+  /// Nothing changes if the compaction failed, or if the offload file was replaced
+  /// since it started.
+  void FinishCompaction(Compaction &compaction);
+
+  /// Whether specs can be offloaded to disk. This becomes false if writing to the
+  /// offload file fails.
+  bool OffloadEnabled() const { return !offload_path_.empty() && !offload_failed_; }
+
+  /// Offload the oldest specs that are in memory to disk, until at least
+  /// `min_bytes_to_offload` bytes of specs, as counted by SpecBytes(), are offloaded
+  /// or there are no specs left in memory.
+  ///
+  /// \return The number of bytes of specs offloaded. This may be less than
+  /// requested if there are not enough specs in memory or the write failed.
+  int64_t Offload(int64_t min_bytes_to_offload);
+
+  /// The number of bytes of the specs in memory, as if each of them was serialized
+  /// in full, i.e. counting the shared fields once per spec. This is the size of
+  /// the lineage that `max_lineage_bytes` limits.
+  int64_t SpecBytes() const { return spec_bytes_; }
+
+  /// The number of bytes of the serialized specs in memory, excluding the shared
+  /// fields.
+  int64_t MemoryBytes() const { return memory_bytes_; }
+
+  /// The number of bytes of the serialized shared fields.
+  int64_t SharedBytes() const { return shared_bytes_; }
+
+  /// The number of bytes of specs in the offload file, including the ones that were
+  /// removed since it was last compacted.
+  int64_t OffloadedBytes() const {
+    return offload_file_ == nullptr ? 0 : offload_file_->size;
+  }
+
+  size_t Size() const { return entries_.size(); }
+
+  size_t NumOffloaded() const { return num_offloaded_; }
+
+ private:
+  /// A file that specs are offloaded to. It's removed once neither the store nor a
+  /// reader uses it.
+  struct OffloadFile {
+    OffloadFile(std::string path, std::FILE *file, int read_fd)
+        : path(std::move(path)), file(file), read_fd(read_fd) {}
+    ~OffloadFile();
+
+    /// Append data to the file. Returns its offset, or -1 on failure.
+    int64_t Append(const std::string &data);
+
+    /// Read `data->size()` bytes at `offset`. The appended data must be flushed.
+    bool ReadAt(int64_t offset, std::string *data) const;
+
+    const std::string path;
+    /// The buffered stream that specs are appended to.
+    std::FILE *const file;
+    /// A descriptor that all the reads share, since they don't change its offset.
+    const int read_fd;
+    /// The bytes written to the file.
+    int64_t size = 0;
+  };
+
+  struct Entry {
+    /// The serialized spec without the shared fields. Empty if the spec is offloaded.
+    std::string spec;
+    /// The serialized shared fields of the spec. Points to a key of
+    /// `shared_fields_`. Null if the spec is offloaded.
+    const std::string *shared_fields = nullptr;
+    /// The offset and size of the full serialized spec in the offload file, or -1 if
+    /// the spec is in memory.
+    int64_t offset = -1;
+    int64_t size = 0;
+    std::vector<ObjectID> dependencies;
+    int32_t attempt_number = 0;
+    /// The position in `in_memory_order_`, if the spec is in memory.
+    std::list<TaskID>::iterator order_it;
+  };
+
+  /// The bytes of the serialized spec of an entry that are in memory, excluding the
+  /// shared fields.
+  static int64_t EntryBytes(const Entry &entry);
+
+  /// Take a reference to the given shared fields, adding them if they are new.
+  const std::string *AddSharedFields(std::string shared_fields);
+
+  /// Release a reference to shared fields, removing them if unused.
+  void ReleaseSharedFields(const std::string *shared_fields);
+
+  /// Open a new offload file. Returns null and disables offloading on failure.
+  std::shared_ptr<OffloadFile> OpenOffloadFile();
+
+  /// Append a full serialized spec to an offload file. Returns the offset, or -1 and
+  /// disables offloading on failure.
+  int64_t AppendToOffloadFile(OffloadFile &file, const std::string &data);
+
+  /// Flush the buffered writes to the offload file, so that they can be read back.
+  void FlushOffloadFile() const;
+
+  const std::string offload_path_;
+
+  const int64_t min_compaction_bytes_;
+
+  /// The offload file. Opened on the first offload, and replaced when it's compacted.
+  std::shared_ptr<OffloadFile> offload_file_;
+
+  /// The number of offload files opened, which makes the path of the next one unique.
+  int64_t num_offload_files_ = 0;
+
+  /// The bytes of the specs in the offload file that are still in the store.
+  int64_t offloaded_live_bytes_ = 0;
+
+  bool offload_failed_ = false;
+
+  /// Whether a compaction was started and isn't finished yet.
+  bool compacting_ = false;
+
+  absl::flat_hash_map<TaskID, Entry> entries_;
+
+  /// The serialized shared fields and the number of specs that use them. A node
+  /// map so that the keys have stable addresses.
+  absl::node_hash_map<std::string, int64_t> shared_fields_;
+
+  /// The specs that are in memory, from the oldest to the newest.
+  std::list<TaskID> in_memory_order_;
+
+  int64_t memory_bytes_ = 0;
+
+  int64_t shared_bytes_ = 0;
+
+  int64_t spec_bytes_ = 0;
+
+  size_t num_offloaded_ = 0;
+};
+
+}  // namespace core
+}  // namespace ray
@@ -430,23 +430,27 @@ void ReferenceCounter::UpdateFinishedTaskReferences(
     const rpc::Address &worker_addr,
     const ReferenceTableProto &borrowed_refs,
     std::vector<ObjectID> *deleted) {
-  absl::MutexLock lock(&mutex_);
-  for (const auto &return_id : return_ids) {
-    UpdateObjectPendingCreation(return_id, false);
-  }
-  // Must merge the borrower refs before decrementing any ref counts. This is
-  // to make sure that for serialized IDs, we increment the borrower count for
-  // the inner ID before decrementing the submitted_task_ref_count for the
-  // outer ID.
-  const auto refs = ReferenceTableFromProto(borrowed_refs);
-  if (!refs.empty()) {
-    RAY_CHECK(!WorkerID::FromBinary(worker_addr.worker_id()).IsNil());
-  }
-  for (const ObjectID &argument_id : argument_ids) {
-    MergeRemoteBorrowers(argument_id, worker_addr, refs);
-  }
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto &return_id : return_ids) {
+      UpdateObjectPendingCreation(return_id, false);
+    }
+    // Must merge the borrower refs before decrementing any ref counts. This is
+    // to make sure that for serialized IDs, we increment the borrower count for
+    // the inner ID before decrementing the submitted_task_ref_count for the
+    // outer ID.
+    const auto refs = ReferenceTableFromProto(borrowed_refs);
+    if (!refs.empty()) {
+      RAY_CHECK(!WorkerID::FromBinary(worker_addr.worker_id()).IsNil());
+    }
+    for (const ObjectID &argument_id : argument_ids) {
+      MergeRemoteBorrowers(argument_id, worker_addr, refs);
+    }
 
-  RemoveSubmittedTaskReferences(argument_ids, release_lineage, deleted);
+    RemoveSubmittedTaskReferences(argument_ids, release_lineage, deleted);
+  }
+  // Contact the new borrowers of all the arguments at once.
+  SendRefRemovedRequests();
 }
 
 int64_t ReferenceCounter::ReleaseLineageReferences(ReferenceTable::iterator ref) {
@@ -1008,15 +1012,18 @@ void ReferenceCounter::CleanupBorrowersOnRefRemoved(
     const ReferenceTable &new_borrower_refs,
     const ObjectID &object_id,
     const rpc::WorkerAddress &borrower_addr) {
-  absl::MutexLock lock(&mutex_);
-  // Merge in any new borrowers that the previous borrower learned of.
-  MergeRemoteBorrowers(object_id, borrower_addr, new_borrower_refs);
+  {
+    absl::MutexLock lock(&mutex_);
+    // Merge in any new borrowers that the previous borrower learned of.
+    MergeRemoteBorrowers(object_id, borrower_addr, new_borrower_refs);
 
-  // Erase the previous borrower.
-  auto it = object_id_refs_.find(object_id);
-  RAY_CHECK(it != object_id_refs_.end()) << object_id;
-  RAY_CHECK(it->second.mutable_borrow()->borrowers.erase(borrower_addr));
-  DeleteReferenceInternal(it, nullptr);
+    // Erase the previous borrower.
+    auto it = object_id_refs_.find(object_id);
+    RAY_CHECK(it != object_id_refs_.end()) << object_id;
+    RAY_CHECK(it->second.mutable_borrow()->borrowers.erase(borrower_addr));
+    DeleteReferenceInternal(it, nullptr);
+  }
+  SendRefRemovedRequests();
 }
 
 void ReferenceCounter::WaitForRefRemoved(const ReferenceTable::iterator &ref_it,
@@ -1034,50 +1041,66 @@ void ReferenceCounter::WaitForRefRemoved(const ReferenceTable::iterator &ref_it,
   request->set_contained_in_id(contained_in_id.Binary());
   request->set_intended_worker_id(addr.worker_id.Binary());
   request->set_subscriber_worker_id(rpc_address_.ToProto().worker_id());
-
-  // If the message is published, this callback will be invoked.
-  const auto message_published_callback =
-      [this, addr, object_id](const rpc::PubMessage &msg) {
-        RAY_CHECK(msg.has_worker_ref_removed_message());
-        const ReferenceTable new_borrower_refs =
-            ReferenceTableFromProto(msg.worker_ref_removed_message().borrowed_refs());
-        RAY_LOG(DEBUG) << "WaitForRefRemoved returned for " << object_id
-                       << ", dest=" << addr.worker_id;
-
-        CleanupBorrowersOnRefRemoved(new_borrower_refs, object_id, addr);
-        // Unsubscribe the object once the message is published.
-        RAY_CHECK(object_info_subscriber_->Unsubscribe(
-            rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL,
-            addr.ToProto(),
-            object_id.Binary()));
-      };
-
-  // If the borrower is failed, this callback will be called.
-  const auto publisher_failed_callback = [this, addr](const std::string &object_id_binary,
-                                                      const Status &) {
-    // When the request is failed, there's no new borrowers ref published from this
-    // borrower.
-    const auto object_id = ObjectID::FromBinary(object_id_binary);
-    RAY_LOG(DEBUG) << "WaitForRefRemoved failed for " << object_id
-                   << ", dest=" << addr.worker_id;
-    CleanupBorrowersOnRefRemoved({}, object_id, addr);
-  };
-
-  RAY_CHECK(
-      object_info_subscriber_->Subscribe(std::move(sub_message),
-                                         rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL,
-                                         addr.ToProto(),
-                                         object_id.Binary(),
-                                         /*subscribe_done_callback=*/nullptr,
-                                         message_published_callback,
-                                         publisher_failed_callback));
+  ref_removed_requests_[addr].emplace_back(object_id.Binary(), std::move(sub_message));
+}
+
+void ReferenceCounter::SendRefRemovedRequests() {
+  absl::flat_hash_map<
+      rpc::WorkerAddress,
+      std::vector<std::pair<std::string, std::unique_ptr<rpc::SubMessage>>>>
+      requests;
+  {
+    absl::MutexLock lock(&mutex_);
+    requests.swap(ref_removed_requests_);
+  }
+
+  for (auto &[addr, sub_messages] : requests) {
+    // If the message is published, this callback will be invoked.
+    const auto message_published_callback = [this, addr = addr](
+                                                const rpc::PubMessage &msg) {
+      RAY_CHECK(msg.has_worker_ref_removed_message());
+      const auto object_id = ObjectID::FromBinary(msg.key_id());
+      const ReferenceTable new_borrower_refs =
+          ReferenceTableFromProto(msg.worker_ref_removed_message().borrowed_refs());
+      RAY_LOG(DEBUG) << "WaitForRefRemoved returned for " << object_id
+                     << ", dest=" << addr.worker_id;
+
+      CleanupBorrowersOnRefRemoved(new_borrower_refs, object_id, addr);
+      // Unsubscribe the object once the message is published.
+      RAY_CHECK(object_info_subscriber_->Unsubscribe(
+          rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL, addr.ToProto(), msg.key_id()));
+    };
+
+    // If the borrower is failed, this callback will be called.
+    const auto publisher_failed_callback =
+        [this, addr = addr](const std::string &object_id_binary, const Status &) {
+          // When the request is failed, there's no new borrowers ref published from
+          // this borrower.
+          const auto object_id = ObjectID::FromBinary(object_id_binary);
+          RAY_LOG(DEBUG) << "WaitForRefRemoved failed for " << object_id
+                         << ", dest=" << addr.worker_id;
+          CleanupBorrowersOnRefRemoved({}, object_id, addr);
+        };
+
+    RAY_LOG(DEBUG) << "Sending " << sub_messages.size()
+                   << " WaitForRefRemoved requests to " << addr.worker_id;
+    RAY_CHECK(object_info_subscriber_->SubscribeBatch(
+        std::move(sub_messages),
+        rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL,
+        addr.ToProto(),
+        message_published_callback,
+        publisher_failed_callback));
+  }
 }
 
 void ReferenceCounter::AddNestedObjectIds(const ObjectID &object_id,
                                           const std::vector<ObjectID> &inner_ids,
                                           const rpc::WorkerAddress &owner_address) {
-  absl::MutexLock lock(&mutex_);
-  AddNestedObjectIdsInternal(object_id, inner_ids, owner_address);
+  {
+    absl::MutexLock lock(&mutex_);
+    AddNestedObjectIdsInternal(object_id, inner_ids, owner_address);
+  }
+  SendRefRemovedRequests();
 }
 
 void ReferenceCounter::AddNestedObjectIdsInternal(
@@ -1366,9 +1389,17 @@ absl::optional<LocalityData> ReferenceCounter::GetLocalityData(
     node_ids.emplace(it->second.pinned_at_raylet_id.value());
   }
 
+  // Whether the node that spilled the object hasn't evicted it from memory yet.
+  const bool spilled_copy_in_memory =
+      it->second.spilled && !it->second.spilled_node_id.IsNil() &&
+      it->second.locations.contains(it->second.spilled_node_id);
+
   // We should only reach here if we have valid locality data to return.
-  absl::optional<LocalityData> locality_data(
-      {static_cast<uint64_t>(object_size), std::move(node_ids)});
+  absl::optional<LocalityData> locality_data({static_cast<uint64_t>(object_size),
+                                              std::move(node_ids),
+                                              it->second.spilled,
+                                              it->second.spilled_node_id,
+                                              spilled_copy_in_memory});
   return locality_data;
 }
 
@@ -1396,24 +1427,27 @@ bool ReferenceCounter::ReportLocalityData(const ObjectID &object_id,
 
 void ReferenceCounter::AddBorrowerAddress(const ObjectID &object_id,
                                           const rpc::Address &borrower_address) {
-  absl::MutexLock lock(&mutex_);
-  auto it = object_id_refs_.find(object_id);
-  RAY_CHECK(it != object_id_refs_.end());
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = object_id_refs_.find(object_id);
+    RAY_CHECK(it != object_id_refs_.end());
 
-  RAY_CHECK(it->second.owned_by_us)
-      << "AddBorrowerAddress should only be used for owner references.";
+    RAY_CHECK(it->second.owned_by_us)
+        << "AddBorrowerAddress should only be used for owner references.";
 
-  rpc::WorkerAddress borrower_worker_address = rpc::WorkerAddress(borrower_address);
-  RAY_CHECK(borrower_worker_address.worker_id != rpc_address_.worker_id)
-      << "The borrower cannot be the owner itself";
+    rpc::WorkerAddress borrower_worker_address = rpc::WorkerAddress(borrower_address);
+    RAY_CHECK(borrower_worker_address.worker_id != rpc_address_.worker_id)
+        << "The borrower cannot be the owner itself";
 
-  RAY_LOG(DEBUG) << "Add borrower " << borrower_address.DebugString() << " for object "
-                 << object_id;
-  auto inserted =
-      it->second.mutable_borrow()->borrowers.insert(borrower_worker_address).second;
-  if (inserted) {
-    WaitForRefRemoved(it, borrower_worker_address);
+    RAY_LOG(DEBUG) << "Add borrower " << borrower_address.DebugString() << " for object "
+                   << object_id;
+    auto inserted =
+        it->second.mutable_borrow()->borrowers.insert(borrower_worker_address).second;
+    if (inserted) {
+      WaitForRefRemoved(it, borrower_worker_address);
+    }
   }
+  SendRefRemovedRequests();
 }
 
 bool ReferenceCounter::IsObjectReconstructable(const ObjectID &object_id,
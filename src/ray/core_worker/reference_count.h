@@ -856,7 +856,8 @@ class ReferenceCounter : public ReferenceCounterInterface,
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   /// Wait for a borrower to stop using its reference. This should only be
-  /// called by the owner of the ID.
+  /// called by the owner of the ID. The request is queued, and sent along with
+  /// the other requests to the same borrower by SendRefRemovedRequests().
   /// \param[in] reference_it Iterator pointing to the reference that we own.
   /// \param[in] addr The address of the borrower.
   /// \param[in] contained_in_id Whether the owned ID was contained in another
@@ -868,6 +869,11 @@ class ReferenceCounter : public ReferenceCounterInterface,
                          const ObjectID &contained_in_id = ObjectID::Nil())
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Send the requests queued by WaitForRefRemoved(), with one subscription
+  /// batch per borrower. This must be called after releasing the lock by the
+  /// public methods that may queue requests.
+  void SendRefRemovedRequests() LOCKS_EXCLUDED(mutex_);
+
   /// Helper method to add an object that we are borrowing. This is used when
   /// deserializing IDs from a task's arguments, or when deserializing an ID
   /// during ray.get().
@@ -1010,6 +1016,13 @@ class ReferenceCounter : public ReferenceCounterInterface,
   /// due to node failure. These objects are still in scope and need to be
   /// recovered.
   std::vector<ObjectID> objects_to_recover_ GUARDED_BY(mutex_);
+
+  /// The WaitForRefRemoved requests that haven't been sent yet, by borrower.
+  /// Each request is the object ID with its subscription message.
+  absl::flat_hash_map<
+      rpc::WorkerAddress,
+      std::vector<std::pair<std::string, std::unique_ptr<rpc::SubMessage>>>>
+      ref_removed_requests_ GUARDED_BY(mutex_);
 };
 
 }  // namespace core
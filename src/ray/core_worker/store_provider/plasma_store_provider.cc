@@ -113,10 +113,13 @@ Status CoreWorkerPlasmaStoreProvider::Create(const std::shared_ptr<Buffer> &meta
                                              const ObjectID &object_id,
                                              const rpc::Address &owner_address,
                                              std::shared_ptr<Buffer> *data,
-                                             bool created_by_worker) {
+                                             bool created_by_worker,
+                                             plasma::flatbuf::CreatePriority priority,
+                                             int64_t deadline_ms) {
   auto source = plasma::flatbuf::ObjectSource::CreatedByWorker;
   if (!created_by_worker) {
     source = plasma::flatbuf::ObjectSource::RestoredFromStorage;
+    priority = plasma::flatbuf::CreatePriority::RestoredObject;
   }
   Status status =
       store_client_.CreateAndSpillIfNeeded(object_id,
@@ -126,7 +129,9 @@ Status CoreWorkerPlasmaStoreProvider::Create(const std::shared_ptr<Buffer> &meta
                                            metadata ? metadata->Size() : 0,
                                            data,
                                            source,
-                                           /*device_num=*/0);
+                                           /*device_num=*/0,
+                                           priority,
+                                           deadline_ms);
 
   if (status.IsObjectStoreFull()) {
     RAY_LOG(ERROR) << "Failed to put object " << object_id
@@ -121,12 +121,20 @@ class CoreWorkerPlasmaStoreProvider {
   /// \param[in] object_id The ID of the object.
   /// \param[in] owner_address The address of the object's owner.
   /// \param[out] data The mutable object buffer in plasma that can be written to.
+  /// \param[in] created_by_worker Whether the worker creates the object, rather than
+  /// restores it from external storage.
+  /// \param[in] priority The priority class of an object created by the worker.
+  /// \param[in] deadline_ms How long the request can wait for space in the object
+  /// store before the object is created on disk, -1 for no deadline.
   Status Create(const std::shared_ptr<Buffer> &metadata,
                 const size_t data_size,
                 const ObjectID &object_id,
                 const rpc::Address &owner_address,
                 std::shared_ptr<Buffer> *data,
-                bool created_by_worker);
+                bool created_by_worker,
+                plasma::flatbuf::CreatePriority priority =
+                    plasma::flatbuf::CreatePriority::Put,
+                int64_t deadline_ms = -1);
 
   /// Seal an object buffer created with Create().
   ///
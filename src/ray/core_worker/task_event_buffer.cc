@@ -34,11 +34,18 @@ TaskStatusEvent::TaskStatusEvent(
     absl::optional<NodeID> node_id,
     absl::optional<WorkerID> worker_id)
     : TaskEvent(task_id, job_id, attempt_number),
-      task_status_(task_status),
-      timestamp_(timestamp),
+      status_updates_({std::make_pair(task_status, timestamp)}),
       task_spec_(task_spec),
       node_id_(node_id),
-      worker_id_(worker_id) {}
+      worker_id_(worker_id) {
+  RAY_CHECK(!node_id_.has_value() || task_status == rpc::TaskStatus::SUBMITTED_TO_WORKER)
+      << "Node ID should be included when task status changes to "
+         "SUBMITTED_TO_WORKER.";
+  RAY_CHECK(!worker_id_.has_value() ||
+            task_status == rpc::TaskStatus::SUBMITTED_TO_WORKER)
+      << "Worker ID should be included when task status changes to "
+         "SUBMITTED_TO_WORKER.";
+}
 
 TaskProfileEvent::TaskProfileEvent(TaskID task_id,
                                    JobID job_id,
@@ -70,19 +77,32 @@ void TaskStatusEvent::ToRpcTaskEvents(rpc::TaskEvents *rpc_task_events) {
   auto state_updates = rpc_task_events->mutable_state_updates();
 
   if (node_id_.has_value()) {
-    RAY_CHECK(task_status_ == rpc::TaskStatus::SUBMITTED_TO_WORKER)
-        << "Node ID should be included when task status changes to "
-           "SUBMITTED_TO_WORKER.";
     state_updates->set_node_id(node_id_->Binary());
   }
 
   if (worker_id_.has_value()) {
-    RAY_CHECK(task_status_ == rpc::TaskStatus::SUBMITTED_TO_WORKER)
-        << "Worker ID should be included when task status changes to "
-           "SUBMITTED_TO_WORKER.";
     state_updates->set_worker_id(worker_id_->Binary());
   }
-  gcs::FillTaskStatusUpdateTime(task_status_, timestamp_, state_updates);
+  for (const auto &[task_status, timestamp] : status_updates_) {
+    gcs::FillTaskStatusUpdateTime(task_status, timestamp, state_updates);
+  }
+}
+
+void TaskStatusEvent::Aggregate(TaskStatusEvent &&other) {
+  RAY_CHECK(GetTaskAttempt() == other.GetTaskAttempt());
+  status_updates_.insert(status_updates_.end(),
+                         other.status_updates_.begin(),
+                         other.status_updates_.end());
+  other.status_updates_.clear();
+  if (task_spec_ == nullptr) {
+    task_spec_ = std::move(other.task_spec_);
+  }
+  if (other.node_id_.has_value()) {
+    node_id_ = other.node_id_;
+  }
+  if (other.worker_id_.has_value()) {
+    worker_id_ = other.worker_id_;
+  }
 }
 
 void TaskProfileEvent::ToRpcTaskEvents(rpc::TaskEvents *rpc_task_events) {
@@ -183,15 +203,53 @@ void TaskEventBufferImpl::AddTaskEvent(std::unique_ptr<TaskEvent> task_event) {
   }
   absl::MutexLock lock(&mutex_);
 
+  if (!IsSampled(*task_event)) {
+    num_task_events_sampled_out_ += task_event->NumEvents();
+    return;
+  }
+
+  TaskStatusEvent *status_event = nullptr;
+  if (!task_event->IsProfileEvent()) {
+    status_event = static_cast<TaskStatusEvent *>(task_event.get());
+    auto it = status_events_index_.find(status_event->GetTaskAttempt());
+    if (it != status_events_index_.end()) {
+      it->second->Aggregate(std::move(*status_event));
+      return;
+    }
+  }
+
   if (buffer_.full()) {
     const auto &to_evict = buffer_.front();
     if (to_evict->IsProfileEvent()) {
       num_profile_task_events_dropped_++;
     } else {
-      num_status_task_events_dropped_++;
+      num_status_task_events_dropped_ += to_evict->NumEvents();
+      status_events_index_.erase(to_evict->GetTaskAttempt());
     }
   }
   buffer_.push_back(std::move(task_event));
+  if (status_event != nullptr) {
+    status_events_index_[status_event->GetTaskAttempt()] = status_event;
+  }
+}
+
+void TaskEventBufferImpl::SetSamplingRate(const JobID &job_id, double sampling_rate) {
+  absl::MutexLock lock(&mutex_);
+  job_sampling_rates_[job_id] = sampling_rate;
+}
+
+bool TaskEventBufferImpl::IsSampled(const TaskEvent &task_event) {
+  auto it = job_sampling_rates_.find(task_event.GetJobId());
+  double sampling_rate = it != job_sampling_rates_.end()
+                             ? it->second
+                             : RayConfig::instance().task_events_sampling_rate();
+  if (sampling_rate >= 1) {
+    return true;
+  }
+  // The hash of the task id is the same on all workers, so they all record the events
+  // of the same tasks.
+  static constexpr size_t kPrecision = 1000 * 1000;
+  return task_event.GetTaskId().Hash() % kPrecision < sampling_rate * kPrecision;
 }
 
 void TaskEventBufferImpl::FlushEvents(bool forced) {
@@ -228,6 +286,12 @@ void TaskEventBufferImpl::FlushEvents(bool forced) {
                    std::make_move_iterator(buffer_.begin()),
                    std::make_move_iterator(buffer_.begin() + num_to_send));
     buffer_.erase(buffer_.begin(), buffer_.begin() + num_to_send);
+    // Later status changes of these task attempts go to new events.
+    for (const auto &task_event : to_send) {
+      if (!task_event->IsProfileEvent()) {
+        status_events_index_.erase(task_event->GetTaskAttempt());
+      }
+    }
 
     // Send and reset the counters
     num_profile_task_events_dropped = num_profile_task_events_dropped_;
@@ -250,7 +314,7 @@ void TaskEventBufferImpl::FlushEvents(bool forced) {
     if (task_event->IsProfileEvent()) {
       num_profile_event_to_send++;
     } else {
-      num_status_event_to_send++;
+      num_status_event_to_send += task_event->NumEvents();
     }
     task_event->ToRpcTaskEvents(events_by_task);
   }
@@ -308,7 +372,7 @@ const std::string TaskEventBufferImpl::DebugString() {
   bool grpc_in_progress;
   size_t num_status_task_events_dropped, num_profile_task_events_dropped,
       data_buffer_size;
-  uint64_t total_events_bytes, total_num_events;
+  uint64_t total_events_bytes, total_num_events, num_task_events_sampled_out;
 
   {
     absl::MutexLock lock(&mutex_);
@@ -317,6 +381,7 @@ const std::string TaskEventBufferImpl::DebugString() {
     num_profile_task_events_dropped = num_profile_task_events_dropped_;
     total_events_bytes = total_events_bytes_;
     total_num_events = total_num_events_;
+    num_task_events_sampled_out = num_task_events_sampled_out_;
     data_buffer_size = buffer_.size();
   }
 
@@ -329,7 +394,7 @@ const std::string TaskEventBufferImpl::DebugString() {
      << "\n\ttotal number of task events sent: " << total_num_events
      << "\n\tnum status task events dropped: " << num_status_task_events_dropped
      << "\n\tnum profile task events dropped: " << num_profile_task_events_dropped
-     << "\n";
+     << "\n\tnum task events sampled out: " << num_task_events_sampled_out << "\n";
 
   return ss.str();
 }
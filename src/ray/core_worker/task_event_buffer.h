@@ -19,6 +19,8 @@
 #include <string>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 #include "ray/common/asio/instrumented_io_context.h"
@@ -33,6 +35,9 @@ namespace core {
 
 namespace worker {
 
+/// A single task attempt, i.e. <task id and attempt number>.
+using TaskAttempt = std::pair<TaskID, int32_t>;
+
 /// A  wrapper class that will be converted to rpc::TaskEvents
 ///
 /// This will be created by CoreWorker and stored in TaskEventBuffer, and
@@ -57,6 +62,15 @@ class TaskEvent {
   /// If it is a profile event.
   virtual bool IsProfileEvent() const = 0;
 
+  /// The number of events this holds, which is more than 1 for aggregated events.
+  virtual size_t NumEvents() const = 0;
+
+  const TaskID &GetTaskId() const { return task_id_; }
+
+  const JobID &GetJobId() const { return job_id_; }
+
+  TaskAttempt GetTaskAttempt() const { return std::make_pair(task_id_, attempt_number_); }
+
  protected:
   /// Task Id.
   const TaskID task_id_ = TaskID::Nil();
@@ -67,6 +81,9 @@ class TaskEvent {
 };
 
 /// TaskStatusEvent is generated when a task changes its status.
+///
+/// The status changes of a task attempt that are buffered at the same time are
+/// aggregated into a single TaskStatusEvent, see `Aggregate`.
 class TaskStatusEvent : public TaskEvent {
  public:
   explicit TaskStatusEvent(
@@ -83,17 +100,22 @@ class TaskStatusEvent : public TaskEvent {
 
   bool IsProfileEvent() const override { return false; }
 
+  size_t NumEvents() const override { return status_updates_.size(); }
+
+  /// Add the status changes of a later event of the same task attempt to this one.
+  ///
+  /// \param other The later event, which is left empty.
+  void Aggregate(TaskStatusEvent &&other);
+
  private:
-  /// The task status change if it's a status change event.
-  const rpc::TaskStatus task_status_ = rpc::TaskStatus::NIL;
-  /// The time when the task status change happens.
-  const int64_t timestamp_ = -1;
+  /// The task status changes, and the time when they happened.
+  absl::InlinedVector<std::pair<rpc::TaskStatus, int64_t>, 2> status_updates_;
   /// Pointer to the task spec.
-  const std::shared_ptr<const TaskSpecification> task_spec_ = nullptr;
-  /// Node id if it's a SUBMITTED_TO_WORKER status change.
-  const absl::optional<NodeID> node_id_ = absl::nullopt;
-  /// Worker id if it's a SUBMITTED_TO_WORKER status change.
-  const absl::optional<WorkerID> worker_id_ = absl::nullopt;
+  std::shared_ptr<const TaskSpecification> task_spec_ = nullptr;
+  /// Node id if there's a SUBMITTED_TO_WORKER status change.
+  absl::optional<NodeID> node_id_ = absl::nullopt;
+  /// Worker id if there's a SUBMITTED_TO_WORKER status change.
+  absl::optional<WorkerID> worker_id_ = absl::nullopt;
 };
 
 /// TaskProfileEvent is generated when `RAY_enable_timeline` is on.
@@ -112,6 +134,8 @@ class TaskProfileEvent : public TaskEvent {
 
   bool IsProfileEvent() const override { return true; }
 
+  size_t NumEvents() const override { return 1; }
+
   void SetEndTime(int64_t end_time) { end_time_ = end_time; }
 
   void SetExtraData(const std::string &extra_data) { extra_data_ = extra_data; }
@@ -140,6 +164,20 @@ class TaskProfileEvent : public TaskEvent {
 ///   in the buffer, any new task events will be dropped. In this case, the number of
 ///   dropped task events will also be included in the next flush to surface this.
 ///
+/// Sampling of task events
+/// =======================
+/// Only the events of a fraction of the tasks are recorded, given by
+/// `RAY_task_events_sampling_rate` or the sampling rate of the job, see
+/// `SetSamplingRate`. Whether a task is sampled only depends on its task id, so all the
+/// events of a task are recorded or none are, by all the workers. Tasks that aren't
+/// sampled are not reported as data loss.
+///
+/// Aggregation of status events
+/// ============================
+/// Status changes of a task attempt that are in the buffer at the same time are kept
+/// as a single event, so that it takes a single slot in the buffer and is converted to
+/// a single rpc::TaskEvents.
+///
 /// No overloading of GCS
 /// =====================
 /// If GCS failed to respond quickly enough to the previous report, reporting of events to
@@ -153,6 +191,13 @@ class TaskEventBuffer {
   /// \param task_events Task events.
   virtual void AddTaskEvent(std::unique_ptr<TaskEvent> task_event) = 0;
 
+  /// Set the sampling rate of the task events of a job.
+  ///
+  /// \param job_id The job.
+  /// \param sampling_rate The fraction of the tasks of the job whose events are
+  /// recorded, from 0 to 1. It overrides `RAY_task_events_sampling_rate`.
+  virtual void SetSamplingRate(const JobID &job_id, double sampling_rate) = 0;
+
   /// Flush all task events stored in the buffer to GCS.
   ///
   /// This function will be called periodically configured by
@@ -208,6 +253,9 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   void AddTaskEvent(std::unique_ptr<TaskEvent> task_event)
       LOCKS_EXCLUDED(mutex_) override;
 
+  void SetSamplingRate(const JobID &job_id, double sampling_rate)
+      LOCKS_EXCLUDED(mutex_) override;
+
   void FlushEvents(bool forced) LOCKS_EXCLUDED(mutex_) override;
 
   Status Start(bool auto_flush = true) LOCKS_EXCLUDED(mutex_) override;
@@ -219,6 +267,9 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   const std::string DebugString() LOCKS_EXCLUDED(mutex_) override;
 
  private:
+  /// Whether the events of the task are recorded, given the sampling rate of its job.
+  bool IsSampled(const TaskEvent &task_event) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Test only functions.
   std::vector<std::reference_wrapper<const TaskEvent>> GetAllTaskEvents()
       LOCKS_EXCLUDED(mutex_) {
@@ -242,6 +293,12 @@ class TaskEventBufferImpl : public TaskEventBuffer {
     return num_profile_task_events_dropped_;
   }
 
+  /// Test only functions.
+  size_t GetNumTaskEventsSampledOut() LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    return num_task_events_sampled_out_;
+  }
+
   /// Test only functions.
   gcs::GcsClient *GetGcsClient() {
     absl::MutexLock lock(&mutex_);
@@ -272,6 +329,18 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   /// Circular buffered task events.
   boost::circular_buffer<std::unique_ptr<TaskEvent>> buffer_ GUARDED_BY(mutex_);
 
+  /// The status event of each task attempt in `buffer_`, which later status changes of
+  /// the task attempt are aggregated into.
+  absl::flat_hash_map<TaskAttempt, TaskStatusEvent *> status_events_index_
+      GUARDED_BY(mutex_);
+
+  /// The sampling rates of the jobs that override `RAY_task_events_sampling_rate`.
+  absl::flat_hash_map<JobID, double> job_sampling_rates_ GUARDED_BY(mutex_);
+
+  /// Debug stats: total number of task events not recorded because their task isn't
+  /// sampled.
+  uint64_t num_task_events_sampled_out_ GUARDED_BY(mutex_) = 0;
+
   /// Number of profile task events dropped since the last report flush.
   size_t num_profile_task_events_dropped_ GUARDED_BY(mutex_) = 0;
 
@@ -297,6 +366,9 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   FRIEND_TEST(TaskEventBufferTest, TestBackPressure);
   FRIEND_TEST(TaskEventBufferTest, TestForcedFlush);
   FRIEND_TEST(TaskEventBufferTest, TestBufferSizeLimit);
+  FRIEND_TEST(TaskEventBufferTest, TestAggregateStatusEvents);
+  FRIEND_TEST(TaskEventBufferTest, TestSampling);
+  FRIEND_TEST(TaskEventBufferTest, FlushBenchmark);
 };
 
 }  // namespace worker
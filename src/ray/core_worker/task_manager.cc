@@ -14,6 +14,8 @@
 
 #include "ray/core_worker/task_manager.h"
 
+#include <boost/asio/post.hpp>
+
 #include "ray/common/buffer.h"
 #include "ray/common/common_protocol.h"
 #include "ray/common/constants.h"
@@ -126,15 +128,15 @@ bool TaskManager::ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *tas
 
     if (!it->second.IsPending()) {
       resubmit = true;
+      // The task is pending again, so it's no longer kept as lineage. If the
+      // task finishes and we still need the spec, we'll add it back to the
+      // lineage store.
+      it->second.spec = lineage_store_.Get(task_id);
+      lineage_store_.Remove(task_id);
+      MaybeCompactLineage();
       MarkTaskRetryOnResubmit(it->second);
       num_pending_tasks_++;
 
-      // The task is pending again, so it's no longer counted as lineage. If
-      // the task finishes and we still need the spec, we'll add the task back
-      // to the footprint sum.
-      total_lineage_footprint_bytes_ -= it->second.lineage_footprint_bytes;
-      it->second.lineage_footprint_bytes = 0;
-
       if (it->second.num_retries_left > 0) {
         it->second.num_retries_left--;
       } else {
@@ -351,7 +353,7 @@ void TaskManager::CompletePendingTask(const TaskID &task_id,
     auto it = submissible_tasks_.find(task_id);
     RAY_CHECK(it != submissible_tasks_.end())
         << "Tried to complete task that was not pending " << task_id;
-    spec = it->second.spec;
+    spec = GetTaskSpecInternal(task_id, it->second);
 
     // Record any dynamically returned objects. We need to store these with the
     // task spec so that the worker will recreate them if the task gets
@@ -393,18 +395,29 @@ void TaskManager::CompletePendingTask(const TaskID &task_id,
     bool task_retryable = it->second.num_retries_left != 0 &&
                           !it->second.reconstructable_return_ids.empty();
     if (task_retryable) {
-      // Pin the task spec if it may be retried again.
+      // Pin the task spec if it may be retried again. Only the compact copy in
+      // the lineage store is kept.
       release_lineage = false;
-      it->second.lineage_footprint_bytes = it->second.spec.GetMessage().ByteSizeLong();
-      total_lineage_footprint_bytes_ += it->second.lineage_footprint_bytes;
-      if (total_lineage_footprint_bytes_ > max_lineage_bytes_) {
-        RAY_LOG(INFO) << "Total lineage size is " << total_lineage_footprint_bytes_ / 1e6
+      lineage_store_.Put(spec);
+      it->second.spec = TaskSpecification();
+      const int64_t total_lineage_footprint_bytes = LineageFootprintBytes();
+      if (total_lineage_footprint_bytes > max_lineage_bytes_) {
+        RAY_LOG(INFO) << "Total lineage size is " << total_lineage_footprint_bytes / 1e6
                       << "MB, which exceeds the limit of " << max_lineage_bytes_ / 1e6
                       << "MB";
         min_lineage_bytes_to_evict =
-            total_lineage_footprint_bytes_ - (max_lineage_bytes_ / 2);
+            total_lineage_footprint_bytes - (max_lineage_bytes_ / 2);
+        if (lineage_store_.OffloadEnabled()) {
+          // Offload the oldest lineage to disk instead of evicting it, so that it
+          // can still be used for reconstruction.
+          auto bytes_offloaded = lineage_store_.Offload(min_lineage_bytes_to_evict);
+          RAY_LOG(INFO) << "Offloaded " << bytes_offloaded / 1e6
+                        << "MB of task lineage to disk.";
+          min_lineage_bytes_to_evict -= bytes_offloaded;
+        }
       }
     } else {
+      lineage_store_.Remove(task_id);
       submissible_tasks_.erase(it);
     }
   }
@@ -505,8 +518,9 @@ void TaskManager::FailPendingTask(const TaskID &task_id,
         << "Tried to fail task that was not pending " << task_id;
     RAY_CHECK(it->second.IsPending())
         << "Tried to fail task that was not pending " << task_id;
-    spec = it->second.spec;
+    spec = GetTaskSpecInternal(task_id, it->second);
     SetTaskStatus(it->second, rpc::TaskStatus::FAILED);
+    lineage_store_.Remove(task_id);
     submissible_tasks_.erase(it);
     num_pending_tasks_--;
 
@@ -641,7 +655,7 @@ void TaskManager::RemoveFinishedTaskReferences(
 int64_t TaskManager::RemoveLineageReference(const ObjectID &object_id,
                                             std::vector<ObjectID> *released_objects) {
   absl::MutexLock lock(&mu_);
-  const int64_t total_lineage_footprint_bytes_prev(total_lineage_footprint_bytes_);
+  const int64_t total_lineage_footprint_bytes_prev(LineageFootprintBytes());
 
   const TaskID &task_id = object_id.TaskId();
   auto it = submissible_tasks_.find(task_id);
@@ -661,25 +675,35 @@ int64_t TaskManager::RemoveLineageReference(const ObjectID &object_id,
 
   if (it->second.reconstructable_return_ids.empty() && !it->second.IsPending()) {
     // If the task can no longer be retried, decrement the lineage ref count
-    // for each of the task's args.
-    for (size_t i = 0; i < it->second.spec.NumArgs(); i++) {
-      if (it->second.spec.ArgByRef(i)) {
-        released_objects->push_back(it->second.spec.ArgId(i));
-      } else {
-        const auto &inlined_refs = it->second.spec.ArgInlinedRefs(i);
-        for (const auto &inlined_ref : inlined_refs) {
-          released_objects->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
-        }
-      }
-    }
+    // for each of the task's args. These are kept in memory, so this doesn't
+    // read back offloaded lineage.
+    const auto &dependencies = lineage_store_.GetDependencies(task_id);
+    released_objects->insert(
+        released_objects->end(), dependencies.begin(), dependencies.end());
 
-    total_lineage_footprint_bytes_ -= it->second.lineage_footprint_bytes;
     // The task has finished and none of the return IDs are in scope anymore,
     // so it is safe to remove the task spec.
+    lineage_store_.Remove(task_id);
+    MaybeCompactLineage();
     submissible_tasks_.erase(it);
   }
 
-  return total_lineage_footprint_bytes_ - total_lineage_footprint_bytes_prev;
+  return LineageFootprintBytes() - total_lineage_footprint_bytes_prev;
+}
+
+void TaskManager::MaybeCompactLineage() {
+  std::shared_ptr<LineageStore::Compaction> compaction =
+      lineage_store_.StartCompaction();
+  if (compaction == nullptr) {
+    return;
+  }
+  // Copying the offloaded lineage reads and writes the whole file, so it's done
+  // in the background, without holding mu_.
+  boost::asio::post(*lineage_compaction_thread_, [this, compaction]() {
+    compaction->Run();
+    absl::MutexLock lock(&mu_);
+    lineage_store_.FinishCompaction(*compaction);
+  });
 }
 
 bool TaskManager::MarkTaskCanceled(const TaskID &task_id) {
@@ -745,7 +769,15 @@ absl::optional<TaskSpecification> TaskManager::GetTaskSpec(const TaskID &task_id
   if (it == submissible_tasks_.end()) {
     return absl::optional<TaskSpecification>();
   }
-  return it->second.spec;
+  return GetTaskSpecInternal(task_id, it->second);
+}
+
+TaskSpecification TaskManager::GetTaskSpecInternal(const TaskID &task_id,
+                                                   const TaskEntry &task_entry) const {
+  if (lineage_store_.Contains(task_id)) {
+    return lineage_store_.Get(task_id);
+  }
+  return task_entry.spec;
 }
 
 std::vector<TaskID> TaskManager::GetPendingChildrenTasks(
@@ -753,7 +785,8 @@ std::vector<TaskID> TaskManager::GetPendingChildrenTasks(
   std::vector<TaskID> ret_vec;
   absl::MutexLock lock(&mu_);
   for (auto it : submissible_tasks_) {
-    if (it.second.IsPending() && (it.second.spec.ParentTaskId() == parent_task_id)) {
+    if (it.second.IsPending() &&
+        GetTaskSpecInternal(it.first, it.second).ParentTaskId() == parent_task_id) {
       ret_vec.push_back(it.first);
     }
   }
@@ -771,7 +804,10 @@ void TaskManager::AddTaskStatusInfo(rpc::CoreWorkerStats *stats) const {
       continue;
     }
     ref->set_task_status(it->second.GetStatus());
-    ref->set_attempt_number(it->second.spec.AttemptNumber());
+    // Don't read back the spec of a finished task just for its attempt number.
+    ref->set_attempt_number(lineage_store_.Contains(task_id)
+                                ? lineage_store_.GetAttemptNumber(task_id)
+                                : it->second.spec.AttemptNumber());
   }
 }
 
@@ -843,20 +879,40 @@ void TaskManager::SetTaskStatus(TaskEntry &task_entry, rpc::TaskStatus status) {
 
 void TaskManager::FillTaskInfo(rpc::GetCoreWorkerStatsReply *reply,
                                const int64_t limit) const {
-  absl::MutexLock lock(&mu_);
-  auto total = submissible_tasks_.size();
-  auto count = 0;
-  for (const auto &task_it : submissible_tasks_) {
-    if (limit != -1 && count >= limit) {
-      break;
+  // The specs of the finished tasks are parsed or read back from disk, so only take
+  // readers of them under the lock, and read them after releasing it.
+  struct TaskInfo {
+    absl::optional<TaskSpecification> spec;
+    LineageStore::SpecReader lineage_reader;
+    rpc::TaskStatus status;
+    NodeID node_id;
+  };
+  std::vector<TaskInfo> tasks;
+  size_t total = 0;
+  {
+    absl::MutexLock lock(&mu_);
+    total = submissible_tasks_.size();
+    tasks.reserve(limit == -1 ? total : std::min<size_t>(total, limit));
+    for (const auto &[task_id, task_entry] : submissible_tasks_) {
+      if (limit != -1 && static_cast<int64_t>(tasks.size()) >= limit) {
+        break;
+      }
+      auto &task = tasks.emplace_back();
+      if (lineage_store_.Contains(task_id)) {
+        task.lineage_reader = lineage_store_.GetReader(task_id);
+      } else {
+        task.spec = task_entry.spec;
+      }
+      task.status = task_entry.GetStatus();
+      task.node_id = task_entry.GetNodeId();
     }
-    count += 1;
+  }
 
-    const auto &task_entry = task_it.second;
+  for (const auto &task : tasks) {
     auto entry = reply->add_owned_task_info_entries();
-    const auto &task_spec = task_entry.spec;
-    const auto &task_state = task_entry.GetStatus();
-    const auto &node_id = task_entry.GetNodeId();
+    const auto task_spec = task.spec ? *task.spec : task.lineage_reader.Read();
+    const auto &task_state = task.status;
+    const auto &node_id = task.node_id;
     rpc::TaskType type;
     if (task_spec.IsNormalTask()) {
       type = rpc::TaskType::NORMAL_TASK;
@@ -890,6 +946,10 @@ void TaskManager::FillTaskInfo(rpc::GetCoreWorkerStatsReply *reply,
 void TaskManager::RecordMetrics() {
   absl::MutexLock lock(&mu_);
   task_counter_.FlushOnChangeCallbacks();
+  ray::stats::STATS_owner_lineage_bytes.Record(lineage_store_.MemoryBytes(), "InMemory");
+  ray::stats::STATS_owner_lineage_bytes.Record(lineage_store_.SharedBytes(), "Shared");
+  ray::stats::STATS_owner_lineage_bytes.Record(lineage_store_.OffloadedBytes(),
+                                               "Offloaded");
 }
 
 void TaskManager::RecordTaskStatusEvent(int32_t attempt_number,
@@ -920,10 +980,11 @@ ObjectID TaskManager::TaskGeneratorId(const TaskID &task_id) const {
   if (it == submissible_tasks_.end()) {
     return ObjectID::Nil();
   }
-  if (!it->second.spec.ReturnsDynamic()) {
+  const auto spec = GetTaskSpecInternal(task_id, it->second);
+  if (!spec.ReturnsDynamic()) {
     return ObjectID::Nil();
   }
-  return it->second.spec.ReturnId(0);
+  return spec.ReturnId(0);
 }
 
 }  // namespace core
@@ -14,11 +14,14 @@
 
 #pragma once
 
+#include <boost/asio/thread_pool.hpp>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task.h"
+#include "ray/core_worker/lineage_store.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
 #include "ray/stats/metric_defs.h"
@@ -95,14 +98,19 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
               RetryTaskCallback retry_task_callback,
               PushErrorCallback push_error_callback,
               int64_t max_lineage_bytes,
-              worker::TaskEventBuffer &task_event_buffer)
+              worker::TaskEventBuffer &task_event_buffer,
+              std::string lineage_offload_path = "")
       : in_memory_store_(in_memory_store),
         reference_counter_(reference_counter),
         put_in_local_plasma_callback_(put_in_local_plasma_callback),
         retry_task_callback_(retry_task_callback),
         push_error_callback_(push_error_callback),
         max_lineage_bytes_(max_lineage_bytes),
+        lineage_store_(std::move(lineage_offload_path)),
         task_event_buffer_(task_event_buffer) {
+    if (lineage_store_.OffloadEnabled()) {
+      lineage_compaction_thread_ = std::make_unique<boost::asio::thread_pool>(1);
+    }
     task_counter_.SetOnChangeCallback(
         [this](const std::tuple<std::string, rpc::TaskStatus, bool> key)
             EXCLUSIVE_LOCKS_REQUIRED(&mu_) {
@@ -274,9 +282,10 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// Return the number of pending tasks.
   size_t NumPendingTasks() const;
 
+  /// Return the number of bytes of memory used by the lineage of finished tasks.
   int64_t TotalLineageFootprintBytes() const {
     absl::MutexLock lock(&mu_);
-    return total_lineage_footprint_bytes_;
+    return LineageFootprintBytes();
   }
 
   /// Record that the given task's dependencies have been created and the task
@@ -349,7 +358,7 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
     }
 
     void SetStatus(rpc::TaskStatus new_status) {
-      auto new_tuple = std::make_tuple(spec.GetName(), new_status, is_retry_);
+      auto new_tuple = std::make_tuple(std::get<0>(status), new_status, is_retry_);
       counter.Swap(status, new_tuple);
       status = new_tuple;
     }
@@ -359,7 +368,7 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
       // is retried N times, we show it as N separate task counts.
       // Note that the increment is for the "previous" task attempt. From now on, this
       // task entry will report metrics or the "current" task attempt.
-      counter.Increment({spec.GetName(), rpc::TaskStatus::FAILED, is_retry_});
+      counter.Increment({std::get<0>(status), rpc::TaskStatus::FAILED, is_retry_});
       is_retry_ = true;
     }
 
@@ -368,7 +377,7 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
       // is resubmitted N times, we show it as N separate task counts.
       // Note that the increment is for the "previous" task attempt. From now on, this
       // task entry will report metrics or the "current" task attempt.
-      counter.Increment({spec.GetName(), rpc::TaskStatus::FINISHED, is_retry_});
+      counter.Increment({std::get<0>(status), rpc::TaskStatus::FINISHED, is_retry_});
       is_retry_ = true;
     }
 
@@ -385,18 +394,19 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
       return GetStatus() == rpc::TaskStatus::SUBMITTED_TO_WORKER;
     }
 
-    /// The task spec. This is pinned as long as the following are true:
-    /// - The task is still pending execution. This means that the task may
-    /// fail and so it may be retried in the future.
-    /// - The task finished execution, but it has num_retries_left > 0 and
-    /// reconstructable_return_ids is not empty. This means that the task may
-    /// be retried in the future to recreate its return objects.
+    /// The task spec. This is pinned as long as the task is still pending
+    /// execution. This means that the task may fail and so it may be retried in
+    /// the future.
+    /// If the task finished execution, but it has num_retries_left > 0 and
+    /// reconstructable_return_ids is not empty, the task may be retried in the
+    /// future to recreate its return objects. In that case the spec is moved to
+    /// the lineage store and this is reset, until the task is resubmitted.
     /// TODO(swang): The TaskSpec protobuf must be copied into the
     /// PushTaskRequest protobuf when sent to a worker so that we can retry it if
     /// the worker fails. We could avoid this by either not caching the full
     /// TaskSpec for tasks that cannot be retried (e.g., actor tasks), or by
     /// storing a shared_ptr to a PushTaskRequest protobuf for all tasks.
-    const TaskSpecification spec;
+    TaskSpecification spec;
     // Number of times this task may be resubmitted. If this reaches 0, then
     // the task entry may be erased.
     int32_t num_retries_left;
@@ -417,11 +427,6 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
     //    pending tasks and tasks that finished execution but that may be
     //    retried in the future.
     absl::flat_hash_set<ObjectID> reconstructable_return_ids;
-    // The size of this (serialized) task spec in bytes, if the task spec is
-    // not pending, i.e. it is being pinned because it's in another object's
-    // lineage. We cache this because the task spec protobuf can mutate
-    // out-of-band.
-    int64_t lineage_footprint_bytes = 0;
     // Number of times this task successfully completed execution so far.
     int num_successful_executions = 0;
 
@@ -480,6 +485,22 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// Shutdown if all tasks are finished and shutdown is scheduled.
   void ShutdownIfNeeded() LOCKS_EXCLUDED(mu_);
 
+  /// Get the spec of a task, reading it back from the lineage store if the task
+  /// finished execution and is only kept as lineage.
+  TaskSpecification GetTaskSpecInternal(const TaskID &task_id,
+                                        const TaskEntry &task_entry) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// The size of the specs of the finished tasks that are kept in memory as
+  /// lineage. This is what max_lineage_bytes_ limits.
+  int64_t LineageFootprintBytes() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return lineage_store_.SpecBytes();
+  }
+
+  /// Compact the lineage offload file on the compaction thread if it's due. The
+  /// offloaded specs are copied without holding mu_.
+  void MaybeCompactLineage() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Set the TaskStatus
   ///
   /// Sets the task status on the TaskEntry, and record the task status change events in
@@ -550,7 +571,9 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// execution.
   size_t num_pending_tasks_ = 0;
 
-  int64_t total_lineage_footprint_bytes_ GUARDED_BY(mu_) = 0;
+  /// The specs of the tasks in submissible_tasks_ that finished execution, but
+  /// may be retried to recreate their return objects.
+  LineageStore lineage_store_ GUARDED_BY(mu_);
 
   /// Optional shutdown hook to call when pending tasks all finish.
   std::function<void()> shutdown_hook_ GUARDED_BY(mu_) = nullptr;
@@ -560,6 +583,11 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// error).
   worker::TaskEventBuffer &task_event_buffer_;
 
+  /// The thread that compacts the lineage offload file, if lineage is offloaded.
+  /// This is the last field, so that a running compaction finishes before the
+  /// lineage store is destroyed.
+  std::unique_ptr<boost::asio::thread_pool> lineage_compaction_thread_;
+
   friend class TaskManagerTest;
 };
 
@@ -14,6 +14,8 @@
 
 #include "ray/core_worker/transport/direct_task_transport.h"
 
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
 #include "gtest/gtest.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/task/task_util.h"
@@ -229,6 +231,17 @@ class MockRayletClient : public WorkerLeaseInterface {
     callbacks.push_back(callback);
   }
 
+  void RequestWorkerLeases(
+      const rpc::TaskSpec &resource_spec,
+      const std::vector<TaskID> &lease_ids,
+      const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeasesReply> &callback,
+      const int64_t backlog_size,
+      const bool is_selected_based_on_locality) override {
+    num_multi_lease_requests += 1;
+    num_workers_requested += lease_ids.size();
+    multi_lease_callbacks.emplace_back(lease_ids.size(), callback);
+  }
+
   void ReleaseUnusedWorkers(
       const std::vector<WorkerID> &workers_in_use,
       const rpc::ClientCallback<rpc::ReleaseUnusedWorkersReply> &callback) override {}
@@ -280,6 +293,30 @@ class MockRayletClient : public WorkerLeaseInterface {
     }
   }
 
+  // Trigger reply to RequestWorkerLeases. The first `num_granted` leases are granted
+  // workers on consecutive ports starting at `port`, the rest are rejected.
+  bool ReplyWorkerLeases(const std::string &address, int port, size_t num_granted) {
+    if (multi_lease_callbacks.empty()) {
+      return false;
+    }
+    auto num_leases = multi_lease_callbacks.front().first;
+    auto callback = multi_lease_callbacks.front().second;
+    multi_lease_callbacks.pop_front();
+    rpc::RequestWorkerLeasesReply reply;
+    for (size_t i = 0; i < num_leases; i++) {
+      auto lease_reply = reply.add_lease_replies();
+      if (i < num_granted) {
+        lease_reply->mutable_worker_address()->set_ip_address(address);
+        lease_reply->mutable_worker_address()->set_port(port + i);
+        lease_reply->mutable_worker_address()->set_raylet_id(NodeID::Nil().Binary());
+      } else {
+        lease_reply->set_rejected(true);
+      }
+    }
+    callback(Status::OK(), reply);
+    return true;
+  }
+
   bool FailWorkerLeaseDueToGrpcUnavailable() {
     rpc::RequestWorkerLeaseReply reply;
     if (callbacks.size() == 0) {
@@ -310,6 +347,7 @@ class MockRayletClient : public WorkerLeaseInterface {
   int num_grant_or_reject_leases_requested = 0;
   int num_is_selected_based_on_locality_leases_requested = 0;
   int num_workers_requested = 0;
+  int num_multi_lease_requests = 0;
   int num_workers_returned = 0;
   int num_workers_returned_exiting = 0;
   int num_workers_disconnected = 0;
@@ -318,6 +356,8 @@ class MockRayletClient : public WorkerLeaseInterface {
   int reported_backlog_size = 0;
   std::map<SchedulingClass, int64_t> reported_backlogs;
   std::list<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>> callbacks = {};
+  std::list<std::pair<size_t, rpc::ClientCallback<rpc::RequestWorkerLeasesReply>>>
+      multi_lease_callbacks = {};
   std::list<rpc::ClientCallback<rpc::CancelWorkerLeaseReply>> cancel_callbacks = {};
   std::list<rpc::ClientCallback<rpc::GetTaskFailureCauseReply>>
       get_task_failure_cause_callbacks = {};
@@ -369,6 +409,10 @@ class MockLeasePolicy : public LeasePolicyInterface {
     return std::make_pair(fallback_rpc_address_, is_locality_aware);
   };
 
+  void OnTaskPushed(const TaskSpecification &spec, const NodeID &node_id) {}
+
+  void OnTaskFinished(const TaskID &task_id) {}
+
   ~MockLeasePolicy() {}
 
   rpc::Address fallback_rpc_address_;
@@ -891,6 +935,252 @@ TEST(DirectTaskTransportTest, TestConcurrentWorkerLeases) {
   ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
 }
 
+// Tests that change max_leases_per_request. The config is reset after each test,
+// even if it fails.
+class MultiLeaseRequestTest : public ::testing::Test {
+ protected:
+  void TearDown() override { RayConfig::instance().initialize(""); }
+};
+
+TEST_F(MultiLeaseRequestTest, TestMultiLeaseRequests) {
+  RayConfig::instance().initialize(R"({"max_leases_per_request": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+  }
+  // The first task is queued alone, so it gets a single lease request.
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 0);
+
+  // Once the first lease is granted, the queued tasks get a multi-lease request.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 1);
+  ASSERT_EQ(raylet_client->num_workers_requested, 5);
+
+  // A partial grant. The rejected leases are requested again, along with the other
+  // queued tasks, in the next request.
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 2000, /*num_granted=*/2));
+  ASSERT_EQ(worker_client->callbacks.size(), 3);
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 2);
+  ASSERT_EQ(raylet_client->num_workers_requested, 9);
+
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 3000, /*num_granted=*/4));
+  ASSERT_EQ(worker_client->callbacks.size(), 7);
+  // Only 3 tasks are left without a worker.
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 3);
+  ASSERT_EQ(raylet_client->num_workers_requested, 12);
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 4000, /*num_granted=*/3));
+  ASSERT_EQ(worker_client->callbacks.size(), 10);
+  ASSERT_FALSE(raylet_client->ReplyWorkerLeases("localhost", 5000, 0));
+
+  while (!worker_client->callbacks.empty()) {
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+  }
+  ASSERT_EQ(raylet_client->num_workers_returned, 10);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 10);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 0);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST_F(MultiLeaseRequestTest, TestMultiLeaseRequestCancellation) {
+  RayConfig::instance().initialize(R"({"max_leases_per_request": 4})");
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter);
+
+  std::vector<TaskSpecification> tasks;
+  for (int i = 0; i < 5; i++) {
+    tasks.push_back(BuildEmptyTaskSpec());
+    ASSERT_TRUE(submitter.SubmitTask(tasks.back()).ok());
+  }
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 1);
+
+  // Cancel the queued tasks. Each lease of the multi-lease request is canceled.
+  for (int i = 1; i < 5; i++) {
+    ASSERT_TRUE(submitter.CancelTask(tasks[i], false, false).ok());
+  }
+  ASSERT_EQ(raylet_client->num_leases_canceled, 4);
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 2000, /*num_granted=*/1));
+  // The worker that was granted anyway is returned right away.
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 1);
+
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+// Multi-lease requests need fewer lease RPCs when a fan-out stage needs a worker per
+// task.
+TEST_F(MultiLeaseRequestTest, TestMultiLeaseRequestsReduceLeaseRpcs) {
+  const int kNumTasks = 100;
+  for (int max_leases_per_request : {1, 16}) {
+    RayConfig::instance().initialize(
+        absl::StrFormat(R"({"max_leases_per_request": %d})", max_leases_per_request));
+    rpc::Address address;
+    auto raylet_client = std::make_shared<MockRayletClient>();
+    auto worker_client = std::make_shared<MockWorkerClient>();
+    auto store = std::make_shared<CoreWorkerMemoryStore>();
+    auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+        [&](const rpc::Address &addr) { return worker_client; });
+    auto task_finisher = std::make_shared<MockTaskFinisher>();
+    auto actor_creator = std::make_shared<MockActorCreator>();
+    auto lease_policy = std::make_shared<MockLeasePolicy>();
+    CoreWorkerDirectTaskSubmitter submitter(address,
+                                            raylet_client,
+                                            client_pool,
+                                            nullptr,
+                                            lease_policy,
+                                            store,
+                                            task_finisher,
+                                            NodeID::Nil(),
+                                            WorkerType::WORKER,
+                                            kLongTimeout,
+                                            actor_creator,
+                                            JobID::Nil(),
+                                            kOneRateLimiter);
+
+    for (int i = 0; i < kNumTasks; i++) {
+      ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+    }
+    // The tasks run long enough that every task needs a worker of its own.
+    int port = 0;
+    int num_lease_rpcs = 0;
+    while (worker_client->callbacks.size() < static_cast<size_t>(kNumTasks)) {
+      if (raylet_client->GrantWorkerLease("localhost", port, NodeID::Nil())) {
+        port++;
+      } else {
+        ASSERT_FALSE(raylet_client->multi_lease_callbacks.empty());
+        auto num_leases = raylet_client->multi_lease_callbacks.front().first;
+        ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", port, num_leases));
+        port += num_leases;
+      }
+      num_lease_rpcs++;
+    }
+    // The first task is queued alone. The others are requested in full batches.
+    const int expected_num_lease_rpcs =
+        1 + (kNumTasks - 1 + max_leases_per_request - 1) / max_leases_per_request;
+    ASSERT_EQ(num_lease_rpcs, expected_num_lease_rpcs);
+    ASSERT_EQ(raylet_client->num_workers_requested, kNumTasks);
+
+    while (!worker_client->callbacks.empty()) {
+      ASSERT_TRUE(worker_client->ReplyPushTask());
+    }
+    ASSERT_EQ(task_finisher->num_tasks_complete, kNumTasks);
+    ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+  }
+}
+
+TEST_F(MultiLeaseRequestTest, TestRejectedLeasesBackoff) {
+  RayConfig::instance().initialize(
+      R"({"max_leases_per_request": 4,
+          "lease_rejection_retry_initial_delay_ms": 50,
+          "lease_rejection_retry_max_delay_ms": 100})");
+  instrumented_io_context io_service;
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(address,
+                                          raylet_client,
+                                          client_pool,
+                                          nullptr,
+                                          lease_policy,
+                                          store,
+                                          task_finisher,
+                                          NodeID::Nil(),
+                                          WorkerType::WORKER,
+                                          kLongTimeout,
+                                          actor_creator,
+                                          JobID::Nil(),
+                                          kOneRateLimiter,
+                                          boost::asio::steady_timer(io_service),
+                                          boost::asio::steady_timer(io_service));
+
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+  }
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 1);
+
+  // A partial grant. The granted worker doesn't trigger a new request, the rejected
+  // leases are requested again after the initial delay.
+  auto start = absl::Now();
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 2000, /*num_granted=*/1));
+  ASSERT_EQ(worker_client->callbacks.size(), 2);
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 1);
+  ASSERT_EQ(io_service.run_one(), 1);
+  ASSERT_GE(absl::Now() - start, absl::Milliseconds(50));
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 2);
+
+  // Rejected again. The delay doubles.
+  start = absl::Now();
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 3000, /*num_granted=*/0));
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 2);
+  ASSERT_EQ(io_service.run_one(), 1);
+  ASSERT_GE(absl::Now() - start, absl::Milliseconds(100));
+  ASSERT_EQ(raylet_client->num_multi_lease_requests, 3);
+
+  // Both leases are granted.
+  ASSERT_TRUE(raylet_client->ReplyWorkerLeases("localhost", 4000, /*num_granted=*/2));
+  ASSERT_EQ(worker_client->callbacks.size(), 4);
+  while (!worker_client->callbacks.empty()) {
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+  }
+  ASSERT_EQ(task_finisher->num_tasks_complete, 4);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 0);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
 TEST(DirectTaskTransportTest, TestConcurrentWorkerLeasesDynamic) {
   rpc::Address address;
   auto raylet_client = std::make_shared<MockRayletClient>();
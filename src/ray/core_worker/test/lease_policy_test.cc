@@ -14,7 +14,12 @@
 
 #include "ray/core_worker/lease_policy.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+
 #include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/task/task_spec.h"
 
 namespace ray {
@@ -285,5 +290,258 @@ TEST(LocalityAwareLeasePolicyTest, TestBestLocalityFallbackAddrFetchFail) {
   ASSERT_FALSE(is_selected_based_on_locality);
 }
 
+class LocalityAwareLeasePolicyCostModelTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    RayConfig::instance().locality_aware_leasing_cost_model_enabled() = true;
+  }
+
+  void TearDown() override {
+    RayConfig::instance().locality_aware_leasing_cost_model_enabled() = false;
+    RayConfig::instance().locality_aware_leasing_task_load_cost_bytes() =
+        kDefaultTaskLoadCostBytes;
+  }
+
+ protected:
+  const uint64_t kDefaultTaskLoadCostBytes =
+      RayConfig::instance().locality_aware_leasing_task_load_cost_bytes();
+};
+
+TEST_F(LocalityAwareLeasePolicyCostModelTest, TestAvoidSpilledCopy) {
+  absl::flat_hash_map<ObjectID, LocalityData> locality_data;
+  NodeID fallback_node = NodeID::FromRandom();
+  rpc::Address fallback_rpc_address = MockNodeAddrFactory(fallback_node).value();
+  NodeID spilled_node = NodeID::FromRandom();
+  NodeID best_node = NodeID::FromRandom();
+  ObjectID obj1 = ObjectID::FromRandom();
+  ObjectID obj2 = ObjectID::FromRandom();
+  // spilled_node: 100 bytes to restore from disk (cost 50), nothing to transfer.
+  // best_node:    nothing to restore, 20 bytes to transfer.
+  locality_data.emplace(
+      obj1, LocalityData{100, {spilled_node, best_node}, true, spilled_node});
+  locality_data.emplace(obj2, LocalityData{20, {spilled_node}});
+  auto mock_locality_data_provider =
+      std::make_shared<MockLocalityDataProvider>(locality_data);
+  LocalityAwareLeasePolicy locality_lease_policy(
+      mock_locality_data_provider, MockNodeAddrFactory, fallback_rpc_address);
+  auto task_spec = CreateFakeTask({obj1, obj2});
+
+  // The node with the most bytes local holds the spilled copy.
+  RayConfig::instance().locality_aware_leasing_cost_model_enabled() = false;
+  auto [best_node_address, is_selected_based_on_locality] =
+      locality_lease_policy.GetBestNodeForTask(task_spec);
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), spilled_node);
+
+  RayConfig::instance().locality_aware_leasing_cost_model_enabled() = true;
+  std::tie(best_node_address, is_selected_based_on_locality) =
+      locality_lease_policy.GetBestNodeForTask(task_spec);
+  ASSERT_EQ(mock_locality_data_provider->num_locality_data_fetches, 4);
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), best_node);
+  ASSERT_TRUE(is_selected_based_on_locality);
+}
+
+TEST_F(LocalityAwareLeasePolicyCostModelTest, TestSpilledCopyStillInMemory) {
+  absl::flat_hash_map<ObjectID, LocalityData> locality_data;
+  NodeID fallback_node = NodeID::FromRandom();
+  rpc::Address fallback_rpc_address = MockNodeAddrFactory(fallback_node).value();
+  NodeID spilled_node = NodeID::FromRandom();
+  NodeID other_node = NodeID::FromRandom();
+  ObjectID obj1 = ObjectID::FromRandom();
+  ObjectID obj2 = ObjectID::FromRandom();
+  // spilled_node hasn't evicted its spilled copy, so it has nothing to restore.
+  // other_node:   nothing to restore, 20 bytes to transfer.
+  locality_data.emplace(
+      obj1, LocalityData{100, {spilled_node, other_node}, true, spilled_node, true});
+  locality_data.emplace(obj2, LocalityData{20, {spilled_node}});
+  auto mock_locality_data_provider =
+      std::make_shared<MockLocalityDataProvider>(locality_data);
+  LocalityAwareLeasePolicy locality_lease_policy(
+      mock_locality_data_provider, MockNodeAddrFactory, fallback_rpc_address);
+  auto task_spec = CreateFakeTask({obj1, obj2});
+  auto best_node_address = locality_lease_policy.GetBestNodeForTask(task_spec).first;
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), spilled_node);
+}
+
+TEST_F(LocalityAwareLeasePolicyCostModelTest, TestPendingPulls) {
+  RayConfig::instance().locality_aware_leasing_task_load_cost_bytes() = 0;
+  absl::flat_hash_map<ObjectID, LocalityData> locality_data;
+  NodeID fallback_node = NodeID::FromRandom();
+  rpc::Address fallback_rpc_address = MockNodeAddrFactory(fallback_node).value();
+  NodeID node1 = NodeID::FromRandom();
+  NodeID node2 = NodeID::FromRandom();
+  ObjectID obj1 = ObjectID::FromRandom();
+  ObjectID obj2 = ObjectID::FromRandom();
+  locality_data.emplace(obj1, LocalityData{300, {node1}});
+  locality_data.emplace(obj2, LocalityData{200, {node2}});
+  auto mock_locality_data_provider =
+      std::make_shared<MockLocalityDataProvider>(locality_data);
+  LocalityAwareLeasePolicy locality_lease_policy(
+      mock_locality_data_provider, MockNodeAddrFactory, fallback_rpc_address);
+
+  // node1 has to pull 200 bytes and node2 300 bytes.
+  auto task1 = CreateFakeTask({obj1, obj2});
+  auto best_node_address = locality_lease_policy.GetBestNodeForTask(task1).first;
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), node1);
+
+  // node1 is already pulling 200 bytes for the first task.
+  locality_lease_policy.OnTaskPushed(task1, node1);
+  auto task2 = CreateFakeTask({obj1, obj2});
+  best_node_address = locality_lease_policy.GetBestNodeForTask(task2).first;
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), node2);
+
+  locality_lease_policy.OnTaskFinished(task1.TaskId());
+  best_node_address = locality_lease_policy.GetBestNodeForTask(task2).first;
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), node1);
+}
+
+TEST_F(LocalityAwareLeasePolicyCostModelTest, TestTaskLoad) {
+  RayConfig::instance().locality_aware_leasing_task_load_cost_bytes() = 100;
+  absl::flat_hash_map<ObjectID, LocalityData> locality_data;
+  NodeID fallback_node = NodeID::FromRandom();
+  rpc::Address fallback_rpc_address = MockNodeAddrFactory(fallback_node).value();
+  NodeID node1 = NodeID::FromRandom();
+  NodeID node2 = NodeID::FromRandom();
+  ObjectID obj1 = ObjectID::FromRandom();
+  ObjectID obj2 = ObjectID::FromRandom();
+  locality_data.emplace(obj1, LocalityData{100, {node1}});
+  locality_data.emplace(obj2, LocalityData{50, {node2}});
+  auto mock_locality_data_provider =
+      std::make_shared<MockLocalityDataProvider>(locality_data);
+  LocalityAwareLeasePolicy locality_lease_policy(
+      mock_locality_data_provider, MockNodeAddrFactory, fallback_rpc_address);
+
+  // A task whose arguments are all local on node1 runs there.
+  auto task1 = CreateFakeTask({obj1});
+  locality_lease_policy.OnTaskPushed(task1, node1);
+
+  // node1 costs 50 bytes to transfer plus 100 for the running task, node2 costs
+  // 100 bytes to transfer.
+  auto task2 = CreateFakeTask({obj1, obj2});
+  auto best_node_address = locality_lease_policy.GetBestNodeForTask(task2).first;
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), node2);
+
+  locality_lease_policy.OnTaskFinished(task1.TaskId());
+  best_node_address = locality_lease_policy.GetBestNodeForTask(task2).first;
+  ASSERT_EQ(NodeID::FromBinary(best_node_address.raylet_id()), node1);
+}
+
+struct SimulationResult {
+  uint64_t bytes_transferred = 0;
+  double mean_latency = 0;
+};
+
+/// Replay a workload on a simulated cluster, placing each task on the node chosen by
+/// the locality-aware lease policy. Each node has a fixed number of workers and an
+/// inbound link that transfers one byte per time unit. A task waits for a worker,
+/// pulls the arguments its node doesn't have yet, then executes. The owner learns
+/// about the new copy of an object once it has been pulled.
+///
+/// Every task reads a large object that is initially only on the first node, and a
+/// small shard that is spread round-robin over the nodes.
+SimulationResult SimulateBroadcastWorkload() {
+  const int kNumNodes = 4;
+  const int kWorkersPerNode = 2;
+  const int kNumTasks = 40;
+  const int64_t kArrivalInterval = 25;
+  const int64_t kExecutionTime = 100;
+  const uint64_t kBroadcastSize = 400;
+  const uint64_t kShardSize = 100;
+
+  std::vector<NodeID> nodes;
+  for (int i = 0; i < kNumNodes; i++) {
+    nodes.push_back(NodeID::FromRandom());
+  }
+  absl::flat_hash_map<ObjectID, LocalityData> locality_data;
+  absl::flat_hash_map<NodeID, absl::flat_hash_map<ObjectID, int64_t>> ready_times;
+  ObjectID broadcast = ObjectID::FromRandom();
+  locality_data.emplace(broadcast, LocalityData{kBroadcastSize, {nodes[0]}});
+  ready_times[nodes[0]][broadcast] = 0;
+  std::vector<ObjectID> shards;
+  for (int i = 0; i < kNumTasks; i++) {
+    shards.push_back(ObjectID::FromRandom());
+    const NodeID &node_id = nodes[i % kNumNodes];
+    locality_data.emplace(shards.back(), LocalityData{kShardSize, {node_id}});
+    ready_times[node_id][shards.back()] = 0;
+  }
+  auto mock_locality_data_provider =
+      std::make_shared<MockLocalityDataProvider>(locality_data);
+  LocalityAwareLeasePolicy locality_lease_policy(mock_locality_data_provider,
+                                                 MockNodeAddrFactory,
+                                                 MockNodeAddrFactory(nodes[0]).value());
+
+  absl::flat_hash_map<NodeID, std::vector<int64_t>> worker_free_times;
+  absl::flat_hash_map<NodeID, int64_t> link_free_times;
+  for (const auto &node_id : nodes) {
+    worker_free_times[node_id].resize(kWorkersPerNode, 0);
+    link_free_times[node_id] = 0;
+  }
+  std::multimap<int64_t, std::function<void()>> events;
+  SimulationResult result;
+  int64_t total_latency = 0;
+  for (int i = 0; i < kNumTasks; i++) {
+    const int64_t now = i * kArrivalInterval;
+    while (!events.empty() && events.begin()->first <= now) {
+      events.begin()->second();
+      events.erase(events.begin());
+    }
+
+    auto task_spec = CreateFakeTask({broadcast, shards[i]});
+    const NodeID node_id = NodeID::FromBinary(
+        locality_lease_policy.GetBestNodeForTask(task_spec).first.raylet_id());
+    locality_lease_policy.OnTaskPushed(task_spec, node_id);
+
+    auto &worker_free_time = *std::min_element(worker_free_times[node_id].begin(),
+                                               worker_free_times[node_id].end());
+    const int64_t start_time = std::max(now, worker_free_time);
+    int64_t args_ready_time = start_time;
+    for (const auto &object_id : task_spec.GetDependencyIds()) {
+      auto &node_ready_times = ready_times[node_id];
+      auto it = node_ready_times.find(object_id);
+      if (it == node_ready_times.end()) {
+        // Pull the object. Later tasks on this node wait for the same pull.
+        const uint64_t object_size = locality_data[object_id].object_size;
+        auto &link_free_time = link_free_times[node_id];
+        link_free_time = std::max(start_time, link_free_time) + object_size;
+        it = node_ready_times.emplace(object_id, link_free_time).first;
+        result.bytes_transferred += object_size;
+        events.emplace(link_free_time, [&, object_id, node_id]() {
+          mock_locality_data_provider->locality_data_[object_id]
+              .nodes_containing_object.insert(node_id);
+        });
+      }
+      args_ready_time = std::max(args_ready_time, it->second);
+    }
+    const int64_t finish_time = args_ready_time + kExecutionTime;
+    worker_free_time = finish_time;
+    total_latency += finish_time - now;
+    events.emplace(finish_time, [&, task_id = task_spec.TaskId()]() {
+      locality_lease_policy.OnTaskFinished(task_id);
+    });
+  }
+  result.mean_latency = static_cast<double>(total_latency) / kNumTasks;
+  return result;
+}
+
+TEST_F(LocalityAwareLeasePolicyCostModelTest, TestSimulatedBroadcastWorkload) {
+  RayConfig::instance().locality_aware_leasing_task_load_cost_bytes() = 100;
+
+  RayConfig::instance().locality_aware_leasing_cost_model_enabled() = false;
+  const auto bytes_local_result = SimulateBroadcastWorkload();
+  RayConfig::instance().locality_aware_leasing_cost_model_enabled() = true;
+  const auto cost_model_result = SimulateBroadcastWorkload();
+  RAY_LOG(INFO) << "Most bytes local: " << bytes_local_result.bytes_transferred
+                << " bytes transferred, mean latency "
+                << bytes_local_result.mean_latency;
+  RAY_LOG(INFO) << "Cost model: " << cost_model_result.bytes_transferred
+                << " bytes transferred, mean latency " << cost_model_result.mean_latency;
+
+  // Placing every task next to the large object overloads its node and its link.
+  // The cost model spreads the tasks once that node is busy, even though the large
+  // object then has to be copied to the other nodes.
+  ASSERT_LT(cost_model_result.mean_latency, bytes_local_result.mean_latency);
+  ASSERT_LT(cost_model_result.bytes_transferred,
+            2 * bytes_local_result.bytes_transferred);
+}
+
 }  // namespace core
 }  // namespace ray
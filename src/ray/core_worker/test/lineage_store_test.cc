@@ -0,0 +1,286 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/lineage_store.h"
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "ray/util/filesystem.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+/// Create a spec that looks like a typical Python task.
+TaskSpecification CreateTaskSpec(const std::string &function_name,
+                                 std::vector<ObjectID> dependencies) {
+  rpc::TaskSpec message;
+  message.set_type(rpc::TaskType::NORMAL_TASK);
+  message.set_name(function_name);
+  message.set_language(rpc::Language::PYTHON);
+  auto *function = message.mutable_function_descriptor()
+                       ->mutable_python_function_descriptor();
+  function->set_module_name("my_pipeline.stages");
+  function->set_function_name(function_name);
+  function->set_function_hash("0123456789abcdef0123456789abcdef");
+  message.set_job_id(JobID::FromInt(1).Binary());
+  message.set_task_id(TaskID::FromRandom(JobID::FromInt(1)).Binary());
+  message.set_parent_task_id(TaskID::FromRandom(JobID::FromInt(1)).Binary());
+  message.mutable_caller_address()->set_ip_address("10.0.0.1");
+  message.mutable_caller_address()->set_port(10001);
+  // All tasks are submitted by the same driver.
+  static const WorkerID caller_id = WorkerID::FromRandom();
+  message.mutable_caller_address()->set_worker_id(caller_id.Binary());
+  for (const auto &dependency : dependencies) {
+    message.add_args()->mutable_object_ref()->set_object_id(dependency.Binary());
+  }
+  message.set_num_returns(1);
+  (*message.mutable_required_resources())["CPU"] = 1;
+  (*message.mutable_required_resources())["memory"] = 1024 * 1024 * 1024;
+  message.mutable_runtime_env_info()->set_serialized_runtime_env(
+      R"({"pip": ["numpy", "pandas"], "env_vars": {"OMP_NUM_THREADS": "1"}})");
+  message.mutable_scheduling_strategy()->mutable_default_scheduling_strategy();
+  message.set_max_retries(3);
+  message.set_depth(1);
+  return TaskSpecification(std::move(message));
+}
+
+bool Equals(const TaskSpecification &a, const TaskSpecification &b) {
+  return google::protobuf::util::MessageDifferencer::Equals(a.GetMessage(),
+                                                            b.GetMessage());
+}
+
+}  // namespace
+
+class LineageStoreTest : public ::testing::Test {
+ public:
+  LineageStoreTest()
+      : offload_path_(JoinPaths(GetUserTempDir(),
+                                "lineage_store_test_" + UniqueID::FromRandom().Hex())) {}
+
+ protected:
+  std::string offload_path_;
+};
+
+TEST_F(LineageStoreTest, TestPutAndGet) {
+  LineageStore store;
+  auto dep = ObjectID::FromRandom();
+  auto spec1 = CreateTaskSpec("f", {dep});
+  auto spec2 = CreateTaskSpec("f", {});
+  auto spec3 = CreateTaskSpec("g", {});
+  store.Put(spec1);
+  store.Put(spec2);
+  store.Put(spec3);
+  ASSERT_EQ(store.Size(), 3);
+  ASSERT_TRUE(Equals(store.Get(spec1.TaskId()), spec1));
+  ASSERT_TRUE(Equals(store.Get(spec2.TaskId()), spec2));
+  ASSERT_TRUE(Equals(store.Get(spec3.TaskId()), spec3));
+  ASSERT_EQ(store.GetDependencies(spec1.TaskId()), std::vector<ObjectID>({dep}));
+  ASSERT_TRUE(Equals(store.GetReader(spec2.TaskId()).Read(), spec2));
+  ASSERT_EQ(store.GetAttemptNumber(spec1.TaskId()), spec1.AttemptNumber());
+  ASSERT_TRUE(store.GetDependencies(spec2.TaskId()).empty());
+
+  // The specs are kept copies, so later changes are not reflected.
+  spec1.GetMutableMessage().set_attempt_number(1);
+  ASSERT_EQ(store.Get(spec1.TaskId()).AttemptNumber(), 0);
+
+  // The tasks that call the same function share their fields.
+  auto total_bytes =
+      spec1.GetMessage().ByteSizeLong() + spec2.GetMessage().ByteSizeLong() +
+      spec3.GetMessage().ByteSizeLong();
+  ASSERT_LT(store.MemoryBytes() + store.SharedBytes(), total_bytes);
+
+  store.Remove(spec1.TaskId());
+  store.Remove(spec2.TaskId());
+  ASSERT_FALSE(store.Contains(spec1.TaskId()));
+  ASSERT_TRUE(Equals(store.Get(spec3.TaskId()), spec3));
+  store.Remove(spec3.TaskId());
+  ASSERT_EQ(store.Size(), 0);
+  ASSERT_EQ(store.MemoryBytes(), 0);
+  ASSERT_EQ(store.SharedBytes(), 0);
+}
+
+TEST_F(LineageStoreTest, TestOffload) {
+  LineageStore store(offload_path_);
+  ASSERT_TRUE(store.OffloadEnabled());
+  std::vector<TaskSpecification> specs;
+  for (int i = 0; i < 10; i++) {
+    specs.push_back(CreateTaskSpec("f", {ObjectID::FromRandom()}));
+    store.Put(specs.back());
+  }
+  // The specs are counted at their full size.
+  auto spec_bytes = store.SpecBytes();
+  ASSERT_EQ(spec_bytes,
+            static_cast<int64_t>(specs.size() * specs[0].GetMessage().ByteSizeLong()));
+  auto memory_bytes = store.MemoryBytes();
+
+  // Offload the oldest half of the specs.
+  auto bytes_to_offload = spec_bytes / 2;
+  auto bytes_offloaded = store.Offload(bytes_to_offload);
+  ASSERT_GE(bytes_offloaded, bytes_to_offload);
+  ASSERT_EQ(store.SpecBytes(), spec_bytes - bytes_offloaded);
+  ASSERT_LT(store.MemoryBytes(), memory_bytes);
+  ASSERT_EQ(store.NumOffloaded(), 5);
+  ASSERT_TRUE(std::filesystem::exists(offload_path_));
+  for (const auto &spec : specs) {
+    ASSERT_TRUE(Equals(store.Get(spec.TaskId()), spec));
+    ASSERT_EQ(store.GetDependencies(spec.TaskId()), spec.GetDependencyIds());
+  }
+
+  // Offload the rest. The shared fields are no longer needed in memory.
+  store.Offload(store.SpecBytes());
+  ASSERT_EQ(store.SpecBytes(), 0);
+  ASSERT_EQ(store.MemoryBytes(), 0);
+  ASSERT_EQ(store.SharedBytes(), 0);
+  ASSERT_EQ(store.NumOffloaded(), 10);
+  ASSERT_TRUE(Equals(store.Get(specs.back().TaskId()), specs.back()));
+
+  // The offload file is removed once it's no longer used.
+  for (const auto &spec : specs) {
+    store.Remove(spec.TaskId());
+  }
+  ASSERT_EQ(store.NumOffloaded(), 0);
+  ASSERT_FALSE(std::filesystem::exists(offload_path_));
+}
+
+TEST_F(LineageStoreTest, TestOffloadCompaction) {
+  // Compact as soon as the removed specs take half of the file.
+  LineageStore store(offload_path_, /*min_compaction_bytes=*/1);
+  std::vector<TaskSpecification> specs;
+  for (int i = 0; i < 10; i++) {
+    specs.push_back(CreateTaskSpec("f", {ObjectID::FromRandom()}));
+    store.Put(specs.back());
+  }
+  store.Offload(store.SpecBytes());
+  const auto offloaded_bytes = store.OffloadedBytes();
+
+  {
+    auto reader = store.GetReader(specs[0].TaskId());
+    for (int i = 0; i < 4; i++) {
+      store.Remove(specs[i].TaskId());
+    }
+    ASSERT_EQ(store.StartCompaction(), nullptr);
+    store.Remove(specs[4].TaskId());
+    store.Remove(specs[5].TaskId());
+    auto compaction = store.StartCompaction();
+    ASSERT_NE(compaction, nullptr);
+    // Only one compaction runs at a time.
+    ASSERT_EQ(store.StartCompaction(), nullptr);
+
+    // The store keeps changing while the specs are copied.
+    store.Remove(specs[6].TaskId());
+    specs.push_back(CreateTaskSpec("f", {ObjectID::FromRandom()}));
+    store.Put(specs.back());
+    store.Offload(store.SpecBytes());
+    compaction->Run();
+    store.FinishCompaction(*compaction);
+
+    // The removed specs were dropped from the file.
+    ASSERT_LE(store.OffloadedBytes(), offloaded_bytes / 2);
+    ASSERT_EQ(store.NumOffloaded(), 4);
+    for (size_t i = 7; i < specs.size(); i++) {
+      ASSERT_TRUE(Equals(store.Get(specs[i].TaskId()), specs[i]));
+    }
+    // A reader taken before the compaction still reads the previous file.
+    ASSERT_TRUE(Equals(reader.Read(), specs[0]));
+    ASSERT_TRUE(std::filesystem::exists(offload_path_));
+  }
+  // The previous file is removed once its last reader is gone.
+  ASSERT_FALSE(std::filesystem::exists(offload_path_));
+}
+
+TEST_F(LineageStoreTest, TestOffloadCompactionOfDroppedFile) {
+  LineageStore store(offload_path_, /*min_compaction_bytes=*/1);
+  std::vector<TaskSpecification> specs;
+  for (int i = 0; i < 4; i++) {
+    specs.push_back(CreateTaskSpec("f", {ObjectID::FromRandom()}));
+    store.Put(specs.back());
+  }
+  store.Offload(store.SpecBytes());
+  for (int i = 0; i < 3; i++) {
+    store.Remove(specs[i].TaskId());
+  }
+  auto compaction = store.StartCompaction();
+  ASSERT_NE(compaction, nullptr);
+
+  // The file is dropped once nothing is offloaded, and a new one is opened for the
+  // next spec, so the compaction of the previous file is dropped too.
+  store.Remove(specs[3].TaskId());
+  auto spec = CreateTaskSpec("f", {ObjectID::FromRandom()});
+  store.Put(spec);
+  store.Offload(store.SpecBytes());
+  const auto offloaded_bytes = store.OffloadedBytes();
+  compaction->Run();
+  store.FinishCompaction(*compaction);
+  ASSERT_EQ(store.OffloadedBytes(), offloaded_bytes);
+  ASSERT_TRUE(Equals(store.Get(spec.TaskId()), spec));
+  store.Remove(spec.TaskId());
+}
+
+TEST_F(LineageStoreTest, TestOffloadDisabled) {
+  LineageStore store;
+  ASSERT_FALSE(store.OffloadEnabled());
+  auto spec = CreateTaskSpec("f", {});
+  store.Put(spec);
+  ASSERT_EQ(store.Offload(store.SpecBytes()), 0);
+  ASSERT_EQ(store.NumOffloaded(), 0);
+  store.Remove(spec.TaskId());
+}
+
+TEST_F(LineageStoreTest, TestOffloadFailure) {
+  LineageStore store(JoinPaths(offload_path_, "nonexistent", "lineage"));
+  auto spec = CreateTaskSpec("f", {});
+  store.Put(spec);
+  ASSERT_EQ(store.Offload(store.SpecBytes()), 0);
+  ASSERT_FALSE(store.OffloadEnabled());
+  ASSERT_TRUE(Equals(store.Get(spec.TaskId()), spec));
+  store.Remove(spec.TaskId());
+}
+
+// Compare the memory used by the lineage of a million tasks, when the specs are kept
+// as protobufs and when they are kept in the lineage store.
+TEST_F(LineageStoreTest, MemoryPerMillionTasksBenchmark) {
+  const int kNumTasks = 1000 * 1000;
+  const std::vector<std::string> function_names = {"load", "transform", "write"};
+  LineageStore store(offload_path_);
+  int64_t protobuf_bytes = 0;
+  for (int i = 0; i < kNumTasks; i++) {
+    auto spec = CreateTaskSpec(function_names[i % function_names.size()],
+                               {ObjectID::FromRandom()});
+    protobuf_bytes += spec.GetMessage().SpaceUsedLong();
+    store.Put(spec);
+  }
+  RAY_LOG(INFO) << "Lineage of " << kNumTasks << " tasks: protobuf "
+                << protobuf_bytes / 1e6 << "MB, lineage store "
+                << (store.MemoryBytes() + store.SharedBytes()) / 1e6 << "MB";
+  ASSERT_LT(store.MemoryBytes() + store.SharedBytes(), protobuf_bytes);
+
+  store.Offload(store.SpecBytes());
+  RAY_LOG(INFO) << "After offloading: lineage store "
+                << (store.MemoryBytes() + store.SharedBytes()) / 1e6 << "MB, file "
+                << store.OffloadedBytes() / 1e6 << "MB";
+}
+
+}  // namespace core
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -16,6 +16,7 @@
 
 #include <google/protobuf/util/message_differencer.h>
 
+#include "absl/time/clock.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mock/ray/gcs/gcs_client/gcs_client.h"
@@ -394,6 +395,177 @@ TEST_F(TaskEventBufferTest, TestBufferSizeLimit) {
   ASSERT_EQ(task_event_buffer_->GetNumStatusTaskEventsDropped(), 0);
 }
 
+TEST_F(TaskEventBufferTest, TestAggregateStatusEvents) {
+  auto task_id = RandomTaskId();
+  auto job_id = JobID::FromInt(0);
+  auto node_id = NodeID::FromRandom();
+  auto worker_id = WorkerID::FromRandom();
+  auto add_status_event = [&](int32_t attempt_number,
+                              rpc::TaskStatus task_status,
+                              int64_t timestamp,
+                              absl::optional<NodeID> event_node_id = absl::nullopt,
+                              absl::optional<WorkerID> event_worker_id = absl::nullopt) {
+    task_event_buffer_->AddTaskEvent(std::make_unique<TaskStatusEvent>(task_id,
+                                                                       job_id,
+                                                                       attempt_number,
+                                                                       task_status,
+                                                                       timestamp,
+                                                                       nullptr,
+                                                                       event_node_id,
+                                                                       event_worker_id));
+  };
+  add_status_event(0, rpc::TaskStatus::PENDING_ARGS_AVAIL, 1);
+  add_status_event(0, rpc::TaskStatus::PENDING_NODE_ASSIGNMENT, 2);
+  add_status_event(0, rpc::TaskStatus::SUBMITTED_TO_WORKER, 3, node_id, worker_id);
+  add_status_event(0, rpc::TaskStatus::FAILED, 4);
+  add_status_event(1, rpc::TaskStatus::PENDING_NODE_ASSIGNMENT, 5);
+
+  // The status changes of each task attempt take a single slot.
+  ASSERT_EQ(task_event_buffer_->GetAllTaskEvents().size(), 2);
+
+  rpc::TaskEventData expected_data;
+  expected_data.set_num_profile_task_events_dropped(0);
+  expected_data.set_num_status_task_events_dropped(0);
+  {
+    auto events = expected_data.add_events_by_task();
+    events->set_task_id(task_id.Binary());
+    events->set_job_id(job_id.Binary());
+    events->set_attempt_number(0);
+    auto state_updates = events->mutable_state_updates();
+    state_updates->set_pending_args_avail_ts(1);
+    state_updates->set_pending_node_assignment_ts(2);
+    state_updates->set_submitted_to_worker_ts(3);
+    state_updates->set_failed_ts(4);
+    state_updates->set_node_id(node_id.Binary());
+    state_updates->set_worker_id(worker_id.Binary());
+  }
+  {
+    auto events = expected_data.add_events_by_task();
+    events->set_task_id(task_id.Binary());
+    events->set_job_id(job_id.Binary());
+    events->set_attempt_number(1);
+    events->mutable_state_updates()->set_pending_node_assignment_ts(5);
+  }
+
+  auto task_gcs_accessor =
+      static_cast<ray::gcs::MockGcsClient *>(task_event_buffer_->GetGcsClient())
+          ->mock_task_accessor;
+  EXPECT_CALL(*task_gcs_accessor, AsyncAddTaskEventData(_, _))
+      .WillOnce([&](std::unique_ptr<rpc::TaskEventData> actual_data,
+                    ray::gcs::StatusCallback callback) {
+        EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(*actual_data,
+                                                                       expected_data));
+        callback(Status::OK());
+        return Status::OK();
+      });
+  task_event_buffer_->FlushEvents(false);
+
+  // Status changes after the flush are buffered again.
+  add_status_event(1, rpc::TaskStatus::RUNNING, 6);
+  ASSERT_EQ(task_event_buffer_->GetAllTaskEvents().size(), 1);
+}
+
+TEST_F(TaskEventBufferTest, TestSampling) {
+  size_t num_tasks = 100;
+  auto sampled_job_id = JobID::FromInt(1);
+  auto not_recorded_job_id = JobID::FromInt(2);
+  task_event_buffer_->SetSamplingRate(sampled_job_id, 0.5);
+  task_event_buffer_->SetSamplingRate(not_recorded_job_id, 0);
+
+  auto task_ids = GenTaskIDs(num_tasks);
+  for (const auto &job_id : {sampled_job_id, not_recorded_job_id}) {
+    for (const auto &task_id : task_ids) {
+      for (auto task_status :
+           {rpc::TaskStatus::PENDING_NODE_ASSIGNMENT, rpc::TaskStatus::RUNNING}) {
+        task_event_buffer_->AddTaskEvent(
+            std::make_unique<TaskStatusEvent>(task_id, job_id, 0, task_status, 1));
+      }
+    }
+  }
+
+  // Either both status changes of a task are recorded, or none are.
+  size_t num_sampled = task_event_buffer_->GetAllTaskEvents().size();
+  ASSERT_GT(num_sampled, num_tasks / 5);
+  ASSERT_LT(num_sampled, num_tasks - num_tasks / 5);
+  for (const auto &task_event : task_event_buffer_->GetAllTaskEvents()) {
+    ASSERT_EQ(task_event.get().GetJobId(), sampled_job_id);
+    ASSERT_EQ(task_event.get().NumEvents(), 2);
+  }
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsSampledOut(),
+            2 * (num_tasks - num_sampled) + 2 * num_tasks);
+  // Tasks that aren't sampled are not data loss.
+  ASSERT_EQ(task_event_buffer_->GetNumStatusTaskEventsDropped(), 0);
+
+  // The jobs without their own sampling rate record all tasks.
+  task_event_buffer_->AddTaskEvent(GenStatusTaskEvent(RandomTaskId(), 0));
+  ASSERT_EQ(task_event_buffer_->GetAllTaskEvents().size(), num_sampled + 1);
+}
+
+// Measure the time to buffer and flush the status changes of many tasks, and the
+// size of the flushed data, with and without sampling.
+TEST_F(TaskEventBufferTest, FlushBenchmark) {
+  const size_t kNumTasks = 50000;
+  task_event_buffer_->Stop();
+  RayConfig::instance().initialize(
+      R"(
+{
+  "task_events_report_interval_ms": 1000,
+  "task_events_max_buffer_size": 100000,
+  "task_events_send_batch_size": 100000
+}
+  )");
+
+  for (double sampling_rate : {1.0, 0.1}) {
+    task_event_buffer_ = std::make_unique<TaskEventBufferImpl>(
+        std::make_unique<ray::gcs::MockGcsClient>());
+    RAY_CHECK_OK(task_event_buffer_->Start(/*auto_flush*/ false));
+    task_event_buffer_->SetSamplingRate(JobID::FromInt(0), sampling_rate);
+    auto task_gcs_accessor =
+        static_cast<ray::gcs::MockGcsClient *>(task_event_buffer_->GetGcsClient())
+            ->mock_task_accessor;
+    size_t num_flushed = 0;
+    size_t num_flushed_bytes = 0;
+    EXPECT_CALL(*task_gcs_accessor, AsyncAddTaskEventData(_, _))
+        .WillOnce([&](std::unique_ptr<rpc::TaskEventData> actual_data,
+                      ray::gcs::StatusCallback callback) {
+          num_flushed = actual_data->events_by_task_size();
+          num_flushed_bytes = actual_data->ByteSizeLong();
+          callback(Status::OK());
+          return Status::OK();
+        });
+
+    auto task_ids = GenTaskIDs(kNumTasks);
+    auto start = absl::Now();
+    // The status changes of a task that runs to completion.
+    for (auto task_status : {rpc::TaskStatus::PENDING_ARGS_AVAIL,
+                             rpc::TaskStatus::PENDING_NODE_ASSIGNMENT,
+                             rpc::TaskStatus::SUBMITTED_TO_WORKER,
+                             rpc::TaskStatus::RUNNING,
+                             rpc::TaskStatus::FINISHED}) {
+      for (const auto &task_id : task_ids) {
+        task_event_buffer_->AddTaskEvent(std::make_unique<TaskStatusEvent>(
+            task_id, JobID::FromInt(0), 0, task_status, absl::GetCurrentTimeNanos()));
+      }
+    }
+    task_event_buffer_->FlushEvents(false);
+    auto elapsed = absl::ToDoubleMicroseconds(absl::Now() - start);
+
+    RAY_LOG(INFO) << "Sampling rate " << sampling_rate << ": " << num_flushed
+                  << " task events flushed, " << num_flushed_bytes << " bytes, "
+                  << elapsed * 1000 / (5 * kNumTasks) << " ns per status change";
+    if (sampling_rate == 1.0) {
+      ASSERT_EQ(num_flushed, kNumTasks);
+    } else {
+      ASSERT_LT(num_flushed, kNumTasks / 5);
+    }
+    task_event_buffer_->Stop();
+  }
+  // Started again to be stopped by TearDown.
+  task_event_buffer_ = std::make_unique<TaskEventBufferImpl>(
+      std::make_unique<ray::gcs::MockGcsClient>());
+  RAY_CHECK_OK(task_event_buffer_->Start(/*auto_flush*/ false));
+}
+
 }  // namespace worker
 
 }  // namespace core
@@ -23,6 +23,7 @@
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
 #include "ray/pubsub/mock_pubsub.h"
+#include "ray/util/filesystem.h"
 
 namespace ray {
 namespace core {
@@ -58,6 +59,11 @@ class MockTaskEventBuffer : public worker::TaskEventBuffer {
               (std::unique_ptr<worker::TaskEvent> task_event),
               (override));
 
+  MOCK_METHOD(void,
+              SetSamplingRate,
+              (const JobID &job_id, double sampling_rate),
+              (override));
+
   MOCK_METHOD(void, FlushEvents, (bool forced), (override));
 
   MOCK_METHOD(Status, Start, (bool manual_flush), (override));
@@ -72,7 +78,8 @@ class MockTaskEventBuffer : public worker::TaskEventBuffer {
 class TaskManagerTest : public ::testing::Test {
  public:
   TaskManagerTest(bool lineage_pinning_enabled = false,
-                  int64_t max_lineage_bytes = 1024 * 1024 * 1024)
+                  int64_t max_lineage_bytes = 1024 * 1024 * 1024,
+                  std::string lineage_offload_path = "")
       : addr_(GetRandomWorkerAddr()),
         publisher_(std::make_shared<mock_pubsub::MockPublisher>()),
         subscriber_(std::make_shared<mock_pubsub::MockSubscriber>()),
@@ -102,7 +109,8 @@ class TaskManagerTest : public ::testing::Test {
                const std::string &error_message,
                double timestamp) { return Status::OK(); },
             max_lineage_bytes,
-            *task_event_buffer_mock_.get()) {}
+            *task_event_buffer_mock_.get(),
+            lineage_offload_path) {}
 
   virtual void TearDown() { AssertNoLeaks(); }
 
@@ -110,7 +118,8 @@ class TaskManagerTest : public ::testing::Test {
     absl::MutexLock lock(&manager_.mu_);
     ASSERT_EQ(manager_.submissible_tasks_.size(), 0);
     ASSERT_EQ(manager_.num_pending_tasks_, 0);
-    ASSERT_EQ(manager_.total_lineage_footprint_bytes_, 0);
+    ASSERT_EQ(manager_.lineage_store_.Size(), 0);
+    ASSERT_EQ(manager_.LineageFootprintBytes(), 0);
   }
 
   rpc::Address addr_;
@@ -132,6 +141,15 @@ class TaskManagerLineageTest : public TaskManagerTest {
   TaskManagerLineageTest() : TaskManagerTest(true, /*max_lineage_bytes=*/10000) {}
 };
 
+class TaskManagerLineageOffloadTest : public TaskManagerTest {
+ public:
+  TaskManagerLineageOffloadTest()
+      : TaskManagerTest(true,
+                        /*max_lineage_bytes=*/1000,
+                        JoinPaths(GetUserTempDir(),
+                                  "lineage_offload_" + UniqueID::FromRandom().Hex())) {}
+};
+
 TEST_F(TaskManagerTest, TestTaskSuccess) {
   rpc::Address caller_address;
   ObjectID dep1 = ObjectID::FromRandom();
@@ -882,6 +900,53 @@ TEST_F(TaskManagerLineageTest, TestResubmitTask) {
   ASSERT_EQ(reference_counter_->NumObjectIDsInScope(), 0);
 }
 
+// Test that the lineage is offloaded to disk instead of evicted when it exceeds the
+// limit, and that the offloaded tasks can still be resubmitted.
+TEST_F(TaskManagerLineageOffloadTest, TestResubmitOffloadedTask) {
+  rpc::Address caller_address;
+  std::vector<TaskSpecification> specs;
+  for (int i = 0; i < 20; i++) {
+    auto spec = CreateTaskHelper(1, {ObjectID::FromRandom(), ObjectID::FromRandom()});
+    manager_.AddPendingTask(caller_address, spec, "", /*max_retries=*/3);
+    rpc::PushTaskReply reply;
+    auto return_object = reply.add_return_objects();
+    return_object->set_object_id(spec.ReturnId(0).Binary());
+    return_object->set_in_plasma(true);
+    manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
+    specs.push_back(spec);
+  }
+  {
+    absl::MutexLock lock(&manager_.mu_);
+    ASSERT_GT(manager_.lineage_store_.NumOffloaded(), 0);
+  }
+  ASSERT_LE(manager_.TotalLineageFootprintBytes(), 1000);
+  // None of the lineage was evicted.
+  for (const auto &spec : specs) {
+    ASSERT_TRUE(manager_.IsTaskSubmissible(spec.TaskId()));
+    bool lineage_evicted = false;
+    ASSERT_TRUE(
+        reference_counter_->IsObjectReconstructable(spec.ReturnId(0), &lineage_evicted));
+    ASSERT_FALSE(lineage_evicted);
+  }
+
+  // The oldest task was offloaded. It can still be resubmitted.
+  std::vector<ObjectID> resubmitted_task_deps;
+  ASSERT_TRUE(manager_.ResubmitTask(specs[0].TaskId(), &resubmitted_task_deps));
+  ASSERT_EQ(resubmitted_task_deps, specs[0].GetDependencyIds());
+  ASSERT_EQ(num_retries_, 1);
+  ASSERT_TRUE(manager_.IsTaskPending(specs[0].TaskId()));
+  ASSERT_EQ(manager_.GetTaskSpec(specs[0].TaskId())->TaskId(), specs[0].TaskId());
+
+  for (const auto &spec : specs) {
+    reference_counter_->RemoveLocalReference(spec.ReturnId(0), nullptr);
+  }
+  // The resubmitted task is still pending.
+  ASSERT_TRUE(manager_.IsTaskPending(specs[0].TaskId()));
+  rpc::PushTaskReply reply;
+  manager_.CompletePendingTask(specs[0].TaskId(), reply, rpc::Address(), false);
+  ASSERT_EQ(reference_counter_->NumObjectIDsInScope(), 0);
+}
+
 // Test resubmission for a task that was successfully executed once and stored
 // its return values in plasma. On re-execution, the task's return values
 // should be stored in plasma again, even if the worker returns its values
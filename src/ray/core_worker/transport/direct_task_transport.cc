@@ -329,13 +329,18 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
   const size_t kMaxPendingLeaseRequestsPerSchedulingCategory =
       lease_request_rate_limiter_->GetMaxPendingLeaseRequestsPerSchedulingCategory();
 
-  if (scheduling_key_entry.pending_lease_requests.size() >=
+  if (scheduling_key_entry.num_pending_lease_rpcs >=
       kMaxPendingLeaseRequestsPerSchedulingCategory) {
     RAY_LOG(DEBUG) << "Exceeding the pending request limit "
                    << kMaxPendingLeaseRequestsPerSchedulingCategory;
     return;
   }
 
+  if (raylet_address == nullptr && scheduling_key_entry.lease_retry_time.has_value()) {
+    // Leases were rejected recently. The lease retry timer asks for them again.
+    return;
+  }
+
   if (!scheduling_key_entry.AllWorkersBusy()) {
     // There are idle workers, so we don't need more.
     return;
@@ -355,7 +360,6 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
     return;
   }
 
-  num_leases_requested_++;
   // Create a TaskSpecification with an overwritten TaskID to make sure we don't reuse the
   // same TaskID to request a worker
   auto resource_spec_msg = scheduling_key_entry.resource_spec.GetMutableMessage();
@@ -371,191 +375,340 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
     raylet_address = &best_node_address;
   }
 
+  // Ask for a worker per queued task without a pending lease, up to
+  // max_leases_per_request, in a single request. Spillback requests are sent one
+  // per lease since they are granted or rejected right away.
+  size_t num_leases = 1;
+  const int64_t max_leases_per_request = RayConfig::instance().max_leases_per_request();
+  if (!is_spillback && max_leases_per_request > 1 &&
+      !resource_spec.IsActorCreationTask()) {
+    num_leases = std::min(static_cast<size_t>(max_leases_per_request),
+                          task_queue.size() -
+                              scheduling_key_entry.pending_lease_requests.size());
+  }
+  num_leases_requested_ += num_leases;
+  scheduling_key_entry.num_pending_lease_rpcs++;
+
   auto lease_client = GetOrConnectLeaseClient(raylet_address);
   const TaskID task_id = resource_spec.TaskId();
   const std::string task_name = resource_spec.GetName();
-  RAY_LOG(DEBUG) << "Requesting lease from raylet "
+  RAY_LOG(DEBUG) << "Requesting " << num_leases << " leases from raylet "
                  << NodeID::FromBinary(raylet_address->raylet_id()) << " for task "
                  << task_id;
 
-  lease_client->RequestWorkerLease(
-      resource_spec.GetMessage(),
-      /*grant_or_reject=*/is_spillback,
-      [this,
-       scheduling_key,
-       task_id,
-       task_name,
-       is_spillback,
-       raylet_address = *raylet_address](const Status &status,
-                                         const rpc::RequestWorkerLeaseReply &reply) {
-        std::deque<TaskSpecification> tasks_to_fail;
-        rpc::RayErrorInfo error_info;
-        ray::Status error_status;
-        rpc::ErrorType error_type = rpc::ErrorType::WORKER_DIED;
-        {
-          absl::MutexLock lock(&mu_);
-
-          auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
-          auto lease_client = GetOrConnectLeaseClient(&raylet_address);
-          scheduling_key_entry.pending_lease_requests.erase(task_id);
-
-          if (status.ok()) {
-            if (reply.canceled()) {
-              RAY_LOG(DEBUG) << "Lease canceled for task: " << task_id
-                             << ", canceled type: "
-                             << rpc::RequestWorkerLeaseReply::SchedulingFailureType_Name(
-                                    reply.failure_type());
-              if (reply.failure_type() ==
-                      rpc::RequestWorkerLeaseReply::
-                          SCHEDULING_CANCELLED_RUNTIME_ENV_SETUP_FAILED ||
-                  reply.failure_type() ==
-                      rpc::RequestWorkerLeaseReply::
-                          SCHEDULING_CANCELLED_PLACEMENT_GROUP_REMOVED ||
-                  reply.failure_type() ==
-                      rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_UNSCHEDULABLE) {
-                // We need to actively fail all of the pending tasks in the queue when the
-                // placement group was removed or the runtime env failed to be set up.
-                // Such an operation is straightforward for the scenario of placement
-                // group removal as all tasks in the queue are associated with the same
-                // placement group, but in the case of runtime env setup failed, This
-                // makes an implicit assumption that runtime_env failures are not
-                // transient -- we may consider adding some retries in the future.
-                if (reply.failure_type() ==
-                    rpc::RequestWorkerLeaseReply::
-                        SCHEDULING_CANCELLED_RUNTIME_ENV_SETUP_FAILED) {
-                  error_type = rpc::ErrorType::RUNTIME_ENV_SETUP_FAILED;
-                  error_info.mutable_runtime_env_setup_failed_error()->set_error_message(
-                      reply.scheduling_failure_message());
-                } else if (reply.failure_type() ==
-                           rpc::RequestWorkerLeaseReply::
-                               SCHEDULING_CANCELLED_UNSCHEDULABLE) {
-                  error_type = rpc::ErrorType::TASK_UNSCHEDULABLE_ERROR;
-                  *(error_info.mutable_error_message()) =
-                      reply.scheduling_failure_message();
-                } else {
-                  error_type = rpc::ErrorType::TASK_PLACEMENT_GROUP_REMOVED;
-                }
-                tasks_to_fail = std::move(scheduling_key_entry.task_queue);
-                scheduling_key_entry.task_queue.clear();
-                if (scheduling_key_entry.CanDelete()) {
-                  scheduling_key_entries_.erase(scheduling_key);
-                }
-              } else {
-                RequestNewWorkerIfNeeded(scheduling_key);
-              }
-            } else if (reply.rejected()) {
-              RAY_LOG(DEBUG) << "Lease rejected " << task_id;
-              // It might happen when the first raylet has a stale view
-              // of the spillback raylet resources.
-              // Retry the request at the first raylet since the resource view may be
-              // refreshed.
-              RAY_CHECK(is_spillback);
-              RequestNewWorkerIfNeeded(scheduling_key);
-            } else if (!reply.worker_address().raylet_id().empty()) {
-              // We got a lease for a worker. Add the lease client state and try to
-              // assign work to the worker.
-              rpc::WorkerAddress addr(reply.worker_address());
-              RAY_LOG(DEBUG) << "Lease granted to task " << task_id << " from raylet "
-                             << addr.raylet_id << " with worker " << addr.worker_id;
-
-              auto resources_copy = reply.resource_mapping();
-
-              AddWorkerLeaseClient(
-                  addr, std::move(lease_client), resources_copy, scheduling_key, task_id);
-              RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
-              OnWorkerIdle(addr,
-                           scheduling_key,
-                           /*error=*/false,
-                           /*worker_exiting=*/false,
-                           resources_copy);
+  if (num_leases == 1) {
+    lease_client->RequestWorkerLease(
+        resource_spec.GetMessage(),
+        /*grant_or_reject=*/is_spillback,
+        [this,
+         scheduling_key,
+         task_id,
+         task_name,
+         is_spillback,
+         raylet_address = *raylet_address](const Status &status,
+                                           const rpc::RequestWorkerLeaseReply &reply) {
+          TasksToFail tasks_to_fail;
+          {
+            absl::MutexLock lock(&mu_);
+            scheduling_key_entries_[scheduling_key].num_pending_lease_rpcs--;
+            HandleWorkerLeaseReply(scheduling_key,
+                                   task_id,
+                                   task_name,
+                                   is_spillback,
+                                   /*is_multi_lease=*/false,
+                                   raylet_address,
+                                   status,
+                                   reply,
+                                   &tasks_to_fail);
+          }
+          FailTasks(std::move(tasks_to_fail));
+        },
+        task_queue.size(),
+        is_selected_based_on_locality);
+    scheduling_key_entry.pending_lease_requests.emplace(task_id, *raylet_address);
+  } else {
+    std::vector<TaskID> lease_ids = {task_id};
+    for (size_t i = 1; i < num_leases; i++) {
+      lease_ids.push_back(TaskID::FromRandom(job_id_));
+    }
+    lease_client->RequestWorkerLeases(
+        resource_spec.GetMessage(),
+        lease_ids,
+        [this, scheduling_key, lease_ids, task_name, raylet_address = *raylet_address](
+            const Status &status, const rpc::RequestWorkerLeasesReply &reply) {
+          TasksToFail tasks_to_fail;
+          {
+            absl::MutexLock lock(&mu_);
+            auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
+            scheduling_key_entry.num_pending_lease_rpcs--;
+            RAY_CHECK(!status.ok() ||
+                      static_cast<size_t>(reply.lease_replies_size()) ==
+                          lease_ids.size());
+            const bool any_rejected =
+                status.ok() && std::any_of(reply.lease_replies().begin(),
+                                           reply.lease_replies().end(),
+                                           [](const auto &lease_reply) {
+                                             return lease_reply.rejected();
+                                           });
+            if (any_rejected) {
+              // This also holds off the requests triggered by the granted leases.
+              BackOffLeaseRequests(scheduling_key);
             } else {
-              // The raylet redirected us to a different raylet to retry at.
-              RAY_CHECK(!is_spillback);
-              RAY_LOG(DEBUG) << "Redirect lease for task " << task_id << " from raylet "
-                             << NodeID::FromBinary(raylet_address.raylet_id())
-                             << " to raylet "
-                             << NodeID::FromBinary(
-                                    reply.retry_at_raylet_address().raylet_id());
-
-              RequestNewWorkerIfNeeded(scheduling_key, &reply.retry_at_raylet_address());
+              scheduling_key_entry.lease_retry_delay_ms = 0;
             }
-          } else if (lease_client != local_lease_client_) {
-            // A lease request to a remote raylet failed. Retry locally if the lease is
-            // still needed.
-            // TODO(swang): Fail after some number of retries?
-            RAY_LOG_EVERY_MS(INFO, 30 * 1000)
-                << "Retrying attempt to schedule task (id: " << task_id
-                << " name: " << task_name
-                << ") at remote node (id: " << raylet_address.raylet_id()
-                << " ip: " << raylet_address.ip_address()
-                << "). Try again "
-                   "on a local node. Error: "
-                << status.ToString();
-
-            RequestNewWorkerIfNeeded(scheduling_key);
-
-          } else {
-            if (status.IsGrpcUnavailable()) {
-              RAY_LOG(WARNING)
-                  << "The worker failed to receive a response from the local "
-                  << "raylet because the raylet is unavailable (crashed). "
-                  << "Error: " << status;
-              if (worker_type_ == WorkerType::WORKER) {
-                // Exit the worker so that caller can retry somewhere else.
-                RAY_LOG(WARNING) << "Terminating the worker due to local raylet death";
-                QuickExit();
-              }
-              RAY_CHECK(worker_type_ == WorkerType::DRIVER);
-              error_type = rpc::ErrorType::LOCAL_RAYLET_DIED;
-              error_status = status;
-              tasks_to_fail = std::move(scheduling_key_entry.task_queue);
-              scheduling_key_entry.task_queue.clear();
-              if (scheduling_key_entry.CanDelete()) {
-                scheduling_key_entries_.erase(scheduling_key);
-              }
-            } else {
-              RAY_LOG(WARNING)
-                  << "The worker failed to receive a response from the local raylet, but "
-                     "raylet is still alive. Try again on a local node. Error: "
-                  << status;
-              // TODO(sang): Maybe we should raise FATAL error if it happens too many
-              // times.
+            const rpc::RequestWorkerLeaseReply no_reply;
+            for (size_t i = 0; i < lease_ids.size(); i++) {
+              HandleWorkerLeaseReply(scheduling_key,
+                                     lease_ids[i],
+                                     task_name,
+                                     /*is_spillback=*/false,
+                                     /*is_multi_lease=*/true,
+                                     raylet_address,
+                                     status,
+                                     status.ok() ? reply.lease_replies(i) : no_reply,
+                                     &tasks_to_fail);
+            }
+            if (any_rejected && !lease_retry_timer_.has_value() &&
+                scheduling_key_entries_.contains(scheduling_key)) {
               RequestNewWorkerIfNeeded(scheduling_key);
             }
           }
-        }
-
-        while (!tasks_to_fail.empty()) {
-          auto &task_spec = tasks_to_fail.front();
-          if (task_spec.IsActorCreationTask() &&
-              error_type == rpc::ErrorType::TASK_PLACEMENT_GROUP_REMOVED) {
-            RAY_UNUSED(task_finisher_->FailPendingTask(
-                task_spec.TaskId(),
-                rpc::ErrorType::ACTOR_PLACEMENT_GROUP_REMOVED,
-                &error_status,
-                &error_info));
-          } else {
-            RAY_UNUSED(task_finisher_->FailPendingTask(
-                task_spec.TaskId(), error_type, &error_status, &error_info));
-          }
-          tasks_to_fail.pop_front();
-        }
-      },
-      task_queue.size(),
-      is_selected_based_on_locality);
-  scheduling_key_entry.pending_lease_requests.emplace(task_id, *raylet_address);
+          FailTasks(std::move(tasks_to_fail));
+        },
+        task_queue.size(),
+        is_selected_based_on_locality);
+    for (const auto &lease_id : lease_ids) {
+      scheduling_key_entry.pending_lease_requests.emplace(lease_id, *raylet_address);
+    }
+  }
   ReportWorkerBacklogIfNeeded(scheduling_key);
 
   // Lease more workers if there are still pending tasks and
   // and we haven't hit the max_pending_lease_requests yet.
   if (scheduling_key_entry.task_queue.size() >
           scheduling_key_entry.pending_lease_requests.size() &&
-      scheduling_key_entry.pending_lease_requests.size() <
+      scheduling_key_entry.num_pending_lease_rpcs <
           kMaxPendingLeaseRequestsPerSchedulingCategory) {
     RequestNewWorkerIfNeeded(scheduling_key);
   }
 }
 
+void CoreWorkerDirectTaskSubmitter::HandleWorkerLeaseReply(
+    const SchedulingKey &scheduling_key,
+    const TaskID &task_id,
+    const std::string &task_name,
+    bool is_spillback,
+    bool is_multi_lease,
+    const rpc::Address &raylet_address,
+    const Status &status,
+    const rpc::RequestWorkerLeaseReply &reply,
+    TasksToFail *tasks_to_fail) {
+  auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
+  auto lease_client = GetOrConnectLeaseClient(&raylet_address);
+  scheduling_key_entry.pending_lease_requests.erase(task_id);
+
+  // Fail all of the tasks in the queue. The entry must not be used afterwards.
+  auto fail_queued_tasks = [this, &scheduling_key_entry, &scheduling_key, tasks_to_fail](
+                               rpc::ErrorType error_type) {
+    tasks_to_fail->error_type = error_type;
+    for (auto &task_spec : scheduling_key_entry.task_queue) {
+      tasks_to_fail->tasks.push_back(std::move(task_spec));
+    }
+    scheduling_key_entry.task_queue.clear();
+    if (scheduling_key_entry.CanDelete()) {
+      scheduling_key_entries_.erase(scheduling_key);
+    }
+  };
+
+  if (status.ok()) {
+    if (reply.canceled()) {
+      RAY_LOG(DEBUG) << "Lease canceled for task: " << task_id << ", canceled type: "
+                     << rpc::RequestWorkerLeaseReply::SchedulingFailureType_Name(
+                            reply.failure_type());
+      if (reply.failure_type() ==
+              rpc::RequestWorkerLeaseReply::
+                  SCHEDULING_CANCELLED_RUNTIME_ENV_SETUP_FAILED ||
+          reply.failure_type() ==
+              rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_PLACEMENT_GROUP_REMOVED ||
+          reply.failure_type() ==
+              rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_UNSCHEDULABLE) {
+        // We need to actively fail all of the pending tasks in the queue when the
+        // placement group was removed or the runtime env failed to be set up. Such an
+        // operation is straightforward for the scenario of placement group removal as
+        // all tasks in the queue are associated with the same placement group, but in
+        // the case of runtime env setup failed, This makes an implicit assumption that
+        // runtime_env failures are not transient -- we may consider adding some retries
+        // in the future.
+        if (reply.failure_type() ==
+            rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_RUNTIME_ENV_SETUP_FAILED) {
+          tasks_to_fail->error_info.mutable_runtime_env_setup_failed_error()
+              ->set_error_message(reply.scheduling_failure_message());
+          fail_queued_tasks(rpc::ErrorType::RUNTIME_ENV_SETUP_FAILED);
+        } else if (reply.failure_type() ==
+                   rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_UNSCHEDULABLE) {
+          *(tasks_to_fail->error_info.mutable_error_message()) =
+              reply.scheduling_failure_message();
+          fail_queued_tasks(rpc::ErrorType::TASK_UNSCHEDULABLE_ERROR);
+        } else {
+          fail_queued_tasks(rpc::ErrorType::TASK_PLACEMENT_GROUP_REMOVED);
+        }
+      } else {
+        RequestNewWorkerIfNeeded(scheduling_key);
+      }
+    } else if (reply.rejected()) {
+      RAY_LOG(DEBUG) << "Lease rejected " << task_id;
+      // It might happen when the first raylet has a stale view
+      // of the spillback raylet resources, or when the raylet couldn't grant all the
+      // leases of a multi-lease request right away.
+      // Retry the request at the first raylet since the resource view may be
+      // refreshed. The rejected leases of a multi-lease request are requested again
+      // after a backoff, see `BackOffLeaseRequests`.
+      RAY_CHECK(is_spillback || is_multi_lease);
+      if (!is_multi_lease) {
+        RequestNewWorkerIfNeeded(scheduling_key);
+      }
+    } else if (!reply.worker_address().raylet_id().empty()) {
+      // We got a lease for a worker. Add the lease client state and try to
+      // assign work to the worker.
+      rpc::WorkerAddress addr(reply.worker_address());
+      RAY_LOG(DEBUG) << "Lease granted to task " << task_id << " from raylet "
+                     << addr.raylet_id << " with worker " << addr.worker_id;
+
+      auto resources_copy = reply.resource_mapping();
+
+      AddWorkerLeaseClient(
+          addr, std::move(lease_client), resources_copy, scheduling_key, task_id);
+      RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
+      OnWorkerIdle(addr,
+                   scheduling_key,
+                   /*error=*/false,
+                   /*worker_exiting=*/false,
+                   resources_copy);
+    } else {
+      // The raylet redirected us to a different raylet to retry at.
+      RAY_CHECK(!is_spillback);
+      RAY_LOG(DEBUG) << "Redirect lease for task " << task_id << " from raylet "
+                     << NodeID::FromBinary(raylet_address.raylet_id()) << " to raylet "
+                     << NodeID::FromBinary(reply.retry_at_raylet_address().raylet_id());
+
+      RequestNewWorkerIfNeeded(scheduling_key, &reply.retry_at_raylet_address());
+    }
+  } else if (lease_client != local_lease_client_) {
+    // A lease request to a remote raylet failed. Retry locally if the lease is
+    // still needed.
+    // TODO(swang): Fail after some number of retries?
+    RAY_LOG_EVERY_MS(INFO, 30 * 1000)
+        << "Retrying attempt to schedule task (id: " << task_id << " name: " << task_name
+        << ") at remote node (id: " << raylet_address.raylet_id()
+        << " ip: " << raylet_address.ip_address()
+        << "). Try again "
+           "on a local node. Error: "
+        << status.ToString();
+
+    RequestNewWorkerIfNeeded(scheduling_key);
+
+  } else {
+    if (status.IsGrpcUnavailable()) {
+      RAY_LOG(WARNING) << "The worker failed to receive a response from the local "
+                       << "raylet because the raylet is unavailable (crashed). "
+                       << "Error: " << status;
+      if (worker_type_ == WorkerType::WORKER) {
+        // Exit the worker so that caller can retry somewhere else.
+        RAY_LOG(WARNING) << "Terminating the worker due to local raylet death";
+        QuickExit();
+      }
+      RAY_CHECK(worker_type_ == WorkerType::DRIVER);
+      tasks_to_fail->error_status = status;
+      fail_queued_tasks(rpc::ErrorType::LOCAL_RAYLET_DIED);
+    } else {
+      RAY_LOG(WARNING)
+          << "The worker failed to receive a response from the local raylet, but "
+             "raylet is still alive. Try again on a local node. Error: "
+          << status;
+      // TODO(sang): Maybe we should raise FATAL error if it happens too many
+      // times.
+      RequestNewWorkerIfNeeded(scheduling_key);
+    }
+  }
+}
+
+void CoreWorkerDirectTaskSubmitter::BackOffLeaseRequests(
+    const SchedulingKey &scheduling_key) {
+  if (!lease_retry_timer_.has_value()) {
+    return;
+  }
+  auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
+  auto &delay_ms = scheduling_key_entry.lease_retry_delay_ms;
+  delay_ms = delay_ms == 0
+                 ? RayConfig::instance().lease_rejection_retry_initial_delay_ms()
+                 : std::min(2 * delay_ms,
+                            RayConfig::instance().lease_rejection_retry_max_delay_ms());
+  RAY_LOG(DEBUG) << "Requesting the rejected leases again in " << delay_ms << "ms";
+  scheduling_key_entry.lease_retry_time =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+  ArmLeaseRetryTimer();
+}
+
+void CoreWorkerDirectTaskSubmitter::ArmLeaseRetryTimer() {
+  absl::optional<std::chrono::steady_clock::time_point> earliest_retry_time;
+  for (const auto &[scheduling_key, scheduling_key_entry] : scheduling_key_entries_) {
+    const auto &retry_time = scheduling_key_entry.lease_retry_time;
+    if (retry_time.has_value() &&
+        (!earliest_retry_time.has_value() || *retry_time < *earliest_retry_time)) {
+      earliest_retry_time = retry_time;
+    }
+  }
+  if (!earliest_retry_time.has_value()) {
+    return;
+  }
+  // This cancels the pending wait, if any.
+  lease_retry_timer_->expires_at(*earliest_retry_time);
+  lease_retry_timer_->async_wait(
+      [this](const boost::system::error_code &error) { OnLeaseRetryTimer(error); });
+}
+
+void CoreWorkerDirectTaskSubmitter::OnLeaseRetryTimer(
+    const boost::system::error_code &error) {
+  if (error == boost::asio::error::operation_aborted) {
+    // The timer was armed again for an earlier retry.
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<SchedulingKey> scheduling_keys_to_retry;
+  for (auto &[scheduling_key, scheduling_key_entry] : scheduling_key_entries_) {
+    if (scheduling_key_entry.lease_retry_time.has_value() &&
+        *scheduling_key_entry.lease_retry_time <= now) {
+      scheduling_key_entry.lease_retry_time.reset();
+      scheduling_keys_to_retry.push_back(scheduling_key);
+    }
+  }
+  for (const auto &scheduling_key : scheduling_keys_to_retry) {
+    RequestNewWorkerIfNeeded(scheduling_key);
+  }
+  ArmLeaseRetryTimer();
+}
+
+void CoreWorkerDirectTaskSubmitter::FailTasks(TasksToFail tasks_to_fail) {
+  while (!tasks_to_fail.tasks.empty()) {
+    auto &task_spec = tasks_to_fail.tasks.front();
+    if (task_spec.IsActorCreationTask() &&
+        tasks_to_fail.error_type == rpc::ErrorType::TASK_PLACEMENT_GROUP_REMOVED) {
+      RAY_UNUSED(
+          task_finisher_->FailPendingTask(task_spec.TaskId(),
+                                          rpc::ErrorType::ACTOR_PLACEMENT_GROUP_REMOVED,
+                                          &tasks_to_fail.error_status,
+                                          &tasks_to_fail.error_info));
+    } else {
+      RAY_UNUSED(task_finisher_->FailPendingTask(task_spec.TaskId(),
+                                                 tasks_to_fail.error_type,
+                                                 &tasks_to_fail.error_status,
+                                                 &tasks_to_fail.error_info));
+    }
+    tasks_to_fail.tasks.pop_front();
+  }
+}
+
 void CoreWorkerDirectTaskSubmitter::PushNormalTask(
     const rpc::WorkerAddress &addr,
     rpc::CoreWorkerClientInterface &client,
@@ -576,6 +729,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
   request->mutable_resource_mapping()->CopyFrom(assigned_resources);
   request->set_intended_worker_id(addr.worker_id.Binary());
   task_finisher_->MarkTaskWaitingForExecution(task_id, addr.raylet_id, addr.worker_id);
+  lease_policy_->OnTaskPushed(task_spec, addr.raylet_id);
   client.PushNormalTask(
       std::move(request),
       [this,
@@ -591,6 +745,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
                          << addr.worker_id << " of raylet " << addr.raylet_id;
           absl::MutexLock lock(&mu_);
           executing_tasks_.erase(task_id);
+          lease_policy_->OnTaskFinished(task_id);
 
           // Decrement the number of tasks in flight to the worker
           auto &lease_entry = worker_to_lease_entry_[addr];
@@ -16,6 +16,8 @@
 
 #include <google/protobuf/repeated_field.h>
 
+#include <chrono>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
@@ -88,7 +90,8 @@ class CoreWorkerDirectTaskSubmitter {
       std::shared_ptr<ActorCreatorInterface> actor_creator,
       const JobID &job_id,
       std::shared_ptr<LeaseRequestRateLimiter> lease_request_rate_limiter,
-      absl::optional<boost::asio::steady_timer> cancel_timer = absl::nullopt)
+      absl::optional<boost::asio::steady_timer> cancel_timer = absl::nullopt,
+      absl::optional<boost::asio::steady_timer> lease_retry_timer = absl::nullopt)
       : rpc_address_(rpc_address),
         local_lease_client_(lease_client),
         lease_client_factory_(lease_client_factory),
@@ -102,7 +105,8 @@ class CoreWorkerDirectTaskSubmitter {
         client_cache_(core_worker_client_pool),
         job_id_(job_id),
         lease_request_rate_limiter_(lease_request_rate_limiter),
-        cancel_retry_timer_(std::move(cancel_timer)) {}
+        cancel_retry_timer_(std::move(cancel_timer)),
+        lease_retry_timer_(std::move(lease_retry_timer)) {}
 
   /// Schedule a task for direct submission to a worker.
   ///
@@ -174,10 +178,56 @@ class CoreWorkerDirectTaskSubmitter {
   /// flight and there are tasks queued. If a raylet address is provided, then
   /// the worker should be requested from the raylet at that address. Else, the
   /// worker should be requested from the local raylet.
+  /// Several workers are requested in one RPC if max_leases_per_request allows.
   void RequestNewWorkerIfNeeded(const SchedulingKey &task_queue_key,
                                 const rpc::Address *raylet_address = nullptr)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// The tasks to fail because of a lease reply, and why. They are failed after
+  /// releasing the lock.
+  struct TasksToFail {
+    std::deque<TaskSpecification> tasks;
+    rpc::ErrorType error_type = rpc::ErrorType::WORKER_DIED;
+    rpc::RayErrorInfo error_info;
+    Status error_status;
+  };
+
+  /// Hold off the lease requests of a scheduling key after some of its leases were
+  /// rejected. The lease retry timer requests them again after a delay that doubles
+  /// with each reply in a row that has rejections. Does nothing without the timer, in
+  /// which case the caller requests the leases again right away.
+  void BackOffLeaseRequests(const SchedulingKey &scheduling_key)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Arm the lease retry timer for the earliest scheduled retry.
+  void ArmLeaseRetryTimer() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Request the leases whose retry is due. Called by the lease retry timer.
+  void OnLeaseRetryTimer(const boost::system::error_code &error) LOCKS_EXCLUDED(mu_);
+
+  /// Handle the reply to a single lease, which is either the reply to a
+  /// `RequestWorkerLease` or one of the replies to a `RequestWorkerLeases`.
+  ///
+  /// \param[in] task_id The ID of the lease.
+  /// \param[in] is_spillback Whether the lease was requested from a spillback raylet.
+  /// \param[in] is_multi_lease Whether the lease was part of a multi-lease request.
+  /// \param[in] raylet_address The raylet the lease was requested from.
+  /// \param[in] status The status of the lease RPC.
+  /// \param[in] reply The reply to the lease. Only valid if the status is OK.
+  /// \param[out] tasks_to_fail The queued tasks that must be failed, if any.
+  void HandleWorkerLeaseReply(const SchedulingKey &scheduling_key,
+                              const TaskID &task_id,
+                              const std::string &task_name,
+                              bool is_spillback,
+                              bool is_multi_lease,
+                              const rpc::Address &raylet_address,
+                              const Status &status,
+                              const rpc::RequestWorkerLeaseReply &reply,
+                              TasksToFail *tasks_to_fail) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fail the tasks collected by `HandleWorkerLeaseReply`.
+  void FailTasks(TasksToFail tasks_to_fail) LOCKS_EXCLUDED(mu_);
+
   /// Cancel a pending worker lease and retry until the cancellation succeeds
   /// (i.e., the raylet drops the request). This should be called when there
   /// are no more tasks queued with the given scheduling key and there is an
@@ -305,8 +355,11 @@ class CoreWorkerDirectTaskSubmitter {
       GUARDED_BY(mu_);
 
   struct SchedulingKeyEntry {
-    // Keep track of pending worker lease requests to the raylet.
+    // Keep track of pending worker lease requests to the raylet, one per lease.
     absl::flat_hash_map<TaskID, rpc::Address> pending_lease_requests;
+    // The number of lease RPCs in flight. A multi-lease RPC has several entries in
+    // pending_lease_requests, so this is what the lease request rate limit applies to.
+    size_t num_pending_lease_rpcs = 0;
     TaskSpecification resource_spec = TaskSpecification();
     // Tasks that are queued for execution. We keep an individual queue per
     // scheduling class to ensure fairness.
@@ -318,12 +371,18 @@ class CoreWorkerDirectTaskSubmitter {
     // Keep track of how many workers have tasks to do.
     uint32_t num_busy_workers = 0;
     int64_t last_reported_backlog_size = 0;
+    // The delay before asking again for leases that were rejected. 0 if the last
+    // multi-lease reply had no rejections.
+    uint64_t lease_retry_delay_ms = 0;
+    // When the rejected leases are requested again, if a retry is scheduled.
+    absl::optional<std::chrono::steady_clock::time_point> lease_retry_time;
 
     // Check whether it's safe to delete this SchedulingKeyEntry from the
     // scheduling_key_entries_ hashmap.
     inline bool CanDelete() const {
       if (pending_lease_requests.empty() && task_queue.empty() &&
-          active_workers.size() == 0 && num_busy_workers == 0) {
+          active_workers.size() == 0 && num_busy_workers == 0 &&
+          !lease_retry_time.has_value()) {
         return true;
       }
 
@@ -366,6 +425,10 @@ class CoreWorkerDirectTaskSubmitter {
   // Retries cancelation requests if they were not successful.
   absl::optional<boost::asio::steady_timer> cancel_retry_timer_;
 
+  // Requests rejected leases again after a backoff. If not set, they are requested
+  // again right away.
+  absl::optional<boost::asio::steady_timer> lease_retry_timer_;
+
   int64_t num_tasks_submitted_ = 0;
   int64_t num_leases_requested_ GUARDED_BY(mu_) = 0;
 };
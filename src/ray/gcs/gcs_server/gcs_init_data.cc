@@ -14,14 +14,37 @@
 
 #include "ray/gcs/gcs_server/gcs_init_data.h"
 
+#include "absl/time/clock.h"
+#include "ray/common/ray_config.h"
+
 namespace ray {
 namespace gcs {
 void GcsInitData::AsyncLoad(const EmptyCallback &on_done) {
+  auto num_threads = RayConfig::instance().gcs_init_data_load_threads();
+  if (main_io_service_ != nullptr && num_threads > 0) {
+    parse_pool_ = std::make_unique<boost::asio::thread_pool>(num_threads);
+  }
+  auto start = absl::GetCurrentTimeNanos();
   // There are 6 kinds of table data need to be loaded.
-  auto count_down = std::make_shared<int>(6);
-  auto on_load_finished = [count_down, on_done] {
+  auto count_down = std::make_shared<std::atomic<int>>(6);
+  auto on_load_finished = [this, count_down, on_done, start] {
     if (--(*count_down) == 0) {
-      if (on_done) {
+      RAY_LOG(INFO) << "Finished loading all the tables in "
+                    << (absl::GetCurrentTimeNanos() - start) / 1000000 << " ms.";
+      if (parse_pool_ != nullptr) {
+        // The last table may finish on a thread of the pool, which can't join the
+        // pool. Join it on the main thread before `on_done`, which may destroy this
+        // object.
+        main_io_service_->post(
+            [this, on_done] {
+              parse_pool_->join();
+              parse_pool_.reset();
+              if (on_done) {
+                on_done();
+              }
+            },
+            "GcsInitData.AsyncLoad");
+      } else if (on_done) {
         on_done();
       }
     }
@@ -42,80 +65,75 @@ void GcsInitData::AsyncLoad(const EmptyCallback &on_done) {
 
 void GcsInitData::AsyncLoadJobTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading job table data.";
-  auto load_job_table_data_callback =
-      [this, on_done](absl::flat_hash_map<JobID, rpc::JobTableData> &&result) {
-        job_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading job table data, size = "
-                      << job_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->JobTable().GetAll(load_job_table_data_callback));
+  auto load_job_table_data_callback = [this, on_done]() {
+    RAY_LOG(INFO) << "Finished loading job table data, size = "
+                  << job_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->JobTable().GetAllPaged(
+      MergeInto(job_table_data_), load_job_table_data_callback, parse_pool_.get()));
 }
 
 void GcsInitData::AsyncLoadNodeTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading node table data.";
-  auto load_node_table_data_callback =
-      [this, on_done](absl::flat_hash_map<NodeID, rpc::GcsNodeInfo> &&result) {
-        node_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading node table data, size = "
-                      << node_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->NodeTable().GetAll(load_node_table_data_callback));
+  auto load_node_table_data_callback = [this, on_done]() {
+    RAY_LOG(INFO) << "Finished loading node table data, size = "
+                  << node_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->NodeTable().GetAllPaged(
+      MergeInto(node_table_data_), load_node_table_data_callback, parse_pool_.get()));
 }
 
 void GcsInitData::AsyncLoadResourceTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading cluster resources table data.";
-  auto load_resource_table_data_callback =
-      [this, on_done](absl::flat_hash_map<NodeID, rpc::ResourceMap> &&result) {
-        resource_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading cluster resources table data, size = "
-                      << resource_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(
-      gcs_table_storage_->NodeResourceTable().GetAll(load_resource_table_data_callback));
+  auto load_resource_table_data_callback = [this, on_done]() {
+    RAY_LOG(INFO) << "Finished loading cluster resources table data, size = "
+                  << resource_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->NodeResourceTable().GetAllPaged(
+      MergeInto(resource_table_data_),
+      load_resource_table_data_callback,
+      parse_pool_.get()));
 }
 
 void GcsInitData::AsyncLoadPlacementGroupTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading placement group table data.";
-  auto load_placement_group_table_data_callback =
-      [this, on_done](
-          absl::flat_hash_map<PlacementGroupID, rpc::PlacementGroupTableData> &&result) {
-        placement_group_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading placement group table data, size = "
-                      << placement_group_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->PlacementGroupTable().GetAll(
-      load_placement_group_table_data_callback));
+  auto load_placement_group_table_data_callback = [this, on_done]() {
+    RAY_LOG(INFO) << "Finished loading placement group table data, size = "
+                  << placement_group_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->PlacementGroupTable().GetAllPaged(
+      MergeInto(placement_group_table_data_),
+      load_placement_group_table_data_callback,
+      parse_pool_.get()));
 }
 
 void GcsInitData::AsyncLoadActorTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading actor table data.";
-  auto load_actor_table_data_callback =
-      [this, on_done](absl::flat_hash_map<ActorID, ActorTableData> &&result) {
-        actor_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading actor table data, size = "
-                      << actor_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->ActorTable().AsyncRebuildIndexAndGetAll(
-      load_actor_table_data_callback));
+  auto load_actor_table_data_callback = [this, on_done]() {
+    RAY_LOG(INFO) << "Finished loading actor table data, size = "
+                  << actor_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->ActorTable().AsyncRebuildIndexAndGetAllPaged(
+      MergeInto(actor_table_data_), load_actor_table_data_callback, parse_pool_.get()));
 }
 
 void GcsInitData::AsyncLoadActorTaskSpecTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading actor task spec table data.";
-  auto load_actor_task_spec_table_data_callback =
-      [this, on_done](const absl::flat_hash_map<ActorID, TaskSpec> &result) {
-        actor_task_spec_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading actor task spec table data, size = "
-                      << actor_task_spec_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->ActorTaskSpecTable().GetAll(
-      load_actor_task_spec_table_data_callback));
+  auto load_actor_task_spec_table_data_callback = [this, on_done]() {
+    RAY_LOG(INFO) << "Finished loading actor task spec table data, size = "
+                  << actor_task_spec_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->ActorTaskSpecTable().GetAllPaged(
+      MergeInto(actor_task_spec_table_data_),
+      load_actor_task_spec_table_data_callback,
+      parse_pool_.get()));
 }
 
 }  // namespace gcs
-}  // namespace ray
\ No newline at end of file
+}  // namespace ray
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <boost/asio/thread_pool.hpp>
+
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/id.h"
 #include "ray/gcs/callback.h"
 #include "ray/gcs/gcs_server/gcs_table_storage.h"
@@ -26,6 +30,9 @@ namespace gcs {
 /// server restarts.
 /// It loads all required metadata from the store into memory at once, so that the next
 /// initialization process can be synchronized.
+///
+/// The tables are read from the store page by page. If a main io service is given, the
+/// pages are parsed in parallel on a pool of `gcs_init_data_load_threads` threads.
 class GcsInitData {
  public:
   /// Create a GcsInitData.
@@ -34,6 +41,15 @@ class GcsInitData {
   explicit GcsInitData(std::shared_ptr<gcs::GcsTableStorage> gcs_table_storage)
       : gcs_table_storage_(std::move(gcs_table_storage)) {}
 
+  /// Create a GcsInitData which parses the metadata in parallel.
+  ///
+  /// \param gcs_table_storage The storage from which the metadata will be loaded.
+  /// \param main_io_service The io service to post the `AsyncLoad` callback to.
+  GcsInitData(std::shared_ptr<gcs::GcsTableStorage> gcs_table_storage,
+              instrumented_io_context &main_io_service)
+      : gcs_table_storage_(std::move(gcs_table_storage)),
+        main_io_service_(&main_io_service) {}
+
   /// Load all required metadata from the store into memory at once asynchronously.
   ///
   /// \param on_done The callback when all metadatas are loaded successfully.
@@ -97,10 +113,33 @@ class GcsInitData {
 
   void AsyncLoadActorTaskSpecTableData(const EmptyCallback &on_done);
 
+  /// Create a page callback which moves the loaded pages into `table_data`.
+  template <typename Key, typename Data>
+  MapCallback<Key, Data> MergeInto(absl::flat_hash_map<Key, Data> &table_data) {
+    return [this, &table_data](absl::flat_hash_map<Key, Data> &&page) {
+      absl::MutexLock lock(&merge_mutex_);
+      table_data.reserve(table_data.size() + page.size());
+      for (auto &item : page) {
+        table_data.emplace(item.first, std::move(item.second));
+      }
+    };
+  }
+
  protected:
   /// The gcs table storage.
   std::shared_ptr<gcs::GcsTableStorage> gcs_table_storage_;
 
+  /// The io service to post the `AsyncLoad` callback to. If null, the metadata is
+  /// parsed in the storage callbacks.
+  instrumented_io_context *main_io_service_ = nullptr;
+
+  /// The thread pool to parse the metadata on. It's joined and destroyed on the main
+  /// thread once all the tables are loaded.
+  std::unique_ptr<boost::asio::thread_pool> parse_pool_;
+
+  /// Mutex to serialize the merges of the parsed pages into the fields below.
+  absl::Mutex merge_mutex_;
+
   /// Job metadata.
   absl::flat_hash_map<JobID, rpc::JobTableData> job_table_data_;
 
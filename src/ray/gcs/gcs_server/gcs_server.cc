@@ -30,8 +30,10 @@
 #include "ray/gcs/gcs_server/gcs_worker_manager.h"
 #include "ray/gcs/gcs_server/runtime_env_handler.h"
 #include "ray/gcs/gcs_server/store_client_kv.h"
+#include "ray/gcs/store_client/file_store_client.h"
 #include "ray/gcs/store_client/observable_store_client.h"
 #include "ray/pubsub/publisher.h"
+#include "ray/util/filesystem.h"
 
 namespace ray {
 namespace gcs {
@@ -60,6 +62,10 @@ GcsServer::GcsServer(const ray::gcs::GcsServerConfig &config,
     gcs_table_storage_ = std::make_shared<gcs::RedisGcsTableStorage>(GetOrConnectRedis());
   } else if (storage_type_ == "memory") {
     gcs_table_storage_ = std::make_shared<InMemoryGcsTableStorage>(main_service_);
+  } else if (storage_type_ == "file") {
+    gcs_table_storage_ = std::make_shared<FileGcsTableStorage>(
+        main_service_,
+        JoinPaths(RayConfig::instance().gcs_file_storage_dir(), "tables"));
   }
 
   auto on_done = [this](const ray::Status &status) {
@@ -116,7 +122,8 @@ RedisClientOptions GcsServer::GetRedisClientOptions() const {
 
 void GcsServer::Start() {
   // Load gcs tables data asynchronously.
-  auto gcs_init_data = std::make_shared<GcsInitData>(gcs_table_storage_);
+  auto gcs_init_data =
+      std::make_shared<GcsInitData>(gcs_table_storage_, main_service_);
   gcs_init_data->AsyncLoad([this, gcs_init_data] { DoStart(*gcs_init_data); });
 }
 
@@ -471,6 +478,11 @@ std::string GcsServer::StorageType() const {
     RAY_CHECK(!config_.redis_address.empty());
     return "redis";
   }
+  if (RayConfig::instance().gcs_storage() == "file") {
+    RAY_CHECK(!RayConfig::instance().gcs_file_storage_dir().empty())
+        << "gcs_file_storage_dir must be set to use the file GCS storage.";
+    return "file";
+  }
   RAY_LOG(FATAL) << "Unsupported GCS storage type: "
                  << RayConfig::instance().gcs_storage();
   return RayConfig::instance().gcs_storage();
@@ -522,6 +534,12 @@ void GcsServer::InitKVManager() {
     instance =
         std::make_unique<StoreClientInternalKV>(std::make_unique<ObservableStoreClient>(
             std::make_unique<InMemoryStoreClient>(main_service_)));
+  } else if (storage_type_ == "file") {
+    instance =
+        std::make_unique<StoreClientInternalKV>(std::make_unique<ObservableStoreClient>(
+            std::make_unique<FileStoreClient>(
+                main_service_,
+                JoinPaths(RayConfig::instance().gcs_file_storage_dir(), "kv"))));
   }
 
   kv_manager_ = std::make_unique<GcsInternalKVManager>(std::move(instance));
@@ -531,8 +549,10 @@ void GcsServer::InitKVManager() {
 }
 
 void GcsServer::InitPubSubHandler() {
-  pubsub_handler_ =
-      std::make_unique<InternalPubSubHandler>(pubsub_io_service_, gcs_publisher_);
+  pubsub_handler_ = std::make_unique<InternalPubSubHandler>(
+      pubsub_io_service_,
+      gcs_publisher_,
+      RayConfig::instance().gcs_server_pubsub_thread_num());
   pubsub_service_ = std::make_unique<rpc::InternalPubSubGrpcService>(pubsub_io_service_,
                                                                      *pubsub_handler_);
   // Register service.
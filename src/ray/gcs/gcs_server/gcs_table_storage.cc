@@ -14,7 +14,10 @@
 
 #include "ray/gcs/gcs_server/gcs_table_storage.h"
 
+#include <boost/asio/post.hpp>
+
 #include "ray/common/id.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/gcs/callback.h"
 
@@ -72,6 +75,59 @@ Status GcsTable<Key, Data>::GetAll(const MapCallback<Key, Data> &callback) {
   return store_client_->AsyncGetAll(table_name_, on_done);
 }
 
+template <typename Key, typename Data>
+Status GcsTable<Key, Data>::GetAllPaged(const MapCallback<Key, Data> &page_callback,
+                                        const EmptyCallback &on_done,
+                                        boost::asio::thread_pool *executor) {
+  // The number of pages being parsed, plus one until the store client has delivered
+  // all the pages.
+  auto pending_count = std::make_shared<std::atomic<int64_t>>(1);
+  auto finish_one = [pending_count, on_done]() {
+    if (--(*pending_count) == 0 && on_done) {
+      on_done();
+    }
+  };
+  auto parse = [page_callback](absl::flat_hash_map<std::string, std::string> &&page) {
+    if (!page_callback) {
+      return;
+    }
+    absl::flat_hash_map<Key, Data> values;
+    values.reserve(page.size());
+    for (auto &item : page) {
+      if (!item.second.empty()) {
+        values[Key::FromBinary(item.first)].ParseFromString(item.second);
+      }
+    }
+    page_callback(std::move(values));
+  };
+  // The number of pages queued or being parsed on the executor. The store client
+  // delivers the pages on a single thread.
+  auto num_pages_in_flight = std::make_shared<std::atomic<int64_t>>(0);
+  const int64_t max_pages_in_flight =
+      RayConfig::instance().gcs_init_data_max_pages_in_flight();
+  auto on_page = [parse,
+                  finish_one,
+                  pending_count,
+                  num_pages_in_flight,
+                  max_pages_in_flight,
+                  executor](absl::flat_hash_map<std::string, std::string> &&page) {
+    if (executor == nullptr || *num_pages_in_flight >= max_pages_in_flight) {
+      parse(std::move(page));
+      return;
+    }
+    ++(*num_pages_in_flight);
+    ++(*pending_count);
+    boost::asio::post(
+        *executor,
+        [parse, finish_one, num_pages_in_flight, page = std::move(page)]() mutable {
+          parse(std::move(page));
+          --(*num_pages_in_flight);
+          finish_one();
+        });
+  };
+  return store_client_->AsyncGetAllPaged(table_name_, on_page, finish_one);
+}
+
 template <typename Key, typename Data>
 Status GcsTable<Key, Data>::Delete(const Key &key, const StatusCallback &callback) {
   return store_client_->AsyncDelete(table_name_, key.Binary(), [callback](auto) {
@@ -201,6 +257,31 @@ Status GcsTableWithJobId<Key, Data>::AsyncRebuildIndexAndGetAll(
   });
 }
 
+template <typename Key, typename Data>
+Status GcsTableWithJobId<Key, Data>::AsyncRebuildIndexAndGetAllPaged(
+    const MapCallback<Key, Data> &page_callback,
+    const EmptyCallback &on_done,
+    boost::asio::thread_pool *executor) {
+  {
+    absl::MutexLock lock(&mutex_);
+    index_.clear();
+  }
+  return this->GetAllPaged(
+      [this, page_callback](absl::flat_hash_map<Key, Data> &&page) {
+        {
+          absl::MutexLock lock(&mutex_);
+          for (auto &item : page) {
+            index_[GetJobIdFromKey(item.first)].insert(item.first);
+          }
+        }
+        if (page_callback) {
+          page_callback(std::move(page));
+        }
+      },
+      on_done,
+      executor);
+}
+
 template class GcsTable<JobID, JobTableData>;
 template class GcsTable<NodeID, GcsNodeInfo>;
 template class GcsTable<NodeID, ResourceMap>;
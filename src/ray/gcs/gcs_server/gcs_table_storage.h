@@ -14,10 +14,12 @@
 
 #pragma once
 
+#include <boost/asio/thread_pool.hpp>
 #include <memory>
 #include <utility>
 
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/gcs/store_client/file_store_client.h"
 #include "ray/gcs/store_client/in_memory_store_client.h"
 #include "ray/gcs/store_client/observable_store_client.h"
 #include "ray/gcs/store_client/redis_store_client.h"
@@ -75,6 +77,21 @@ class GcsTable {
   /// \return Status
   Status GetAll(const MapCallback<Key, Data> &callback);
 
+  /// Get all data from the table asynchronously, page by page, so that the raw data of
+  /// the whole table doesn't need to be held in memory at once.
+  ///
+  /// \param page_callback Callback that will be called with the data of each page.
+  /// \param on_done Callback that will be called after all the pages have been passed
+  /// to `page_callback`.
+  /// \param executor If not null, the pages are parsed and passed to `page_callback`
+  /// on it in parallel, up to `gcs_init_data_max_pages_in_flight` pages at a time.
+  /// The other pages, or all of them if it's null, are parsed in the storage
+  /// callbacks.
+  /// \return Status
+  Status GetAllPaged(const MapCallback<Key, Data> &page_callback,
+                     const EmptyCallback &on_done,
+                     boost::asio::thread_pool *executor = nullptr);
+
   /// Delete data from the table asynchronously.
   ///
   /// \param key The key that will be deleted from the table.
@@ -151,6 +168,12 @@ class GcsTableWithJobId : public GcsTable<Key, Data> {
   /// Rebuild the index during startup.
   Status AsyncRebuildIndexAndGetAll(const MapCallback<Key, Data> &callback);
 
+  /// Rebuild the index during startup, page by page. Please refer to `GetAllPaged`
+  /// for the parameters.
+  Status AsyncRebuildIndexAndGetAllPaged(const MapCallback<Key, Data> &page_callback,
+                                         const EmptyCallback &on_done,
+                                         boost::asio::thread_pool *executor = nullptr);
+
  protected:
   virtual JobID GetJobIdFromKey(const Key &key) = 0;
 
@@ -355,5 +378,16 @@ class InMemoryGcsTableStorage : public GcsTableStorage {
             std::make_unique<InMemoryStoreClient>(main_io_service))) {}
 };
 
+/// \class FileGcsTableStorage
+/// FileGcsTableStorage is an implementation of `GcsTableStorage`
+/// that uses memory as storage and persists it to a local directory.
+class FileGcsTableStorage : public GcsTableStorage {
+ public:
+  FileGcsTableStorage(instrumented_io_context &main_io_service,
+                      const std::string &storage_dir)
+      : GcsTableStorage(std::make_shared<ObservableStoreClient>(
+            std::make_unique<FileStoreClient>(main_io_service, storage_dir))) {}
+};
+
 }  // namespace gcs
 }  // namespace ray
@@ -14,6 +14,8 @@
 
 #include "ray/gcs/gcs_server/gcs_task_manager.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/gcs/pb_util.h"
@@ -35,58 +37,260 @@ std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvent
   // probably have to do if we are supporting pagination in the future.
   // As for now, this will make sure data is returned w.r.t insertion order, so we could
   // return the more recent entries when limit applies.
-  RAY_CHECK(next_idx_to_overwrite_ == 0 || next_idx_to_overwrite_ < task_events_.size())
+  RAY_CHECK(next_idx_to_overwrite_ == 0 || next_idx_to_overwrite_ < task_events_.Size())
       << "next_idx_to_overwrite=" << next_idx_to_overwrite_
-      << " should be in bound. (size=" << task_events_.size() << ")";
+      << " should be in bound. (size=" << task_events_.Size() << ")";
+  ret.reserve(task_events_.Size());
   // Copy from the least recently generated data, where `next_idx_to_overwrite_` points to
-  // the least recently added data.
-  std::copy(task_events_.begin() + next_idx_to_overwrite_,
-            task_events_.end(),
-            std::back_inserter(ret));
-  // Copy the wrapped around if any
-  if (next_idx_to_overwrite_ > 0) {
-    std::copy(task_events_.begin(),
-              task_events_.begin() + next_idx_to_overwrite_,
-              std::back_inserter(ret));
+  // the least recently added data, then the wrapped around if any.
+  for (size_t i = 0; i < task_events_.Size(); ++i) {
+    ret.push_back(task_events_.Get((next_idx_to_overwrite_ + i) % task_events_.Size()));
   }
   return ret;
 }
 
-std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
-    JobID job_id) const {
-  auto task_attempts_itr = job_to_task_attempt_index_.find(job_id);
-  if (task_attempts_itr == job_to_task_attempt_index_.end()) {
-    // Not found any tasks related to this job.
-    return {};
+TaskEventsQueryResult GcsTaskManager::GcsTaskManagerStorage::QueryTaskEvents(
+    const TaskEventsQuery &query) const {
+  TaskEventsQueryResult result;
+  // The rows stored have the sequence numbers in [first_seq_no, num_rows_added_), and
+  // the query goes through the ones before the cursor, from the most recent.
+  const uint64_t first_seq_no = num_rows_added_ - task_events_.Size();
+  const uint64_t end_seq_no =
+      query.cursor.has_value() ? std::min(*query.cursor, num_rows_added_)
+                               : num_rows_added_;
+  if (end_seq_no <= first_seq_no) {
+    return result;
+  }
+
+  // Go through the candidates of the most selective index.
+  const absl::btree_set<uint64_t> *candidates = nullptr;
+  bool no_candidate = false;
+  auto select_index = [&candidates, &no_candidate](const auto &index, const auto &key) {
+    auto itr = index.find(key);
+    if (itr == index.end()) {
+      no_candidate = true;
+    } else if (candidates == nullptr || itr->second.size() < candidates->size()) {
+      candidates = &itr->second;
+    }
+  };
+  if (query.job_id.has_value()) {
+    select_index(job_query_index_, *query.job_id);
+  }
+  if (query.name.has_value()) {
+    select_index(name_query_index_, *query.name);
   }
-  return GetTaskEvents(task_attempts_itr->second);
+  if (query.actor_id.has_value()) {
+    select_index(actor_query_index_, *query.actor_id);
+  }
+  if (query.node_id.has_value()) {
+    select_index(node_query_index_, *query.node_id);
+  }
+  if (query.state.has_value()) {
+    select_index(state_query_index_, *query.state);
+  }
+  if (no_candidate) {
+    return result;
+  }
+  // Few tasks are usually queried by id, so their rows are better candidates.
+  absl::optional<std::vector<uint64_t>> task_seq_nos;
+  if (query.task_ids.has_value()) {
+    task_seq_nos.emplace();
+    for (const auto &task_id : *query.task_ids) {
+      auto task_attempts_itr = task_to_task_attempt_index_.find(task_id);
+      if (task_attempts_itr == task_to_task_attempt_index_.end()) {
+        continue;
+      }
+      for (const auto &task_attempt : task_attempts_itr->second) {
+        task_seq_nos->push_back(IndexToSeqNo(GetTaskEventIndex(task_attempt)));
+      }
+    }
+    std::sort(task_seq_nos->begin(), task_seq_nos->end(), std::greater<uint64_t>());
+  }
+
+  // Returns whether to go on.
+  uint64_t last_returned_seq_no = end_seq_no;
+  auto visit = [&](uint64_t seq_no) {
+    if (!MatchesQuery(query, seq_no)) {
+      return true;
+    }
+    auto idx = SeqNoToIndex(seq_no);
+    if (query.limit < 0 ||
+        static_cast<int64_t>(result.task_events.size()) < query.limit) {
+      result.task_events.push_back(task_events_.Get(idx));
+      last_returned_seq_no = seq_no;
+      return true;
+    }
+    // A match past the limit.
+    result.next_cursor = last_returned_seq_no;
+    if (!query.count_truncated) {
+      return false;
+    }
+    result.num_status_events_truncated += task_events_.HasStateUpdates(idx) ? 1 : 0;
+    result.num_profile_events_truncated += task_events_.NumProfileEvents(idx);
+    return true;
+  };
+
+  if (task_seq_nos.has_value() &&
+      (candidates == nullptr || task_seq_nos->size() < candidates->size())) {
+    for (auto seq_no : *task_seq_nos) {
+      if (seq_no < end_seq_no && !visit(seq_no)) {
+        break;
+      }
+    }
+  } else if (candidates != nullptr) {
+    for (auto itr = std::make_reverse_iterator(candidates->lower_bound(end_seq_no));
+         itr != candidates->rend();
+         ++itr) {
+      if (!visit(*itr)) {
+        break;
+      }
+    }
+  } else {
+    for (uint64_t seq_no = end_seq_no; seq_no > first_seq_no; --seq_no) {
+      if (!visit(seq_no - 1)) {
+        break;
+      }
+    }
+  }
+  return result;
 }
 
-std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
-    const absl::flat_hash_set<TaskID> &task_ids) const {
-  absl::flat_hash_set<TaskAttempt> select_task_attempts;
-  for (const auto &task_id : task_ids) {
-    auto task_attempts_itr = task_to_task_attempt_index_.find(task_id);
-    if (task_attempts_itr != task_to_task_attempt_index_.end()) {
-      select_task_attempts.insert(task_attempts_itr->second.begin(),
-                                  task_attempts_itr->second.end());
+bool GcsTaskManager::GcsTaskManagerStorage::MatchesQuery(const TaskEventsQuery &query,
+                                                         uint64_t seq_no) const {
+  auto idx = SeqNoToIndex(seq_no);
+  if (!task_events_.HasTaskInfo(idx)) {
+    // Skip task events w/o task info.
+    return false;
+  }
+  if (query.exclude_driver && driver_seq_nos_.contains(seq_no)) {
+    return false;
+  }
+  if (query.task_ids.has_value() &&
+      !query.task_ids->contains(task_events_.GetTaskId(idx))) {
+    return false;
+  }
+  if (query.job_id.has_value() && task_events_.GetJobId(idx) != *query.job_id) {
+    return false;
+  }
+  if (query.state.has_value() && task_events_.GetLatestStatus(idx) != query.state) {
+    return false;
+  }
+  if (query.node_id.has_value()) {
+    auto node_id = task_events_.GetNodeId(idx);
+    if (node_id == nullptr || *node_id != *query.node_id) {
+      return false;
     }
   }
+  // The values from the task info are checked on the indexes, not to parse it.
+  auto indexed = [seq_no](const auto &index, const std::string &key) {
+    auto itr = index.find(key);
+    return itr != index.end() && itr->second.contains(seq_no);
+  };
+  if (query.name.has_value() && !indexed(name_query_index_, *query.name)) {
+    return false;
+  }
+  if (query.actor_id.has_value() && !indexed(actor_query_index_, *query.actor_id)) {
+    return false;
+  }
+  return true;
+}
 
-  return GetTaskEvents(select_task_attempts);
+GcsTaskManager::GcsTaskManagerStorage::QueryKeys
+GcsTaskManager::GcsTaskManagerStorage::GetQueryKeys(size_t idx,
+                                                    bool with_task_info) const {
+  QueryKeys keys;
+  keys.job_id = task_events_.GetJobId(idx);
+  if (auto node_id = task_events_.GetNodeId(idx)) {
+    keys.node_id = *node_id;
+  }
+  keys.state = task_events_.GetLatestStatus(idx);
+  if (with_task_info && task_events_.HasTaskInfo(idx)) {
+    auto task_info = task_events_.GetTaskInfo(idx);
+    keys.task_info.emplace();
+    keys.task_info->name = task_info.name();
+    keys.task_info->actor_id = task_info.actor_id();
+    keys.task_info->is_driver = task_info.type() == rpc::TaskType::DRIVER_TASK;
+  }
+  return keys;
 }
 
-std::vector<rpc::TaskEvents> GcsTaskManager::GcsTaskManagerStorage::GetTaskEvents(
-    const absl::flat_hash_set<TaskAttempt> &task_attempts) const {
-  std::vector<rpc::TaskEvents> result;
-  for (const auto &task_attempt : task_attempts) {
-    auto idx_itr = task_attempt_index_.find(task_attempt);
-    if (idx_itr != task_attempt_index_.end()) {
-      result.push_back(task_events_.at(idx_itr->second));
+void GcsTaskManager::GcsTaskManagerStorage::UpdateQueryIndexes(uint64_t seq_no,
+                                                               const QueryKeys &keys,
+                                                               bool add) {
+  auto update = [seq_no, add](auto &index, const auto &key) {
+    if (add) {
+      index[key].insert(seq_no);
+      return;
+    }
+    auto itr = index.find(key);
+    if (itr == index.end()) {
+      return;
+    }
+    itr->second.erase(seq_no);
+    if (itr->second.empty()) {
+      index.erase(itr);
     }
+  };
+  if (!keys.job_id.IsNil()) {
+    update(job_query_index_, keys.job_id);
+  }
+  if (!keys.node_id.empty()) {
+    update(node_query_index_, keys.node_id);
+  }
+  if (keys.state.has_value()) {
+    update(state_query_index_, *keys.state);
   }
+  if (keys.task_info.has_value()) {
+    update(name_query_index_, keys.task_info->name);
+    if (!keys.task_info->actor_id.empty()) {
+      update(actor_query_index_, keys.task_info->actor_id);
+    }
+    if (keys.task_info->is_driver) {
+      if (add) {
+        driver_seq_nos_.insert(seq_no);
+      } else {
+        driver_seq_nos_.erase(seq_no);
+      }
+    }
+  }
+}
 
-  return result;
+void GcsTaskManager::GcsTaskManagerStorage::ReindexQueryKeys(uint64_t seq_no,
+                                                             const QueryKeys &old_keys,
+                                                             const QueryKeys &new_keys) {
+  if (old_keys == new_keys) {
+    return;
+  }
+  // Only move the keys that changed.
+  QueryKeys removed = old_keys;
+  QueryKeys added = new_keys;
+  if (old_keys.job_id == new_keys.job_id) {
+    removed.job_id = added.job_id = JobID::Nil();
+  }
+  if (old_keys.node_id == new_keys.node_id) {
+    removed.node_id.clear();
+    added.node_id.clear();
+  }
+  if (old_keys.state == new_keys.state) {
+    removed.state = added.state = absl::nullopt;
+  }
+  if (old_keys.task_info == new_keys.task_info) {
+    removed.task_info = added.task_info = absl::nullopt;
+  }
+  UpdateQueryIndexes(seq_no, removed, /*add=*/false);
+  UpdateQueryIndexes(seq_no, added, /*add=*/true);
+}
+
+size_t GcsTaskManager::GcsTaskManagerStorage::SeqNoToIndex(uint64_t seq_no) const {
+  return max_num_task_events_ > 0 ? seq_no % max_num_task_events_ : seq_no;
+}
+
+uint64_t GcsTaskManager::GcsTaskManagerStorage::IndexToSeqNo(size_t idx) const {
+  if (max_num_task_events_ == 0) {
+    return idx;
+  }
+  // The most recent sequence number that maps to `idx`.
+  return num_rows_added_ - 1 - (num_rows_added_ - 1 - idx) % max_num_task_events_;
 }
 
 absl::optional<TaskAttempt> GcsTaskManager::GcsTaskManagerStorage::GetLatestTaskAttempt(
@@ -110,33 +314,37 @@ absl::optional<TaskAttempt> GcsTaskManager::GcsTaskManagerStorage::GetLatestTask
   return latest_task_attempt;
 }
 
-rpc::TaskEvents &GcsTaskManager::GcsTaskManagerStorage::GetTaskEvent(
-    const TaskAttempt &task_attempt) {
+size_t GcsTaskManager::GcsTaskManagerStorage::GetTaskEventIndex(
+    const TaskAttempt &task_attempt) const {
   auto idx_itr = task_attempt_index_.find(task_attempt);
   RAY_CHECK(idx_itr != task_attempt_index_.end())
       << "Task attempt of task: " << task_attempt.first
       << ", attempt_number: " << task_attempt.second
       << " should have task events in the buffer but missing.";
-  return task_events_.at(idx_itr->second);
+  return idx_itr->second;
 }
 
-const rpc::TaskEvents &GcsTaskManager::GcsTaskManagerStorage::GetTaskEvent(
-    const TaskAttempt &task_attempt) const {
-  auto idx_itr = task_attempt_index_.find(task_attempt);
-  RAY_CHECK(idx_itr != task_attempt_index_.end())
-      << "Task attempt of task: " << task_attempt.first
-      << ", attempt_number: " << task_attempt.second
-      << " should have task events in the buffer but missing.";
-  return task_events_.at(idx_itr->second);
+void GcsTaskManager::GcsTaskManagerStorage::UpdateNumBytesStored() {
+  size_t num_bytes = task_events_.NumBytes();
+  if (num_bytes > num_bytes_stored_) {
+    stats_counter_.Increment(kNumTaskEventsBytesStored, num_bytes - num_bytes_stored_);
+  } else if (num_bytes < num_bytes_stored_) {
+    stats_counter_.Decrement(kNumTaskEventsBytesStored, num_bytes_stored_ - num_bytes);
+  }
+  num_bytes_stored_ = num_bytes;
 }
 
 void GcsTaskManager::GcsTaskManagerStorage::MarkTaskAttemptFailed(
     const TaskAttempt &task_attempt, int64_t failed_ts) {
-  auto &task_event = GetTaskEvent(task_attempt);
-  if (!task_event.has_state_updates()) {
+  auto idx = GetTaskEventIndex(task_attempt);
+  if (!task_events_.HasStateUpdates(idx)) {
     return;
   }
-  task_event.mutable_state_updates()->set_failed_ts(failed_ts);
+  auto old_keys = GetQueryKeys(idx, /*with_task_info=*/false);
+  task_events_.SetStatusUpdateTime(idx, rpc::TaskStatus::FAILED, failed_ts);
+  UpdateNumBytesStored();
+  ReindexQueryKeys(
+      IndexToSeqNo(idx), old_keys, GetQueryKeys(idx, /*with_task_info=*/false));
 }
 
 bool GcsTaskManager::GcsTaskManagerStorage::IsTaskTerminated(
@@ -153,10 +361,8 @@ absl::optional<int64_t> GcsTaskManager::GcsTaskManagerStorage::GetTaskStatusUpda
     return absl::nullopt;
   }
 
-  const auto &task_event = GetTaskEvent(*latest_task_attempt);
-  return task_event.has_state_updates()
-             ? GetTaskStatusTimeFromStateUpdates(task_status, task_event.state_updates())
-             : absl::nullopt;
+  return task_events_.GetStatusUpdateTime(GetTaskEventIndex(*latest_task_attempt),
+                                          task_status);
 }
 
 void GcsTaskManager::GcsTaskManagerStorage::MarkTasksFailed(const JobID &job_id,
@@ -248,17 +454,19 @@ GcsTaskManager::GcsTaskManagerStorage::AddOrReplaceTaskEvent(
   if (itr != task_attempt_index_.end()) {
     // Existing task attempt entry, merge.
     auto idx = itr->second;
-    auto &existing_events = task_events_.at(idx);
 
     // Update the events.
-    if (events_by_task.has_task_info() && !existing_events.has_task_info()) {
+    if (events_by_task.has_task_info() && !task_events_.HasTaskInfo(idx)) {
       stats_counter_.Increment(
           kTaskTypeToCounterType.at(events_by_task.task_info().type()));
     }
 
-    stats_counter_.Decrement(kNumTaskEventsBytesStored, existing_events.ByteSizeLong());
-    existing_events.MergeFrom(events_by_task);
-    stats_counter_.Increment(kNumTaskEventsBytesStored, existing_events.ByteSizeLong());
+    // The task info only changes if there is one in the events.
+    bool with_task_info = events_by_task.has_task_info();
+    auto old_keys = GetQueryKeys(idx, with_task_info);
+    task_events_.Merge(idx, events_by_task);
+    UpdateNumBytesStored();
+    ReindexQueryKeys(IndexToSeqNo(idx), old_keys, GetQueryKeys(idx, with_task_info));
 
     MarkTaskTreeFailedIfNeeded(task_id, parent_task_id);
     return absl::nullopt;
@@ -275,21 +483,22 @@ GcsTaskManager::GcsTaskManagerStorage::AddOrReplaceTaskEvent(
   // If limit enforced, replace one.
   // TODO(rickyx): Optimize this to per job limit with bounded FIFO map.
   // https://github.com/ray-project/ray/issues/31071
-  if (max_num_task_events_ > 0 && task_events_.size() >= max_num_task_events_) {
+  if (max_num_task_events_ > 0 && task_events_.Size() >= max_num_task_events_) {
     RAY_LOG_EVERY_MS(WARNING, 10000)
         << "Max number of tasks event (" << max_num_task_events_
         << ") allowed is reached. Old task events will be overwritten. Set "
            "`RAY_task_events_max_num_task_in_gcs` to a higher value to "
            "store more.";
 
-    stats_counter_.Decrement(kNumTaskEventsBytesStored,
-                             task_events_[next_idx_to_overwrite_].ByteSizeLong());
-    stats_counter_.Increment(kNumTaskEventsBytesStored, events_by_task.ByteSizeLong());
-
     // Change the underlying storage.
-    auto &to_replaced = task_events_.at(next_idx_to_overwrite_);
-    std::swap(to_replaced, events_by_task);
-    auto replaced = std::move(events_by_task);
+    UpdateQueryIndexes(IndexToSeqNo(next_idx_to_overwrite_),
+                       GetQueryKeys(next_idx_to_overwrite_, /*with_task_info=*/true),
+                       /*add=*/false);
+    auto replaced = task_events_.Replace(next_idx_to_overwrite_, events_by_task);
+    UpdateNumBytesStored();
+    UpdateQueryIndexes(num_rows_added_++,
+                       GetQueryKeys(next_idx_to_overwrite_, /*with_task_info=*/true),
+                       /*add=*/true);
 
     // Update task_attempt -> buffer index mapping.
     TaskAttempt replaced_attempt = std::make_pair<>(
@@ -340,14 +549,17 @@ GcsTaskManager::GcsTaskManagerStorage::AddOrReplaceTaskEvent(
   }
 
   // Add to index.
-  task_attempt_index_[task_attempt] = task_events_.size();
+  task_attempt_index_[task_attempt] = task_events_.Size();
   job_to_task_attempt_index_[job_id].insert(task_attempt);
   task_to_task_attempt_index_[task_id].insert(task_attempt);
   // Add a new task events.
-  stats_counter_.Increment(kNumTaskEventsBytesStored, events_by_task.ByteSizeLong());
   stats_counter_.Increment(kNumTaskEventsStored);
 
-  task_events_.push_back(std::move(events_by_task));
+  task_events_.Append(events_by_task);
+  UpdateNumBytesStored();
+  UpdateQueryIndexes(num_rows_added_++,
+                     GetQueryKeys(task_events_.Size() - 1, /*with_task_info=*/true),
+                     /*add=*/true);
 
   MarkTaskTreeFailedIfNeeded(task_id, parent_task_id);
   return absl::nullopt;
@@ -358,55 +570,72 @@ void GcsTaskManager::HandleGetTaskEvents(rpc::GetTaskEventsRequest request,
                                          rpc::SendReplyCallback send_reply_callback) {
   RAY_LOG(DEBUG) << "Getting task status:" << request.ShortDebugString();
 
-  // Select candidate events by indexing.
-  std::vector<rpc::TaskEvents> task_events;
+  TaskEventsQuery query;
   if (request.has_task_ids()) {
-    absl::flat_hash_set<TaskID> task_ids;
+    query.task_ids.emplace();
     for (const auto &task_id_str : request.task_ids().vals()) {
-      task_ids.insert(TaskID::FromBinary(task_id_str));
+      query.task_ids->insert(TaskID::FromBinary(task_id_str));
     }
-    task_events = task_event_storage_->GetTaskEvents(task_ids);
   } else if (request.has_job_id()) {
-    task_events = task_event_storage_->GetTaskEvents(JobID::FromBinary(request.job_id()));
-  } else {
-    task_events = task_event_storage_->GetTaskEvents();
+    query.job_id = JobID::FromBinary(request.job_id());
   }
-
-  // Populate reply.
-  auto limit = request.has_limit() ? request.limit() : -1;
-  // Simple limit.
-  auto count = 0;
-  int32_t num_profile_event_limit = 0;
-  int32_t num_status_event_limit = 0;
-
-  for (auto itr = task_events.rbegin(); itr != task_events.rend(); ++itr) {
-    auto &task_event = *itr;
-    if (!task_event.has_task_info()) {
-      // Skip task events w/o task info.
-      continue;
+  const auto &filters = request.filters();
+  if (filters.has_name()) {
+    query.name = filters.name();
+  }
+  if (filters.has_state()) {
+    query.state = filters.state();
+  }
+  if (filters.has_actor_id()) {
+    query.actor_id = filters.actor_id();
+  }
+  if (filters.has_node_id()) {
+    query.node_id = filters.node_id();
+  }
+  query.exclude_driver = request.exclude_driver();
+  query.limit = request.has_limit() ? request.limit() : -1;
+  if (request.has_page_token()) {
+    if (request.has_limit() && request.limit() <= 0) {
+      // A page would never move the cursor forward.
+      GCS_RPC_SEND_REPLY(
+          send_reply_callback,
+          reply,
+          Status::Invalid(absl::StrCat("Paginated queries need a positive limit, got ",
+                                       request.limit())));
+      return;
     }
-
-    if (request.exclude_driver() &&
-        task_event.task_info().type() == rpc::TaskType::DRIVER_TASK) {
-      continue;
+    // Events past the limit are on the next pages, not dropped.
+    query.count_truncated = false;
+    if (!request.page_token().empty()) {
+      uint64_t cursor = 0;
+      if (!absl::SimpleAtoi(request.page_token(), &cursor)) {
+        GCS_RPC_SEND_REPLY(
+            send_reply_callback,
+            reply,
+            Status::Invalid("Invalid page token: " + request.page_token()));
+        return;
+      }
+      query.cursor = cursor;
     }
+  }
 
-    if (limit < 0 || count++ < limit) {
-      auto events = reply->add_events_by_task();
-      events->Swap(&task_event);
-    } else {
-      num_profile_event_limit +=
-          task_event.has_profile_events() ? task_event.profile_events().events_size() : 0;
-      num_status_event_limit += task_event.has_state_updates() ? 1 : 0;
-    }
+  auto result = task_event_storage_->QueryTaskEvents(query);
+  reply->mutable_events_by_task()->Reserve(result.task_events.size());
+  for (auto &task_event : result.task_events) {
+    reply->add_events_by_task()->Swap(&task_event);
+  }
+  if (result.next_cursor.has_value()) {
+    reply->set_next_page_token(absl::StrCat(*result.next_cursor));
   }
   // TODO(rickyx): We will need to revisit the data loss semantics, to report data loss
   // on a single task retry(attempt) rather than the actual events.
   // https://github.com/ray-project/ray/issues/31280
   reply->set_num_profile_task_events_dropped(
-      stats_counter_.Get(kTotalNumProfileTaskEventsDropped) + num_profile_event_limit);
+      stats_counter_.Get(kTotalNumProfileTaskEventsDropped) +
+      result.num_profile_events_truncated);
   reply->set_num_status_task_events_dropped(
-      stats_counter_.Get(kTotalNumStatusTaskEventsDropped) + num_status_event_limit);
+      stats_counter_.Get(kTotalNumStatusTaskEventsDropped) +
+      result.num_status_events_truncated);
 
   GCS_RPC_SEND_REPLY(send_reply_callback, reply, Status::OK());
   return;
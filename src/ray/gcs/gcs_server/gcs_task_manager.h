@@ -15,10 +15,12 @@
 #pragma once
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/gcs/gcs_client/usage_stats_client.h"
+#include "ray/gcs/gcs_server/task_events_table.h"
 #include "ray/rpc/gcs_server/gcs_rpc_server.h"
 #include "ray/util/counter_map.h"
 #include "src/ray/protobuf/gcs.pb.h"
@@ -48,6 +50,46 @@ const absl::flat_hash_map<rpc::TaskType, GcsTaskManagerCounter> kTaskTypeToCount
     {rpc::TaskType::DRIVER_TASK, kTotalNumDriverTask},
 };
 
+/// A query of the task events stored, parsed from a `rpc::GetTaskEventsRequest`.
+struct TaskEventsQuery {
+  /// Only the task events of these tasks, if set.
+  absl::optional<absl::flat_hash_set<TaskID>> task_ids;
+  /// Only the task events of this job, if set.
+  absl::optional<JobID> job_id;
+  /// Only the task events of the tasks with this name, if set.
+  absl::optional<std::string> name;
+  /// Only the task events whose latest status is this one, if set.
+  absl::optional<rpc::TaskStatus> state;
+  /// Only the task events of the tasks of this actor (binary id), if set.
+  absl::optional<std::string> actor_id;
+  /// Only the task events that ran on this node (binary id), if set.
+  absl::optional<std::string> node_id;
+  /// Whether to skip the task events of drivers.
+  bool exclude_driver = false;
+  /// Max number of task events to return, no limit if negative.
+  int64_t limit = -1;
+  /// Only the task events added before the cursor, returned as `next_cursor` of the
+  /// previous page. From the most recently added one if unset.
+  absl::optional<uint64_t> cursor;
+  /// Whether to count the task events that match but are not returned because of
+  /// `limit`. This needs to go through all the matches.
+  bool count_truncated = true;
+};
+
+/// The result of a `TaskEventsQuery`.
+struct TaskEventsQueryResult {
+  /// The task events that match, from the most recently added one.
+  std::vector<rpc::TaskEvents> task_events;
+  /// The cursor of the next page, set if more task events may match.
+  absl::optional<uint64_t> next_cursor;
+  /// Number of status events in the task events not returned because of the limit, if
+  /// `count_truncated`.
+  int32_t num_status_events_truncated = 0;
+  /// Number of profile events in the task events not returned because of the limit, if
+  /// `count_truncated`.
+  int32_t num_profile_events_truncated = 0;
+};
+
 /// GcsTaskManger is responsible for capturing task states change reported by
 /// TaskEventBuffer from other components.
 ///
@@ -128,7 +170,8 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
   /// This class is not thread-safe.
   ///
   /// It merges events from a single task attempt (same task id and attempt number) into
-  /// a single rpc::TaskEvents entry, as reported by multiple rpc calls from workers.
+  /// a single entry, as reported by multiple rpc calls from workers. The entries are
+  /// kept in a `TaskEventsTable`, which is much more compact than rpc::TaskEvents.
   ///
   /// When more than `RAY_task_events_max_num_task_in_gcs` task events are stored in the
   /// the storage, older task events will be replaced by new task events, where older
@@ -153,12 +196,6 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// replaced task event.
     absl::optional<rpc::TaskEvents> AddOrReplaceTaskEvent(rpc::TaskEvents &&task_event);
 
-    /// Get task events from job.
-    ///
-    /// \param job_id Job ID to filter task events.
-    /// \return task events of `job_id`.
-    std::vector<rpc::TaskEvents> GetTaskEvents(JobID job_id) const;
-
     /// Get all task events.
     ///
     /// This retrieves copies of all task events ordered from the least recently inserted
@@ -167,19 +204,15 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// \return all task events stored sorted with insertion order.
     std::vector<rpc::TaskEvents> GetTaskEvents() const;
 
-    /// Get task events from tasks corresponding to `task_ids`.
+    /// Get the task events that match a query, from the most recently added.
     ///
-    /// \param task_ids Task ids of the tasks.
-    /// \return task events from the `task_ids`.
-    std::vector<rpc::TaskEvents> GetTaskEvents(
-        const absl::flat_hash_set<TaskID> &task_ids) const;
-
-    /// Get task events of task attempt.
+    /// The candidates come from the most selective index of the query, and the other
+    /// filters are checked on the stored columns, so only the task events returned are
+    /// copied. Without `count_truncated`, it stops at the first match past the limit.
     ///
-    /// \param task_attempts Task attempts (task ids + attempt number).
-    /// \return task events from the `task_attempts`.
-    std::vector<rpc::TaskEvents> GetTaskEvents(
-        const absl::flat_hash_set<TaskAttempt> &task_attempts) const;
+    /// \param query The query.
+    /// \return The task events that match, with the cursor of the next page.
+    TaskEventsQueryResult QueryTaskEvents(const TaskEventsQuery &query) const;
 
     ///  Mark tasks from a job as failed.
     ///
@@ -212,17 +245,69 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// \param parent_task_id ID of the task's parent.
     void MarkTaskTreeFailedIfNeeded(const TaskID &task_id, const TaskID &parent_task_id);
 
-    /// Get a reference to the TaskEvent stored in the buffer.
+    /// Get the index of the task events of a task attempt in `task_events_`.
     ///
-    /// \param task_attempt The task attempt.
-    /// \return Reference to the task events stored in the buffer.
-    rpc::TaskEvents &GetTaskEvent(const TaskAttempt &task_attempt);
+    /// \param task_attempt The task attempt, which must be stored.
+    /// \return Index of the task events of the task attempt.
+    size_t GetTaskEventIndex(const TaskAttempt &task_attempt) const;
+
+    /// Update the stats of the number of bytes stored, after `task_events_` changed.
+    void UpdateNumBytesStored();
+
+    /// The values of a row of `task_events_` that the query indexes are keyed by.
+    struct QueryKeys {
+      /// The values that come from the task info. Only read when the task info could
+      /// have changed.
+      struct TaskInfoKeys {
+        std::string name;
+        std::string actor_id;
+        bool is_driver = false;
+        bool operator==(const TaskInfoKeys &other) const {
+          return name == other.name && actor_id == other.actor_id &&
+                 is_driver == other.is_driver;
+        }
+      };
+
+      JobID job_id;
+      std::string node_id;
+      absl::optional<rpc::TaskStatus> state;
+      absl::optional<TaskInfoKeys> task_info;
+
+      bool operator==(const QueryKeys &other) const {
+        return job_id == other.job_id && node_id == other.node_id &&
+               state == other.state && task_info == other.task_info;
+      }
+    };
+
+    /// Get the query keys of the row at `idx` of `task_events_`.
+    ///
+    /// \param idx The row.
+    /// \param with_task_info Whether to read the keys from the task info, which needs
+    /// to parse it.
+    QueryKeys GetQueryKeys(size_t idx, bool with_task_info) const;
 
-    /// Get a const reference to the TaskEvent stored in the buffer.
+    /// Add or remove the row with a sequence number to the query indexes.
     ///
-    /// \param task_attempt The task attempt.
-    /// \return Reference to the task events stored in the buffer.
-    const rpc::TaskEvents &GetTaskEvent(const TaskAttempt &task_attempt) const;
+    /// \param seq_no The sequence number of the row.
+    /// \param keys The keys of the row.
+    /// \param add Whether to add or remove the row.
+    void UpdateQueryIndexes(uint64_t seq_no, const QueryKeys &keys, bool add);
+
+    /// Move the row with a sequence number in the query indexes from its old keys to
+    /// its new keys, if they changed.
+    void ReindexQueryKeys(uint64_t seq_no,
+                          const QueryKeys &old_keys,
+                          const QueryKeys &new_keys);
+
+    /// Get the index in `task_events_` of the row with a sequence number.
+    size_t SeqNoToIndex(uint64_t seq_no) const;
+
+    /// Get the sequence number of the row at `idx` of `task_events_`.
+    uint64_t IndexToSeqNo(size_t idx) const;
+
+    /// Whether the row with a sequence number matches the filters of a query, apart
+    /// from the cursor.
+    bool MatchesQuery(const TaskEventsQuery &query, uint64_t seq_no) const;
 
     /// Get the timestamp of a task status update.
     ///
@@ -276,7 +361,10 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     /// TODO(rickyx): Refactor this into LRI(least recently inserted) buffer:
     /// https://github.com/ray-project/ray/issues/31158
     /// Current task events stored.
-    std::vector<rpc::TaskEvents> task_events_;
+    TaskEventsTable task_events_;
+
+    /// The number of bytes of `task_events_` last recorded in the stats.
+    size_t num_bytes_stored_ = 0;
 
     /// Index from task attempt to the corresponding task attempt in the buffer
     /// `task_events_`.
@@ -294,6 +382,22 @@ class GcsTaskManager : public rpc::TaskInfoHandler {
     absl::flat_hash_map<TaskID, absl::flat_hash_set<TaskID>>
         parent_to_children_task_index_;
 
+    /// Number of rows ever added to `task_events_`. Rows get increasing sequence
+    /// numbers as they are added or replaced, so that the row with sequence number `s`
+    /// is at index `s % max_num_task_events_` (or `s` if there is no max). Queries
+    /// return the rows by decreasing sequence number, which is what their cursors are.
+    uint64_t num_rows_added_ = 0;
+
+    /// Indexes for queries, from a value to the sequence numbers of the rows with the
+    /// value, in order.
+    absl::flat_hash_map<JobID, absl::btree_set<uint64_t>> job_query_index_;
+    absl::flat_hash_map<std::string, absl::btree_set<uint64_t>> name_query_index_;
+    absl::flat_hash_map<std::string, absl::btree_set<uint64_t>> actor_query_index_;
+    absl::flat_hash_map<std::string, absl::btree_set<uint64_t>> node_query_index_;
+    absl::flat_hash_map<rpc::TaskStatus, absl::btree_set<uint64_t>> state_query_index_;
+    /// The sequence numbers of the rows of driver tasks.
+    absl::flat_hash_set<uint64_t> driver_seq_nos_;
+
     /// Reference to the counter map owned by the GcsTaskManager.
     CounterMapThreadSafe<GcsTaskManagerCounter> &stats_counter_;
 
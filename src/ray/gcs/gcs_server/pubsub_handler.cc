@@ -19,15 +19,12 @@ namespace gcs {
 
 InternalPubSubHandler::InternalPubSubHandler(
     instrumented_io_context &io_service,
-    const std::shared_ptr<gcs::GcsPublisher> &gcs_publisher)
-    : io_service_(io_service), gcs_publisher_(gcs_publisher) {
-  io_service_thread_ = std::make_unique<std::thread>([this] {
-    SetThreadName("pubsub");
-    // Keep io_service_ alive.
-    boost::asio::io_service::work io_service_work_(io_service_);
-    io_service_.run();
-  });
-}
+    const std::shared_ptr<gcs::GcsPublisher> &gcs_publisher,
+    int num_threads)
+    : io_service_(io_service),
+      executor_(
+          std::make_unique<rpc::ServiceExecutor>(io_service_, num_threads, "pubsub")),
+      gcs_publisher_(gcs_publisher) {}
 
 void InternalPubSubHandler::HandleGcsPublish(rpc::GcsPublishRequest request,
                                              rpc::GcsPublishReply *reply,
@@ -114,12 +111,7 @@ void InternalPubSubHandler::HandleGcsSubscriberCommandBatch(
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
-void InternalPubSubHandler::Stop() {
-  io_service_.stop();
-  if (io_service_thread_->joinable()) {
-    io_service_thread_->join();
-  }
-}
+void InternalPubSubHandler::Stop() { executor_->Stop(); }
 
 }  // namespace gcs
 }  // namespace ray
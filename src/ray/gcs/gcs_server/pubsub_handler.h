@@ -26,8 +26,13 @@ namespace gcs {
 /// de-registering subscribers.
 class InternalPubSubHandler : public rpc::InternalPubSubHandler {
  public:
+  /// \param io_service The event loop of the pubsub handlers.
+  /// \param gcs_publisher The publisher. It's thread-safe, so the handlers can run
+  /// in parallel.
+  /// \param num_threads The number of threads that run the pubsub handlers.
   InternalPubSubHandler(instrumented_io_context &io_service,
-                        const std::shared_ptr<gcs::GcsPublisher> &gcs_publisher);
+                        const std::shared_ptr<gcs::GcsPublisher> &gcs_publisher,
+                        int num_threads = 1);
 
   void HandleGcsPublish(rpc::GcsPublishRequest request,
                         rpc::GcsPublishReply *reply,
@@ -41,7 +46,7 @@ class InternalPubSubHandler : public rpc::InternalPubSubHandler {
                                        rpc::GcsSubscriberCommandBatchReply *reply,
                                        rpc::SendReplyCallback send_reply_callback) final;
 
-  // Stops the event loop and the thread of the pubsub handler.
+  // Stops the event loop and the threads of the pubsub handler.
   void Stop();
 
   std::string DebugString() const;
@@ -49,7 +54,8 @@ class InternalPubSubHandler : public rpc::InternalPubSubHandler {
  private:
   /// Not owning the io service, to allow sharing it with pubsub::Publisher.
   instrumented_io_context &io_service_;
-  std::unique_ptr<std::thread> io_service_thread_;
+  /// Runs `io_service_`.
+  std::unique_ptr<rpc::ServiceExecutor> executor_;
   std::shared_ptr<gcs::GcsPublisher> gcs_publisher_;
 };
 
@@ -0,0 +1,471 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/task_events_table.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "ray/gcs/pb_util.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace gcs {
+
+namespace {
+
+/// The statuses that have a timestamp in `rpc::TaskStateUpdate`, in the order they
+/// usually happen, which keeps the deltas between them small.
+constexpr rpc::TaskStatus kTimestampStatuses[] = {
+    rpc::TaskStatus::PENDING_ARGS_AVAIL,
+    rpc::TaskStatus::PENDING_NODE_ASSIGNMENT,
+    rpc::TaskStatus::SUBMITTED_TO_WORKER,
+    rpc::TaskStatus::RUNNING,
+    rpc::TaskStatus::FINISHED,
+    rpc::TaskStatus::FAILED,
+};
+
+constexpr size_t kNumTimestamps = sizeof(kTimestampStatuses) / sizeof(rpc::TaskStatus);
+
+/// Serialize with a deterministic order of map entries, so that equal task infos have
+/// equal bytes.
+std::string SerializeDeterministic(const rpc::TaskInfoEntry &message) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_stream);
+  }
+  return serialized;
+}
+
+/// Append `value` as a zigzag varint, so that small negative values are short too.
+template <typename Container>
+void AppendVarint(int64_t value, Container *out) {
+  uint64_t zigzag =
+      (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  while (zigzag >= 0x80) {
+    out->push_back(static_cast<uint8_t>(zigzag | 0x80));
+    zigzag >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(zigzag));
+}
+
+/// Read a zigzag varint written by `AppendVarint`, and advance `pos` past it.
+int64_t ReadVarint(const uint8_t **pos) {
+  uint64_t zigzag = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = *(*pos)++;
+    zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      break;
+    }
+  }
+  return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+}
+
+/// The difference of two timestamps, wrapping around instead of overflowing.
+int64_t Delta(int64_t to, int64_t from) {
+  return static_cast<int64_t>(static_cast<uint64_t>(to) - static_cast<uint64_t>(from));
+}
+
+int64_t AddDelta(int64_t from, int64_t delta) {
+  return static_cast<int64_t>(static_cast<uint64_t>(from) + static_cast<uint64_t>(delta));
+}
+
+}  // namespace
+
+const std::string *StringPool::Intern(const std::string &value) {
+  auto it = strings_.find(value);
+  if (it == strings_.end()) {
+    it = strings_.emplace(value, 0).first;
+    num_bytes_ += value.size() + sizeof(decltype(strings_)::value_type);
+  }
+  it->second++;
+  return &it->first;
+}
+
+void StringPool::Release(const std::string *value) {
+  if (value == nullptr) {
+    return;
+  }
+  auto it = strings_.find(*value);
+  RAY_CHECK(it != strings_.end());
+  if (--it->second == 0) {
+    num_bytes_ -= it->first.size() + sizeof(decltype(strings_)::value_type);
+    strings_.erase(it);
+  }
+}
+
+void TaskEventsTable::Append(const rpc::TaskEvents &task_events) {
+  flags_.push_back(0);
+  task_ids_.emplace_back();
+  job_ids_.emplace_back();
+  attempt_numbers_.push_back(0);
+  task_infos_.push_back(nullptr);
+  parent_task_ids_.emplace_back();
+  node_ids_.push_back(nullptr);
+  worker_ids_.push_back(nullptr);
+  base_timestamps_.push_back(0);
+  timestamp_deltas_.emplace_back();
+  profile_events_.emplace_back();
+
+  size_t idx = Size() - 1;
+  SetRow(idx, task_events);
+  heap_bytes_ += HeapBytes(idx);
+}
+
+rpc::TaskEvents TaskEventsTable::Replace(size_t idx, const rpc::TaskEvents &task_events) {
+  auto replaced = Get(idx);
+  heap_bytes_ -= HeapBytes(idx);
+  ClearRow(idx);
+  SetRow(idx, task_events);
+  heap_bytes_ += HeapBytes(idx);
+  return replaced;
+}
+
+void TaskEventsTable::Merge(size_t idx, const rpc::TaskEvents &task_events) {
+  heap_bytes_ -= HeapBytes(idx);
+  // The task id of a row doesn't change, since rows are merged by task attempt.
+  if (!task_events.job_id().empty()) {
+    flags_[idx] |= kHasJobId;
+    job_ids_[idx] = JobID::FromBinary(task_events.job_id());
+  }
+  if (task_events.attempt_number() != 0) {
+    attempt_numbers_[idx] = task_events.attempt_number();
+  }
+  if (task_events.has_task_info()) {
+    auto task_info = HasTaskInfo(idx) ? GetTaskInfo(idx) : rpc::TaskInfoEntry();
+    task_info.MergeFrom(task_events.task_info());
+    ClearTaskInfo(idx);
+    SetTaskInfo(idx, std::move(task_info));
+  }
+  if (task_events.has_state_updates()) {
+    auto state_updates =
+        HasStateUpdates(idx) ? GetStateUpdates(idx) : rpc::TaskStateUpdate();
+    state_updates.MergeFrom(task_events.state_updates());
+    ClearStateUpdates(idx);
+    SetStateUpdates(idx, state_updates);
+  }
+  if (task_events.has_profile_events()) {
+    auto profile_events =
+        profile_events_[idx] ? GetProfileEvents(idx) : rpc::ProfileEvents();
+    profile_events.MergeFrom(task_events.profile_events());
+    ClearProfileEvents(idx);
+    SetProfileEvents(idx, profile_events);
+  }
+  heap_bytes_ += HeapBytes(idx);
+}
+
+rpc::TaskEvents TaskEventsTable::Get(size_t idx) const {
+  rpc::TaskEvents task_events;
+  task_events.set_task_id(task_ids_[idx].Binary());
+  if (flags_[idx] & kHasJobId) {
+    task_events.set_job_id(job_ids_[idx].Binary());
+  }
+  task_events.set_attempt_number(attempt_numbers_[idx]);
+  if (HasTaskInfo(idx)) {
+    *task_events.mutable_task_info() = GetTaskInfo(idx);
+  }
+  if (HasStateUpdates(idx)) {
+    *task_events.mutable_state_updates() = GetStateUpdates(idx);
+  }
+  if (profile_events_[idx]) {
+    *task_events.mutable_profile_events() = GetProfileEvents(idx);
+  }
+  return task_events;
+}
+
+absl::optional<int64_t> TaskEventsTable::GetStatusUpdateTime(
+    size_t idx, rpc::TaskStatus task_status) const {
+  if (!HasStateUpdates(idx)) {
+    return absl::nullopt;
+  }
+  for (size_t i = 0; i < kNumTimestamps; i++) {
+    if (kTimestampStatuses[i] == task_status) {
+      return GetTimestamps(idx)[i];
+    }
+  }
+  return absl::nullopt;
+}
+
+void TaskEventsTable::SetStatusUpdateTime(size_t idx,
+                                          rpc::TaskStatus task_status,
+                                          int64_t timestamp) {
+  RAY_CHECK(HasStateUpdates(idx));
+  for (size_t i = 0; i < kNumTimestamps; i++) {
+    if (kTimestampStatuses[i] == task_status) {
+      heap_bytes_ -= HeapBytes(idx);
+      auto timestamps = GetTimestamps(idx);
+      timestamps[i] = timestamp;
+      SetTimestamps(idx, timestamps);
+      heap_bytes_ += HeapBytes(idx);
+      return;
+    }
+  }
+  RAY_LOG(FATAL) << "Task status " << rpc::TaskStatus_Name(task_status)
+                 << " doesn't have a timestamp.";
+}
+
+absl::optional<rpc::TaskStatus> TaskEventsTable::GetLatestStatus(size_t idx) const {
+  if (!HasStateUpdates(idx)) {
+    return absl::nullopt;
+  }
+  // `kTimestampStatuses` is in the order of `rpc::TaskStatus`.
+  for (size_t i = kNumTimestamps; i > 0; i--) {
+    if (flags_[idx] & (kFirstTimestampBit << (i - 1))) {
+      return kTimestampStatuses[i - 1];
+    }
+  }
+  return absl::nullopt;
+}
+
+size_t TaskEventsTable::NumBytes() const {
+  static constexpr size_t kRowBytes =
+      sizeof(uint16_t) + 2 * sizeof(TaskID) + sizeof(JobID) + sizeof(int32_t) +
+      3 * sizeof(const std::string *) + sizeof(int64_t) +
+      sizeof(absl::InlinedVector<uint8_t, 16>) +
+      sizeof(std::unique_ptr<ProfileEventsColumns>);
+  return Size() * kRowBytes + heap_bytes_ + strings_.NumBytes();
+}
+
+void TaskEventsTable::SetRow(size_t idx, const rpc::TaskEvents &task_events) {
+  task_ids_[idx] = TaskID::FromBinary(task_events.task_id());
+  if (!task_events.job_id().empty()) {
+    flags_[idx] |= kHasJobId;
+    job_ids_[idx] = JobID::FromBinary(task_events.job_id());
+  }
+  attempt_numbers_[idx] = task_events.attempt_number();
+  if (task_events.has_task_info()) {
+    SetTaskInfo(idx, task_events.task_info());
+  }
+  if (task_events.has_state_updates()) {
+    SetStateUpdates(idx, task_events.state_updates());
+  }
+  if (task_events.has_profile_events()) {
+    SetProfileEvents(idx, task_events.profile_events());
+  }
+}
+
+void TaskEventsTable::ClearRow(size_t idx) {
+  ClearTaskInfo(idx);
+  ClearStateUpdates(idx);
+  ClearProfileEvents(idx);
+  flags_[idx] = 0;
+  job_ids_[idx] = JobID::Nil();
+  attempt_numbers_[idx] = 0;
+}
+
+void TaskEventsTable::SetTaskInfo(size_t idx, rpc::TaskInfoEntry task_info) {
+  // The task ids are unique to each task, so they are kept out of the interned bytes.
+  if (task_info.task_id() == task_ids_[idx].Binary()) {
+    flags_[idx] |= kTaskInfoHasTaskId;
+    task_info.clear_task_id();
+  }
+  if (!task_info.parent_task_id().empty()) {
+    flags_[idx] |= kTaskInfoHasParentTaskId;
+    parent_task_ids_[idx] = TaskID::FromBinary(task_info.parent_task_id());
+    task_info.clear_parent_task_id();
+  }
+  task_infos_[idx] = strings_.Intern(SerializeDeterministic(task_info));
+}
+
+rpc::TaskInfoEntry TaskEventsTable::GetTaskInfo(size_t idx) const {
+  rpc::TaskInfoEntry task_info;
+  RAY_CHECK(task_info.ParseFromString(*task_infos_[idx]));
+  if (flags_[idx] & kTaskInfoHasTaskId) {
+    task_info.set_task_id(task_ids_[idx].Binary());
+  }
+  if (flags_[idx] & kTaskInfoHasParentTaskId) {
+    task_info.set_parent_task_id(parent_task_ids_[idx].Binary());
+  }
+  return task_info;
+}
+
+void TaskEventsTable::ClearTaskInfo(size_t idx) {
+  strings_.Release(task_infos_[idx]);
+  task_infos_[idx] = nullptr;
+  parent_task_ids_[idx] = TaskID::Nil();
+  flags_[idx] &= ~(kTaskInfoHasTaskId | kTaskInfoHasParentTaskId);
+}
+
+void TaskEventsTable::SetStateUpdates(size_t idx,
+                                      const rpc::TaskStateUpdate &state_updates) {
+  flags_[idx] |= kHasStateUpdates;
+  if (state_updates.has_node_id()) {
+    node_ids_[idx] = strings_.Intern(state_updates.node_id());
+  }
+  if (state_updates.has_worker_id()) {
+    worker_ids_[idx] = strings_.Intern(state_updates.worker_id());
+  }
+  std::vector<absl::optional<int64_t>> timestamps;
+  for (auto task_status : kTimestampStatuses) {
+    timestamps.push_back(GetTaskStatusTimeFromStateUpdates(task_status, state_updates));
+  }
+  SetTimestamps(idx, timestamps);
+}
+
+rpc::TaskStateUpdate TaskEventsTable::GetStateUpdates(size_t idx) const {
+  rpc::TaskStateUpdate state_updates;
+  if (node_ids_[idx]) {
+    state_updates.set_node_id(*node_ids_[idx]);
+  }
+  if (worker_ids_[idx]) {
+    state_updates.set_worker_id(*worker_ids_[idx]);
+  }
+  auto timestamps = GetTimestamps(idx);
+  for (size_t i = 0; i < kNumTimestamps; i++) {
+    if (timestamps[i].has_value()) {
+      FillTaskStatusUpdateTime(kTimestampStatuses[i], *timestamps[i], &state_updates);
+    }
+  }
+  return state_updates;
+}
+
+void TaskEventsTable::ClearStateUpdates(size_t idx) {
+  strings_.Release(node_ids_[idx]);
+  strings_.Release(worker_ids_[idx]);
+  node_ids_[idx] = nullptr;
+  worker_ids_[idx] = nullptr;
+  SetTimestamps(idx, std::vector<absl::optional<int64_t>>(kNumTimestamps));
+  flags_[idx] &= ~kHasStateUpdates;
+}
+
+std::vector<absl::optional<int64_t>> TaskEventsTable::GetTimestamps(size_t idx) const {
+  std::vector<absl::optional<int64_t>> timestamps(kNumTimestamps);
+  const uint8_t *pos = timestamp_deltas_[idx].data();
+  absl::optional<int64_t> previous;
+  for (size_t i = 0; i < kNumTimestamps; i++) {
+    if (!(flags_[idx] & (kFirstTimestampBit << i))) {
+      continue;
+    }
+    timestamps[i] = previous.has_value() ? AddDelta(*previous, ReadVarint(&pos))
+                                         : base_timestamps_[idx];
+    previous = timestamps[i];
+  }
+  return timestamps;
+}
+
+void TaskEventsTable::SetTimestamps(
+    size_t idx, const std::vector<absl::optional<int64_t>> &timestamps) {
+  auto &deltas = timestamp_deltas_[idx];
+  deltas.clear();
+  base_timestamps_[idx] = 0;
+  absl::optional<int64_t> previous;
+  for (size_t i = 0; i < kNumTimestamps; i++) {
+    const uint16_t bit = kFirstTimestampBit << i;
+    if (!timestamps[i].has_value()) {
+      flags_[idx] &= ~bit;
+      continue;
+    }
+    flags_[idx] |= bit;
+    if (previous.has_value()) {
+      AppendVarint(Delta(*timestamps[i], *previous), &deltas);
+    } else {
+      base_timestamps_[idx] = *timestamps[i];
+    }
+    previous = timestamps[i];
+  }
+  deltas.shrink_to_fit();
+}
+
+void TaskEventsTable::SetProfileEvents(size_t idx,
+                                       const rpc::ProfileEvents &profile_events) {
+  auto intern_if_set = [this](const std::string &value) {
+    return value.empty() ? nullptr : strings_.Intern(value);
+  };
+  auto columns = std::make_unique<ProfileEventsColumns>();
+  columns->component_type = intern_if_set(profile_events.component_type());
+  columns->component_id = intern_if_set(profile_events.component_id());
+  columns->node_ip_address = intern_if_set(profile_events.node_ip_address());
+  columns->event_names.reserve(profile_events.events_size());
+  columns->extra_data.reserve(profile_events.events_size());
+  int64_t previous_start_time = 0;
+  for (const auto &event : profile_events.events()) {
+    columns->event_names.push_back(intern_if_set(event.event_name()));
+    columns->extra_data.push_back(
+        event.has_extra_data() ? strings_.Intern(event.extra_data()) : nullptr);
+    AppendVarint(Delta(event.start_time(), previous_start_time), &columns->times);
+    AppendVarint(Delta(event.end_time(), event.start_time()), &columns->times);
+    previous_start_time = event.start_time();
+  }
+  columns->times.shrink_to_fit();
+  profile_events_[idx] = std::move(columns);
+}
+
+rpc::ProfileEvents TaskEventsTable::GetProfileEvents(size_t idx) const {
+  const auto &columns = *profile_events_[idx];
+  rpc::ProfileEvents profile_events;
+  if (columns.component_type) {
+    profile_events.set_component_type(*columns.component_type);
+  }
+  if (columns.component_id) {
+    profile_events.set_component_id(*columns.component_id);
+  }
+  if (columns.node_ip_address) {
+    profile_events.set_node_ip_address(*columns.node_ip_address);
+  }
+  const uint8_t *pos = columns.times.data();
+  int64_t previous_start_time = 0;
+  for (size_t i = 0; i < columns.event_names.size(); i++) {
+    auto event = profile_events.add_events();
+    if (columns.event_names[i]) {
+      event->set_event_name(*columns.event_names[i]);
+    }
+    if (columns.extra_data[i]) {
+      event->set_extra_data(*columns.extra_data[i]);
+    }
+    int64_t start_time = AddDelta(previous_start_time, ReadVarint(&pos));
+    event->set_start_time(start_time);
+    event->set_end_time(AddDelta(start_time, ReadVarint(&pos)));
+    previous_start_time = start_time;
+  }
+  return profile_events;
+}
+
+void TaskEventsTable::ClearProfileEvents(size_t idx) {
+  const auto &columns = profile_events_[idx];
+  if (!columns) {
+    return;
+  }
+  strings_.Release(columns->component_type);
+  strings_.Release(columns->component_id);
+  strings_.Release(columns->node_ip_address);
+  for (const auto *event_name : columns->event_names) {
+    strings_.Release(event_name);
+  }
+  for (const auto *extra_data : columns->extra_data) {
+    strings_.Release(extra_data);
+  }
+  profile_events_[idx].reset();
+}
+
+size_t TaskEventsTable::HeapBytes(size_t idx) const {
+  size_t bytes = 0;
+  const auto &deltas = timestamp_deltas_[idx];
+  if (deltas.capacity() > 16) {
+    bytes += deltas.capacity();
+  }
+  if (const auto &columns = profile_events_[idx]) {
+    bytes += sizeof(ProfileEventsColumns) +
+             columns->event_names.capacity() * sizeof(const std::string *) +
+             columns->extra_data.capacity() * sizeof(const std::string *) +
+             columns->times.capacity();
+  }
+  return bytes;
+}
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,221 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/types/optional.h"
+#include "ray/common/id.h"
+#include "src/ray/protobuf/gcs.pb.h"
+
+namespace ray {
+namespace gcs {
+
+/// Reference counted strings shared by the rows of a `TaskEventsTable`.
+///
+/// This class is not thread-safe.
+class StringPool {
+ public:
+  /// Take a reference to `value`, adding it to the pool if it's new.
+  ///
+  /// \return The pooled string, which is valid until its last reference is released.
+  const std::string *Intern(const std::string &value);
+
+  /// Release a reference to a pooled string, removing it if unused. No-op for nullptr.
+  void Release(const std::string *value);
+
+  /// Number of different strings in the pool.
+  size_t Size() const { return strings_.size(); }
+
+  /// Approximate number of bytes used by the pool.
+  size_t NumBytes() const { return num_bytes_; }
+
+ private:
+  /// The strings and their number of references. A node map so that the keys have
+  /// stable addresses.
+  absl::node_hash_map<std::string, int64_t> strings_;
+
+  size_t num_bytes_ = 0;
+};
+
+/// The task events of the task attempts tracked by GCS, stored column by column.
+///
+/// Each row holds the same data as a `rpc::TaskEvents`, and rows are converted from
+/// and to `rpc::TaskEvents` without loss. But it takes a fraction of the memory:
+///   - Strings that repeat across tasks are interned: the task info without the task
+///   ids (name, function, resources, runtime env...), the node and worker ids, and the
+///   strings of the profile events.
+///   - The timestamps of the state updates and the profile events are delta-encoded as
+///   varints.
+///   - There is no per message overhead.
+///
+/// This class is not thread-safe.
+class TaskEventsTable {
+ public:
+  TaskEventsTable() = default;
+
+  TaskEventsTable(const TaskEventsTable &) = delete;
+  TaskEventsTable &operator=(const TaskEventsTable &) = delete;
+
+  /// Number of rows.
+  size_t Size() const { return task_ids_.size(); }
+
+  /// Add a row.
+  void Append(const rpc::TaskEvents &task_events);
+
+  /// Overwrite the row at `idx`.
+  ///
+  /// \return The task events that were in the row.
+  rpc::TaskEvents Replace(size_t idx, const rpc::TaskEvents &task_events);
+
+  /// Merge task events into the row at `idx`, like `rpc::TaskEvents::MergeFrom`.
+  void Merge(size_t idx, const rpc::TaskEvents &task_events);
+
+  /// Get the task events of the row at `idx`.
+  rpc::TaskEvents Get(size_t idx) const;
+
+  /// Get the task id of the row at `idx`.
+  const TaskID &GetTaskId(size_t idx) const { return task_ids_[idx]; }
+
+  /// Get the job id of the row at `idx`, nil if the row doesn't have one.
+  JobID GetJobId(size_t idx) const {
+    return (flags_[idx] & kHasJobId) ? job_ids_[idx] : JobID::Nil();
+  }
+
+  /// Whether the row at `idx` has task info.
+  bool HasTaskInfo(size_t idx) const { return task_infos_[idx] != nullptr; }
+
+  /// Get the task info of the row at `idx`, which must have task info.
+  rpc::TaskInfoEntry GetTaskInfo(size_t idx) const;
+
+  /// Whether the row at `idx` has state updates.
+  bool HasStateUpdates(size_t idx) const { return flags_[idx] & kHasStateUpdates; }
+
+  /// Get the time of a status update of the row at `idx`.
+  ///
+  /// \return The timestamp, absl::nullopt if the row doesn't have the status update.
+  absl::optional<int64_t> GetStatusUpdateTime(size_t idx,
+                                              rpc::TaskStatus task_status) const;
+
+  /// Set the time of a status update of the row at `idx`, which must have state
+  /// updates.
+  void SetStatusUpdateTime(size_t idx, rpc::TaskStatus task_status, int64_t timestamp);
+
+  /// Get the latest status of the row at `idx`, i.e. the last one in the order of
+  /// `rpc::TaskStatus` that has a status update time.
+  ///
+  /// \return The status, absl::nullopt if the row doesn't have status update times.
+  absl::optional<rpc::TaskStatus> GetLatestStatus(size_t idx) const;
+
+  /// Get the node id of the state updates of the row at `idx`.
+  ///
+  /// \return The binary node id, nullptr if unset.
+  const std::string *GetNodeId(size_t idx) const { return node_ids_[idx]; }
+
+  /// Number of profile events of the row at `idx`.
+  size_t NumProfileEvents(size_t idx) const {
+    return profile_events_[idx] ? profile_events_[idx]->event_names.size() : 0;
+  }
+
+  /// Approximate number of bytes used by the table.
+  size_t NumBytes() const;
+
+  /// Number of different strings interned by the table.
+  size_t NumInternedStrings() const { return strings_.Size(); }
+
+ private:
+  /// The profile events of a row, see `rpc::ProfileEvents`.
+  struct ProfileEventsColumns {
+    const std::string *component_type = nullptr;
+    const std::string *component_id = nullptr;
+    const std::string *node_ip_address = nullptr;
+    std::vector<const std::string *> event_names;
+    /// Null if the event doesn't have extra data.
+    std::vector<const std::string *> extra_data;
+    /// For each event, the difference of its start time from the start time of the
+    /// previous event, then its duration, as zigzag varints.
+    std::vector<uint8_t> times;
+  };
+
+  enum RowFlags : uint16_t {
+    kHasJobId = 1 << 0,
+    kHasStateUpdates = 1 << 1,
+    /// The task info has the task id, which is the same as the task id of the row.
+    kTaskInfoHasTaskId = 1 << 2,
+    kTaskInfoHasParentTaskId = 1 << 3,
+    /// The bits from this one on tell which status update times are set, in the order
+    /// of `kTimestampStatuses`.
+    kFirstTimestampBit = 1 << 4,
+  };
+
+  /// Write the row at `idx`, which must be empty.
+  void SetRow(size_t idx, const rpc::TaskEvents &task_events);
+
+  /// Release what the row at `idx` refers to, and empty it.
+  void ClearRow(size_t idx);
+
+  void SetTaskInfo(size_t idx, rpc::TaskInfoEntry task_info);
+  void ClearTaskInfo(size_t idx);
+
+  void SetStateUpdates(size_t idx, const rpc::TaskStateUpdate &state_updates);
+  rpc::TaskStateUpdate GetStateUpdates(size_t idx) const;
+  void ClearStateUpdates(size_t idx);
+
+  /// Get the timestamps of the state updates of the row at `idx`, in the order of
+  /// `kTimestampStatuses`.
+  std::vector<absl::optional<int64_t>> GetTimestamps(size_t idx) const;
+  void SetTimestamps(size_t idx, const std::vector<absl::optional<int64_t>> &timestamps);
+
+  void SetProfileEvents(size_t idx, const rpc::ProfileEvents &profile_events);
+  rpc::ProfileEvents GetProfileEvents(size_t idx) const;
+  void ClearProfileEvents(size_t idx);
+
+  /// The bytes a row uses on the heap, apart from interned strings.
+  size_t HeapBytes(size_t idx) const;
+
+  std::vector<uint16_t> flags_;
+  std::vector<TaskID> task_ids_;
+  std::vector<JobID> job_ids_;
+  std::vector<int32_t> attempt_numbers_;
+
+  /// The serialized task info without its task id and parent task id. Null if the row
+  /// doesn't have task info.
+  std::vector<const std::string *> task_infos_;
+  std::vector<TaskID> parent_task_ids_;
+
+  /// The node and worker ids of the state updates. Null if unset.
+  std::vector<const std::string *> node_ids_;
+  std::vector<const std::string *> worker_ids_;
+  /// The first status update time that is set.
+  std::vector<int64_t> base_timestamps_;
+  /// The differences of the other status update times that are set from the
+  /// previous one, as zigzag varints.
+  std::vector<absl::InlinedVector<uint8_t, 16>> timestamp_deltas_;
+
+  /// Null if the row doesn't have profile events, which is the common case.
+  std::vector<std::unique_ptr<ProfileEventsColumns>> profile_events_;
+
+  StringPool strings_;
+
+  /// Sum of `HeapBytes` of all rows.
+  size_t heap_bytes_ = 0;
+};
+
+}  // namespace gcs
+}  // namespace ray
@@ -16,6 +16,7 @@
 
 #include <google/protobuf/util/message_differencer.h>
 
+#include "absl/time/clock.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ray/gcs/pb_util.h"
@@ -107,9 +108,6 @@ class GcsTaskManagerTest : public ::testing::Test {
                                             int64_t limit = -1,
                                             bool exclude_driver = true) {
     rpc::GetTaskEventsRequest request;
-    rpc::GetTaskEventsReply reply;
-    std::promise<bool> promise;
-
     if (!task_ids.empty()) {
       for (const auto &task_id : task_ids) {
         request.mutable_task_ids()->add_vals(task_id.Binary());
@@ -125,6 +123,15 @@ class GcsTaskManagerTest : public ::testing::Test {
     }
 
     request.set_exclude_driver(exclude_driver);
+    auto reply = SyncGetTaskEvents(request);
+    EXPECT_EQ(StatusCode(reply.status().code()), StatusCode::OK);
+    return reply;
+  }
+
+  rpc::GetTaskEventsReply SyncGetTaskEvents(const rpc::GetTaskEventsRequest &request) {
+    rpc::GetTaskEventsReply reply;
+    std::promise<bool> promise;
+
     task_manager->GetIoContext().dispatch(
         [this, &promise, &request, &reply]() {
           task_manager->HandleGetTaskEvents(
@@ -137,8 +144,6 @@ class GcsTaskManagerTest : public ::testing::Test {
         "SyncGetTaskEvents");
 
     promise.get_future().get();
-
-    EXPECT_EQ(StatusCode(reply.status().code()), StatusCode::OK);
     return reply;
   }
 
@@ -256,7 +261,7 @@ TEST_F(GcsTaskManagerTest, TestHandleAddTaskEventBasic) {
 
   // Assert on actual data.
   {
-    EXPECT_EQ(task_manager->task_event_storage_->task_events_.size(), num_task_events);
+    EXPECT_EQ(task_manager->task_event_storage_->task_events_.Size(), num_task_events);
     EXPECT_EQ(task_manager->GetTotalNumTaskEventsReported(), num_task_events);
     EXPECT_EQ(task_manager->GetTotalNumProfileTaskEventsDropped(),
               num_profile_events_dropped);
@@ -281,9 +286,9 @@ TEST_F(GcsTaskManagerTest, TestMergeTaskEventsSameTaskAttempt) {
 
   // Assert on actual data
   {
-    EXPECT_EQ(task_manager->task_event_storage_->task_events_.size(), 1);
+    EXPECT_EQ(task_manager->task_event_storage_->task_events_.Size(), 1);
     // Assert on events
-    auto task_events = task_manager->task_event_storage_->task_events_[0];
+    auto task_events = task_manager->task_event_storage_->task_events_.Get(0);
     // Sort and assert profile events merged matched
     std::sort(task_events.mutable_profile_events()->mutable_events()->begin(),
               task_events.mutable_profile_events()->mutable_events()->end(),
@@ -672,7 +677,7 @@ TEST_F(GcsTaskManagerMemoryLimitedTest, TestIndexNoLeak) {
   }
   // Assert on the indexes and the storage
   {
-    EXPECT_EQ(task_manager->task_event_storage_->task_events_.size(), num_limit);
+    EXPECT_EQ(task_manager->task_event_storage_->task_events_.Size(), num_limit);
     EXPECT_EQ(task_manager->task_event_storage_->stats_counter_.Get(kTotalNumNormalTask),
               task_ids.size() + num_limit);
     // No task has parent.
@@ -684,6 +689,17 @@ TEST_F(GcsTaskManagerMemoryLimitedTest, TestIndexNoLeak) {
               num_limit);
     EXPECT_EQ(task_manager->task_event_storage_->job_to_task_attempt_index_.size(), 1);
     EXPECT_EQ(task_manager->task_event_storage_->task_attempt_index_.size(), num_limit);
+
+    // The query indexes only have the rows in memory.
+    const auto &storage = *task_manager->task_event_storage_;
+    EXPECT_EQ(storage.job_query_index_.size(), 1);
+    EXPECT_EQ(storage.job_query_index_.begin()->second.size(), num_limit);
+    EXPECT_EQ(storage.name_query_index_.size(), 1);
+    EXPECT_EQ(storage.name_query_index_.begin()->second.size(), num_limit);
+    EXPECT_EQ(storage.state_query_index_.size(), 1);
+    EXPECT_EQ(storage.state_query_index_.begin()->second.size(), num_limit);
+    EXPECT_TRUE(storage.actor_query_index_.empty());
+    EXPECT_TRUE(storage.node_query_index_.empty());
   }
 }
 
@@ -735,7 +751,7 @@ TEST_F(GcsTaskManagerMemoryLimitedTest, TestLimitTaskEvents) {
     EXPECT_EQ(task_manager->GetTotalNumTaskEventsReported(), num_batch1 + num_batch2);
 
     std::sort(expected_events.begin(), expected_events.end(), SortByTaskAttempt);
-    auto actual_events = task_manager->task_event_storage_->task_events_;
+    auto actual_events = task_manager->task_event_storage_->GetTaskEvents();
     std::sort(actual_events.begin(), actual_events.end(), SortByTaskAttempt);
     EXPECT_EQ(actual_events.size(), expected_events.size());
     for (size_t i = 0; i < actual_events.size(); ++i) {
@@ -828,5 +844,365 @@ TEST_F(GcsTaskManagerMemoryLimitedTest, TestLimitReturnRecentTasksWhenGetAll) {
   }
 }
 
+TEST_F(GcsTaskManagerTest, TestGetTaskEventsWithFilters) {
+  auto actor_id = ActorID::Of(JobID::FromInt(0), RandomTaskId(), 0);
+  auto node_id = NodeID::FromRandom();
+  auto task_ids = GenTaskIDs(6);
+  for (size_t i = 0; i < task_ids.size(); i++) {
+    auto task_info = GenTaskInfo(JobID::FromInt(0));
+    task_info.set_name(i % 2 == 0 ? "f" : "g");
+    if (i < 2) {
+      task_info.set_actor_id(actor_id.Binary());
+    }
+    auto state_update = GenStateUpdate({{rpc::TaskStatus::PENDING_ARGS_AVAIL, 1}});
+    if (i >= 3) {
+      state_update.set_node_id(node_id.Binary());
+    }
+    auto events = GenTaskEvents({task_ids[i]},
+                                /* attempt_number */ 0,
+                                /* job_id */ 0,
+                                /* profile event */ absl::nullopt,
+                                state_update,
+                                task_info);
+    SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+  }
+  // The tasks 4 and 5 run, then 5 finishes.
+  for (size_t i = 4; i < task_ids.size(); i++) {
+    auto status = i == 4 ? rpc::TaskStatus::RUNNING : rpc::TaskStatus::FINISHED;
+    auto events = GenTaskEvents({task_ids[i]},
+                                /* attempt_number */ 0,
+                                /* job_id */ 0,
+                                /* profile event */ absl::nullopt,
+                                GenStateUpdate({{status, 2}}));
+    SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+  }
+
+  auto get_task_ids = [this](const rpc::GetTaskEventsRequest::Filters &filters) {
+    rpc::GetTaskEventsRequest request;
+    request.mutable_filters()->CopyFrom(filters);
+    auto reply = SyncGetTaskEvents(request);
+    EXPECT_EQ(StatusCode(reply.status().code()), StatusCode::OK);
+    std::vector<TaskID> result;
+    for (const auto &task_event : reply.events_by_task()) {
+      result.push_back(TaskID::FromBinary(task_event.task_id()));
+    }
+    return result;
+  };
+
+  {
+    rpc::GetTaskEventsRequest::Filters filters;
+    filters.set_name("f");
+    EXPECT_THAT(get_task_ids(filters),
+                testing::ElementsAre(task_ids[4], task_ids[2], task_ids[0]));
+    filters.set_actor_id(actor_id.Binary());
+    EXPECT_THAT(get_task_ids(filters), testing::ElementsAre(task_ids[0]));
+  }
+  {
+    rpc::GetTaskEventsRequest::Filters filters;
+    filters.set_node_id(node_id.Binary());
+    EXPECT_THAT(get_task_ids(filters),
+                testing::ElementsAre(task_ids[5], task_ids[4], task_ids[3]));
+    filters.set_state(rpc::TaskStatus::PENDING_ARGS_AVAIL);
+    EXPECT_THAT(get_task_ids(filters), testing::ElementsAre(task_ids[3]));
+  }
+  {
+    rpc::GetTaskEventsRequest::Filters filters;
+    filters.set_state(rpc::TaskStatus::RUNNING);
+    EXPECT_THAT(get_task_ids(filters), testing::ElementsAre(task_ids[4]));
+    filters.set_state(rpc::TaskStatus::FINISHED);
+    EXPECT_THAT(get_task_ids(filters), testing::ElementsAre(task_ids[5]));
+    filters.set_name("f");
+    EXPECT_THAT(get_task_ids(filters), testing::IsEmpty());
+  }
+
+  // Tasks marked failed move to the failed state.
+  task_manager->OnJobFinished(JobID::FromInt(0), /* job_finish_time_ms */ 3);
+  {
+    rpc::GetTaskEventsRequest::Filters filters;
+    filters.set_state(rpc::TaskStatus::FAILED);
+    auto poll = [&]() { return get_task_ids(filters).size() == 5; };
+    ASSERT_TRUE(WaitForCondition(poll, 10000));
+    filters.set_state(rpc::TaskStatus::PENDING_ARGS_AVAIL);
+    EXPECT_THAT(get_task_ids(filters), testing::IsEmpty());
+  }
+}
+
+TEST_F(GcsTaskManagerMemoryLimitedTest, TestPaginateTaskEvents) {
+  size_t num_limit = 100;  // synced with test config
+  size_t page_size = 30;
+  auto task_ids = GenTaskIDs(num_limit + 50);
+  for (const auto &task_id : task_ids) {
+    auto events = GenTaskEvents({task_id},
+                                /* attempt_number */ 0,
+                                /* job_id */ 0,
+                                GenProfileEvents("event", 1, 1),
+                                GenStateUpdate());
+    SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+  }
+
+  rpc::GetTaskEventsRequest request;
+  request.set_limit(page_size);
+  request.set_page_token("");
+  std::vector<TaskID> paginated;
+  std::string paginated_token;
+  size_t num_pages = 0;
+  while (true) {
+    auto reply = SyncGetTaskEvents(request);
+    ASSERT_EQ(StatusCode(reply.status().code()), StatusCode::OK);
+    num_pages++;
+    // Events past the limit are not dropped when paginating, only the evicted ones.
+    int32_t num_evicted = num_pages == 1 ? 50 : 51;
+    EXPECT_EQ(reply.num_status_task_events_dropped(), num_evicted);
+    EXPECT_EQ(reply.num_profile_task_events_dropped(), num_evicted);
+    for (const auto &task_event : reply.events_by_task()) {
+      paginated.push_back(TaskID::FromBinary(task_event.task_id()));
+    }
+    if (!reply.has_next_page_token()) {
+      break;
+    }
+    request.set_page_token(reply.next_page_token());
+    paginated_token = reply.next_page_token();
+
+    // Task events added while paginating are not returned in later pages, and the one
+    // it evicts is not either.
+    if (num_pages == 1) {
+      auto events = GenTaskEvents(GenTaskIDs(1));
+      SyncAddTaskEventData(Mocker::GenTaskEventsData(events));
+      task_ids.erase(task_ids.begin() + 50);
+    }
+  }
+  EXPECT_EQ(num_pages, (num_limit + page_size - 1) / page_size);
+  // From the most recent ones, without the one evicted while paginating.
+  std::vector<TaskID> expected(task_ids.rbegin(), task_ids.rbegin() + num_limit - 1);
+  EXPECT_EQ(paginated, expected);
+
+  request.set_page_token("not a page token");
+  EXPECT_EQ(StatusCode(SyncGetTaskEvents(request).status().code()),
+            StatusCode::Invalid);
+
+  // A page with no events would return its own cursor as the next page token.
+  request.set_page_token(paginated_token);
+  for (int64_t limit : {0, -1}) {
+    request.set_limit(limit);
+    EXPECT_EQ(StatusCode(SyncGetTaskEvents(request).status().code()),
+              StatusCode::Invalid);
+  }
+}
+
+// Query task events by each of the indexes. Every 100th task is still running,
+// every 10000th is an actor task, and names and nodes repeat every 1000 and 100
+// tasks.
+TEST(GcsTaskManagerStorageTest, QueryByIndexes) {
+  const size_t kNumTasks = 20000;
+  const size_t kNumNodes = 100;
+  CounterMapThreadSafe<GcsTaskManagerCounter> stats_counter;
+  GcsTaskManager::GcsTaskManagerStorage storage(kNumTasks, stats_counter);
+  std::vector<NodeID> node_ids;
+  for (size_t i = 0; i < kNumNodes; i++) {
+    node_ids.push_back(NodeID::FromRandom());
+  }
+  auto actor_id = ActorID::Of(JobID::FromInt(1), RandomTaskId(), 0);
+  std::vector<TaskID> task_ids;
+  for (size_t i = 0; i < kNumTasks; i++) {
+    task_ids.push_back(RandomTaskId());
+    rpc::TaskEvents events;
+    events.set_task_id(task_ids.back().Binary());
+    events.set_job_id(JobID::FromInt(1).Binary());
+    auto task_info = events.mutable_task_info();
+    task_info->set_type(rpc::TaskType::NORMAL_TASK);
+    task_info->set_name("task_" + std::to_string(i % 1000));
+    task_info->set_job_id(JobID::FromInt(1).Binary());
+    if (i % 10000 == 0) {
+      task_info->set_type(rpc::TaskType::ACTOR_TASK);
+      task_info->set_actor_id(actor_id.Binary());
+    }
+    auto state_updates = events.mutable_state_updates();
+    state_updates->set_node_id(node_ids[i % kNumNodes].Binary());
+    state_updates->set_pending_args_avail_ts(i);
+    state_updates->set_running_ts(i + 1);
+    if (i % 100 != 0) {
+      state_updates->set_finished_ts(i + 2);
+    }
+    storage.AddOrReplaceTaskEvent(std::move(events));
+  }
+
+  auto run_query = [&storage](const std::string &description,
+                              const TaskEventsQuery &query,
+                              size_t expected_num_results) {
+    auto result = storage.QueryTaskEvents(query);
+    EXPECT_EQ(result.task_events.size(), expected_num_results) << description;
+    return result;
+  };
+
+  TaskEventsQuery page;
+  page.limit = 100;
+  page.count_truncated = false;
+  auto result = run_query("First page of all", page, 100);
+  EXPECT_EQ(TaskID::FromBinary(result.task_events[0].task_id()), task_ids.back());
+  page.cursor = result.next_cursor;
+  run_query("Second page of all", page, 100);
+
+  TaskEventsQuery by_state;
+  by_state.state = rpc::TaskStatus::RUNNING;
+  by_state.limit = 100;
+  by_state.count_truncated = false;
+  run_query("First page of running", by_state, 100);
+  by_state.limit = -1;
+  run_query("All running", by_state, kNumTasks / 100);
+
+  TaskEventsQuery by_actor;
+  by_actor.actor_id = actor_id.Binary();
+  run_query("All of an actor", by_actor, kNumTasks / 10000);
+
+  TaskEventsQuery by_name_and_node;
+  by_name_and_node.name = "task_7";
+  by_name_and_node.node_id = node_ids[7].Binary();
+  run_query("All of a name on a node", by_name_and_node, kNumTasks / 1000);
+
+  TaskEventsQuery by_task_ids;
+  by_task_ids.task_ids.emplace(task_ids.begin(), task_ids.begin() + 100);
+  run_query("100 tasks by id", by_task_ids, 100);
+
+  TaskEventsQuery counted;
+  counted.limit = 100;
+  run_query("First page of all, counting the others", counted, 100);
+}
+
+rpc::TaskEvents GenFullTaskEvents(const TaskID &task_id,
+                                  const NodeID &node_id,
+                                  const WorkerID &worker_id,
+                                  int64_t start_ts) {
+  rpc::TaskEvents events;
+  events.set_task_id(task_id.Binary());
+  events.set_job_id(JobID::FromInt(1).Binary());
+  events.set_attempt_number(1);
+
+  auto task_info = events.mutable_task_info();
+  task_info->set_type(rpc::TaskType::NORMAL_TASK);
+  task_info->set_name("train_model");
+  task_info->set_func_or_class_name("my_module.train_model");
+  task_info->set_job_id(JobID::FromInt(1).Binary());
+  task_info->set_task_id(task_id.Binary());
+  task_info->set_parent_task_id(TaskID::ForDriverTask(JobID::FromInt(1)).Binary());
+  (*task_info->mutable_required_resources())["CPU"] = 1;
+  (*task_info->mutable_required_resources())["GPU"] = 0.5;
+  task_info->mutable_runtime_env_info()->set_serialized_runtime_env(
+      R"({"pip": ["torch", "numpy"], "env_vars": {"OMP_NUM_THREADS": "1"}})");
+  task_info->set_node_id(node_id.Binary());
+
+  auto state_updates = events.mutable_state_updates();
+  state_updates->set_node_id(node_id.Binary());
+  state_updates->set_worker_id(worker_id.Binary());
+  state_updates->set_pending_args_avail_ts(start_ts);
+  state_updates->set_pending_node_assignment_ts(start_ts + 1000);
+  state_updates->set_submitted_to_worker_ts(start_ts + 250000);
+  state_updates->set_running_ts(start_ts + 300000);
+  state_updates->set_finished_ts(start_ts + 5000000000);
+  return events;
+}
+
+TEST(TaskEventsTableTest, TestRoundTrip) {
+  TaskEventsTable table;
+  auto node_id = NodeID::FromRandom();
+  auto worker_id = WorkerID::FromRandom();
+  std::vector<rpc::TaskEvents> expected;
+  for (int i = 0; i < 10; i++) {
+    expected.push_back(
+        GenFullTaskEvents(RandomTaskId(), node_id, worker_id, /*start_ts=*/1000 * i));
+    table.Append(expected.back());
+  }
+  // Profile events, and timestamps that aren't in order.
+  auto profile_events = expected[3].mutable_profile_events();
+  profile_events->set_component_type("worker");
+  profile_events->set_component_id(worker_id.Binary());
+  profile_events->set_node_ip_address("10.0.0.1");
+  for (int i = 0; i < 3; i++) {
+    auto event = profile_events->add_events();
+    event->set_event_name(i == 1 ? "task:execute" : "task:deserialize_arguments");
+    event->set_start_time(100 - 10 * i);
+    event->set_end_time(200 + i);
+    if (i != 2) {
+      event->set_extra_data(R"({"name": "train_model"})");
+    }
+  }
+  expected[4].mutable_state_updates()->set_failed_ts(1);
+  expected[5].clear_task_info();
+  expected[6].clear_state_updates();
+  expected[7].mutable_task_info()->set_task_id(RandomTaskId().Binary());
+  for (int i = 3; i < 8; i++) {
+    table.Replace(i, expected[i]);
+  }
+
+  ASSERT_EQ(table.Size(), expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(table.Get(i),
+                                                                   expected[i]))
+        << "Expected: " << expected[i].DebugString()
+        << "Actual: " << table.Get(i).DebugString();
+  }
+}
+
+TEST(TaskEventsTableTest, TestMergeAndUpdate) {
+  TaskEventsTable table;
+  auto task_id = RandomTaskId();
+  rpc::TaskEvents first;
+  first.set_task_id(task_id.Binary());
+  first.set_job_id(JobID::FromInt(1).Binary());
+  first.mutable_state_updates()->set_pending_args_avail_ts(10);
+  table.Append(first);
+  ASSERT_FALSE(table.HasTaskInfo(0));
+
+  auto full = GenFullTaskEvents(task_id, NodeID::FromRandom(), WorkerID::FromRandom(), 5);
+  full.set_attempt_number(0);
+  table.Merge(0, full);
+  rpc::TaskEvents expected = first;
+  expected.MergeFrom(full);
+  EXPECT_TRUE(
+      google::protobuf::util::MessageDifferencer::Equals(table.Get(0), expected));
+  ASSERT_TRUE(table.HasTaskInfo(0));
+  ASSERT_EQ(*table.GetStatusUpdateTime(0, rpc::TaskStatus::PENDING_ARGS_AVAIL), 5);
+  ASSERT_FALSE(table.GetStatusUpdateTime(0, rpc::TaskStatus::FAILED).has_value());
+
+  table.SetStatusUpdateTime(0, rpc::TaskStatus::FAILED, 7);
+  ASSERT_EQ(*table.GetStatusUpdateTime(0, rpc::TaskStatus::FAILED), 7);
+  ASSERT_EQ(*table.GetStatusUpdateTime(0, rpc::TaskStatus::RUNNING), 300005);
+
+  // Strings are released when the rows that use them are replaced.
+  rpc::TaskEvents other;
+  other.set_task_id(RandomTaskId().Binary());
+  table.Replace(0, other);
+  ASSERT_EQ(table.NumInternedStrings(), 0);
+}
+
+// Compare the memory used per task attempt by the table and by rpc::TaskEvents, for
+// tasks of the same function that run on a few workers.
+TEST(TaskEventsTableTest, MemoryPerEventBenchmark) {
+  const size_t kNumTasks = 100000;
+  std::vector<NodeID> node_ids;
+  std::vector<WorkerID> worker_ids;
+  for (int i = 0; i < 16; i++) {
+    node_ids.push_back(NodeID::FromRandom());
+    worker_ids.push_back(WorkerID::FromRandom());
+  }
+
+  TaskEventsTable table;
+  size_t proto_bytes = 0;
+  int64_t start_ts = absl::GetCurrentTimeNanos();
+  for (size_t i = 0; i < kNumTasks; i++) {
+    auto events = GenFullTaskEvents(
+        RandomTaskId(), node_ids[i % node_ids.size()], worker_ids[i % worker_ids.size()],
+        start_ts + 1000 * i);
+    proto_bytes += events.SpaceUsedLong();
+    table.Append(events);
+  }
+  double proto_bytes_per_event = 1.0 * proto_bytes / kNumTasks;
+  double table_bytes_per_event = 1.0 * table.NumBytes() / kNumTasks;
+  RAY_LOG(INFO) << "rpc::TaskEvents: " << proto_bytes_per_event
+                << " bytes per task attempt, TaskEventsTable: " << table_bytes_per_event
+                << " bytes per task attempt, " << table.NumInternedStrings()
+                << " interned strings";
+  ASSERT_LT(table_bytes_per_event, proto_bytes_per_event / 4);
+}
+
 }  // namespace gcs
 }  // namespace ray
@@ -32,12 +32,13 @@ namespace {
 
 /// A helper function to call the callback and delete it from the callback
 /// manager if necessary.
-void ProcessCallback(int64_t callback_index,
-                     std::shared_ptr<ray::gcs::CallbackReply> callback_reply) {
+void ProcessCallback(int64_t callback_index, redisReply *redis_reply) {
   RAY_CHECK(callback_index >= 0) << "The callback index must be greater than 0, "
                                  << "but it actually is " << callback_index;
   auto callback_item =
       ray::gcs::RedisCallbackManager::instance().GetCallback(callback_index);
+  auto callback_reply = std::make_shared<ray::gcs::CallbackReply>(
+      redis_reply, callback_item->allow_error_reply_);
 
   // Record the redis latency
   auto end_time = absl::GetCurrentTimeNanos() / 1000;
@@ -56,7 +57,8 @@ namespace ray {
 
 namespace gcs {
 
-CallbackReply::CallbackReply(redisReply *redis_reply) : reply_type_(redis_reply->type) {
+CallbackReply::CallbackReply(redisReply *redis_reply, bool allow_error)
+    : reply_type_(redis_reply->type) {
   RAY_CHECK(nullptr != redis_reply);
 
   switch (reply_type_) {
@@ -64,7 +66,8 @@ CallbackReply::CallbackReply(redisReply *redis_reply) : reply_type_(redis_reply-
     break;
   }
   case REDIS_REPLY_ERROR: {
-    RAY_CHECK(false) << "Got an error in redis reply: " << redis_reply->str;
+    RAY_CHECK(allow_error) << "Got an error in redis reply: " << redis_reply->str;
+    string_reply_ = std::string(redis_reply->str, redis_reply->len);
     break;
   }
   case REDIS_REPLY_INTEGER: {
@@ -140,6 +143,13 @@ void CallbackReply::ParseAsStringArray(redisReply *redis_reply) {
 
 bool CallbackReply::IsNil() const { return REDIS_REPLY_NIL == reply_type_; }
 
+bool CallbackReply::IsError() const { return REDIS_REPLY_ERROR == reply_type_; }
+
+const std::string &CallbackReply::ReadAsError() const {
+  RAY_CHECK(reply_type_ == REDIS_REPLY_ERROR) << "Unexpected type: " << reply_type_;
+  return string_reply_;
+}
+
 int64_t CallbackReply::ReadAsInteger() const {
   RAY_CHECK(reply_type_ == REDIS_REPLY_INTEGER) << "Unexpected type: " << reply_type_;
   return int_reply_;
@@ -180,7 +190,7 @@ void GlobalRedisCallback(void *c, void *r, void *privdata) {
   }
   int64_t callback_index = reinterpret_cast<int64_t>(privdata);
   redisReply *reply = reinterpret_cast<redisReply *>(r);
-  ProcessCallback(callback_index, std::make_shared<CallbackReply>(reply));
+  ProcessCallback(callback_index, reply);
 }
 
 int64_t RedisCallbackManager::AllocateCallbackIndex() {
@@ -190,7 +200,8 @@ int64_t RedisCallbackManager::AllocateCallbackIndex() {
 
 int64_t RedisCallbackManager::AddCallback(const RedisCallback &function,
                                           instrumented_io_context &io_service,
-                                          int64_t callback_index) {
+                                          int64_t callback_index,
+                                          bool allow_error_reply) {
   auto start_time = absl::GetCurrentTimeNanos() / 1000;
 
   std::lock_guard<std::mutex> lock(mutex_);
@@ -200,7 +211,9 @@ int64_t RedisCallbackManager::AddCallback(const RedisCallback &function,
     num_callbacks_++;
   }
   callback_items_.emplace(
-      callback_index, std::make_shared<CallbackItem>(function, start_time, io_service));
+      callback_index,
+      std::make_shared<CallbackItem>(
+          function, start_time, io_service, allow_error_reply));
   return callback_index;
 }
 
@@ -437,7 +450,8 @@ std::unique_ptr<CallbackReply> RedisContext::RunArgvSync(
 }
 
 Status RedisContext::RunArgvAsync(const std::vector<std::string> &args,
-                                  const RedisCallback &redis_callback) {
+                                  const RedisCallback &redis_callback,
+                                  bool allow_error_reply) {
   RAY_CHECK(redis_async_context_);
   // Build the arguments.
   std::vector<const char *> argv;
@@ -446,8 +460,8 @@ Status RedisContext::RunArgvAsync(const std::vector<std::string> &args,
     argv.push_back(args[i].data());
     argc.push_back(args[i].size());
   }
-  int64_t callback_index =
-      RedisCallbackManager::instance().AddCallback(redis_callback, io_service_);
+  int64_t callback_index = RedisCallbackManager::instance().AddCallback(
+      redis_callback, io_service_, /*callback_index=*/-1, allow_error_reply);
   // Run the Redis command.
   Status status = redis_async_context_->RedisAsyncCommandArgv(
       reinterpret_cast<redisCallbackFn *>(&GlobalRedisCallback),
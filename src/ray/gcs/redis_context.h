@@ -41,11 +41,20 @@ using rpc::TablePrefix;
 /// A simple reply wrapper for redis reply.
 class CallbackReply {
  public:
-  explicit CallbackReply(redisReply *redis_reply);
+  /// \param redis_reply The reply to wrap.
+  /// \param allow_error Whether the caller handles an error reply. Otherwise, an
+  /// error reply is fatal.
+  explicit CallbackReply(redisReply *redis_reply, bool allow_error = false);
 
   /// Whether this reply is `nil` type reply.
   bool IsNil() const;
 
+  /// Whether this reply is an error reply. This is only possible if it was allowed.
+  bool IsError() const;
+
+  /// Read the message of an error reply.
+  const std::string &ReadAsError() const;
+
   /// Read this reply data as an integer.
   int64_t ReadAsInteger() const;
 
@@ -86,7 +95,7 @@ class CallbackReply {
   /// Reply data if reply_type_ is REDIS_REPLY_STATUS.
   Status status_reply_;
 
-  /// Reply data if reply_type_ is REDIS_REPLY_STRING.
+  /// Reply data if reply_type_ is REDIS_REPLY_STRING or REDIS_REPLY_ERROR.
   std::string string_reply_;
 
   /// Reply data if reply_type_ is REDIS_REPLY_ARRAY.
@@ -115,8 +124,12 @@ class RedisCallbackManager {
 
     CallbackItem(const RedisCallback &callback,
                  int64_t start_time,
-                 instrumented_io_context &io_service)
-        : callback_(callback), start_time_(start_time), io_service_(&io_service) {}
+                 instrumented_io_context &io_service,
+                 bool allow_error_reply)
+        : callback_(callback),
+          start_time_(start_time),
+          io_service_(&io_service),
+          allow_error_reply_(allow_error_reply) {}
 
     void Dispatch(std::shared_ptr<CallbackReply> &reply) {
       std::shared_ptr<CallbackItem> self = shared_from_this();
@@ -129,6 +142,8 @@ class RedisCallbackManager {
     RedisCallback callback_;
     int64_t start_time_;
     instrumented_io_context *io_service_;
+    /// Whether the callback handles error replies.
+    bool allow_error_reply_ = false;
   };
 
   /// Allocate an index at which we can add a callback later on.
@@ -137,7 +152,8 @@ class RedisCallbackManager {
   /// Add a callback at an optionally specified index.
   int64_t AddCallback(const RedisCallback &function,
                       instrumented_io_context &io_service,
-                      int64_t callback_index = -1);
+                      int64_t callback_index = -1,
+                      bool allow_error_reply = false);
 
   /// Remove a callback.
   void RemoveCallback(int64_t callback_index);
@@ -188,9 +204,12 @@ class RedisContext {
   ///
   /// \param args The vector of command args to pass to Redis.
   /// \param redis_callback The Redis callback function.
+  /// \param allow_error_reply Whether the callback handles an error reply. Otherwise,
+  /// an error reply is fatal.
   /// \return Status.
   Status RunArgvAsync(const std::vector<std::string> &args,
-                      const RedisCallback &redis_callback = nullptr);
+                      const RedisCallback &redis_callback = nullptr,
+                      bool allow_error_reply = false);
 
   redisContext *sync_context() {
     RAY_CHECK(context_);
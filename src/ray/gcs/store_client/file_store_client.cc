@@ -0,0 +1,572 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/store_client/file_store_client.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "absl/time/clock.h"
+#include "boost/crc.hpp"
+#include "ray/common/ray_config.h"
+#include "ray/util/filesystem.h"
+#include "ray/util/util.h"
+
+namespace ray {
+
+namespace gcs {
+
+namespace {
+
+const std::string kSnapshotFileName = "gcs_snapshot";
+const std::string kLogFileName = "gcs_log";
+
+/// Every record is framed by the size of its payload and the CRC32C of its payload.
+/// The payload is the record type and the sizes of the table name, the key and the
+/// value, followed by the table name, the key and the value.
+constexpr size_t kFrameHeaderSize = 2 * sizeof(uint32_t);
+constexpr size_t kRecordHeaderSize = sizeof(uint8_t) + 3 * sizeof(uint32_t);
+
+uint32_t Crc32c(std::string_view data) {
+  boost::crc_optimal<32, 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF, true, true> crc;
+  crc.process_bytes(data.data(), data.size());
+  return crc.checksum();
+}
+
+void SerializeRecord(std::string *buffer,
+                     uint8_t type,
+                     std::string_view table_name,
+                     std::string_view key,
+                     std::string_view value) {
+  const size_t frame_offset = buffer->size();
+  buffer->append(kFrameHeaderSize, '\0');
+  char header[kRecordHeaderSize];
+  header[0] = static_cast<char>(type);
+  uint32_t sizes[3] = {static_cast<uint32_t>(table_name.size()),
+                       static_cast<uint32_t>(key.size()),
+                       static_cast<uint32_t>(value.size())};
+  std::memcpy(header + 1, sizes, sizeof(sizes));
+  buffer->append(header, kRecordHeaderSize);
+  buffer->append(table_name);
+  buffer->append(key);
+  buffer->append(value);
+  auto payload = std::string_view(*buffer).substr(frame_offset + kFrameHeaderSize);
+  uint32_t frame[2] = {static_cast<uint32_t>(payload.size()), Crc32c(payload)};
+  std::memcpy(buffer->data() + frame_offset, frame, sizeof(frame));
+}
+
+/// Parse the records in `data` and call `fn` for each of them.
+///
+/// \return The number of bytes of the valid records. It's less than `data.size()` if
+/// a record is truncated, e.g., because the process died while writing it, or
+/// corrupted. The records after it are not parsed.
+size_t ParseRecords(
+    std::string_view data,
+    const std::function<void(
+        uint8_t, std::string_view, std::string_view, std::string_view)> &fn) {
+  size_t offset = 0;
+  while (data.size() - offset >= kFrameHeaderSize) {
+    uint32_t frame[2];
+    std::memcpy(frame, data.data() + offset, sizeof(frame));
+    const size_t payload_size = frame[0];
+    if (payload_size < kRecordHeaderSize ||
+        data.size() - offset - kFrameHeaderSize < payload_size) {
+      break;
+    }
+    auto payload = data.substr(offset + kFrameHeaderSize, payload_size);
+    if (Crc32c(payload) != frame[1]) {
+      break;
+    }
+    auto type = static_cast<uint8_t>(payload[0]);
+    uint32_t sizes[3];
+    std::memcpy(sizes, payload.data() + 1, sizeof(sizes));
+    const size_t record_size = kRecordHeaderSize + static_cast<size_t>(sizes[0]) +
+                               static_cast<size_t>(sizes[1]) +
+                               static_cast<size_t>(sizes[2]);
+    // The valid types are the ones of `FileStoreClient::RecordType`.
+    if (type < 1 || type > 3 || record_size != payload_size) {
+      break;
+    }
+    auto body = payload.substr(kRecordHeaderSize);
+    fn(type,
+       body.substr(0, sizes[0]),
+       body.substr(sizes[0], sizes[1]),
+       body.substr(sizes[0] + sizes[1], sizes[2]));
+    offset += kFrameHeaderSize + payload_size;
+  }
+  return offset;
+}
+
+/// A read-only view of a whole file. The file is mmap-ed so that loading a large
+/// snapshot doesn't copy it into a buffer first.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    buffer_.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    RAY_CHECK(fstat(fd, &st) == 0) << "Failed to stat " << path << ": "
+                                   << strerror(errno);
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      RAY_CHECK(addr != MAP_FAILED) << "Failed to mmap " << path << ": "
+                                    << strerror(errno);
+      // The file is read sequentially once.
+      madvise(addr, size_, MADV_SEQUENTIAL);
+      addr_ = addr;
+      data_ = std::string_view(static_cast<const char *>(addr), size_);
+    }
+    close(fd);
+#endif
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (addr_ != nullptr) {
+      munmap(addr_, size_);
+    }
+#endif
+  }
+
+  std::string_view Data() const { return data_; }
+
+ private:
+  std::string_view data_;
+#ifdef _WIN32
+  std::string buffer_;
+#else
+  void *addr_ = nullptr;
+  size_t size_ = 0;
+#endif
+};
+
+void SyncFile(std::FILE *file) {
+#ifdef _WIN32
+  _commit(_fileno(file));
+#else
+  fsync(fileno(file));
+#endif
+}
+
+/// Sync a directory so that the files renamed into it survive machine failures.
+void SyncDirectory(const std::string &path) {
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY);
+  RAY_CHECK(fd >= 0) << "Failed to open " << path << ": " << strerror(errno);
+  RAY_CHECK(fsync(fd) == 0) << "Failed to sync " << path << ": " << strerror(errno);
+  close(fd);
+#endif
+}
+
+/// Write the whole buffer to the file and flush it.
+void WriteFile(std::FILE *file, const std::string &path, std::string_view buffer) {
+  RAY_CHECK(std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size())
+      << "Failed to write to " << path << ": " << strerror(errno);
+  RAY_CHECK(std::fflush(file) == 0)
+      << "Failed to flush " << path << ": " << strerror(errno);
+}
+
+}  // namespace
+
+FileStoreClient::FileStoreClient(instrumented_io_context &main_io_service,
+                                 const std::string &storage_dir)
+    : main_io_service_(main_io_service),
+      storage_dir_(storage_dir),
+      snapshot_path_(JoinPaths(storage_dir, kSnapshotFileName)),
+      log_path_(JoinPaths(storage_dir, kLogFileName)) {
+  std::error_code ec;
+  std::filesystem::create_directories(storage_dir, ec);
+  RAY_CHECK(!ec) << "Failed to create the GCS storage directory " << storage_dir
+                 << ": " << ec.message();
+  {
+    absl::MutexLock log_lock(&log_mutex_);
+    absl::MutexLock lock(&mutex_);
+    Load();
+    log_file_ = std::fopen(log_path_.c_str(), "ab");
+    RAY_CHECK(log_file_ != nullptr)
+        << "Failed to open " << log_path_ << ": " << strerror(errno);
+  }
+  writer_thread_ = std::thread([this] {
+    SetThreadName("gcs.file_store");
+    WriterLoop();
+  });
+}
+
+FileStoreClient::~FileStoreClient() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+  }
+  writer_thread_.join();
+  absl::MutexLock log_lock(&log_mutex_);
+  if (log_file_ != nullptr) {
+    std::fclose(log_file_);
+  }
+}
+
+void FileStoreClient::Load() {
+  auto start = absl::Now();
+  auto apply = [this](uint8_t type,
+                      std::string_view table_name,
+                      std::string_view key,
+                      std::string_view value) {
+    mutex_.AssertHeld();
+    ApplyRecord(static_cast<RecordType>(type), table_name, key, value);
+  };
+
+  size_t snapshot_size = 0;
+  {
+    MappedFile snapshot(snapshot_path_);
+    snapshot_size = snapshot.Data().size();
+    // The snapshot is written to a temp file and renamed, so it's never truncated.
+    RAY_CHECK(ParseRecords(snapshot.Data(), apply) == snapshot_size)
+        << "The GCS snapshot " << snapshot_path_ << " is corrupted.";
+  }
+
+  MappedFile log(log_path_);
+  log_size_ = ParseRecords(log.Data(), apply);
+  if (static_cast<size_t>(log_size_) < log.Data().size()) {
+    RAY_LOG(WARNING) << "Dropping the GCS log " << log_path_
+                     << " from its first truncated or corrupted record, size: "
+                     << log.Data().size() << ", valid size: " << log_size_;
+    std::filesystem::resize_file(log_path_, log_size_);
+  }
+
+  size_t num_records = 0;
+  for (const auto &[_, table] : tables_) {
+    num_records += table.size();
+  }
+  RAY_LOG(INFO) << "Loaded " << num_records << " records of " << tables_.size()
+                << " tables from " << snapshot_size << " bytes of snapshot and "
+                << log_size_ << " bytes of log in " << absl::Now() - start;
+}
+
+void FileStoreClient::ApplyRecord(RecordType type,
+                                  std::string_view table_name,
+                                  std::string_view key,
+                                  std::string_view value) {
+  switch (type) {
+  case RecordType::PUT:
+    tables_[table_name][key] = std::string(value);
+    break;
+  case RecordType::REMOVE: {
+    auto it = tables_.find(table_name);
+    if (it != tables_.end()) {
+      it->second.erase(key);
+    }
+    break;
+  }
+  case RecordType::JOB_COUNTER:
+    job_id_ = std::stoi(std::string(value));
+    break;
+  }
+}
+
+void FileStoreClient::AppendToLog(RecordType type,
+                                  std::string_view table_name,
+                                  std::string_view key,
+                                  std::string_view value) {
+  SerializeRecord(&pending_log_, static_cast<uint8_t>(type), table_name, key, value);
+  num_appended_records_++;
+}
+
+void FileStoreClient::AddWriteCallback(std::function<void()> callback,
+                                       const std::string &name) {
+  pending_callbacks_.emplace_back(std::move(callback), name);
+}
+
+bool FileStoreClient::HasPendingWritesOrStopped() const {
+  return stopped_ || !pending_log_.empty() || !pending_callbacks_.empty();
+}
+
+void FileStoreClient::WriterLoop() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &FileStoreClient::HasPendingWritesOrStopped));
+      if (pending_log_.empty() && pending_callbacks_.empty()) {
+        return;
+      }
+    }
+    absl::MutexLock log_lock(&log_mutex_);
+    FlushLog();
+    if (log_size_ > RayConfig::instance().gcs_file_storage_compaction_threshold_bytes()) {
+      CompactLog();
+    }
+  }
+}
+
+void FileStoreClient::FlushLog() {
+  std::string buffer;
+  std::vector<std::pair<std::function<void()>, std::string>> callbacks;
+  int64_t num_records = 0;
+  {
+    absl::MutexLock lock(&mutex_);
+    buffer.swap(pending_log_);
+    callbacks.swap(pending_callbacks_);
+    num_records = num_appended_records_;
+  }
+  if (!buffer.empty()) {
+    WriteFile(log_file_, log_path_, buffer);
+    if (RayConfig::instance().gcs_file_storage_fsync()) {
+      SyncFile(log_file_);
+    }
+    log_size_ += buffer.size();
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    num_flushed_records_ = num_records;
+  }
+  for (auto &[callback, name] : callbacks) {
+    main_io_service_.post(std::move(callback), name);
+  }
+}
+
+void FileStoreClient::Compact() {
+  absl::MutexLock log_lock(&log_mutex_);
+  FlushLog();
+  CompactLog();
+}
+
+void FileStoreClient::CompactLog() {
+  auto start = absl::Now();
+  // The records queued after this are written to the new log. Those that are also in
+  // the snapshot are replayed on top of it with the same result.
+  std::string buffer;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const auto &[table_name, table] : tables_) {
+      for (const auto &[key, value] : table) {
+        SerializeRecord(
+            &buffer, static_cast<uint8_t>(RecordType::PUT), table_name, key, value);
+      }
+    }
+    SerializeRecord(&buffer,
+                    static_cast<uint8_t>(RecordType::JOB_COUNTER),
+                    "",
+                    "",
+                    std::to_string(job_id_));
+  }
+
+  auto tmp_path = snapshot_path_ + ".tmp";
+  std::FILE *snapshot = std::fopen(tmp_path.c_str(), "wb");
+  RAY_CHECK(snapshot != nullptr) << "Failed to open " << tmp_path << ": "
+                                 << strerror(errno);
+  WriteFile(snapshot, tmp_path, buffer);
+  SyncFile(snapshot);
+  std::fclose(snapshot);
+  std::filesystem::rename(tmp_path, snapshot_path_);
+  SyncDirectory(storage_dir_);
+
+  // If the process dies before the log is truncated, replaying the whole log on top of
+  // the new snapshot still ends up with the same data.
+  std::fclose(log_file_);
+  log_file_ = std::fopen(log_path_.c_str(), "wb");
+  RAY_CHECK(log_file_ != nullptr)
+      << "Failed to open " << log_path_ << ": " << strerror(errno);
+  RAY_LOG(INFO) << "Compacted " << log_size_ << " bytes of GCS log into a "
+                << buffer.size() << " bytes snapshot in " << absl::Now() - start;
+  log_size_ = 0;
+}
+
+int64_t FileStoreClient::GetLogSize() {
+  absl::MutexLock log_lock(&log_mutex_);
+  return log_size_;
+}
+
+Status FileStoreClient::AsyncPut(const std::string &table_name,
+                                 const std::string &key,
+                                 const std::string &data,
+                                 bool overwrite,
+                                 std::function<void(bool)> callback) {
+  absl::MutexLock lock(&mutex_);
+  auto &table = tables_[table_name];
+  auto it = table.find(key);
+  bool inserted = it == table.end();
+  if (inserted || overwrite) {
+    table[key] = data;
+    AppendToLog(RecordType::PUT, table_name, key, data);
+  }
+  if (callback != nullptr) {
+    AddWriteCallback([callback, inserted]() { callback(inserted); },
+                     "GcsFileStore.Put");
+  }
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncGet(const std::string &table_name,
+                                 const std::string &key,
+                                 const OptionalItemCallback<std::string> &callback) {
+  RAY_CHECK(callback != nullptr);
+  absl::MutexLock lock(&mutex_);
+  boost::optional<std::string> data;
+  auto table_it = tables_.find(table_name);
+  if (table_it != tables_.end()) {
+    auto it = table_it->second.find(key);
+    if (it != table_it->second.end()) {
+      data = it->second;
+    }
+  }
+  main_io_service_.post(
+      [callback, data = std::move(data)]() { callback(Status::OK(), data); },
+      "GcsFileStore.Get");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncGetAll(
+    const std::string &table_name,
+    const MapCallback<std::string, std::string> &callback) {
+  RAY_CHECK(callback);
+  absl::MutexLock lock(&mutex_);
+  auto result = absl::flat_hash_map<std::string, std::string>();
+  auto table_it = tables_.find(table_name);
+  if (table_it != tables_.end()) {
+    result = table_it->second;
+  }
+  main_io_service_.post(
+      [result = std::move(result), callback]() mutable { callback(std::move(result)); },
+      "GcsFileStore.GetAll");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncMultiGet(
+    const std::string &table_name,
+    const std::vector<std::string> &keys,
+    const MapCallback<std::string, std::string> &callback) {
+  RAY_CHECK(callback);
+  absl::MutexLock lock(&mutex_);
+  auto result = absl::flat_hash_map<std::string, std::string>();
+  auto table_it = tables_.find(table_name);
+  if (table_it != tables_.end()) {
+    for (auto &key : keys) {
+      auto it = table_it->second.find(key);
+      if (it != table_it->second.end()) {
+        result[key] = it->second;
+      }
+    }
+  }
+  main_io_service_.post(
+      [result = std::move(result), callback]() mutable { callback(std::move(result)); },
+      "GcsFileStore.MultiGet");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncDelete(const std::string &table_name,
+                                    const std::string &key,
+                                    std::function<void(bool)> callback) {
+  absl::MutexLock lock(&mutex_);
+  size_t num = 0;
+  auto table_it = tables_.find(table_name);
+  if (table_it != tables_.end()) {
+    num = table_it->second.erase(key);
+  }
+  if (num > 0) {
+    AppendToLog(RecordType::REMOVE, table_name, key, "");
+  }
+  if (callback != nullptr) {
+    AddWriteCallback([callback, num]() { callback(num > 0); }, "GcsFileStore.Delete");
+  }
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncBatchDelete(const std::string &table_name,
+                                         const std::vector<std::string> &keys,
+                                         std::function<void(int64_t)> callback) {
+  absl::MutexLock lock(&mutex_);
+  int64_t num = 0;
+  auto table_it = tables_.find(table_name);
+  if (table_it != tables_.end()) {
+    for (auto &key : keys) {
+      if (table_it->second.erase(key) > 0) {
+        AppendToLog(RecordType::REMOVE, table_name, key, "");
+        ++num;
+      }
+    }
+  }
+  if (callback != nullptr) {
+    AddWriteCallback([callback, num]() { callback(num); }, "GcsFileStore.BatchDelete");
+  }
+  return Status::OK();
+}
+
+int FileStoreClient::GetNextJobID() {
+  absl::MutexLock lock(&mutex_);
+  job_id_ += 1;
+  const int job_id = job_id_;
+  AppendToLog(RecordType::JOB_COUNTER, "", "", std::to_string(job_id));
+  // The job ID is used right away, so it must be in the log before it's returned.
+  const int64_t num_records = num_appended_records_;
+  auto flushed = [this, num_records]() {
+    mutex_.AssertHeld();
+    return num_flushed_records_ >= num_records;
+  };
+  mutex_.Await(absl::Condition(&flushed));
+  return job_id;
+}
+
+Status FileStoreClient::AsyncGetKeys(
+    const std::string &table_name,
+    const std::string &prefix,
+    std::function<void(std::vector<std::string>)> callback) {
+  RAY_CHECK(callback);
+  absl::MutexLock lock(&mutex_);
+  std::vector<std::string> result;
+  auto table_it = tables_.find(table_name);
+  if (table_it != tables_.end()) {
+    for (auto &pair : table_it->second) {
+      if (pair.first.find(prefix) == 0) {
+        result.push_back(pair.first);
+      }
+    }
+  }
+  main_io_service_.post(
+      [result = std::move(result), callback]() mutable { callback(std::move(result)); },
+      "GcsFileStore.Keys");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncExists(const std::string &table_name,
+                                    const std::string &key,
+                                    std::function<void(bool)> callback) {
+  RAY_CHECK(callback);
+  absl::MutexLock lock(&mutex_);
+  auto table_it = tables_.find(table_name);
+  bool result = table_it != tables_.end() && table_it->second.contains(key);
+  main_io_service_.post([result, callback]() mutable { callback(result); },
+                        "GcsFileStore.Exists");
+  return Status::OK();
+}
+
+}  // namespace gcs
+
+}  // namespace ray
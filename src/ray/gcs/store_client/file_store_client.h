@@ -0,0 +1,184 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdio>
+#include <string_view>
+#include <thread>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/gcs/store_client/store_client.h"
+#include "src/ray/protobuf/gcs.pb.h"
+
+namespace ray {
+
+namespace gcs {
+
+/// \class FileStoreClient
+/// Please refer to StoreClient for API semantics.
+///
+/// FileStoreClient keeps all the data in memory and persists it to a local directory,
+/// so the GCS can recover its tables after a restart without an external Redis.
+/// Every write is appended to a log file before its callback is called. The writes are
+/// queued and a writer thread appends them to the log in groups, so that a burst of
+/// writes costs one flush. When the log grows over
+/// `gcs_file_storage_compaction_threshold_bytes`, the whole data set is written to a
+/// snapshot file and the log is truncated. On construction, the snapshot is mmap-ed
+/// and loaded, and the log is replayed on top of it up to its first incomplete or
+/// corrupted record.
+///
+/// Writes are durable against GCS process failures. They are also durable against
+/// machine failures if `gcs_file_storage_fsync` is set.
+///
+/// This class is thread safe.
+class FileStoreClient : public StoreClient {
+ public:
+  /// Create a FileStoreClient and load the data persisted in `storage_dir`.
+  ///
+  /// \param main_io_service The io service to post the callbacks to.
+  /// \param storage_dir The directory of the snapshot and log files. It's created if
+  /// it doesn't exist.
+  FileStoreClient(instrumented_io_context &main_io_service,
+                  const std::string &storage_dir);
+
+  ~FileStoreClient() override;
+
+  Status AsyncPut(const std::string &table_name,
+                  const std::string &key,
+                  const std::string &data,
+                  bool overwrite,
+                  std::function<void(bool)> callback) override;
+
+  Status AsyncGet(const std::string &table_name,
+                  const std::string &key,
+                  const OptionalItemCallback<std::string> &callback) override;
+
+  Status AsyncGetAll(const std::string &table_name,
+                     const MapCallback<std::string, std::string> &callback) override;
+
+  Status AsyncMultiGet(const std::string &table_name,
+                       const std::vector<std::string> &keys,
+                       const MapCallback<std::string, std::string> &callback) override;
+
+  Status AsyncDelete(const std::string &table_name,
+                     const std::string &key,
+                     std::function<void(bool)> callback) override;
+
+  Status AsyncBatchDelete(const std::string &table_name,
+                          const std::vector<std::string> &keys,
+                          std::function<void(int64_t)> callback) override;
+
+  int GetNextJobID() override;
+
+  Status AsyncGetKeys(const std::string &table_name,
+                      const std::string &prefix,
+                      std::function<void(std::vector<std::string>)> callback) override;
+
+  Status AsyncExists(const std::string &table_name,
+                     const std::string &key,
+                     std::function<void(bool)> callback) override;
+
+  /// Write a snapshot of all the data and truncate the log.
+  void Compact();
+
+  /// Get the size of the log written since the last snapshot. The writes whose
+  /// callbacks were called are included.
+  int64_t GetLogSize();
+
+ private:
+  /// The type of a record in the snapshot and log files.
+  enum class RecordType : uint8_t { PUT = 1, REMOVE = 2, JOB_COUNTER = 3 };
+
+  /// Load the snapshot and replay the log.
+  void Load() EXCLUSIVE_LOCKS_REQUIRED(log_mutex_, mutex_);
+
+  /// Apply a record read from the snapshot or log files.
+  void ApplyRecord(RecordType type,
+                   std::string_view table_name,
+                   std::string_view key,
+                   std::string_view value) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Queue a record to be appended to the log by the writer thread.
+  void AppendToLog(RecordType type,
+                   std::string_view table_name,
+                   std::string_view key,
+                   std::string_view value) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Queue the callback of a write. It's posted once the queued records are in the log.
+  void AddWriteCallback(std::function<void()> callback, const std::string &name)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Whether the writer thread has anything to do.
+  bool HasPendingWritesOrStopped() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Append the queued records to the log, compacting it when it's too large.
+  void WriterLoop() LOCKS_EXCLUDED(log_mutex_, mutex_);
+
+  /// Append the queued records to the log and post the callbacks of their writes.
+  void FlushLog() EXCLUSIVE_LOCKS_REQUIRED(log_mutex_) LOCKS_EXCLUDED(mutex_);
+
+  /// Write a snapshot of the data and truncate the log. The data is serialized under
+  /// `mutex_` and written without it.
+  void CompactLog() EXCLUSIVE_LOCKS_REQUIRED(log_mutex_) LOCKS_EXCLUDED(mutex_);
+
+  /// Async API Callback needs to post to main_io_service_ to ensure the orderly execution
+  /// of the callback.
+  instrumented_io_context &main_io_service_;
+
+  const std::string storage_dir_;
+  const std::string snapshot_path_;
+  const std::string log_path_;
+
+  /// Mutex to protect the log file. It's held by the writer thread while it appends to
+  /// the log or compacts it, and it's always acquired before `mutex_`.
+  absl::Mutex log_mutex_;
+
+  /// The log file opened for appending.
+  std::FILE *log_file_ GUARDED_BY(log_mutex_) = nullptr;
+
+  /// The size of the log file.
+  int64_t log_size_ GUARDED_BY(log_mutex_) = 0;
+
+  /// Mutex to protect all the fields below.
+  absl::Mutex mutex_;
+
+  /// Mapping from table name to the records of the table.
+  absl::flat_hash_map<std::string, absl::flat_hash_map<std::string, std::string>>
+      tables_ GUARDED_BY(mutex_);
+
+  int job_id_ GUARDED_BY(mutex_) = 0;
+
+  /// The serialized records that are not in the log yet.
+  std::string pending_log_ GUARDED_BY(mutex_);
+
+  /// The callbacks of the writes that are not in the log yet, with their handler names.
+  std::vector<std::pair<std::function<void()>, std::string>> pending_callbacks_
+      GUARDED_BY(mutex_);
+
+  /// The number of records queued for the log, and the number of them in the log.
+  int64_t num_appended_records_ GUARDED_BY(mutex_) = 0;
+  int64_t num_flushed_records_ GUARDED_BY(mutex_) = 0;
+
+  /// Set on destruction. The writer thread exits once the queued records are written.
+  bool stopped_ GUARDED_BY(mutex_) = false;
+
+  std::thread writer_thread_;
+};
+
+}  // namespace gcs
+
+}  // namespace ray
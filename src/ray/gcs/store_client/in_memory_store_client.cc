@@ -14,26 +14,43 @@
 
 #include "ray/gcs/store_client/in_memory_store_client.h"
 
+#include "absl/strings/match.h"
+#include "ray/common/ray_config.h"
+
 namespace ray {
 
 namespace gcs {
 
+InMemoryStoreClient::Records &InMemoryStoreClient::Shard::MutableRecords() {
+  if (records_.use_count() > 1) {
+    records_ = std::make_shared<Records>(*records_);
+  }
+  return *records_;
+}
+
+std::shared_ptr<const InMemoryStoreClient::Records>
+InMemoryStoreClient::Shard::Snapshot() {
+  absl::MutexLock lock(&mutex_);
+  return records_;
+}
+
 Status InMemoryStoreClient::AsyncPut(const std::string &table_name,
                                      const std::string &key,
                                      const std::string &data,
                                      bool overwrite,
                                      std::function<void(bool)> callback) {
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
-  auto it = table->records_.find(key);
+  auto &shard = table->GetShard(key);
   bool inserted = false;
-  if (it != table->records_.end()) {
-    if (overwrite) {
-      it->second = data;
+  {
+    absl::MutexLock lock(&shard.mutex_);
+    auto it = shard.records_->find(key);
+    if (it == shard.records_->end()) {
+      shard.MutableRecords().emplace(key, data);
+      inserted = true;
+    } else if (overwrite) {
+      shard.MutableRecords()[key] = data;
     }
-  } else {
-    table->records_[key] = data;
-    inserted = true;
   }
   if (callback != nullptr) {
     main_io_service_.post([callback, inserted]() { callback(inserted); },
@@ -47,11 +64,14 @@ Status InMemoryStoreClient::AsyncGet(const std::string &table_name,
                                      const OptionalItemCallback<std::string> &callback) {
   RAY_CHECK(callback != nullptr);
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
-  auto iter = table->records_.find(key);
+  auto &shard = table->GetShard(key);
   boost::optional<std::string> data;
-  if (iter != table->records_.end()) {
-    data = iter->second;
+  {
+    absl::MutexLock lock(&shard.mutex_);
+    auto iter = shard.records_->find(key);
+    if (iter != shard.records_->end()) {
+      data = iter->second;
+    }
   }
 
   main_io_service_.post(
@@ -66,26 +86,65 @@ Status InMemoryStoreClient::AsyncGetAll(
     const MapCallback<std::string, std::string> &callback) {
   RAY_CHECK(callback);
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
+  // Copy the records out of the locks.
   auto result = absl::flat_hash_map<std::string, std::string>();
-  result.insert(table->records_.begin(), table->records_.end());
+  for (auto &shard : table->shards_) {
+    auto records = shard.Snapshot();
+    result.insert(records->begin(), records->end());
+  }
   main_io_service_.post(
       [result = std::move(result), callback]() mutable { callback(std::move(result)); },
       "GcsInMemoryStore.GetAll");
   return Status::OK();
 }
 
+Status InMemoryStoreClient::AsyncGetAllPaged(
+    const std::string &table_name,
+    const MapCallback<std::string, std::string> &page_callback,
+    const EmptyCallback &on_done) {
+  RAY_CHECK(page_callback);
+  auto table = GetOrCreateTable(table_name);
+  size_t page_size = RayConfig::instance().maximum_gcs_storage_operation_batch_size();
+  auto page = absl::flat_hash_map<std::string, std::string>();
+  for (auto &shard : table->shards_) {
+    auto records = shard.Snapshot();
+    for (const auto &item : *records) {
+      page.insert(item);
+      if (page.size() >= page_size) {
+        main_io_service_.post(
+            [page = std::move(page), page_callback]() mutable {
+              page_callback(std::move(page));
+            },
+            "GcsInMemoryStore.GetAllPaged");
+        page = absl::flat_hash_map<std::string, std::string>();
+      }
+    }
+  }
+  main_io_service_.post(
+      [page = std::move(page), page_callback, on_done]() mutable {
+        if (!page.empty()) {
+          page_callback(std::move(page));
+        }
+        if (on_done) {
+          on_done();
+        }
+      },
+      "GcsInMemoryStore.GetAllPaged");
+  return Status::OK();
+}
+
 Status InMemoryStoreClient::AsyncMultiGet(
     const std::string &table_name,
     const std::vector<std::string> &keys,
     const MapCallback<std::string, std::string> &callback) {
   RAY_CHECK(callback);
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
   auto result = absl::flat_hash_map<std::string, std::string>();
   for (auto &key : keys) {
-    auto it = table->records_.find(key);
-    if (it == table->records_.end()) {
+    auto &shard = table->GetShard(key);
+    absl::MutexLock lock(&shard.mutex_);
+    auto it = shard.records_->find(key);
+    if (it == shard.records_->end()) {
       continue;
     }
     result[key] = it->second;
@@ -100,8 +159,14 @@ Status InMemoryStoreClient::AsyncDelete(const std::string &table_name,
                                         const std::string &key,
                                         std::function<void(bool)> callback) {
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
-  auto num = table->records_.erase(key);
+  auto &shard = table->GetShard(key);
+  size_t num = 0;
+  {
+    absl::MutexLock lock(&shard.mutex_);
+    if (shard.records_->contains(key)) {
+      num = shard.MutableRecords().erase(key);
+    }
+  }
   if (callback != nullptr) {
     main_io_service_.post([callback, num]() { callback(num > 0); },
                           "GcsInMemoryStore.Delete");
@@ -113,10 +178,13 @@ Status InMemoryStoreClient::AsyncBatchDelete(const std::string &table_name,
                                              const std::vector<std::string> &keys,
                                              std::function<void(int64_t)> callback) {
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
   int64_t num = 0;
   for (auto &key : keys) {
-    num += table->records_.erase(key);
+    auto &shard = table->GetShard(key);
+    absl::MutexLock lock(&shard.mutex_);
+    if (shard.records_->contains(key)) {
+      num += shard.MutableRecords().erase(key);
+    }
   }
   if (callback != nullptr) {
     main_io_service_.post([callback, num]() { callback(num); },
@@ -133,15 +201,19 @@ int InMemoryStoreClient::GetNextJobID() {
 
 std::shared_ptr<InMemoryStoreClient::InMemoryTable> InMemoryStoreClient::GetOrCreateTable(
     const std::string &table_name) {
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto iter = tables_.find(table_name);
+    if (iter != tables_.end()) {
+      return iter->second;
+    }
+  }
   absl::MutexLock lock(&mutex_);
-  auto iter = tables_.find(table_name);
-  if (iter != tables_.end()) {
-    return iter->second;
-  } else {
-    auto table = std::make_shared<InMemoryTable>();
-    tables_[table_name] = table;
-    return table;
+  auto &table = tables_[table_name];
+  if (table == nullptr) {
+    table = std::make_shared<InMemoryTable>();
   }
+  return table;
 }
 
 Status InMemoryStoreClient::AsyncGetKeys(
@@ -151,10 +223,12 @@ Status InMemoryStoreClient::AsyncGetKeys(
   RAY_CHECK(callback);
   auto table = GetOrCreateTable(table_name);
   std::vector<std::string> result;
-  absl::MutexLock lock(&(table->mutex_));
-  for (auto &pair : table->records_) {
-    if (pair.first.find(prefix) == 0) {
-      result.push_back(pair.first);
+  for (auto &shard : table->shards_) {
+    absl::MutexLock lock(&shard.mutex_);
+    for (auto it = shard.records_->lower_bound(prefix);
+         it != shard.records_->end() && absl::StartsWith(it->first, prefix);
+         ++it) {
+      result.push_back(it->first);
     }
   }
   main_io_service_.post(
@@ -168,8 +242,12 @@ Status InMemoryStoreClient::AsyncExists(const std::string &table_name,
                                         std::function<void(bool)> callback) {
   RAY_CHECK(callback);
   auto table = GetOrCreateTable(table_name);
-  absl::MutexLock lock(&(table->mutex_));
-  bool result = table->records_.contains(key);
+  auto &shard = table->GetShard(key);
+  bool result = false;
+  {
+    absl::MutexLock lock(&shard.mutex_);
+    result = shard.records_->contains(key);
+  }
   main_io_service_.post([result, callback]() mutable { callback(result); },
                         "GcsInMemoryStore.Exists");
   return Status::OK();
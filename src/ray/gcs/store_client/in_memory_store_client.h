@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <array>
+
+#include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
@@ -27,6 +30,13 @@ namespace gcs {
 /// \class InMemoryStoreClient
 /// Please refer to StoreClient for API semantics.
 ///
+/// Each table is split into `kNumShards` shards by the hash of the keys, each with its
+/// own lock, so that operations on different keys rarely contend. The records of a
+/// shard are kept ordered, so prefix scans only visit the matching keys. The records
+/// are copy-on-write: reading a whole table only takes a reference to the records of
+/// each shard under the lock, and a later write copies the records if the reference
+/// is still held.
+///
 /// This class is thread safe.
 class InMemoryStoreClient : public StoreClient {
  public:
@@ -46,6 +56,10 @@ class InMemoryStoreClient : public StoreClient {
   Status AsyncGetAll(const std::string &table_name,
                      const MapCallback<std::string, std::string> &callback) override;
 
+  Status AsyncGetAllPaged(const std::string &table_name,
+                          const MapCallback<std::string, std::string> &page_callback,
+                          const EmptyCallback &on_done) override;
+
   Status AsyncMultiGet(const std::string &table_name,
                        const std::vector<std::string> &keys,
                        const MapCallback<std::string, std::string> &callback) override;
@@ -69,17 +83,37 @@ class InMemoryStoreClient : public StoreClient {
                      std::function<void(bool)> callback) override;
 
  private:
-  struct InMemoryTable {
-    /// Mutex to protect the records_ field and the index_keys_ field.
+  /// The records of a shard, ordered by key.
+  using Records = absl::btree_map<std::string, std::string>;
+
+  struct Shard {
+    /// Mutex to protect the records_ field.
     absl::Mutex mutex_;
-    // Mapping from key to data.
-    absl::flat_hash_map<std::string, std::string> records_ GUARDED_BY(mutex_);
+    /// Mapping from key to data. It's shared with the readers which are copying the
+    /// whole shard, so it must be copied before being modified if it's shared.
+    std::shared_ptr<Records> records_ GUARDED_BY(mutex_) = std::make_shared<Records>();
+
+    /// Get the records to modify, copying them first if a reader still holds them.
+    Records &MutableRecords() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+    /// Get a reference to the current records which won't be modified by later writes.
+    std::shared_ptr<const Records> Snapshot() LOCKS_EXCLUDED(mutex_);
+  };
+
+  static constexpr size_t kNumShards = 16;
+
+  struct InMemoryTable {
+    std::array<Shard, kNumShards> shards_;
+
+    Shard &GetShard(const std::string &key) {
+      return shards_[std::hash<std::string>()(key) % kNumShards];
+    }
   };
 
   std::shared_ptr<InMemoryStoreClient::InMemoryTable> GetOrCreateTable(
       const std::string &table_name);
 
-  /// Mutex to protect the tables_ field.
+  /// Mutex to protect the tables_ field and the job_id_ field.
   absl::Mutex mutex_;
   absl::flat_hash_map<std::string, std::shared_ptr<InMemoryTable>> tables_
       GUARDED_BY(mutex_);
@@ -88,7 +122,7 @@ class InMemoryStoreClient : public StoreClient {
   /// of the callback.
   instrumented_io_context &main_io_service_;
 
-  int job_id_ = 0;
+  int job_id_ GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace gcs
@@ -75,6 +75,22 @@ Status ObservableStoreClient::AsyncGetAll(
     }
   });
 }
+
+Status ObservableStoreClient::AsyncGetAllPaged(
+    const std::string &table_name,
+    const MapCallback<std::string, std::string> &page_callback,
+    const EmptyCallback &on_done) {
+  auto start = absl::GetCurrentTimeNanos();
+  STATS_gcs_storage_operation_count.Record(1, "GetAll");
+  return delegate_->AsyncGetAllPaged(table_name, page_callback, [start, on_done]() {
+    auto end = absl::GetCurrentTimeNanos();
+    STATS_gcs_storage_operation_latency_ms.Record(
+        absl::Nanoseconds(end - start) / absl::Milliseconds(1), "GetAll");
+    if (on_done) {
+      on_done();
+    }
+  });
+}
 Status ObservableStoreClient::AsyncMultiGet(
     const std::string &table_name,
     const std::vector<std::string> &keys,
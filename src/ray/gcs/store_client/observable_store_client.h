@@ -39,6 +39,10 @@ class ObservableStoreClient : public StoreClient {
   Status AsyncGetAll(const std::string &table_name,
                      const MapCallback<std::string, std::string> &callback) override;
 
+  Status AsyncGetAllPaged(const std::string &table_name,
+                          const MapCallback<std::string, std::string> &page_callback,
+                          const EmptyCallback &on_done) override;
+
   Status AsyncMultiGet(const std::string &table_name,
                        const std::vector<std::string> &keys,
                        const MapCallback<std::string, std::string> &callback) override;
@@ -19,7 +19,10 @@
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "ray/common/asio/asio_util.h"
 #include "ray/gcs/redis_context.h"
+#include "ray/stats/metric_defs.h"
 #include "ray/util/logging.h"
 
 namespace ray {
@@ -31,6 +34,24 @@ namespace {
 const std::string_view kTableSeparator = ":";
 const std::string_view kClusterSeparator = "@";
 
+// Apply a batch of writes to the hash KEYS[1]. ARGV holds (command, key, value)
+// triples and the reply holds the result of each command as a string, since
+// integer arrays are not supported by CallbackReply. The script is loaded once and
+// then run by its SHA1 digest.
+const std::string kBatchWriteScript = R"(
+local results = {}
+for i = 1, #ARGV, 3 do
+  local result
+  if ARGV[i] == 'HDEL' then
+    result = redis.call('HDEL', KEYS[1], ARGV[i + 1])
+  else
+    result = redis.call(ARGV[i], KEYS[1], ARGV[i + 1], ARGV[i + 2])
+  end
+  results[#results + 1] = tostring(result)
+end
+return results
+)";
+
 // "[, ], -, ?, *, ^, \" are special chars in Redis pattern matching.
 // escape them with / according to the doc:
 // https://redis.io/commands/keys/
@@ -156,21 +177,37 @@ Status MGetValues(std::shared_ptr<RedisClient> redis_client,
 
 RedisStoreClient::RedisStoreClient(std::shared_ptr<RedisClient> redis_client)
     : external_storage_namespace_(::RayConfig::instance().external_storage_namespace()),
-      redis_client_(std::move(redis_client)) {
+      redis_client_(std::move(redis_client)),
+      write_batch_window_ms_(::RayConfig::instance().gcs_redis_write_batch_window_ms()) {
   RAY_CHECK(!absl::StrContains(external_storage_namespace_, kClusterSeparator))
       << "Storage namespace (" << external_storage_namespace_ << ") shouldn't contain "
       << kClusterSeparator << ".";
+  if (BatchWrites()) {
+    // If this fails, the batches send the whole script instead.
+    auto reply = redis_client_->GetPrimaryContext()->RunArgvSync(
+        {"SCRIPT", "LOAD", kBatchWriteScript});
+    if (reply != nullptr) {
+      batch_write_script_sha_ = reply->ReadAsString();
+    }
+  }
 }
 
+RedisStoreClient::~RedisStoreClient() { FlushAllWrites(); }
+
 Status RedisStoreClient::AsyncPut(const std::string &table_name,
                                   const std::string &key,
                                   const std::string &data,
                                   bool overwrite,
                                   std::function<void(bool)> callback) {
-  return DoPut(GenRedisKey(external_storage_namespace_, table_name, key),
-               data,
-               overwrite,
-               callback);
+  auto redis_key = GenRedisKey(external_storage_namespace_, table_name, key);
+  if (BatchWrites()) {
+    return BufferWrite(table_name,
+                       redis_key,
+                       overwrite ? WriteCommand::HSET : WriteCommand::HSETNX,
+                       data,
+                       std::move(callback));
+  }
+  return DoPut(redis_key, data, overwrite, callback);
 }
 
 Status RedisStoreClient::AsyncGet(const std::string &table_name,
@@ -190,6 +227,7 @@ Status RedisStoreClient::AsyncGet(const std::string &table_name,
   std::vector<std::string> args = {"HGET", external_storage_namespace_, redis_key};
 
   auto shard_context = redis_client_->GetShardContext(redis_key);
+  FlushWrites(shard_context.get());
   return shard_context->RunArgvAsync(args, redis_callback);
 }
 
@@ -201,6 +239,7 @@ Status RedisStoreClient::AsyncGetAll(
       GenKeyRedisMatchPattern(external_storage_namespace_, table_name);
   auto scanner = std::make_shared<RedisScanner>(
       redis_client_, external_storage_namespace_, table_name);
+  FlushAllWrites();
   auto on_done = [callback,
                   scanner](absl::flat_hash_map<std::string, std::string> &&result) {
     callback(std::move(result));
@@ -208,9 +247,33 @@ Status RedisStoreClient::AsyncGetAll(
   return scanner->ScanKeysAndValues(match_pattern, on_done);
 }
 
+Status RedisStoreClient::AsyncGetAllPaged(
+    const std::string &table_name,
+    const MapCallback<std::string, std::string> &page_callback,
+    const EmptyCallback &on_done) {
+  RAY_CHECK(page_callback);
+  std::string match_pattern =
+      GenKeyRedisMatchPattern(external_storage_namespace_, table_name);
+  auto scanner = std::make_shared<RedisScanner>(
+      redis_client_, external_storage_namespace_, table_name);
+  FlushAllWrites();
+  return scanner->ScanKeysAndValuesPaged(
+      match_pattern, page_callback, [on_done, scanner]() {
+        if (on_done) {
+          on_done();
+        }
+      });
+}
+
 Status RedisStoreClient::AsyncDelete(const std::string &table_name,
                                      const std::string &key,
                                      std::function<void(bool)> callback) {
+  std::string redis_key = GenRedisKey(external_storage_namespace_, table_name, key);
+  if (BatchWrites()) {
+    return BufferWrite(
+        table_name, redis_key, WriteCommand::HDEL, std::string(), std::move(callback));
+  }
+
   RedisCallback delete_callback = nullptr;
   if (callback) {
     delete_callback = [callback](const std::shared_ptr<CallbackReply> &reply) {
@@ -218,7 +281,6 @@ Status RedisStoreClient::AsyncDelete(const std::string &table_name,
     };
   }
 
-  std::string redis_key = GenRedisKey(external_storage_namespace_, table_name, key);
   // We always replace `DEL` with `UNLINK`.
   std::vector<std::string> args = {"HDEL", external_storage_namespace_, redis_key};
 
@@ -234,6 +296,7 @@ Status RedisStoreClient::AsyncBatchDelete(const std::string &table_name,
   for (auto &key : keys) {
     redis_keys.push_back(GenRedisKey(external_storage_namespace_, table_name, key));
   }
+  FlushAllWrites();
   return DeleteByKeys(redis_keys, callback);
 }
 
@@ -249,6 +312,7 @@ Status RedisStoreClient::AsyncMultiGet(
   for (auto &key : keys) {
     true_keys.push_back(GenRedisKey(external_storage_namespace_, table_name, key));
   }
+  FlushAllWrites();
   RAY_CHECK_OK(MGetValues(
       redis_client_, external_storage_namespace_, table_name, true_keys, callback));
   return Status::OK();
@@ -273,6 +337,168 @@ Status RedisStoreClient::DoPut(const std::string &key,
   return shard_context->RunArgvAsync(args, write_callback);
 }
 
+Status RedisStoreClient::BufferWrite(const std::string &table_name,
+                                     const std::string &redis_key,
+                                     WriteCommand command,
+                                     const std::string &data,
+                                     std::function<void(bool)> callback) {
+  auto shard_context = redis_client_->GetShardContext(redis_key).get();
+  absl::MutexLock lock(&write_mutex_);
+  auto &buffer = write_buffers_[shard_context];
+  auto it = buffer.writes.find(redis_key);
+  if (it != buffer.writes.end() && it->second.command != command) {
+    // Writes of different kinds to the same key can't be merged without losing
+    // the result of the first one, so send the buffered ones first.
+    FlushWritesLocked(shard_context, buffer);
+    it = buffer.writes.end();
+  }
+
+  if (it == buffer.writes.end()) {
+    auto &write = buffer.writes[redis_key];
+    write.command = command;
+    write.table_name = table_name;
+    write.data = data;
+    write.callbacks.push_back(std::move(callback));
+    write.buffered_time_ns = absl::GetCurrentTimeNanos();
+  } else {
+    // HSETNX keeps the first value, while HSET and HDEL keep the last one.
+    if (command == WriteCommand::HSET) {
+      it->second.data = data;
+    }
+    it->second.callbacks.push_back(std::move(callback));
+    STATS_gcs_storage_write_merged_count.Record(1, table_name);
+  }
+
+  if (buffer.writes.size() >=
+      RayConfig::instance().maximum_gcs_storage_operation_batch_size()) {
+    FlushWritesLocked(shard_context, buffer);
+  } else if (!buffer.flush_scheduled) {
+    buffer.flush_scheduled = true;
+    auto flush = [this, alive = std::weak_ptr<bool>(alive_), shard_context]() {
+      if (alive.lock()) {
+        FlushWrites(shard_context);
+      }
+    };
+    if (write_batch_window_ms_ == 0) {
+      shard_context->io_service().post(std::move(flush), "RedisStoreClient.FlushWrites");
+    } else {
+      execute_after(
+          shard_context->io_service(), std::move(flush), write_batch_window_ms_);
+    }
+  }
+  return Status::OK();
+}
+
+void RedisStoreClient::FlushWrites(RedisContext *shard_context) {
+  if (!BatchWrites()) {
+    return;
+  }
+  absl::MutexLock lock(&write_mutex_);
+  auto it = write_buffers_.find(shard_context);
+  if (it != write_buffers_.end()) {
+    FlushWritesLocked(shard_context, it->second);
+  }
+}
+
+void RedisStoreClient::FlushAllWrites() {
+  if (!BatchWrites()) {
+    return;
+  }
+  absl::MutexLock lock(&write_mutex_);
+  for (auto &[shard_context, buffer] : write_buffers_) {
+    FlushWritesLocked(shard_context, buffer);
+  }
+}
+
+void RedisStoreClient::FlushWritesLocked(RedisContext *shard_context,
+                                         WriteBuffer &buffer) {
+  // A scheduled flush which finds the buffer empty is a no-op, so it's fine to let
+  // the next write schedule a new one right away.
+  buffer.flush_scheduled = false;
+  if (buffer.writes.empty()) {
+    return;
+  }
+
+  auto writes = std::make_shared<std::vector<PendingWrite>>();
+  writes->reserve(buffer.writes.size());
+  auto args = std::make_shared<std::vector<std::string>>();
+  args->reserve(4 + 3 * buffer.writes.size());
+  if (batch_write_script_sha_.empty()) {
+    args->push_back("EVAL");
+    args->push_back(kBatchWriteScript);
+  } else {
+    args->push_back("EVALSHA");
+    args->push_back(batch_write_script_sha_);
+  }
+  args->push_back("1");
+  args->push_back(external_storage_namespace_);
+  for (auto &[redis_key, write] : buffer.writes) {
+    switch (write.command) {
+    case WriteCommand::HSET:
+      args->emplace_back("HSET");
+      break;
+    case WriteCommand::HSETNX:
+      args->emplace_back("HSETNX");
+      break;
+    case WriteCommand::HDEL:
+      args->emplace_back("HDEL");
+      break;
+    }
+    args->push_back(redis_key);
+    args->push_back(std::move(write.data));
+    writes->push_back(std::move(write));
+  }
+  buffer.writes.clear();
+  SendWriteBatch(shard_context, std::move(args), std::move(writes));
+}
+
+void RedisStoreClient::SendWriteBatch(
+    RedisContext *shard_context,
+    std::shared_ptr<std::vector<std::string>> args,
+    std::shared_ptr<std::vector<PendingWrite>> writes) {
+  auto batch_callback = [shard_context, args, writes](
+                            const std::shared_ptr<CallbackReply> &reply) {
+    if (reply->IsError()) {
+      if ((*args)[0] == "EVALSHA" && absl::StartsWith(reply->ReadAsError(), "NOSCRIPT")) {
+        // Redis lost the script, e.g. because it restarted. Sending the whole script
+        // loads it again for the next batches.
+        (*args)[0] = "EVAL";
+        (*args)[1] = kBatchWriteScript;
+        SendWriteBatch(shard_context, args, writes);
+        return;
+      }
+      RAY_LOG(ERROR) << "Failed to write a batch of " << writes->size()
+                     << " keys to redis: " << reply->ReadAsError();
+      for (auto &write : *writes) {
+        for (auto &callback : write.callbacks) {
+          if (callback) {
+            callback(false);
+          }
+        }
+      }
+      return;
+    }
+    const auto &results = reply->ReadAsStringArray();
+    RAY_CHECK(results.size() == writes->size());
+    auto now = absl::GetCurrentTimeNanos();
+    for (size_t i = 0; i < writes->size(); ++i) {
+      auto &write = (*writes)[i];
+      STATS_gcs_storage_write_batch_latency_ms.Record(
+          absl::Nanoseconds(now - write.buffered_time_ns) / absl::Milliseconds(1),
+          write.table_name);
+      bool result = results[i].has_value() && *results[i] != "0";
+      for (auto &callback : write.callbacks) {
+        if (callback) {
+          callback(result);
+        }
+        result = false;
+      }
+    }
+  };
+  RAY_CHECK_OK(
+      shard_context->RunArgvAsync(*args, batch_callback, /*allow_error_reply=*/true));
+}
+
 Status RedisStoreClient::DeleteByKeys(const std::vector<std::string> &keys,
                                       std::function<void(int64_t)> callback) {
   // Delete for each shard.
@@ -324,6 +550,15 @@ Status RedisStoreClient::RedisScanner::ScanKeysAndValues(
   return Status::OK();
 }
 
+Status RedisStoreClient::RedisScanner::ScanKeysAndValuesPaged(
+    const std::string &match_pattern,
+    const MapCallback<std::string, std::string> &page_callback,
+    const EmptyCallback &on_done) {
+  page_callback_ = page_callback;
+  Scan(match_pattern, [on_done](const Status &status) { on_done(); });
+  return Status::OK();
+}
+
 void RedisStoreClient::RedisScanner::Scan(const std::string &match_pattern,
                                           const StatusCallback &callback) {
   // This lock guards the iterator over shard_to_cursor_ because the callbacks
@@ -383,11 +618,24 @@ void RedisStoreClient::RedisScanner::OnScanCallback(
       shard_it->second = cursor;
     }
     RAY_CHECK(scan_result.size() % 2 == 0);
+    if (!page_callback_) {
+      for (size_t i = 0; i < scan_result.size(); i += 2) {
+        auto key = GetKeyFromRedisKey(
+            external_storage_namespace_, std::move(scan_result[i]), table_name_);
+        results_.emplace(std::move(key), std::move(scan_result[i + 1]));
+      }
+    }
+  }
+
+  if (page_callback_ && !scan_result.empty()) {
+    absl::flat_hash_map<std::string, std::string> page;
+    page.reserve(scan_result.size() / 2);
     for (size_t i = 0; i < scan_result.size(); i += 2) {
       auto key = GetKeyFromRedisKey(
           external_storage_namespace_, std::move(scan_result[i]), table_name_);
-      results_.emplace(std::move(key), std::move(scan_result[i + 1]));
+      page.emplace(std::move(key), std::move(scan_result[i + 1]));
     }
+    page_callback_(std::move(page));
   }
 
   // If pending_request_count_ is equal to 0, it means that the scan of this batch is
@@ -407,6 +655,7 @@ Status RedisStoreClient::AsyncGetKeys(
       GenKeyRedisMatchPattern(external_storage_namespace_, table_name, prefix);
   auto scanner = std::make_shared<RedisScanner>(
       redis_client_, external_storage_namespace_, table_name);
+  FlushAllWrites();
 
   auto on_done = [table_name, callback, scanner](auto redis_result) {
     std::vector<std::string> result;
@@ -426,6 +675,7 @@ Status RedisStoreClient::AsyncExists(const std::string &table_name,
   std::vector<std::string> args = {"HEXISTS", external_storage_namespace_, redis_key};
 
   auto shard_context = redis_client_->GetShardContext(redis_key);
+  FlushWrites(shard_context.get());
   RAY_CHECK_OK(shard_context->RunArgvAsync(
       args,
       [callback = std::move(callback)](const std::shared_ptr<CallbackReply> &reply) {
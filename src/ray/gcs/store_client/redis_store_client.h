@@ -25,10 +25,21 @@ namespace ray {
 
 namespace gcs {
 
+/// \class RedisStoreClient
+/// Please refer to StoreClient for API semantics.
+///
+/// When `gcs_redis_write_batch_window_ms` is not negative, puts and deletes are
+/// buffered per shard and flushed as one batch command at the end of the window.
+/// Repeated writes of the same kind to the same key within a window are merged into
+/// one. Reads flush the buffered writes first, so they always observe the writes
+/// issued before them.
 class RedisStoreClient : public StoreClient {
  public:
   explicit RedisStoreClient(std::shared_ptr<RedisClient> redis_client);
 
+  /// Sends the buffered writes, so they aren't lost with the client.
+  ~RedisStoreClient();
+
   Status AsyncPut(const std::string &table_name,
                   const std::string &key,
                   const std::string &data,
@@ -42,6 +53,10 @@ class RedisStoreClient : public StoreClient {
   Status AsyncGetAll(const std::string &table_name,
                      const MapCallback<std::string, std::string> &callback) override;
 
+  Status AsyncGetAllPaged(const std::string &table_name,
+                          const MapCallback<std::string, std::string> &page_callback,
+                          const EmptyCallback &on_done) override;
+
   Status AsyncMultiGet(const std::string &table_name,
                        const std::vector<std::string> &keys,
                        const MapCallback<std::string, std::string> &callback) override;
@@ -79,6 +94,13 @@ class RedisStoreClient : public StoreClient {
     Status ScanKeysAndValues(const std::string &match_pattern,
                              const MapCallback<std::string, std::string> &callback);
 
+    /// Scan the keys and values and pass them to `page_callback` as soon as each
+    /// scan batch is received, instead of accumulating them.
+    Status ScanKeysAndValuesPaged(
+        const std::string &match_pattern,
+        const MapCallback<std::string, std::string> &page_callback,
+        const EmptyCallback &on_done);
+
    private:
     void Scan(const std::string &match_pattern, const StatusCallback &callback);
 
@@ -97,6 +119,10 @@ class RedisStoreClient : public StoreClient {
     /// All keys that scanned from redis.
     absl::flat_hash_map<std::string, std::string> results_;
 
+    /// If set, the results of each scan batch are passed to it instead of being
+    /// accumulated in `results_`.
+    MapCallback<std::string, std::string> page_callback_;
+
     /// The scan cursor for each shard.
     absl::flat_hash_map<size_t, size_t> shard_to_cursor_;
 
@@ -111,11 +137,83 @@ class RedisStoreClient : public StoreClient {
                bool overwrite,
                std::function<void(bool)> callback);
 
+  /// The redis command of a buffered write.
+  enum class WriteCommand { HSET, HSETNX, HDEL };
+
+  /// A write buffered by the write-behind batching.
+  struct PendingWrite {
+    WriteCommand command;
+    /// The table of the write, only used for metrics.
+    std::string table_name;
+    /// The value to write. Empty for deletes.
+    std::string data;
+    /// The callbacks of the writes merged into this one. The first one gets the
+    /// result from redis. The others get false, because the key had already been
+    /// written or deleted by the first one when they were issued.
+    std::vector<std::function<void(bool)>> callbacks;
+    /// When the write was buffered.
+    int64_t buffered_time_ns;
+  };
+
+  /// The writes buffered for a shard.
+  struct WriteBuffer {
+    /// Buffered writes keyed by redis key.
+    absl::flat_hash_map<std::string, PendingWrite> writes;
+    /// Whether a flush of this buffer has been scheduled.
+    bool flush_scheduled = false;
+  };
+
+  /// Buffer a write to be flushed at the end of the batch window.
+  Status BufferWrite(const std::string &table_name,
+                     const std::string &redis_key,
+                     WriteCommand command,
+                     const std::string &data,
+                     std::function<void(bool)> callback);
+
+  /// Send the buffered writes of a shard to redis.
+  void FlushWrites(RedisContext *shard_context);
+
+  /// Send the buffered writes of all the shards to redis.
+  void FlushAllWrites();
+
+  /// Send the buffered writes of a shard to redis. The caller must hold
+  /// `write_mutex_`.
+  void FlushWritesLocked(RedisContext *shard_context, WriteBuffer &buffer)
+      EXCLUSIVE_LOCKS_REQUIRED(write_mutex_);
+
+  /// Run the batch write script with the given arguments, and reply to the writes
+  /// with its results. If redis doesn't have the script cached, run it again with
+  /// the whole script instead of its SHA1 digest.
+  static void SendWriteBatch(RedisContext *shard_context,
+                             std::shared_ptr<std::vector<std::string>> args,
+                             std::shared_ptr<std::vector<PendingWrite>> writes);
+
+  /// Whether the write-behind batching is enabled.
+  bool BatchWrites() const { return write_batch_window_ms_ >= 0; }
+
   Status DeleteByKeys(const std::vector<std::string> &keys,
                       std::function<void(int64_t)> callback);
 
   std::string external_storage_namespace_;
   std::shared_ptr<RedisClient> redis_client_;
+
+  /// The flush window of the write-behind batching. Negative means disabled.
+  const int64_t write_batch_window_ms_;
+
+  /// The SHA1 digest of the batch write script, once redis loaded it. Empty if
+  /// loading it failed.
+  std::string batch_write_script_sha_;
+
+  /// Mutex to protect the write_buffers_ field.
+  absl::Mutex write_mutex_;
+
+  /// The buffered writes of each shard.
+  absl::flat_hash_map<RedisContext *, WriteBuffer> write_buffers_
+      GUARDED_BY(write_mutex_);
+
+  /// Scheduled flushes hold a weak reference to this, so the ones which fire after
+  /// the client is destroyed do nothing.
+  std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
 };
 
 }  // namespace gcs
@@ -68,6 +68,26 @@ class StoreClient {
   virtual Status AsyncGetAll(const std::string &table_name,
                              const MapCallback<std::string, std::string> &callback) = 0;
 
+  /// Get all data from the given table asynchronously, page by page. Store clients
+  /// which read from an external storage should override it, so that the data of the
+  /// whole table doesn't need to be held in memory at once.
+  ///
+  /// \param table_name The name of the table to be read.
+  /// \param page_callback Called with each page of the key value pairs.
+  /// \param on_done Called after all the pages have been passed to `page_callback`.
+  /// \return Status
+  virtual Status AsyncGetAllPaged(
+      const std::string &table_name,
+      const MapCallback<std::string, std::string> &page_callback,
+      const EmptyCallback &on_done) {
+    return AsyncGetAll(table_name,
+                       [page_callback, on_done](
+                           absl::flat_hash_map<std::string, std::string> &&result) {
+                         page_callback(std::move(result));
+                         on_done();
+                       });
+  }
+
   /// Get all data from the given table asynchronously.
   ///
   /// \param table_name The name of the table to be read.
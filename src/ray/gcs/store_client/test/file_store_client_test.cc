@@ -0,0 +1,250 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/store_client/file_store_client.h"
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+#include "ray/common/ray_config.h"
+#include "ray/gcs/store_client/test/store_client_test_base.h"
+#include "ray/util/filesystem.h"
+
+namespace ray {
+
+namespace gcs {
+
+class FileStoreClientTest : public StoreClientTestBase {
+ public:
+  void InitStoreClient() override {
+    storage_dir_ = JoinPaths(GetUserTempDir(),
+                             "file_store_client_test_" + UniqueID::FromRandom().Hex());
+    store_client_ =
+        std::make_shared<FileStoreClient>(*(io_service_pool_->Get()), storage_dir_);
+  }
+
+  void DisconnectStoreClient() override {
+    store_client_.reset();
+    std::filesystem::remove_all(storage_dir_);
+  }
+
+  void TearDown() override {
+    StoreClientTestBase::TearDown();
+    RayConfig::instance().initialize("");
+  }
+
+ protected:
+  /// Destroy the store client and create a new one which recovers from the files.
+  void Reopen() {
+    store_client_.reset();
+    store_client_ =
+        std::make_shared<FileStoreClient>(*(io_service_pool_->Get()), storage_dir_);
+  }
+
+  FileStoreClient &Client() { return static_cast<FileStoreClient &>(*store_client_); }
+
+  void SyncPut(const std::string &table_name,
+               const std::string &key,
+               const std::string &value) {
+    std::promise<bool> promise;
+    RAY_CHECK_OK(store_client_->AsyncPut(
+        table_name, key, value, true, [&promise](bool r) { promise.set_value(r); }));
+    promise.get_future().get();
+  }
+
+  bool SyncDelete(const std::string &table_name, const std::string &key) {
+    std::promise<bool> promise;
+    RAY_CHECK_OK(store_client_->AsyncDelete(
+        table_name, key, [&promise](bool r) { promise.set_value(r); }));
+    return promise.get_future().get();
+  }
+
+  absl::flat_hash_map<std::string, std::string> SyncGetAll(
+      const std::string &table_name) {
+    std::promise<absl::flat_hash_map<std::string, std::string>> promise;
+    RAY_CHECK_OK(store_client_->AsyncGetAll(
+        table_name, [&promise](auto result) { promise.set_value(std::move(result)); }));
+    return promise.get_future().get();
+  }
+
+  std::string storage_dir_;
+};
+
+TEST_F(FileStoreClientTest, AsyncPutAndAsyncGetTest) { TestAsyncPutAndAsyncGet(); }
+
+TEST_F(FileStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
+  TestAsyncGetAllAndBatchDelete();
+}
+
+TEST_F(FileStoreClientTest, RecoverFromLog) {
+  Put();
+  SyncPut("other_table", "key", "value1");
+  SyncPut("other_table", "key", "value2");
+  ASSERT_TRUE(SyncDelete(table_name_, keys_[0].Binary()));
+  key_to_value_.erase(keys_[0]);
+
+  Reopen();
+  Get();
+  auto other = SyncGetAll("other_table");
+  ASSERT_EQ(other.size(), 1);
+  ASSERT_EQ(other["key"], "value2");
+  ASSERT_FALSE(SyncDelete(table_name_, keys_[0].Binary()));
+}
+
+TEST_F(FileStoreClientTest, RecoverFromSnapshotAndLog) {
+  Put();
+  Client().Compact();
+  ASSERT_EQ(Client().GetLogSize(), 0);
+
+  // These writes only exist in the log.
+  SyncPut("other_table", "key", "value");
+  ASSERT_TRUE(SyncDelete(table_name_, keys_[0].Binary()));
+  key_to_value_.erase(keys_[0]);
+  ASSERT_GT(Client().GetLogSize(), 0);
+
+  Reopen();
+  Get();
+  ASSERT_EQ(SyncGetAll(table_name_).size(), key_to_value_.size());
+  ASSERT_EQ(SyncGetAll("other_table").size(), 1);
+}
+
+TEST_F(FileStoreClientTest, CompactWhenLogIsTooLarge) {
+  RayConfig::instance().initialize(
+      R"({"gcs_file_storage_compaction_threshold_bytes": 4096})");
+  for (int i = 0; i < 1000; i++) {
+    SyncPut(table_name_, "key", std::to_string(i));
+    ASSERT_LE(Client().GetLogSize(), 4096);
+  }
+  Reopen();
+  auto result = SyncGetAll(table_name_);
+  ASSERT_EQ(result.size(), 1);
+  ASSERT_EQ(result["key"], "999");
+}
+
+TEST_F(FileStoreClientTest, DropTruncatedLogTail) {
+  SyncPut(table_name_, "key1", "value1");
+  SyncPut(table_name_, "key2", "value2");
+  store_client_.reset();
+
+  // Simulate a crash in the middle of appending a record.
+  auto log_path = JoinPaths(storage_dir_, "gcs_log");
+  auto log_size = std::filesystem::file_size(log_path);
+  std::filesystem::resize_file(log_path, log_size - 3);
+
+  Reopen();
+  auto result = SyncGetAll(table_name_);
+  ASSERT_EQ(result.size(), 1);
+  ASSERT_EQ(result["key1"], "value1");
+
+  // New writes are appended after the last complete record.
+  SyncPut(table_name_, "key3", "value3");
+  Reopen();
+  result = SyncGetAll(table_name_);
+  ASSERT_EQ(result.size(), 2);
+  ASSERT_EQ(result["key3"], "value3");
+}
+
+TEST_F(FileStoreClientTest, DropLogFromCorruptedRecord) {
+  SyncPut(table_name_, "key1", "value1");
+  SyncPut(table_name_, "key2", "value2");
+  SyncPut(table_name_, "key3", "value3");
+  store_client_.reset();
+
+  // Flip a byte of the second record's value.
+  auto log_path = JoinPaths(storage_dir_, "gcs_log");
+  std::string log;
+  {
+    std::ifstream file(log_path, std::ios::binary);
+    log.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  auto pos = log.find("value2");
+  ASSERT_NE(pos, std::string::npos);
+  log[pos] = 'V';
+  {
+    std::ofstream file(log_path, std::ios::binary | std::ios::trunc);
+    file << log;
+  }
+
+  // The records from the corrupted one on are dropped.
+  Reopen();
+  auto result = SyncGetAll(table_name_);
+  ASSERT_EQ(result.size(), 1);
+  ASSERT_EQ(result["key1"], "value1");
+  ASSERT_LT(Client().GetLogSize(), static_cast<int64_t>(log.size()));
+
+  SyncPut(table_name_, "key4", "value4");
+  Reopen();
+  result = SyncGetAll(table_name_);
+  ASSERT_EQ(result.size(), 2);
+  ASSERT_EQ(result["key4"], "value4");
+}
+
+TEST_F(FileStoreClientTest, RecoverJobID) {
+  ASSERT_EQ(store_client_->GetNextJobID(), 1);
+  ASSERT_EQ(store_client_->GetNextJobID(), 2);
+  Reopen();
+  ASSERT_EQ(store_client_->GetNextJobID(), 3);
+  Client().Compact();
+  Reopen();
+  ASSERT_EQ(store_client_->GetNextJobID(), 4);
+}
+
+/// Measure how long it takes to recover the tables of a cluster with the given
+/// number of actors, placement groups and nodes.
+TEST_F(FileStoreClientTest, RecoveryTimeBenchmark) {
+  const std::string value(256, 'x');
+  for (size_t num_records : {1000, 10000, 100000}) {
+    store_client_.reset();
+    std::filesystem::remove_all(storage_dir_);
+    InitStoreClient();
+
+    std::atomic<int> pending_count{0};
+    auto callback = [&pending_count](bool) { --pending_count; };
+    for (const auto &table : {"ACTOR", "PLACEMENT_GROUP", "NODE"}) {
+      for (size_t i = 0; i < num_records; i++) {
+        ++pending_count;
+        RAY_CHECK_OK(
+            store_client_->AsyncPut(table, std::to_string(i), value, true, callback));
+      }
+    }
+    WaitPendingDone(pending_count);
+
+    auto start = std::chrono::steady_clock::now();
+    Reopen();
+    auto from_log = std::chrono::steady_clock::now() - start;
+
+    Client().Compact();
+    start = std::chrono::steady_clock::now();
+    Reopen();
+    auto from_snapshot = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(SyncGetAll("ACTOR").size(), num_records);
+    RAY_LOG(INFO) << "Recovered " << num_records
+                  << " actors, placement groups and nodes from the log in "
+                  << std::chrono::duration<double, std::milli>(from_log).count()
+                  << " ms, from the snapshot in "
+                  << std::chrono::duration<double, std::milli>(from_snapshot).count()
+                  << " ms";
+  }
+}
+
+}  // namespace gcs
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
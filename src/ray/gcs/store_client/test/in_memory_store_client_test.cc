@@ -14,6 +14,10 @@
 
 #include "ray/gcs/store_client/in_memory_store_client.h"
 
+#include <algorithm>
+#include <future>
+#include <thread>
+
 #include "ray/gcs/store_client/test/store_client_test_base.h"
 
 namespace ray {
@@ -34,6 +38,69 @@ TEST_F(InMemoryStoreClientTest, AsyncPutAndAsyncGetTest) { TestAsyncPutAndAsyncG
 TEST_F(InMemoryStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
   TestAsyncGetAllAndBatchDelete();
 }
+
+TEST_F(InMemoryStoreClientTest, GetKeysByPrefix) {
+  for (const auto &key : {"a", "ab", "abc", "abd", "b", "ba", ""}) {
+    RAY_CHECK_OK(store_client_->AsyncPut(table_name_, key, "value", true, nullptr));
+  }
+  auto get_keys = [this](const std::string &prefix) {
+    std::promise<std::vector<std::string>> promise;
+    RAY_CHECK_OK(store_client_->AsyncGetKeys(
+        table_name_, prefix, [&promise](auto result) { promise.set_value(result); }));
+    auto keys = promise.get_future().get();
+    std::sort(keys.begin(), keys.end());
+    return keys;
+  };
+  ASSERT_EQ(get_keys("ab"), std::vector<std::string>({"ab", "abc", "abd"}));
+  ASSERT_EQ(get_keys("b"), std::vector<std::string>({"b", "ba"}));
+  ASSERT_EQ(get_keys("c"), std::vector<std::string>());
+  ASSERT_EQ(get_keys("").size(), 7);
+}
+
+TEST_F(InMemoryStoreClientTest, GetAllIsNotAffectedByLaterWrites) {
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key1", "value1", true, nullptr));
+  std::promise<absl::flat_hash_map<std::string, std::string>> promise;
+  RAY_CHECK_OK(store_client_->AsyncGetAll(
+      table_name_, [&promise](auto result) { promise.set_value(std::move(result)); }));
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key1", "value2", true, nullptr));
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key2", "value2", true, nullptr));
+  auto result = promise.get_future().get();
+  ASSERT_EQ(result.size(), 1);
+  ASSERT_EQ(result["key1"], "value1");
+}
+
+/// Measure the throughput of a KV workload issued from several threads, where each
+/// thread writes and reads its own keys and sometimes lists the keys by prefix.
+TEST_F(InMemoryStoreClientTest, MultiThreadedKVBenchmark) {
+  const int num_threads = 8;
+  const int num_ops_per_thread = 100000;
+  const int num_keys_per_thread = 1000;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([this, t]() {
+      auto prefix = "thread_" + std::to_string(t) + "/";
+      for (int i = 0; i < num_ops_per_thread; ++i) {
+        auto key = prefix + std::to_string(i % num_keys_per_thread);
+        if (i % 100 == 0) {
+          RAY_CHECK_OK(store_client_->AsyncGetKeys(table_name_, prefix, [](auto) {}));
+        } else if (i % 2 == 0) {
+          RAY_CHECK_OK(store_client_->AsyncPut(table_name_, key, key, true, nullptr));
+        } else {
+          RAY_CHECK_OK(store_client_->AsyncGet(table_name_, key, [](auto, auto) {}));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  RAY_LOG(INFO) << "KV throughput with " << num_threads
+                << " threads: " << num_threads * num_ops_per_thread / elapsed_s
+                << " ops/s";
+}
 }  // namespace gcs
 
 }  // namespace ray
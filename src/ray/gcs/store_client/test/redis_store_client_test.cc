@@ -14,6 +14,9 @@
 
 #include "ray/gcs/store_client/redis_store_client.h"
 
+#include <algorithm>
+
+#include "absl/time/clock.h"
 #include "ray/common/test_util.h"
 #include "ray/gcs/redis_client.h"
 #include "ray/gcs/store_client/test/store_client_test_base.h"
@@ -55,6 +58,132 @@ TEST_F(RedisStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
   TestAsyncGetAllAndBatchDelete();
 }
 
+class RedisStoreClientBatchTest : public RedisStoreClientTest {
+ public:
+  void InitStoreClient() override {
+    RayConfig::instance().initialize(R"({"gcs_redis_write_batch_window_ms": 0})");
+    RedisStoreClientTest::InitStoreClient();
+  }
+
+  void TearDown() override {
+    RedisStoreClientTest::TearDown();
+    RayConfig::instance().initialize(R"({"gcs_redis_write_batch_window_ms": -1})");
+  }
+
+  /// Put `num_keys` keys with the given store client and return the throughput.
+  double PutThroughput(StoreClient &store_client, size_t num_keys) {
+    std::string data(256, 'x');
+    auto start = absl::Now();
+    for (size_t i = 0; i < num_keys; ++i) {
+      ++pending_count_;
+      RAY_CHECK_OK(store_client.AsyncPut(
+          "Benchmark", std::to_string(i), data, true, [this](auto) {
+            --pending_count_;
+          }));
+    }
+    WaitPendingDone();
+    return num_keys / absl::ToDoubleSeconds(absl::Now() - start);
+  }
+};
+
+TEST_F(RedisStoreClientBatchTest, AsyncPutAndAsyncGetTest) { TestAsyncPutAndAsyncGet(); }
+
+TEST_F(RedisStoreClientBatchTest, AsyncGetAllAndBatchDeleteTest) {
+  TestAsyncGetAllAndBatchDelete();
+}
+
+TEST_F(RedisStoreClientBatchTest, MergeWritesToSameKey) {
+  std::vector<bool> results;
+  absl::Mutex mutex;
+  auto record = [this, &results, &mutex](bool result) {
+    absl::MutexLock lock(&mutex);
+    results.push_back(result);
+    --pending_count_;
+  };
+
+  // Repeated puts are merged and the last value wins. Only the first one adds the
+  // key.
+  pending_count_ += 3;
+  for (const auto &value : {"a", "b", "c"}) {
+    RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key", value, true, record));
+  }
+  WaitPendingDone();
+  ASSERT_EQ(results, std::vector<bool>({true, false, false}));
+
+  ++pending_count_;
+  RAY_CHECK_OK(store_client_->AsyncGet(
+      table_name_, "key", [this](auto status, const auto &result) {
+        ASSERT_TRUE(result);
+        ASSERT_EQ("c", *result);
+        --pending_count_;
+      }));
+  WaitPendingDone();
+
+  // Puts without overwrite keep the existing value.
+  results.clear();
+  pending_count_ += 2;
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key", "d", false, record));
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key", "e", false, record));
+  WaitPendingDone();
+  ASSERT_EQ(results, std::vector<bool>({false, false}));
+
+  // A delete after a put is not merged with it, and a repeated delete finds nothing.
+  results.clear();
+  pending_count_ += 4;
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "other", "f", true, record));
+  RAY_CHECK_OK(store_client_->AsyncDelete(table_name_, "other", record));
+  RAY_CHECK_OK(store_client_->AsyncDelete(table_name_, "key", record));
+  RAY_CHECK_OK(store_client_->AsyncDelete(table_name_, "key", record));
+  WaitPendingDone();
+  ASSERT_EQ(results.size(), 4);
+  ASSERT_EQ(std::count(results.begin(), results.end(), true), 3);
+
+  ++pending_count_;
+  RAY_CHECK_OK(store_client_->AsyncExists(table_name_, "key", [this](bool exists) {
+    ASSERT_FALSE(exists);
+    --pending_count_;
+  }));
+  WaitPendingDone();
+}
+
+TEST_F(RedisStoreClientBatchTest, ReloadFlushedScript) {
+  // Redis drops its cached scripts, e.g. when it restarts.
+  auto reply = redis_client_->GetPrimaryContext()->RunArgvSync({"SCRIPT", "FLUSH"});
+  ASSERT_TRUE(reply != nullptr);
+  ASSERT_TRUE(reply->ReadAsStatus().ok());
+
+  // The batch that gets NOSCRIPT is sent again with the whole script, which loads
+  // it for the next batch.
+  for (const auto &value : {"a", "b"}) {
+    ++pending_count_;
+    RAY_CHECK_OK(
+        store_client_->AsyncPut(table_name_, "key", value, true, [this](bool result) {
+          --pending_count_;
+        }));
+    WaitPendingDone();
+  }
+  ++pending_count_;
+  RAY_CHECK_OK(store_client_->AsyncGet(
+      table_name_, "key", [this](auto status, const auto &result) {
+        ASSERT_TRUE(result);
+        ASSERT_EQ("b", *result);
+        --pending_count_;
+      }));
+  WaitPendingDone();
+}
+
+TEST_F(RedisStoreClientBatchTest, PutThroughputBenchmark) {
+  const size_t num_keys = 20000;
+  auto batched = PutThroughput(*store_client_, num_keys);
+
+  RayConfig::instance().initialize(R"({"gcs_redis_write_batch_window_ms": -1})");
+  RedisStoreClient unbatched_client(redis_client_);
+  auto unbatched = PutThroughput(unbatched_client, num_keys);
+
+  RAY_LOG(INFO) << "Put throughput with write batching: " << batched
+                << " ops/s, without write batching: " << unbatched << " ops/s";
+}
+
 }  // namespace gcs
 
 }  // namespace ray
@@ -19,8 +19,11 @@
 namespace ray {
 
 ChunkObjectReader::ChunkObjectReader(std::shared_ptr<IObjectReader> object,
-                                     uint64_t chunk_size)
-    : object_(std::move(object)), chunk_size_(chunk_size) {
+                                     uint64_t chunk_size,
+                                     uint64_t num_readahead_chunks)
+    : object_(std::move(object)),
+      chunk_size_(chunk_size),
+      num_readahead_chunks_(num_readahead_chunks) {
   RAY_CHECK(chunk_size_ > 0) << "chunk_size shouldn't be 0";
 }
 
@@ -30,6 +33,16 @@ uint64_t ChunkObjectReader::GetNumChunks() const {
 }
 
 absl::optional<std::string> ChunkObjectReader::GetChunk(uint64_t chunk_index) const {
+  if (num_readahead_chunks_ > 0) {
+    // Keep the next chunks loading while this one is read: the whole window on
+    // the first chunk, then the chunk entering the window on each later one.
+    const auto first_chunk = chunk_index == 0 ? 1 : chunk_index + num_readahead_chunks_;
+    const auto last_chunk = chunk_index + num_readahead_chunks_;
+    if (first_chunk <= last_chunk && first_chunk < GetNumChunks()) {
+      object_->ReadAhead(first_chunk * chunk_size_,
+                         (last_chunk - first_chunk + 1) * chunk_size_);
+    }
+  }
   // The spilled file stores metadata before data. But the GetChunk needs to
   // return data before metadata. We achieve by first read from data section,
   // then read from metadata section.
@@ -25,7 +25,11 @@ class ChunkObjectReader {
   ///
   /// \param object_url the underlying object to read from.
   /// \param chunk_size the size of chunk for read
-  ChunkObjectReader(std::shared_ptr<IObjectReader> object, uint64_t chunk_size);
+  /// \param num_readahead_chunks the number of chunks after the one being read
+  ///        to load in the background, assuming chunks are read in order.
+  ChunkObjectReader(std::shared_ptr<IObjectReader> object,
+                    uint64_t chunk_size,
+                    uint64_t num_readahead_chunks = 0);
 
   uint64_t GetNumChunks() const;
 
@@ -41,6 +45,7 @@ class ChunkObjectReader {
  private:
   const std::shared_ptr<IObjectReader> object_;
   const uint64_t chunk_size_;
+  const uint64_t num_readahead_chunks_;
 };
 
 }  // namespace ray
@@ -98,10 +98,17 @@ ray::Status ObjectBufferPool::CreateChunk(const ObjectID &object_id,
                                           const rpc::Address &owner_address,
                                           uint64_t data_size,
                                           uint64_t metadata_size,
-                                          uint64_t chunk_index) {
+                                          uint64_t chunk_index,
+                                          plasma::flatbuf::ObjectSource source,
+                                          plasma::flatbuf::CreatePriority priority) {
   absl::MutexLock lock(&pool_mutex_);
-  RAY_RETURN_NOT_OK(EnsureBufferExists(
-      object_id, owner_address, data_size, metadata_size, chunk_index));
+  RAY_RETURN_NOT_OK(EnsureBufferExists(object_id,
+                                       owner_address,
+                                       data_size,
+                                       metadata_size,
+                                       chunk_index,
+                                       source,
+                                       priority));
   auto &state = create_buffer_state_.at(object_id);
   if (chunk_index >= state.chunk_state.size()) {
     return ray::Status::IOError("Object size mismatch");
@@ -184,11 +191,14 @@ std::vector<ObjectBufferPool::ChunkInfo> ObjectBufferPool::BuildChunks(
   return chunks;
 }
 
-ray::Status ObjectBufferPool::EnsureBufferExists(const ObjectID &object_id,
-                                                 const rpc::Address &owner_address,
-                                                 uint64_t data_size,
-                                                 uint64_t metadata_size,
-                                                 uint64_t chunk_index) {
+ray::Status ObjectBufferPool::EnsureBufferExists(
+    const ObjectID &object_id,
+    const rpc::Address &owner_address,
+    uint64_t data_size,
+    uint64_t metadata_size,
+    uint64_t chunk_index,
+    plasma::flatbuf::ObjectSource source,
+    plasma::flatbuf::CreatePriority priority) {
   while (true) {
     // Buffer for object_id already exists and the size matches ours.
     {
@@ -245,7 +255,9 @@ ray::Status ObjectBufferPool::EnsureBufferExists(const ObjectID &object_id,
       nullptr,
       static_cast<int64_t>(metadata_size),
       &data,
-      plasma::flatbuf::ObjectSource::ReceivedFromRemoteRaylet);
+      source,
+      /*device_num=*/0,
+      priority);
 
   pool_mutex_.Lock();
 
@@ -104,6 +104,8 @@ class ObjectBufferPool {
   /// \param data_size The sum of the object size and metadata size.
   /// \param metadata_size The size of the metadata.
   /// \param chunk_index The index of the chunk.
+  /// \param source Where the object's data comes from, used for stats.
+  /// \param priority The priority class of the object store create request.
   /// \return status of invoking this method.
   /// An IOError status is returned if object creation on the store client fails,
   /// or if create is invoked consecutively on the same chunk
@@ -112,7 +114,12 @@ class ObjectBufferPool {
                           const rpc::Address &owner_address,
                           uint64_t data_size,
                           uint64_t metadata_size,
-                          uint64_t chunk_index) LOCKS_EXCLUDED(pool_mutex_);
+                          uint64_t chunk_index,
+                          plasma::flatbuf::ObjectSource source =
+                              plasma::flatbuf::ObjectSource::ReceivedFromRemoteRaylet,
+                          plasma::flatbuf::CreatePriority priority =
+                              plasma::flatbuf::CreatePriority::PulledObject)
+      LOCKS_EXCLUDED(pool_mutex_);
 
   /// Write to a Chunk of an object. If all chunks of an object is written,
   /// it seals the object.
@@ -162,7 +169,9 @@ class ObjectBufferPool {
                                  const rpc::Address &owner_address,
                                  uint64_t data_size,
                                  uint64_t metadata_size,
-                                 uint64_t chunk_index)
+                                 uint64_t chunk_index,
+                                 plasma::flatbuf::ObjectSource source,
+                                 plasma::flatbuf::CreatePriority priority)
       EXCLUSIVE_LOCKS_REQUIRED(pool_mutex_);
 
   void AbortCreateInternal(const ObjectID &object_id)
@@ -137,12 +137,18 @@ ObjectManager::ObjectManager(
   if (available_memory < 0) {
     available_memory = 0;
   }
+  const auto &restore_object = [this](const ObjectID &object_id,
+                                      int64_t object_size,
+                                      const std::string &spilled_url,
+                                      std::function<void(const ray::Status &)> callback) {
+    RestoreSpilledObject(object_id, object_size, spilled_url, std::move(callback));
+  };
   pull_manager_.reset(new PullManager(self_node_id_,
                                       object_is_local,
                                       send_pull_request,
                                       cancel_pull_request,
                                       fail_pull_request,
-                                      restore_spilled_object_,
+                                      restore_object,
                                       get_time,
                                       config.pull_timeout_ms,
                                       available_memory,
@@ -443,7 +449,8 @@ void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
         auto chunk_object_reader = std::make_shared<ChunkObjectReader>(
             std::make_shared<SpilledObjectReader>(
                 std::move(optional_spilled_object.value())),
-            chunk_size);
+            chunk_size,
+            RayConfig::instance().spilled_object_readahead_chunks());
 
         // Schedule PushObjectInternal back to main_service as PushObjectInternal access
         // thread unsafe datastructure.
@@ -462,6 +469,154 @@ void ObjectManager::PushFromFilesystem(const ObjectID &object_id,
       "ObjectManager.CreateSpilledObject");
 }
 
+void ObjectManager::RestoreSpilledObject(
+    const ObjectID &object_id,
+    int64_t object_size,
+    const std::string &spilled_url,
+    std::function<void(const ray::Status &)> callback) {
+  // Only objects spilled to this node's filesystem can be read directly.
+  if (RayConfig::instance().restore_spilled_objects_from_local_disk() &&
+      RayConfig::instance().is_external_storage_type_fs() &&
+      spilled_url == get_spilled_object_url_(object_id)) {
+    return RestoreFromFilesystem(
+        object_id, object_size, spilled_url, std::move(callback));
+  }
+  restore_spilled_object_(object_id, object_size, spilled_url, std::move(callback));
+}
+
+void ObjectManager::RestoreFromFilesystem(
+    const ObjectID &object_id,
+    int64_t object_size,
+    const std::string &spilled_url,
+    std::function<void(const ray::Status &)> callback) {
+  if (!objects_restoring_from_disk_.insert(object_id).second) {
+    // If the same object is restoring, we dedup here.
+    return;
+  }
+  // SpilledObjectReader does synchronous IO; schedule it off main thread.
+  rpc_service_.post(
+      [this,
+       object_id,
+       object_size,
+       spilled_url,
+       callback = std::move(callback),
+       chunk_size = config_.object_chunk_size]() mutable {
+        auto optional_spilled_object =
+            SpilledObjectReader::CreateSpilledObjectReader(spilled_url);
+        if (!optional_spilled_object.has_value() ||
+            optional_spilled_object->GetObjectSize() == 0) {
+          // Let an IO worker restore objects that can't be streamed.
+          main_service_->post(
+              [this, object_id, object_size, spilled_url, callback]() {
+                objects_restoring_from_disk_.erase(object_id);
+                restore_spilled_object_(object_id, object_size, spilled_url, callback);
+              },
+              "ObjectManager.RestoreSpilledObject");
+          return;
+        }
+        auto chunk_reader = std::make_shared<ChunkObjectReader>(
+            std::make_shared<SpilledObjectReader>(
+                std::move(optional_spilled_object.value())),
+            chunk_size,
+            RayConfig::instance().spilled_object_readahead_chunks());
+        WriteSpilledObjectChunks(object_id,
+                                 std::move(chunk_reader),
+                                 /*chunk_index=*/0,
+                                 absl::GetCurrentTimeNanos(),
+                                 std::move(callback));
+      },
+      "ObjectManager.ReadSpilledObject");
+}
+
+void ObjectManager::WriteSpilledObjectChunks(
+    const ObjectID &object_id,
+    std::shared_ptr<ChunkObjectReader> chunk_reader,
+    uint64_t chunk_index,
+    int64_t start_time_ns,
+    std::function<void(const ray::Status &)> callback) {
+  const auto status = WriteSpilledObjectChunk(object_id, *chunk_reader, chunk_index);
+  if (status.ok() && chunk_index + 1 < chunk_reader->GetNumChunks()) {
+    // Repost for the next chunk so that restoring a large object doesn't hold
+    // an rpc thread while pushes and other restores are waiting.
+    rpc_service_.post(
+        [this,
+         object_id,
+         chunk_reader = std::move(chunk_reader),
+         chunk_index,
+         start_time_ns,
+         callback = std::move(callback)]() mutable {
+          WriteSpilledObjectChunks(object_id,
+                                   std::move(chunk_reader),
+                                   chunk_index + 1,
+                                   start_time_ns,
+                                   std::move(callback));
+        },
+        "ObjectManager.WriteSpilledObjectChunk");
+    return;
+  }
+  const auto bytes_restored = chunk_reader->GetObject().GetObjectSize();
+  RAY_LOG(DEBUG) << "Restored " << bytes_restored << " bytes of object " << object_id
+                 << " from local disk in "
+                 << (absl::GetCurrentTimeNanos() - start_time_ns) / 1e6
+                 << "ms, status: " << status;
+  main_service_->post(
+      [this, object_id, status, bytes_restored, callback = std::move(callback)]() {
+        objects_restoring_from_disk_.erase(object_id);
+        if (status.ok()) {
+          num_bytes_restored_from_disk_ += bytes_restored;
+        }
+        if (callback) {
+          callback(status);
+        }
+      },
+      "ObjectManager.RestoreFromFilesystem");
+}
+
+Status ObjectManager::WriteSpilledObjectChunk(const ObjectID &object_id,
+                                              const ChunkObjectReader &chunk_reader,
+                                              uint64_t chunk_index) {
+  const auto &object = chunk_reader.GetObject();
+  if (!pull_manager_->IsObjectActive(object_id)) {
+    // This object is no longer being actively pulled.
+    buffer_pool_.AbortCreate(object_id);
+    return Status::Invalid("Object is no longer needed.");
+  }
+  // Only one chunk is held in memory at a time. The readahead keeps the disk
+  // busy while a chunk is copied into the object store.
+  auto optional_chunk = chunk_reader.GetChunk(chunk_index);
+  if (!optional_chunk.has_value()) {
+    buffer_pool_.AbortCreate(object_id);
+    return Status::IOError("Failed to read spilled object");
+  }
+  auto status =
+      buffer_pool_.CreateChunk(object_id,
+                               object.GetOwnerAddress(),
+                               object.GetObjectSize(),
+                               object.GetMetadataSize(),
+                               chunk_index,
+                               plasma::flatbuf::ObjectSource::RestoredFromStorage,
+                               plasma::flatbuf::CreatePriority::RestoredObject);
+  if (!status.ok()) {
+    if (status.IsOutOfDisk()) {
+      pull_manager_->SetOutOfDisk(object_id);
+    }
+    buffer_pool_.AbortCreate(object_id);
+    return status;
+  }
+  if (!pull_manager_->IsObjectActive(object_id)) {
+    // Check again because the pull may have been deactivated right before
+    // creating the chunk, as in ReceiveObjectChunk.
+    buffer_pool_.AbortCreate(object_id);
+    return Status::Invalid("Object is no longer needed.");
+  }
+  buffer_pool_.WriteChunk(object_id,
+                          object.GetObjectSize(),
+                          object.GetMetadataSize(),
+                          chunk_index,
+                          optional_chunk.value());
+  return Status::OK();
+}
+
 void ObjectManager::PushObjectInternal(const ObjectID &object_id,
                                        const NodeID &node_id,
                                        std::shared_ptr<ChunkObjectReader> chunk_reader,
@@ -763,6 +918,8 @@ void ObjectManager::RecordMetrics() {
   ray::stats::STATS_object_manager_bytes.Record(num_bytes_pushed_from_disk_,
                                                 "PushedFromLocalDisk");
   ray::stats::STATS_object_manager_bytes.Record(num_bytes_received_total_, "Received");
+  ray::stats::STATS_object_manager_bytes.Record(num_bytes_restored_from_disk_,
+                                                "RestoredFromLocalDisk");
 
   ray::stats::STATS_object_manager_received_chunks.Record(num_chunks_received_total_,
                                                           "Total");
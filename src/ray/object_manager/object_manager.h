@@ -281,6 +281,60 @@ class ObjectManager : public ObjectManagerInterface,
                           const NodeID &node_id,
                           const std::string &spilled_url);
 
+  /// Restore a spilled object into the local object store. Objects spilled to
+  /// the local filesystem are streamed in chunks by RestoreFromFilesystem, and
+  /// other objects are restored by an IO worker.
+  ///
+  /// \param object_id The object's id.
+  /// \param object_size The size of the object.
+  /// \param spilled_url The url of the spilled object.
+  /// \param callback Callback to call when the restoration is done.
+  void RestoreSpilledObject(const ObjectID &object_id,
+                            int64_t object_size,
+                            const std::string &spilled_url,
+                            std::function<void(const ray::Status &)> callback);
+
+  /// Restore an object spilled to the local filesystem by reading it in chunks
+  /// with readahead and writing each chunk into the object store, without first
+  /// reading the whole object. This is a no-op if the object is already being
+  /// restored.
+  ///
+  /// \param object_id The object's id.
+  /// \param object_size The size of the object.
+  /// \param spilled_url The url of the spilled object.
+  /// \param callback Callback to call when the restoration is done.
+  void RestoreFromFilesystem(const ObjectID &object_id,
+                             int64_t object_size,
+                             const std::string &spilled_url,
+                             std::function<void(const ray::Status &)> callback);
+
+  /// Write the chunks of a spilled object into the object store, starting at
+  /// chunk_index. Each chunk is written in its own rpc service handler, and the
+  /// callback is posted to the main service once the object is sealed or a chunk
+  /// fails.
+  ///
+  /// \param object_id The object's id.
+  /// \param chunk_reader Chunk reader used to read the spilled object.
+  /// \param chunk_index The index of the next chunk to write.
+  /// \param start_time_ns When the restore started, used for logging.
+  /// \param callback Callback to call when the restoration is done.
+  void WriteSpilledObjectChunks(const ObjectID &object_id,
+                                std::shared_ptr<ChunkObjectReader> chunk_reader,
+                                uint64_t chunk_index,
+                                int64_t start_time_ns,
+                                std::function<void(const ray::Status &)> callback);
+
+  /// Write one chunk of a spilled object into the object store. This does
+  /// synchronous IO and runs on the rpc service.
+  ///
+  /// \param object_id The object's id.
+  /// \param chunk_reader Chunk reader used to read the spilled object.
+  /// \param chunk_index The index of the chunk to write.
+  /// \return Status::OK() if the chunk was written.
+  Status WriteSpilledObjectChunk(const ObjectID &object_id,
+                                 const ChunkObjectReader &chunk_reader,
+                                 uint64_t chunk_index);
+
   /// The internal implementation of pushing an object.
   ///
   /// \param object_id The object's id.
@@ -473,6 +527,10 @@ class ObjectManager : public ObjectManagerInterface,
   size_t num_bytes_received_total_ = 0;
   size_t num_bytes_pushed_from_disk_ = 0;
   size_t num_bytes_pushed_from_plasma_ = 0;
+  size_t num_bytes_restored_from_disk_ = 0;
+
+  /// Objects that are being restored by RestoreFromFilesystem.
+  absl::flat_hash_set<ObjectID> objects_restoring_from_disk_;
 
   /// Running total of received chunks.
   size_t num_chunks_received_total_ = 0;
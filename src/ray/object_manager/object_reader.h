@@ -53,5 +53,13 @@ class IObjectReader {
   virtual bool ReadFromMetadataSection(uint64_t offset,
                                        uint64_t size,
                                        char *output) const = 0;
+
+  /// Hint that a range of the object will be read soon, so that readers backed
+  /// by slow storage can start loading it in the background. The range is in the
+  /// order that chunks return the object: data followed by metadata.
+  ///
+  /// \param offset offset to the start of the data section.
+  /// \param size number of bytes that will be read.
+  virtual void ReadAhead(uint64_t offset, uint64_t size) const {}
 };
 }  // namespace ray
@@ -16,6 +16,8 @@
 // under the License.
 #pragma once
 
+#include <sstream>
+
 #include "absl/types/optional.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/object_manager/plasma/compat.h"
@@ -59,6 +61,14 @@ class IAllocator {
 
   /// Get the number of bytes fallback allocated so far.
   virtual int64_t FallbackAllocated() const = 0;
+
+  /// Get the size of the largest primary allocation that can succeed.
+  ///
+  /// \return the size in bytes, or -1 if the allocator doesn't track it.
+  virtual int64_t GetLargestFreeExtent() const { return -1; }
+
+  /// Write debug information about the allocator, if any, to `buffer`.
+  virtual void GetDebugDump(std::stringstream &buffer) const {}
 };
 
 }  // namespace plasma
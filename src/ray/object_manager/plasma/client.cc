@@ -33,6 +33,7 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/ray_config.h"
 #include "ray/object_manager/plasma/connection.h"
+#include "ray/object_manager/plasma/object_index.h"
 #include "ray/object_manager/plasma/plasma.h"
 #include "ray/object_manager/plasma/protocol.h"
 #include "ray/object_manager/plasma/shared_memory.h"
@@ -94,6 +95,11 @@ struct ObjectInUseEntry {
   PlasmaObject object;
   /// A flag representing whether the object has been sealed.
   bool is_sealed;
+  /// Whether the store counts this client as using the object, i.e. the client got
+  /// the object through a message. Then it must send a release request.
+  bool has_store_reference = true;
+  /// The pin of the object in the object index of the store, -1 if not pinned.
+  int64_t index_pin = -1;
 };
 
 class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Impl> {
@@ -117,7 +123,9 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
                                 int64_t metadata_size,
                                 std::shared_ptr<Buffer> *data,
                                 fb::ObjectSource source,
-                                int device_num = 0);
+                                int device_num = 0,
+                                fb::CreatePriority priority = fb::CreatePriority::Put,
+                                int64_t deadline_ms = -1);
 
   Status RetryCreate(const ObjectID &object_id,
                      uint64_t request_id,
@@ -197,9 +205,10 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
 
   uint8_t *LookupMmappedFile(MEMFD_TYPE store_fd_val);
 
-  void IncrementObjectCount(const ObjectID &object_id,
-                            PlasmaObject *object,
-                            bool is_sealed);
+  /// \return The entry of the object in `objects_in_use_`.
+  ObjectInUseEntry *IncrementObjectCount(const ObjectID &object_id,
+                                         PlasmaObject *object,
+                                         bool is_sealed);
 
   /// The boost::asio IO context for the client.
   instrumented_io_context main_service_;
@@ -222,6 +231,12 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
   int64_t store_capacity_;
   /// A hash set to record the ids that users want to delete but still in use.
   std::unordered_set<ObjectID> deletion_cache_;
+  /// The shared memory index of the sealed objects in use published by the store, to
+  /// get them without sending messages. Null if the store has no index for this
+  /// client.
+  std::unique_ptr<ObjectIndex> object_index_;
+  /// The pin table of this client in `object_index_`.
+  int64_t object_index_pin_table_ = -1;
   /// A mutex which protects this class.
   std::recursive_mutex client_mutex_;
 };
@@ -270,9 +285,9 @@ bool PlasmaClient::Impl::IsInUse(const ObjectID &object_id) {
   return (elem != objects_in_use_.end());
 }
 
-void PlasmaClient::Impl::IncrementObjectCount(const ObjectID &object_id,
-                                              PlasmaObject *object,
-                                              bool is_sealed) {
+ObjectInUseEntry *PlasmaClient::Impl::IncrementObjectCount(const ObjectID &object_id,
+                                                           PlasmaObject *object,
+                                                           bool is_sealed) {
   // Increment the count of the object to track the fact that it is being used.
   // The corresponding decrement should happen in PlasmaClient::Release.
   auto elem = objects_in_use_.find(object_id);
@@ -293,6 +308,7 @@ void PlasmaClient::Impl::IncrementObjectCount(const ObjectID &object_id,
   // being used by this client. The corresponding decrement should happen in
   // PlasmaClient::Release.
   object_entry->count += 1;
+  return object_entry;
 }
 
 Status PlasmaClient::Impl::HandleCreateReply(const ObjectID &object_id,
@@ -364,7 +380,9 @@ Status PlasmaClient::Impl::CreateAndSpillIfNeeded(const ObjectID &object_id,
                                                   int64_t metadata_size,
                                                   std::shared_ptr<Buffer> *data,
                                                   fb::ObjectSource source,
-                                                  int device_num) {
+                                                  int device_num,
+                                                  fb::CreatePriority priority,
+                                                  int64_t deadline_ms) {
   std::unique_lock<std::recursive_mutex> guard(client_mutex_);
   uint64_t retry_with_request_id = 0;
 
@@ -377,7 +395,9 @@ Status PlasmaClient::Impl::CreateAndSpillIfNeeded(const ObjectID &object_id,
                                       metadata_size,
                                       source,
                                       device_num,
-                                      /*try_immediately=*/false));
+                                      /*try_immediately=*/false,
+                                      priority,
+                                      deadline_ms));
   Status status = HandleCreateReply(object_id, metadata, &retry_with_request_id, data);
 
   while (retry_with_request_id > 0) {
@@ -441,9 +461,36 @@ Status PlasmaClient::Impl::GetBuffers(
   for (int64_t i = 0; i < num_objects; ++i) {
     auto object_entry = objects_in_use_.find(object_ids[i]);
     if (object_entry == objects_in_use_.end()) {
-      // This object is not currently in use by this client, so we need to send
-      // a request to the store.
-      all_present = false;
+      // This object is not currently in use by this client. Pin it through the object
+      // index if the store published it, else we need to send a request to the store.
+      PlasmaObject object;
+      const int64_t pin =
+          object_index_
+              ? object_index_->Pin(object_index_pin_table_, object_ids[i], &object)
+              : -1;
+      if (pin == -1) {
+        all_present = false;
+        continue;
+      }
+      auto mmap_entry = mmap_table_.find(object.store_fd);
+      if (mmap_entry == mmap_table_.end()) {
+        // The file isn't mapped yet, the store sends it with the get reply.
+        object_index_->Unpin(object_index_pin_table_, pin);
+        all_present = false;
+        continue;
+      }
+      std::shared_ptr<Buffer> physical_buf = std::make_shared<SharedMemoryBuffer>(
+          mmap_entry->second->pointer() + object.data_offset,
+          object.data_size + object.metadata_size);
+      physical_buf = wrap_buffer(object_ids[i], physical_buf);
+      object_buffers[i].data =
+          SharedMemoryBuffer::Slice(physical_buf, 0, object.data_size);
+      object_buffers[i].metadata = SharedMemoryBuffer::Slice(
+          physical_buf, object.data_size, object.metadata_size);
+      object_buffers[i].device_num = object.device_num;
+      ObjectInUseEntry *entry = IncrementObjectCount(object_ids[i], &object, true);
+      entry->has_store_reference = false;
+      entry->index_pin = pin;
     } else if (!object_entry->second->is_sealed) {
       // This client created the object but hasn't sealed it. If we call Get
       // with no timeout, we will deadlock, because this client won't be able to
@@ -513,6 +560,9 @@ Status PlasmaClient::Impl::GetBuffers(
       // If the object was already in use by the client, then the store should
       // have returned it.
       RAY_DCHECK(object->data_size != -1);
+      // If the client only pinned the object through the index, the store now counts
+      // it as using the object too.
+      objects_in_use_[object_ids[i]]->has_store_reference = true;
       // We've already filled out the information for this object, so we can
       // just continue.
       continue;
@@ -588,9 +638,16 @@ Status PlasmaClient::Impl::Release(const ObjectID &object_id) {
   RAY_CHECK(object_entry->second->count >= 0);
   // Check if the client is no longer using this object.
   if (object_entry->second->count == 0) {
-    // Tell the store that the client no longer needs the object.
+    const bool has_store_reference = object_entry->second->has_store_reference;
+    const int64_t index_pin = object_entry->second->index_pin;
     RAY_RETURN_NOT_OK(MarkObjectUnused(object_id));
-    RAY_RETURN_NOT_OK(SendReleaseRequest(store_conn_, object_id));
+    if (index_pin != -1) {
+      object_index_->Unpin(object_index_pin_table_, index_pin);
+    }
+    if (has_store_reference) {
+      // Tell the store that the client no longer needs the object.
+      RAY_RETURN_NOT_OK(SendReleaseRequest(store_conn_, object_id));
+    }
     auto iter = deletion_cache_.find(object_id);
     if (iter != deletion_cache_.end()) {
       deletion_cache_.erase(object_id);
@@ -730,7 +787,21 @@ Status PlasmaClient::Impl::Connect(const std::string &store_socket_name,
   RAY_RETURN_NOT_OK(SendConnectRequest(store_conn_));
   std::vector<uint8_t> buffer;
   RAY_RETURN_NOT_OK(PlasmaReceive(store_conn_, MessageType::PlasmaConnectReply, &buffer));
-  RAY_RETURN_NOT_OK(ReadConnectReply(buffer.data(), buffer.size(), &store_capacity_));
+  MEMFD_TYPE object_index_fd;
+  int64_t object_index_offset;
+  int64_t object_index_mmap_size;
+  RAY_RETURN_NOT_OK(ReadConnectReply(buffer.data(),
+                                     buffer.size(),
+                                     &store_capacity_,
+                                     &object_index_pin_table_,
+                                     &object_index_fd,
+                                     &object_index_offset,
+                                     &object_index_mmap_size));
+  if (object_index_pin_table_ >= 0) {
+    object_index_ = std::make_unique<ObjectIndex>(
+        GetStoreFdAndMmap(object_index_fd, object_index_mmap_size) +
+        object_index_offset);
+  }
   return Status::OK();
 }
 
@@ -742,8 +813,11 @@ Status PlasmaClient::Impl::Disconnect() {
   // a SIGTERM, for example).
 
   // Close the connections to Plasma. The Plasma store will release the objects
-  // that were in use by us when handling the SIGPIPE.
+  // that were in use by us when handling the SIGPIPE, and drop our pins in the object
+  // index, whose pin table it may then give to another client.
   store_conn_.reset();
+  object_index_.reset();
+  object_index_pin_table_ = -1;
   return Status::OK();
 }
 
@@ -785,7 +859,9 @@ Status PlasmaClient::CreateAndSpillIfNeeded(const ObjectID &object_id,
                                             int64_t metadata_size,
                                             std::shared_ptr<Buffer> *data,
                                             fb::ObjectSource source,
-                                            int device_num) {
+                                            int device_num,
+                                            fb::CreatePriority priority,
+                                            int64_t deadline_ms) {
   return impl_->CreateAndSpillIfNeeded(object_id,
                                        owner_address,
                                        data_size,
@@ -793,7 +869,9 @@ Status PlasmaClient::CreateAndSpillIfNeeded(const ObjectID &object_id,
                                        metadata_size,
                                        data,
                                        source,
-                                       device_num);
+                                       device_num,
+                                       priority,
+                                       deadline_ms);
 }
 
 Status PlasmaClient::TryCreateImmediately(const ObjectID &object_id,
@@ -121,6 +121,10 @@ class PlasmaClientInterface {
   ///        device_num = 0 corresponds to the host,
   ///        device_num = 1 corresponds to GPU0,
   ///        device_num = 2 corresponds to GPU1, etc.
+  /// \param priority The priority class of the request. When the object store is
+  ///        full, requests of a higher class are served first.
+  /// \param deadline_ms How long the request can wait for space in the object
+  ///        store before the object is created on disk, -1 for no deadline.
   /// \return The return status.
   ///
   /// The returned object must be released once it is done with.  It must also
@@ -132,7 +136,10 @@ class PlasmaClientInterface {
                                         int64_t metadata_size,
                                         std::shared_ptr<Buffer> *data,
                                         plasma::flatbuf::ObjectSource source,
-                                        int device_num = 0) = 0;
+                                        int device_num = 0,
+                                        plasma::flatbuf::CreatePriority priority =
+                                            plasma::flatbuf::CreatePriority::Put,
+                                        int64_t deadline_ms = -1) = 0;
 
   /// Delete a list of objects from the object store. This currently assumes that the
   /// object is present, has been sealed and not used by another client. Otherwise,
@@ -187,6 +194,10 @@ class PlasmaClient : public PlasmaClientInterface {
   ///        device_num = 0 corresponds to the host,
   ///        device_num = 1 corresponds to GPU0,
   ///        device_num = 2 corresponds to GPU1, etc.
+  /// \param priority The priority class of the request. When the object store is
+  ///        full, requests of a higher class are served first.
+  /// \param deadline_ms How long the request can wait for space in the object
+  ///        store before the object is created on disk, -1 for no deadline.
   /// \return The return status.
   ///
   /// The returned object must be released once it is done with.  It must also
@@ -198,7 +209,10 @@ class PlasmaClient : public PlasmaClientInterface {
                                 int64_t metadata_size,
                                 std::shared_ptr<Buffer> *data,
                                 plasma::flatbuf::ObjectSource source,
-                                int device_num = 0);
+                                int device_num = 0,
+                                plasma::flatbuf::CreatePriority priority =
+                                    plasma::flatbuf::CreatePriority::Put,
+                                int64_t deadline_ms = -1);
 
   /// Create an object in the Plasma Store. Any metadata for this object must be
   /// be passed in when the object is created.
@@ -96,6 +96,7 @@ struct Allocation {
         fallback_allocated(false) {}
 
   friend class PlasmaAllocator;
+  friend class SizeClassAllocator;
   friend class DummyAllocator;
   friend struct ObjectLifecycleManagerTest;
   FRIEND_TEST(ObjectStoreTest, PassThroughTest);
@@ -143,6 +144,7 @@ class LocalObject {
   FRIEND_TEST(ObjectStoreTest, PassThroughTest);
   friend struct ObjectLifecycleManagerTest;
   FRIEND_TEST(ObjectLifecycleManagerTest, RemoveReferenceOneRefNotSealed);
+  FRIEND_TEST(ObjectLifecycleManagerTest, CompactObjects);
   friend struct ObjectStatsCollectorTest;
   FRIEND_TEST(EvictionPolicyTest, Test);
   friend struct GetRequestQueueTest;
@@ -47,6 +47,9 @@ class Client : public ray::ClientConnection, public ClientInterface {
 
   std::string name = "anonymous_client";
 
+  /// The pin table of this client in the object index of the store, -1 if none.
+  int64_t object_index_pin_table = -1;
+
  private:
   Client(ray::MessageHandler &message_handler, ray::local_stream_socket &&socket);
   /// File descriptors that are used by this client.
@@ -16,10 +16,13 @@
 
 #include <stdlib.h>
 
+#include <limits>
 #include <memory>
+#include <utility>
 
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/object_manager/plasma/common.h"
+#include "ray/stats/metric_defs.h"
 #include "ray/util/util.h"
 
 namespace plasma {
@@ -27,11 +30,33 @@ namespace plasma {
 uint64_t CreateRequestQueue::AddRequest(const ObjectID &object_id,
                                         const std::shared_ptr<ClientInterface> &client,
                                         const CreateObjectCallback &create_callback,
-                                        size_t object_size) {
+                                        size_t object_size,
+                                        flatbuf::CreatePriority priority,
+                                        int64_t deadline_ms) {
   auto req_id = next_req_id_++;
   fulfilled_requests_[req_id] = nullptr;
-  queue_.emplace_back(
-      new CreateRequest(object_id, req_id, client, create_callback, object_size));
+  const int64_t now = get_time_();
+  const int64_t deadline_ns = deadline_ms < 0 ? -1 : now + deadline_ms * 1000000;
+  // Requests without a deadline go after the requests of their class with one.
+  auto sort_key = [](flatbuf::CreatePriority priority, int64_t deadline_ns) {
+    return std::make_pair(priority,
+                          deadline_ns == -1 ? std::numeric_limits<int64_t>::max()
+                                            : deadline_ns);
+  };
+  const auto key = sort_key(priority, deadline_ns);
+  auto it = queue_.begin();
+  while (it != queue_.end() && sort_key((*it)->priority, (*it)->deadline_ns) <= key) {
+    it++;
+  }
+  queue_.emplace(it,
+                 new CreateRequest(object_id,
+                                   req_id,
+                                   client,
+                                   create_callback,
+                                   object_size,
+                                   priority,
+                                   now,
+                                   deadline_ns));
   num_bytes_pending_ += object_size;
   return req_id;
 }
@@ -90,6 +115,10 @@ Status CreateRequestQueue::ProcessRequests() {
   bool logged_oom = false;
   while (!queue_.empty()) {
     auto request_it = queue_.begin();
+    if (IsPastDeadline(**request_it, get_time_())) {
+      ProcessRequestPastDeadline(request_it, &logged_oom);
+      continue;
+    }
     bool spilling_required = false;
     auto status =
         ProcessRequest(/*fallback_allocator=*/false, *request_it, &spilling_required);
@@ -125,33 +154,17 @@ Status CreateRequestQueue::ProcessRequests() {
       if (spill_pending) {
         RAY_LOG(DEBUG) << "Reset grace period " << status << " " << spill_pending;
         oom_start_time_ns_ = -1;
+        ProcessRequestsBehind(request_it, &logged_oom);
         return Status::TransientObjectStoreFull("Waiting for objects to spill.");
       } else if (now - oom_start_time_ns_ < grace_period_ns) {
         // We need a grace period since (1) global GC takes a bit of time to
         // kick in, and (2) there is a race between spilling finishing and space
         // actually freeing up in the object store.
         RAY_LOG(DEBUG) << "In grace period before fallback allocation / oom.";
+        ProcessRequestsBehind(request_it, &logged_oom);
         return Status::ObjectStoreFull("Waiting for grace period.");
       } else {
-        // Trigger the fallback allocator.
-        status = ProcessRequest(/*fallback_allocator=*/true,
-                                *request_it,
-                                /*spilling_required=*/nullptr);
-        if (!status.ok()) {
-          // This only happens when an allocation is bigger than available disk space.
-          // We should throw OutOfDisk Error here.
-          (*request_it)->error = PlasmaError::OutOfDisk;
-          std::string dump = "";
-          if (dump_debug_info_callback_ && !logged_oom) {
-            dump = dump_debug_info_callback_();
-            logged_oom = true;
-          }
-          RAY_LOG(INFO) << "Out-of-disk: Failed to create object "
-                        << (*request_it)->object_id << " of size "
-                        << (*request_it)->object_size / 1024 / 1024 << "MB\n"
-                        << dump;
-        }
-        FinishRequest(request_it);
+        ProcessRequestWithFallback(request_it, &logged_oom);
       }
     }
   }
@@ -159,10 +172,74 @@ Status CreateRequestQueue::ProcessRequests() {
   return Status::OK();
 }
 
+void CreateRequestQueue::ProcessRequestWithFallback(
+    std::list<std::unique_ptr<CreateRequest>>::iterator request_it, bool *logged_oom) {
+  // Trigger the fallback allocator.
+  auto status = ProcessRequest(/*fallback_allocator=*/true,
+                               *request_it,
+                               /*spilling_required=*/nullptr);
+  if (!status.ok()) {
+    // This only happens when an allocation is bigger than available disk space.
+    // We should throw OutOfDisk Error here.
+    (*request_it)->error = PlasmaError::OutOfDisk;
+    std::string dump = "";
+    if (dump_debug_info_callback_ && !*logged_oom) {
+      dump = dump_debug_info_callback_();
+      *logged_oom = true;
+    }
+    RAY_LOG(INFO) << "Out-of-disk: Failed to create object " << (*request_it)->object_id
+                  << " of size " << (*request_it)->object_size / 1024 / 1024 << "MB\n"
+                  << dump;
+  }
+  FinishRequest(request_it);
+}
+
+void CreateRequestQueue::ProcessRequestPastDeadline(
+    std::list<std::unique_ptr<CreateRequest>>::iterator request_it, bool *logged_oom) {
+  // Space may have been freed since the request was last tried, so only fall back if
+  // the object still doesn't fit in the primary memory.
+  if (ProcessRequest(/*fallback_allocator=*/false,
+                     *request_it,
+                     /*spilling_required=*/nullptr)
+          .ok()) {
+    FinishRequest(request_it);
+    return;
+  }
+  ProcessRequestWithFallback(request_it, logged_oom);
+}
+
+void CreateRequestQueue::ProcessRequestsBehind(
+    std::list<std::unique_ptr<CreateRequest>>::iterator head_it, bool *logged_oom) {
+  const size_t head_size = (*head_it)->object_size;
+  const auto head_priority = (*head_it)->priority;
+  const int64_t now = get_time_();
+  for (auto it = std::next(head_it); it != queue_.end();) {
+    auto request_it = it++;
+    auto &request = *request_it;
+    if (IsPastDeadline(*request, now)) {
+      ProcessRequestPastDeadline(request_it, logged_oom);
+    } else if (request->object_size < head_size && request->priority <= head_priority) {
+      // The request may fit in the space that is left. This doesn't reset the OOM
+      // timer, which is for the head of the queue.
+      if (ProcessRequest(/*fallback_allocator=*/false,
+                         request,
+                         /*spilling_required=*/nullptr)
+              .ok()) {
+        RAY_LOG(DEBUG) << "Created object " << request->object_id
+                       << " ahead of a blocked request for a larger object.";
+        FinishRequest(request_it);
+      }
+    }
+  }
+}
+
 void CreateRequestQueue::FinishRequest(
     std::list<std::unique_ptr<CreateRequest>>::iterator request_it) {
   // Fulfill the request.
   auto &request = *request_it;
+  ray::stats::STATS_object_store_create_request_wait_time_ms.Record(
+      static_cast<double>(get_time_() - request->add_time_ns) / 1e6,
+      flatbuf::EnumNameCreatePriority(request->priority));
   auto it = fulfilled_requests_.find(request->request_id);
   RAY_CHECK(it != fulfilled_requests_.end());
   RAY_CHECK(it->second == nullptr);
@@ -51,18 +51,24 @@ class CreateRequestQueue {
   /// to later get the result of the request.
   ///
   /// The request may not get tried immediately if the head of the queue is not
-  /// serviceable.
+  /// serviceable. The queue is ordered by priority class, then by deadline, then by
+  /// arrival.
   ///
   /// \param object_id The ID of the object to create.
   /// \param client The client that sent the request. This is used as a key to
   /// drop this request if the client disconnects.
   /// \param create_callback A callback to attempt to create the object.
   /// \param object_size Object size in bytes.
+  /// \param priority The priority class of the request.
+  /// \param deadline_ms How long the request can wait for space before it is
+  /// served with the fallback allocator. -1 means no deadline.
   /// \return A request ID that can be used to get the result.
   uint64_t AddRequest(const ObjectID &object_id,
                       const std::shared_ptr<ClientInterface> &client,
                       const CreateObjectCallback &create_callback,
-                      const size_t object_size);
+                      const size_t object_size,
+                      flatbuf::CreatePriority priority = flatbuf::CreatePriority::Put,
+                      int64_t deadline_ms = -1);
 
   /// Get the result of a request.
   ///
@@ -101,8 +107,11 @@ class CreateRequestQueue {
   /// Process requests in the queue.
   ///
   /// This will try to process as many requests in the queue as possible, in
-  /// FIFO order. If the first request is not serviceable, this will break and
-  /// the caller should try again later.
+  /// queue order. If the first request is not serviceable, this will break and
+  /// the caller should try again later. Before that, the requests behind it that
+  /// are smaller and of the same or a higher priority class are tried, so that
+  /// they don't wait for a large object, and the requests past their deadline are
+  /// served with the fallback allocator.
   ///
   /// \return Bad status for the first request in the queue if it failed to be
   /// serviced, or OK if all requests were fulfilled.
@@ -123,12 +132,18 @@ class CreateRequestQueue {
                   uint64_t request_id,
                   const std::shared_ptr<ClientInterface> &client,
                   CreateObjectCallback create_callback,
-                  size_t object_size)
+                  size_t object_size,
+                  flatbuf::CreatePriority priority,
+                  int64_t add_time_ns,
+                  int64_t deadline_ns)
         : object_id(object_id),
           request_id(request_id),
           client(client),
           create_callback(create_callback),
-          object_size(object_size) {}
+          object_size(object_size),
+          priority(priority),
+          add_time_ns(add_time_ns),
+          deadline_ns(deadline_ns) {}
 
     // The ObjectID to create.
     const ObjectID object_id;
@@ -146,6 +161,14 @@ class CreateRequestQueue {
 
     const size_t object_size;
 
+    const flatbuf::CreatePriority priority;
+
+    // When the request was added to the queue.
+    const int64_t add_time_ns;
+
+    // When the request has to be served with the fallback allocator, -1 if never.
+    const int64_t deadline_ns;
+
     // The results of the creation call. These should be sent back to the
     // client once ready.
     PlasmaError error = PlasmaError::OK;
@@ -159,6 +182,27 @@ class CreateRequestQueue {
                         std::unique_ptr<CreateRequest> &request,
                         bool *spilling_required);
 
+  /// Serve a request with the fallback allocator, failing it with an out-of-disk
+  /// error if that doesn't work either, and finish it.
+  void ProcessRequestWithFallback(
+      std::list<std::unique_ptr<CreateRequest>>::iterator request_it, bool *logged_oom);
+
+  /// Serve a request that is past its deadline, from the primary memory if it fits
+  /// there and with the fallback allocator otherwise, and finish it.
+  void ProcessRequestPastDeadline(
+      std::list<std::unique_ptr<CreateRequest>>::iterator request_it, bool *logged_oom);
+
+  /// Try the requests behind a head of the queue that can't be served yet: the ones
+  /// that are smaller than the head and of the same or a higher priority class, and
+  /// the ones past their deadline.
+  void ProcessRequestsBehind(
+      std::list<std::unique_ptr<CreateRequest>>::iterator head_it, bool *logged_oom);
+
+  /// Whether a request is past its deadline.
+  bool IsPastDeadline(const CreateRequest &request, int64_t now) const {
+    return request.deadline_ns != -1 && now >= request.deadline_ns;
+  }
+
   /// Finish a queued request and remove it from the queue.
   void FinishRequest(std::list<std::unique_ptr<CreateRequest>>::iterator request_it);
 
@@ -195,6 +239,7 @@ class CreateRequestQueue {
   /// spilled, we will attempt to process these requests again and respond to
   /// the client if successful or out of memory. If more objects must be
   /// spilled, the request will be replaced at the head of the queue.
+  /// The queue is ordered by priority class, then by deadline, then by arrival.
   /// TODO(swang): We should also queue objects here even if there is no room
   /// in the object store. Then, the client does not need to poll on an
   /// OutOfMemory error and we can just respond to them once there is enough
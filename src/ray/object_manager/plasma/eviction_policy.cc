@@ -23,6 +23,13 @@
 #include "ray/object_manager/plasma/plasma_allocator.h"
 
 namespace plasma {
+namespace {
+
+/// The number of uses after which an object of the fallback tier is promoted back to
+/// the primary memory.
+constexpr int64_t kNumUsesToPromote = 2;
+
+}  // namespace
 
 void LRUCache::Add(const ObjectID &key, int64_t size) {
   auto it = item_map_.find(key);
@@ -94,9 +101,11 @@ int64_t LRUCache::ChooseObjectsToEvict(int64_t num_bytes_required,
 bool LRUCache::Exists(const ObjectID &key) const { return item_map_.count(key) > 0; }
 
 EvictionPolicy::EvictionPolicy(const IObjectStore &object_store,
-                               const IAllocator &allocator)
+                               const IAllocator &allocator,
+                               int64_t fallback_tier_capacity)
     : pinned_memory_bytes_(0),
       cache_("global lru", allocator.GetFootprintLimit()),
+      fallback_tier_cache_("fallback tier lru", fallback_tier_capacity),
       object_store_(object_store),
       allocator_(allocator) {}
 
@@ -112,13 +121,19 @@ int64_t EvictionPolicy::ChooseObjectsToEvict(int64_t num_bytes_required,
 }
 
 void EvictionPolicy::ObjectCreated(const ObjectID &object_id) {
-  cache_.Add(object_id, GetObjectSize(object_id));
+  const auto *object = object_store_.GetObject(object_id);
+  GetCache(*object).Add(object_id, object->GetObjectSize());
 }
 
 int64_t EvictionPolicy::RequireSpace(int64_t size,
                                      std::vector<ObjectID> &objects_to_evict) {
-  // Check if there is enough space to create the object.
-  int64_t required_space = allocator_.Allocated() + size - allocator_.GetFootprintLimit();
+  // Check if there is enough space to create the object. The objects of the fallback
+  // tier don't take primary memory.
+  int64_t allocated = allocator_.Allocated();
+  if (fallback_tier_cache_.OriginalCapacity() > 0) {
+    allocated -= allocator_.FallbackAllocated();
+  }
+  int64_t required_space = allocated + size - allocator_.GetFootprintLimit();
   // Try to free up at least as much space as we need right now but ideally
   // up to 20% of the total capacity.
   int64_t space_to_free = std::max(required_space, allocator_.GetFootprintLimit() / 5);
@@ -132,30 +147,86 @@ int64_t EvictionPolicy::RequireSpace(int64_t size,
 }
 
 void EvictionPolicy::BeginObjectAccess(const ObjectID &object_id) {
+  const auto *object = object_store_.GetObject(object_id);
   // If the object is in the LRU cache, remove it.
-  cache_.Remove(object_id);
-  pinned_memory_bytes_ += GetObjectSize(object_id);
+  GetCache(*object).Remove(object_id);
+  if (InFallbackTier(*object)) {
+    fallback_tier_num_uses_[object_id]++;
+  }
+  pinned_memory_bytes_ += object->GetObjectSize();
 }
 
 void EvictionPolicy::EndObjectAccess(const ObjectID &object_id) {
-  auto size = GetObjectSize(object_id);
+  const auto *object = object_store_.GetObject(object_id);
+  auto size = object->GetObjectSize();
   // Add the object to the LRU cache.
-  cache_.Add(object_id, size);
+  GetCache(*object).Add(object_id, size);
+  if (!InFallbackTier(*object)) {
+    fallback_tier_num_uses_.erase(object_id);
+  }
   pinned_memory_bytes_ -= size;
 }
 
 void EvictionPolicy::RemoveObject(const ObjectID &object_id) {
   // If the object is in the LRU cache, remove it.
   cache_.Remove(object_id);
+  fallback_tier_cache_.Remove(object_id);
+  fallback_tier_num_uses_.erase(object_id);
+}
+
+int64_t EvictionPolicy::RequireFallbackTierSpace(
+    int64_t size, std::vector<ObjectID> &objects_to_evict) {
+  const int64_t capacity = fallback_tier_cache_.OriginalCapacity();
+  int64_t required_space = allocator_.FallbackAllocated() + size - capacity;
+  if (required_space <= 0 || size > capacity) {
+    return required_space;
+  }
+  int64_t num_bytes_evicted =
+      fallback_tier_cache_.ChooseObjectsToEvict(required_space, objects_to_evict);
+  for (auto &object_id : objects_to_evict) {
+    fallback_tier_cache_.Remove(object_id);
+  }
+  return required_space - num_bytes_evicted;
+}
+
+void EvictionPolicy::ObjectDemoted(const ObjectID &object_id) {
+  cache_.Remove(object_id);
+  fallback_tier_cache_.Add(object_id, GetObjectSize(object_id));
+  fallback_tier_num_uses_.erase(object_id);
+}
+
+void EvictionPolicy::ObjectPromoted(const ObjectID &object_id) {
+  fallback_tier_cache_.Remove(object_id);
+  cache_.Add(object_id, GetObjectSize(object_id));
+  fallback_tier_num_uses_.erase(object_id);
+}
+
+bool EvictionPolicy::ShouldPromote(const ObjectID &object_id) const {
+  auto it = fallback_tier_num_uses_.find(object_id);
+  return it != fallback_tier_num_uses_.end() && it->second >= kNumUsesToPromote;
 }
 
 int64_t EvictionPolicy::GetObjectSize(const ObjectID &object_id) const {
   return object_store_.GetObject(object_id)->GetObjectSize();
 }
 
+bool EvictionPolicy::InFallbackTier(const LocalObject &object) const {
+  return fallback_tier_cache_.OriginalCapacity() > 0 &&
+         object.GetAllocation().fallback_allocated;
+}
+
+LRUCache &EvictionPolicy::GetCache(const LocalObject &object) {
+  return InFallbackTier(object) ? fallback_tier_cache_ : cache_;
+}
+
 bool EvictionPolicy::IsObjectExists(const ObjectID &object_id) const {
-  return cache_.Exists(object_id);
+  return cache_.Exists(object_id) || fallback_tier_cache_.Exists(object_id);
 }
 
-std::string EvictionPolicy::DebugString() const { return cache_.DebugString(); }
+std::string EvictionPolicy::DebugString() const {
+  if (fallback_tier_cache_.OriginalCapacity() > 0) {
+    return cache_.DebugString() + fallback_tier_cache_.DebugString();
+  }
+  return cache_.DebugString();
+}
 }  // namespace plasma
@@ -98,6 +98,37 @@ class IEvictionPolicy {
   /// \param object_id The ID of the object that is now being used.
   virtual void RemoveObject(const ObjectID &object_id) = 0;
 
+  /// This method will be called when the Plasma store needs space in the fallback
+  /// tier, to demote an unused object there instead of evicting it. When this method
+  /// is called, the eviction policy will assume that the objects chosen to be evicted
+  /// will in fact be evicted from the Plasma store by the caller.
+  ///
+  /// \param size The size in bytes of the object to demote.
+  /// \param objects_to_evict The object IDs that were chosen for eviction will
+  ///        be stored into this vector.
+  /// \return The number of bytes of space that is still needed in the fallback tier,
+  /// if any. If negative, then the required space has been made.
+  virtual int64_t RequireFallbackTierSpace(int64_t size,
+                                           std::vector<ObjectID> &objects_to_evict) = 0;
+
+  /// This method will be called when an object that was chosen to be evicted was
+  /// moved to the fallback tier instead.
+  ///
+  /// \param object_id The ID of the object that was demoted.
+  virtual void ObjectDemoted(const ObjectID &object_id) = 0;
+
+  /// This method will be called when an object of the fallback tier was moved back
+  /// to the primary memory.
+  ///
+  /// \param object_id The ID of the object that was promoted.
+  virtual void ObjectPromoted(const ObjectID &object_id) = 0;
+
+  /// Whether an object of the fallback tier was used often enough since it got
+  /// there to be moved back to the primary memory.
+  ///
+  /// \param object_id The ID of the object that is no longer being used.
+  virtual bool ShouldPromote(const ObjectID &object_id) const = 0;
+
   /// Returns debugging information for this eviction policy.
   virtual std::string DebugString() const = 0;
 };
@@ -159,7 +190,11 @@ class LRUCache {
 /// The eviction policy implementation
 class EvictionPolicy : public IEvictionPolicy {
  public:
-  EvictionPolicy(const IObjectStore &object_store, const IAllocator &allocator);
+  /// \param fallback_tier_capacity The bytes of the fallback tier, where unused
+  /// objects are demoted to instead of being evicted. 0 disables the tier.
+  EvictionPolicy(const IObjectStore &object_store,
+                 const IAllocator &allocator,
+                 int64_t fallback_tier_capacity = 0);
 
   void ObjectCreated(const ObjectID &object_id) override;
 
@@ -174,12 +209,27 @@ class EvictionPolicy : public IEvictionPolicy {
 
   void RemoveObject(const ObjectID &object_id) override;
 
+  int64_t RequireFallbackTierSpace(int64_t size,
+                                   std::vector<ObjectID> &objects_to_evict) override;
+
+  void ObjectDemoted(const ObjectID &object_id) override;
+
+  void ObjectPromoted(const ObjectID &object_id) override;
+
+  bool ShouldPromote(const ObjectID &object_id) const override;
+
   std::string DebugString() const override;
 
  private:
   /// Returns the size of the object
   int64_t GetObjectSize(const ObjectID &object_id) const;
 
+  /// Returns whether the object is in the fallback tier.
+  bool InFallbackTier(const LocalObject &object) const;
+
+  /// Returns the LRU cache of the tier of the object.
+  LRUCache &GetCache(const LocalObject &object);
+
   /// Returns whether the object exist in cache or not
   bool IsObjectExists(const ObjectID &object_id) const;
 
@@ -189,6 +239,13 @@ class EvictionPolicy : public IEvictionPolicy {
   /// Datastructure for the LRU cache.
   LRUCache cache_;
 
+  /// The LRU cache of the unused objects in the fallback tier.
+  LRUCache fallback_tier_cache_;
+
+  /// The number of times each object in the fallback tier was used since it got
+  /// there.
+  absl::flat_hash_map<ObjectID, int64_t> fallback_tier_num_uses_;
+
   const IObjectStore &object_store_;
 
   const IAllocator &allocator_;
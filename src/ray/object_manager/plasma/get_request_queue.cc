@@ -90,6 +90,7 @@ void GetRequestQueue::AddRequest(const std::shared_ptr<ClientInterface> &client,
                            [this, get_request](const boost::system::error_code &ec) {
                              if (ec != boost::asio::error::operation_aborted) {
                                // Timer was not cancelled, take necessary action.
+                               absl::MutexLockMaybe lock(mutex_);
                                OnGetRequestCompleted(get_request);
                              }
                            });
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/id.h"
 #include "ray/object_manager/plasma/connection.h"
@@ -70,14 +71,18 @@ struct GetRequest {
 
 class GetRequestQueue {
  public:
+  /// \param mutex If not null, the mutex that guards the queue when it is used from
+  /// several threads. It is taken when a get request times out.
   GetRequestQueue(instrumented_io_context &io_context,
                   IObjectLifecycleManager &object_lifecycle_mgr,
                   ObjectReadyCallback object_callback,
-                  AllObjectReadyCallback all_objects_callback)
+                  AllObjectReadyCallback all_objects_callback,
+                  absl::Mutex *mutex = nullptr)
       : io_context_(io_context),
         object_lifecycle_mgr_(object_lifecycle_mgr),
         object_satisfied_callback_(object_callback),
-        all_objects_satisfied_callback_(all_objects_callback) {}
+        all_objects_satisfied_callback_(all_objects_callback),
+        mutex_(mutex) {}
 
   /// Add a get request to get request queue. Note this will call callback functions
   /// directly if all objects has been satisfied, otherwise store the request
@@ -131,6 +136,8 @@ class GetRequestQueue {
   ObjectReadyCallback object_satisfied_callback_;
   AllObjectReadyCallback all_objects_satisfied_callback_;
 
+  absl::Mutex *mutex_;
+
   friend struct GetRequestQueueTest;
 };
 
@@ -0,0 +1,267 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/object_index.h"
+
+#include <array>
+#include <cstring>
+#include <new>
+
+#include "ray/util/logging.h"
+
+namespace plasma {
+namespace {
+
+constexpr uint64_t kObjectIndexMagic = 0x504c41534d414958;  // "PLASMAIX"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<int64_t>::is_always_lock_free &&
+                  std::atomic<int32_t>::is_always_lock_free,
+              "The object index is shared between processes, its atomics can't use "
+              "locks.");
+
+using ObjectIdWords = std::array<uint64_t, 4>;
+static_assert(sizeof(ObjectIdWords) >= kUniqueIDSize, "Object ids don't fit a slot.");
+
+ObjectIdWords ToWords(const ObjectID &object_id) {
+  ObjectIdWords words{};
+  std::memcpy(words.data(), object_id.Data(), ObjectID::Size());
+  return words;
+}
+
+int64_t AlignUp(int64_t size) {
+  constexpr int64_t kAlignment = 64;
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+int64_t ObjectIndex::RegionSize(int64_t num_slots,
+                                int64_t num_pin_tables,
+                                int64_t pins_per_table) {
+  return AlignUp(sizeof(Header)) + AlignUp(num_slots * sizeof(ObjectIndexSlot)) +
+         num_pin_tables * pins_per_table * sizeof(std::atomic<int64_t>);
+}
+
+void ObjectIndex::Initialize(uint8_t *region,
+                             int64_t num_slots,
+                             int64_t num_pin_tables,
+                             int64_t pins_per_table) {
+  RAY_CHECK(num_slots > 0 && num_pin_tables > 0 && pins_per_table > 0);
+  // The atomics are lock free, so zeroed memory holds zero values.
+  std::memset(region, 0, RegionSize(num_slots, num_pin_tables, pins_per_table));
+  new (region) Header{kObjectIndexMagic, num_slots, num_pin_tables, pins_per_table};
+}
+
+ObjectIndex::ObjectIndex(uint8_t *region)
+    : header_(reinterpret_cast<Header *>(region)),
+      slots_(reinterpret_cast<ObjectIndexSlot *>(region + AlignUp(sizeof(Header)))),
+      pin_tables_(reinterpret_cast<std::atomic<int64_t> *>(
+          region + AlignUp(sizeof(Header)) +
+          AlignUp(header_->num_slots * sizeof(ObjectIndexSlot)))),
+      pin_tables_in_use_(header_->num_pin_tables, false) {
+  RAY_CHECK(header_->magic == kObjectIndexMagic) << "Invalid plasma object index.";
+}
+
+std::atomic<int64_t> *ObjectIndex::PinTable(int64_t pin_table) const {
+  RAY_CHECK(pin_table >= 0 && pin_table < header_->num_pin_tables);
+  return pin_tables_ + pin_table * header_->pins_per_table;
+}
+
+bool ObjectIndex::Publish(const ObjectID &object_id, const PlasmaObject &object) {
+  if (published_slots_.contains(object_id)) {
+    return true;
+  }
+  const ObjectIdWords words = ToWords(object_id);
+  const int64_t num_slots = header_->num_slots;
+  int64_t slot = static_cast<int64_t>(object_id.Hash() % num_slots);
+  for (int64_t probe = 0; probe < kMaxProbes && probe < num_slots;
+       probe++, slot = (slot + 1) % num_slots) {
+    ObjectIndexSlot &entry = slots_[slot];
+    const int32_t state = entry.state.load(std::memory_order_relaxed);
+    if (state != kEmpty && state != kRemoved) {
+      continue;
+    }
+    // Seqlock write: readers that overlap it see an odd or a changed version.
+    const uint64_t version = entry.version.load(std::memory_order_relaxed);
+    entry.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < words.size(); i++) {
+      entry.object_id[i].store(words[i], std::memory_order_relaxed);
+    }
+    entry.store_fd.store(FD2INT(object.store_fd.first), std::memory_order_relaxed);
+    entry.unique_fd_id.store(object.store_fd.second, std::memory_order_relaxed);
+    entry.data_offset.store(object.data_offset, std::memory_order_relaxed);
+    entry.data_size.store(object.data_size, std::memory_order_relaxed);
+    entry.metadata_size.store(object.metadata_size, std::memory_order_relaxed);
+    entry.mmap_size.store(object.mmap_size, std::memory_order_relaxed);
+    entry.state.store(kPublished, std::memory_order_relaxed);
+    entry.version.store(version + 2, std::memory_order_release);
+    published_slots_[object_id] = slot;
+    return true;
+  }
+  return false;
+}
+
+bool ObjectIndex::TryUnpublish(const ObjectID &object_id) {
+  auto it = published_slots_.find(object_id);
+  if (it == published_slots_.end()) {
+    return true;
+  }
+  const int64_t slot = it->second;
+  ObjectIndexSlot &entry = slots_[slot];
+  entry.state.store(kClosing, std::memory_order_seq_cst);
+  if (entry.num_pins.load(std::memory_order_seq_cst) != 0 && IsSlotPinned(slot)) {
+    entry.state.store(kPublished, std::memory_order_seq_cst);
+    return false;
+  }
+  const uint64_t version = entry.version.load(std::memory_order_relaxed);
+  entry.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.state.store(kRemoved, std::memory_order_relaxed);
+  entry.version.store(version + 2, std::memory_order_release);
+  published_slots_.erase(it);
+  return true;
+}
+
+bool ObjectIndex::IsPinned(const ObjectID &object_id) const {
+  auto it = published_slots_.find(object_id);
+  return it != published_slots_.end() && IsSlotPinned(it->second);
+}
+
+bool ObjectIndex::IsSlotPinned(int64_t slot) const {
+  for (int64_t pin_table = 0; pin_table < header_->num_pin_tables; pin_table++) {
+    if (!pin_tables_in_use_[pin_table]) {
+      continue;
+    }
+    const std::atomic<int64_t> *pins = PinTable(pin_table);
+    for (int64_t pin = 0; pin < header_->pins_per_table; pin++) {
+      if (pins[pin].load(std::memory_order_seq_cst) == slot + 1) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+int64_t ObjectIndex::AcquirePinTable() {
+  for (int64_t pin_table = 0; pin_table < header_->num_pin_tables; pin_table++) {
+    if (!pin_tables_in_use_[pin_table]) {
+      pin_tables_in_use_[pin_table] = true;
+      return pin_table;
+    }
+  }
+  return -1;
+}
+
+void ObjectIndex::ReleasePinTable(int64_t pin_table) {
+  RAY_CHECK(pin_tables_in_use_[pin_table]);
+  std::atomic<int64_t> *pins = PinTable(pin_table);
+  for (int64_t pin = 0; pin < header_->pins_per_table; pin++) {
+    const int64_t slot_plus_one = pins[pin].load(std::memory_order_seq_cst);
+    if (slot_plus_one != 0) {
+      // Clients count a pin before recording it, so every recorded pin was counted
+      // and the count can't go negative.
+      slots_[slot_plus_one - 1].num_pins.fetch_sub(1, std::memory_order_seq_cst);
+      pins[pin].store(0, std::memory_order_seq_cst);
+    }
+  }
+  pin_tables_in_use_[pin_table] = false;
+}
+
+int64_t ObjectIndex::Pin(int64_t pin_table,
+                         const ObjectID &object_id,
+                         PlasmaObject *object) {
+  const ObjectIdWords words = ToWords(object_id);
+  const int64_t num_slots = header_->num_slots;
+  int64_t slot = static_cast<int64_t>(object_id.Hash() % num_slots);
+  for (int64_t probe = 0; probe < kMaxProbes && probe < num_slots;
+       probe++, slot = (slot + 1) % num_slots) {
+    ObjectIndexSlot &entry = slots_[slot];
+    // Seqlock read: the slot is only valid if its version didn't change while reading.
+    const uint64_t version = entry.version.load(std::memory_order_acquire);
+    if (version % 2 == 1) {
+      // The store is writing the slot, get the object through the store.
+      return -1;
+    }
+    const int32_t state = entry.state.load(std::memory_order_relaxed);
+    bool matches = state == kPublished;
+    for (size_t i = 0; i < words.size() && matches; i++) {
+      matches = entry.object_id[i].load(std::memory_order_relaxed) == words[i];
+    }
+    PlasmaObject candidate = {};
+    if (matches) {
+      candidate.store_fd = {INT2FD(entry.store_fd.load(std::memory_order_relaxed)),
+                            entry.unique_fd_id.load(std::memory_order_relaxed)};
+      candidate.data_offset = entry.data_offset.load(std::memory_order_relaxed);
+      candidate.data_size = entry.data_size.load(std::memory_order_relaxed);
+      candidate.metadata_offset = candidate.data_offset + candidate.data_size;
+      candidate.metadata_size = entry.metadata_size.load(std::memory_order_relaxed);
+      candidate.mmap_size = entry.mmap_size.load(std::memory_order_relaxed);
+      candidate.device_num = 0;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.version.load(std::memory_order_relaxed) != version) {
+      return -1;
+    }
+    if (state == kEmpty) {
+      return -1;
+    }
+    if (!matches) {
+      continue;
+    }
+
+    // Record the pin in a free entry of the pin table.
+    std::atomic<int64_t> *pins = PinTable(pin_table);
+    const int64_t pins_per_table = header_->pins_per_table;
+    int64_t pin = -1;
+    for (int64_t i = 0; i < pins_per_table; i++) {
+      const int64_t candidate_pin = (next_pin_ + i) % pins_per_table;
+      if (pins[candidate_pin].load(std::memory_order_relaxed) == 0) {
+        pin = candidate_pin;
+        break;
+      }
+    }
+    if (pin == -1) {
+      return -1;
+    }
+    next_pin_ = (pin + 1) % pins_per_table;
+    // Count the pin before recording it. If the client crashes in between, the count
+    // stays too high and the store only scans the pin tables for the slot needlessly.
+    // The other order could leave the count too low, and the store would then skip
+    // the scan and unpublish an object that is still pinned.
+    entry.num_pins.fetch_add(1, std::memory_order_seq_cst);
+    pins[pin].store(slot + 1, std::memory_order_seq_cst);
+    // Back off if the store started unpublishing the slot, or reused it.
+    if (entry.state.load(std::memory_order_seq_cst) != kPublished ||
+        entry.version.load(std::memory_order_seq_cst) != version) {
+      Unpin(pin_table, pin);
+      return -1;
+    }
+    *object = candidate;
+    return pin;
+  }
+  return -1;
+}
+
+void ObjectIndex::Unpin(int64_t pin_table, int64_t pin) {
+  std::atomic<int64_t> *pins = PinTable(pin_table);
+  const int64_t slot_plus_one = pins[pin].load(std::memory_order_relaxed);
+  RAY_CHECK(slot_plus_one > 0);
+  // Clearing the pin releases the accesses to the object to the store.
+  pins[pin].store(0, std::memory_order_seq_cst);
+  slots_[slot_plus_one - 1].num_pins.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+}  // namespace plasma
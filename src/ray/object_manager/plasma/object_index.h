@@ -0,0 +1,167 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/id.h"
+#include "ray/object_manager/plasma/plasma.h"
+
+namespace plasma {
+
+/// A slot of the object index table. All the fields are atomics because clients read
+/// them while the store writes them, see `ObjectIndex`.
+struct ObjectIndexSlot {
+  /// Seqlock version of the slot: odd while the store writes it.
+  std::atomic<uint64_t> version;
+  /// One of `ObjectIndex::SlotState`.
+  std::atomic<int32_t> state;
+  /// Number of pins of the slot. Only a hint for the store, see `ObjectIndex`.
+  std::atomic<int32_t> num_pins;
+  std::atomic<uint64_t> object_id[4];
+  std::atomic<int64_t> store_fd;
+  std::atomic<int64_t> unique_fd_id;
+  std::atomic<int64_t> data_offset;
+  std::atomic<int64_t> data_size;
+  std::atomic<int64_t> metadata_size;
+  std::atomic<int64_t> mmap_size;
+};
+
+/// An index of sealed objects in shared memory, published by the plasma store so that
+/// its clients get and release the objects without sending messages to the store.
+///
+/// The index lives in a region allocated from the plasma store memory. The region
+/// holds a header, an open addressing hash table of object slots, and one pin table
+/// per client:
+///   - The store writes the slots under a seqlock, and clients read them without
+///   locks.
+///   - A client pins an object by writing its slot in a free entry of its pin table,
+///   then checking that the store didn't start unpublishing the slot in the meantime.
+///   The store unpublishes a slot by marking it closing, then checking that no pin
+///   table has the slot. These accesses are sequentially consistent, so either the
+///   client sees the slot closing and backs off, or the store sees the pin and keeps
+///   the slot.
+///   - The pins of a client are the entries of its own pin table, so the store drops
+///   the pins of a client that disconnected or crashed by clearing its table.
+/// Each slot also counts its pins, so that the store only scans the pin tables for
+/// the slots that may be pinned. A client counts a pin before recording it and
+/// uncounts it after clearing it, so a client that crashes midway can only leave the
+/// count too high, which only costs a scan.
+///
+/// The store calls the methods that publish and unpublish the objects and manage the
+/// pin tables, under its lock. A client pins and unpins through its own pin table,
+/// from one thread at a time.
+class ObjectIndex {
+ public:
+  enum SlotState : int32_t {
+    kEmpty = 0,
+    kPublished = 1,
+    /// The store is unpublishing the slot.
+    kClosing = 2,
+    /// The slot was unpublished. Lookups probe past it, and it can be reused.
+    kRemoved = 3,
+  };
+
+  /// Number of bytes of an index region.
+  static int64_t RegionSize(int64_t num_slots,
+                            int64_t num_pin_tables,
+                            int64_t pins_per_table);
+
+  /// Initialize an empty index in `region`, which has `RegionSize` bytes.
+  static void Initialize(uint8_t *region,
+                         int64_t num_slots,
+                         int64_t num_pin_tables,
+                         int64_t pins_per_table);
+
+  /// Access the index initialized in `region`.
+  explicit ObjectIndex(uint8_t *region);
+
+  ObjectIndex(const ObjectIndex &) = delete;
+  ObjectIndex &operator=(const ObjectIndex &) = delete;
+
+  // Store side.
+
+  /// Publish a sealed object. No-op if the object is already published.
+  ///
+  /// \return Whether the object is published. False if its probe sequence is full, in
+  /// which case clients get the object through the store.
+  bool Publish(const ObjectID &object_id, const PlasmaObject &object);
+
+  /// Unpublish an object, unless a client pinned it.
+  ///
+  /// \return False if a client pinned the object, which is then still published.
+  /// True otherwise, including if the object wasn't published.
+  bool TryUnpublish(const ObjectID &object_id);
+
+  /// Whether a client pinned an object.
+  bool IsPinned(const ObjectID &object_id) const;
+
+  /// Give a pin table to a new client.
+  ///
+  /// \return The pin table, -1 if all the pin tables are in use.
+  int64_t AcquirePinTable();
+
+  /// Drop the pins of a client and make its pin table available.
+  void ReleasePinTable(int64_t pin_table);
+
+  /// Number of published objects.
+  size_t NumPublished() const { return published_slots_.size(); }
+
+  // Client side.
+
+  /// Pin a published object in `pin_table`, and read how to access it.
+  ///
+  /// \return The pin to pass to `Unpin`, -1 if the object isn't published or can't be
+  /// pinned right now.
+  int64_t Pin(int64_t pin_table, const ObjectID &object_id, PlasmaObject *object);
+
+  /// Unpin an object pinned by `Pin`.
+  void Unpin(int64_t pin_table, int64_t pin);
+
+ private:
+  struct Header {
+    uint64_t magic;
+    int64_t num_slots;
+    int64_t num_pin_tables;
+    int64_t pins_per_table;
+  };
+
+  /// The number of slots probed for an object before giving up.
+  static constexpr int64_t kMaxProbes = 32;
+
+  /// Pointer to the entries of a pin table. Each entry is a pinned slot plus one, or 0
+  /// if free.
+  std::atomic<int64_t> *PinTable(int64_t pin_table) const;
+
+  /// Whether a pin table in use has `slot`.
+  bool IsSlotPinned(int64_t slot) const;
+
+  Header *header_;
+  ObjectIndexSlot *slots_;
+  std::atomic<int64_t> *pin_tables_;
+
+  /// Store side: the slots of the published objects.
+  absl::flat_hash_map<ObjectID, int64_t> published_slots_;
+  /// Store side: whether each pin table is given to a client.
+  std::vector<bool> pin_tables_in_use_;
+
+  /// Client side: where to start looking for a free entry of the pin table.
+  int64_t next_pin_ = 0;
+};
+
+}  // namespace plasma
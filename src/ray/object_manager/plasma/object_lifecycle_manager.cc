@@ -17,8 +17,11 @@
 
 #include "ray/object_manager/plasma/object_lifecycle_manager.h"
 
+#include <algorithm>
+
 #include "absl/time/clock.h"
 #include "ray/common/ray_config.h"
+#include "ray/stats/metric_defs.h"
 
 namespace plasma {
 using namespace flatbuf;
@@ -26,10 +29,14 @@ using namespace flatbuf;
 ObjectLifecycleManager::ObjectLifecycleManager(
     IAllocator &allocator, ray::DeleteObjectCallback delete_object_callback)
     : object_store_(std::make_unique<ObjectStore>(allocator)),
-      eviction_policy_(std::make_unique<EvictionPolicy>(*object_store_, allocator)),
+      eviction_policy_(std::make_unique<EvictionPolicy>(
+          *object_store_,
+          allocator,
+          RayConfig::instance().plasma_fallback_tier_bytes())),
       delete_object_callback_(delete_object_callback),
       earger_deletion_objects_(),
-      stats_collector_(std::make_unique<ObjectStatsCollector>()) {}
+      stats_collector_(std::make_unique<ObjectStatsCollector>()),
+      fallback_tier_enabled_(RayConfig::instance().plasma_fallback_tier_bytes() > 0) {}
 
 std::pair<const LocalObject *, flatbuf::PlasmaError> ObjectLifecycleManager::CreateObject(
     const ray::ObjectInfo &object_info,
@@ -129,6 +136,9 @@ bool ObjectLifecycleManager::AddReference(const ObjectID &object_id) {
   if (entry->ref_count == 0) {
     // Tell the eviction policy that this object is being used.
     eviction_policy_->BeginObjectAccess(object_id);
+    if (fallback_tier_enabled_ && entry->GetAllocation().fallback_allocated) {
+      object_store_->PrefetchObject(object_id);
+    }
   }
   // Increase reference count.
   entry->ref_count++;
@@ -157,7 +167,17 @@ bool ObjectLifecycleManager::RemoveReference(const ObjectID &object_id) {
   RAY_LOG(DEBUG) << "Releasing object no longer in use " << object_id
                  << ", num bytes in use is now " << GetNumBytesInUse();
 
+  // The copy to the primary memory happens later, in PromoteObjects.
+  if (fallback_tier_enabled_ && entry->Sealed() &&
+      entry->GetAllocation().fallback_allocated &&
+      earger_deletion_objects_.count(object_id) == 0 &&
+      entry->GetObjectSize() <=
+          RayConfig::instance().plasma_fallback_tier_max_move_bytes() &&
+      eviction_policy_->ShouldPromote(object_id)) {
+    objects_to_promote_.insert(object_id);
+  }
   eviction_policy_->EndObjectAccess(object_id);
+  compaction_may_move_objects_ = true;
 
   // TODO(scv119): handle this anomaly in upper layer.
   RAY_CHECK(entry->Sealed()) << object_id << " is not sealed while ref count becomes 0.";
@@ -217,6 +237,12 @@ const LocalObject *ObjectLifecycleManager::CreateObjectInternal(
 }
 
 void ObjectLifecycleManager::EvictObjects(const std::vector<ObjectID> &object_ids) {
+  EvictObjects(object_ids, RayConfig::instance().plasma_fallback_tier_max_move_bytes());
+}
+
+int64_t ObjectLifecycleManager::EvictObjects(const std::vector<ObjectID> &object_ids,
+                                             int64_t max_demote_bytes) {
+  int64_t num_bytes_demoted = 0;
   for (const auto &object_id : object_ids) {
     RAY_LOG(DEBUG) << "evicting object " << object_id.Hex();
     auto entry = object_store_->GetObject(object_id);
@@ -229,8 +255,103 @@ void ObjectLifecycleManager::EvictObjects(const std::vector<ObjectID> &object_id
     RAY_CHECK(entry->ref_count == 0)
         << "To evict an object, there must be no clients currently using it.";
 
+    // The copy happens under the store lock, so the objects past the budget are
+    // deleted instead.
+    const int64_t object_size = entry->GetObjectSize();
+    if (fallback_tier_enabled_ && num_bytes_demoted + object_size <= max_demote_bytes &&
+        DemoteObject(object_id)) {
+      num_bytes_demoted += object_size;
+      continue;
+    }
     DeleteObjectInternal(object_id);
   }
+  return num_bytes_demoted;
+}
+
+bool ObjectLifecycleManager::DemoteObject(const ObjectID &object_id) {
+  auto entry = object_store_->GetObject(object_id);
+  if (entry->GetAllocation().fallback_allocated) {
+    return false;
+  }
+  std::vector<ObjectID> objects_to_evict;
+  int64_t space_needed = eviction_policy_->RequireFallbackTierSpace(
+      entry->GetObjectSize(), objects_to_evict);
+  for (const auto &object_id_to_evict : objects_to_evict) {
+    DeleteObjectInternal(object_id_to_evict);
+  }
+  if (space_needed > 0) {
+    return false;
+  }
+
+  int64_t start = absl::GetCurrentTimeNanos();
+  if (!object_store_->DemoteObject(object_id)) {
+    return false;
+  }
+  ray::stats::STATS_object_store_fallback_tier_move_time_ms.Record(
+      (absl::GetCurrentTimeNanos() - start) / 1e6, "Demote");
+  eviction_policy_->ObjectDemoted(object_id);
+  stats_collector_->OnObjectTierChanged(*entry);
+  RAY_LOG(DEBUG) << "demoted object " << object_id << " to the fallback tier";
+  return true;
+}
+
+int64_t ObjectLifecycleManager::PromoteObject(const ObjectID &object_id,
+                                              int64_t max_demote_bytes) {
+  auto entry = object_store_->GetObject(object_id);
+  // Take the object out of the LRU cache of the fallback tier, so that it isn't
+  // evicted to make space for the objects demoted for it.
+  eviction_policy_->RemoveObject(object_id);
+  int64_t start = absl::GetCurrentTimeNanos();
+  int64_t num_bytes_demoted = 0;
+  if (!object_store_->PromoteObject(object_id)) {
+    std::vector<ObjectID> objects_to_evict;
+    eviction_policy_->ChooseObjectsToEvict(entry->GetObjectSize(), objects_to_evict);
+    num_bytes_demoted = EvictObjects(objects_to_evict, max_demote_bytes);
+    if (!object_store_->PromoteObject(object_id)) {
+      eviction_policy_->ObjectDemoted(object_id);
+      return -1;
+    }
+  }
+  ray::stats::STATS_object_store_fallback_tier_move_time_ms.Record(
+      (absl::GetCurrentTimeNanos() - start) / 1e6, "Promote");
+  eviction_policy_->ObjectPromoted(object_id);
+  stats_collector_->OnObjectTierChanged(*entry);
+  RAY_LOG(DEBUG) << "promoted object " << object_id << " from the fallback tier";
+  return num_bytes_demoted;
+}
+
+int64_t ObjectLifecycleManager::PromoteObjects(int64_t max_bytes) {
+  if (objects_to_promote_.empty()) {
+    return 0;
+  }
+  // Promoting an object may delete others, so iterate over a copy.
+  std::vector<ObjectID> object_ids(objects_to_promote_.begin(),
+                                   objects_to_promote_.end());
+  int64_t num_bytes_moved = 0;
+  int64_t num_bytes_promoted = 0;
+  for (const auto &object_id : object_ids) {
+    if (!objects_to_promote_.contains(object_id)) {
+      continue;
+    }
+    auto entry = object_store_->GetObject(object_id);
+    const int64_t object_size = entry->GetObjectSize();
+    if (num_bytes_moved + object_size > max_bytes) {
+      continue;
+    }
+    objects_to_promote_.erase(object_id);
+    // A client may have mapped the object again since it was queued. It is queued
+    // again when released.
+    if (entry->ref_count > 0 || !entry->GetAllocation().fallback_allocated) {
+      continue;
+    }
+    const int64_t num_bytes_demoted =
+        PromoteObject(object_id, max_bytes - num_bytes_moved - object_size);
+    if (num_bytes_demoted >= 0) {
+      num_bytes_moved += object_size + num_bytes_demoted;
+      num_bytes_promoted += object_size;
+    }
+  }
+  return num_bytes_promoted;
 }
 
 void ObjectLifecycleManager::DeleteObjectInternal(const ObjectID &object_id) {
@@ -241,8 +362,10 @@ void ObjectLifecycleManager::DeleteObjectInternal(const ObjectID &object_id) {
 
   stats_collector_->OnObjectDeleting(*entry);
   earger_deletion_objects_.erase(object_id);
+  objects_to_promote_.erase(object_id);
   eviction_policy_->RemoveObject(object_id);
   object_store_->DeleteObject(object_id);
+  compaction_may_move_objects_ = true;
 
   if (!aborted) {
     // only send notification if it's not aborted.
@@ -271,6 +394,55 @@ int64_t ObjectLifecycleManager::GetNumObjectsUnsealed() const {
   return stats_collector_->GetNumObjectsUnsealed();
 }
 
+int64_t ObjectLifecycleManager::CompactObjects(int64_t max_bytes) {
+  if (!compaction_may_move_objects_) {
+    return 0;
+  }
+  // Objects that a client uses may be mapped by the client, so only the objects with
+  // no reference are moved.
+  std::vector<std::pair<const void *, ObjectID>> objects_to_move;
+  object_store_->ForEachObject([&objects_to_move](const ObjectID &object_id,
+                                                  const LocalObject &object) {
+    const auto &allocation = object.GetAllocation();
+    if (object.Sealed() && object.GetRefCount() == 0 && !allocation.fallback_allocated &&
+        allocation.device_num == 0) {
+      objects_to_move.emplace_back(allocation.address, object_id);
+    }
+  });
+  std::sort(objects_to_move.begin(),
+            objects_to_move.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+
+  int64_t num_bytes_moved = 0;
+  bool over_budget = false;
+  for (const auto &object : objects_to_move) {
+    const int64_t object_size = GetObject(object.second)->GetObjectSize();
+    if (object_size > max_bytes) {
+      // The object is larger than any compaction may copy, so it's never moved.
+      continue;
+    }
+    if (num_bytes_moved + object_size > max_bytes) {
+      over_budget = true;
+      continue;
+    }
+    if (object_store_->RelocateObject(object.second)) {
+      num_bytes_moved += object_size;
+    }
+  }
+  // Until objects are freed or released, the next compactions would move nothing.
+  if (num_bytes_moved == 0 && !over_budget) {
+    compaction_may_move_objects_ = false;
+  }
+  num_bytes_compacted_total_ += num_bytes_moved;
+  RAY_LOG(DEBUG) << "Compaction moved " << num_bytes_moved << " bytes of "
+                 << objects_to_move.size() << " movable objects.";
+  return num_bytes_moved;
+}
+
+int64_t ObjectLifecycleManager::GetNumBytesCompactedTotal() const {
+  return num_bytes_compacted_total_;
+}
+
 void ObjectLifecycleManager::RecordMetrics() const { stats_collector_->RecordMetrics(); }
 
 void ObjectLifecycleManager::GetDebugDump(std::stringstream &buffer) const {
@@ -287,6 +459,7 @@ ObjectLifecycleManager::ObjectLifecycleManager(
       eviction_policy_(std::move(eviction_policy)),
       delete_object_callback_(delete_object_callback),
       earger_deletion_objects_(),
-      stats_collector_(std::move(stats_collector)) {}
+      stats_collector_(std::move(stats_collector)),
+      fallback_tier_enabled_(RayConfig::instance().plasma_fallback_tier_bytes() > 0) {}
 
 }  // namespace plasma
@@ -139,6 +139,29 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
 
   int64_t GetNumObjectsUnsealed() const;
 
+  /// Move sealed objects that no client uses toward the start of the primary memory,
+  /// so that the free space between them coalesces and large objects don't need
+  /// fallback allocation. The objects at the highest addresses are moved first, and
+  /// the ones that don't fit in the rest of `max_bytes` are skipped.
+  ///
+  /// \param max_bytes The most bytes to copy. It must be the same in every call:
+  /// the objects larger than it are never moved, and don't keep the next compactions
+  /// looking for objects to move.
+  /// \return The number of bytes moved.
+  int64_t CompactObjects(int64_t max_bytes);
+
+  int64_t GetNumBytesCompactedTotal() const;
+
+  /// Move the objects of the fallback tier that were used often enough since they
+  /// were demoted back to the primary memory. Releasing such an object only queues
+  /// it, so that the copy happens here, within `max_bytes`, rather than on every
+  /// release.
+  ///
+  /// \param max_bytes The most bytes to copy, including the objects demoted to make
+  /// space.
+  /// \return The number of bytes promoted.
+  int64_t PromoteObjects(int64_t max_bytes);
+
   void RecordMetrics() const;
 
   void GetDebugDump(std::stringstream &buffer) const;
@@ -161,11 +184,33 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
                                           plasma::flatbuf::ObjectSource source,
                                           bool allow_fallback_allocation);
 
-  // Evict objects returned by the eviction policy.
+  // Evict objects returned by the eviction policy. The objects are demoted to the
+  // fallback tier instead if it is enabled and has space, as long as the bytes
+  // copied stay within `max_demote_bytes`.
   //
   // \param object_ids Object IDs of the objects to be evicted.
+  // \param max_demote_bytes The most bytes to copy to the fallback tier.
+  // \return The number of bytes demoted.
+  int64_t EvictObjects(const std::vector<ObjectID> &object_ids,
+                       int64_t max_demote_bytes);
+
+  // Evict objects returned by the eviction policy, demoting at most
+  // plasma_fallback_tier_max_move_bytes of them.
   void EvictObjects(const std::vector<ObjectID> &object_ids);
 
+  // Move an unused object to the fallback tier, evicting the least recently used
+  // objects of the tier to make space.
+  //
+  // \return Whether the object was moved.
+  bool DemoteObject(const ObjectID &object_id);
+
+  // Move an unused object of the fallback tier back to the primary memory, demoting
+  // the least recently used objects there to make space.
+  //
+  // \param max_demote_bytes The most bytes to demote to make space.
+  // \return The number of bytes demoted, or -1 if the object wasn't moved.
+  int64_t PromoteObject(const ObjectID &object_id, int64_t max_demote_bytes);
+
   void DeleteObjectInternal(const ObjectID &object_id);
   std::unique_ptr<IObjectStore> object_store_;
   std::unique_ptr<IEvictionPolicy> eviction_policy_;
@@ -176,5 +221,18 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
   absl::flat_hash_set<ObjectID> earger_deletion_objects_;
 
   std::unique_ptr<ObjectStatsCollector> stats_collector_;
+
+  // Whether unused objects are demoted to the fallback tier instead of being evicted.
+  const bool fallback_tier_enabled_;
+
+  // The objects of the fallback tier to move back to the primary memory.
+  absl::flat_hash_set<ObjectID> objects_to_promote_;
+
+  // Whether an object was freed or released since the last compaction that moved
+  // nothing, so that a compaction may move something.
+  bool compaction_may_move_objects_ = true;
+
+  // The number of bytes moved by compactions.
+  int64_t num_bytes_compacted_total_ = 0;
 };
 }  // namespace plasma
@@ -17,6 +17,15 @@
 
 #include "ray/object_manager/plasma/object_store.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
 namespace plasma {
 
 ObjectStore::ObjectStore(IAllocator &allocator)
@@ -79,6 +88,101 @@ bool ObjectStore::DeleteObject(const ObjectID &object_id) {
   return true;
 }
 
+bool ObjectStore::RelocateObject(const ObjectID &object_id) {
+  auto entry = GetMutableObject(object_id);
+  if (entry == nullptr) {
+    return false;
+  }
+  RAY_CHECK(!entry->allocation.fallback_allocated && entry->allocation.device_num == 0)
+      << "To relocate an object it must be in the primary memory.";
+  auto allocation = allocator_.Allocate(entry->GetObjectSize());
+  if (!allocation.has_value()) {
+    return false;
+  }
+  if (allocation->fd != entry->allocation.fd ||
+      allocation->address >= entry->allocation.address) {
+    allocator_.Free(std::move(allocation.value()));
+    return false;
+  }
+  MoveObject(entry, std::move(allocation.value()));
+  RAY_LOG(DEBUG) << "relocated object " << object_id << " to offset "
+                 << entry->allocation.offset;
+  return true;
+}
+
+bool ObjectStore::DemoteObject(const ObjectID &object_id) {
+  auto entry = GetMutableObject(object_id);
+  if (entry == nullptr) {
+    return false;
+  }
+  RAY_CHECK(!entry->allocation.fallback_allocated && entry->allocation.device_num == 0)
+      << "To demote an object it must be in the primary memory.";
+  auto allocation = allocator_.FallbackAllocate(entry->GetObjectSize());
+  if (!allocation.has_value()) {
+    return false;
+  }
+  if (!allocation->fallback_allocated) {
+    // The allocator found primary memory after all.
+    allocator_.Free(std::move(allocation.value()));
+    return false;
+  }
+  MoveObject(entry, std::move(allocation.value()));
+#ifdef __linux__
+  // Write the object back without waiting, so that its pages can be reclaimed.
+  if (sync_file_range(entry->allocation.fd.first,
+                      entry->allocation.offset,
+                      entry->GetObjectSize(),
+                      SYNC_FILE_RANGE_WRITE) != 0) {
+    RAY_LOG(DEBUG) << "Failed to start the writeback of object " << object_id << ": "
+                   << strerror(errno);
+  }
+#endif
+  RAY_LOG(DEBUG) << "demoted object " << object_id;
+  return true;
+}
+
+bool ObjectStore::PromoteObject(const ObjectID &object_id) {
+  auto entry = GetMutableObject(object_id);
+  if (entry == nullptr) {
+    return false;
+  }
+  RAY_CHECK(entry->allocation.fallback_allocated)
+      << "To promote an object it must be fallback allocated.";
+  auto allocation = allocator_.Allocate(entry->GetObjectSize());
+  if (!allocation.has_value()) {
+    return false;
+  }
+  MoveObject(entry, std::move(allocation.value()));
+  RAY_LOG(DEBUG) << "promoted object " << object_id;
+  return true;
+}
+
+void ObjectStore::PrefetchObject(const ObjectID &object_id) {
+#ifndef _WIN32
+  auto entry = GetObject(object_id);
+  if (entry == nullptr || !entry->allocation.fallback_allocated) {
+    return;
+  }
+  // madvise needs a page aligned address.
+  const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto address = reinterpret_cast<uintptr_t>(entry->allocation.address);
+  const uintptr_t start = address / page_size * page_size;
+  if (madvise(reinterpret_cast<void *>(start),
+              address + entry->GetObjectSize() - start,
+              MADV_WILLNEED) != 0) {
+    RAY_LOG(DEBUG) << "Failed to prefetch object " << object_id << ": "
+                   << strerror(errno);
+  }
+#endif
+}
+
+void ObjectStore::ForEachObject(
+    const std::function<void(const ObjectID &, const LocalObject &)> &fn) const {
+  for (const auto &entry : object_table_) {
+    fn(entry.first, *entry.second);
+  }
+}
+
 LocalObject *ObjectStore::GetMutableObject(const ObjectID &object_id) {
   auto it = object_table_.find(object_id);
   if (it == object_table_.end()) {
@@ -87,4 +191,11 @@ LocalObject *ObjectStore::GetMutableObject(const ObjectID &object_id) {
   return it->second.get();
 }
 
+void ObjectStore::MoveObject(LocalObject *entry, Allocation allocation) {
+  RAY_CHECK(entry->Sealed()) << "To move an object it must have been sealed.";
+  std::memcpy(allocation.address, entry->allocation.address, entry->GetObjectSize());
+  std::swap(entry->allocation, allocation);
+  allocator_.Free(std::move(allocation));
+}
+
 }  // namespace plasma
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "absl/container/flat_hash_map.h"
 #include "ray/object_manager/plasma/allocator.h"
 #include "ray/object_manager/plasma/common.h"
@@ -67,6 +69,46 @@ class IObjectStore {
   ///   - false if such object doesn't exist.
   ///   - true if deleted.
   virtual bool DeleteObject(const ObjectID &object_id) = 0;
+
+  /// Move a sealed object to a new primary allocation, if the allocator gives one at a
+  /// lower address of the same memory, and free the old one. Moving the objects toward
+  /// the start of the memory coalesces the free space after them.
+  /// NOTE: The caller must make sure that no client has the object mapped.
+  ///
+  /// \param object_id Object ID of the object to be moved.
+  /// \return
+  ///   - false if such object doesn't exist, or no lower allocation was found.
+  ///   - true if moved.
+  virtual bool RelocateObject(const ObjectID &object_id) = 0;
+
+  /// Move a sealed object from the primary memory to a fallback allocation, and start
+  /// writing it back to the disk in the background.
+  /// NOTE: The caller must make sure that no client has the object mapped.
+  ///
+  /// \param object_id Object ID of the object to be moved.
+  /// \return
+  ///   - false if such object doesn't exist, or the fallback allocation failed.
+  ///   - true if moved.
+  virtual bool DemoteObject(const ObjectID &object_id) = 0;
+
+  /// Move a sealed object from a fallback allocation back to the primary memory.
+  /// NOTE: The caller must make sure that no client has the object mapped.
+  ///
+  /// \param object_id Object ID of the object to be moved.
+  /// \return
+  ///   - false if such object doesn't exist, or there is no primary memory for it.
+  ///   - true if moved.
+  virtual bool PromoteObject(const ObjectID &object_id) = 0;
+
+  /// Start reading a fallback allocated object from the disk in the background, as it
+  /// is about to be used.
+  ///
+  /// \param object_id Object ID of the object to be read.
+  virtual void PrefetchObject(const ObjectID &object_id) = 0;
+
+  /// Call `fn` with each object in the store.
+  virtual void ForEachObject(
+      const std::function<void(const ObjectID &, const LocalObject &)> &fn) const = 0;
 };
 
 // ObjectStore implements IObjectStore. It uses IAllocator
@@ -85,11 +127,25 @@ class ObjectStore : public IObjectStore {
 
   bool DeleteObject(const ObjectID &object_id) override;
 
+  bool RelocateObject(const ObjectID &object_id) override;
+
+  bool DemoteObject(const ObjectID &object_id) override;
+
+  bool PromoteObject(const ObjectID &object_id) override;
+
+  void PrefetchObject(const ObjectID &object_id) override;
+
+  void ForEachObject(const std::function<void(const ObjectID &, const LocalObject &)>
+                         &fn) const override;
+
  private:
   friend struct ObjectStatsCollectorTest;
 
   LocalObject *GetMutableObject(const ObjectID &object_id);
 
+  /// Copy a sealed object to `allocation`, and free its old allocation.
+  void MoveObject(LocalObject *entry, Allocation allocation);
+
   /// Allocator that allocates memory.
   IAllocator &allocator_;
 
@@ -204,7 +204,9 @@ Status SendCreateRequest(const std::shared_ptr<StoreConn> &store_conn,
                          int64_t metadata_size,
                          flatbuf::ObjectSource source,
                          int device_num,
-                         bool try_immediately) {
+                         bool try_immediately,
+                         flatbuf::CreatePriority priority,
+                         int64_t deadline_ms) {
   flatbuffers::FlatBufferBuilder fbb;
   auto message =
       fb::CreatePlasmaCreateRequest(fbb,
@@ -217,7 +219,9 @@ Status SendCreateRequest(const std::shared_ptr<StoreConn> &store_conn,
                                     metadata_size,
                                     source,
                                     device_num,
-                                    try_immediately);
+                                    try_immediately,
+                                    priority,
+                                    deadline_ms);
   return PlasmaSend(store_conn, MessageType::PlasmaCreateRequest, &fbb, message);
 }
 
@@ -518,17 +522,39 @@ Status SendConnectRequest(const std::shared_ptr<StoreConn> &store_conn) {
 
 Status ReadConnectRequest(uint8_t *data) { return Status::OK(); }
 
-Status SendConnectReply(const std::shared_ptr<Client> &client, int64_t memory_capacity) {
+Status SendConnectReply(const std::shared_ptr<Client> &client,
+                        int64_t memory_capacity,
+                        int64_t object_index_pin_table,
+                        MEMFD_TYPE object_index_store_fd,
+                        int64_t object_index_offset,
+                        int64_t object_index_mmap_size) {
   flatbuffers::FlatBufferBuilder fbb;
-  auto message = fb::CreatePlasmaConnectReply(fbb, memory_capacity);
+  auto message = fb::CreatePlasmaConnectReply(fbb,
+                                              memory_capacity,
+                                              object_index_pin_table,
+                                              FD2INT(object_index_store_fd.first),
+                                              object_index_store_fd.second,
+                                              object_index_offset,
+                                              object_index_mmap_size);
   return PlasmaSend(client, MessageType::PlasmaConnectReply, &fbb, message);
 }
 
-Status ReadConnectReply(uint8_t *data, size_t size, int64_t *memory_capacity) {
+Status ReadConnectReply(uint8_t *data,
+                        size_t size,
+                        int64_t *memory_capacity,
+                        int64_t *object_index_pin_table,
+                        MEMFD_TYPE *object_index_store_fd,
+                        int64_t *object_index_offset,
+                        int64_t *object_index_mmap_size) {
   RAY_DCHECK(data);
   auto message = flatbuffers::GetRoot<fb::PlasmaConnectReply>(data);
   RAY_DCHECK(VerifyFlatbuffer(message, data, size));
   *memory_capacity = message->memory_capacity();
+  *object_index_pin_table = message->object_index_pin_table();
+  object_index_store_fd->first = INT2FD(message->object_index_store_fd());
+  object_index_store_fd->second = message->object_index_unique_fd_id();
+  *object_index_offset = message->object_index_offset();
+  *object_index_mmap_size = message->object_index_mmap_size();
   return Status::OK();
 }
 
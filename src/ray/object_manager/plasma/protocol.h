@@ -89,7 +89,9 @@ Status SendCreateRequest(const std::shared_ptr<StoreConn> &store_conn,
                          int64_t metadata_size,
                          flatbuf::ObjectSource source,
                          int device_num,
-                         bool try_immediately);
+                         bool try_immediately,
+                         flatbuf::CreatePriority priority = flatbuf::CreatePriority::Put,
+                         int64_t deadline_ms = -1);
 
 void ReadCreateRequest(uint8_t *data,
                        size_t size,
@@ -214,9 +216,23 @@ Status SendConnectRequest(const std::shared_ptr<StoreConn> &store_conn);
 
 Status ReadConnectRequest(uint8_t *data, size_t size);
 
-Status SendConnectReply(const std::shared_ptr<Client> &client, int64_t memory_capacity);
-
-Status ReadConnectReply(uint8_t *data, size_t size, int64_t *memory_capacity);
+/// \param object_index_pin_table The pin table of the client in the object index of
+/// the store, -1 if the client doesn't use the index. Then the other object_index_*
+/// parameters are ignored.
+Status SendConnectReply(const std::shared_ptr<Client> &client,
+                        int64_t memory_capacity,
+                        int64_t object_index_pin_table = -1,
+                        MEMFD_TYPE object_index_store_fd = {INVALID_FD, 0},
+                        int64_t object_index_offset = 0,
+                        int64_t object_index_mmap_size = 0);
+
+Status ReadConnectReply(uint8_t *data,
+                        size_t size,
+                        int64_t *memory_capacity,
+                        int64_t *object_index_pin_table,
+                        MEMFD_TYPE *object_index_store_fd,
+                        int64_t *object_index_offset,
+                        int64_t *object_index_mmap_size);
 
 /* Plasma Evict message functions (no reply so far). */
 
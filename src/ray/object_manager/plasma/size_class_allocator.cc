@@ -0,0 +1,270 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/size_class_allocator.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "ray/util/logging.h"
+
+namespace plasma {
+namespace {
+
+/// Memory of the backing allocator that isn't taken for the arena, for the bookkeeping
+/// of the backing allocator.
+constexpr int64_t kBackingAllocatorReserve = 1024 * 1024;
+
+/// The smallest size class. It is also the alignment of the small objects.
+constexpr int64_t kMinSizeClass = 64;
+
+int64_t RoundUp(int64_t size, int64_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+SizeClassAllocator::SizeClassAllocator(IAllocator &backing_allocator)
+    : backing_allocator_(backing_allocator) {
+  const int64_t footprint_limit = backing_allocator_.GetFootprintLimit();
+  RAY_CHECK(footprint_limit >= kBackingAllocatorReserve + kSlabSize)
+      << "Footprint limit has to be at least " << kBackingAllocatorReserve + kSlabSize;
+  arena_size_ = (footprint_limit - kBackingAllocatorReserve) / kPageSize * kPageSize;
+  arena_ = backing_allocator_.Allocate(arena_size_);
+  RAY_CHECK(arena_.has_value()) << "Failed to allocate the arena of the size class "
+                                   "allocator, of "
+                                << arena_size_ << " bytes.";
+  AddFreeExtent(0, arena_size_);
+
+  // Size classes are 64 bytes apart up to 512 bytes, then there are 4 classes per
+  // doubling, so that a slot wastes at most 20% of its size.
+  for (int64_t size = kMinSizeClass; size <= 512; size += kMinSizeClass) {
+    class_sizes_.push_back(size);
+  }
+  for (int64_t base = 512; base < kMaxSmallObjectSize; base *= 2) {
+    for (int64_t i = 1; i <= 4; i++) {
+      class_sizes_.push_back(base + i * base / 4);
+    }
+  }
+  RAY_CHECK(class_sizes_.back() == kMaxSmallObjectSize);
+  partial_slabs_.resize(class_sizes_.size());
+}
+
+SizeClassAllocator::~SizeClassAllocator() {
+  backing_allocator_.Free(std::move(*arena_));
+}
+
+absl::optional<Allocation> SizeClassAllocator::Allocate(size_t bytes) {
+  const int64_t size = static_cast<int64_t>(bytes);
+  const int64_t offset = size <= kMaxSmallObjectSize
+                             ? AllocateSmall(SizeClass(size))
+                             : AllocateExtent(RoundUp(size, kPageSize));
+  RAY_LOG(DEBUG) << "allocated " << bytes << " at offset " << offset;
+  if (offset == -1) {
+    return absl::nullopt;
+  }
+  allocated_ += size;
+  return BuildAllocation(offset, size);
+}
+
+absl::optional<Allocation> SizeClassAllocator::FallbackAllocate(size_t bytes) {
+  return backing_allocator_.FallbackAllocate(bytes);
+}
+
+void SizeClassAllocator::Free(Allocation allocation) {
+  RAY_CHECK(allocation.address != nullptr) << "Cannot free the nullptr";
+  const auto *address = static_cast<uint8_t *>(allocation.address);
+  const auto *arena_address = static_cast<uint8_t *>(arena_->address);
+  if (address < arena_address || address >= arena_address + arena_size_) {
+    backing_allocator_.Free(std::move(allocation));
+    return;
+  }
+  const int64_t offset = address - arena_address;
+  RAY_LOG(DEBUG) << "deallocating " << allocation.size << " at offset " << offset;
+  if (allocation.size <= kMaxSmallObjectSize) {
+    FreeSmall(offset);
+  } else {
+    FreeExtent(offset, RoundUp(allocation.size, kPageSize));
+  }
+  allocated_ -= allocation.size;
+}
+
+int64_t SizeClassAllocator::GetFootprintLimit() const {
+  return backing_allocator_.GetFootprintLimit();
+}
+
+int64_t SizeClassAllocator::Allocated() const {
+  // The backing allocator counts the arena as allocated.
+  return allocated_ + backing_allocator_.Allocated() - arena_->size;
+}
+
+int64_t SizeClassAllocator::FallbackAllocated() const {
+  return backing_allocator_.FallbackAllocated();
+}
+
+int64_t SizeClassAllocator::GetLargestFreeExtent() const {
+  return free_extents_by_size_.empty() ? 0 : free_extents_by_size_.rbegin()->first;
+}
+
+int SizeClassAllocator::SizeClass(int64_t bytes) const {
+  return static_cast<int>(
+      std::lower_bound(class_sizes_.begin(), class_sizes_.end(), bytes) -
+      class_sizes_.begin());
+}
+
+int64_t SizeClassAllocator::AllocateSmall(int size_class) {
+  auto &partial_slabs = partial_slabs_[size_class];
+  if (partial_slabs.empty()) {
+    const int64_t slab_offset = AllocateExtent(kSlabSize);
+    if (slab_offset == -1) {
+      return -1;
+    }
+    slabs_.emplace(slab_offset, Slab{size_class, kSlabSize / class_sizes_[size_class]});
+    partial_slabs.insert(slab_offset);
+  }
+  // Fill the slabs at the lowest offsets first, so that the others get empty and can
+  // be given back.
+  const int64_t slab_offset = *partial_slabs.begin();
+  Slab &slab = slabs_.at(slab_offset);
+  int64_t slot;
+  if (!slab.free_slots.empty()) {
+    slot = slab.free_slots.back();
+    slab.free_slots.pop_back();
+  } else {
+    slot = slab.next_unused++;
+  }
+  if (++slab.num_used == slab.num_slots) {
+    partial_slabs.erase(partial_slabs.begin());
+  }
+  return slab_offset + slot * class_sizes_[size_class];
+}
+
+void SizeClassAllocator::FreeSmall(int64_t offset) {
+  auto it = slabs_.upper_bound(offset);
+  RAY_CHECK(it != slabs_.begin()) << "No slab has offset " << offset;
+  it--;
+  const int64_t slab_offset = it->first;
+  Slab &slab = it->second;
+  const int64_t class_size = class_sizes_[slab.size_class];
+  RAY_CHECK(offset < slab_offset + kSlabSize && (offset - slab_offset) % class_size == 0)
+      << "No slot of a slab has offset " << offset;
+  auto &partial_slabs = partial_slabs_[slab.size_class];
+  if (slab.num_used == slab.num_slots) {
+    partial_slabs.insert(slab_offset);
+  }
+  if (--slab.num_used == 0) {
+    partial_slabs.erase(slab_offset);
+    slabs_.erase(it);
+    FreeExtent(slab_offset, kSlabSize);
+    return;
+  }
+  slab.free_slots.push_back((offset - slab_offset) / class_size);
+}
+
+int64_t SizeClassAllocator::AllocateExtent(int64_t size) {
+  // Best fit: the smallest free extent that fits, at the lowest offset.
+  auto it = free_extents_by_size_.lower_bound({size, 0});
+  if (it == free_extents_by_size_.end()) {
+    return -1;
+  }
+  const int64_t extent_size = it->first;
+  const int64_t offset = it->second;
+  RemoveFreeExtent(free_extents_.find(offset));
+  if (extent_size > size) {
+    AddFreeExtent(offset + size, extent_size - size);
+  }
+  return offset;
+}
+
+void SizeClassAllocator::FreeExtent(int64_t offset, int64_t size) {
+  auto next = free_extents_.lower_bound(offset);
+  if (next != free_extents_.begin()) {
+    auto prev = std::prev(next);
+    RAY_CHECK(prev->first + prev->second <= offset) << "Extent freed twice " << offset;
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      size += prev->second;
+      RemoveFreeExtent(prev);
+    }
+  }
+  if (next != free_extents_.end()) {
+    RAY_CHECK(offset + size <= next->first) << "Extent freed twice " << offset;
+    if (offset + size == next->first) {
+      size += next->second;
+      RemoveFreeExtent(next);
+    }
+  }
+  AddFreeExtent(offset, size);
+}
+
+void SizeClassAllocator::AddFreeExtent(int64_t offset, int64_t size) {
+  free_extents_.emplace(offset, size);
+  free_extents_by_size_.emplace(size, offset);
+}
+
+void SizeClassAllocator::RemoveFreeExtent(std::map<int64_t, int64_t>::iterator it) {
+  free_extents_by_size_.erase({it->second, it->first});
+  free_extents_.erase(it);
+}
+
+Allocation SizeClassAllocator::BuildAllocation(int64_t offset, int64_t size) const {
+  return Allocation(static_cast<uint8_t *>(arena_->address) + offset,
+                    size,
+                    arena_->fd,
+                    arena_->offset + offset,
+                    /*device_num=*/0,
+                    arena_->mmap_size,
+                    /*fallback_allocated=*/false);
+}
+
+FragmentationStats SizeClassAllocator::GetFragmentationStats() const {
+  FragmentationStats stats;
+  for (const auto &extent : free_extents_) {
+    stats.free_extent_bytes += extent.second;
+    size_t bucket = 0;
+    for (int64_t num_pages = extent.second / kPageSize; num_pages > 1; num_pages /= 2) {
+      bucket++;
+    }
+    if (stats.free_extent_histogram.size() <= bucket) {
+      stats.free_extent_histogram.resize(bucket + 1);
+    }
+    stats.free_extent_histogram[bucket]++;
+  }
+  stats.largest_free_extent = GetLargestFreeExtent();
+  stats.num_slabs = slabs_.size();
+  for (const auto &slab : slabs_) {
+    stats.slab_free_bytes += (slab.second.num_slots - slab.second.num_used) *
+                             class_sizes_[slab.second.size_class];
+  }
+  return stats;
+}
+
+void SizeClassAllocator::GetDebugDump(std::stringstream &buffer) const {
+  const auto stats = GetFragmentationStats();
+  buffer << "- size class allocator: " << stats.num_slabs << " slabs with "
+         << stats.slab_free_bytes / 1024 / 1024 << "MB free, " << free_extents_.size()
+         << " free extents of " << stats.free_extent_bytes / 1024 / 1024
+         << "MB, largest " << stats.largest_free_extent / 1024 / 1024
+         << "MB, external fragmentation " << stats.ExternalFragmentation() << "\n";
+  buffer << "- free extents by number of pages:";
+  for (size_t i = 0; i < stats.free_extent_histogram.size(); i++) {
+    if (stats.free_extent_histogram[i] > 0) {
+      buffer << " [" << (int64_t{1} << i) << ", " << (int64_t{2} << i)
+             << "): " << stats.free_extent_histogram[i];
+    }
+  }
+  buffer << "\n";
+}
+
+}  // namespace plasma
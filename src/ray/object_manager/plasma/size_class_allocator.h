@@ -0,0 +1,156 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "ray/object_manager/plasma/allocator.h"
+#include "ray/object_manager/plasma/common.h"
+
+namespace plasma {
+
+/// Fragmentation statistics of a `SizeClassAllocator`.
+struct FragmentationStats {
+  /// Bytes of the free extents.
+  int64_t free_extent_bytes = 0;
+  /// Size of the largest free extent, i.e. of the largest object that can be allocated.
+  int64_t largest_free_extent = 0;
+  /// Number of free extents of [2^i, 2^(i+1)) pages, for each i.
+  std::vector<int64_t> free_extent_histogram;
+  /// Number of slabs of small objects.
+  int64_t num_slabs = 0;
+  /// Bytes of the free slots of the slabs.
+  int64_t slab_free_bytes = 0;
+
+  /// The part of the free extent bytes that can't be used by the largest allocation,
+  /// from 0 (a single free extent) to 1.
+  double ExternalFragmentation() const {
+    return free_extent_bytes == 0
+               ? 0
+               : 1 - static_cast<double>(largest_free_extent) / free_extent_bytes;
+  }
+};
+
+/// An allocator that resists the fragmentation of the object store memory by mixed
+/// small and large objects. It takes the primary memory of another allocator as one
+/// arena, and manages it in two levels:
+///   - Large objects get page aligned extents of the arena. The free extents are
+///   coalesced with their free neighbors, and allocations take the smallest free extent
+///   that fits, at the lowest address.
+///   - Small objects get slots of slabs, which are extents dedicated to one size class.
+///   So small objects don't leave holes between large objects, and a slab is given back
+///   as an extent once all its slots are free.
+/// Fallback allocations go to the other allocator.
+///
+/// This class is not thread safe.
+class SizeClassAllocator : public IAllocator {
+ public:
+  /// Objects up to this size are allocated in slabs.
+  static constexpr int64_t kMaxSmallObjectSize = 128 * 1024;
+  /// The size of a slab.
+  static constexpr int64_t kSlabSize = 1024 * 1024;
+  /// The alignment of the extents, and granularity of large objects.
+  static constexpr int64_t kPageSize = 4096;
+
+  /// \param backing_allocator The allocator to take the arena from, and that serves
+  /// fallback allocations. It must outlive this allocator.
+  explicit SizeClassAllocator(IAllocator &backing_allocator);
+
+  ~SizeClassAllocator() override;
+
+  SizeClassAllocator(const SizeClassAllocator &) = delete;
+  SizeClassAllocator &operator=(const SizeClassAllocator &) = delete;
+
+  absl::optional<Allocation> Allocate(size_t bytes) override;
+
+  absl::optional<Allocation> FallbackAllocate(size_t bytes) override;
+
+  void Free(Allocation allocation) override;
+
+  int64_t GetFootprintLimit() const override;
+
+  int64_t Allocated() const override;
+
+  int64_t FallbackAllocated() const override;
+
+  int64_t GetLargestFreeExtent() const override;
+
+  void GetDebugDump(std::stringstream &buffer) const override;
+
+  FragmentationStats GetFragmentationStats() const;
+
+ private:
+  /// A slab of slots of one size class.
+  struct Slab {
+    int size_class;
+    int64_t num_slots;
+    int64_t num_used = 0;
+    /// Slots from this one on were never used.
+    int64_t next_unused = 0;
+    /// Slots that were used and freed.
+    std::vector<int64_t> free_slots;
+  };
+
+  /// The size class of a small object, i.e. the index of the smallest class that fits.
+  int SizeClass(int64_t bytes) const;
+
+  /// Allocate a small object of `size_class`.
+  ///
+  /// \return The offset in the arena, -1 if there is no space.
+  int64_t AllocateSmall(int size_class);
+  void FreeSmall(int64_t offset);
+
+  /// Take an extent of `size` bytes, a multiple of the page size.
+  ///
+  /// \return The offset in the arena, -1 if no free extent fits.
+  int64_t AllocateExtent(int64_t size);
+  /// Give back an extent, coalescing it with its free neighbors.
+  void FreeExtent(int64_t offset, int64_t size);
+  void AddFreeExtent(int64_t offset, int64_t size);
+  void RemoveFreeExtent(std::map<int64_t, int64_t>::iterator it);
+
+  /// Build the allocation of `size` bytes at `offset` in the arena.
+  Allocation BuildAllocation(int64_t offset, int64_t size) const;
+
+  IAllocator &backing_allocator_;
+
+  /// The arena taken from the backing allocator.
+  absl::optional<Allocation> arena_;
+  int64_t arena_size_ = 0;
+
+  /// The slot size of each size class, in increasing order.
+  std::vector<int64_t> class_sizes_;
+
+  /// The free extents by offset, with their size.
+  std::map<int64_t, int64_t> free_extents_;
+  /// The free extents by size, then offset.
+  std::set<std::pair<int64_t, int64_t>> free_extents_by_size_;
+
+  /// The slabs by offset.
+  std::map<int64_t, Slab> slabs_;
+  /// For each size class, the offsets of its slabs that have free slots.
+  std::vector<std::set<int64_t>> partial_slabs_;
+
+  /// Bytes allocated in the arena, as requested.
+  int64_t allocated_ = 0;
+};
+
+}  // namespace plasma
@@ -182,6 +182,14 @@ void ObjectStatsCollector::OnObjectRefDecreased(const LocalObject &obj) {
   }
 }
 
+void ObjectStatsCollector::OnObjectTierChanged(const LocalObject &obj) {
+  RAY_CHECK(obj.Sealed());
+  const auto &kAllocation = obj.GetAllocation();
+  bytes_by_loc_seal_.Swap({!kAllocation.fallback_allocated, /* sealed */ true},
+                          {kAllocation.fallback_allocated, /* sealed */ true},
+                          obj.GetObjectInfo().GetObjectSize());
+}
+
 int64_t ObjectStatsCollector::GetNumBytesCreatedCurrent() const {
   return num_bytes_created_by_worker_ + num_bytes_restored_ + num_bytes_received_ +
          num_bytes_errored_;
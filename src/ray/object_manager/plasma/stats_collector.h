@@ -51,6 +51,10 @@ class ObjectStatsCollector {
   // Called after an object's ref count is decreased by 1.
   void OnObjectRefDecreased(const LocalObject &object);
 
+  // Called after a sealed object moved between the primary memory and the fallback
+  // tier.
+  void OnObjectTierChanged(const LocalObject &object);
+
   /// Record the internal metrics.
   void RecordMetrics() const;
 
@@ -18,8 +18,8 @@
 // PLASMA STORE: This is a simple object store server process
 //
 // It accepts incoming client connections on a unix domain socket
-// (name passed in via the -s option of the executable) and uses a
-// single thread to serve the clients. Each client establishes a
+// (name passed in via the -s option of the executable) and serves the
+// clients on one or several threads. Each client establishes a
 // connection and can create objects, wait for objects and seal
 // objects through that connection.
 //
@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <boost/bind/bind.hpp>
 #include <chrono>
 #include <ctime>
@@ -60,6 +61,20 @@ namespace fb = plasma::flatbuf;
 namespace plasma {
 namespace {
 
+/// The number of clients that can use the object index, and how many objects each of
+/// them can pin through it at a time.
+constexpr int64_t kObjectIndexNumPinTables = 1024;
+constexpr int64_t kObjectIndexPinsPerTable = 256;
+
+/// How often to retry releasing the objects that clients pin through the object index.
+constexpr uint32_t kIndexReleaseRetryMs = 10;
+
+/// How often to compact the memory when the compaction is enabled.
+constexpr uint32_t kCompactionIntervalMs = 100;
+
+/// How often to promote the objects of the fallback tier when it is enabled.
+constexpr uint32_t kPromotionIntervalMs = 100;
+
 ray::ObjectID GetCreateRequestObjectId(const std::vector<uint8_t> &message) {
   uint8_t *input = (uint8_t *)message.data();
   size_t input_size = message.size();
@@ -75,6 +90,7 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
                          const std::string &socket_name,
                          uint32_t delay_on_oom_ms,
                          float object_spilling_threshold,
+                         uint32_t num_client_threads,
                          ray::SpillObjectsCallback spill_objects_callback,
                          std::function<void()> object_store_full_callback,
                          ray::AddObjectCallback add_object_callback,
@@ -83,6 +99,10 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
       socket_name_(socket_name),
       acceptor_(main_service, ParseUrlEndpoint(socket_name)),
       socket_(main_service),
+      client_io_service_pool_(
+          num_client_threads > 1
+              ? std::make_unique<ray::IOServicePool>(num_client_threads)
+              : nullptr),
       allocator_(allocator),
       fs_monitor_(fs_monitor),
       add_object_callback_(add_object_callback),
@@ -112,7 +132,8 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
                 mutex_.AssertHeld();
                 this->AddToClientObjectIds(object_id, request->client);
               },
-          [this](const auto &request) { this->ReturnFromGet(request); }) {
+          [this](const auto &request) { this->ReturnFromGet(request); },
+          &mutex_) {
   if (RayConfig::instance().event_stats_print_interval_ms() > 0 &&
       RayConfig::instance().event_stats()) {
     PrintAndRecordDebugDump();
@@ -121,17 +142,62 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
   if (RayConfig::instance().metrics_report_interval_ms() > 0) {
     ScheduleRecordMetrics();
   }
+
+  if (RayConfig::instance().plasma_compaction_bandwidth_bytes_per_s() > 0) {
+    CompactObjects();
+  }
+
+  if (RayConfig::instance().plasma_fallback_tier_bytes() > 0) {
+    PromoteObjects();
+  }
 }
 
 // TODO(pcm): Get rid of this destructor by using RAII to clean up data.
-PlasmaStore::~PlasmaStore() {}
+PlasmaStore::~PlasmaStore() {
+  Stop();
+  absl::MutexLock lock(&mutex_);
+  if (object_index_allocation_) {
+    for (const auto &object_id : index_held_objects_) {
+      object_lifecycle_mgr_.RemoveReference(object_id);
+    }
+    object_index_.reset();
+    allocator_.Free(std::move(*object_index_allocation_));
+  }
+}
 
 void PlasmaStore::Start() {
+  const int64_t object_index_num_slots =
+      RayConfig::instance().plasma_object_index_num_slots();
+  if (object_index_num_slots > 0) {
+    absl::MutexLock lock(&mutex_);
+    object_index_allocation_ = allocator_.Allocate(ObjectIndex::RegionSize(
+        object_index_num_slots, kObjectIndexNumPinTables, kObjectIndexPinsPerTable));
+    if (object_index_allocation_) {
+      auto region = static_cast<uint8_t *>(object_index_allocation_->address);
+      ObjectIndex::Initialize(region,
+                              object_index_num_slots,
+                              kObjectIndexNumPinTables,
+                              kObjectIndexPinsPerTable);
+      object_index_ = std::make_unique<ObjectIndex>(region);
+    } else {
+      RAY_LOG(WARNING) << "Failed to allocate the plasma object index, the clients will "
+                          "get all the objects through the store.";
+    }
+  }
+  if (client_io_service_pool_) {
+    client_io_service_pool_->Run();
+  }
   // Start listening for clients.
   DoAccept();
 }
 
-void PlasmaStore::Stop() { acceptor_.close(); }
+void PlasmaStore::Stop() {
+  acceptor_.close();
+  if (client_io_service_pool_ && !client_threads_stopped_) {
+    client_io_service_pool_->Stop();
+    client_threads_stopped_ = true;
+  }
+}
 
 // If this client is not already using the object, add the client to the
 // object's list of clients, otherwise do nothing.
@@ -145,6 +211,72 @@ void PlasmaStore::AddToClientObjectIds(const ObjectID &object_id,
   RAY_CHECK(object_lifecycle_mgr_.AddReference(object_id));
   // Add object id to the list of object ids that this client is using.
   client->MarkObjectAsUsed(object_id);
+  PublishObject(object_id);
+}
+
+void PlasmaStore::PublishObject(const ObjectID &object_id) {
+  if (!object_index_) {
+    return;
+  }
+  auto entry = object_lifecycle_mgr_.GetObject(object_id);
+  if (entry == nullptr || !entry->Sealed() || entry->GetRefCount() == 0) {
+    return;
+  }
+  PlasmaObject object;
+  entry->ToPlasmaObject(&object, /*check_sealed=*/true);
+  if (object.device_num == 0) {
+    // If the index is too full, the clients get the object through the store.
+    RAY_UNUSED(object_index_->Publish(object_id, object));
+  }
+}
+
+void PlasmaStore::RemoveReference(const ObjectID &object_id) {
+  if (object_index_) {
+    auto entry = object_lifecycle_mgr_.GetObject(object_id);
+    if (entry != nullptr && entry->GetRefCount() == 1 &&
+        !object_index_->TryUnpublish(object_id)) {
+      // The clients don't tell the store when they unpin an object, so the reference is
+      // kept until a retry finds the object unpinned.
+      index_held_objects_.insert(object_id);
+      ScheduleReleaseIndexHeldObjects();
+      return;
+    }
+  }
+  object_lifecycle_mgr_.RemoveReference(object_id);
+}
+
+void PlasmaStore::ReleaseIndexHeldObjects() {
+  if (!object_index_) {
+    return;
+  }
+  for (auto it = index_held_objects_.begin(); it != index_held_objects_.end();) {
+    const ObjectID object_id = *it;
+    auto entry = object_lifecycle_mgr_.GetObject(object_id);
+    RAY_CHECK(entry != nullptr);
+    // If a client got the object through the store again, the object stays published
+    // with the reference of that client.
+    if (entry->GetRefCount() > 1 || object_index_->TryUnpublish(object_id)) {
+      index_held_objects_.erase(it++);
+      object_lifecycle_mgr_.RemoveReference(object_id);
+    } else {
+      ++it;
+    }
+  }
+  ScheduleReleaseIndexHeldObjects();
+}
+
+void PlasmaStore::ScheduleReleaseIndexHeldObjects() {
+  if (index_held_objects_.empty() || index_release_timer_) {
+    return;
+  }
+  index_release_timer_ = execute_after(
+      io_context_,
+      [this]() {
+        absl::MutexLock lock(&mutex_);
+        index_release_timer_ = nullptr;
+        ReleaseIndexHeldObjects();
+      },
+      kIndexReleaseRetryMs);
 }
 
 PlasmaError PlasmaStore::HandleCreateObjectRequest(const std::shared_ptr<Client> &client,
@@ -266,7 +398,7 @@ int PlasmaStore::RemoveFromClientObjectIds(const ObjectID &object_id,
     client->MarkObjectAsUnused(*it);
     RAY_LOG(DEBUG) << "Object " << object_id << " no longer in use by client";
     // Decrease reference count.
-    object_lifecycle_mgr_.RemoveReference(object_id);
+    RemoveReference(object_id);
     // Return 1 to indicate that the client was removed.
     return 1;
   } else {
@@ -289,6 +421,7 @@ void PlasmaStore::SealObjects(const std::vector<ObjectID> &object_ids) {
     auto entry = object_lifecycle_mgr_.SealObject(object_ids[i]);
     RAY_CHECK(entry) << object_ids[i] << " is missing or not sealed.";
     add_object_callback_(entry->GetObjectInfo());
+    PublishObject(object_ids[i]);
   }
 
   for (size_t i = 0; i < object_ids.size(); ++i) {
@@ -351,9 +484,19 @@ void PlasmaStore::DisconnectClient(const std::shared_ptr<Client> &client) {
   /// Remove all of the client's GetRequests.
   get_request_queue_.RemoveGetRequestsForClient(client);
 
+  // Drop the pins of the client before its references, so that they don't keep the
+  // objects.
+  if (client->object_index_pin_table >= 0) {
+    if (object_index_) {
+      object_index_->ReleasePinTable(client->object_index_pin_table);
+    }
+    client->object_index_pin_table = -1;
+  }
+
   for (const auto &[object_id, _] : sealed_objects) {
     RemoveFromClientObjectIds(object_id, client);
   }
+  ReleaseIndexHeldObjects();
 
   create_request_queue_.RemoveDisconnectedClientRequests(client);
 }
@@ -361,13 +504,13 @@ void PlasmaStore::DisconnectClient(const std::shared_ptr<Client> &client) {
 Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
                                    fb::MessageType type,
                                    const std::vector<uint8_t> &message) {
-  absl::MutexLock lock(&mutex_);
   // TODO(suquark): We should convert these interfaces to const later.
   uint8_t *input = (uint8_t *)message.data();
   size_t input_size = message.size();
   ObjectID object_id;
 
-  // Process the different types of requests.
+  // Process the different types of requests. Only the store state is accessed under
+  // the lock, so that the client threads don't wait on each other's socket writes.
   switch (type) {
   case fb::MessageType::PlasmaCreateRequest: {
     const auto &object_id = GetCreateRequestObjectId(message);
@@ -387,8 +530,12 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     if (request->try_immediately()) {
       RAY_LOG(DEBUG) << "Received request to create object " << object_id
                      << " immediately";
-      auto result_error = create_request_queue_.TryRequestImmediately(
-          object_id, client, handle_create, object_size);
+      std::pair<PlasmaObject, PlasmaError> result_error;
+      {
+        absl::MutexLock lock(&mutex_);
+        result_error = create_request_queue_.TryRequestImmediately(
+            object_id, client, handle_create, object_size);
+      }
       const auto &result = result_error.first;
       const auto &error = result_error.second;
       if (SendCreateReply(client, object_id, result, error).ok() &&
@@ -396,12 +543,20 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
         static_cast<void>(client->SendFd(result.store_fd));
       }
     } else {
-      auto req_id =
-          create_request_queue_.AddRequest(object_id, client, handle_create, object_size);
+      uint64_t req_id;
+      {
+        absl::MutexLock lock(&mutex_);
+        req_id = create_request_queue_.AddRequest(object_id,
+                                                  client,
+                                                  handle_create,
+                                                  object_size,
+                                                  request->priority(),
+                                                  request->deadline_ms());
+        ProcessCreateRequests();
+      }
       RAY_LOG(DEBUG) << "Received create request for object " << object_id
                      << " assigned request ID " << req_id << ", " << object_size
                      << " bytes";
-      ProcessCreateRequests();
       ReplyToCreateClient(client, object_id, req_id);
     }
   } break;
@@ -413,9 +568,12 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
   } break;
   case fb::MessageType::PlasmaAbortRequest: {
     RAY_RETURN_NOT_OK(ReadAbortRequest(input, input_size, &object_id));
-    RAY_CHECK(AbortObject(object_id, client) == 1) << "To abort an object, the only "
-                                                      "client currently using it "
-                                                      "must be the creator.";
+    {
+      absl::MutexLock lock(&mutex_);
+      RAY_CHECK(AbortObject(object_id, client) == 1) << "To abort an object, the only "
+                                                        "client currently using it "
+                                                        "must be the creator.";
+    }
     RAY_RETURN_NOT_OK(SendAbortReply(client, object_id));
   } break;
   case fb::MessageType::PlasmaGetRequest: {
@@ -424,10 +582,12 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     bool is_from_worker;
     RAY_RETURN_NOT_OK(ReadGetRequest(
         input, input_size, object_ids_to_get, &timeout_ms, &is_from_worker));
+    absl::MutexLock lock(&mutex_);
     ProcessGetRequest(client, object_ids_to_get, timeout_ms, is_from_worker);
   } break;
   case fb::MessageType::PlasmaReleaseRequest: {
     RAY_RETURN_NOT_OK(ReadReleaseRequest(input, input_size, &object_id));
+    absl::MutexLock lock(&mutex_);
     ReleaseObject(object_id, client);
   } break;
   case fb::MessageType::PlasmaDeleteRequest: {
@@ -435,42 +595,84 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     std::vector<PlasmaError> error_codes;
     RAY_RETURN_NOT_OK(ReadDeleteRequest(input, input_size, &object_ids));
     error_codes.reserve(object_ids.size());
-    for (auto &object_id : object_ids) {
-      error_codes.push_back(object_lifecycle_mgr_.DeleteObject(object_id));
+    {
+      absl::MutexLock lock(&mutex_);
+      for (auto &object_id : object_ids) {
+        error_codes.push_back(object_lifecycle_mgr_.DeleteObject(object_id));
+      }
     }
     RAY_RETURN_NOT_OK(SendDeleteReply(client, object_ids, error_codes));
   } break;
   case fb::MessageType::PlasmaContainsRequest: {
     RAY_RETURN_NOT_OK(ReadContainsRequest(input, input_size, &object_id));
-    if (object_lifecycle_mgr_.IsObjectSealed(object_id)) {
-      RAY_RETURN_NOT_OK(SendContainsReply(client, object_id, 1));
-    } else {
-      RAY_RETURN_NOT_OK(SendContainsReply(client, object_id, 0));
+    bool is_sealed;
+    {
+      absl::MutexLock lock(&mutex_);
+      is_sealed = object_lifecycle_mgr_.IsObjectSealed(object_id);
     }
+    RAY_RETURN_NOT_OK(SendContainsReply(client, object_id, is_sealed));
   } break;
   case fb::MessageType::PlasmaSealRequest: {
     RAY_RETURN_NOT_OK(ReadSealRequest(input, input_size, &object_id));
-    SealObjects({object_id});
+    {
+      absl::MutexLock lock(&mutex_);
+      SealObjects({object_id});
+    }
     RAY_RETURN_NOT_OK(SendSealReply(client, object_id, PlasmaError::OK));
   } break;
   case fb::MessageType::PlasmaEvictRequest: {
     // This code path should only be used for testing.
     int64_t num_bytes;
     RAY_RETURN_NOT_OK(ReadEvictRequest(input, input_size, &num_bytes));
-    int64_t num_bytes_evicted = object_lifecycle_mgr_.RequireSpace(num_bytes);
+    int64_t num_bytes_evicted;
+    {
+      absl::MutexLock lock(&mutex_);
+      num_bytes_evicted = object_lifecycle_mgr_.RequireSpace(num_bytes);
+    }
     RAY_RETURN_NOT_OK(SendEvictReply(client, num_bytes_evicted));
   } break;
   case fb::MessageType::PlasmaConnectRequest: {
-    RAY_RETURN_NOT_OK(SendConnectReply(client, allocator_.GetFootprintLimit()));
+    int64_t footprint_limit;
+    int64_t object_index_pin_table = -1;
+    MEMFD_TYPE object_index_fd = {INVALID_FD, 0};
+    int64_t object_index_offset = 0;
+    int64_t object_index_mmap_size = 0;
+    {
+      absl::MutexLock lock(&mutex_);
+      footprint_limit = allocator_.GetFootprintLimit();
+      if (object_index_) {
+        if (client->object_index_pin_table == -1) {
+          client->object_index_pin_table = object_index_->AcquirePinTable();
+        }
+        object_index_pin_table = client->object_index_pin_table;
+        object_index_fd = object_index_allocation_->fd;
+        object_index_offset = object_index_allocation_->offset;
+        object_index_mmap_size = object_index_allocation_->mmap_size;
+      }
+    }
+    RAY_RETURN_NOT_OK(SendConnectReply(client,
+                                       footprint_limit,
+                                       object_index_pin_table,
+                                       object_index_fd,
+                                       object_index_offset,
+                                       object_index_mmap_size));
+    if (object_index_pin_table >= 0) {
+      RAY_RETURN_NOT_OK(client->SendFd(object_index_fd));
+    }
   } break;
-  case fb::MessageType::PlasmaDisconnectClient:
+  case fb::MessageType::PlasmaDisconnectClient: {
     RAY_LOG(DEBUG) << "Disconnecting client on fd " << client;
+    absl::MutexLock lock(&mutex_);
     DisconnectClient(client);
     return Status::Disconnected("The Plasma Store client is disconnected.");
-    break;
+  } break;
   case fb::MessageType::PlasmaGetDebugStringRequest: {
-    RAY_RETURN_NOT_OK(SendGetDebugStringReply(
-        client, object_lifecycle_mgr_.EvictionPolicyDebugString()));
+    std::string debug_string;
+    {
+      absl::MutexLock lock(&mutex_);
+      debug_string = object_lifecycle_mgr_.EvictionPolicyDebugString();
+    }
+    RAY_RETURN_NOT_OK(SendGetDebugStringReply(client, debug_string));
   } break;
   default:
     // This code should be unreachable.
@@ -480,6 +682,10 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
 }
 
 void PlasmaStore::DoAccept() {
+  if (client_io_service_pool_) {
+    // The next client is served on the thread of the io context of its socket.
+    socket_ = ray::local_stream_socket(*client_io_service_pool_->Get());
+  }
   acceptor_.async_accept(
       socket_,
       boost::bind(&PlasmaStore::ConnectClient, this, boost::asio::placeholders::error));
@@ -525,7 +731,11 @@ void PlasmaStore::ReplyToCreateClient(const std::shared_ptr<Client> &client,
                                       uint64_t req_id) {
   PlasmaObject result = {};
   PlasmaError error;
-  bool finished = create_request_queue_.GetRequestResult(req_id, &result, &error);
+  bool finished;
+  {
+    absl::MutexLock lock(&mutex_);
+    finished = create_request_queue_.GetRequestResult(req_id, &result, &error);
+  }
   if (finished) {
     RAY_LOG(DEBUG) << "Finishing create object " << object_id << " request ID " << req_id;
     if (SendCreateReply(client, object_id, result, error).ok() &&
@@ -546,7 +756,10 @@ bool PlasmaStore::IsObjectSpillable(const ObjectID &object_id) {
     // Object already evicted or deleted.
     return false;
   }
-  return entry->Sealed() && entry->GetRefCount() == 1;
+  // The object isn't spillable if a client pinned it through the object index, on top
+  // of the reference of the raylet.
+  return entry->Sealed() && entry->GetRefCount() == 1 &&
+         !(object_index_ && object_index_->IsPinned(object_id));
 }
 
 void PlasmaStore::PrintAndRecordDebugDump() const {
@@ -570,6 +783,37 @@ void PlasmaStore::ScheduleRecordMetrics() const {
       RayConfig::instance().metrics_report_interval_ms() / 2);
 }
 
+void PlasmaStore::CompactObjects() {
+  absl::MutexLock lock(&mutex_);
+  // Each tick copies its slice of the bandwidth, so that the store lock is never held
+  // for more than one interval's worth of copying.
+  const int64_t budget_bytes =
+      RayConfig::instance().plasma_compaction_bandwidth_bytes_per_s() *
+      kCompactionIntervalMs / 1000;
+  const int64_t largest_free_extent = allocator_.GetLargestFreeExtent();
+  const int64_t num_bytes_moved = object_lifecycle_mgr_.CompactObjects(budget_bytes);
+  if (num_bytes_moved > 0) {
+    ray::stats::STATS_object_store_compaction_bytes_moved.Record(num_bytes_moved);
+    if (largest_free_extent >= 0) {
+      ray::stats::STATS_object_store_largest_free_extent_bytes.Record(
+          largest_free_extent, "BeforeCompaction");
+      ray::stats::STATS_object_store_largest_free_extent_bytes.Record(
+          allocator_.GetLargestFreeExtent(), "AfterCompaction");
+    }
+  }
+
+  compaction_timer_ = execute_after(
+      io_context_, [this]() { CompactObjects(); }, kCompactionIntervalMs);
+}
+
+void PlasmaStore::PromoteObjects() {
+  absl::MutexLock lock(&mutex_);
+  object_lifecycle_mgr_.PromoteObjects(
+      RayConfig::instance().plasma_fallback_tier_max_move_bytes());
+  promotion_timer_ = execute_after(
+      io_context_, [this]() { PromoteObjects(); }, kPromotionIntervalMs);
+}
+
 std::string PlasmaStore::GetDebugDump() const {
   std::stringstream buffer;
   buffer << "========== Plasma store: =================\n";
@@ -581,6 +825,15 @@ std::string PlasmaStore::GetDebugDump() const {
   auto num_pending_bytes = create_request_queue_.NumPendingBytes();
   buffer << num_pending_requests << " pending objects of total size "
          << num_pending_bytes / 1024 / 1024 << "MB\n";
+  if (object_index_) {
+    buffer << "- objects in the object index: " << object_index_->NumPublished()
+           << ", kept for index pins: " << index_held_objects_.size() << "\n";
+  }
+  if (RayConfig::instance().plasma_compaction_bandwidth_bytes_per_s() > 0) {
+    buffer << "- bytes moved by compaction: "
+           << object_lifecycle_mgr_.GetNumBytesCompactedTotal() / 1024 / 1024 << "MB\n";
+  }
+  allocator_.GetDebugDump(buffer);
   object_lifecycle_mgr_.GetDebugDump(buffer);
   return buffer.str();
 }
@@ -25,8 +25,10 @@
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/asio/io_service_pool.h"
 #include "ray/common/file_system_monitor.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
@@ -36,6 +38,7 @@
 #include "ray/object_manager/plasma/create_request_queue.h"
 #include "ray/object_manager/plasma/eviction_policy.h"
 #include "ray/object_manager/plasma/get_request_queue.h"
+#include "ray/object_manager/plasma/object_index.h"
 #include "ray/object_manager/plasma/object_lifecycle_manager.h"
 #include "ray/object_manager/plasma/object_store.h"
 #include "ray/object_manager/plasma/plasma.h"
@@ -60,6 +63,7 @@ class PlasmaStore {
               const std::string &socket_name,
               uint32_t delay_on_oom_ms,
               float object_spilling_threshold,
+              uint32_t num_client_threads,
               ray::SpillObjectsCallback spill_objects_callback,
               std::function<void()> object_store_full_callback,
               ray::AddObjectCallback add_object_callback,
@@ -70,7 +74,7 @@ class PlasmaStore {
   /// Start this store.
   void Start();
 
-  /// Stop this store.
+  /// Stop this store. This is idempotent.
   void Stop();
 
   /// Return true if the given object id has only one reference.
@@ -207,7 +211,7 @@ class PlasmaStore {
 
   void ReplyToCreateClient(const std::shared_ptr<Client> &client,
                            const ObjectID &object_id,
-                           uint64_t req_id) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+                           uint64_t req_id) LOCKS_EXCLUDED(mutex_);
 
   void AddToClientObjectIds(const ObjectID &object_id,
                             const std::shared_ptr<ClientInterface> &client)
@@ -219,6 +223,21 @@ class PlasmaStore {
                                 const std::shared_ptr<Client> &client)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Publish an object in the object index if it's sealed and in use, so that the
+  /// clients get it without sending messages.
+  void PublishObject(const ObjectID &object_id) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Remove a reference to an object. If it's the last one and a client still pins the
+  /// object through the object index, keep it until the object is unpinned.
+  void RemoveReference(const ObjectID &object_id) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Remove the references kept for the objects that aren't pinned through the object
+  /// index anymore, and retry later for the others.
+  void ReleaseIndexHeldObjects() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Retry `ReleaseIndexHeldObjects` later if there are objects left.
+  void ScheduleReleaseIndexHeldObjects() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Start listening for clients.
   void DoAccept();
 
@@ -231,6 +250,14 @@ class PlasmaStore {
 
   void ScheduleRecordMetrics() const LOCKS_EXCLUDED(mutex_);
 
+  /// Move the objects no client uses toward the start of the memory, as much as the
+  /// compaction bandwidth allows, and schedule the next compaction.
+  void CompactObjects() LOCKS_EXCLUDED(mutex_);
+
+  /// Move the objects of the fallback tier that are used again back to the memory,
+  /// and schedule the next promotion.
+  void PromoteObjects() LOCKS_EXCLUDED(mutex_);
+
   // A reference to the asio io context.
   instrumented_io_context &io_context_;
   /// The name of the socket this object store listens on.
@@ -239,6 +266,11 @@ class PlasmaStore {
   boost::asio::basic_socket_acceptor<ray::local_stream_protocol> acceptor_;
   /// The socket to listen on for new clients.
   ray::local_stream_socket socket_;
+  /// The threads that serve the clients, which are assigned to them round robin. Null
+  /// if the clients are served on io_context_.
+  std::unique_ptr<ray::IOServicePool> client_io_service_pool_;
+  /// Whether the client threads were stopped.
+  bool client_threads_stopped_ = false;
 
   /// This mutex is used in order to make plasma store threas-safe with raylet.
   /// Raylet's local_object_manager needs to ping access plasma store's method in order to
@@ -246,6 +278,8 @@ class PlasmaStore {
   /// deadlock while we keep the simplest possible change. NOTE(sang): Avoid adding more
   /// interface that node manager or object manager can access the plasma store with this
   /// mutex if it is not absolutely necessary.
+  /// It also guards the store state from the client threads: the requests are parsed
+  /// and the replies are sent to the requesting client outside of it.
   mutable absl::Mutex mutex_;
 
   /// The allocator that allocates mmaped memory.
@@ -284,6 +318,12 @@ class PlasmaStore {
   /// Timer for recording object store metrics.
   mutable std::shared_ptr<boost::asio::deadline_timer> metric_timer_ GUARDED_BY(mutex_);
 
+  /// Timer for compacting the memory.
+  std::shared_ptr<boost::asio::deadline_timer> compaction_timer_ GUARDED_BY(mutex_);
+
+  /// Timer for promoting the objects of the fallback tier.
+  std::shared_ptr<boost::asio::deadline_timer> promotion_timer_ GUARDED_BY(mutex_);
+
   /// Queue of object creation requests.
   CreateRequestQueue create_request_queue_ GUARDED_BY(mutex_);
 
@@ -295,6 +335,21 @@ class PlasmaStore {
   bool dumped_on_oom_ GUARDED_BY(mutex_) = false;
 
   GetRequestQueue get_request_queue_ GUARDED_BY(mutex_);
+
+  /// The memory of the object index. Unset if the index is disabled.
+  absl::optional<Allocation> object_index_allocation_ GUARDED_BY(mutex_);
+
+  /// The shared memory index of the sealed objects in use, which the clients pin
+  /// without sending messages. Null if disabled.
+  std::unique_ptr<ObjectIndex> object_index_ GUARDED_BY(mutex_);
+
+  /// The objects that no client uses through messages anymore, but that a client still
+  /// pins through the object index. The store keeps a reference to each of them.
+  absl::flat_hash_set<ObjectID> index_held_objects_ GUARDED_BY(mutex_);
+
+  /// A timer that is set while there are `index_held_objects_`, to retry releasing
+  /// them.
+  std::shared_ptr<boost::asio::deadline_timer> index_release_timer_ GUARDED_BY(mutex_);
 };
 
 }  // namespace plasma
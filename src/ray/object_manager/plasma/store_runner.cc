@@ -90,6 +90,9 @@ void PlasmaStoreRunner::Start(ray::SpillObjectsCallback spill_objects_callback,
     absl::MutexLock lock(&store_runner_mutex_);
     allocator_ = std::make_unique<PlasmaAllocator>(
         plasma_directory_, fallback_directory_, hugepages_enabled_, system_memory_);
+    if (RayConfig::instance().plasma_size_class_allocator_enabled()) {
+      size_class_allocator_ = std::make_unique<SizeClassAllocator>(*allocator_);
+    }
 #ifndef _WIN32
     std::vector<std::string> local_spilling_paths;
     if (RayConfig::instance().is_external_storage_type_fs()) {
@@ -105,12 +108,16 @@ void PlasmaStoreRunner::Start(ray::SpillObjectsCallback spill_objects_callback,
     // Create noop monitor for Windows.
     fs_monitor_ = std::make_unique<ray::FileSystemMonitor>();
 #endif
+    IAllocator &allocator = size_class_allocator_
+                                ? static_cast<IAllocator &>(*size_class_allocator_)
+                                : *allocator_;
     store_.reset(new PlasmaStore(main_service_,
-                                 *allocator_,
+                                 allocator,
                                  *fs_monitor_,
                                  socket_name_,
                                  RayConfig::instance().object_store_full_delay_ms(),
                                  RayConfig::instance().object_spilling_threshold(),
+                                 RayConfig::instance().plasma_store_num_client_threads(),
                                  spill_objects_callback,
                                  object_store_full_callback,
                                  add_object_callback,
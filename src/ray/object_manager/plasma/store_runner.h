@@ -7,6 +7,7 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/file_system_monitor.h"
 #include "ray/object_manager/plasma/plasma_allocator.h"
+#include "ray/object_manager/plasma/size_class_allocator.h"
 #include "ray/object_manager/plasma/store.h"
 
 namespace plasma {
@@ -44,6 +45,8 @@ class PlasmaStoreRunner {
   std::string fallback_directory_;
   mutable instrumented_io_context main_service_;
   std::unique_ptr<PlasmaAllocator> allocator_;
+  /// Allocates the objects from the memory of `allocator_`, if enabled.
+  std::unique_ptr<SizeClassAllocator> size_class_allocator_;
   std::unique_ptr<ray::FileSystemMonitor> fs_monitor_;
   std::unique_ptr<PlasmaStore> store_;
 };
@@ -95,6 +95,13 @@ class MockObjectStore : public IObjectStore {
   MOCK_CONST_METHOD1(GetObject, const LocalObject *(const ObjectID &));
   MOCK_METHOD1(SealObject, const LocalObject *(const ObjectID &));
   MOCK_METHOD1(DeleteObject, bool(const ObjectID &));
+  MOCK_METHOD1(RelocateObject, bool(const ObjectID &));
+  MOCK_METHOD1(DemoteObject, bool(const ObjectID &));
+  MOCK_METHOD1(PromoteObject, bool(const ObjectID &));
+  MOCK_METHOD1(PrefetchObject, void(const ObjectID &));
+  MOCK_CONST_METHOD1(
+      ForEachObject,
+      void(const std::function<void(const ObjectID &, const LocalObject &)> &));
   MOCK_CONST_METHOD0(GetNumBytesCreatedTotal, int64_t());
   MOCK_CONST_METHOD0(GetNumBytesUnsealed, int64_t());
   MOCK_CONST_METHOD0(GetNumObjectsUnsealed, int64_t());
@@ -0,0 +1,136 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/object_index.h"
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace plasma {
+
+class ObjectIndexTest : public ::testing::Test {
+ protected:
+  ObjectIndexTest()
+      : region_(ObjectIndex::RegionSize(kNumSlots, kNumPinTables, kPinsPerTable)) {
+    ObjectIndex::Initialize(region_.data(), kNumSlots, kNumPinTables, kPinsPerTable);
+    // The store and the client access the same region through their own views.
+    store_ = std::make_unique<ObjectIndex>(region_.data());
+    client_ = std::make_unique<ObjectIndex>(region_.data());
+    pin_table_ = store_->AcquirePinTable();
+  }
+
+  static PlasmaObject MakeObject(int64_t data_offset) {
+    PlasmaObject object = {};
+    object.store_fd = {INT2FD(3), 42};
+    object.data_offset = data_offset;
+    object.data_size = 100;
+    object.metadata_offset = data_offset + 100;
+    object.metadata_size = 10;
+    object.device_num = 0;
+    object.mmap_size = 1 << 20;
+    return object;
+  }
+
+  static constexpr int64_t kNumSlots = 64;
+  static constexpr int64_t kNumPinTables = 2;
+  static constexpr int64_t kPinsPerTable = 4;
+
+  std::vector<uint8_t> region_;
+  std::unique_ptr<ObjectIndex> store_;
+  std::unique_ptr<ObjectIndex> client_;
+  int64_t pin_table_;
+};
+
+TEST_F(ObjectIndexTest, TestPinAndUnpublish) {
+  const auto object_id = ObjectID::FromRandom();
+  PlasmaObject object;
+  EXPECT_EQ(client_->Pin(pin_table_, object_id, &object), -1);
+
+  ASSERT_TRUE(store_->Publish(object_id, MakeObject(4096)));
+  EXPECT_EQ(store_->NumPublished(), 1);
+  int64_t pin = client_->Pin(pin_table_, object_id, &object);
+  ASSERT_NE(pin, -1);
+  EXPECT_EQ(object, MakeObject(4096));
+  EXPECT_EQ(object.mmap_size, 1 << 20);
+
+  // The store can't unpublish a pinned object.
+  EXPECT_TRUE(store_->IsPinned(object_id));
+  EXPECT_FALSE(store_->TryUnpublish(object_id));
+  int64_t second_pin = client_->Pin(pin_table_, object_id, &object);
+  ASSERT_NE(second_pin, -1);
+
+  client_->Unpin(pin_table_, pin);
+  EXPECT_FALSE(store_->TryUnpublish(object_id));
+  client_->Unpin(pin_table_, second_pin);
+  EXPECT_FALSE(store_->IsPinned(object_id));
+  EXPECT_TRUE(store_->TryUnpublish(object_id));
+  EXPECT_EQ(store_->NumPublished(), 0);
+  EXPECT_EQ(client_->Pin(pin_table_, object_id, &object), -1);
+}
+
+TEST_F(ObjectIndexTest, TestReuseSlots) {
+  PlasmaObject object;
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 3 * kNumSlots; i++) {
+    const auto object_id = ObjectID::FromRandom();
+    ASSERT_TRUE(store_->Publish(object_id, MakeObject(i)));
+    if (i > 0) {
+      EXPECT_TRUE(store_->TryUnpublish(object_ids.back()));
+      EXPECT_EQ(client_->Pin(pin_table_, object_ids.back(), &object), -1);
+    }
+    int64_t pin = client_->Pin(pin_table_, object_id, &object);
+    ASSERT_NE(pin, -1);
+    EXPECT_EQ(object.data_offset, i);
+    client_->Unpin(pin_table_, pin);
+    object_ids.push_back(object_id);
+  }
+  EXPECT_EQ(store_->NumPublished(), 1);
+}
+
+TEST_F(ObjectIndexTest, TestFullPinTable) {
+  const auto object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(store_->Publish(object_id, MakeObject(0)));
+  PlasmaObject object;
+  std::vector<int64_t> pins;
+  for (int i = 0; i < kPinsPerTable; i++) {
+    pins.push_back(client_->Pin(pin_table_, object_id, &object));
+    ASSERT_NE(pins.back(), -1);
+  }
+  // The client gets the object through the store when its pin table is full.
+  EXPECT_EQ(client_->Pin(pin_table_, object_id, &object), -1);
+  client_->Unpin(pin_table_, pins.back());
+  EXPECT_NE(client_->Pin(pin_table_, object_id, &object), -1);
+}
+
+TEST_F(ObjectIndexTest, TestReleasePinTable) {
+  const auto object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(store_->Publish(object_id, MakeObject(0)));
+  PlasmaObject object;
+  ASSERT_NE(client_->Pin(pin_table_, object_id, &object), -1);
+  ASSERT_NE(client_->Pin(pin_table_, object_id, &object), -1);
+  EXPECT_FALSE(store_->TryUnpublish(object_id));
+
+  // The client disconnects without unpinning: the store drops its pins.
+  store_->ReleasePinTable(pin_table_);
+  EXPECT_FALSE(store_->IsPinned(object_id));
+  EXPECT_TRUE(store_->TryUnpublish(object_id));
+
+  EXPECT_EQ(store_->AcquirePinTable(), pin_table_);
+  EXPECT_NE(store_->AcquirePinTable(), -1);
+  EXPECT_EQ(store_->AcquirePinTable(), -1);
+}
+
+}  // namespace plasma
@@ -14,17 +14,33 @@
 
 #include "ray/object_manager/plasma/object_lifecycle_manager.h"
 
+#include <cstring>
+#include <filesystem>
 #include <limits>
+#include <random>
+#include <utility>
 
 #include "absl/random/random.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/object_manager/plasma/size_class_allocator.h"
 
 using namespace ray;
 using namespace testing;
 
 namespace plasma {
+namespace {
+const int64_t kMB = 1024 * 1024;
+std::string CreateTestDir() {
+  std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / GenerateUUIDV4();
+  std::filesystem::create_directories(directory);
+  return directory.string();
+}
+}  // namespace
 
 class MockEvictionPolicy : public IEvictionPolicy {
  public:
@@ -34,6 +50,10 @@ class MockEvictionPolicy : public IEvictionPolicy {
   MOCK_METHOD1(EndObjectAccess, void(const ObjectID &));
   MOCK_METHOD2(ChooseObjectsToEvict, int64_t(int64_t, std::vector<ObjectID> &));
   MOCK_METHOD1(RemoveObject, void(const ObjectID &));
+  MOCK_METHOD2(RequireFallbackTierSpace, int64_t(int64_t, std::vector<ObjectID> &));
+  MOCK_METHOD1(ObjectDemoted, void(const ObjectID &));
+  MOCK_METHOD1(ObjectPromoted, void(const ObjectID &));
+  MOCK_CONST_METHOD1(ShouldPromote, bool(const ObjectID &));
   MOCK_CONST_METHOD0(DebugString, std::string());
 };
 
@@ -46,6 +66,13 @@ class MockObjectStore : public IObjectStore {
   MOCK_CONST_METHOD1(GetObject, const LocalObject *(const ObjectID &));
   MOCK_METHOD1(SealObject, const LocalObject *(const ObjectID &));
   MOCK_METHOD1(DeleteObject, bool(const ObjectID &));
+  MOCK_METHOD1(RelocateObject, bool(const ObjectID &));
+  MOCK_METHOD1(DemoteObject, bool(const ObjectID &));
+  MOCK_METHOD1(PromoteObject, bool(const ObjectID &));
+  MOCK_METHOD1(PrefetchObject, void(const ObjectID &));
+  MOCK_CONST_METHOD1(
+      ForEachObject,
+      void(const std::function<void(const ObjectID &, const LocalObject &)> &));
   MOCK_CONST_METHOD1(GetDebugDump, void(std::stringstream &buffer));
 };
 
@@ -343,6 +370,308 @@ TEST_F(ObjectLifecycleManagerTest, RemoveReferenceOneRefEagerlyDeletion) {
   std::vector<ObjectID> expect_notified_ids{id1_};
   EXPECT_EQ(expect_notified_ids, notify_deleted_ids_);
 }
+
+TEST_F(ObjectLifecycleManagerTest, CompactObjects) {
+  uint8_t memory[400];
+  object1_.state = ObjectState::PLASMA_SEALED;
+  object1_.object_info.data_size = 100;
+  object1_.allocation.address = &memory[100];
+  object2_.state = ObjectState::PLASMA_SEALED;
+  object2_.object_info.data_size = 50;
+  object2_.allocation.address = &memory[200];
+  one_ref_object_.allocation.address = &memory[300];
+  not_sealed_object_.allocation.address = &memory[350];
+  EXPECT_CALL(*object_store_, ForEachObject(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([this](const auto &fn) {
+        fn(id1_, object1_);
+        fn(id2_, object2_);
+        fn(id3_, one_ref_object_);
+        fn(ObjectID::FromRandom(), not_sealed_object_);
+      }));
+  EXPECT_CALL(*object_store_, GetObject(id1_)).WillRepeatedly(Return(&object1_));
+  EXPECT_CALL(*object_store_, GetObject(id2_)).WillRepeatedly(Return(&object2_));
+
+  // Only the sealed objects that no client uses are moved, from the highest address,
+  // and the ones over the budget are skipped.
+  EXPECT_CALL(*object_store_, RelocateObject(id2_)).Times(1).WillOnce(Return(true));
+  EXPECT_EQ(manager_->CompactObjects(/*max_bytes=*/120), 50);
+
+  // Once a compaction moves nothing, the next ones don't look for objects to move.
+  EXPECT_CALL(*object_store_, RelocateObject(_)).WillRepeatedly(Return(false));
+  EXPECT_EQ(manager_->CompactObjects(/*max_bytes=*/1000), 0);
+  EXPECT_EQ(manager_->CompactObjects(/*max_bytes=*/1000), 0);
+  EXPECT_EQ(manager_->GetNumBytesCompactedTotal(), 50);
+}
+
+TEST_F(ObjectLifecycleManagerTest, CompactObjectsSkipsObjectsOverBudget) {
+  uint8_t memory[200];
+  object1_.state = ObjectState::PLASMA_SEALED;
+  object1_.object_info.data_size = 100;
+  object1_.allocation.address = &memory[100];
+  EXPECT_CALL(*object_store_, ForEachObject(_))
+      .Times(1)
+      .WillOnce(Invoke([this](const auto &fn) { fn(id1_, object1_); }));
+  EXPECT_CALL(*object_store_, GetObject(id1_)).WillRepeatedly(Return(&object1_));
+
+  // An object larger than the budget never fits, so it doesn't keep the next
+  // compactions looking for objects to move.
+  EXPECT_CALL(*object_store_, RelocateObject(_)).Times(0);
+  EXPECT_EQ(manager_->CompactObjects(/*max_bytes=*/60), 0);
+  EXPECT_EQ(manager_->CompactObjects(/*max_bytes=*/60), 0);
+}
+
+/// Runs an object lifecycle manager with the allocator of the store.
+class ObjectLifecycleManagerWithAllocatorTest : public Test {
+ protected:
+  explicit ObjectLifecycleManagerWithAllocatorTest(int64_t memory_bytes = 64 * kMB)
+      : backing_allocator_(plasma_directory_,
+                           fallback_directory_,
+                           /*hugepage_enabled=*/false,
+                           memory_bytes),
+        allocator_(backing_allocator_) {
+    ResetManager();
+  }
+
+  ~ObjectLifecycleManagerWithAllocatorTest() { RayConfig::instance().initialize(""); }
+
+  void TearDown() override {
+    std::filesystem::remove_all(plasma_directory_);
+    std::filesystem::remove_all(fallback_directory_);
+  }
+
+  /// Replace the manager, which must have no object left, by one with a fallback tier
+  /// of `bytes`.
+  void SetFallbackTierBytes(int64_t bytes) {
+    RayConfig::instance().initialize(
+        absl::StrFormat(R"({"plasma_fallback_tier_bytes": %d})", bytes));
+    ResetManager();
+  }
+
+  void ResetManager() {
+    manager_ = std::make_unique<ObjectLifecycleManager>(
+        allocator_, [this](const ObjectID &) { num_deleted_++; });
+  }
+
+  /// Create and seal an object filled with `value`, that a client uses.
+  ///
+  /// \return The object, or nullptr if there is no space.
+  const LocalObject *Put(const ObjectID &object_id,
+                         int64_t size,
+                         bool fallback_allocator,
+                         uint8_t value) {
+    ObjectInfo info;
+    info.object_id = object_id;
+    info.data_size = size;
+    info.metadata_size = 0;
+    auto result = manager_->CreateObject(
+        info, flatbuf::ObjectSource::CreatedByWorker, fallback_allocator);
+    if (result.first == nullptr) {
+      return nullptr;
+    }
+    RAY_CHECK(manager_->AddReference(object_id));
+    std::memset(result.first->GetAllocation().address, value, size);
+    return manager_->SealObject(object_id);
+  }
+
+  uint8_t *Data(const ObjectID &object_id) {
+    return static_cast<uint8_t *>(
+        manager_->GetObject(object_id)->GetAllocation().address);
+  }
+
+  /// Read random objects of `object_size` of a working set, 80% of the time from a
+  /// hot tenth of it. The objects that aren't in the store anymore are created again,
+  /// like objects restored from spilled copies.
+  ///
+  /// \return The fraction of the reads that found the object in the store, and the
+  /// number of reads per second.
+  std::pair<double, double> RunWorkingSet(int64_t working_set_bytes,
+                                          int64_t object_size,
+                                          int num_reads) {
+    std::mt19937 gen(42);
+    std::vector<ObjectID> object_ids;
+    for (int64_t i = 0; i < working_set_bytes / object_size; i++) {
+      object_ids.push_back(ObjectID::FromRandom());
+      RAY_CHECK(Put(object_ids.back(), object_size, /*fallback_allocator=*/false, i) !=
+                nullptr);
+      RAY_CHECK(manager_->RemoveReference(object_ids.back()));
+    }
+    std::uniform_real_distribution<double> is_hot(0, 1);
+    std::uniform_int_distribution<size_t> hot_object(0, object_ids.size() / 10 - 1);
+    std::uniform_int_distribution<size_t> any_object(0, object_ids.size() - 1);
+
+    int num_hits = 0;
+    int64_t checksum = 0;
+    int64_t start = absl::GetCurrentTimeNanos();
+    for (int i = 0; i < num_reads; i++) {
+      const size_t index = is_hot(gen) < 0.8 ? hot_object(gen) : any_object(gen);
+      const auto &object_id = object_ids[index];
+      if (manager_->GetObject(object_id) == nullptr) {
+        RAY_CHECK(Put(object_id, object_size, /*fallback_allocator=*/false, index) !=
+                  nullptr);
+      } else {
+        num_hits++;
+        RAY_CHECK(manager_->AddReference(object_id));
+      }
+      const uint8_t *data = Data(object_id);
+      for (int64_t offset = 0; offset < object_size; offset += 4096) {
+        checksum += data[offset];
+      }
+      RAY_CHECK(data[object_size - 1] == static_cast<uint8_t>(index));
+      RAY_CHECK(manager_->RemoveReference(object_id));
+      // The store promotes the objects used again periodically.
+      if (i % 10 == 0) {
+        manager_->PromoteObjects(
+            RayConfig::instance().plasma_fallback_tier_max_move_bytes());
+      }
+    }
+    const double elapsed_s = (absl::GetCurrentTimeNanos() - start) / 1e9;
+    RAY_LOG(DEBUG) << "checksum " << checksum;
+
+    for (const auto &object_id : object_ids) {
+      if (manager_->GetObject(object_id) != nullptr) {
+        RAY_CHECK(manager_->DeleteObject(object_id) == flatbuf::PlasmaError::OK);
+      }
+    }
+    EXPECT_EQ(allocator_.Allocated(), 0);
+    return {static_cast<double>(num_hits) / num_reads, num_reads / elapsed_s};
+  }
+
+  /// Removed with their files by TearDown.
+  const std::string plasma_directory_ = CreateTestDir();
+  const std::string fallback_directory_ = CreateTestDir();
+  PlasmaAllocator backing_allocator_;
+  SizeClassAllocator allocator_;
+  std::unique_ptr<ObjectLifecycleManager> manager_;
+  int num_deleted_ = 0;
+};
+
+TEST_F(ObjectLifecycleManagerWithAllocatorTest, CompactionAvoidsFallbackAllocation) {
+  // Reproduce the fallback allocations that the fragmentation of the memory causes.
+  // Fill the memory with objects in use.
+  std::vector<ObjectID> object_ids;
+  while (true) {
+    const auto object_id = ObjectID::FromRandom();
+    if (Put(object_id, kMB, /*fallback_allocator=*/false, object_ids.size()) ==
+        nullptr) {
+      break;
+    }
+    object_ids.push_back(object_id);
+  }
+  ASSERT_EQ(object_ids.size(), 63u);
+
+  // Every other object is deleted, which leaves half of the memory free in holes.
+  std::vector<ObjectID> kept_object_ids;
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    if (i % 2 == 0) {
+      kept_object_ids.push_back(object_ids[i]);
+      continue;
+    }
+    ASSERT_TRUE(manager_->RemoveReference(object_ids[i]));
+    ASSERT_EQ(manager_->DeleteObject(object_ids[i]), flatbuf::PlasmaError::OK);
+  }
+  EXPECT_EQ(allocator_.GetLargestFreeExtent(), kMB);
+
+  // A large object fits in no hole.
+  const auto large_object_id = ObjectID::FromRandom();
+  auto large_object = Put(large_object_id, 8 * kMB, /*fallback_allocator=*/true, 1);
+  ASSERT_NE(large_object, nullptr);
+  EXPECT_TRUE(large_object->GetAllocation().fallback_allocated);
+  ASSERT_TRUE(manager_->RemoveReference(large_object_id));
+  ASSERT_EQ(manager_->DeleteObject(large_object_id), flatbuf::PlasmaError::OK);
+
+  // The clients release the objects at the highest addresses, which the compaction
+  // moves into the holes.
+  for (size_t i = kept_object_ids.size() / 2; i < kept_object_ids.size(); i++) {
+    ASSERT_TRUE(manager_->RemoveReference(kept_object_ids[i]));
+  }
+  EXPECT_EQ(manager_->CompactObjects(4 * kMB), 4 * kMB);
+  EXPECT_EQ(manager_->CompactObjects(64 * kMB), 12 * kMB);
+  EXPECT_EQ(manager_->CompactObjects(64 * kMB), 0);
+  EXPECT_EQ(allocator_.GetLargestFreeExtent(), 31 * kMB);
+  for (size_t i = 0; i < kept_object_ids.size(); i++) {
+    EXPECT_EQ(Data(kept_object_ids[i])[0], static_cast<uint8_t>(2 * i));
+    EXPECT_EQ(Data(kept_object_ids[i])[kMB - 1], static_cast<uint8_t>(2 * i));
+  }
+
+  // Now the large object fits without evicting the released objects.
+  const int num_deleted = num_deleted_;
+  large_object = Put(large_object_id, 8 * kMB, /*fallback_allocator=*/true, 1);
+  ASSERT_NE(large_object, nullptr);
+  EXPECT_FALSE(large_object->GetAllocation().fallback_allocated);
+  EXPECT_EQ(num_deleted_, num_deleted);
+}
+
+TEST_F(ObjectLifecycleManagerWithAllocatorTest, FallbackTierBoundsMoves) {
+  RayConfig::instance().initialize(absl::StrFormat(
+      R"({"plasma_fallback_tier_bytes": %d, "plasma_fallback_tier_max_move_bytes": %d})",
+      4 * 64 * kMB,
+      4 * kMB));
+  ResetManager();
+  // Fill the memory with objects that no client uses.
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 63; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+    ASSERT_NE(Put(object_ids.back(), kMB, /*fallback_allocator=*/false, i), nullptr);
+    ASSERT_TRUE(manager_->RemoveReference(object_ids.back()));
+  }
+
+  // Making space for a new object demotes only 4MB of the evicted objects, and
+  // deletes the others.
+  const auto new_object_id = ObjectID::FromRandom();
+  ASSERT_NE(Put(new_object_id, kMB, /*fallback_allocator=*/false, 0), nullptr);
+  ASSERT_TRUE(manager_->RemoveReference(new_object_id));
+  std::vector<ObjectID> demoted_object_ids;
+  for (const auto &object_id : object_ids) {
+    auto object = manager_->GetObject(object_id);
+    if (object != nullptr && object->GetAllocation().fallback_allocated) {
+      demoted_object_ids.push_back(object_id);
+    }
+  }
+  EXPECT_EQ(demoted_object_ids.size(), 4u);
+  EXPECT_GT(num_deleted_, 0);
+
+  // An object used twice in the fallback tier is only promoted by PromoteObjects.
+  const auto &object_id = demoted_object_ids.front();
+  const uint8_t value = Data(object_id)[0];
+  for (int i = 0; i < 2; i++) {
+    ASSERT_TRUE(manager_->AddReference(object_id));
+    ASSERT_TRUE(manager_->RemoveReference(object_id));
+  }
+  EXPECT_TRUE(manager_->GetObject(object_id)->GetAllocation().fallback_allocated);
+  EXPECT_EQ(manager_->PromoteObjects(4 * kMB), kMB);
+  EXPECT_FALSE(manager_->GetObject(object_id)->GetAllocation().fallback_allocated);
+  EXPECT_EQ(Data(object_id)[kMB - 1], value);
+  EXPECT_EQ(manager_->PromoteObjects(4 * kMB), 0);
+}
+
+/// Runs working sets a few times larger than a small store.
+class FallbackTierWorkingSetTest : public ObjectLifecycleManagerWithAllocatorTest {
+ protected:
+  static constexpr int64_t kMemoryBytes = 8 * kMB;
+  static constexpr int64_t kObjectSize = 256 * 1024;
+
+  FallbackTierWorkingSetTest() : ObjectLifecycleManagerWithAllocatorTest(kMemoryBytes) {}
+};
+
+TEST_F(FallbackTierWorkingSetTest, FallbackTierBenchmark) {
+  const int num_reads = 2000;
+  for (int64_t memory_multiple : {2, 4}) {
+    const int64_t working_set_bytes = memory_multiple * kMemoryBytes;
+    SetFallbackTierBytes(0);
+    const auto memory_result = RunWorkingSet(working_set_bytes, kObjectSize, num_reads);
+    SetFallbackTierBytes(4 * kMemoryBytes);
+    const auto tiered_result = RunWorkingSet(working_set_bytes, kObjectSize, num_reads);
+    RAY_LOG(INFO) << "Working set of " << memory_multiple << "x the memory: "
+                  << memory_result.first * 100 << "% of the reads found the object, "
+                  << memory_result.second << " reads per second without fallback tier, "
+                  << tiered_result.first * 100 << "% and " << tiered_result.second
+                  << " with it.";
+    EXPECT_LT(memory_result.first, 1);
+    // The objects evicted from the memory are in the fallback tier.
+    EXPECT_EQ(tiered_result.first, 1);
+  }
+}
 }  // namespace plasma
 
 int main(int argc, char **argv) {
@@ -0,0 +1,239 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/size_class_allocator.h"
+
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/object_manager/plasma/plasma_allocator.h"
+
+using namespace std::filesystem;
+
+namespace plasma {
+namespace {
+const int64_t kKB = 1024;
+const int64_t kMB = 1024 * 1024;
+std::string CreateTestDir() {
+  path directory = std::filesystem::temp_directory_path() / GenerateUUIDV4();
+  create_directories(directory);
+  return directory.string();
+}
+};  // namespace
+
+class SizeClassAllocatorTest : public ::testing::Test {
+ protected:
+  SizeClassAllocatorTest()
+      : backing_allocator_(CreateTestDir(),
+                           CreateTestDir(),
+                           /*hugepage_enabled=*/false,
+                           64 * kMB) {}
+
+  /// Create objects of random sizes, mostly small ones, and delete random objects to
+  /// keep the allocated bytes under 3/4 of the footprint limit. Objects that don't fit
+  /// in the primary memory are fallback allocated.
+  ///
+  /// \return The fraction of the objects that were fallback allocated, and the number
+  /// of objects created per second.
+  static std::pair<double, double> RunChurn(IAllocator &allocator, int num_objects) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> is_large(0, 1);
+    std::uniform_int_distribution<int64_t> small_size(64, 64 * kKB);
+    std::uniform_int_distribution<int64_t> large_size(256 * kKB, 4 * kMB);
+    const int64_t max_allocated = allocator.GetFootprintLimit() * 3 / 4;
+
+    std::vector<Allocation> allocations;
+    int num_fallbacks = 0;
+    int64_t start = absl::GetCurrentTimeNanos();
+    for (int i = 0; i < num_objects; i++) {
+      const int64_t size = is_large(gen) < 0.2 ? large_size(gen) : small_size(gen);
+      while (!allocations.empty() && allocator.Allocated() + size > max_allocated) {
+        std::uniform_int_distribution<size_t> victim(0, allocations.size() - 1);
+        std::swap(allocations[victim(gen)], allocations.back());
+        allocator.Free(std::move(allocations.back()));
+        allocations.pop_back();
+      }
+      auto allocation = allocator.Allocate(size);
+      if (!allocation.has_value()) {
+        num_fallbacks++;
+        allocation = allocator.FallbackAllocate(size);
+        RAY_CHECK(allocation.has_value());
+      }
+      allocations.push_back(std::move(*allocation));
+    }
+    for (auto &allocation : allocations) {
+      allocator.Free(std::move(allocation));
+    }
+    const double elapsed_s = (absl::GetCurrentTimeNanos() - start) / 1e9;
+    EXPECT_EQ(allocator.Allocated(), 0);
+    EXPECT_EQ(allocator.FallbackAllocated(), 0);
+    return {static_cast<double>(num_fallbacks) / num_objects, num_objects / elapsed_s};
+  }
+
+  PlasmaAllocator backing_allocator_;
+};
+
+TEST_F(SizeClassAllocatorTest, TestAllocateAndFree) {
+  SizeClassAllocator allocator(backing_allocator_);
+  EXPECT_EQ(allocator.GetFootprintLimit(), 64 * kMB);
+  const auto empty_stats = allocator.GetFragmentationStats();
+  EXPECT_GT(empty_stats.largest_free_extent, 62 * kMB);
+  EXPECT_EQ(empty_stats.largest_free_extent, empty_stats.free_extent_bytes);
+
+  auto small_1 = allocator.Allocate(100);
+  auto small_2 = allocator.Allocate(100);
+  auto large = allocator.Allocate(kMB + 1);
+  ASSERT_TRUE(small_1.has_value());
+  ASSERT_TRUE(small_2.has_value());
+  ASSERT_TRUE(large.has_value());
+  EXPECT_EQ(small_1->size, 100);
+  EXPECT_EQ(large->size, kMB + 1);
+  EXPECT_FALSE(large->fallback_allocated);
+  // The objects are in the same memory mapped file.
+  EXPECT_EQ(small_1->fd, large->fd);
+  EXPECT_EQ(small_1->mmap_size, large->mmap_size);
+  EXPECT_EQ(small_1->offset % 64, 0);
+  EXPECT_EQ(small_2->offset - small_1->offset, 128);
+  EXPECT_EQ(static_cast<uint8_t *>(small_2->address) -
+                static_cast<uint8_t *>(small_1->address),
+            128);
+  EXPECT_EQ(large->offset % SizeClassAllocator::kPageSize, 0);
+  EXPECT_EQ(allocator.Allocated(), 200 + kMB + 1);
+  EXPECT_EQ(allocator.GetFragmentationStats().num_slabs, 1);
+
+  allocator.Free(std::move(*small_1));
+  allocator.Free(std::move(*large));
+  EXPECT_EQ(allocator.Allocated(), 100);
+  // The freed slot is reused.
+  auto small_3 = allocator.Allocate(128);
+  ASSERT_TRUE(small_3.has_value());
+  EXPECT_EQ(small_3->address, static_cast<uint8_t *>(small_2->address) - 128);
+  allocator.Free(std::move(*small_2));
+  allocator.Free(std::move(*small_3));
+
+  // The empty slab and the extents are coalesced back.
+  EXPECT_EQ(allocator.Allocated(), 0);
+  const auto stats = allocator.GetFragmentationStats();
+  EXPECT_EQ(stats.num_slabs, 0);
+  EXPECT_EQ(stats.largest_free_extent, empty_stats.largest_free_extent);
+  EXPECT_EQ(stats.free_extent_histogram, empty_stats.free_extent_histogram);
+}
+
+TEST_F(SizeClassAllocatorTest, TestCoalescing) {
+  SizeClassAllocator allocator(backing_allocator_);
+  const int64_t free_bytes = allocator.GetFragmentationStats().free_extent_bytes;
+  std::vector<Allocation> allocations;
+  for (int i = 0; i < 4; i++) {
+    auto allocation = allocator.Allocate(4 * kMB);
+    ASSERT_TRUE(allocation.has_value());
+    allocations.push_back(std::move(*allocation));
+  }
+
+  const int64_t first_offset = allocations[0].offset;
+  allocator.Free(std::move(allocations[0]));
+  allocator.Free(std::move(allocations[2]));
+  auto stats = allocator.GetFragmentationStats();
+  EXPECT_EQ(stats.free_extent_bytes, free_bytes - 8 * kMB);
+  EXPECT_EQ(stats.largest_free_extent, free_bytes - 16 * kMB);
+  // 2 free extents of 1024 pages.
+  EXPECT_EQ(stats.free_extent_histogram[10], 2);
+  EXPECT_GT(stats.ExternalFragmentation(), 0);
+
+  // The best fit is one of the holes, not the large free extent.
+  auto allocation = allocator.Allocate(3 * kMB);
+  ASSERT_TRUE(allocation.has_value());
+  EXPECT_EQ(allocation->offset, first_offset);
+  allocator.Free(std::move(*allocation));
+
+  allocator.Free(std::move(allocations[1]));
+  allocator.Free(std::move(allocations[3]));
+  stats = allocator.GetFragmentationStats();
+  EXPECT_EQ(stats.largest_free_extent, free_bytes);
+  EXPECT_EQ(stats.ExternalFragmentation(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, TestSmallObjectsDontFragmentLargeOnes) {
+  SizeClassAllocator allocator(backing_allocator_);
+  // Interleave small and large objects until the memory is full.
+  std::vector<Allocation> small_allocations;
+  std::vector<Allocation> large_allocations;
+  while (true) {
+    auto small_allocation = allocator.Allocate(10 * kKB);
+    auto large_allocation = allocator.Allocate(kMB);
+    if (!small_allocation.has_value() || !large_allocation.has_value()) {
+      if (small_allocation.has_value()) {
+        small_allocations.push_back(std::move(*small_allocation));
+      }
+      if (large_allocation.has_value()) {
+        large_allocations.push_back(std::move(*large_allocation));
+      }
+      break;
+    }
+    small_allocations.push_back(std::move(*small_allocation));
+    large_allocations.push_back(std::move(*large_allocation));
+  }
+  ASSERT_GT(large_allocations.size(), 50u);
+
+  // Once the large objects are freed, their space is one extent.
+  const int64_t num_large_allocations = large_allocations.size();
+  for (auto &allocation : large_allocations) {
+    allocator.Free(std::move(allocation));
+  }
+  auto allocation = allocator.Allocate(num_large_allocations * kMB);
+  ASSERT_TRUE(allocation.has_value());
+  EXPECT_FALSE(allocation->fallback_allocated);
+  allocator.Free(std::move(*allocation));
+
+  for (auto &small_allocation : small_allocations) {
+    allocator.Free(std::move(small_allocation));
+  }
+  EXPECT_EQ(allocator.Allocated(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, TestFallbackAllocate) {
+  SizeClassAllocator allocator(backing_allocator_);
+  auto allocation = allocator.Allocate(60 * kMB);
+  ASSERT_TRUE(allocation.has_value());
+  EXPECT_FALSE(allocator.Allocate(8 * kMB).has_value());
+
+  auto fallback_allocation = allocator.FallbackAllocate(8 * kMB);
+  ASSERT_TRUE(fallback_allocation.has_value());
+  EXPECT_TRUE(fallback_allocation->fallback_allocated);
+  EXPECT_EQ(allocator.Allocated(), 68 * kMB);
+  EXPECT_EQ(allocator.FallbackAllocated(), 8 * kMB);
+
+  allocator.Free(std::move(*fallback_allocation));
+  allocator.Free(std::move(*allocation));
+  EXPECT_EQ(allocator.Allocated(), 0);
+  EXPECT_EQ(allocator.FallbackAllocated(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, ChurnBenchmark) {
+  const int num_objects = 20000;
+  const auto dlmalloc_result = RunChurn(backing_allocator_, num_objects);
+  RAY_LOG(INFO) << "dlmalloc: " << dlmalloc_result.first * 100
+                << "% of the objects fallback allocated, " << dlmalloc_result.second
+                << " objects per second.";
+  SizeClassAllocator allocator(backing_allocator_);
+  const auto size_class_result = RunChurn(allocator, num_objects);
+  RAY_LOG(INFO) << "Size classes: " << size_class_result.first * 100
+                << "% of the objects fallback allocated, " << size_class_result.second
+                << " objects per second.";
+}
+
+}  // namespace plasma
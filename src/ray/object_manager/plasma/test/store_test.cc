@@ -0,0 +1,283 @@
+// Copyright 2017 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/store.h"
+
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/object_manager/plasma/client.h"
+#include "ray/object_manager/plasma/plasma_allocator.h"
+
+using namespace std::filesystem;
+
+namespace plasma {
+namespace {
+const int64_t kMB = 1024 * 1024;
+std::string CreateTestDir() {
+  path directory = std::filesystem::temp_directory_path() / GenerateUUIDV4();
+  create_directories(directory);
+  return directory.string();
+}
+};  // namespace
+
+/// A plasma store served on its own thread.
+class TestStore {
+ public:
+  TestStore(IAllocator &allocator, uint32_t num_client_threads)
+      : socket_name_((path(CreateTestDir()) / "store").string()),
+        store_(
+            io_context_,
+            allocator,
+            fs_monitor_,
+            socket_name_,
+            /*delay_on_oom_ms=*/10,
+            /*object_spilling_threshold=*/1.0,
+            num_client_threads,
+            /*spill_objects_callback=*/[]() { return false; },
+            /*object_store_full_callback=*/[]() {},
+            [this](const ray::ObjectInfo &) { num_sealed_++; },
+            [this](const ObjectID &) { num_deleted_++; }) {
+    store_.Start();
+    thread_ = std::thread([this]() {
+      boost::asio::io_service::work work(io_context_);
+      io_context_.run();
+    });
+  }
+
+  ~TestStore() {
+    store_.Stop();
+    io_context_.stop();
+    thread_.join();
+  }
+
+  const std::string &SocketName() const { return socket_name_; }
+  int NumSealed() const { return num_sealed_; }
+  int NumDeleted() const { return num_deleted_; }
+
+  /// Wait until the store deleted `num_deleted` objects.
+  bool WaitForNumDeleted(int num_deleted) {
+    for (int i = 0; i < 1000 && num_deleted_ < num_deleted; i++) {
+      absl::SleepFor(absl::Milliseconds(5));
+    }
+    return num_deleted_ == num_deleted;
+  }
+
+ private:
+  instrumented_io_context io_context_;
+  ray::FileSystemMonitor fs_monitor_;
+  const std::string socket_name_;
+  std::atomic<int> num_sealed_ = 0;
+  std::atomic<int> num_deleted_ = 0;
+  PlasmaStore store_;
+  std::thread thread_;
+};
+
+class PlasmaStoreTest : public ::testing::Test {
+ protected:
+  PlasmaStoreTest()
+      : allocator_(CreateTestDir(),
+                   CreateTestDir(),
+                   /*hugepage_enabled=*/false,
+                   256 * kMB) {}
+
+  ~PlasmaStoreTest() { RayConfig::instance().initialize(""); }
+
+  void SetObjectIndexNumSlots(int64_t num_slots) {
+    RayConfig::instance().initialize(
+        absl::StrFormat(R"({"plasma_object_index_num_slots": %d})", num_slots));
+  }
+
+  /// Create and seal an object holding `value`, and release it.
+  static void Put(PlasmaClient &client, const ObjectID &object_id, uint8_t value) {
+    std::shared_ptr<Buffer> data;
+    RAY_CHECK_OK(client.CreateAndSpillIfNeeded(object_id,
+                                               ray::rpc::Address(),
+                                               /*data_size=*/1024,
+                                               /*metadata=*/nullptr,
+                                               /*metadata_size=*/0,
+                                               &data,
+                                               flatbuf::ObjectSource::CreatedByWorker));
+    std::memset(data->Data(), value, data->Size());
+    RAY_CHECK_OK(client.Seal(object_id));
+    RAY_CHECK_OK(client.Release(object_id));
+  }
+
+  /// Run a store served by `num_client_threads` threads, and `num_clients` clients
+  /// that each create, seal, get and delete `num_objects` objects.
+  ///
+  /// \return The number of objects processed per second.
+  double RunClients(uint32_t num_client_threads, int num_clients, int num_objects) {
+    double elapsed_s;
+    {
+      TestStore store(allocator_, num_client_threads);
+      int64_t start = absl::GetCurrentTimeNanos();
+      std::vector<std::thread> clients;
+      for (int i = 0; i < num_clients; i++) {
+        clients.emplace_back([&store, num_objects]() {
+          PlasmaClient client;
+          RAY_CHECK_OK(client.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+          for (int j = 0; j < num_objects; j++) {
+            const auto object_id = ObjectID::FromRandom();
+            Put(client, object_id, j % 256);
+
+            std::vector<ObjectBuffer> object_buffers;
+            RAY_CHECK_OK(client.Get({object_id}, -1, &object_buffers, true));
+            RAY_CHECK(object_buffers[0].data != nullptr);
+            RAY_CHECK(object_buffers[0].data->Size() == 1024);
+            RAY_CHECK_OK(client.Release(object_id));
+            RAY_CHECK_OK(client.Delete({object_id}));
+          }
+          RAY_CHECK_OK(client.Disconnect());
+        });
+      }
+      for (auto &client : clients) {
+        client.join();
+      }
+      elapsed_s = (absl::GetCurrentTimeNanos() - start) / 1e9;
+
+      EXPECT_EQ(store.NumSealed(), num_clients * num_objects);
+      EXPECT_EQ(store.NumDeleted(), num_clients * num_objects);
+    }
+    EXPECT_EQ(allocator_.Allocated(), 0);
+    return num_clients * num_objects / elapsed_s;
+  }
+
+  /// Measure the latency of getting and releasing an object that another client, like
+  /// the raylet for primary copies, has in use.
+  ///
+  /// \return The mean latency of a Get and Release pair in nanoseconds.
+  double GetReleaseLatencyNs(int num_iterations) {
+    TestStore store(allocator_, /*num_client_threads=*/1);
+    PlasmaClient owner;
+    PlasmaClient client;
+    RAY_CHECK_OK(owner.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+    RAY_CHECK_OK(client.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+    const auto object_id = ObjectID::FromRandom();
+    Put(owner, object_id, 1);
+    std::vector<ObjectBuffer> owner_buffers;
+    RAY_CHECK_OK(owner.Get({object_id}, -1, &owner_buffers, false));
+
+    int64_t start = 0;
+    // The first iteration maps the memory of the store.
+    for (int i = -1; i < num_iterations; i++) {
+      if (i == 0) {
+        start = absl::GetCurrentTimeNanos();
+      }
+      std::vector<ObjectBuffer> object_buffers;
+      RAY_CHECK_OK(client.Get({object_id}, -1, &object_buffers, true));
+      RAY_CHECK(object_buffers[0].data->Data()[0] == 1);
+      object_buffers.clear();
+      // The buffers released the object.
+      RAY_CHECK(!client.IsInUse(object_id));
+    }
+    const double latency_ns =
+        static_cast<double>(absl::GetCurrentTimeNanos() - start) / num_iterations;
+
+    owner_buffers.clear();
+    RAY_CHECK_OK(owner.Delete({object_id}));
+    EXPECT_TRUE(store.WaitForNumDeleted(1));
+    RAY_CHECK_OK(client.Disconnect());
+    RAY_CHECK_OK(owner.Disconnect());
+    return latency_ns;
+  }
+
+  PlasmaAllocator allocator_;
+};
+
+TEST_F(PlasmaStoreTest, ManyClientsBenchmark) {
+  const int num_clients = 64;
+  const int num_objects = 200;
+  for (uint32_t num_client_threads : {1, 2, 4, 8}) {
+    double objects_per_s = RunClients(num_client_threads, num_clients, num_objects);
+    RAY_LOG(INFO) << num_clients << " clients, " << num_client_threads
+                  << " client threads: " << objects_per_s
+                  << " objects created, sealed, gotten and deleted per second.";
+  }
+}
+
+TEST_F(PlasmaStoreTest, ObjectIndexGetReleaseBenchmark) {
+  const int num_iterations = 20000;
+  for (int64_t num_slots : {0, 65536}) {
+    SetObjectIndexNumSlots(num_slots);
+    double latency_ns = GetReleaseLatencyNs(num_iterations);
+    RAY_LOG(INFO) << "Object index " << (num_slots > 0 ? "enabled" : "disabled")
+                  << ": " << latency_ns << "ns per Get and Release.";
+  }
+  EXPECT_EQ(allocator_.Allocated(), 0);
+}
+
+TEST_F(PlasmaStoreTest, ObjectIndexKeepsPinnedObjects) {
+  SetObjectIndexNumSlots(1024);
+  TestStore store(allocator_, /*num_client_threads=*/1);
+  PlasmaClient owner;
+  PlasmaClient client;
+  RAY_CHECK_OK(owner.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+  RAY_CHECK_OK(client.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+  const auto object_id = ObjectID::FromRandom();
+  Put(owner, object_id, 7);
+  std::vector<ObjectBuffer> owner_buffers;
+  RAY_CHECK_OK(owner.Get({object_id}, -1, &owner_buffers, false));
+  // Map the memory of the store, then pin the object through the index.
+  std::vector<ObjectBuffer> object_buffers;
+  RAY_CHECK_OK(client.Get({object_id}, -1, &object_buffers, true));
+  object_buffers.clear();
+  RAY_CHECK_OK(client.Get({object_id}, -1, &object_buffers, true));
+
+  // The owner deletes the object while the client still pins it.
+  owner_buffers.clear();
+  RAY_CHECK_OK(owner.Delete({object_id}));
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_EQ(store.NumDeleted(), 0);
+  EXPECT_EQ(object_buffers[0].data->Data()[0], 7);
+  EXPECT_EQ(object_buffers[0].data->Data()[1023], 7);
+
+  object_buffers.clear();
+  EXPECT_TRUE(store.WaitForNumDeleted(1));
+  RAY_CHECK_OK(client.Disconnect());
+  RAY_CHECK_OK(owner.Disconnect());
+}
+
+TEST_F(PlasmaStoreTest, ObjectIndexDropsPinsOfDisconnectedClients) {
+  SetObjectIndexNumSlots(1024);
+  TestStore store(allocator_, /*num_client_threads=*/1);
+  PlasmaClient owner;
+  RAY_CHECK_OK(owner.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+  const auto object_id = ObjectID::FromRandom();
+  Put(owner, object_id, 7);
+  std::vector<ObjectBuffer> owner_buffers;
+  RAY_CHECK_OK(owner.Get({object_id}, -1, &owner_buffers, false));
+
+  std::vector<ObjectBuffer> object_buffers;
+  {
+    PlasmaClient client;
+    RAY_CHECK_OK(client.Connect(store.SocketName(), "", 0, /*num_retries=*/50));
+    RAY_CHECK_OK(client.Get({object_id}, -1, &object_buffers, true));
+    object_buffers.clear();
+    RAY_CHECK_OK(client.Get({object_id}, -1, &object_buffers, true));
+    // Disconnect without releasing, like a crashed client.
+    RAY_CHECK_OK(client.Disconnect());
+  }
+
+  owner_buffers.clear();
+  RAY_CHECK_OK(owner.Delete({object_id}));
+  EXPECT_TRUE(store.WaitForNumDeleted(1));
+  RAY_CHECK_OK(owner.Disconnect());
+}
+
+}  // namespace plasma
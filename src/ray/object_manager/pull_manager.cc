@@ -90,9 +90,11 @@ uint64_t PullManager::Pull(const std::vector<rpc::ObjectReference> &object_ref_b
     get_request_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
   } else if (prio == BundlePriority::WAIT_REQUEST) {
     wait_request_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
-  } else {
-    RAY_CHECK(prio == BundlePriority::TASK_ARGS);
+  } else if (prio == BundlePriority::TASK_ARGS) {
     task_argument_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
+  } else {
+    RAY_CHECK(prio == BundlePriority::PREFETCH);
+    prefetch_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
   }
 
   // We have a new request. Activate the new request, if the
@@ -132,8 +134,21 @@ bool PullManager::ActivateNextBundlePullRequest(BundlePullRequestQueue &bundles,
       }
     }
 
-    // Quota check.
-    if (respect_quota && num_active_bundles_ >= 1 && bytes_to_pull > RemainingQuota()) {
+    // Quota check. Prefetches must fit in the remaining memory and in the
+    // prefetch quota. Other requests may take the memory used by prefetches,
+    // which are deactivated afterwards if we end up over quota.
+    const bool is_prefetch = &bundles == &prefetch_bundles_;
+    if (is_prefetch) {
+      if (bytes_to_pull > RemainingQuota() ||
+          num_bytes_being_prefetched_ + bytes_to_pull > PrefetchQuota()) {
+        RAY_LOG(DEBUG) << "Prefetch bundle would exceed quota: bytes_to_pull("
+                       << bytes_to_pull << "), remaining quota(" << RemainingQuota()
+                       << "), num_bytes_being_prefetched(" << num_bytes_being_prefetched_
+                       << "), prefetch quota(" << PrefetchQuota() << ")";
+        return false;
+      }
+    } else if (respect_quota && num_active_bundles_ >= 1 &&
+               bytes_to_pull > RemainingQuota() + num_bytes_being_prefetched_) {
       RAY_LOG(DEBUG) << "Bundle would exceed quota: "
                      << "num_bytes_being_pulled(" << num_bytes_being_pulled_
                      << ") + "
@@ -165,11 +180,18 @@ bool PullManager::ActivateNextBundlePullRequest(BundlePullRequestQueue &bundles,
         ResetRetryTimer(obj_id);
       }
     }
+
+    if (is_prefetch) {
+      prefetch_bytes_by_request_[next_request_id] = bytes_to_pull;
+      num_bytes_being_prefetched_ += bytes_to_pull;
+    }
   }
 
   bundles.ActivateBundlePullRequest(next_request_id);
 
-  num_active_bundles_ += 1;
+  if (&bundles != &prefetch_bundles_) {
+    num_active_bundles_ += 1;
+  }
   return true;
 }
 
@@ -196,7 +218,14 @@ void PullManager::DeactivateBundlePullRequest(
   }
 
   bundles.DeactivateBundlePullRequest(request_id);
-  num_active_bundles_ -= 1;
+  if (&bundles == &prefetch_bundles_) {
+    auto it = prefetch_bytes_by_request_.find(request_id);
+    RAY_CHECK(it != prefetch_bytes_by_request_.end());
+    num_bytes_being_prefetched_ -= it->second;
+    prefetch_bytes_by_request_.erase(it);
+  } else {
+    num_active_bundles_ -= 1;
+  }
 }
 
 void PullManager::DeactivateUntilMarginAvailable(
@@ -206,7 +235,9 @@ void PullManager::DeactivateUntilMarginAvailable(
     int64_t quota_margin,
     std::unordered_set<ObjectID> *object_ids_to_cancel) {
   while (RemainingQuota() < quota_margin && !bundles.active_requests.empty()) {
-    if (num_active_bundles_ <= retain_min) {
+    // Prefetch bundles are not counted as active bundles, so they can always
+    // be deactivated.
+    if (&bundles != &prefetch_bundles_ && num_active_bundles_ <= retain_min) {
       return;
     }
     const uint64_t request_id = *(bundles.active_requests.rbegin());
@@ -225,6 +256,12 @@ int64_t PullManager::RemainingQuota() {
 
 bool PullManager::OverQuota() { return RemainingQuota() < 0L; }
 
+int64_t PullManager::PrefetchQuota() const {
+  return static_cast<int64_t>(
+      num_bytes_available_ *
+      RayConfig::instance().prefetch_queued_task_args_max_fraction());
+}
+
 void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available) {
   if (num_bytes_available_ != num_bytes_available) {
     RAY_LOG(DEBUG) << "Updating pulls based on available memory: " << num_bytes_available;
@@ -241,6 +278,11 @@ void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available)
   bool get_requests_remaining = !get_request_bundles_.inactive_requests.empty();
   while (get_requests_remaining) {
     const int64_t margin_required = NextRequestBundleSize(get_request_bundles_);
+    DeactivateUntilMarginAvailable("prefetch request",
+                                   prefetch_bundles_,
+                                   /*retain_min=*/0,
+                                   /*quota_margin=*/margin_required,
+                                   &object_ids_to_cancel);
     DeactivateUntilMarginAvailable("task args request",
                                    task_argument_bundles_,
                                    /*retain_min=*/0,
@@ -262,6 +304,11 @@ void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available)
   bool wait_requests_remaining = !wait_request_bundles_.inactive_requests.empty();
   while (wait_requests_remaining) {
     const int64_t margin_required = NextRequestBundleSize(wait_request_bundles_);
+    DeactivateUntilMarginAvailable("prefetch request",
+                                   prefetch_bundles_,
+                                   /*retain_min=*/0,
+                                   /*quota_margin=*/margin_required,
+                                   &object_ids_to_cancel);
     DeactivateUntilMarginAvailable("task args request",
                                    task_argument_bundles_,
                                    /*retain_min=*/0,
@@ -281,7 +328,18 @@ void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available)
                                        &objects_to_pull)) {
   }
 
+  // Prefetch requests only use the memory that is left over.
+  while (ActivateNextBundlePullRequest(prefetch_bundles_,
+                                       /*respect_quota=*/true,
+                                       &objects_to_pull)) {
+  }
+
   // While we are over capacity, deactivate requests starting from the back of the queues.
+  DeactivateUntilMarginAvailable("prefetch request",
+                                 prefetch_bundles_,
+                                 /*retain_min=*/0,
+                                 /*quota_margin=*/0L,
+                                 &object_ids_to_cancel);
   DeactivateUntilMarginAvailable("task args request",
                                  task_argument_bundles_,
                                  /*retain_min=*/1,
@@ -640,9 +698,11 @@ const PullManager::BundlePullRequestQueue &PullManager::GetBundlePullRequestQueu
     return get_request_bundles_;
   } else if (wait_request_bundles_.requests.contains(request_id)) {
     return wait_request_bundles_;
-  } else {
-    RAY_CHECK(task_argument_bundles_.requests.contains(request_id));
+  } else if (task_argument_bundles_.requests.contains(request_id)) {
     return task_argument_bundles_;
+  } else {
+    RAY_CHECK(prefetch_bundles_.requests.contains(request_id));
+    return prefetch_bundles_;
   }
 }
 
@@ -724,12 +784,16 @@ void PullManager::RecordMetrics() const {
   ray::stats::STATS_pull_manager_usage_bytes.Record(num_bytes_being_pulled_,
                                                     "BeingPulled");
   ray::stats::STATS_pull_manager_usage_bytes.Record(pinned_objects_size_, "Pinned");
+  ray::stats::STATS_pull_manager_usage_bytes.Record(num_bytes_being_prefetched_,
+                                                    "BeingPrefetched");
   ray::stats::STATS_pull_manager_requested_bundles.Record(
       get_request_bundles_.requests.size(), "Get");
   ray::stats::STATS_pull_manager_requested_bundles.Record(
       wait_request_bundles_.requests.size(), "Wait");
   ray::stats::STATS_pull_manager_requested_bundles.Record(
       task_argument_bundles_.requests.size(), "TaskArgs");
+  ray::stats::STATS_pull_manager_requested_bundles.Record(
+      prefetch_bundles_.requests.size(), "Prefetch");
   ray::stats::STATS_pull_manager_requested_bundles.Record(next_req_id_,
                                                           "CumulativeTotal");
   ray::stats::STATS_pull_manager_requests.Record(object_pull_requests_.size(), "Queued");
@@ -756,6 +820,8 @@ std::string PullManager::DebugString() const {
   result << "\n- get request bundles: " << get_request_bundles_.DebugString();
   result << "\n- wait request bundles: " << wait_request_bundles_.DebugString();
   result << "\n- task request bundles: " << task_argument_bundles_.DebugString();
+  result << "\n- prefetch request bundles: " << prefetch_bundles_.DebugString();
+  result << "\n- num bytes being prefetched: " << num_bytes_being_prefetched_;
   result << "\n- first get request bundle: " << BundleInfo(get_request_bundles_);
   result << "\n- first wait request bundle: " << BundleInfo(wait_request_bundles_);
   result << "\n- first task request bundle: " << BundleInfo(task_argument_bundles_);
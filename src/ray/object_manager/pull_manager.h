@@ -46,6 +46,9 @@ enum BundlePriority {
   WAIT_REQUEST,
   /// Bundle requested for fetching task arguments.
   TASK_ARGS,
+  /// Bundle requested speculatively for the arguments of tasks that are queued
+  /// but not yet scheduled. These only use memory that no other bundle needs.
+  PREFETCH,
 };
 
 // Not thread-safe except for IsObjectActive().
@@ -174,6 +177,9 @@ class PullManager {
 
   void SetOutOfDisk(const ObjectID &object_id);
 
+  /// Returns the number of bytes that prefetch bundles may use for active pulls.
+  int64_t PrefetchQuota() const;
+
   int64_t NumInactivePulls(const TaskMetricsKey &task_key) const {
     return task_argument_bundles_.inactive_by_name.Get(task_key);
   }
@@ -464,6 +470,16 @@ class PullManager {
   BundlePullRequestQueue wait_request_bundles_;
   /// Bundle pull requests of arguments of queued tasks.
   BundlePullRequestQueue task_argument_bundles_;
+  /// Bundle pull requests of arguments of tasks that are not scheduled yet.
+  /// These are activated last, only within the remaining memory and the
+  /// prefetch quota, and are deactivated first. Other requests may count the
+  /// bytes of active prefetches as available.
+  BundlePullRequestQueue prefetch_bundles_;
+
+  /// The number of bytes that each active prefetch bundle started pulling when
+  /// it was activated, and their total.
+  absl::flat_hash_map<uint64_t, int64_t> prefetch_bytes_by_request_;
+  int64_t num_bytes_being_prefetched_ = 0;
 
   /// The total number of bytes that we are currently pulling. This is the
   /// total size of the objects requested that we are actively pulling. To
@@ -475,7 +491,7 @@ class PullManager {
   /// pulling.
   int64_t num_bytes_available_;
 
-  /// The number of currently active bundles.
+  /// The number of currently active bundles, not counting prefetch bundles.
   int64_t num_active_bundles_ = 0;
 
   /// Callback to pin plasma objects.
@@ -14,6 +14,12 @@
 
 #include "ray/object_manager/spilled_object_reader.h"
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <fstream>
 #include <regex>
 
@@ -179,4 +185,33 @@ bool SpilledObjectReader::ReadFromMetadataSection(uint64_t offset,
   std::ifstream is(file_path_, std::ios::binary);
   return is.seekg(metadata_offset_ + offset) && is.read(output, size);
 }
+
+void SpilledObjectReader::ReadAhead(uint64_t offset, uint64_t size) const {
+#ifdef __linux__
+  const uint64_t end = std::min(offset + size, data_size_ + metadata_size_);
+  if (offset >= end) {
+    return;
+  }
+  int fd = open(file_path_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  // The kernel loads the pages in the background, so the reads that follow hit
+  // the page cache instead of waiting on the disk.
+  if (offset < data_size_) {
+    posix_fadvise(fd,
+                  data_offset_ + offset,
+                  std::min(end, data_size_) - offset,
+                  POSIX_FADV_WILLNEED);
+  }
+  if (end > data_size_) {
+    const uint64_t metadata_start = std::max(offset, data_size_) - data_size_;
+    posix_fadvise(fd,
+                  metadata_offset_ + metadata_start,
+                  end - data_size_ - metadata_start,
+                  POSIX_FADV_WILLNEED);
+  }
+  close(fd);
+#endif
+}
 }  // namespace ray
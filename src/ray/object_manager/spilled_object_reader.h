@@ -45,6 +45,8 @@ class SpilledObjectReader : public IObjectReader {
                                uint64_t size,
                                char *output) const override;
 
+  void ReadAhead(uint64_t offset, uint64_t size) const override;
+
  private:
   SpilledObjectReader(std::string file_path,
                       uint64_t total_size,
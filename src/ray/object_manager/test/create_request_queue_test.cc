@@ -183,7 +183,7 @@ TEST_F(CreateRequestQueueTest, TestFallbackAllocator) {
 
 TEST(CreateRequestQueueParameterTest, TestOomInfiniteRetry) {
   int num_global_gc_ = 0;
-  int64_t current_time_ns;
+  int64_t current_time_ns = 0;
   ray::FileSystemMonitor monitor{{"/"}, 1};
   CreateRequestQueue queue(
       monitor,
@@ -524,6 +524,188 @@ TEST_F(CreateRequestQueueTest, TestFallbackAllocationFailled) {
   AssertNoLeaks();
 }
 
+TEST_F(CreateRequestQueueTest, TestPriorityOrder) {
+  std::vector<int> created;
+  auto request = [&](int i) {
+    return [&created, i](bool fallback, PlasmaObject *result, bool *spill_requested) {
+      created.push_back(i);
+      result->data_size = 1234;
+      return PlasmaError::OK;
+    };
+  };
+
+  auto client = std::make_shared<MockClient>();
+  std::vector<uint64_t> req_ids;
+  req_ids.push_back(queue_.AddRequest(
+      ObjectID::Nil(), client, request(0), 1234, flatbuf::CreatePriority::PulledObject));
+  req_ids.push_back(queue_.AddRequest(ObjectID::Nil(),
+                                      client,
+                                      request(1),
+                                      1234,
+                                      flatbuf::CreatePriority::RestoredObject));
+  req_ids.push_back(queue_.AddRequest(
+      ObjectID::Nil(), client, request(2), 1234, flatbuf::CreatePriority::Put));
+  req_ids.push_back(queue_.AddRequest(
+      ObjectID::Nil(), client, request(3), 1234, flatbuf::CreatePriority::TaskReturn));
+  // Within a class, the requests with a deadline go first, then by arrival.
+  req_ids.push_back(queue_.AddRequest(
+      ObjectID::Nil(), client, request(4), 1234, flatbuf::CreatePriority::Put));
+  req_ids.push_back(queue_.AddRequest(ObjectID::Nil(),
+                                      client,
+                                      request(5),
+                                      1234,
+                                      flatbuf::CreatePriority::Put,
+                                      /*deadline_ms=*/1000));
+
+  ASSERT_TRUE(queue_.ProcessRequests().ok());
+  ASSERT_EQ(created, std::vector<int>({3, 5, 2, 4, 1, 0}));
+  for (auto req_id : req_ids) {
+    ASSERT_REQUEST_FINISHED(queue_, req_id, PlasmaError::OK);
+  }
+  AssertNoLeaks();
+}
+
+TEST_F(CreateRequestQueueTest, TestSmallRequestsBypassBlockedHead) {
+  auto oom_request = [&](bool fallback, PlasmaObject *result, bool *spill_requested) {
+    return PlasmaError::OutOfMemory;
+  };
+  auto request = [&](bool fallback, PlasmaObject *result, bool *spill_requested) {
+    result->data_size = 1234;
+    return PlasmaError::OK;
+  };
+
+  // A large object blocks the head of the queue until the grace period is over.
+  auto client = std::make_shared<MockClient>();
+  auto large_req_id = queue_.AddRequest(
+      ObjectID::Nil(), client, oom_request, 1000 * 1234, flatbuf::CreatePriority::Put);
+  auto small_put_req_id = queue_.AddRequest(
+      ObjectID::Nil(), client, request, 1234, flatbuf::CreatePriority::Put);
+  auto larger_put_req_id = queue_.AddRequest(
+      ObjectID::Nil(), client, request, 2000 * 1234, flatbuf::CreatePriority::Put);
+  auto small_pull_req_id = queue_.AddRequest(
+      ObjectID::Nil(), client, request, 1234, flatbuf::CreatePriority::PulledObject);
+
+  // The smaller request of the same class is served behind the blocked head. The
+  // larger request and the request of a lower class wait for the head.
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_UNFINISHED(queue_, large_req_id);
+  ASSERT_REQUEST_FINISHED(queue_, small_put_req_id, PlasmaError::OK);
+  ASSERT_REQUEST_UNFINISHED(queue_, larger_put_req_id);
+  ASSERT_REQUEST_UNFINISHED(queue_, small_pull_req_id);
+
+  // Task returns are queued ahead of the blocked put, and served even if the head of
+  // the queue is still blocked.
+  auto task_return_req_id = queue_.AddRequest(
+      ObjectID::Nil(), client, request, 1234, flatbuf::CreatePriority::TaskReturn);
+  current_time_ns_ += 1e8;
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_FINISHED(queue_, task_return_req_id, PlasmaError::OK);
+  ASSERT_REQUEST_UNFINISHED(queue_, large_req_id);
+
+  // Grace period is done. The large request fails, and the others are served.
+  current_time_ns_ += oom_grace_period_s_ * 2e9;
+  ASSERT_TRUE(queue_.ProcessRequests().ok());
+  ASSERT_REQUEST_FINISHED(queue_, large_req_id, PlasmaError::OutOfDisk);
+  ASSERT_REQUEST_FINISHED(queue_, larger_put_req_id, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue_, small_pull_req_id, PlasmaError::OK);
+  AssertNoLeaks();
+}
+
+TEST_F(CreateRequestQueueTest, TestDeadline) {
+  int num_fallbacks = 0;
+  auto oom_request = [&](bool fallback, PlasmaObject *result, bool *spill_requested) {
+    if (fallback) {
+      result->data_size = 1234;
+      num_fallbacks += 1;
+      return PlasmaError::OK;
+    } else {
+      return PlasmaError::OutOfMemory;
+    }
+  };
+
+  auto client = std::make_shared<MockClient>();
+  auto req_id1 = queue_.AddRequest(
+      ObjectID::Nil(), client, oom_request, 1234, flatbuf::CreatePriority::Put);
+  auto req_id2 = queue_.AddRequest(ObjectID::Nil(),
+                                   client,
+                                   oom_request,
+                                   1234,
+                                   flatbuf::CreatePriority::PulledObject,
+                                   /*deadline_ms=*/100);
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_UNFINISHED(queue_, req_id1);
+  ASSERT_REQUEST_UNFINISHED(queue_, req_id2);
+
+  // The second request is past its deadline, so it is served with the fallback
+  // allocator although the grace period of the first one isn't over.
+  current_time_ns_ += 2e8;
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_UNFINISHED(queue_, req_id1);
+  ASSERT_REQUEST_FINISHED(queue_, req_id2, PlasmaError::OK);
+  ASSERT_EQ(num_fallbacks, 1);
+
+  // A deadline shorter than the grace period also applies to the head of the queue.
+  auto req_id3 = queue_.AddRequest(ObjectID::Nil(),
+                                   client,
+                                   oom_request,
+                                   1234,
+                                   flatbuf::CreatePriority::TaskReturn,
+                                   /*deadline_ms=*/100);
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_UNFINISHED(queue_, req_id3);
+  current_time_ns_ += 2e8;
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_FINISHED(queue_, req_id3, PlasmaError::OK);
+  ASSERT_EQ(num_fallbacks, 2);
+
+  current_time_ns_ += oom_grace_period_s_ * 2e9;
+  ASSERT_TRUE(queue_.ProcessRequests().ok());
+  ASSERT_REQUEST_FINISHED(queue_, req_id1, PlasmaError::OK);
+  ASSERT_EQ(num_fallbacks, 3);
+  AssertNoLeaks();
+}
+
+TEST_F(CreateRequestQueueTest, TestDeadlinePrefersPrimaryMemory) {
+  int num_fallbacks = 0;
+  bool space_freed = false;
+  auto head_request = [&](bool fallback, PlasmaObject *result, bool *spill_requested) {
+    result->data_size = 1234;
+    return fallback ? PlasmaError::OK : PlasmaError::OutOfMemory;
+  };
+  auto request = [&](bool fallback, PlasmaObject *result, bool *spill_requested) {
+    if (!fallback && !space_freed) {
+      return PlasmaError::OutOfMemory;
+    }
+    result->data_size = 1234;
+    num_fallbacks += fallback ? 1 : 0;
+    return PlasmaError::OK;
+  };
+
+  auto client = std::make_shared<MockClient>();
+  auto req_id1 = queue_.AddRequest(
+      ObjectID::Nil(), client, head_request, 1234, flatbuf::CreatePriority::Put);
+  auto req_id2 = queue_.AddRequest(ObjectID::Nil(),
+                                   client,
+                                   request,
+                                   1234,
+                                   flatbuf::CreatePriority::PulledObject,
+                                   /*deadline_ms=*/100);
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+
+  // Once the second request is past its deadline, it's still created in the primary
+  // memory if it fits there now.
+  space_freed = true;
+  current_time_ns_ += 2e8;
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_REQUEST_FINISHED(queue_, req_id2, PlasmaError::OK);
+  ASSERT_EQ(num_fallbacks, 0);
+
+  current_time_ns_ += oom_grace_period_s_ * 2e9;
+  ASSERT_TRUE(queue_.ProcessRequests().ok());
+  ASSERT_REQUEST_FINISHED(queue_, req_id1, PlasmaError::OK);
+  AssertNoLeaks();
+}
+
 }  // namespace plasma
 
 int main(int argc, char **argv) {
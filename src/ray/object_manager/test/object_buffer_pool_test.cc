@@ -58,7 +58,9 @@ class MockPlasmaClient : public plasma::PlasmaClientInterface {
                                      int64_t metadata_size,
                                      std::shared_ptr<Buffer> *data,
                                      plasma::flatbuf::ObjectSource source,
-                                     int device_num) {
+                                     int device_num,
+                                     plasma::flatbuf::CreatePriority priority,
+                                     int64_t deadline_ms) {
     *data = std::make_shared<LocalMemoryBuffer>(data_size);
     return ray::Status::OK();
   }
@@ -60,7 +60,10 @@ class PullManagerTestWithCapacity {
     ASSERT_TRUE(pull_manager_.get_request_bundles_.Empty());
     ASSERT_TRUE(pull_manager_.wait_request_bundles_.Empty());
     ASSERT_TRUE(pull_manager_.task_argument_bundles_.Empty());
+    ASSERT_TRUE(pull_manager_.prefetch_bundles_.Empty());
     ASSERT_EQ(pull_manager_.num_active_bundles_, 0);
+    ASSERT_TRUE(pull_manager_.prefetch_bytes_by_request_.empty());
+    ASSERT_EQ(pull_manager_.num_bytes_being_prefetched_, 0);
     ASSERT_TRUE(pull_manager_.object_pull_requests_.empty());
     absl::MutexLock lock(&pull_manager_.active_objects_mu_);
     ASSERT_TRUE(pull_manager_.active_object_pull_requests_.empty());
@@ -126,6 +129,8 @@ class PullManagerWithAdmissionControlTest
     ASSERT_EQ(pull_manager_.num_active_bundles_, num_bundles);
   }
 
+  int64_t NumBytesBeingPrefetched() { return pull_manager_.num_bytes_being_prefetched_; }
+
   bool IsUnderCapacity(int64_t num_bytes_requested) {
     return num_bytes_requested <= pull_manager_.num_bytes_available_;
   }
@@ -1186,6 +1191,78 @@ TEST_F(PullManagerWithAdmissionControlTest, TestPrioritizeWorkerRequests) {
   AssertNoLeaks();
 }
 
+TEST_F(PullManagerWithAdmissionControlTest, TestPrefetchYieldsToOtherRequests) {
+  /// Test that prefetch requests stay within the prefetch quota, and that they
+  /// are deactivated to make room for any other request.
+  int object_size = 2;
+  std::unordered_set<NodeID> client_ids;
+  client_ids.insert(NodeID::FromRandom());
+  std::vector<rpc::ObjectReference> objects_to_locate;
+
+  // The default prefetch quota fits a single object.
+  std::vector<uint64_t> prefetch_req_ids;
+  std::vector<ObjectID> prefetch_oids;
+  for (int i = 0; i < 2; i++) {
+    auto refs = CreateObjectRefs(1);
+    prefetch_req_ids.push_back(pull_manager_.Pull(
+        refs, BundlePriority::PREFETCH, {"", false}, &objects_to_locate));
+    prefetch_oids.push_back(ObjectRefsToIds(refs)[0]);
+    pull_manager_.OnLocationChange(
+        prefetch_oids.back(), client_ids, "", NodeID::Nil(), false, object_size);
+  }
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[1]));
+  ASSERT_EQ(NumBytesBeingPrefetched(), object_size);
+  AssertNumActiveBundlesEquals(0);
+
+  // Task args may use the memory of the active prefetch, which is deactivated
+  // once the task args need it.
+  std::vector<uint64_t> task_req_ids;
+  std::vector<ObjectID> task_oids;
+  for (int i = 0; i < 5; i++) {
+    auto refs = CreateObjectRefs(1);
+    task_req_ids.push_back(pull_manager_.Pull(
+        refs, BundlePriority::TASK_ARGS, {"", false}, &objects_to_locate));
+    task_oids.push_back(ObjectRefsToIds(refs)[0]);
+    pull_manager_.OnLocationChange(
+        task_oids.back(), client_ids, "", NodeID::Nil(), false, object_size);
+  }
+  for (const auto &oid : task_oids) {
+    ASSERT_TRUE(pull_manager_.IsObjectActive(oid));
+  }
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[1]));
+  ASSERT_EQ(NumBytesBeingPrefetched(), 0);
+  AssertNumActiveBundlesEquals(5);
+
+  // The prefetch resumes once there is room again.
+  pull_manager_.CancelPull(task_req_ids.back());
+  task_req_ids.pop_back();
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[1]));
+
+  // A get request takes the memory of the prefetch.
+  auto refs = CreateObjectRefs(1);
+  auto get_req_id = pull_manager_.Pull(
+      refs, BundlePriority::GET_REQUEST, {"", false}, &objects_to_locate);
+  auto get_oid = ObjectRefsToIds(refs)[0];
+  pull_manager_.OnLocationChange(
+      get_oid, client_ids, "", NodeID::Nil(), false, object_size);
+  ASSERT_TRUE(pull_manager_.IsObjectActive(get_oid));
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  ASSERT_EQ(NumBytesBeingPrefetched(), 0);
+
+  pull_manager_.CancelPull(get_req_id);
+  for (auto req_id : task_req_ids) {
+    pull_manager_.CancelPull(req_id);
+  }
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  for (auto req_id : prefetch_req_ids) {
+    pull_manager_.CancelPull(req_id);
+  }
+  AssertNoLeaks();
+}
+
 TEST_P(PullManagerTest, TestTimeOut) {
   BundlePriority prio = GetParam();
   auto refs = CreateObjectRefs(1);
@@ -243,6 +243,37 @@ bool Subscriber::Subscribe(std::unique_ptr<rpc::SubMessage> sub_message,
                            std::move(subscription_failure_callback));
 }
 
+bool Subscriber::SubscribeBatch(
+    std::vector<std::pair<std::string, std::unique_ptr<rpc::SubMessage>>> sub_messages,
+    const rpc::ChannelType channel_type,
+    const rpc::Address &publisher_address,
+    SubscriptionItemCallback subscription_callback,
+    SubscriptionFailureCallback subscription_failure_callback) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  bool all_inserted = true;
+
+  absl::MutexLock lock(&mutex_);
+  // Queue all the commands before sending any, so that they go in the same batches.
+  auto &command_queue = commands_[publisher_id];
+  for (auto &[key_id, sub_message] : sub_messages) {
+    auto command = std::make_unique<CommandItem>();
+    command->cmd.set_channel_type(channel_type);
+    command->cmd.set_key_id(key_id);
+    if (sub_message != nullptr) {
+      command->cmd.mutable_subscribe_message()->Swap(sub_message.get());
+    }
+    command_queue.emplace(std::move(command));
+    all_inserted &= Channel(channel_type)
+                        ->Subscribe(publisher_address,
+                                    key_id,
+                                    subscription_callback,
+                                    subscription_failure_callback);
+  }
+  SendCommandBatchIfPossible(publisher_address);
+  MakeLongPollingConnectionIfNotConnected(publisher_address);
+  return all_inserted;
+}
+
 bool Subscriber::SubscribeChannel(
     std::unique_ptr<rpc::SubMessage> sub_message,
     const rpc::ChannelType channel_type,
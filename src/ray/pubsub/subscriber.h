@@ -19,6 +19,8 @@
 
 #include <boost/any.hpp>
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -241,6 +243,39 @@ class SubscriberInterface {
       SubscriptionItemCallback subscription_callback,
       SubscriptionFailureCallback subscription_failure_callback) = 0;
 
+  /// Subscribe to several entities in channel channel_type from the same publisher.
+  ///
+  /// This is the same as calling Subscribe() for each entity, but the subscription
+  /// commands are queued together so that they are sent in as few command batches as
+  /// possible, and the callbacks are shared by the entities.
+  ///
+  /// \param sub_messages The entity ids with their subscription messages.
+  /// \param channel_type The channel to subscribe to.
+  /// \param publisher_address Address of the publisher to subscribe the objects.
+  /// \param subscription_callback A callback that is invoked whenever the information
+  /// of one of the entities is received by the subscriber.
+  /// \param subscription_failure_callback A callback that is invoked for each entity
+  /// whenever the connection to publisher is broken (e.g. the publisher fails).
+  /// \return True if all were inserted, false if any key already existed.
+  [[nodiscard]] virtual bool SubscribeBatch(
+      std::vector<std::pair<std::string, std::unique_ptr<rpc::SubMessage>>> sub_messages,
+      rpc::ChannelType channel_type,
+      const rpc::Address &publisher_address,
+      SubscriptionItemCallback subscription_callback,
+      SubscriptionFailureCallback subscription_failure_callback) {
+    bool all_inserted = true;
+    for (auto &[key_id, sub_message] : sub_messages) {
+      all_inserted &= Subscribe(std::move(sub_message),
+                                channel_type,
+                                publisher_address,
+                                key_id,
+                                /*subscribe_done_callback=*/nullptr,
+                                subscription_callback,
+                                subscription_failure_callback);
+    }
+    return all_inserted;
+  }
+
   /// Subscribe to all entities in channel channel_type.
   ///
   /// \param sub_message The subscription message.
@@ -354,6 +389,13 @@ class Subscriber : public SubscriberInterface {
                  SubscriptionItemCallback subscription_callback,
                  SubscriptionFailureCallback subscription_failure_callback) override;
 
+  bool SubscribeBatch(
+      std::vector<std::pair<std::string, std::unique_ptr<rpc::SubMessage>>> sub_messages,
+      rpc::ChannelType channel_type,
+      const rpc::Address &publisher_address,
+      SubscriptionItemCallback subscription_callback,
+      SubscriptionFailureCallback subscription_failure_callback) override;
+
   bool SubscribeChannel(
       std::unique_ptr<rpc::SubMessage> sub_message,
       rpc::ChannelType channel_type,
@@ -14,6 +14,8 @@
 
 #include "ray/raylet/dependency_manager.h"
 
+#include "ray/stats/metric_defs.h"
+
 namespace ray {
 
 namespace raylet {
@@ -205,6 +207,21 @@ bool DependencyManager::RequestTaskDependencies(
                    << " request: " << task_entry->pull_request_id;
   }
 
+  // The task's dependencies were prefetched. Record how many of them arrived in
+  // time, and cancel the prefetch now that the pull above took it over.
+  auto prefetch_it = prefetch_requests_.find(task_id);
+  if (prefetch_it != prefetch_requests_.end()) {
+    for (const auto &obj_id : prefetch_it->second.objects) {
+      if (local_objects_.count(obj_id)) {
+        num_prefetch_hits_++;
+      } else {
+        num_prefetch_misses_++;
+      }
+    }
+    object_manager_.CancelPull(prefetch_it->second.pull_request_id);
+    prefetch_requests_.erase(prefetch_it);
+  }
+
   return task_entry->num_missing_dependencies == 0;
 }
 
@@ -230,6 +247,46 @@ void DependencyManager::RemoveTaskDependencies(const TaskID &task_id) {
   queued_task_requests_.erase(task_entry);
 }
 
+void DependencyManager::PrefetchTaskDependencies(
+    const TaskID &task_id,
+    const std::vector<rpc::ObjectReference> &required_objects,
+    const TaskMetricsKey &task_key) {
+  if (prefetch_requests_.contains(task_id) || queued_task_requests_.contains(task_id)) {
+    return;
+  }
+
+  PrefetchRequest request;
+  std::vector<rpc::ObjectReference> refs_to_prefetch;
+  for (const auto &ref : required_objects) {
+    const auto obj_id = ObjectRefToId(ref);
+    if (local_objects_.count(obj_id) == 0 && request.objects.insert(obj_id).second) {
+      refs_to_prefetch.push_back(ref);
+    }
+  }
+  if (refs_to_prefetch.empty()) {
+    return;
+  }
+
+  request.pull_request_id =
+      object_manager_.Pull(refs_to_prefetch, BundlePriority::PREFETCH, task_key);
+  RAY_LOG(DEBUG) << "Started prefetch for dependencies of task " << task_id
+                 << " request: " << request.pull_request_id;
+  prefetch_requests_.emplace(task_id, std::move(request));
+}
+
+void DependencyManager::CancelPrefetchTaskDependencies(const TaskID &task_id) {
+  auto it = prefetch_requests_.find(task_id);
+  if (it == prefetch_requests_.end()) {
+    return;
+  }
+
+  RAY_LOG(DEBUG) << "Canceling prefetch for dependencies of task " << task_id
+                 << " request: " << it->second.pull_request_id;
+  num_prefetch_unused_ += it->second.objects.size();
+  object_manager_.CancelPull(it->second.pull_request_id);
+  prefetch_requests_.erase(it);
+}
+
 std::vector<TaskID> DependencyManager::HandleObjectMissing(
     const ray::ObjectID &object_id) {
   RAY_CHECK(local_objects_.erase(object_id))
@@ -323,11 +380,16 @@ std::string DependencyManager::DebugString() const {
   result << "\n- get req map size: " << get_requests_.size();
   result << "\n- wait req map size: " << wait_requests_.size();
   result << "\n- local objects map size: " << local_objects_.size();
+  result << "\n- prefetch req map size: " << prefetch_requests_.size();
   return result.str();
 }
 
 void DependencyManager::RecordMetrics() {
   waiting_tasks_counter_.FlushOnChangeCallbacks();
+  ray::stats::STATS_scheduler_prefetched_task_args.Record(num_prefetch_hits_, "Hit");
+  ray::stats::STATS_scheduler_prefetched_task_args.Record(num_prefetch_misses_, "Miss");
+  ray::stats::STATS_scheduler_prefetched_task_args.Record(num_prefetch_unused_,
+                                                          "Unused");
 }
 
 }  // namespace raylet
@@ -35,6 +35,11 @@ class TaskDependencyManagerInterface {
       const std::vector<rpc::ObjectReference> &required_objects,
       const TaskMetricsKey &task_key) = 0;
   virtual void RemoveTaskDependencies(const TaskID &task_id) = 0;
+  virtual void PrefetchTaskDependencies(
+      const TaskID &task_id,
+      const std::vector<rpc::ObjectReference> &required_objects,
+      const TaskMetricsKey &task_key) = 0;
+  virtual void CancelPrefetchTaskDependencies(const TaskID &task_id) = 0;
   virtual bool TaskDependenciesBlocked(const TaskID &task_id) const = 0;
   virtual bool CheckObjectLocal(const ObjectID &object_id) const = 0;
   virtual ~TaskDependencyManagerInterface(){};
@@ -169,6 +174,25 @@ class DependencyManager : public TaskDependencyManagerInterface {
   /// \return Void.
   void RemoveTaskDependencies(const TaskID &task_id);
 
+  /// Prefetch the dependencies of a task that is not queued on this node yet
+  /// but is likely to be soon. The objects that are not local are pulled with
+  /// the lowest priority, until the task's dependencies are requested or the
+  /// prefetch is canceled.
+  ///
+  /// This method does nothing if the task is already prefetched or queued.
+  ///
+  /// \param task_id The task that will require the objects.
+  /// \param required_objects The objects required by the task.
+  /// \param task_key Task name and whether it is a retry.
+  void PrefetchTaskDependencies(const TaskID &task_id,
+                                const std::vector<rpc::ObjectReference> &required_objects,
+                                const TaskMetricsKey &task_key);
+
+  /// Cancel the prefetch of a task's dependencies, if any.
+  ///
+  /// \param task_id The task whose dependencies were prefetched.
+  void CancelPrefetchTaskDependencies(const TaskID &task_id);
+
   /// Handle an object becoming locally available.
   ///
   /// \param object_id The object ID of the object to mark as locally
@@ -269,6 +293,14 @@ class DependencyManager : public TaskDependencyManagerInterface {
     }
   };
 
+  /// The dependencies of a task that are being prefetched.
+  struct PrefetchRequest {
+    /// The objects that were not local when the prefetch started.
+    absl::flat_hash_set<ObjectID> objects;
+    /// Used to identify the pull request for the objects to the object manager.
+    uint64_t pull_request_id = 0;
+  };
+
   /// Stop tracking this object, if it is no longer needed by any worker or
   /// queued task.
   void RemoveObjectIfNotNeeded(
@@ -302,6 +334,16 @@ class DependencyManager : public TaskDependencyManagerInterface {
   /// that require it.
   absl::flat_hash_map<ObjectID, ObjectDependencies> required_objects_;
 
+  /// A map from the ID of a task that is not queued yet to the dependencies
+  /// that we are prefetching for it.
+  absl::flat_hash_map<TaskID, PrefetchRequest> prefetch_requests_;
+
+  /// The number of prefetched objects that were local by the time the task
+  /// was queued, that were not local yet, and whose task was never queued.
+  int64_t num_prefetch_hits_ = 0;
+  int64_t num_prefetch_misses_ = 0;
+  int64_t num_prefetch_unused_ = 0;
+
   /// The set of locally available objects. This is used to determine which
   /// tasks are ready to run and which `ray.wait` requests can be finished.
   std::unordered_set<ray::ObjectID> local_objects_;
@@ -38,6 +38,8 @@ class MockObjectManager : public ObjectManagerInterface {
       active_get_requests.insert(req_id);
     } else if (prio == BundlePriority::WAIT_REQUEST) {
       active_wait_requests.insert(req_id);
+    } else if (prio == BundlePriority::PREFETCH) {
+      active_prefetch_requests.insert(req_id);
     } else {
       active_task_requests.insert(req_id);
     }
@@ -47,13 +49,15 @@ class MockObjectManager : public ObjectManagerInterface {
   void CancelPull(uint64_t request_id) {
     ASSERT_TRUE(active_get_requests.erase(request_id) ||
                 active_wait_requests.erase(request_id) ||
-                active_task_requests.erase(request_id));
+                active_task_requests.erase(request_id) ||
+                active_prefetch_requests.erase(request_id));
   }
 
   bool PullRequestActiveOrWaitingForMetadata(uint64_t request_id) const {
     return active_get_requests.count(request_id) ||
            active_wait_requests.count(request_id) ||
-           active_task_requests.count(request_id);
+           active_task_requests.count(request_id) ||
+           active_prefetch_requests.count(request_id);
   }
 
   int64_t PullManagerNumInactivePullsByTaskName(const TaskMetricsKey &task_key) const {
@@ -64,6 +68,7 @@ class MockObjectManager : public ObjectManagerInterface {
   std::unordered_set<uint64_t> active_get_requests;
   std::unordered_set<uint64_t> active_wait_requests;
   std::unordered_set<uint64_t> active_task_requests;
+  std::unordered_set<uint64_t> active_prefetch_requests;
 };
 
 class DependencyManagerTest : public ::testing::Test {
@@ -77,16 +82,22 @@ class DependencyManagerTest : public ::testing::Test {
 
   int64_t NumWaitingTotal() { return dependency_manager_.waiting_tasks_counter_.Total(); }
 
+  int64_t NumPrefetchHits() { return dependency_manager_.num_prefetch_hits_; }
+  int64_t NumPrefetchMisses() { return dependency_manager_.num_prefetch_misses_; }
+  int64_t NumPrefetchUnused() { return dependency_manager_.num_prefetch_unused_; }
+
   void AssertNoLeaks() {
     ASSERT_TRUE(dependency_manager_.required_objects_.empty());
     ASSERT_TRUE(dependency_manager_.queued_task_requests_.empty());
     ASSERT_TRUE(dependency_manager_.get_requests_.empty());
     ASSERT_TRUE(dependency_manager_.wait_requests_.empty());
+    ASSERT_TRUE(dependency_manager_.prefetch_requests_.empty());
     ASSERT_TRUE(dependency_manager_.waiting_tasks_counter_.Total() == 0);
     // All pull requests are canceled.
     ASSERT_TRUE(object_manager_mock_.active_task_requests.empty());
     ASSERT_TRUE(object_manager_mock_.active_get_requests.empty());
     ASSERT_TRUE(object_manager_mock_.active_wait_requests.empty());
+    ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
   }
 
   MockObjectManager object_manager_mock_;
@@ -365,6 +376,148 @@ TEST_F(DependencyManagerTest, TestDuplicateTaskArgs) {
   AssertNoLeaks();
 }
 
+/// Test prefetching the dependencies of a task before it is queued. The
+/// prefetch is handed over to the task's request once the task is queued.
+TEST_F(DependencyManagerTest, TestPrefetchThenRequest) {
+  std::vector<ObjectID> arguments;
+  for (int i = 0; i < 3; i++) {
+    arguments.push_back(ObjectID::FromRandom());
+  }
+  // Objects that are already local are not prefetched.
+  dependency_manager_.HandleObjectLocal(arguments[0]);
+  TaskID task_id = RandomTaskId();
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_EQ(object_manager_mock_.active_prefetch_requests.size(), 1);
+  // Prefetching the same task again does nothing.
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_EQ(object_manager_mock_.active_prefetch_requests.size(), 1);
+
+  // One of the prefetched objects arrives before the task is queued.
+  ASSERT_TRUE(dependency_manager_.HandleObjectLocal(arguments[1]).empty());
+  bool ready = dependency_manager_.RequestTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_FALSE(ready);
+  ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
+  ASSERT_EQ(object_manager_mock_.active_task_requests.size(), 1);
+  ASSERT_EQ(NumPrefetchHits(), 1);
+  ASSERT_EQ(NumPrefetchMisses(), 1);
+  ASSERT_EQ(NumPrefetchUnused(), 0);
+
+  // A task that is already queued is not prefetched.
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
+
+  auto ready_task_ids = dependency_manager_.HandleObjectLocal(arguments[2]);
+  ASSERT_EQ(ready_task_ids.size(), 1);
+  ASSERT_EQ(ready_task_ids.front(), task_id);
+  dependency_manager_.RemoveTaskDependencies(task_id);
+  AssertNoLeaks();
+}
+
+/// Test canceling the prefetch of a task that is never queued.
+TEST_F(DependencyManagerTest, TestPrefetchThenCancel) {
+  std::vector<ObjectID> arguments;
+  for (int i = 0; i < 2; i++) {
+    arguments.push_back(ObjectID::FromRandom());
+  }
+  TaskID task_id = RandomTaskId();
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"", false});
+  ASSERT_EQ(object_manager_mock_.active_prefetch_requests.size(), 1);
+
+  dependency_manager_.CancelPrefetchTaskDependencies(task_id);
+  ASSERT_EQ(NumPrefetchUnused(), 2);
+  // Canceling again does nothing.
+  dependency_manager_.CancelPrefetchTaskDependencies(task_id);
+  ASSERT_EQ(NumPrefetchUnused(), 2);
+  AssertNoLeaks();
+
+  // Nothing is pulled if all of the objects are already local.
+  for (const auto &argument : arguments) {
+    dependency_manager_.HandleObjectLocal(argument);
+  }
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"", false});
+  ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
+  AssertNoLeaks();
+}
+
+/// Simulate a pipeline of tasks that run one at a time on a single worker,
+/// each with one argument that takes as long to transfer as the task takes to
+/// run. Transfers are serialized on one link. Without prefetching, a task's
+/// argument is only pulled once the task is queued, when the previous task
+/// finishes. With prefetching, the transfers overlap with the execution of the
+/// earlier tasks.
+TEST_F(DependencyManagerTest, TestPrefetchPipelineLatencyBenchmark) {
+  const int num_tasks = 100;
+  const int64_t transfer_time = 10;
+  const int64_t execution_time = 10;
+  int64_t makespan[2];
+  for (bool prefetch : {false, true}) {
+    std::vector<TaskID> task_ids;
+    std::vector<ObjectID> arguments;
+    for (int i = 0; i < num_tasks; i++) {
+      task_ids.push_back(RandomTaskId());
+      arguments.push_back(ObjectID::FromRandom());
+    }
+
+    int64_t now = 0;
+    int64_t link_free_time = 0;
+    std::vector<int64_t> arrival_time(num_tasks, -1);
+    int next_arrival = 0;
+    auto transfer = [&](int i) {
+      if (arrival_time[i] < 0) {
+        arrival_time[i] = std::max(now, link_free_time) + transfer_time;
+        link_free_time = arrival_time[i];
+      }
+    };
+    auto advance_to = [&](int64_t time) {
+      now = time;
+      while (next_arrival < num_tasks && arrival_time[next_arrival] >= 0 &&
+             arrival_time[next_arrival] <= now) {
+        dependency_manager_.HandleObjectLocal(arguments[next_arrival++]);
+      }
+    };
+
+    if (prefetch) {
+      // All of the tasks are queued beyond the single worker.
+      for (int i = 0; i < num_tasks; i++) {
+        dependency_manager_.PrefetchTaskDependencies(
+            task_ids[i], ObjectIdsToRefs({arguments[i]}), {"", false});
+        transfer(i);
+      }
+    }
+
+    int64_t total_wait_time = 0;
+    for (int i = 0; i < num_tasks; i++) {
+      const int64_t queued_time = now;
+      bool ready = dependency_manager_.RequestTaskDependencies(
+          task_ids[i], ObjectIdsToRefs({arguments[i]}), {"", false});
+      if (!ready) {
+        transfer(i);
+        advance_to(arrival_time[i]);
+      }
+      total_wait_time += now - queued_time;
+      advance_to(now + execution_time);
+      dependency_manager_.RemoveTaskDependencies(task_ids[i]);
+    }
+    makespan[prefetch] = now;
+    RAY_LOG(INFO) << "Pipeline of " << num_tasks << " tasks with prefetch "
+                  << (prefetch ? "on" : "off") << ": makespan " << now
+                  << ", mean wait for arguments "
+                  << static_cast<double>(total_wait_time) / num_tasks
+                  << ", prefetch hits " << NumPrefetchHits() << ", misses "
+                  << NumPrefetchMisses();
+    AssertNoLeaks();
+  }
+  ASSERT_EQ(makespan[false], num_tasks * (transfer_time + execution_time));
+  ASSERT_EQ(makespan[true], transfer_time + num_tasks * execution_time);
+  ASSERT_EQ(NumPrefetchHits() + NumPrefetchMisses(), num_tasks);
+}
+
 }  // namespace raylet
 
 }  // namespace ray
@@ -14,6 +14,8 @@
 
 #include "ray/raylet/local_object_manager.h"
 
+#include <algorithm>
+
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/util.h"
@@ -22,6 +24,28 @@ namespace ray {
 
 namespace raylet {
 
+namespace {
+
+/// Spill candidates that share an owner and a size bin.
+struct SpillFusionGroup {
+  std::string owner_worker_id;
+  std::vector<ObjectID> object_ids;
+  int64_t num_bytes;
+};
+
+/// Objects are binned by the power of two of their size, so that a spill file
+/// holds objects of a similar size.
+int SpillSizeBin(int64_t object_size) {
+  int bin = 0;
+  while (object_size > 1) {
+    object_size >>= 1;
+    bin++;
+  }
+  return bin;
+}
+
+}  // namespace
+
 void LocalObjectManager::PinObjectsAndWaitForFree(
     const std::vector<ObjectID> &object_ids,
     std::vector<std::unique_ptr<RayObject>> &&objects,
@@ -179,24 +203,71 @@ bool LocalObjectManager::SpillObjectsOfSize(int64_t num_bytes_to_spill) {
   }
 
   RAY_LOG(DEBUG) << "Choosing objects to spill of total size " << num_bytes_to_spill;
-  int64_t bytes_to_spill = 0;
+  // Group the spillable objects by owner and size bin. Objects of the same owner
+  // tend to go out of scope together, so fusing them into the same file lets the
+  // file be deleted instead of being kept alive by a few remaining objects.
+  const bool fuse_by_locality = RayConfig::instance().object_spilling_fuse_by_locality();
+  const int64_t max_candidates =
+      fuse_by_locality ? max_fused_object_count_ * kSpillFusionCandidateFactor
+                       : max_fused_object_count_;
+  std::vector<SpillFusionGroup> groups;
+  absl::flat_hash_map<std::pair<std::string, int>, size_t> group_index;
   auto it = pinned_objects_.begin();
-  std::vector<ObjectID> objects_to_spill;
   int64_t counts = 0;
-  while (it != pinned_objects_.end() && counts < max_fused_object_count_) {
+  size_t num_candidates = 0;
+  while (it != pinned_objects_.end() && counts < max_candidates) {
     if (is_plasma_object_spillable_(it->first)) {
-      bytes_to_spill += it->second->GetSize();
-      objects_to_spill.push_back(it->first);
+      const int64_t object_size = it->second->GetSize();
+      std::pair<std::string, int> key;
+      const auto local_object_it = local_objects_.find(it->first);
+      if (fuse_by_locality && local_object_it != local_objects_.end()) {
+        key = {local_object_it->second.owner_address.worker_id(),
+               SpillSizeBin(object_size)};
+      }
+      const auto inserted = group_index.emplace(key, groups.size());
+      if (inserted.second) {
+        groups.push_back(SpillFusionGroup{key.first, {}, 0});
+      }
+      auto &group = groups[inserted.first->second];
+      group.object_ids.push_back(it->first);
+      group.num_bytes += object_size;
+      num_candidates++;
     }
     it++;
     counts += 1;
   }
-  if (objects_to_spill.empty()) {
+  if (groups.empty()) {
     return false;
   }
 
-  if (it == pinned_objects_.end() && bytes_to_spill < num_bytes_to_spill &&
-      !objects_pending_spill_.empty()) {
+  // Fuse the largest group first, then the other groups of the same owner, then
+  // the remaining groups. Stop at a group boundary once there are enough bytes.
+  std::stable_sort(groups.begin(),
+                   groups.end(),
+                   [](const SpillFusionGroup &a, const SpillFusionGroup &b) {
+                     return a.num_bytes > b.num_bytes;
+                   });
+  std::stable_partition(
+      groups.begin() + 1, groups.end(), [&groups](const SpillFusionGroup &group) {
+        return group.owner_worker_id == groups.front().owner_worker_id;
+      });
+  int64_t bytes_to_spill = 0;
+  std::vector<ObjectID> objects_to_spill;
+  for (const auto &group : groups) {
+    if (bytes_to_spill >= num_bytes_to_spill && !objects_to_spill.empty()) {
+      break;
+    }
+    for (const auto &object_id : group.object_ids) {
+      if (static_cast<int64_t>(objects_to_spill.size()) >= max_fused_object_count_) {
+        break;
+      }
+      bytes_to_spill += pinned_objects_[object_id]->GetSize();
+      objects_to_spill.push_back(object_id);
+    }
+  }
+
+  if (it == pinned_objects_.end() && objects_to_spill.size() == num_candidates &&
+      bytes_to_spill < num_bytes_to_spill && !objects_pending_spill_.empty()) {
     // We have gone through all spillable objects but we have not yet reached
     // the minimum bytes to spill and we are already spilling other objects.
     // Let those spill requests finish before we try to spill the current
@@ -392,18 +463,17 @@ void LocalObjectManager::OnObjectSpilled(const std::vector<ObjectID> &object_ids
     auto parsed_url = ParseURL(object_url);
     const auto base_url_it = parsed_url->find("url");
     RAY_CHECK(base_url_it != parsed_url->end());
-    if (!url_ref_count_.contains(base_url_it->second)) {
-      url_ref_count_[base_url_it->second] = 1;
-    } else {
-      url_ref_count_[base_url_it->second] += 1;
-    }
+    auto it = objects_pending_spill_.find(object_id);
+    RAY_CHECK(it != objects_pending_spill_.end());
+    const auto object_size = it->second->GetSize();
+    auto &spilled_file = spilled_files_[base_url_it->second];
+    spilled_file.num_live_objects += 1;
+    spilled_file.total_bytes += object_size;
+    spilled_file.live_bytes += object_size;
 
     // Mark that the object is spilled and unpin the pending requests.
     spilled_objects_url_.emplace(object_id, object_url);
     RAY_LOG(DEBUG) << "Unpinning pending spill object " << object_id;
-    auto it = objects_pending_spill_.find(object_id);
-    RAY_CHECK(it != objects_pending_spill_.end());
-    const auto object_size = it->second->GetSize();
     num_bytes_pending_spill_ -= object_size;
     objects_pending_spill_.erase(it);
 
@@ -506,6 +576,7 @@ void LocalObjectManager::AsyncRestoreSpilledObject(
 
 void LocalObjectManager::ProcessSpilledObjectsDeleteQueue(uint32_t max_batch_size) {
   std::vector<std::string> object_urls_to_delete;
+  absl::flat_hash_set<std::string> spilled_files_to_reclaim;
   // Process upto batch size of objects to delete.
   while (!spilled_object_pending_delete_.empty() &&
          object_urls_to_delete.size() < max_batch_size) {
@@ -528,25 +599,38 @@ void LocalObjectManager::ProcessSpilledObjectsDeleteQueue(uint32_t max_batch_siz
       auto parsed_url = ParseURL(object_url);
       const auto base_url_it = parsed_url->find("url");
       RAY_CHECK(base_url_it != parsed_url->end());
-      const auto &url_ref_count_it = url_ref_count_.find(base_url_it->second);
-      RAY_CHECK(url_ref_count_it != url_ref_count_.end())
-          << "url_ref_count_ should exist when spilled_objects_url_ exists. Please "
+      const auto &spilled_file_it = spilled_files_.find(base_url_it->second);
+      RAY_CHECK(spilled_file_it != spilled_files_.end())
+          << "spilled_files_ should exist when spilled_objects_url_ exists. Please "
              "submit a Github issue if you see this error.";
-      url_ref_count_it->second -= 1;
+      RAY_CHECK(local_objects_.contains(object_id))
+          << "local objects should contain the spilled object: " << object_id;
+      const int64_t object_size = local_objects_.at(object_id).object_size;
+      auto &spilled_file = spilled_file_it->second;
+      spilled_file.num_live_objects -= 1;
+      spilled_file.live_bytes -= object_size;
 
       // If there's no more refs, delete the object.
-      if (url_ref_count_it->second == 0) {
-        url_ref_count_.erase(url_ref_count_it);
+      if (spilled_file.num_live_objects == 0) {
+        spilled_file_dead_bytes_ -= spilled_file.dead_bytes;
+        spilled_files_.erase(spilled_file_it);
         RAY_LOG(DEBUG) << "The URL " << object_url
                        << " is deleted because the references are out of scope.";
         object_urls_to_delete.emplace_back(object_url);
+      } else {
+        // Otherwise the object keeps taking up space in the file until its
+        // space is reclaimed or the whole file is deleted.
+        spilled_file.dead_bytes += object_size;
+        spilled_file.dead_object_urls.push_back(object_url);
+        spilled_file_dead_bytes_ += object_size;
+        if (ShouldReclaimSpilledFile(spilled_file)) {
+          spilled_files_to_reclaim.insert(base_url_it->second);
+        }
       }
       spilled_objects_url_.erase(spilled_objects_url_it);
 
       // Update current spilled objects metrics
-      RAY_CHECK(local_objects_.contains(object_id))
-          << "local objects should contain the spilled object: " << object_id;
-      spilled_bytes_current_ -= local_objects_.at(object_id).object_size;
+      spilled_bytes_current_ -= object_size;
     } else {
       // If the object was not spilled, it gets pinned again. Unpin here to
       // prevent a memory leak.
@@ -558,6 +642,38 @@ void LocalObjectManager::ProcessSpilledObjectsDeleteQueue(uint32_t max_batch_siz
   if (object_urls_to_delete.size() > 0) {
     DeleteSpilledObjects(std::move(object_urls_to_delete));
   }
+
+  // Release the space of freed objects in files that are now mostly dead. Files
+  // that were deleted as a whole in this batch don't need it anymore.
+  std::vector<std::string> object_urls_to_reclaim;
+  for (const auto &base_url : spilled_files_to_reclaim) {
+    auto spilled_file_it = spilled_files_.find(base_url);
+    if (spilled_file_it == spilled_files_.end()) {
+      continue;
+    }
+    auto &spilled_file = spilled_file_it->second;
+    RAY_LOG(DEBUG) << "Reclaiming " << spilled_file.dead_bytes << " bytes of freed "
+                   << "objects from spill file " << base_url;
+    spilled_file_dead_bytes_ -= spilled_file.dead_bytes;
+    spilled_file_reclaimed_bytes_total_ += spilled_file.dead_bytes;
+    spilled_file.dead_bytes = 0;
+    for (auto &object_url : spilled_file.dead_object_urls) {
+      object_urls_to_reclaim.push_back(std::move(object_url));
+    }
+    spilled_file.dead_object_urls.clear();
+  }
+  if (object_urls_to_reclaim.size() > 0) {
+    ReclaimSpilledObjects(std::move(object_urls_to_reclaim));
+  }
+}
+
+bool LocalObjectManager::ShouldReclaimSpilledFile(const SpilledFileInfo &file) const {
+  // Only local files can release part of their space.
+  if (!is_external_storage_type_fs_) {
+    return false;
+  }
+  const double threshold = RayConfig::instance().spilled_file_reclaim_threshold();
+  return file.live_bytes < threshold * file.total_bytes;
 }
 
 void LocalObjectManager::DeleteSpilledObjects(std::vector<std::string> urls_to_delete,
@@ -593,6 +709,31 @@ void LocalObjectManager::DeleteSpilledObjects(std::vector<std::string> urls_to_d
       });
 }
 
+void LocalObjectManager::ReclaimSpilledObjects(
+    std::vector<std::string> urls_to_reclaim) {
+  io_worker_pool_.PopDeleteWorker(
+      [this, urls_to_reclaim = std::move(urls_to_reclaim)](
+          std::shared_ptr<WorkerInterface> io_worker) {
+        RAY_LOG(DEBUG) << "Sending reclaim spilled object request. Length: "
+                       << urls_to_reclaim.size();
+        rpc::DeleteSpilledObjectsRequest request;
+        for (const auto &url : urls_to_reclaim) {
+          request.add_reclaimed_objects_url(url);
+        }
+        io_worker->rpc_client()->DeleteSpilledObjects(
+            request,
+            [this, io_worker](const ray::Status &status,
+                              const rpc::DeleteSpilledObjectsReply &reply) {
+              io_worker_pool_.PushDeleteWorker(io_worker);
+              if (!status.ok()) {
+                num_failed_deletion_requests_ += 1;
+                RAY_LOG(WARNING) << "Failed to send reclaim spilled object request: "
+                                 << status.ToString();
+              }
+            });
+      });
+}
+
 void LocalObjectManager::FillObjectSpillingStats(rpc::GetNodeStatsReply *reply) const {
   auto stats = reply->mutable_store_stats();
   stats->set_spill_time_total_s(spill_time_total_s_);
@@ -639,6 +780,16 @@ void LocalObjectManager::RecordMetrics() const {
 
   ray::stats::STATS_spill_manager_request_total.Record(num_failed_deletion_requests_,
                                                        "FailedDeletion");
+
+  ray::stats::STATS_spill_manager_file_bytes.Record(spilled_bytes_current_, "Live");
+  ray::stats::STATS_spill_manager_file_bytes.Record(spilled_file_dead_bytes_, "Dead");
+  ray::stats::STATS_spill_manager_file_bytes.Record(spilled_file_reclaimed_bytes_total_,
+                                                    "Reclaimed");
+  const int64_t spilled_file_bytes = spilled_bytes_current_ + spilled_file_dead_bytes_;
+  if (spilled_file_bytes > 0) {
+    ray::stats::STATS_spill_manager_file_utilization.Record(
+        static_cast<double>(spilled_bytes_current_) / spilled_file_bytes);
+  }
 }
 
 int64_t LocalObjectManager::GetPrimaryBytes() const {
@@ -669,6 +820,10 @@ std::string LocalObjectManager::DebugString() const {
   result << "- cumulative restore requests: " << restored_objects_total_ << "\n";
   result << "- spilled objects pending delete: " << spilled_object_pending_delete_.size()
          << "\n";
+  result << "- num spill files: " << spilled_files_.size() << "\n";
+  result << "- num dead bytes in spill files: " << spilled_file_dead_bytes_ << "\n";
+  result << "- cumulative bytes reclaimed from spill files: "
+         << spilled_file_reclaimed_bytes_total_ << "\n";
   return result.str();
 }
 
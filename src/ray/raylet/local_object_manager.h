@@ -36,6 +36,10 @@ namespace raylet {
 /// The default number of retries when spilled object deletion failed.
 const int64_t kDefaultSpilledObjectDeleteRetries = 3;
 
+/// When spilled objects are fused by owner and size, the number of pinned objects
+/// considered for a spill file, as a multiple of the max fused object count.
+const int64_t kSpillFusionCandidateFactor = 4;
+
 /// This class implements memory management for primary objects, objects that
 /// have been freed, and objects that have been spilled.
 class LocalObjectManager {
@@ -186,6 +190,20 @@ class LocalObjectManager {
     size_t object_size;
   };
 
+  /// Space accounting for a file that holds one or more spilled objects.
+  struct SpilledFileInfo {
+    /// The number of objects in the file that are still in scope.
+    uint64_t num_live_objects = 0;
+    /// The total bytes of the objects spilled to the file.
+    int64_t total_bytes = 0;
+    /// The bytes of the objects in the file that are still in scope.
+    int64_t live_bytes = 0;
+    /// The bytes of freed objects whose space has not been reclaimed yet.
+    int64_t dead_bytes = 0;
+    /// The URLs with offsets of the freed objects that make up dead_bytes.
+    std::vector<std::string> dead_object_urls;
+  };
+
   FRIEND_TEST(LocalObjectManagerTest, TestSpillObjectsOfSizeZero);
   FRIEND_TEST(LocalObjectManagerTest, TestSpillUptoMaxFuseCount);
   FRIEND_TEST(LocalObjectManagerTest,
@@ -228,6 +246,17 @@ class LocalObjectManager {
   void DeleteSpilledObjects(std::vector<std::string> urls_to_delete,
                             int64_t num_retries = kDefaultSpilledObjectDeleteRetries);
 
+  /// Release the space of freed objects inside spill files that still hold live
+  /// objects. This is best effort: on failure the space is released once the
+  /// whole file is deleted.
+  ///
+  /// \param urls_to_reclaim List of urls with offsets of the freed objects.
+  void ReclaimSpilledObjects(std::vector<std::string> urls_to_reclaim);
+
+  /// Whether the freed objects of a spill file should have their space released,
+  /// which is the case once too little of the file is still in scope.
+  bool ShouldReclaimSpilledFile(const SpilledFileInfo &file) const;
+
   const NodeID self_node_id_;
   const std::string self_node_address_;
   const int self_node_port_;
@@ -305,10 +334,10 @@ class LocalObjectManager {
   /// pinned_objects_ entries are deleted when spilling happens.
   absl::flat_hash_map<ObjectID, std::string> spilled_objects_url_;
 
-  /// Base URL -> ref_count. It is used because there could be multiple objects
-  /// within a single spilled file. We need to ref count to avoid deleting the file
-  /// before all objects within that file are out of scope.
-  absl::flat_hash_map<std::string, uint64_t> url_ref_count_;
+  /// Base URL -> spilled file info. It is used because there could be multiple
+  /// objects within a single spilled file. We need to ref count to avoid deleting
+  /// the file before all objects within that file are out of scope.
+  absl::flat_hash_map<std::string, SpilledFileInfo> spilled_files_;
 
   /// Minimum bytes to spill to a single IO spill worker.
   int64_t min_spilling_size_;
@@ -360,6 +389,12 @@ class LocalObjectManager {
   /// The total number of bytes spilled currently.
   int64_t spilled_bytes_current_ = 0;
 
+  /// The bytes of freed objects that still take up space in spill files.
+  int64_t spilled_file_dead_bytes_ = 0;
+
+  /// The total number of bytes reclaimed from partially freed spill files.
+  int64_t spilled_file_reclaimed_bytes_total_ = 0;
+
   /// The total number of bytes spilled.
   int64_t spilled_bytes_total_ = 0;
 
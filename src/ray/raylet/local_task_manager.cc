@@ -18,6 +18,7 @@
 
 #include <boost/range/join.hpp>
 
+#include "absl/strings/str_cat.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/logging.h"
 
@@ -65,6 +66,13 @@ bool LocalTaskManager::WaitForTaskArgsRequests(std::shared_ptr<internal::Work> w
   const auto &scheduling_key = task.GetTaskSpecification().GetSchedulingClass();
   auto object_ids = task.GetTaskSpecification().GetDependencies();
   bool can_dispatch = true;
+  // The dependency manager hands any prefetch of the task's arguments over to
+  // the request below.
+  auto prefetch_it = prefetched_tasks_index_.find(task_id);
+  if (prefetch_it != prefetched_tasks_index_.end()) {
+    prefetched_tasks_.erase(prefetch_it->second);
+    prefetched_tasks_index_.erase(prefetch_it);
+  }
   if (object_ids.size() > 0) {
     bool args_ready = task_dependency_manager_.RequestTaskDependencies(
         task_id,
@@ -88,7 +96,56 @@ bool LocalTaskManager::WaitForTaskArgsRequests(std::shared_ptr<internal::Work> w
   return can_dispatch;
 }
 
+void LocalTaskManager::PrefetchTaskArgs(
+    const std::vector<std::shared_ptr<internal::Work>> &works) {
+  for (const auto &work : works) {
+    const auto &spec = work->task.GetTaskSpecification();
+    const auto task_id = spec.TaskId();
+    if (spec.GetDependencies().empty() || work->args_prefetch_expired ||
+        prefetched_tasks_index_.contains(task_id)) {
+      continue;
+    }
+    auto it = prefetched_tasks_.insert(prefetched_tasks_.end(),
+                                       PrefetchedTask{task_id, get_time_ms_(), work});
+    prefetched_tasks_index_.emplace(task_id, it);
+    task_dependency_manager_.PrefetchTaskDependencies(
+        task_id, work->task.GetDependencies(), {spec.GetName(), spec.IsRetry()});
+  }
+
+  // Evict the oldest prefetches to stay within the limit.
+  const size_t max_tasks = RayConfig::instance().prefetch_queued_task_args_max_tasks();
+  while (prefetched_tasks_.size() > max_tasks) {
+    CancelTaskArgsPrefetch(prefetched_tasks_.front().task_id);
+  }
+}
+
+void LocalTaskManager::CancelTaskArgsPrefetch(const TaskID &task_id) {
+  auto it = prefetched_tasks_index_.find(task_id);
+  if (it == prefetched_tasks_index_.end()) {
+    return;
+  }
+  task_dependency_manager_.CancelPrefetchTaskDependencies(task_id);
+  prefetched_tasks_.erase(it->second);
+  prefetched_tasks_index_.erase(it);
+}
+
+void LocalTaskManager::CancelExpiredTaskArgsPrefetches() {
+  const int64_t now_ms = get_time_ms_();
+  const int64_t timeout_ms =
+      RayConfig::instance().prefetch_queued_task_args_timeout_ms();
+  while (!prefetched_tasks_.empty() &&
+         prefetched_tasks_.front().start_time_ms + timeout_ms <= now_ms) {
+    // The task is still queued for scheduling, so don't prefetch it again on
+    // the next tick.
+    if (auto work = prefetched_tasks_.front().work.lock()) {
+      work->args_prefetch_expired = true;
+    }
+    CancelTaskArgsPrefetch(prefetched_tasks_.front().task_id);
+  }
+}
+
 void LocalTaskManager::ScheduleAndDispatchTasks() {
+  CancelExpiredTaskArgsPrefetches();
   DispatchScheduledTasksToWorkers();
   // TODO(swang): Spill from waiting queue first? Otherwise, we may end up
   // spilling a task whose args are already local.
@@ -501,6 +558,19 @@ bool LocalTaskManager::PoppedWorkerHandler(
             task_id,
             rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_RUNTIME_ENV_SETUP_FAILED,
             /*scheduling_failure_message*/ runtime_env_setup_error_message);
+      } else if (status == PopWorkerStatus::WorkerStartFailed &&
+                 ++num_worker_start_failures_[scheduling_class] >=
+                     RayConfig::instance().worker_start_max_failures()) {
+        // Workers of this scheduling class keep failing to start, e.g. because of a
+        // bad worker command, so fail the task instead of retrying it forever. The
+        // count is reset once a worker of the class is popped.
+        CancelTask(task_id,
+                   rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_UNSCHEDULABLE,
+                   /*scheduling_failure_message*/
+                   absl::StrCat("Failed to start a worker for the task ",
+                                num_worker_start_failures_[scheduling_class],
+                                " times in a row. Check the raylet logs for the "
+                                "error."));
       } else {
         // In other cases, set the work status `WAITING` to make this task
         // could be re-dispatched.
@@ -508,7 +578,10 @@ bool LocalTaskManager::PoppedWorkerHandler(
             internal::UnscheduledWorkCause::WORKER_NOT_FOUND_JOB_CONFIG_NOT_EXIST;
         if (status == PopWorkerStatus::JobConfigMissing) {
           cause = internal::UnscheduledWorkCause::WORKER_NOT_FOUND_JOB_CONFIG_NOT_EXIST;
-        } else if (status == PopWorkerStatus::WorkerPendingRegistration) {
+        } else if (status == PopWorkerStatus::WorkerPendingRegistration ||
+                   status == PopWorkerStatus::WorkerStartFailed) {
+          // A worker that failed to start is handled like one that died before
+          // registering: the task waits for another worker.
           cause = internal::UnscheduledWorkCause::WORKER_NOT_FOUND_REGISTRATION_TIMEOUT;
         } else {
           RAY_LOG(FATAL) << "Unexpected state received for the empty pop worker. Status: "
@@ -533,6 +606,7 @@ bool LocalTaskManager::PoppedWorkerHandler(
 
     Dispatch(worker, leased_workers_, work->allocated_instances, task, reply, callback);
     erase_from_dispatch_queue_fn(work, scheduling_class);
+    num_worker_start_failures_.erase(scheduling_class);
     dispatched = true;
   }
 
@@ -743,14 +817,30 @@ bool LocalTaskManager::CancelTask(
     const TaskID &task_id,
     rpc::RequestWorkerLeaseReply::SchedulingFailureType failure_type,
     const std::string &scheduling_failure_message) {
+  return RemoveQueuedTask(task_id, [&](std::shared_ptr<internal::Work> &work) {
+    RAY_LOG(DEBUG) << "Canceling task " << task_id << ".";
+    ReplyCancelled(work, failure_type, scheduling_failure_message);
+  });
+}
+
+bool LocalTaskManager::RejectTask(const TaskID &task_id) {
+  return RemoveQueuedTask(task_id, [&](std::shared_ptr<internal::Work> &work) {
+    RAY_LOG(DEBUG) << "Rejecting task " << task_id << ".";
+    work->reply->set_rejected(true);
+    work->callback();
+  });
+}
+
+bool LocalTaskManager::RemoveQueuedTask(
+    const TaskID &task_id,
+    const std::function<void(std::shared_ptr<internal::Work> &)> &reply) {
   for (auto shapes_it = tasks_to_dispatch_.begin(); shapes_it != tasks_to_dispatch_.end();
        shapes_it++) {
     auto &work_queue = shapes_it->second;
     for (auto work_it = work_queue.begin(); work_it != work_queue.end(); work_it++) {
       const auto &task = (*work_it)->task;
       if (task.GetTaskSpecification().TaskId() == task_id) {
-        RAY_LOG(DEBUG) << "Canceling task " << task_id << " from dispatch queue.";
-        ReplyCancelled(*work_it, failure_type, scheduling_failure_message);
+        reply(*work_it);
         if ((*work_it)->GetState() == internal::WorkStatus::WAITING_FOR_WORKER) {
           // We've already acquired resources so we need to release them.
           cluster_resource_scheduler_->GetLocalResourceManager().ReleaseWorkerResources(
@@ -776,7 +866,7 @@ bool LocalTaskManager::CancelTask(
   auto iter = waiting_tasks_index_.find(task_id);
   if (iter != waiting_tasks_index_.end()) {
     const auto &task = (*iter->second)->task;
-    ReplyCancelled(*iter->second, failure_type, scheduling_failure_message);
+    reply(*iter->second);
     if (!task.GetTaskSpecification().GetDependencies().empty()) {
       task_dependency_manager_.RemoveTaskDependencies(
           task.GetTaskSpecification().TaskId());
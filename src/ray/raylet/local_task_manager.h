@@ -97,6 +97,14 @@ class LocalTaskManager : public ILocalTaskManager {
   // Schedule and dispatch tasks.
   void ScheduleAndDispatchTasks() override;
 
+  /// Prefetch the arguments of tasks that are likely to be queued on this node
+  /// soon, but can't be placed on any node yet.
+  void PrefetchTaskArgs(
+      const std::vector<std::shared_ptr<internal::Work>> &works) override;
+
+  /// Cancel the prefetch of a task's arguments, if any.
+  void CancelTaskArgsPrefetch(const TaskID &task_id) override;
+
   /// Move tasks from waiting to ready for dispatch. Called when a task's
   /// dependencies are resolved.
   ///
@@ -123,6 +131,14 @@ class LocalTaskManager : public ILocalTaskManager {
                       rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_INTENDED,
                   const std::string &scheduling_failure_message = "") override;
 
+  /// Reject a queued task that is not waiting for a worker yet, so that its owner
+  /// requests it again later.
+  ///
+  /// \param task_id: The id of the task to reject.
+  ///
+  /// \return True if the task was queued and is now removed.
+  bool RejectTask(const TaskID &task_id) override;
+
   /// Return if any tasks are pending resource acquisition.
   ///
   /// \param[out] example: An example task that is deadlocking.
@@ -193,6 +209,16 @@ class LocalTaskManager : public ILocalTaskManager {
 
   void RemoveFromRunningTasksIfExists(const RayTask &task);
 
+  /// Remove a queued task and reply to its lease request.
+  ///
+  /// \param task_id: The id of the task to remove.
+  /// \param reply: Fills in the reply and sends it.
+  ///
+  /// \return True if the task was queued and is now removed.
+  bool RemoveQueuedTask(
+      const TaskID &task_id,
+      const std::function<void(std::shared_ptr<internal::Work> &)> &reply);
+
   /// Handle the popped worker from worker pool.
   bool PoppedWorkerHandler(const std::shared_ptr<WorkerInterface> worker,
                            PopWorkerStatus status,
@@ -268,6 +294,9 @@ class LocalTaskManager : public ILocalTaskManager {
                    std::vector<std::unique_ptr<RayObject>> args);
   void ReleaseTaskArgs(const TaskID &task_id);
 
+  /// Cancel the prefetches that are older than the prefetch timeout.
+  void CancelExpiredTaskArgsPrefetches();
+
  private:
   const NodeID &self_node_id_;
   /// Responsible for resource tracking/view of the cluster.
@@ -302,6 +331,11 @@ class LocalTaskManager : public ILocalTaskManager {
   /// details about what information is tracked.
   absl::flat_hash_map<SchedulingClass, SchedulingClassInfo> info_by_sched_cls_;
 
+  /// The number of times in a row that a worker failed to start for a task of each
+  /// scheduling class. The tasks of a class fail once this reaches
+  /// `worker_start_max_failures`.
+  absl::flat_hash_map<SchedulingClass, int64_t> num_worker_start_failures_;
+
   /// Queue of lease requests that should be scheduled onto workers.
   /// Tasks move from scheduled | waiting -> dispatch.
   /// Tasks can also move from dispatch -> waiting if one of their arguments is
@@ -334,6 +368,23 @@ class LocalTaskManager : public ILocalTaskManager {
   absl::flat_hash_map<TaskID, std::list<std::shared_ptr<internal::Work>>::iterator>
       waiting_tasks_index_;
 
+  /// A task that is not queued here yet whose arguments the dependency manager
+  /// is prefetching.
+  struct PrefetchedTask {
+    TaskID task_id;
+    /// The time at which the prefetch started.
+    int64_t start_time_ms;
+    /// The lease request, marked when the prefetch times out.
+    std::weak_ptr<internal::Work> work;
+  };
+
+  /// The tasks whose arguments are being prefetched, oldest first.
+  std::list<PrefetchedTask> prefetched_tasks_;
+
+  /// An index for the above list.
+  absl::flat_hash_map<TaskID, std::list<PrefetchedTask>::iterator>
+      prefetched_tasks_index_;
+
   /// Track the backlog of all workers belonging to this raylet.
   absl::flat_hash_map<SchedulingClass, absl::flat_hash_map<WorkerID, int64_t>>
       backlog_tracker_;
@@ -527,8 +527,7 @@ ray::Status NodeManager::RegisterGcs() {
         /* receiver */ this,
         /* pull_from_reporter_interval_ms */ 0);
 
-    auto gcs_channel = gcs_client_->GetGcsRpcClient().GetChannel();
-    ray_syncer_.Connect(kGCSNodeID.Binary(), gcs_channel);
+    UpdateRaySyncerUpstream();
     periodical_runner_.RunFnPeriodically(
         [this] {
           auto triggered_by_global_gc = TryLocalGC();
@@ -971,6 +970,10 @@ void NodeManager::NodeAdded(const GcsNodeInfo &node_info) {
   remote_node_manager_addresses_[node_id] =
       std::make_pair(node_info.node_manager_address(), node_info.node_manager_port());
 
+  if (RayConfig::instance().use_ray_syncer()) {
+    UpdateRaySyncerUpstream();
+  }
+
   // Fetch resource info for the remote node and update cluster resource map.
   RAY_CHECK_OK(gcs_client_->NodeResources().AsyncGetResources(
       node_id,
@@ -990,6 +993,46 @@ void NodeManager::NodeAdded(const GcsNodeInfo &node_info) {
       }));
 }
 
+void NodeManager::UpdateRaySyncerUpstream() {
+  std::string upstream = kGCSNodeID.Binary();
+  auto fanout = RayConfig::instance().ray_syncer_aggregation_fanout();
+  if (fanout > 1) {
+    std::vector<std::string> node_ids;
+    node_ids.reserve(remote_node_manager_addresses_.size() + 1);
+    node_ids.push_back(self_node_id_.Binary());
+    for (const auto &entry : remote_node_manager_addresses_) {
+      node_ids.push_back(entry.first.Binary());
+    }
+    auto parent = syncer::GetAggregationUpstream(
+        std::move(node_ids), self_node_id_.Binary(), fanout);
+    if (parent) {
+      upstream = std::move(*parent);
+    }
+  }
+
+  if (upstream == ray_syncer_upstream_) {
+    return;
+  }
+
+  if (!ray_syncer_upstream_.empty()) {
+    ray_syncer_.Disconnect(ray_syncer_upstream_);
+  }
+
+  std::shared_ptr<grpc::Channel> channel;
+  if (upstream == kGCSNodeID.Binary()) {
+    channel = gcs_client_->GetGcsRpcClient().GetChannel();
+    RAY_LOG(INFO) << "Ray syncer is syncing with the GCS.";
+  } else {
+    const auto &address = remote_node_manager_addresses_[NodeID::FromBinary(upstream)];
+    channel = rpc::BuildChannel(address.first, address.second);
+    RAY_LOG(INFO) << "Ray syncer is syncing with the parent node "
+                  << NodeID::FromBinary(upstream) << " at " << address.first << ":"
+                  << address.second;
+  }
+  ray_syncer_upstream_ = upstream;
+  ray_syncer_.Connect(upstream, std::move(channel));
+}
+
 void NodeManager::NodeRemoved(const NodeID &node_id) {
   // TODO(swang): If we receive a notification for our own death, clean up and
   // exit immediately.
@@ -1039,6 +1082,10 @@ void NodeManager::NodeRemoved(const NodeID &node_id) {
     remote_node_manager_addresses_.erase(node_entry);
   }
 
+  if (RayConfig::instance().use_ray_syncer()) {
+    UpdateRaySyncerUpstream();
+  }
+
   // Notify the object directory that the node has been removed so that it
   // can remove it from any cached locations.
   object_directory_->HandleNodeRemoved(node_id);
@@ -1882,6 +1929,58 @@ void NodeManager::HandleRequestWorkerLease(rpc::RequestWorkerLeaseRequest reques
                                               send_reply_callback_wrapper);
 }
 
+void NodeManager::HandleRequestWorkerLeases(rpc::RequestWorkerLeasesRequest request,
+                                            rpc::RequestWorkerLeasesReply *reply,
+                                            rpc::SendReplyCallback send_reply_callback) {
+  const size_t num_leases = request.lease_ids_size();
+  if (num_leases == 0) {
+    send_reply_callback(Status::OK(), nullptr, nullptr);
+    return;
+  }
+  // Multi-lease requests are only sent for normal tasks, since each actor creation
+  // task needs a lease of its own.
+  RAY_CHECK(!TaskSpecification(request.resource_spec()).IsActorCreationTask());
+  metrics_num_task_scheduled_ += num_leases;
+
+  if (RayConfig::instance().enable_worker_prestart()) {
+    int64_t available_cpus = static_cast<int64_t>(
+        cluster_resource_scheduler_->GetLocalResourceManager().GetLocalAvailableCpus());
+    worker_pool_.PrestartWorkers(TaskSpecification(request.resource_spec()),
+                                 request.backlog_size(),
+                                 available_cpus);
+  }
+
+  std::vector<RayTask> tasks;
+  std::vector<rpc::RequestWorkerLeaseReply *> lease_replies;
+  std::vector<rpc::SendReplyCallback> send_reply_callbacks;
+  tasks.reserve(num_leases);
+  lease_replies.reserve(num_leases);
+  send_reply_callbacks.reserve(num_leases);
+  // The reply is sent once every lease is granted, spilled back or rejected. Leases
+  // that can't be dispatched right away are rejected, so this doesn't wait long.
+  auto num_pending_leases = std::make_shared<size_t>(num_leases);
+  for (const auto &lease_id : request.lease_ids()) {
+    rpc::Task task_message;
+    task_message.mutable_task_spec()->CopyFrom(request.resource_spec());
+    task_message.mutable_task_spec()->set_task_id(lease_id);
+    tasks.emplace_back(task_message);
+    lease_replies.push_back(reply->add_lease_replies());
+    send_reply_callbacks.push_back(
+        [num_pending_leases, send_reply_callback](
+            Status status, std::function<void()> success, std::function<void()> failure) {
+          RAY_CHECK_GT(*num_pending_leases, 0u);
+          if (--(*num_pending_leases) == 0) {
+            send_reply_callback(Status::OK(), nullptr, nullptr);
+          }
+        });
+  }
+
+  cluster_task_manager_->QueueAndScheduleTasks(tasks,
+                                               request.is_selected_based_on_locality(),
+                                               lease_replies,
+                                               send_reply_callbacks);
+}
+
 void NodeManager::HandlePrepareBundleResources(
     rpc::PrepareBundleResourcesRequest request,
     rpc::PrepareBundleResourcesReply *reply,
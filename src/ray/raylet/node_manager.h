@@ -232,6 +232,12 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
   /// \return Void.
   void NodeRemoved(const NodeID &node_id);
 
+  /// Connect the ray syncer to the upstream of this node, which is either the GCS
+  /// or the parent node in the aggregation tree when
+  /// `ray_syncer_aggregation_fanout` is set. The current connection is
+  /// dropped if the upstream changed since the last call.
+  void UpdateRaySyncerUpstream();
+
   /// Handler for the addition or updation of a resource in the GCS
   /// \param node_id ID of the node that created or updated resources.
   /// \param createUpdatedResources Created or updated resources.
@@ -509,6 +515,11 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
                                 rpc::RequestWorkerLeaseReply *reply,
                                 rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Handle a `RequestWorkerLeases` request.
+  void HandleRequestWorkerLeases(rpc::RequestWorkerLeasesRequest request,
+                                 rpc::RequestWorkerLeasesReply *reply,
+                                 rpc::SendReplyCallback send_reply_callback) override;
+
   /// Handle a `ReportWorkerBacklog` request.
   void HandleReportWorkerBacklog(rpc::ReportWorkerBacklogRequest request,
                                  rpc::ReportWorkerBacklogReply *reply,
@@ -833,6 +844,10 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
   /// RaySyncerService for gRPC
   syncer::RaySyncerService ray_syncer_service_;
 
+  /// The node id of the node the ray syncer is connected to, in binary format. It's
+  /// kGCSNodeID unless the node is a leaf or inner node of the aggregation tree.
+  std::string ray_syncer_upstream_;
+
   /// The Policy for selecting the worker to kill when the node runs out of memory.
   std::shared_ptr<WorkerKillingPolicy> worker_killing_policy_;
 
@@ -16,6 +16,7 @@
 
 #include <google/protobuf/map.h>
 
+#include <algorithm>
 #include <boost/range/join.hpp>
 
 #include "ray/stats/metric_defs.h"
@@ -64,6 +65,105 @@ void ClusterTaskManager::QueueAndScheduleTask(
   ScheduleAndDispatchTasks();
 }
 
+void ClusterTaskManager::QueueAndScheduleTasks(
+    const std::vector<RayTask> &tasks,
+    bool is_selected_based_on_locality,
+    const std::vector<rpc::RequestWorkerLeaseReply *> &replies,
+    const std::vector<rpc::SendReplyCallback> &send_reply_callbacks) {
+  RAY_CHECK(!tasks.empty());
+  RAY_CHECK_EQ(tasks.size(), replies.size());
+  RAY_CHECK_EQ(tasks.size(), send_reply_callbacks.size());
+  RAY_LOG(DEBUG) << "Queuing and scheduling " << tasks.size() << " tasks";
+  const auto &scheduling_class = tasks[0].GetTaskSpecification().GetSchedulingClass();
+  auto &work_queue = infeasible_tasks_.count(scheduling_class) > 0
+                         ? infeasible_tasks_[scheduling_class]
+                         : tasks_to_schedule_[scheduling_class];
+  std::vector<std::shared_ptr<internal::Work>> batch;
+  std::vector<std::shared_ptr<bool>> replied;
+  batch.reserve(tasks.size());
+  replied.reserve(tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    RAY_CHECK_EQ(tasks[i].GetTaskSpecification().GetSchedulingClass(), scheduling_class);
+    auto send_reply_callback = send_reply_callbacks[i];
+    auto is_replied = std::make_shared<bool>(false);
+    auto work = std::make_shared<internal::Work>(
+        tasks[i],
+        /*grant_or_reject=*/false,
+        is_selected_based_on_locality,
+        replies[i],
+        [send_reply_callback, is_replied] {
+          *is_replied = true;
+          send_reply_callback(Status::OK(), nullptr, nullptr);
+        });
+    batch.push_back(work);
+    replied.push_back(std::move(is_replied));
+    work_queue.push_back(std::move(work));
+  }
+  ScheduleAndDispatchTasks();
+
+  // The leases that are spilled back or waiting for a worker are resolved right away.
+  // The others would hold up the reply, and the workers granted in the meantime, so
+  // they are rejected.
+  std::vector<std::shared_ptr<internal::Work>> works_to_reject;
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (!*replied[i] &&
+        batch[i]->GetState() != internal::WorkStatus::WAITING_FOR_WORKER) {
+      works_to_reject.push_back(batch[i]);
+    }
+  }
+  if (works_to_reject.size() == batch.size()) {
+    // Nothing could be dispatched. Keep one lease queued so that it's granted as soon
+    // as resources free up.
+    works_to_reject.erase(works_to_reject.begin());
+  }
+  if (works_to_reject.empty()) {
+    return;
+  }
+
+  // The works still queued here couldn't be placed on any node. The others are queued
+  // on this node, waiting for their arguments or for resources.
+  absl::flat_hash_set<const internal::Work *> rejected_works;
+  for (const auto &work : works_to_reject) {
+    rejected_works.insert(work.get());
+  }
+  absl::flat_hash_set<const internal::Work *> unplaced_works;
+  for (auto *queues : {&tasks_to_schedule_, &infeasible_tasks_}) {
+    auto queue_it = queues->find(scheduling_class);
+    if (queue_it == queues->end()) {
+      continue;
+    }
+    auto &queue = queue_it->second;
+    queue.erase(std::remove_if(queue.begin(),
+                               queue.end(),
+                               [&rejected_works, &unplaced_works](const auto &work) {
+                                 if (!rejected_works.contains(work.get())) {
+                                   return false;
+                                 }
+                                 unplaced_works.insert(work.get());
+                                 return true;
+                               }),
+                queue.end());
+    if (queue.empty()) {
+      queues->erase(queue_it);
+    }
+  }
+  for (const auto &work : works_to_reject) {
+    const auto &task_id = work->task.GetTaskSpecification().TaskId();
+    RAY_LOG(DEBUG) << "Rejecting task " << task_id << " of a multi-lease request";
+    if (unplaced_works.contains(work.get())) {
+      work->reply->set_rejected(true);
+      work->callback();
+    } else {
+      RAY_CHECK(local_task_manager_->RejectTask(task_id));
+    }
+  }
+  if (RayConfig::instance().prefetch_queued_task_args() &&
+      infeasible_tasks_.count(scheduling_class) == 0) {
+    // The owner will request these leases again, most likely from this node.
+    local_task_manager_->PrefetchTaskArgs(works_to_reject);
+  }
+}
+
 namespace {
 void ReplyCancelled(const internal::Work &work,
                     rpc::RequestWorkerLeaseReply::SchedulingFailureType failure_type,
@@ -174,9 +274,37 @@ void ClusterTaskManager::ScheduleAndDispatchTasks() {
   }
   works_to_cancel.clear();
 
+  if (RayConfig::instance().prefetch_queued_task_args()) {
+    PrefetchQueuedTaskArgs();
+  }
+
   local_task_manager_->ScheduleAndDispatchTasks();
 }
 
+void ClusterTaskManager::PrefetchQueuedTaskArgs() {
+  if (tasks_to_schedule_.empty()) {
+    return;
+  }
+  const size_t max_tasks = RayConfig::instance().prefetch_queued_task_args_max_tasks();
+  std::vector<std::shared_ptr<internal::Work>> works;
+  for (const auto &shapes_it : tasks_to_schedule_) {
+    for (const auto &work : shapes_it.second) {
+      if (works.size() >= max_tasks) {
+        break;
+      }
+      const auto &spec = work->task.GetTaskSpecification();
+      // Skip tasks that can only run on another node.
+      if (spec.IsNodeAffinitySchedulingStrategy() &&
+          !spec.GetNodeAffinitySchedulingStrategySoft() &&
+          spec.GetNodeAffinitySchedulingStrategyNodeId() != self_node_id_) {
+        continue;
+      }
+      works.push_back(work);
+    }
+  }
+  local_task_manager_->PrefetchTaskArgs(works);
+}
+
 void ClusterTaskManager::TryScheduleInfeasibleTask() {
   for (auto shapes_it = infeasible_tasks_.begin();
        shapes_it != infeasible_tasks_.end();) {
@@ -227,6 +355,7 @@ bool ClusterTaskManager::CancelTask(
       const auto &task = (*work_it)->task;
       if (task.GetTaskSpecification().TaskId() == task_id) {
         RAY_LOG(DEBUG) << "Canceling task " << task_id << " from schedule queue.";
+        local_task_manager_->CancelTaskArgsPrefetch(task_id);
         ReplyCancelled(*(*work_it), failure_type, scheduling_failure_message);
         work_queue.erase(work_it);
         if (work_queue.empty()) {
@@ -244,6 +373,7 @@ bool ClusterTaskManager::CancelTask(
       const auto &task = (*work_it)->task;
       if (task.GetTaskSpecification().TaskId() == task_id) {
         RAY_LOG(DEBUG) << "Canceling task " << task_id << " from infeasible queue.";
+        local_task_manager_->CancelTaskArgsPrefetch(task_id);
         ReplyCancelled(*(*work_it), failure_type, scheduling_failure_message);
         work_queue.erase(work_it);
         if (work_queue.empty()) {
@@ -263,13 +393,15 @@ void ClusterTaskManager::CancelTaskForOwner(
     rpc::RequestWorkerLeaseReply::SchedulingFailureType failure_type,
     const std::string &scheduling_failure_message) {
   std::function<bool(std::shared_ptr<internal::Work>)> filter(
-      [owner_task_id, failure_type, scheduling_failure_message](
+      [this, owner_task_id, failure_type, scheduling_failure_message](
           std::shared_ptr<internal::Work> work) {
         auto task = work->task;
         if (task.GetTaskSpecification().ParentTaskId() == owner_task_id) {
           if (!task.GetTaskSpecification().IsDetachedActor()) {
             RAY_LOG(DEBUG) << "Canceling task from owner " << owner_task_id
                            << " for task " << task.GetTaskSpecification().DebugString();
+            local_task_manager_->CancelTaskArgsPrefetch(
+                task.GetTaskSpecification().TaskId());
             ReplyCancelled(*work, failure_type, scheduling_failure_message);
             return true;
           }
@@ -369,6 +501,9 @@ void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
     return;
   }
 
+  // The task won't be queued here, so its arguments are not needed here.
+  local_task_manager_->CancelTaskArgsPrefetch(work->task.GetTaskSpecification().TaskId());
+
   auto send_reply_callback = work->callback;
 
   if (work->grant_or_reject) {
@@ -73,6 +73,21 @@ class ClusterTaskManager : public ClusterTaskManagerInterface {
                             rpc::RequestWorkerLeaseReply *reply,
                             rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Queue tasks of the same shape and schedule them in one pass. This happens when
+  /// processing a multi-lease request. The tasks that can't be spilled back or
+  /// dispatched to a worker right away are rejected, except that one of them stays
+  /// queued if none of the tasks could be dispatched.
+  ///
+  /// \param tasks: The incoming tasks to be queued and scheduled.
+  /// \param is_selected_based_on_locality : should schedule on local node if possible.
+  /// \param replies: The replies of the lease requests, one per task.
+  /// \param send_reply_callbacks: The functions used during dispatching, one per task.
+  void QueueAndScheduleTasks(
+      const std::vector<RayTask> &tasks,
+      bool is_selected_based_on_locality,
+      const std::vector<rpc::RequestWorkerLeaseReply *> &replies,
+      const std::vector<rpc::SendReplyCallback> &send_reply_callbacks) override;
+
   /// Attempt to cancel an already queued task.
   ///
   /// \param task_id: The id of the task to remove.
@@ -153,6 +168,11 @@ class ClusterTaskManager : public ClusterTaskManagerInterface {
   void ScheduleOnNode(const NodeID &node_to_schedule,
                       const std::shared_ptr<internal::Work> &work);
 
+  /// Ask the local task manager to prefetch the arguments of the tasks that
+  /// are still waiting for resources, since they will most likely run on this
+  /// node once resources free up.
+  void PrefetchQueuedTaskArgs();
+
   /// Recompute the debug stats.
   /// It is needed because updating the debug state is expensive for cluster_task_manager.
   /// TODO(sang): Update the internal states value dynamically instead of iterating the
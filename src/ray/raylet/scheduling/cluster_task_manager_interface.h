@@ -74,6 +74,22 @@ class ClusterTaskManagerInterface {
                                     rpc::RequestWorkerLeaseReply *reply,
                                     rpc::SendReplyCallback send_reply_callback) = 0;
 
+  /// Queue tasks of the same shape and schedule them in one pass. This happens when
+  /// processing a multi-lease request. The tasks that can't be spilled back or
+  /// dispatched to a worker right away are rejected, except that one of them stays
+  /// queued if none of the tasks could be dispatched, so that the requester waits for
+  /// resources like it does with a single lease request.
+  ///
+  /// \param tasks: The incoming tasks to be queued and scheduled.
+  /// \param is_selected_based_on_locality : should schedule on local node if possible.
+  /// \param replies: The replies of the lease requests, one per task.
+  /// \param send_reply_callbacks: The functions used during dispatching, one per task.
+  virtual void QueueAndScheduleTasks(
+      const std::vector<RayTask> &tasks,
+      bool is_selected_based_on_locality,
+      const std::vector<rpc::RequestWorkerLeaseReply *> &replies,
+      const std::vector<rpc::SendReplyCallback> &send_reply_callbacks) = 0;
+
   /// Return if any tasks are pending resource acquisition.
   ///
   /// \param[in] exemplar An example task that is deadlocking.
@@ -196,6 +196,7 @@ class MockTaskDependencyManager : public TaskDependencyManagerInterface {
                                const std::vector<rpc::ObjectReference> &required_objects,
                                const TaskMetricsKey &task_key) {
     RAY_CHECK(subscribed_tasks.insert(task_id).second);
+    prefetched_tasks.erase(task_id);
     for (auto &obj_ref : required_objects) {
       if (missing_objects_.find(ObjectRefToId(obj_ref)) != missing_objects_.end()) {
         return false;
@@ -214,8 +215,19 @@ class MockTaskDependencyManager : public TaskDependencyManagerInterface {
 
   bool CheckObjectLocal(const ObjectID &object_id) const { return true; }
 
+  void PrefetchTaskDependencies(const TaskID &task_id,
+                                const std::vector<rpc::ObjectReference> &required_objects,
+                                const TaskMetricsKey &task_key) {
+    prefetched_tasks.insert(task_id);
+  }
+
+  void CancelPrefetchTaskDependencies(const TaskID &task_id) {
+    prefetched_tasks.erase(task_id);
+  }
+
   std::unordered_set<ObjectID> &missing_objects_;
   std::unordered_set<TaskID> subscribed_tasks;
+  std::unordered_set<TaskID> prefetched_tasks;
   std::unordered_set<TaskID> blocked_tasks;
 };
 
@@ -336,6 +348,9 @@ class ClusterTaskManagerTest : public ::testing::Test {
     ASSERT_TRUE(local_task_manager_->info_by_sched_cls_.empty());
     ASSERT_EQ(local_task_manager_->pinned_task_arguments_bytes_, 0);
     ASSERT_TRUE(dependency_manager_.subscribed_tasks.empty());
+    ASSERT_TRUE(local_task_manager_->prefetched_tasks_.empty());
+    ASSERT_TRUE(local_task_manager_->prefetched_tasks_index_.empty());
+    ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
   }
 
   void AssertPinnedTaskArgumentsPresent(const RayTask &task) {
@@ -869,6 +884,118 @@ TEST_F(ClusterTaskManagerTest, TestGrantOrReject) {
   AssertNoLeaks();
 }
 
+TEST_F(ClusterTaskManagerTest, TestMultiLeaseRequest) {
+  for (int i = 0; i < 3; i++) {
+    pool_.PushWorker(std::make_shared<MockWorker>(WorkerID::FromRandom(), 1234 + i));
+  }
+  const RayTask base_task = CreateTask({{ray::kCPU_ResourceLabel, 3}});
+  auto create_tasks = [&base_task](int num_tasks) {
+    std::vector<RayTask> tasks;
+    for (int i = 0; i < num_tasks; i++) {
+      auto message = base_task.GetTaskSpecification().GetMessage();
+      message.set_task_id(RandomTaskId().Binary());
+      tasks.emplace_back(TaskSpecification(message));
+    }
+    return tasks;
+  };
+  int num_callbacks = 0;
+  auto create_callbacks = [&num_callbacks](int num_tasks) {
+    return std::vector<rpc::SendReplyCallback>(
+        num_tasks,
+        [&num_callbacks](Status, std::function<void()>, std::function<void()>) {
+          num_callbacks++;
+        });
+  };
+
+  // Two of the leases fit on the node, the other two are rejected right away.
+  std::vector<rpc::RequestWorkerLeaseReply> replies(4);
+  task_manager_.QueueAndScheduleTasks(
+      create_tasks(4),
+      /*is_selected_based_on_locality=*/false,
+      {&replies[0], &replies[1], &replies[2], &replies[3]},
+      create_callbacks(4));
+  ASSERT_EQ(num_callbacks, 2);
+  ASSERT_TRUE(replies[2].rejected());
+  ASSERT_TRUE(replies[3].rejected());
+  pool_.TriggerCallbacks();
+  ASSERT_EQ(num_callbacks, 4);
+  ASSERT_EQ(leased_workers_.size(), 2);
+  ASSERT_FALSE(replies[0].rejected());
+  ASSERT_FALSE(replies[1].rejected());
+
+  // None of the leases fit now. One of them stays queued and the other is rejected.
+  std::vector<rpc::RequestWorkerLeaseReply> more_replies(2);
+  task_manager_.QueueAndScheduleTasks(create_tasks(2),
+                                      /*is_selected_based_on_locality=*/false,
+                                      {&more_replies[0], &more_replies[1]},
+                                      create_callbacks(2));
+  pool_.TriggerCallbacks();
+  ASSERT_EQ(num_callbacks, 5);
+  ASSERT_TRUE(more_replies[1].rejected());
+  ASSERT_EQ(task_manager_.GetPendingQueueSize(), 1);
+
+  // The queued lease is granted once a task finishes.
+  RayTask finished_task;
+  local_task_manager_->TaskFinished(leased_workers_.begin()->second, &finished_task);
+  leased_workers_.erase(leased_workers_.begin());
+  task_manager_.ScheduleAndDispatchTasks();
+  pool_.TriggerCallbacks();
+  ASSERT_EQ(num_callbacks, 6);
+  ASSERT_FALSE(more_replies[0].rejected());
+  ASSERT_EQ(leased_workers_.size(), 2);
+
+  while (!leased_workers_.empty()) {
+    local_task_manager_->TaskFinished(leased_workers_.begin()->second, &finished_task);
+    leased_workers_.erase(leased_workers_.begin());
+  }
+  AssertNoLeaks();
+}
+
+TEST_F(ClusterTaskManagerTest, TestMultiLeaseRequestWaitingForArgs) {
+  pool_.PushWorker(std::make_shared<MockWorker>(WorkerID::FromRandom(), 1234));
+  const RayTask base_task = CreateTask({{ray::kCPU_ResourceLabel, 1}}, 1);
+  const auto missing_arg = base_task.GetTaskSpecification().GetDependencyIds()[0];
+  missing_objects_.insert(missing_arg);
+  std::vector<RayTask> tasks;
+  for (int i = 0; i < 3; i++) {
+    auto message = base_task.GetTaskSpecification().GetMessage();
+    message.set_task_id(RandomTaskId().Binary());
+    tasks.emplace_back(TaskSpecification(message));
+  }
+  int num_callbacks = 0;
+  std::vector<rpc::RequestWorkerLeaseReply> replies(3);
+  task_manager_.QueueAndScheduleTasks(
+      tasks,
+      /*is_selected_based_on_locality=*/false,
+      {&replies[0], &replies[1], &replies[2]},
+      std::vector<rpc::SendReplyCallback>(
+          3, [&num_callbacks](Status, std::function<void()>, std::function<void()>) {
+            num_callbacks++;
+          }));
+
+  // The leases are queued on this node, waiting for their argument. They would hold
+  // up the reply, so all of them but one are rejected right away.
+  ASSERT_EQ(num_callbacks, 2);
+  ASSERT_FALSE(replies[0].rejected());
+  ASSERT_TRUE(replies[1].rejected());
+  ASSERT_TRUE(replies[2].rejected());
+  std::unordered_set<TaskID> expected_subscribed_tasks = {
+      tasks[0].GetTaskSpecification().TaskId()};
+  ASSERT_EQ(dependency_manager_.subscribed_tasks, expected_subscribed_tasks);
+
+  // The queued lease is granted once its argument is local.
+  missing_objects_.erase(missing_arg);
+  local_task_manager_->TasksUnblocked({tasks[0].GetTaskSpecification().TaskId()});
+  pool_.TriggerCallbacks();
+  ASSERT_EQ(num_callbacks, 3);
+  ASSERT_FALSE(replies[0].rejected());
+  ASSERT_EQ(leased_workers_.size(), 1);
+
+  RayTask finished_task;
+  local_task_manager_->TaskFinished(leased_workers_.begin()->second, &finished_task);
+  AssertNoLeaks();
+}
+
 TEST_F(ClusterTaskManagerTest, TestSpillAfterAssigned) {
   /*
     Test the race condition in which a task is assigned to the local node, but
@@ -980,6 +1107,40 @@ TEST_F(ClusterTaskManagerTest, NotOKPopWorkerTest) {
   AssertNoLeaks();
 }
 
+TEST_F(ClusterTaskManagerTest, WorkerStartFailedTest) {
+  RayConfig::instance().initialize(
+      R"({"scheduler_top_k_absolute": 1, "worker_start_max_failures": 3})");
+  RayTask task = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+  rpc::RequestWorkerLeaseReply reply;
+  bool callback_called = false;
+  bool *callback_called_ptr = &callback_called;
+  auto callback = [callback_called_ptr](
+                      Status, std::function<void()>, std::function<void()>) {
+    *callback_called_ptr = true;
+  };
+  task_manager_.QueueAndScheduleTask(task, false, false, &reply, callback);
+
+  // The task waits for another worker until workers failed to start too many times
+  // in a row.
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(NumTasksToDispatchWithStatus(internal::WorkStatus::WAITING_FOR_WORKER),
+              1);
+    pool_.TriggerCallbacksWithNotOKStatus(PopWorkerStatus::WorkerStartFailed);
+    ASSERT_FALSE(callback_called);
+    ASSERT_EQ(NumTasksToDispatchWithStatus(internal::WorkStatus::WAITING), 1);
+    task_manager_.ScheduleAndDispatchTasks();
+  }
+  pool_.TriggerCallbacksWithNotOKStatus(PopWorkerStatus::WorkerStartFailed);
+  ASSERT_TRUE(callback_called);
+  ASSERT_TRUE(reply.canceled());
+  ASSERT_EQ(reply.failure_type(),
+            rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_UNSCHEDULABLE);
+  ASSERT_EQ(NumTasksToDispatchWithStatus(internal::WorkStatus::WAITING), 0);
+  ASSERT_EQ(NumRunningTasks(), 0);
+
+  AssertNoLeaks();
+}
+
 TEST_F(ClusterTaskManagerTest, TaskUnschedulableTest) {
   TaskSpecification task_spec =
       CreateTask({{ray::kCPU_ResourceLabel, 1}}).GetTaskSpecification();
@@ -1583,6 +1744,134 @@ TEST_F(ClusterTaskManagerTest, ArgumentEvicted) {
   AssertNoLeaks();
 }
 
+TEST_F(ClusterTaskManagerTest, PrefetchTaskArgsTest) {
+  /*
+    Test that the local task manager prefetches the arguments of tasks that are
+    not queued yet, up to a limit and until a timeout, and that the prefetch is
+    handed over to the dependency request once the task is queued.
+   */
+  const uint64_t max_tasks = RayConfig::instance().prefetch_queued_task_args_max_tasks();
+  RayConfig::instance().prefetch_queued_task_args_max_tasks() = 2;
+  std::vector<RayTask> tasks;
+  std::vector<std::shared_ptr<internal::Work>> works;
+  for (int i = 0; i < 3; i++) {
+    tasks.push_back(CreateTask({{ray::kCPU_ResourceLabel, 1}}, /*num_args=*/1));
+    works.push_back(std::make_shared<internal::Work>(
+        tasks.back(), false, false, nullptr, [] {}));
+  }
+  // Tasks without arguments are not prefetched.
+  auto task_without_args = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+  works.push_back(std::make_shared<internal::Work>(
+      task_without_args, false, false, nullptr, [] {}));
+
+  // The oldest prefetch is evicted to stay within the limit.
+  local_task_manager_->PrefetchTaskArgs(works);
+  std::unordered_set<TaskID> expected_prefetched_tasks = {
+      tasks[1].GetTaskSpecification().TaskId(),
+      tasks[2].GetTaskSpecification().TaskId()};
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, expected_prefetched_tasks);
+
+  // Queueing a task takes over its prefetch.
+  rpc::RequestWorkerLeaseReply reply;
+  bool callback_occurred = false;
+  task_manager_.QueueAndScheduleTask(
+      tasks[1],
+      false,
+      false,
+      &reply,
+      [&callback_occurred](Status, std::function<void()>, std::function<void()>) {
+        callback_occurred = true;
+      });
+  pool_.TriggerCallbacks();
+  expected_prefetched_tasks = {tasks[2].GetTaskSpecification().TaskId()};
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, expected_prefetched_tasks);
+  ASSERT_EQ(local_task_manager_->prefetched_tasks_.size(), 1);
+
+  // The remaining prefetch times out.
+  current_time_ms_ += RayConfig::instance().prefetch_queued_task_args_timeout_ms();
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
+
+  std::shared_ptr<MockWorker> worker =
+      std::make_shared<MockWorker>(WorkerID::FromRandom(), 1234);
+  pool_.PushWorker(std::static_pointer_cast<WorkerInterface>(worker));
+  task_manager_.ScheduleAndDispatchTasks();
+  pool_.TriggerCallbacks();
+  ASSERT_TRUE(callback_occurred);
+  RayTask finished_task;
+  local_task_manager_->TaskFinished(leased_workers_.begin()->second, &finished_task);
+  RayConfig::instance().prefetch_queued_task_args_max_tasks() = max_tasks;
+  AssertNoLeaks();
+}
+
+TEST_F(ClusterTaskManagerTest, PrefetchQueuedTaskArgsCancelTest) {
+  /*
+    Test that the prefetch of a queued task's arguments is canceled when the
+    task is canceled or spilled back, and that a task whose prefetch timed out
+    is not prefetched again. The fixture reinitializes the config per test.
+   */
+  RayConfig::instance().prefetch_queued_task_args() = true;
+  std::shared_ptr<MockWorker> worker =
+      std::make_shared<MockWorker>(WorkerID::FromRandom(), 1234);
+  pool_.PushWorker(std::static_pointer_cast<WorkerInterface>(worker));
+  int num_callbacks = 0;
+  auto callback = [&](Status, std::function<void()>, std::function<void()>) {
+    num_callbacks++;
+  };
+
+  // Take all the local CPUs so that the next tasks stay queued.
+  auto running_task = CreateTask({{ray::kCPU_ResourceLabel, 8}});
+  rpc::RequestWorkerLeaseReply running_reply;
+  task_manager_.QueueAndScheduleTask(
+      running_task, false, false, &running_reply, callback);
+  pool_.TriggerCallbacks();
+  ASSERT_EQ(leased_workers_.size(), 1);
+
+  // Canceling a queued task cancels its prefetch.
+  auto canceled_task = CreateTask({{ray::kCPU_ResourceLabel, 8}}, /*num_args=*/1);
+  const auto canceled_task_id = canceled_task.GetTaskSpecification().TaskId();
+  rpc::RequestWorkerLeaseReply canceled_reply;
+  task_manager_.QueueAndScheduleTask(
+      canceled_task, false, false, &canceled_reply, callback);
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.count(canceled_task_id));
+  ASSERT_TRUE(task_manager_.CancelTask(canceled_task_id));
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
+  ASSERT_TRUE(local_task_manager_->prefetched_tasks_.empty());
+
+  // A task whose prefetch timed out is not prefetched again.
+  auto expired_task = CreateTask({{ray::kCPU_ResourceLabel, 8}}, /*num_args=*/1);
+  const auto expired_task_id = expired_task.GetTaskSpecification().TaskId();
+  rpc::RequestWorkerLeaseReply expired_reply;
+  task_manager_.QueueAndScheduleTask(
+      expired_task, false, false, &expired_reply, callback);
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.count(expired_task_id));
+  current_time_ms_ += RayConfig::instance().prefetch_queued_task_args_timeout_ms();
+  task_manager_.ScheduleAndDispatchTasks();
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
+
+  // Spilling a task back cancels its prefetch.
+  auto spilled_task = CreateTask({{ray::kCPU_ResourceLabel, 8}}, /*num_args=*/1);
+  const auto spilled_task_id = spilled_task.GetTaskSpecification().TaskId();
+  rpc::RequestWorkerLeaseReply spilled_reply;
+  task_manager_.QueueAndScheduleTask(
+      spilled_task, false, false, &spilled_reply, callback);
+  std::unordered_set<TaskID> expected_prefetched_tasks = {spilled_task_id};
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, expected_prefetched_tasks);
+  auto remote_node_id = NodeID::FromRandom();
+  AddNode(remote_node_id, 16);
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_EQ(spilled_reply.retry_at_raylet_address().raylet_id(), remote_node_id.Binary());
+  ASSERT_EQ(expired_reply.retry_at_raylet_address().raylet_id(), remote_node_id.Binary());
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
+  ASSERT_TRUE(local_task_manager_->prefetched_tasks_.empty());
+  ASSERT_EQ(num_callbacks, 4);
+
+  RayTask finished_task;
+  local_task_manager_->TaskFinished(leased_workers_.begin()->second, &finished_task);
+  AssertNoLeaks();
+}
+
 TEST_F(ClusterTaskManagerTest, FeasibleToNonFeasible) {
   // Test the case, when resources changes in local node, the feasible task should
   // able to transfer to infeasible task
@@ -60,6 +60,9 @@ class Work {
   rpc::RequestWorkerLeaseReply *reply;
   std::function<void(void)> callback;
   std::shared_ptr<TaskResourceInstances> allocated_instances;
+  /// Whether a prefetch of the task's arguments timed out. The arguments are
+  /// not prefetched again for this request.
+  bool args_prefetch_expired = false;
   Work(RayTask task,
        bool grant_or_reject,
        bool is_selected_based_on_locality,
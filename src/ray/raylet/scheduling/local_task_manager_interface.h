@@ -37,6 +37,22 @@ class ILocalTaskManager {
   // Schedule and dispatch tasks.
   virtual void ScheduleAndDispatchTasks() = 0;
 
+  /// Prefetch the arguments of tasks that are likely to be queued on this node
+  /// soon, but can't be placed on any node yet. A prefetch lasts until the
+  /// task is queued here, spilled back or cancelled, or until it is evicted by
+  /// newer prefetches or times out. A task whose prefetch timed out is not
+  /// prefetched again.
+  ///
+  /// \param works: The tasks whose arguments to prefetch.
+  virtual void PrefetchTaskArgs(
+      const std::vector<std::shared_ptr<internal::Work>> &works) = 0;
+
+  /// Cancel the prefetch of a task's arguments, if any, because the task
+  /// won't be queued on this node.
+  ///
+  /// \param task_id: The task whose arguments were prefetched.
+  virtual void CancelTaskArgsPrefetch(const TaskID &task_id) = 0;
+
   /// Attempt to cancel an already queued task.
   ///
   /// \param task_id: The id of the task to remove.
@@ -50,6 +66,13 @@ class ILocalTaskManager {
           rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_INTENDED,
       const std::string &scheduling_failure_message = "") = 0;
 
+  /// Reject a queued task, i.e. tell its owner to request it again later.
+  ///
+  /// \param task_id: The id of the task to reject.
+  ///
+  /// \return True if the task was queued and is now removed.
+  virtual bool RejectTask(const TaskID &task_id) = 0;
+
   virtual const absl::flat_hash_map<SchedulingClass,
                                     std::deque<std::shared_ptr<internal::Work>>>
       &GetTaskToDispatch() const = 0;
@@ -88,6 +111,11 @@ class NoopLocalTaskManager : public ILocalTaskManager {
   // Schedule and dispatch tasks.
   void ScheduleAndDispatchTasks() override {}
 
+  void PrefetchTaskArgs(
+      const std::vector<std::shared_ptr<internal::Work>> &works) override {}
+
+  void CancelTaskArgsPrefetch(const TaskID &task_id) override {}
+
   /// Attempt to cancel an already queued task.
   ///
   /// \param task_id: The id of the task to remove.
@@ -102,6 +130,8 @@ class NoopLocalTaskManager : public ILocalTaskManager {
     return false;
   }
 
+  bool RejectTask(const TaskID &task_id) override { return false; }
+
   const absl::flat_hash_map<SchedulingClass, std::deque<std::shared_ptr<internal::Work>>>
       &GetTaskToDispatch() const override {
     static const absl::flat_hash_map<SchedulingClass,
@@ -204,6 +204,16 @@ class MockIOWorkerClient : public rpc::CoreWorkerClientInterface {
     return deleted_urls_size;
   }
 
+  /// Reply to all delete requests and return the number of reclaimed urls.
+  int ReplyAllDeleteSpilledObjects() {
+    int reclaimed_urls_size = 0;
+    while (!delete_requests.empty()) {
+      reclaimed_urls_size += delete_requests.front().reclaimed_objects_url_size();
+      ReplyDeleteSpilledObjects();
+    }
+    return reclaimed_urls_size;
+  }
+
   int FailDeleteSpilledObject(Status status = Status::IOError("io error")) {
     if (delete_callbacks.size() == 0) {
       return 0;
@@ -364,13 +374,19 @@ class LocalObjectManagerTestWithMinSpillingSize {
 
   size_t GetCurrentSpilledCount() { return manager.spilled_objects_url_.size(); }
 
+  int64_t GetSpilledFileBytes() {
+    return manager.spilled_bytes_current_ + manager.spilled_file_dead_bytes_;
+  }
+
+  size_t GetSpilledFileCount() { return manager.spilled_files_.size(); }
+
   void AssertNoLeaks() {
     // TODO(swang): Assert this for all tests.
     ASSERT_TRUE(manager.pinned_objects_size_ == 0);
     ASSERT_TRUE(manager.pinned_objects_.empty());
     ASSERT_TRUE(manager.spilled_objects_url_.empty());
     ASSERT_TRUE(manager.objects_pending_spill_.empty());
-    ASSERT_TRUE(manager.url_ref_count_.empty());
+    ASSERT_TRUE(manager.spilled_files_.empty());
     ASSERT_TRUE(manager.local_objects_.empty());
     ASSERT_TRUE(manager.spilled_object_pending_delete_.empty());
     ASSERT_FALSE(manager.IsSpillingInProgress());
@@ -1535,6 +1551,87 @@ TEST_F(LocalObjectManagerFusedTest, TestMinSpillingSizeMaxFusionCount) {
   ASSERT_EQ(GetCurrentSpilledBytes(), object_size * 40);
 }
 
+TEST_F(LocalObjectManagerFusedTest, TestSpillFusionByOwnerAfterMixedFrees) {
+  ///
+  /// Test that objects are fused into spill files by owner, so that freeing all
+  /// objects of one owner frees whole files, and that the space of freed objects
+  /// in mostly dead files is reclaimed.
+  ///
+  rpc::Address owner_address_a;
+  owner_address_a.set_worker_id(WorkerID::FromRandom().Binary());
+  rpc::Address owner_address_b;
+  owner_address_b.set_worker_id(WorkerID::FromRandom().Binary());
+
+  // Each owner has 10 objects that fill up the min spilling size together.
+  int64_t object_size = 10;
+  auto pin_objects = [&](const rpc::Address &owner_address) {
+    std::vector<ObjectID> object_ids;
+    std::vector<std::unique_ptr<RayObject>> objects;
+    for (size_t i = 0; i < 10; i++) {
+      ObjectID object_id = ObjectID::FromRandom();
+      object_ids.push_back(object_id);
+      auto data_buffer =
+          std::make_shared<MockObjectBuffer>(object_size, object_id, unpins);
+      auto object = std::make_unique<RayObject>(
+          data_buffer, nullptr, std::vector<rpc::ObjectReference>());
+      objects.push_back(std::move(object));
+    }
+    manager.PinObjectsAndWaitForFree(object_ids, std::move(objects), owner_address);
+    return object_ids;
+  };
+  const auto object_ids_a = pin_objects(owner_address_a);
+  const auto object_ids_b = pin_objects(owner_address_b);
+
+  // Both owners' objects are spilled in separate files, although the spill batch
+  // could hold up to 15 objects.
+  manager.SpillObjectUptoMaxThroughput();
+  ASSERT_TRUE(worker_pool.FlushPopSpillWorkerCallbacks());
+  ASSERT_TRUE(worker_pool.FlushPopSpillWorkerCallbacks());
+  EXPECT_CALL(worker_pool, PushSpillWorker(_)).Times(2);
+  for (const std::string file : {"file0", "file1"}) {
+    std::vector<std::string> urls;
+    for (int i = 0; i < 10; i++) {
+      urls.push_back(BuildURL(file, i, 10));
+    }
+    ASSERT_TRUE(worker_pool.io_worker_client->ReplySpillObjects(urls));
+  }
+  while (owner_client->ReplyUpdateObjectLocationBatch()) {
+  }
+  ASSERT_EQ(GetCurrentSpilledCount(), 20);
+  ASSERT_EQ(GetSpilledFileCount(), 2);
+  ASSERT_EQ(GetSpilledFileBytes(), 20 * object_size);
+  for (const auto &object_ids : {object_ids_a, object_ids_b}) {
+    const auto base_url = (*ParseURL(owner_client->object_urls[object_ids[0]]))["url"];
+    for (const auto &object_id : object_ids) {
+      ASSERT_EQ((*ParseURL(owner_client->object_urls[object_id]))["url"], base_url);
+    }
+  }
+
+  // All objects of owner A go out of scope, which frees a whole file.
+  for (const auto &object_id : object_ids_a) {
+    EXPECT_CALL(*subscriber_, Unsubscribe(_, _, object_id.Binary()));
+    ASSERT_TRUE(subscriber_->PublishObjectEviction(
+        WorkerID::FromBinary(owner_address_a.worker_id())));
+  }
+  manager.ProcessSpilledObjectsDeleteQueue(/* max_batch_size */ 30);
+  worker_pool.io_worker_client->ReplyAllDeleteSpilledObjects();
+  ASSERT_EQ(GetSpilledFileCount(), 1);
+  ASSERT_EQ(GetSpilledFileBytes(), 10 * object_size);
+
+  // Most objects of owner B go out of scope. The space of the freed objects is
+  // reclaimed once less than half of the file is in scope.
+  for (size_t i = 0; i < 6; i++) {
+    EXPECT_CALL(*subscriber_, Unsubscribe(_, _, object_ids_b[i].Binary()));
+    ASSERT_TRUE(subscriber_->PublishObjectEviction(
+        WorkerID::FromBinary(owner_address_b.worker_id())));
+  }
+  manager.ProcessSpilledObjectsDeleteQueue(/* max_batch_size */ 30);
+  ASSERT_EQ(worker_pool.io_worker_client->ReplyAllDeleteSpilledObjects(), 6);
+  ASSERT_EQ(GetSpilledFileCount(), 1);
+  ASSERT_EQ(GetCurrentSpilledBytes(), 4 * object_size);
+  ASSERT_EQ(GetSpilledFileBytes(), 4 * object_size);
+}
+
 TEST_F(LocalObjectManagerTest, TestPinBytes) {
   rpc::Address owner_address;
   owner_address.set_worker_id(WorkerID::FromRandom().Binary());
@@ -27,6 +27,7 @@
 #include "ray/core_worker/common.h"
 #include "ray/gcs/pb_util.h"
 #include "ray/stats/metric_defs.h"
+#include "ray/util/filesystem.h"
 #include "ray/util/logging.h"
 #include "ray/util/util.h"
 
@@ -146,7 +147,10 @@ WorkerPool::~WorkerPool() {
   for (const auto &entry : states_by_lang_) {
     // Kill all the worker processes.
     for (auto &worker_process : entry.second.worker_processes) {
-      procs_to_kill.insert(worker_process.second.proc);
+      // The process is null if it's still being forked from a zygote.
+      if (!worker_process.second.proc.IsNull()) {
+        procs_to_kill.insert(worker_process.second.proc);
+      }
     }
   }
   for (Process proc : procs_to_kill) {
@@ -462,18 +466,28 @@ std::tuple<Process, StartupToken> WorkerPool::StartWorkerProcess(
 
   // Start a process and measure the startup time.
   auto start = std::chrono::high_resolution_clock::now();
-  Process proc = StartProcess(worker_command_args, env);
-  auto end = std::chrono::high_resolution_clock::now();
-  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-  stats::ProcessStartupTimeMs.Record(duration.count());
-  stats::NumWorkersStarted.Record(1);
-  RAY_LOG(INFO) << "Started worker process with pid " << proc.GetId() << ", the token is "
-                << worker_startup_token_counter_;
-  if (!IsIOWorkerType(worker_type)) {
-    AdjustWorkerOomScore(proc.GetId());
+  Process proc;
+  bool forking = false;
+#ifndef _WIN32
+  if (RayConfig::instance().worker_zygote_enabled() && language == Language::PYTHON &&
+      worker_type == rpc::WorkerType::WORKER && dynamic_options.empty() &&
+      (serialized_runtime_env_context.empty() || serialized_runtime_env_context == "{}")) {
+    forking = ForkFromZygote(runtime_env_hash,
+                             language,
+                             worker_startup_token_counter_,
+                             worker_command_args,
+                             env);
+  }
+#endif
+  if (!forking) {
+    proc = StartProcess(worker_command_args, env);
+    if (!proc.IsValid()) {
+      *status = PopWorkerStatus::WorkerStartFailed;
+      return {Process(), (StartupToken)-1};
+    }
+    OnWorkerProcessStarted(proc, worker_startup_token_counter_, worker_type, start);
   }
-  MonitorStartingWorkerProcess(
-      proc, worker_startup_token_counter_, language, worker_type);
+  MonitorStartingWorkerProcess(worker_startup_token_counter_, language, worker_type);
   AddWorkerProcess(state, worker_type, proc, start, runtime_env_info, dynamic_options);
   StartupToken worker_startup_token = worker_startup_token_counter_;
   update_worker_startup_token_counter();
@@ -484,6 +498,22 @@ std::tuple<Process, StartupToken> WorkerPool::StartWorkerProcess(
   return {proc, worker_startup_token};
 }
 
+void WorkerPool::OnWorkerProcessStarted(
+    const Process &proc,
+    StartupToken proc_startup_token,
+    const rpc::WorkerType worker_type,
+    const std::chrono::high_resolution_clock::time_point &start) {
+  auto end = std::chrono::high_resolution_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+  stats::ProcessStartupTimeMs.Record(duration.count());
+  stats::NumWorkersStarted.Record(1);
+  RAY_LOG(INFO) << "Started worker process with pid " << proc.GetId() << ", the token is "
+                << proc_startup_token;
+  if (!IsIOWorkerType(worker_type)) {
+    AdjustWorkerOomScore(proc.GetId());
+  }
+}
+
 void WorkerPool::AdjustWorkerOomScore(pid_t pid) const {
 #ifdef __linux__
   std::ofstream oom_score_file;
@@ -505,8 +535,7 @@ void WorkerPool::AdjustWorkerOomScore(pid_t pid) const {
 #endif
 }
 
-void WorkerPool::MonitorStartingWorkerProcess(const Process &proc,
-                                              StartupToken proc_startup_token,
+void WorkerPool::MonitorStartingWorkerProcess(StartupToken proc_startup_token,
                                               const Language &language,
                                               const rpc::WorkerType worker_type) {
   auto timer = std::make_shared<boost::asio::deadline_timer>(
@@ -514,7 +543,7 @@ void WorkerPool::MonitorStartingWorkerProcess(const Process &proc,
       boost::posix_time::seconds(
           RayConfig::instance().worker_register_timeout_seconds()));
   // Capture timer in lambda to copy it once, so that it can avoid destructing timer.
-  timer->async_wait([timer, language, proc = proc, proc_startup_token, worker_type, this](
+  timer->async_wait([timer, language, proc_startup_token, worker_type, this](
                         const boost::system::error_code e) mutable {
     // check the error code.
     auto &state = this->GetStateForLanguage(language);
@@ -522,6 +551,8 @@ void WorkerPool::MonitorStartingWorkerProcess(const Process &proc,
     // to avoid the zombie worker.
     auto it = state.worker_processes.find(proc_startup_token);
     if (it != state.worker_processes.end() && it->second.is_pending_registration) {
+      // The process is null if the zygote hasn't replied yet.
+      Process proc = it->second.proc;
       RAY_LOG(ERROR)
           << "Some workers of the worker process(" << proc.GetId()
           << ") have not registered within the timeout. "
@@ -600,15 +631,135 @@ Process WorkerPool::StartProcess(const std::vector<std::string> &worker_command_
     if (ec.value() == 24) {
       RAY_LOG(FATAL) << "Too many workers, failed to create a file. Try setting "
                      << "`ulimit -n <num_files>` then restart Ray.";
-    } else {
-      // The worker failed to start. This is a fatal error.
-      RAY_LOG(FATAL) << "Failed to start worker with return value " << ec << ": "
-                     << ec.message();
     }
+    // The spawn reports exec failures, e.g. a bad worker command. Fail this worker
+    // instead of the raylet, like a worker that exits before registering.
+    RAY_LOG(ERROR) << "Failed to start worker with return value " << ec << ": "
+                   << ec.message();
+    return Process();
   }
   return child;
 }
 
+bool WorkerPool::ForkFromZygote(int runtime_env_hash,
+                                const Language &language,
+                                StartupToken startup_token,
+                                const std::vector<std::string> &worker_command_args,
+                                const ProcessEnvironment &env) {
+  if (failed_zygotes_.contains(runtime_env_hash)) {
+    return false;
+  }
+  auto &zygote = zygotes_[runtime_env_hash];
+  if (zygote != nullptr && !zygote->IsAlive()) {
+    RAY_LOG(WARNING) << "Worker zygote " << zygote->SocketPath()
+                     << " died. Workers will be started without zygote.";
+    failed_zygotes_.insert(runtime_env_hash);
+    zygotes_.erase(runtime_env_hash);
+    return false;
+  }
+  if (zygote == nullptr) {
+    // Start the zygote with the command of this worker. This worker is started from
+    // scratch while the zygote is loading.
+    zygote = std::make_unique<WorkerZygote>(
+        *io_service_,
+        JoinPaths(GetUserTempDir(),
+                  "ray_worker_zygote_" + std::to_string(GetPID()) + "_" +
+                      std::to_string(runtime_env_hash)));
+    auto status = zygote->Start(worker_command_args, env);
+    if (!status.ok()) {
+      RAY_LOG(WARNING) << status.ToString();
+      failed_zygotes_.insert(runtime_env_hash);
+      zygotes_.erase(runtime_env_hash);
+    }
+    return false;
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  zygote->ForkAsync(
+      worker_command_args,
+      env,
+      [this, runtime_env_hash, language, startup_token, worker_command_args, env, start](
+          Process proc, bool connected) {
+        auto &state = GetStateForLanguage(language);
+        auto it = state.worker_processes.find(startup_token);
+        if (proc.IsValid()) {
+          if (it != state.worker_processes.end()) {
+            it->second.proc = proc;
+          }
+          OnWorkerProcessStarted(proc, startup_token, rpc::WorkerType::WORKER, start);
+          return;
+        }
+        if (connected) {
+          // The zygote may still fork the worker after the failure, e.g. on a
+          // timeout. Kill it and never fork from it again.
+          auto zygote_it = zygotes_.find(runtime_env_hash);
+          if (zygote_it != zygotes_.end()) {
+            RAY_LOG(WARNING) << "Worker zygote " << zygote_it->second->SocketPath()
+                             << " failed. Workers will be started without zygote.";
+            failed_zygotes_.insert(runtime_env_hash);
+            zygotes_.erase(zygote_it);
+          }
+        }
+        if (it != state.worker_processes.end()) {
+          StartWorkerAfterFailedFork(language, startup_token, worker_command_args, env);
+        }
+      });
+  return true;
+}
+
+void WorkerPool::StartWorkerAfterFailedFork(
+    const Language &language,
+    StartupToken startup_token,
+    std::vector<std::string> worker_command_args,
+    const ProcessEnvironment &env) {
+  auto &state = GetStateForLanguage(language);
+  // Start the worker with a new token, so that a worker which the zygote forks anyway
+  // can't register in its place.
+  StartupToken new_startup_token = worker_startup_token_counter_;
+  update_worker_startup_token_counter();
+  const std::string token_arg = "--startup-token=" + std::to_string(startup_token);
+  for (auto &arg : worker_command_args) {
+    if (arg == token_arg) {
+      arg = "--startup-token=" + std::to_string(new_startup_token);
+    }
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  Process proc = StartProcess(worker_command_args, env);
+  if (!proc.IsValid()) {
+    bool found;
+    bool used;
+    TaskID task_id;
+    InvokePopWorkerCallbackForProcess(state.starting_workers_to_tasks,
+                                      startup_token,
+                                      nullptr,
+                                      PopWorkerStatus::WorkerStartFailed,
+                                      &found,
+                                      &used,
+                                      &task_id);
+    auto it = state.worker_processes.find(startup_token);
+    if (it != state.worker_processes.end()) {
+      DeleteRuntimeEnvIfPossible(it->second.runtime_env_info.serialized_runtime_env());
+      RemoveWorkerProcess(state, startup_token);
+    }
+    TryPendingPopWorkerRequests(language);
+    return;
+  }
+  OnWorkerProcessStarted(proc, new_startup_token, rpc::WorkerType::WORKER, start);
+
+  // Move the process and the task waiting for it to the new token.
+  auto process_it = state.worker_processes.find(startup_token);
+  WorkerProcessInfo process_info = std::move(process_it->second);
+  state.worker_processes.erase(process_it);
+  process_info.proc = proc;
+  state.worker_processes.emplace(new_startup_token, std::move(process_info));
+  auto task_it = state.starting_workers_to_tasks.find(startup_token);
+  if (task_it != state.starting_workers_to_tasks.end()) {
+    TaskWaitingForWorkerInfo task_info = std::move(task_it->second);
+    state.starting_workers_to_tasks.erase(task_it);
+    state.starting_workers_to_tasks.emplace(new_startup_token, std::move(task_info));
+  }
+  MonitorStartingWorkerProcess(new_startup_token, language, rpc::WorkerType::WORKER);
+}
+
 Status WorkerPool::GetNextFreePort(int *port) {
   if (!free_ports_) {
     *port = 0;
@@ -1197,7 +1348,8 @@ void WorkerPool::PopWorker(const TaskSpecification &task_spec,
                                                     serialized_runtime_env_context,
                                                     task_spec.RuntimeEnvInfo());
     if (status == PopWorkerStatus::OK) {
-      RAY_CHECK(proc.IsValid());
+      // The process is null if it's being forked from a zygote.
+      RAY_CHECK_GE(startup_token, 0);
       WarnAboutSize();
       auto task_info = TaskWaitingForWorkerInfo{task_spec.TaskId(), callback};
       state.starting_workers_to_tasks[startup_token] = std::move(task_info);
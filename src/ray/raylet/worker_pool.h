@@ -34,6 +34,7 @@
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/raylet/agent_manager.h"
 #include "ray/raylet/worker.h"
+#include "ray/raylet/worker_zygote.h"
 
 namespace ray {
 
@@ -59,6 +60,9 @@ enum PopWorkerStatus {
   // Any fails of runtime env creation.
   // A nullptr worker will be returned with callback.
   RuntimeEnvCreationFailed = 4,
+  // The worker process failed to start, e.g. the worker command can't be executed.
+  // A nullptr worker will be returned with callback.
+  WorkerStartFailed = 5,
 };
 
 /// \param[in] worker The started worker instance. Nullptr if worker is not started.
@@ -413,7 +417,8 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   /// \param serialized_runtime_env_context The context of runtime env.
   /// \param runtime_env_info The raw runtime env info.
   /// \return The process that we started and a token. If the token is less than 0,
-  /// we didn't start a process.
+  /// we didn't start a process. The process is null while it's being forked from a
+  /// zygote.
   std::tuple<Process, StartupToken> StartWorkerProcess(
       const Language &language,
       const rpc::WorkerType worker_type,
@@ -431,10 +436,48 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   /// \param worker_command_args The command arguments of new worker process.
   /// \param[in] env Additional environment variables to be set on this process besides
   /// the environment variables of the parent process.
-  /// \return An object representing the started worker process.
+  /// \return An object representing the started worker process, or an invalid
+  /// process if it failed to start.
   virtual Process StartProcess(const std::vector<std::string> &worker_command_args,
                                const ProcessEnvironment &env);
 
+  /// Fork a new worker process from the zygote of the runtime env hash. The zygote is
+  /// started if it doesn't exist yet. The fork is asynchronous: the process of the
+  /// token is set when the zygote replies, and the worker is started from scratch
+  /// with a new token if the fork fails.
+  ///
+  /// \param runtime_env_hash The hash of runtime env.
+  /// \param language The language of the worker process.
+  /// \param startup_token The startup token of the worker process.
+  /// \param worker_command_args The command arguments of new worker process.
+  /// \param[in] env Additional environment variables to be set on this process.
+  /// \return Whether the fork is requested. The caller should start the worker process
+  /// from scratch if not, e.g. because the zygote isn't started yet.
+  bool ForkFromZygote(int runtime_env_hash,
+                      const Language &language,
+                      StartupToken startup_token,
+                      const std::vector<std::string> &worker_command_args,
+                      const ProcessEnvironment &env);
+
+  /// Start a worker process from scratch after its fork from the zygote failed. The
+  /// process and the task waiting for it are moved to a new startup token.
+  ///
+  /// \param language The language of the worker process.
+  /// \param startup_token The startup token the fork was requested with.
+  /// \param worker_command_args The command arguments of the worker process.
+  /// \param[in] env Additional environment variables to be set on this process.
+  void StartWorkerAfterFailedFork(const Language &language,
+                                  StartupToken startup_token,
+                                  std::vector<std::string> worker_command_args,
+                                  const ProcessEnvironment &env);
+
+  /// Record the start of a worker process and adjust its OOM score.
+  void OnWorkerProcessStarted(
+      const Process &proc,
+      StartupToken proc_startup_token,
+      const rpc::WorkerType worker_type,
+      const std::chrono::high_resolution_clock::time_point &start);
+
   /// Push an warning message to user if worker pool is getting to big.
   virtual void WarnAboutSize();
 
@@ -551,8 +594,7 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   /// (due to worker process crash or any other reasons), remove them
   /// from `worker_processes`. Otherwise if we'll mistakenly
   /// think there are unregistered workers, and won't start new workers.
-  void MonitorStartingWorkerProcess(const Process &proc,
-                                    StartupToken proc_startup_token,
+  void MonitorStartingWorkerProcess(StartupToken proc_startup_token,
                                     const Language &language,
                                     const rpc::WorkerType worker_type);
 
@@ -768,6 +810,12 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   /// Agent manager.
   std::shared_ptr<AgentManager> agent_manager_;
 
+  /// The worker zygotes, keyed by runtime env hash.
+  absl::flat_hash_map<int, std::unique_ptr<WorkerZygote>> zygotes_;
+  /// The runtime env hashes whose zygotes died or failed to fork. Workers of them are
+  /// always started from scratch.
+  absl::flat_hash_set<int> failed_zygotes_;
+
   /// Stats
   int64_t process_failed_job_config_missing_ = 0;
   int64_t process_failed_rate_limited_ = 0;
@@ -170,6 +170,9 @@ class WorkerPoolMock : public WorkerPool {
 
   Process StartProcess(const std::vector<std::string> &worker_command_args,
                        const ProcessEnvironment &env) override {
+    if (fail_start_process_) {
+      return Process();
+    }
     // Use a bogus process ID that won't conflict with those in the system
     pid_t pid = static_cast<pid_t>(PID_MAX_LIMIT + 1 + worker_commands_by_proc_.size());
     last_worker_process_ = Process::FromPid(pid);
@@ -181,6 +184,9 @@ class WorkerPoolMock : public WorkerPool {
 
   void WarnAboutSize() override {}
 
+  /// Whether starting a worker process fails, like for a bad worker command.
+  bool fail_start_process_ = false;
+
   Process LastStartedWorkerProcess() const { return last_worker_process_; }
 
   const std::vector<std::string> &GetWorkerCommand(Process proc) {
@@ -626,6 +632,25 @@ TEST_F(WorkerPoolTest, HandleWorkerRegistration) {
   }
 }
 
+TEST_F(WorkerPoolTest, HandleWorkerStartFailure) {
+  // A worker process that fails to start fails the worker, not the raylet.
+  worker_pool_->fail_start_process_ = true;
+  PopWorkerStatus status = PopWorkerStatus::OK;
+  auto [proc, token] = worker_pool_->StartWorkerProcess(
+      Language::PYTHON, rpc::WorkerType::WORKER, JOB_ID, &status);
+  ASSERT_FALSE(proc.IsValid());
+  ASSERT_EQ(status, PopWorkerStatus::WorkerStartFailed);
+  ASSERT_EQ(worker_pool_->NumWorkersStarting(), 0);
+
+  worker_pool_->fail_start_process_ = false;
+  status = PopWorkerStatus::OK;
+  std::tie(proc, token) = worker_pool_->StartWorkerProcess(
+      Language::PYTHON, rpc::WorkerType::WORKER, JOB_ID, &status);
+  ASSERT_TRUE(proc.IsValid());
+  ASSERT_EQ(status, PopWorkerStatus::OK);
+  ASSERT_EQ(worker_pool_->NumWorkersStarting(), 1);
+}
+
 TEST_F(WorkerPoolTest, HandleUnknownWorkerRegistration) {
   auto worker = worker_pool_->CreateWorker(Process(), Language::PYTHON);
   auto status = worker_pool_->RegisterWorker(
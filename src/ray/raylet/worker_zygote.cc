@@ -0,0 +1,276 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/worker_zygote.h"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <cstring>
+#include <filesystem>
+
+#include "ray/common/client_connection.h"
+#include "ray/common/ray_config.h"
+#include "ray/util/logging.h"
+#include "ray/util/util.h"
+
+extern char **environ;
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+/// The types of the connections to the zygote.
+constexpr uint32_t kForkRequest = 0;
+constexpr uint32_t kControlConnection = 1;
+
+void AppendUint32(std::string *buffer, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    buffer->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void AppendString(std::string *buffer, const std::string &value) {
+  AppendUint32(buffer, static_cast<uint32_t>(value.size()));
+  buffer->append(value);
+}
+
+/// A fork request in flight. It's shared by the handlers of the request, and the
+/// first of them to finish invokes the callback.
+struct ForkRequest {
+  ForkRequest(instrumented_io_context &io_service,
+              std::string socket_path,
+              WorkerZygote::ForkCallback callback)
+      : socket(io_service),
+        timer(io_service),
+        socket_path(std::move(socket_path)),
+        callback(std::move(callback)) {}
+
+  void Finish(Process proc) {
+    if (callback == nullptr) {
+      return;
+    }
+    timer.cancel();
+    boost::system::error_code ec;
+    socket.close(ec);
+    auto done = std::move(callback);
+    callback = nullptr;
+    done(proc, connected);
+  }
+
+  void Fail(const std::string &step, const boost::system::error_code &error) {
+    if (error != boost::asio::error::operation_aborted) {
+      RAY_LOG(WARNING) << "Failed to " << step << " worker zygote " << socket_path
+                       << ": " << error.message();
+    }
+    Finish(Process());
+  }
+
+  local_stream_socket socket;
+  boost::asio::deadline_timer timer;
+  const std::string socket_path;
+  std::string request;
+  uint8_t reply[4];
+  bool connected = false;
+  WorkerZygote::ForkCallback callback;
+};
+
+void SendForkRequest(const std::shared_ptr<ForkRequest> &fork_request) {
+  fork_request->socket.async_connect(
+      ParseUrlEndpoint(fork_request->socket_path),
+      [fork_request](const boost::system::error_code &error) {
+        if (error) {
+          fork_request->Fail("connect to", error);
+          return;
+        }
+        fork_request->connected = true;
+        boost::asio::async_write(
+            fork_request->socket,
+            boost::asio::buffer(fork_request->request),
+            [fork_request](const boost::system::error_code &error, size_t) {
+              if (error) {
+                fork_request->Fail("send the fork request to", error);
+                return;
+              }
+              boost::asio::async_read(
+                  fork_request->socket,
+                  boost::asio::buffer(fork_request->reply),
+                  [fork_request](const boost::system::error_code &error, size_t) {
+                    if (error) {
+                      fork_request->Fail("read the fork reply from", error);
+                      return;
+                    }
+                    const uint8_t *reply = fork_request->reply;
+                    auto pid = static_cast<int32_t>(
+                        reply[0] | (reply[1] << 8) | (reply[2] << 16) |
+                        (static_cast<uint32_t>(reply[3]) << 24));
+                    if (pid <= 0) {
+                      RAY_LOG(WARNING) << "Worker zygote " << fork_request->socket_path
+                                       << " failed to fork a worker.";
+                      fork_request->Finish(Process());
+                      return;
+                    }
+                    fork_request->Finish(Process::FromPid(pid));
+                  });
+            });
+      });
+}
+
+}  // namespace
+
+struct WorkerZygote::ControlConnection {
+  enum class State { CONNECTING, CONNECTED, FAILED };
+
+  explicit ControlConnection(instrumented_io_context &io_service) : socket(io_service) {
+    AppendUint32(&header, kControlConnection);
+  }
+
+  local_stream_socket socket;
+  std::string header;
+  State state = State::CONNECTING;
+};
+
+WorkerZygote::WorkerZygote(instrumented_io_context &io_service, std::string socket_path)
+    : io_service_(io_service), socket_path_(std::move(socket_path)) {}
+
+WorkerZygote::~WorkerZygote() {
+  if (control_ != nullptr) {
+    boost::system::error_code ec;
+    control_->socket.close(ec);
+  }
+  if (zygote_.IsValid()) {
+    zygote_.Kill();
+  }
+  std::error_code ec;
+  std::filesystem::remove(socket_path_, ec);
+}
+
+Status WorkerZygote::Start(const std::vector<std::string> &worker_command_args,
+                           const ProcessEnvironment &env) {
+  // Remove the socket left by a previous zygote, otherwise the new one can't bind it.
+  std::error_code ec;
+  std::filesystem::remove(socket_path_, ec);
+
+  std::vector<std::string> args = worker_command_args;
+  args.push_back(kZygoteSocketFlag + socket_path_);
+  std::vector<const char *> argv;
+  for (const std::string &arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  argv.push_back(NULL);
+
+  zygote_ = Process(argv.data(), nullptr, ec, /*decouple=*/false, env);
+  if (!zygote_.IsValid() || ec) {
+    return Status::IOError("Failed to start the worker zygote: " + ec.message());
+  }
+  RAY_LOG(INFO) << "Started worker zygote with pid " << zygote_.GetId()
+                << ", listening on " << socket_path_;
+  return Status::OK();
+}
+
+void WorkerZygote::ForkAsync(const std::vector<std::string> &worker_command_args,
+                             const ProcessEnvironment &env,
+                             ForkCallback callback) {
+  auto fork_request =
+      std::make_shared<ForkRequest>(io_service_, socket_path_, std::move(callback));
+  if (control_ != nullptr && control_->state == ControlConnection::State::FAILED) {
+    control_ = nullptr;
+  }
+  if (!IsAlive() ||
+      (control_ != nullptr && control_->state == ControlConnection::State::CONNECTING)) {
+    // The zygote is dead, or is still loading.
+    io_service_.post([fork_request]() { fork_request->Finish(Process()); },
+                     "WorkerZygote.ForkAsync");
+    return;
+  }
+
+  // The child's environment replaces the zygote's, so that the variables of the
+  // worker the zygote was started with don't leak into it.
+  ProcessEnvironment child_env;
+  for (char *const *e = environ; *e; ++e) {
+    const char *key_end = strchr(*e + 1, '=');
+    if (key_end != nullptr) {
+      child_env[std::string(*e, static_cast<size_t>(key_end - *e))] = key_end + 1;
+    }
+  }
+  for (const auto &[key, value] : env) {
+    child_env[key] = value;
+  }
+
+  std::string &request = fork_request->request;
+  AppendUint32(&request, kForkRequest);
+  AppendUint32(&request, static_cast<uint32_t>(worker_command_args.size()));
+  for (const auto &arg : worker_command_args) {
+    AppendString(&request, arg);
+  }
+  AppendUint32(&request, static_cast<uint32_t>(child_env.size()));
+  for (const auto &[key, value] : child_env) {
+    AppendString(&request, key);
+    AppendString(&request, value);
+  }
+
+  fork_request->timer.expires_from_now(boost::posix_time::milliseconds(
+      RayConfig::instance().worker_zygote_fork_timeout_ms()));
+  fork_request->timer.async_wait([fork_request](const boost::system::error_code &error) {
+    if (error == boost::asio::error::operation_aborted) {
+      return;
+    }
+    RAY_LOG(WARNING) << "Worker zygote " << fork_request->socket_path
+                     << " didn't reply in "
+                     << RayConfig::instance().worker_zygote_fork_timeout_ms() << "ms.";
+    fork_request->Finish(Process());
+  });
+
+  if (control_ != nullptr) {
+    SendForkRequest(fork_request);
+    return;
+  }
+  // Open the control connection before the first fork request, so that the zygote
+  // exits with the raylet.
+  control_ = std::make_shared<ControlConnection>(io_service_);
+  auto control = control_;
+  control->socket.async_connect(
+      ParseUrlEndpoint(socket_path_),
+      [control, fork_request](const boost::system::error_code &error) {
+        if (error) {
+          // The zygote is still loading. Connect again on the next request.
+          RAY_LOG(DEBUG) << "Worker zygote " << fork_request->socket_path
+                         << " is not ready: " << error.message();
+          control->state = ControlConnection::State::FAILED;
+          fork_request->Finish(Process());
+          return;
+        }
+        boost::asio::async_write(
+            control->socket,
+            boost::asio::buffer(control->header),
+            [control, fork_request](const boost::system::error_code &error, size_t) {
+              if (error) {
+                control->state = ControlConnection::State::FAILED;
+                fork_request->connected = true;
+                fork_request->Fail("open the control connection to", error);
+                return;
+              }
+              control->state = ControlConnection::State::CONNECTED;
+              SendForkRequest(fork_request);
+            });
+      });
+}
+
+bool WorkerZygote::IsAlive() const { return zygote_.IsAlive(); }
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,114 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/status.h"
+#include "ray/util/process.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// The flag appended to a worker command to start it as a zygote.
+constexpr char kZygoteSocketFlag[] = "--zygote-socket=";
+
+/// \class WorkerZygote
+///
+/// A zygote is a template worker process which has loaded the worker runtime but
+/// hasn't connected to the cluster. It listens on a unix socket and forks a child per
+/// request. The child runs the worker with the requested command line arguments and
+/// environment variables, and registers with the raylet like a worker started from
+/// scratch, but skips the interpreter startup and the imports.
+///
+/// Each connection starts with its type. Numbers are 4-byte little-endian unsigned
+/// ints, and each string is prefixed with its length.
+/// - A control connection (type 1) carries nothing else. The raylet opens it before
+///   the first fork request and keeps it open, and the zygote exits when it's closed,
+///   e.g. because the raylet died.
+/// - A fork request (type 0) is a list of strings: the number of arguments, the
+///   arguments, the number of environment variables, and the key and the value of
+///   each of them. The environment variables are the complete environment of the
+///   child, which replaces the one inherited from the zygote. The reply is the 4-byte
+///   little-endian pid of the child, or -1 if the fork failed.
+class WorkerZygote {
+ public:
+  /// Callback of a fork request.
+  ///
+  /// \param proc The forked worker process, or a null process if the fork failed.
+  /// \param connected Whether the request reached the zygote. If it did, the zygote
+  /// may still fork the worker after the failure is reported, e.g. on a timeout.
+  using ForkCallback = std::function<void(Process proc, bool connected)>;
+
+  /// Create a WorkerZygote.
+  ///
+  /// \param io_service The event loop to talk to the zygote on.
+  /// \param socket_path The path of the unix socket that the zygote listens on.
+  WorkerZygote(instrumented_io_context &io_service, std::string socket_path);
+
+  /// Kill the zygote process. The workers forked from it are not affected.
+  ~WorkerZygote();
+
+  /// Start the zygote process.
+  ///
+  /// \param worker_command_args The command of a worker process. The zygote is started
+  /// with this command and the socket flag appended.
+  /// \param env Additional environment variables of the zygote process.
+  /// \return Status::OK if the zygote process is started.
+  Status Start(const std::vector<std::string> &worker_command_args,
+               const ProcessEnvironment &env);
+
+  /// Fork a worker from the zygote. The callback is invoked on the event loop when
+  /// the zygote replies, or after `worker_zygote_fork_timeout_ms`.
+  ///
+  /// \param worker_command_args The command of the worker process. The child parses
+  /// the arguments after the worker script.
+  /// \param env Additional environment variables of the worker process. The child
+  /// gets the environment of the raylet with these applied, like a worker started
+  /// from scratch, and none of the variables the zygote was started with.
+  /// \param callback Invoked with the forked worker process, or with a null process
+  /// if the zygote isn't ready yet, failed to fork or didn't reply in time.
+  void ForkAsync(const std::vector<std::string> &worker_command_args,
+                 const ProcessEnvironment &env,
+                 ForkCallback callback);
+
+  /// Whether the zygote process is alive.
+  bool IsAlive() const;
+
+  const std::string &SocketPath() const { return socket_path_; }
+
+ private:
+  struct ControlConnection;
+
+  instrumented_io_context &io_service_;
+
+  const std::string socket_path_;
+
+  /// The zygote process.
+  Process zygote_;
+
+  /// The control connection to the zygote. It's shared with the pending handlers,
+  /// which may outlive this object.
+  std::shared_ptr<ControlConnection> control_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,204 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/worker_zygote.h"
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/id.h"
+#include "ray/common/ray_config.h"
+#include "ray/util/filesystem.h"
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+uint32_t ReadUint32(boost::asio::local::stream_protocol::socket &socket) {
+  uint8_t buffer[4];
+  boost::asio::read(socket, boost::asio::buffer(buffer));
+  return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) |
+         (static_cast<uint32_t>(buffer[3]) << 24);
+}
+
+std::string ReadString(boost::asio::local::stream_protocol::socket &socket) {
+  std::string value(ReadUint32(socket), '\0');
+  boost::asio::read(socket, boost::asio::buffer(value));
+  return value;
+}
+
+}  // namespace
+
+class WorkerZygoteTest : public ::testing::Test {
+ public:
+  WorkerZygoteTest()
+      : socket_path_(JoinPaths(GetUserTempDir(),
+                               "zygote_test_" + UniqueID::FromRandom().Hex())),
+        zygote_(std::make_unique<WorkerZygote>(io_service_, socket_path_)) {}
+
+ protected:
+  void TearDown() override {
+    if (server_thread_.joinable()) {
+      server_thread_.join();
+    }
+    RayConfig::instance().initialize("");
+  }
+
+  /// Fork from the zygote, and run the event loop until the callback is invoked.
+  std::pair<Process, bool> Fork(const std::vector<std::string> &args,
+                                const ProcessEnvironment &env) {
+    std::optional<std::pair<Process, bool>> result;
+    zygote_->ForkAsync(args, env, [&result](Process proc, bool connected) {
+      result = std::make_pair(proc, connected);
+    });
+    // The request doesn't block the caller.
+    EXPECT_FALSE(result.has_value());
+    io_service_.restart();
+    while (!result.has_value() && io_service_.run_one() > 0) {
+    }
+    EXPECT_TRUE(result.has_value());
+    return result.value_or(std::make_pair(Process(), false));
+  }
+
+  /// Accept the control connection and one fork request on the zygote socket, and
+  /// reply to the request with `pid`. After that, wait for the control connection to
+  /// be closed if `wait_for_close` is set.
+  void Serve(int32_t pid, bool wait_for_close = false) {
+    boost::asio::local::stream_protocol::acceptor acceptor(
+        server_io_context_,
+        boost::asio::local::stream_protocol::endpoint(socket_path_));
+    server_thread_ = std::thread([this, pid, wait_for_close, acceptor = std::move(
+                                                                  acceptor)]() mutable {
+      boost::asio::local::stream_protocol::socket control(server_io_context_);
+      acceptor.accept(control);
+      control_type_ = ReadUint32(control);
+
+      boost::asio::local::stream_protocol::socket socket(server_io_context_);
+      acceptor.accept(socket);
+      request_type_ = ReadUint32(socket);
+      auto num_args = ReadUint32(socket);
+      for (uint32_t i = 0; i < num_args; i++) {
+        received_args_.push_back(ReadString(socket));
+      }
+      auto num_env = ReadUint32(socket);
+      for (uint32_t i = 0; i < num_env; i++) {
+        auto key = ReadString(socket);
+        received_env_[key] = ReadString(socket);
+      }
+      uint8_t reply[4];
+      for (int i = 0; i < 4; i++) {
+        reply[i] = (static_cast<uint32_t>(pid) >> (8 * i)) & 0xff;
+      }
+      boost::asio::write(socket, boost::asio::buffer(reply));
+
+      if (wait_for_close) {
+        uint8_t byte;
+        boost::system::error_code ec;
+        boost::asio::read(control, boost::asio::buffer(&byte, 1), ec);
+        control_closed_ = ec == boost::asio::error::eof;
+      }
+    });
+  }
+
+  instrumented_io_context io_service_;
+  std::string socket_path_;
+  std::unique_ptr<WorkerZygote> zygote_;
+  boost::asio::io_context server_io_context_;
+  std::thread server_thread_;
+  uint32_t control_type_ = 0;
+  uint32_t request_type_ = 0;
+  std::vector<std::string> received_args_;
+  ProcessEnvironment received_env_;
+  bool control_closed_ = false;
+};
+
+TEST_F(WorkerZygoteTest, TestFork) {
+  // A stand-in zygote process. The socket flag becomes the $0 of the script.
+  ASSERT_TRUE(
+      zygote_->Start({"/bin/sh", "-c", "sleep 1000"}, {{"RAY_ZYGOTE_ONLY", "1"}}).ok());
+  ASSERT_TRUE(zygote_->IsAlive());
+
+  // The zygote isn't listening yet.
+  auto [not_ready, connected] = Fork({"python", "worker.py"}, {});
+  ASSERT_TRUE(not_ready.IsNull());
+  ASSERT_FALSE(connected);
+
+  Serve(/*pid=*/GetPID());
+  auto [proc, forked_connected] = Fork({"python", "worker.py", "--startup-token=1"},
+                                       {{"RAY_JOB_ID", "01000000"}});
+  server_thread_.join();
+  ASSERT_EQ(proc.GetId(), GetPID());
+  ASSERT_TRUE(forked_connected);
+  ASSERT_EQ(control_type_, 1u);
+  ASSERT_EQ(request_type_, 0u);
+  ASSERT_EQ(received_args_,
+            std::vector<std::string>({"python", "worker.py", "--startup-token=1"}));
+  // The child gets the whole environment of the raylet, without the variables of
+  // the zygote.
+  ASSERT_EQ(received_env_["RAY_JOB_ID"], "01000000");
+  ASSERT_EQ(received_env_["PATH"], std::string(getenv("PATH")));
+  ASSERT_EQ(received_env_.count("RAY_ZYGOTE_ONLY"), 0);
+}
+
+TEST_F(WorkerZygoteTest, TestForkTimeout) {
+  RayConfig::instance().initialize(R"({"worker_zygote_fork_timeout_ms": 100})");
+  ASSERT_TRUE(zygote_->Start({"/bin/sh", "-c", "sleep 1000"}, {}).ok());
+  // A zygote which accepts the connections but never replies.
+  boost::asio::local::stream_protocol::acceptor acceptor(
+      server_io_context_, boost::asio::local::stream_protocol::endpoint(socket_path_));
+  auto start = std::chrono::steady_clock::now();
+  auto [proc, connected] = Fork({"python", "worker.py"}, {});
+  ASSERT_TRUE(proc.IsNull());
+  // The zygote may still fork the worker.
+  ASSERT_TRUE(connected);
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+}
+
+TEST_F(WorkerZygoteTest, TestForkFailure) {
+  ASSERT_TRUE(zygote_->Start({"/bin/sh", "-c", "sleep 1000"}, {}).ok());
+  Serve(/*pid=*/-1);
+  auto [proc, connected] = Fork({"python", "worker.py"}, {});
+  server_thread_.join();
+  ASSERT_TRUE(proc.IsNull());
+  ASSERT_TRUE(connected);
+}
+
+TEST_F(WorkerZygoteTest, TestControlConnectionClosed) {
+  ASSERT_TRUE(zygote_->Start({"/bin/sh", "-c", "sleep 1000"}, {}).ok());
+  Serve(/*pid=*/GetPID(), /*wait_for_close=*/true);
+  auto [proc, connected] = Fork({"python", "worker.py"}, {});
+  ASSERT_EQ(proc.GetId(), GetPID());
+  // The zygote exits when the control connection is closed.
+  zygote_.reset();
+  server_thread_.join();
+  ASSERT_TRUE(control_closed_);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -49,6 +49,48 @@ AddressesToFlatbuffer(flatbuffers::FlatBufferBuilder &fbb,
 
 namespace ray {
 
+void WorkerLeaseInterface::RequestWorkerLeases(
+    const rpc::TaskSpec &resource_spec,
+    const std::vector<TaskID> &lease_ids,
+    const rpc::ClientCallback<rpc::RequestWorkerLeasesReply> &callback,
+    const int64_t backlog_size,
+    const bool is_selected_based_on_locality) {
+  struct PendingLeases {
+    rpc::RequestWorkerLeasesReply reply;
+    size_t num_pending;
+    Status status;
+  };
+  auto pending = std::make_shared<PendingLeases>();
+  pending->num_pending = lease_ids.size();
+  for (size_t i = 0; i < lease_ids.size(); i++) {
+    pending->reply.add_lease_replies();
+  }
+  if (lease_ids.empty()) {
+    callback(Status::OK(), pending->reply);
+    return;
+  }
+  for (size_t i = 0; i < lease_ids.size(); i++) {
+    rpc::TaskSpec task_spec = resource_spec;
+    task_spec.set_task_id(lease_ids[i].Binary());
+    RequestWorkerLease(
+        task_spec,
+        /*grant_or_reject=*/false,
+        [pending, callback, i](const Status &status,
+                               const rpc::RequestWorkerLeaseReply &reply) {
+          if (status.ok()) {
+            pending->reply.mutable_lease_replies(i)->CopyFrom(reply);
+          } else if (pending->status.ok()) {
+            pending->status = status;
+          }
+          if (--pending->num_pending == 0) {
+            callback(pending->status, pending->reply);
+          }
+        },
+        backlog_size,
+        is_selected_based_on_locality);
+  }
+}
+
 raylet::RayletConnection::RayletConnection(instrumented_io_context &io_service,
                                            const std::string &raylet_socket,
                                            int num_retries,
@@ -339,6 +381,22 @@ void raylet::RayletClient::RequestWorkerLease(
   grpc_client_->RequestWorkerLease(*request, callback);
 }
 
+void raylet::RayletClient::RequestWorkerLeases(
+    const rpc::TaskSpec &resource_spec,
+    const std::vector<TaskID> &lease_ids,
+    const rpc::ClientCallback<rpc::RequestWorkerLeasesReply> &callback,
+    const int64_t backlog_size,
+    const bool is_selected_based_on_locality) {
+  rpc::RequestWorkerLeasesRequest request;
+  request.mutable_resource_spec()->CopyFrom(resource_spec);
+  for (const auto &lease_id : lease_ids) {
+    request.add_lease_ids(lease_id.Binary());
+  }
+  request.set_backlog_size(backlog_size);
+  request.set_is_selected_based_on_locality(is_selected_based_on_locality);
+  grpc_client_->RequestWorkerLeases(request, callback);
+}
+
 /// Spill objects to external storage.
 void raylet::RayletClient::RequestObjectSpillage(
     const ObjectID &object_id,
@@ -74,6 +74,23 @@ class WorkerLeaseInterface {
       const int64_t backlog_size = -1,
       const bool is_selected_based_on_locality = false) = 0;
 
+  /// Requests several workers of the same shape from the raylet. Each lease is
+  /// granted, spilled back or rejected on its own, but there is a single reply
+  /// once all of them are resolved, see `RequestWorkerLeasesReply`.
+  /// The default implementation sends one `RequestWorkerLease` per lease; if any of
+  /// them fails, the callback gets its status.
+  /// \param resource_spec Resources that should be allocated for each worker.
+  /// \param lease_ids The IDs of the leases. They are used like the task ID of a
+  ///                   single lease request, e.g. to cancel a lease.
+  /// \param callback: The callback to call when all the leases are resolved.
+  /// \param backlog_size The queue length for the given shape on the CoreWorker.
+  virtual void RequestWorkerLeases(
+      const rpc::TaskSpec &resource_spec,
+      const std::vector<TaskID> &lease_ids,
+      const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeasesReply> &callback,
+      const int64_t backlog_size = -1,
+      const bool is_selected_based_on_locality = false);
+
   /// Returns a worker to the raylet.
   /// \param worker_port The local port of the worker on the raylet node.
   /// \param worker_id The unique worker id of the worker on the raylet node.
@@ -407,6 +424,14 @@ class RayletClient : public RayletClientInterface {
       const int64_t backlog_size,
       const bool is_selected_based_on_locality) override;
 
+  /// Implements WorkerLeaseInterface.
+  void RequestWorkerLeases(
+      const rpc::TaskSpec &resource_spec,
+      const std::vector<TaskID> &lease_ids,
+      const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeasesReply> &callback,
+      const int64_t backlog_size,
+      const bool is_selected_based_on_locality) override;
+
   /// Implements WorkerLeaseInterface.
   ray::Status ReturnWorker(int worker_port,
                            const WorkerID &worker_id,
@@ -233,5 +233,27 @@ void GrpcServer::PollEventsFromCompletionQueue(int index) {
   }
 }
 
+ServiceExecutor::ServiceExecutor(instrumented_io_context &io_context,
+                                 int num_threads,
+                                 const std::string &name)
+    : io_context_(io_context), work_(io_context) {
+  RAY_CHECK(num_threads > 0) << "Num of threads of " << name << " must be greater than 0";
+  for (int i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this, name, i]() {
+      SetThreadName(name + "." + std::to_string(i));
+      io_context_.run();
+    });
+  }
+}
+
+void ServiceExecutor::Stop() {
+  io_context_.stop();
+  for (auto &thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
 }  // namespace rpc
 }  // namespace ray
@@ -28,7 +28,9 @@ namespace ray {
 namespace rpc {
 /// \param MAX_ACTIVE_RPCS Maximum number of RPCs to handle at the same time. -1 means no
 /// limit.
-#define _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, RECORD_METRICS) \
+/// \param EXECUTOR The event loop to which the handler function is posted.
+#define _RPC_SERVICE_HANDLER(                                                   \
+    SERVICE, HANDLER, MAX_ACTIVE_RPCS, RECORD_METRICS, EXECUTOR)                \
   std::unique_ptr<ServerCallFactory> HANDLER##_call_factory(                    \
       new ServerCallFactoryImpl<SERVICE,                                        \
                                 SERVICE##Handler,                               \
@@ -39,7 +41,7 @@ namespace rpc {
           service_handler_,                                                     \
           &SERVICE##Handler::Handle##HANDLER,                                   \
           cq,                                                                   \
-          main_service_,                                                        \
+          EXECUTOR,                                                             \
           #SERVICE ".grpc_server." #HANDLER,                                    \
           MAX_ACTIVE_RPCS,                                                      \
           RECORD_METRICS));                                                     \
@@ -47,11 +49,24 @@ namespace rpc {
 
 /// Define a RPC service handler with gRPC server metrics enabled.
 #define RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS) \
-  _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, true)
+  _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, true, main_service_)
 
 /// Define a RPC service handler with gRPC server metrics disabled.
 #define RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(SERVICE, HANDLER, MAX_ACTIVE_RPCS) \
-  _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, false)
+  _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, false, main_service_)
+
+/// Define a RPC service handler that runs on `EXECUTOR`, an `instrumented_io_context`
+/// of the service, instead of the main event loop. Use this for handlers that should
+/// not wait behind the main event loop. If `EXECUTOR` is run by multiple threads (see
+/// `ServiceExecutor`), the handler runs concurrently with itself and with the handlers
+/// on the main event loop, so it must only access thread-safe state.
+#define RPC_SERVICE_HANDLER_ON_EXECUTOR(SERVICE, HANDLER, MAX_ACTIVE_RPCS, EXECUTOR) \
+  _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, true, EXECUTOR)
+
+/// Same as `RPC_SERVICE_HANDLER_ON_EXECUTOR`, with gRPC server metrics disabled.
+#define RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED_ON_EXECUTOR(      \
+    SERVICE, HANDLER, MAX_ACTIVE_RPCS, EXECUTOR)                      \
+  _RPC_SERVICE_HANDLER(SERVICE, HANDLER, MAX_ACTIVE_RPCS, false, EXECUTOR)
 
 // Define a void RPC client method.
 #define DECLARE_VOID_RPC_SERVICE_HANDLER_METHOD(METHOD)            \
@@ -70,6 +85,11 @@ class GrpcService;
 /// Subclasses can register one or multiple services to a `GrpcServer`, see
 /// `RegisterServices`. And they should also implement `InitServerCallFactories` to decide
 /// which kinds of requests this server should accept.
+///
+/// The polling threads only hand the requests over to the event loop of each handler,
+/// which is the main event loop of the service unless the handler declares its own
+/// executor (see `RPC_SERVICE_HANDLER_ON_EXECUTOR`). So adding polling threads doesn't
+/// make the handlers of a service run in parallel, a multi-threaded executor does.
 class GrpcServer {
  public:
   /// Construct a gRPC server that listens on a TCP port.
@@ -138,6 +158,33 @@ class GrpcServer {
   const int64_t keepalive_time_ms_;
 };
 
+/// Runs an event loop on a pool of threads, so that the handlers of a service that are
+/// posted to it run in parallel, instead of one at a time on the main event loop.
+class ServiceExecutor {
+ public:
+  /// Start the threads.
+  ///
+  /// \param[in] io_context The event loop to run. It must outlive this executor.
+  /// \param[in] num_threads The number of threads that run the event loop.
+  /// \param[in] name Name of the threads, used for debugging purpose.
+  ServiceExecutor(instrumented_io_context &io_context,
+                  int num_threads,
+                  const std::string &name);
+
+  /// Stop the event loop and join the threads.
+  ~ServiceExecutor() { Stop(); }
+
+  /// Stop the event loop and join the threads. The handlers that are still queued
+  /// are not run.
+  void Stop();
+
+ private:
+  instrumented_io_context &io_context_;
+  /// Keeps the event loop running while it has nothing to do.
+  boost::asio::io_service::work work_;
+  std::vector<std::thread> threads_;
+};
+
 /// Base class that represents an abstract gRPC service.
 ///
 /// Subclass should implement `InitServerCallFactories` to decide
@@ -109,6 +109,12 @@ class NodeManagerWorkerClient
                          grpc_client_,
                          /*method_timeout_ms*/ -1, )
 
+  /// Request several worker leases of the same shape.
+  VOID_RPC_CLIENT_METHOD(NodeManagerService,
+                         RequestWorkerLeases,
+                         grpc_client_,
+                         /*method_timeout_ms*/ -1, )
+
   /// Report task backlog information
   VOID_RPC_CLIENT_METHOD(NodeManagerService,
                          ReportWorkerBacklog,
@@ -0,0 +1,218 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "gtest/gtest.h"
+#include "ray/rpc/grpc_server.h"
+#include "ray/rpc/node_manager/node_manager_client.h"
+#include "ray/rpc/node_manager/node_manager_server.h"
+
+namespace ray {
+namespace rpc {
+
+#define FAKE_NODE_MANAGER_HANDLER(METHOD)                                \
+  void Handle##METHOD(METHOD##Request request,                           \
+                      METHOD##Reply *reply,                              \
+                      SendReplyCallback send_reply_callback) override {  \
+    HandleRequest(std::move(send_reply_callback));                       \
+  }
+
+/// A `NodeManagerServiceHandler` that does a fixed amount of CPU work per request.
+/// It's thread-safe, so that it can be run by any number of threads.
+class FakeNodeManagerServiceHandler : public NodeManagerServiceHandler {
+ public:
+  FAKE_NODE_MANAGER_HANDLER(UpdateResourceUsage)
+  FAKE_NODE_MANAGER_HANDLER(RequestResourceReport)
+  FAKE_NODE_MANAGER_HANDLER(GetResourceLoad)
+  FAKE_NODE_MANAGER_HANDLER(NotifyGCSRestart)
+  FAKE_NODE_MANAGER_HANDLER(RequestWorkerLease)
+  FAKE_NODE_MANAGER_HANDLER(RequestWorkerLeases)
+  FAKE_NODE_MANAGER_HANDLER(ReportWorkerBacklog)
+  FAKE_NODE_MANAGER_HANDLER(ReturnWorker)
+  FAKE_NODE_MANAGER_HANDLER(ReleaseUnusedWorkers)
+  FAKE_NODE_MANAGER_HANDLER(ShutdownRaylet)
+  FAKE_NODE_MANAGER_HANDLER(CancelWorkerLease)
+  FAKE_NODE_MANAGER_HANDLER(PrepareBundleResources)
+  FAKE_NODE_MANAGER_HANDLER(CommitBundleResources)
+  FAKE_NODE_MANAGER_HANDLER(CancelResourceReserve)
+  FAKE_NODE_MANAGER_HANDLER(PinObjectIDs)
+  FAKE_NODE_MANAGER_HANDLER(GetNodeStats)
+  FAKE_NODE_MANAGER_HANDLER(GlobalGC)
+  FAKE_NODE_MANAGER_HANDLER(FormatGlobalMemoryInfo)
+  FAKE_NODE_MANAGER_HANDLER(RequestObjectSpillage)
+  FAKE_NODE_MANAGER_HANDLER(ReleaseUnusedBundles)
+  FAKE_NODE_MANAGER_HANDLER(GetSystemConfig)
+  FAKE_NODE_MANAGER_HANDLER(GetTasksInfo)
+  FAKE_NODE_MANAGER_HANDLER(GetObjectsInfo)
+  FAKE_NODE_MANAGER_HANDLER(GetTaskFailureCause)
+
+  /// The number of different threads the handlers ran on.
+  size_t NumHandlerThreads() {
+    absl::MutexLock lock(&mutex_);
+    return handler_threads_.size();
+  }
+
+ private:
+  void HandleRequest(SendReplyCallback send_reply_callback) {
+    {
+      absl::MutexLock lock(&mutex_);
+      handler_threads_.insert(std::this_thread::get_id());
+    }
+    // Stand-in for the work of a real handler, e.g. scheduling a lease request.
+    volatile uint64_t hash = 0;
+    for (int i = 0; i < 20000; i++) {
+      hash = hash * 31 + i;
+    }
+    send_reply_callback(Status::OK(), nullptr, nullptr);
+  }
+
+  absl::Mutex mutex_;
+  absl::flat_hash_set<std::thread::id> handler_threads_ GUARDED_BY(mutex_);
+};
+
+#undef FAKE_NODE_MANAGER_HANDLER
+
+class NodeManagerServerLoadTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    client_thread_ = std::make_unique<std::thread>([this]() {
+      /// The asio work to keep client_io_service_ alive.
+      boost::asio::io_service::work client_io_service_work_(client_io_service_);
+      client_io_service_.run();
+    });
+    client_call_manager_ =
+        std::make_unique<ClientCallManager>(client_io_service_, /*num_threads=*/4);
+  }
+
+  void TearDown() {
+    client_call_manager_.reset();
+    client_io_service_.stop();
+    client_thread_->join();
+  }
+
+  /// Start a `NodeManagerService` whose handlers run on `num_handler_threads` threads,
+  /// send `num_requests` requests to it with at most `max_inflight` in flight, and
+  /// return the number of requests handled per second.
+  double RunLoad(int num_handler_threads,
+                 int num_requests,
+                 int max_inflight,
+                 FakeNodeManagerServiceHandler &handler) {
+    instrumented_io_context handler_io_service;
+    ServiceExecutor executor(
+        handler_io_service, num_handler_threads, "node_manager_load_test");
+    NodeManagerGrpcService service(handler_io_service, handler);
+    GrpcServer server("node_manager_load_test",
+                      0,
+                      /*listen_to_localhost_only=*/true,
+                      /*num_threads=*/num_handler_threads);
+    server.RegisterService(service);
+    server.Run();
+    while (server.GetPort() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto client = NodeManagerWorkerClient::make(
+        "127.0.0.1", server.GetPort(), *client_call_manager_);
+
+    absl::Mutex mutex;
+    int num_sent = 0;
+    int num_replied = 0;
+    std::function<void()> send_one;
+    send_one = [&]() {
+      client->GetResourceLoad(
+          GetResourceLoadRequest(),
+          [&](const Status &status, const GetResourceLoadReply &reply) {
+            RAY_CHECK(status.ok()) << status;
+            bool send_more = false;
+            {
+              absl::MutexLock lock(&mutex);
+              num_replied++;
+              if (num_sent < num_requests) {
+                num_sent++;
+                send_more = true;
+              }
+            }
+            if (send_more) {
+              send_one();
+            }
+          });
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    {
+      absl::MutexLock lock(&mutex);
+      num_sent = std::min(max_inflight, num_requests);
+    }
+    for (int i = 0; i < std::min(max_inflight, num_requests); i++) {
+      send_one();
+    }
+    {
+      absl::MutexLock lock(&mutex);
+      auto all_replied = [&]() { return num_replied == num_requests; };
+      mutex.Await(absl::Condition(&all_replied));
+    }
+    auto elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    server.Shutdown();
+    executor.Stop();
+    return num_requests / elapsed_s;
+  }
+
+ protected:
+  instrumented_io_context client_io_service_;
+  std::unique_ptr<std::thread> client_thread_;
+  std::unique_ptr<ClientCallManager> client_call_manager_;
+};
+
+TEST_F(NodeManagerServerLoadTest, TestHandlersRunOnExecutorThreads) {
+  FakeNodeManagerServiceHandler handler;
+  RunLoad(/*num_handler_threads=*/4,
+          /*num_requests=*/1000,
+          /*max_inflight=*/64,
+          handler);
+  ASSERT_GT(handler.NumHandlerThreads(), 1);
+  ASSERT_LE(handler.NumHandlerThreads(), 4);
+}
+
+// Measure the throughput of the `NodeManagerService` against the number of threads
+// that run its handlers. With one thread, this is how the raylet handles RPCs.
+TEST_F(NodeManagerServerLoadTest, ThroughputBenchmark) {
+  const int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  double single_thread_throughput = 0;
+  for (int num_threads = 1; num_threads <= std::min(8, max_threads); num_threads *= 2) {
+    FakeNodeManagerServiceHandler handler;
+    double throughput = RunLoad(num_threads,
+                                /*num_requests=*/20000,
+                                /*max_inflight=*/256,
+                                handler);
+    if (num_threads == 1) {
+      single_thread_throughput = throughput;
+    }
+    RAY_LOG(INFO) << num_threads << " handler threads: " << throughput
+                  << " RPCs/s, speedup " << throughput / single_thread_throughput;
+  }
+}
+
+}  // namespace rpc
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -37,12 +37,13 @@ namespace rpc {
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(CoreWorkerService, GetObjectStatus, -1)    \
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(                                           \
       CoreWorkerService, WaitForActorOutOfScope, -1)                                     \
-  RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(CoreWorkerService, PubsubLongPolling, -1)  \
+  RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED_ON_EXECUTOR(                               \
+      CoreWorkerService, PubsubLongPolling, -1, object_info_service_)                    \
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(CoreWorkerService, PubsubCommandBatch, -1) \
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(                                           \
       CoreWorkerService, UpdateObjectLocationBatch, -1)                                  \
-  RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(                                           \
-      CoreWorkerService, GetObjectLocationsOwner, -1)                                    \
+  RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED_ON_EXECUTOR(                               \
+      CoreWorkerService, GetObjectLocationsOwner, -1, object_info_service_)              \
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(CoreWorkerService, KillActor, -1)          \
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(CoreWorkerService, CancelTask, -1)         \
   RPC_SERVICE_HANDLER_SERVER_METRICS_DISABLED(CoreWorkerService, RemoteCancelTask, -1)   \
@@ -104,10 +105,17 @@ class CoreWorkerGrpcService : public GrpcService {
   /// Constructor.
   ///
   /// \param[in] main_service See super class.
+  /// \param[in] object_info_service The event loop of the handlers that serve object
+  /// locations and pubsub long polling, i.e. `HandlePubsubLongPolling` and
+  /// `HandleGetObjectLocationsOwner`. These handlers must be thread-safe if it's not the
+  /// main event loop.
   /// \param[in] handler The service handler that actually handle the requests.
   CoreWorkerGrpcService(instrumented_io_context &main_service,
+                        instrumented_io_context &object_info_service,
                         CoreWorkerServiceHandler &service_handler)
-      : GrpcService(main_service), service_handler_(service_handler) {}
+      : GrpcService(main_service),
+        object_info_service_(object_info_service),
+        service_handler_(service_handler) {}
 
  protected:
   grpc::Service &GetGrpcService() override { return service_; }
@@ -119,6 +127,9 @@ class CoreWorkerGrpcService : public GrpcService {
   }
 
  private:
+  /// The event loop of the object location and pubsub long polling handlers.
+  instrumented_io_context &object_info_service_;
+
   /// The grpc async service object.
   CoreWorkerService::AsyncService service_;
 
@@ -14,9 +14,15 @@
 
 #include "ray/stats/metric.h"
 
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "opencensus/stats/internal/aggregation_window.h"
 #include "opencensus/stats/internal/set_aggregation_window.h"
 #include "opencensus/stats/measure_registry.h"
+#include "opencensus/tags/tag_map.h"
 
 namespace ray {
 
@@ -24,6 +30,25 @@ namespace stats {
 
 absl::Mutex Metric::registration_mutex_;
 
+namespace {
+
+/// The bound metrics that are alive, and the values collected from them.
+struct BoundMetricRegistry {
+  absl::Mutex mutex;
+  absl::flat_hash_set<BoundMetric *> metrics GUARDED_BY(mutex);
+  /// Keyed by the metric name and the tag values.
+  absl::flat_hash_map<std::string, std::shared_ptr<BoundMetricData>> data
+      GUARDED_BY(mutex);
+};
+
+BoundMetricRegistry &GetBoundMetricRegistry() {
+  // Never destroyed, since bound metrics may be destroyed after the static objects.
+  static auto *registry = new BoundMetricRegistry();
+  return *registry;
+}
+
+}  // namespace
+
 namespace internal {
 
 void RegisterAsView(opencensus::stats::ViewDescriptor view_descriptor,
@@ -85,11 +110,7 @@ bool StatsConfig::IsInitialized() const { return is_initialized_; }
 /// Metric
 ///
 using MeasureDouble = opencensus::stats::Measure<double>;
-void Metric::Record(double value, const TagsType &tags) {
-  if (StatsConfig::instance().IsStatsDisabled()) {
-    return;
-  }
-
+void Metric::RegisterIfNeeded() {
   // NOTE(lingxuan.zlx): Double check for recording performance while
   // processing in multithread and avoid race since metrics may invoke
   // record in different threads or code pathes.
@@ -109,6 +130,14 @@ void Metric::Record(double value, const TagsType &tags) {
       RegisterView();
     }
   }
+}
+
+void Metric::Record(double value, const TagsType &tags) {
+  if (StatsConfig::instance().IsStatsDisabled()) {
+    return;
+  }
+
+  RegisterIfNeeded();
 
   // Do record.
   TagsType combined_tags(tags);
@@ -176,5 +205,145 @@ void Sum::RegisterView() {
   internal::RegisterAsView(view_descriptor, tag_keys_);
 }
 
+///
+/// BoundMetric
+///
+BoundMetric::BoundMetric(Metric &metric,
+                         const std::unordered_map<std::string, std::string> &tags)
+    : metric_(metric),
+      type_(metric.GetType()),
+      boundaries_(type_ == HISTOGRAM
+                      ? static_cast<Histogram &>(metric).GetBoundaries()
+                      : std::vector<double>{}) {
+  if (type_ == HISTOGRAM) {
+    for (auto &shard : shards_) {
+      absl::MutexLock lock(&shard.mutex);
+      shard.bucket_counts.resize(boundaries_.size() + 1);
+    }
+  }
+  std::vector<std::pair<std::string, std::string>> sorted_tags(tags.begin(),
+                                                               tags.end());
+  std::sort(sorted_tags.begin(), sorted_tags.end());
+  std::string key = metric.GetName();
+  for (const auto &[tag_key, tag_value] : sorted_tags) {
+    absl::StrAppend(&key, "\n", tag_key, "=", tag_value);
+  }
+
+  auto &registry = GetBoundMetricRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  auto &data = registry.data[key];
+  if (data == nullptr) {
+    data = std::make_shared<BoundMetricData>();
+    data->type = type_;
+    data->tags = std::move(sorted_tags);
+    data->start_time = absl::Now();
+    data->boundaries = boundaries_;
+    data->bucket_counts.resize(type_ == HISTOGRAM ? boundaries_.size() + 1 : 0);
+  }
+  data_ = data;
+  registry.metrics.insert(this);
+}
+
+BoundMetric::~BoundMetric() {
+  auto &registry = GetBoundMetricRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  registry.metrics.erase(this);
+  Flush();
+}
+
+BoundMetric::Shard &BoundMetric::GetShard() {
+  static std::atomic<size_t> next_shard_index{0};
+  thread_local const size_t shard_index =
+      next_shard_index.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shards_[shard_index];
+}
+
+void BoundMetric::Record(double value) {
+  if (StatsConfig::instance().IsStatsDisabled()) {
+    return;
+  }
+  if (type_ == GAUGE) {
+    last_value_.store(value, std::memory_order_relaxed);
+    has_last_value_.store(true, std::memory_order_release);
+    return;
+  }
+
+  auto &shard = GetShard();
+  absl::MutexLock lock(&shard.mutex);
+  shard.count++;
+  shard.sum += value;
+  if (type_ == HISTOGRAM) {
+    shard.sum_of_squares += value * value;
+    shard.min = std::min(shard.min, value);
+    shard.max = std::max(shard.max, value);
+    // Same as opencensus, a value equal to a boundary goes to the upper bucket.
+    shard.bucket_counts[std::upper_bound(boundaries_.begin(), boundaries_.end(), value) -
+                        boundaries_.begin()]++;
+  }
+}
+
+void BoundMetric::Flush() {
+  auto &data = *data_;
+  bool recorded = false;
+  if (type_ == GAUGE) {
+    if (has_last_value_.exchange(false, std::memory_order_acquire)) {
+      data.value = last_value_.load(std::memory_order_relaxed);
+      recorded = true;
+    }
+  } else {
+    for (auto &shard : shards_) {
+      absl::MutexLock lock(&shard.mutex);
+      if (shard.count == 0) {
+        continue;
+      }
+      recorded = true;
+      if (type_ == SUM) {
+        data.value += shard.sum;
+      } else if (type_ == COUNT) {
+        data.value += shard.count;
+      } else {
+        data.count += shard.count;
+        data.sum += shard.sum;
+        data.sum_of_squares += shard.sum_of_squares;
+        data.min = std::min(data.min, shard.min);
+        data.max = std::max(data.max, shard.max);
+        for (size_t i = 0; i < shard.bucket_counts.size(); i++) {
+          data.bucket_counts[i] += shard.bucket_counts[i];
+          shard.bucket_counts[i] = 0;
+        }
+        shard.sum_of_squares = 0;
+        shard.min = std::numeric_limits<double>::infinity();
+        shard.max = -std::numeric_limits<double>::infinity();
+      }
+      shard.count = 0;
+      shard.sum = 0;
+    }
+  }
+  if (recorded && data.measure_descriptor == nullptr) {
+    // The exporters describe the metric with the descriptor of its measure.
+    metric_.RegisterIfNeeded();
+    data.measure_descriptor = &metric_.measure_->GetDescriptor();
+  }
+}
+
+std::vector<BoundMetricData> BoundMetric::Collect() {
+  std::vector<BoundMetricData> result;
+  if (StatsConfig::instance().IsStatsDisabled()) {
+    return result;
+  }
+  auto &registry = GetBoundMetricRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  for (auto *metric : registry.metrics) {
+    metric->Flush();
+  }
+  for (const auto &[key, data] : registry.data) {
+    // Skip the metrics that haven't recorded anything yet.
+    if (data->measure_descriptor != nullptr) {
+      result.push_back(*data);
+    }
+  }
+  return result;
+}
+
 }  // namespace stats
 }  // namespace ray
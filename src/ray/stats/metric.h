@@ -16,12 +16,19 @@
 
 #include <ctype.h>
 
+#include <array>
+#include <atomic>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <utility>  // std::pair
+#include <vector>
 
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "gtest/gtest_prod.h"
 #include "opencensus/stats/stats.h"
 #include "opencensus/stats/stats_exporter.h"
@@ -99,6 +106,8 @@ class StatsConfig final {
   std::vector<std::function<void()>> initializers_;
 };
 
+enum StatsType : int { COUNT, SUM, GAUGE, HISTOGRAM };
+
 /// A thin wrapper that wraps the `opencensus::tag::measure` for using it simply.
 class Metric {
  public:
@@ -134,9 +143,15 @@ class Metric {
   /// \param tags The map tag values that we want to record for this metric record.
   void Record(double value, const std::unordered_map<std::string, std::string> &tags);
 
+  /// Get the aggregation type of this metric.
+  virtual StatsType GetType() const = 0;
+
  protected:
   virtual void RegisterView() = 0;
 
+  /// Register the measure and the view of this metric if it's not registered yet.
+  void RegisterIfNeeded();
+
  protected:
   std::string name_;
   std::string description_;
@@ -147,6 +162,8 @@ class Metric {
   // For making sure thread-safe to all of metric registrations.
   static absl::Mutex registration_mutex_;
 
+  friend class BoundMetric;
+
 };  // class Metric
 
 class Gauge : public Metric {
@@ -157,6 +174,8 @@ class Gauge : public Metric {
         const std::vector<opencensus::tags::TagKey> &tag_keys = {})
       : Metric(name, description, unit, tag_keys) {}
 
+  StatsType GetType() const override { return GAUGE; }
+
  private:
   void RegisterView() override;
 
@@ -171,6 +190,10 @@ class Histogram : public Metric {
             const std::vector<opencensus::tags::TagKey> &tag_keys = {})
       : Metric(name, description, unit, tag_keys), boundaries_(boundaries) {}
 
+  StatsType GetType() const override { return HISTOGRAM; }
+
+  const std::vector<double> &GetBoundaries() const { return boundaries_; }
+
  private:
   void RegisterView() override;
 
@@ -187,6 +210,8 @@ class Count : public Metric {
         const std::vector<opencensus::tags::TagKey> &tag_keys = {})
       : Metric(name, description, unit, tag_keys) {}
 
+  StatsType GetType() const override { return COUNT; }
+
  private:
   void RegisterView() override;
 
@@ -200,11 +225,105 @@ class Sum : public Metric {
       const std::vector<opencensus::tags::TagKey> &tag_keys = {})
       : Metric(name, description, unit, tag_keys) {}
 
+  StatsType GetType() const override { return SUM; }
+
  private:
   void RegisterView() override;
 
 };  // class Sum
 
+/// The values recorded through the bound metrics of a metric with a set of tag values,
+/// since the process started.
+struct BoundMetricData {
+  /// The descriptor of the measure of the metric.
+  const opencensus::stats::MeasureDescriptor *measure_descriptor = nullptr;
+  StatsType type;
+  /// The tag keys and values, without the global tags.
+  std::vector<std::pair<std::string, std::string>> tags;
+  /// When the first bound metric of the metric and the tags was created.
+  absl::Time start_time;
+  /// Gauge: the last recorded value. Sum: the sum. Count: the number of values.
+  double value = 0;
+  /// The distribution of the values, if this is a histogram.
+  int64_t count = 0;
+  double sum = 0;
+  double sum_of_squares = 0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  std::vector<double> boundaries;
+  std::vector<int64_t> bucket_counts;
+};
+
+/// A handle to record a metric with tag values that are resolved once, for hot paths.
+///
+/// Metric::Record registers the tag keys and records to opencensus on every call,
+/// which takes several locks and allocates. A bound metric instead accumulates the
+/// recorded values per thread, in the form the metric type is exported in:
+/// - Gauge: the last recorded value.
+/// - Sum: the sum of the recorded values.
+/// - Count: the number of recorded values.
+/// - Histogram: the bucket counts, and the count, sum, min and max of the values.
+/// The exporters collect the accumulated values directly (see Collect), next to the
+/// opencensus views, so nothing is replayed into opencensus. A metric shouldn't be
+/// recorded both through Metric::Record and through a bound metric with the same tag
+/// values, otherwise it's exported twice with the same tags.
+///
+/// The metric must outlive the handle. This class is thread-safe.
+class BoundMetric {
+ public:
+  /// \param metric The metric to record to.
+  /// \param tags The tag values that all records of this handle have.
+  BoundMetric(Metric &metric,
+              const std::unordered_map<std::string, std::string> &tags = {});
+
+  /// Keep the values accumulated since the last collection for the next one.
+  ~BoundMetric();
+
+  BoundMetric(const BoundMetric &) = delete;
+  BoundMetric &operator=(const BoundMetric &) = delete;
+
+  /// Record the value for this metric.
+  void Record(double value);
+
+  /// Get the values recorded by all the bound metrics of this process.
+  static std::vector<BoundMetricData> Collect();
+
+ private:
+  /// The values accumulated by a subset of the threads since the last collection.
+  /// Each thread always uses the same shard, so the shard locks are rarely contended.
+  struct alignas(64) Shard {
+    absl::Mutex mutex;
+    int64_t count GUARDED_BY(mutex) = 0;
+    double sum GUARDED_BY(mutex) = 0;
+    /// Only used by histograms.
+    double sum_of_squares GUARDED_BY(mutex) = 0;
+    double min GUARDED_BY(mutex) = std::numeric_limits<double>::infinity();
+    double max GUARDED_BY(mutex) = -std::numeric_limits<double>::infinity();
+    std::vector<int64_t> bucket_counts GUARDED_BY(mutex);
+  };
+
+  static constexpr size_t kNumShards = 16;
+
+  /// The shard of the calling thread.
+  Shard &GetShard();
+
+  /// Move the values accumulated by the shards into `data_`. The caller holds the
+  /// lock of the bound metric registry, which guards `data_`.
+  void Flush();
+
+  Metric &metric_;
+  const StatsType type_;
+  /// The bucket boundaries, if this is a histogram.
+  const std::vector<double> boundaries_;
+  std::array<Shard, kNumShards> shards_;
+  /// The last recorded value, if this is a gauge.
+  std::atomic<double> last_value_{0};
+  std::atomic<bool> has_last_value_{false};
+  /// The values collected from this handle, shared with the other handles of the
+  /// same metric and tags. It's kept after the handle is destroyed.
+  std::shared_ptr<BoundMetricData> data_;
+};
+
 /// Raw metric view point for exporter.
 struct MetricPoint {
   std::string metric_name;
@@ -214,8 +333,6 @@ struct MetricPoint {
   const opencensus::stats::MeasureDescriptor &measure_descriptor;
 };
 
-enum StatsType : int { COUNT, SUM, GAUGE, HISTOGRAM };
-
 namespace internal {
 void RegisterAsView(opencensus::stats::ViewDescriptor view_descriptor,
                     const std::vector<opencensus::tags::TagKey> &keys);
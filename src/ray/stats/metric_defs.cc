@@ -52,6 +52,16 @@ DEFINE_stats(
     (),
     ray::stats::GAUGE);
 
+/// Tracks the lineage kept by task owners for object reconstruction.
+DEFINE_stats(owner_lineage_bytes,
+             "Bytes of task lineage kept by the owner.",
+             // Location: InMemory for the compact task specs, Shared for the fields
+             // deduplicated across task specs, or Offloaded for the specs appended to
+             // the offload file.
+             ("Location"),
+             (),
+             ray::stats::GAUGE);
+
 /// Tracks actors by state, including pending, running, and idle actors.
 ///
 /// To avoid metric collection conflicts between components reporting on the same task,
@@ -147,7 +157,7 @@ DEFINE_stats(grpc_server_req_finished,
 /// Object Manager.
 DEFINE_stats(object_manager_bytes,
              "Number of bytes pushed or received by type {PushedFromLocalPlasma, "
-             "PushedFromLocalDisk, Received}.",
+             "PushedFromLocalDisk, Received, RestoredFromLocalDisk}.",
              ("Type"),
              (),
              ray::stats::GAUGE);
@@ -162,12 +172,14 @@ DEFINE_stats(object_manager_received_chunks,
 /// Pull Manager
 DEFINE_stats(
     pull_manager_usage_bytes,
-    "The total number of bytes usage broken per type {Available, BeingPulled, Pinned}",
+    "The total number of bytes usage broken per type {Available, BeingPulled, Pinned, "
+    "BeingPrefetched}",
     ("Type"),
     (),
     ray::stats::GAUGE);
 DEFINE_stats(pull_manager_requested_bundles,
-             "Number of requested bundles broken per type {Get, Wait, TaskArgs}.",
+             "Number of requested bundles broken per type {Get, Wait, TaskArgs, "
+             "Prefetch}.",
              ("Type"),
              (),
              ray::stats::GAUGE);
@@ -225,6 +237,13 @@ DEFINE_stats(scheduler_unscheduleable_tasks,
              ("Reason"),
              (),
              ray::stats::GAUGE);
+DEFINE_stats(scheduler_prefetched_task_args,
+             "Number of prefetched arguments of queued tasks broken per result {Hit, "
+             "Miss, Unused}. An argument is a hit if it was local by the time the task "
+             "was queued on this node.",
+             ("Result"),
+             (),
+             ray::stats::GAUGE);
 DEFINE_stats(scheduler_failed_worker_startup_total,
              "Number of tasks that fail to be scheduled because workers were not "
              "available. Labels are broken per reason {JobConfigMissing, "
@@ -255,6 +274,42 @@ DEFINE_stats(spill_manager_throughput_mb,
              ("Type"),
              (),
              ray::stats::GAUGE);
+DEFINE_stats(spill_manager_file_bytes,
+             "Byte size of local spill files broken per state {Live, Dead, Reclaimed}.",
+             ("State"),
+             (),
+             ray::stats::GAUGE);
+DEFINE_stats(spill_manager_file_utilization,
+             "Fraction of the bytes in local spill files that belong to live objects.",
+             (),
+             (),
+             ray::stats::GAUGE);
+
+/// Object Store
+DEFINE_stats(object_store_create_request_wait_time_ms,
+             "Time from a request to create an object in the object store to its reply, "
+             "by priority class {TaskReturn, Put, RestoredObject, PulledObject}.",
+             ("Priority"),
+             ({1, 10, 100, 1000, 10000}),
+             ray::stats::HISTOGRAM);
+DEFINE_stats(object_store_compaction_bytes_moved,
+             "Bytes of objects moved by the compaction of the object store memory.",
+             (),
+             (),
+             ray::stats::COUNT);
+DEFINE_stats(object_store_largest_free_extent_bytes,
+             "Size of the largest object that fits in the object store memory, by phase "
+             "{BeforeCompaction, AfterCompaction} of the last compaction that moved "
+             "objects.",
+             ("Phase"),
+             (),
+             ray::stats::GAUGE);
+DEFINE_stats(object_store_fallback_tier_move_time_ms,
+             "Time to move an object between the object store memory and its fallback "
+             "tier, by operation {Demote, Promote}.",
+             ("Operation"),
+             ({1, 10, 100, 1000, 10000}),
+             ray::stats::HISTOGRAM);
 
 /// GCS Storage
 DEFINE_stats(gcs_storage_operation_latency_ms,
@@ -267,6 +322,16 @@ DEFINE_stats(gcs_storage_operation_count,
              ("Operation"),
              (),
              ray::stats::COUNT);
+DEFINE_stats(gcs_storage_write_batch_latency_ms,
+             "Time from buffering a write to Gcs storage to the write being flushed",
+             ("Table"),
+             ({0.1, 1, 10, 100, 1000, 10000}, ),
+             ray::stats::HISTOGRAM);
+DEFINE_stats(gcs_storage_write_merged_count,
+             "Number of writes to Gcs storage merged into a buffered write",
+             ("Table"),
+             (),
+             ray::stats::COUNT);
 
 /// Placement Group
 // The end to end placement group creation latency.
@@ -45,6 +45,9 @@ namespace stats {
 /// Tasks stats, broken down by state.
 DECLARE_stats(tasks);
 
+/// Lineage of finished tasks kept by the owner, broken down by location.
+DECLARE_stats(owner_lineage_bytes);
+
 /// Actor stats, broken down by state.
 DECLARE_stats(actors);
 
@@ -86,6 +89,7 @@ DECLARE_stats(push_manager_chunks);
 DECLARE_stats(scheduler_failed_worker_startup_total);
 DECLARE_stats(scheduler_tasks);
 DECLARE_stats(scheduler_unscheduleable_tasks);
+DECLARE_stats(scheduler_prefetched_task_args);
 
 /// Raylet Resource Manager
 DECLARE_stats(resources);
@@ -96,10 +100,14 @@ DECLARE_stats(spill_manager_objects);
 DECLARE_stats(spill_manager_objects_bytes);
 DECLARE_stats(spill_manager_request_total);
 DECLARE_stats(spill_manager_throughput_mb);
+DECLARE_stats(spill_manager_file_bytes);
+DECLARE_stats(spill_manager_file_utilization);
 
 /// GCS Storage
 DECLARE_stats(gcs_storage_operation_latency_ms);
 DECLARE_stats(gcs_storage_operation_count);
+DECLARE_stats(gcs_storage_write_batch_latency_ms);
+DECLARE_stats(gcs_storage_write_merged_count);
 DECLARE_stats(gcs_task_manager_task_events_dropped);
 DECLARE_stats(gcs_task_manager_task_events_stored);
 DECLARE_stats(gcs_task_manager_task_events_stored_bytes);
@@ -107,6 +115,10 @@ DECLARE_stats(gcs_task_manager_task_events_reported);
 
 /// Object Store
 DECLARE_stats(object_store_memory);
+DECLARE_stats(object_store_create_request_wait_time_ms);
+DECLARE_stats(object_store_compaction_bytes_moved);
+DECLARE_stats(object_store_largest_free_extent_bytes);
+DECLARE_stats(object_store_fallback_tier_move_time_ms);
 
 /// Placement Group
 DECLARE_stats(gcs_placement_group_creation_latency_ms);
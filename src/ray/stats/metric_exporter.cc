@@ -16,9 +16,26 @@
 
 #include <future>
 
+#include "absl/container/flat_hash_map.h"
+
 namespace ray {
 namespace stats {
 
+namespace {
+
+/// The tags of a bound metric, including the global tags.
+std::unordered_map<std::string, std::string> GetBoundMetricTags(
+    const BoundMetricData &data) {
+  std::unordered_map<std::string, std::string> tags(data.tags.begin(),
+                                                    data.tags.end());
+  for (const auto &[key, value] : StatsConfig::instance().GetGlobalTags()) {
+    tags[key.name()] = value;
+  }
+  return tags;
+}
+
+}  // namespace
+
 template <>
 void MetricPointExporter::ExportToPoints(
     const opencensus::stats::ViewData::DataMap<opencensus::stats::Distribution>
@@ -103,6 +120,36 @@ void MetricPointExporter::ExportViewData(
       break;
     }
   }
+
+  // The values recorded through bound metrics aren't in the views.
+  for (const auto &data : BoundMetric::Collect()) {
+    const auto &metric_name = data.measure_descriptor->name();
+    auto tags = GetBoundMetricTags(data);
+    if (data.type == HISTOGRAM) {
+      // Same as the views, a histogram is exported as its mean, max and min.
+      points.push_back(MetricPoint{metric_name + ".mean",
+                                   current_sys_time_ms(),
+                                   data.sum / data.count,
+                                   tags,
+                                   *data.measure_descriptor});
+      points.push_back(MetricPoint{metric_name + ".max",
+                                   current_sys_time_ms(),
+                                   data.max,
+                                   tags,
+                                   *data.measure_descriptor});
+      points.push_back(MetricPoint{metric_name + ".min",
+                                   current_sys_time_ms(),
+                                   data.min,
+                                   tags,
+                                   *data.measure_descriptor});
+    } else {
+      points.push_back(MetricPoint{metric_name,
+                                   current_sys_time_ms(),
+                                   data.value,
+                                   std::move(tags),
+                                   *data.measure_descriptor});
+    }
+  }
   metric_exporter_client_->ReportMetrics(points);
 }
 
@@ -123,6 +170,52 @@ void OpenCensusProtoExporter::ExportViewData(
   rpc::ReportOCMetricsRequest request_proto;
   request_proto.set_worker_id(worker_id_.Binary());
 
+  // The values recorded through bound metrics aren't in the views. They're added to
+  // the metric of their view, or to a new metric if the view isn't exported.
+  absl::flat_hash_map<std::string, std::vector<BoundMetricData>> bound_metrics;
+  for (auto &bound_data : BoundMetric::Collect()) {
+    bound_metrics[bound_data.measure_descriptor->name()].push_back(
+        std::move(bound_data));
+  }
+  auto add_bound_timeseries = [](auto *metric_proto,
+                                 const BoundMetricData &bound_data,
+                                 const std::vector<std::string> &label_keys) {
+    auto tags = GetBoundMetricTags(bound_data);
+    auto metric_timeseries_proto = metric_proto->add_timeseries();
+    metric_timeseries_proto->mutable_start_timestamp()->set_seconds(
+        absl::ToUnixSeconds(bound_data.start_time));
+    for (const auto &key : label_keys) {
+      metric_timeseries_proto->add_label_values()->set_value(tags[key]);
+    }
+    auto point_proto = metric_timeseries_proto->add_points();
+    point_proto->mutable_timestamp()->set_seconds(absl::ToUnixSeconds(absl::Now()));
+    switch (bound_data.type) {
+    case COUNT:
+      point_proto->set_int64_value(static_cast<int64_t>(bound_data.value));
+      break;
+    case HISTOGRAM: {
+      auto distribution_proto = point_proto->mutable_distribution_value();
+      distribution_proto->set_count(bound_data.count);
+      distribution_proto->set_sum(bound_data.sum);
+      distribution_proto->set_sum_of_squared_deviation(std::max(
+          bound_data.sum_of_squares - bound_data.sum * bound_data.sum / bound_data.count,
+          0.0));
+      auto bucket_opt_proto =
+          distribution_proto->mutable_bucket_options()->mutable_explicit_();
+      for (const auto &bound : bound_data.boundaries) {
+        bucket_opt_proto->add_bounds(bound);
+      }
+      for (const auto &count : bound_data.bucket_counts) {
+        distribution_proto->add_buckets()->set_count(count);
+      }
+      break;
+    }
+    default:
+      point_proto->set_double_value(bound_data.value);
+      break;
+    }
+  };
+
   for (const auto &datum : data) {
     // Unpack the fields we need for in memory data structure.
     auto &view_descriptor = datum.first;
@@ -200,6 +293,40 @@ void OpenCensusProtoExporter::ExportViewData(
       RAY_LOG(FATAL) << "Unknown view data type.";
       break;
     }
+
+    auto bound_it = bound_metrics.find(measure_descriptor.name());
+    if (bound_it != bound_metrics.end()) {
+      std::vector<std::string> label_keys;
+      for (const auto &tag_key : view_descriptor.columns()) {
+        label_keys.push_back(tag_key.name());
+      }
+      for (const auto &bound_data : bound_it->second) {
+        add_bound_timeseries(request_point_proto, bound_data, label_keys);
+      }
+      bound_metrics.erase(bound_it);
+    }
+  }
+
+  for (const auto &[name, bound_data_list] : bound_metrics) {
+    const auto &measure_descriptor = *bound_data_list.front().measure_descriptor;
+    auto request_point_proto = request_proto.add_metrics();
+    auto metric_descriptor_proto = request_point_proto->mutable_metric_descriptor();
+    metric_descriptor_proto->set_name(measure_descriptor.name());
+    metric_descriptor_proto->set_description(measure_descriptor.description());
+    metric_descriptor_proto->set_unit(measure_descriptor.units());
+    std::vector<std::string> label_keys;
+    for (const auto &[key, value] : StatsConfig::instance().GetGlobalTags()) {
+      label_keys.push_back(key.name());
+    }
+    for (const auto &[key, value] : bound_data_list.front().tags) {
+      label_keys.push_back(key);
+    }
+    for (const auto &key : label_keys) {
+      metric_descriptor_proto->add_label_keys()->set_key(key);
+    }
+    for (const auto &bound_data : bound_data_list) {
+      add_bound_timeseries(request_point_proto, bound_data, label_keys);
+    }
   }
 
   client_->ReportOCMetrics(
@@ -0,0 +1,168 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/async_log_sink.h"
+
+#include <chrono>
+#include <string>
+
+namespace ray {
+
+namespace {
+
+/// How long the writer thread waits for messages, and a blocked thread for room in
+/// the queue, before checking the queue again. This bounds the delay if the wake-up
+/// is missed.
+constexpr std::chrono::milliseconds kWriterWaitTimeout(10);
+
+}  // namespace
+
+AsyncLogSink::AsyncLogSink(std::vector<spdlog::sink_ptr> sinks,
+                           size_t queue_size,
+                           AsyncLogOverflowPolicy overflow_policy)
+    : sinks_(std::move(sinks)),
+      overflow_policy_(overflow_policy),
+      queue_(queue_size),
+      writer_thread_([this]() { WriterLoop(); }) {}
+
+AsyncLogSink::~AsyncLogSink() {
+  stopped_ = true;
+  WakeUpWriter();
+  writer_thread_.join();
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg &msg) {
+  spdlog::details::log_msg_buffer buffer(msg);
+  if (!queue_.TryPush(std::move(buffer))) {
+    if (overflow_policy_ == AsyncLogOverflowPolicy::DROP) {
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    // Wait for the writer thread to pop a message.
+    num_space_waiters_++;
+    std::unique_lock<std::mutex> lock(mutex_);
+    writer_cv_.notify_one();
+    while (!queue_.TryPush(std::move(buffer))) {
+      space_cv_.wait_for(lock, kWriterWaitTimeout);
+    }
+    num_space_waiters_--;
+    return;
+  }
+  if (writer_waiting_.load(std::memory_order_acquire)) {
+    WakeUpWriter();
+  }
+}
+
+void AsyncLogSink::flush() {
+  if (std::this_thread::get_id() != writer_thread_.get_id()) {
+    // Wait for the messages that were queued before this call. This is skipped on
+    // the writer thread, e.g. when a sink fails and the failure is logged.
+    const size_t num_pushed = queue_.NumPushed();
+    num_flush_waiters_++;
+    WakeUpWriter();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      flush_cv_.wait(lock, [this, num_pushed]() {
+        return num_written_.load() >= num_pushed || stopped_.load();
+      });
+    }
+    num_flush_waiters_--;
+  }
+  for (const auto &sink : sinks_) {
+    sink->flush();
+  }
+}
+
+void AsyncLogSink::set_pattern(const std::string &pattern) {
+  for (const auto &sink : sinks_) {
+    sink->set_pattern(pattern);
+  }
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+  for (const auto &sink : sinks_) {
+    sink->set_formatter(sink_formatter->clone());
+  }
+}
+
+void AsyncLogSink::WriterLoop() {
+  spdlog::details::log_msg_buffer buffer;
+  while (true) {
+    bool wrote = false;
+    while (queue_.TryPop(&buffer)) {
+      if (num_space_waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        space_cv_.notify_all();
+      }
+      Write(buffer);
+      num_written_.fetch_add(1);
+      wrote = true;
+    }
+    ReportDropped();
+    if (wrote) {
+      // The messages used to be flushed one by one on the caller thread. Flush once
+      // per batch instead so that they still show up in the files promptly.
+      for (const auto &sink : sinks_) {
+        sink->flush();
+      }
+    }
+    if (num_flush_waiters_.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      flush_cv_.notify_all();
+    }
+    if (stopped_.load() && num_written_.load() >= queue_.NumPushed()) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    writer_waiting_.store(true, std::memory_order_release);
+    writer_cv_.wait_for(lock, kWriterWaitTimeout, [this]() {
+      return stopped_.load() || num_written_.load() < queue_.NumPushed();
+    });
+    writer_waiting_.store(false, std::memory_order_relaxed);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_cv_.notify_all();
+  }
+}
+
+void AsyncLogSink::Write(const spdlog::details::log_msg &msg) {
+  for (const auto &sink : sinks_) {
+    if (sink->should_log(msg.level)) {
+      sink->log(msg);
+    }
+  }
+}
+
+void AsyncLogSink::ReportDropped() {
+  const uint64_t num_dropped = num_dropped_.load(std::memory_order_relaxed);
+  if (num_dropped == num_dropped_reported_) {
+    return;
+  }
+  const std::string text =
+      "Dropped " + std::to_string(num_dropped - num_dropped_reported_) +
+      " log messages because the async log queue is full.";
+  num_dropped_reported_ = num_dropped;
+  spdlog::details::log_msg msg(
+      spdlog::source_loc{}, spdlog::string_view_t{}, spdlog::level::warn, text);
+  Write(msg);
+}
+
+void AsyncLogSink::WakeUpWriter() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  writer_cv_.notify_one();
+}
+
+}  // namespace ray
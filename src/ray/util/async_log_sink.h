@@ -0,0 +1,187 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spdlog/details/log_msg_buffer.h"
+#include "spdlog/sinks/sink.h"
+
+namespace ray {
+
+/// A bounded multi-producer single-consumer queue. Pushing and popping are lock-free.
+/// See http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue.
+template <typename T>
+class BoundedMpscQueue {
+ public:
+  /// \param capacity The maximum number of items in the queue. It's rounded up to a
+  /// power of 2.
+  explicit BoundedMpscQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    slots_ = std::vector<Slot>(size);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /// Push an item. This can be called from any thread.
+  ///
+  /// \return Whether the item was pushed. `value` is only moved from if it was
+  /// pushed, i.e. if the queue wasn't full.
+  bool TryPush(T &&value) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+      slot = &slots_[pos & mask_];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The slot still holds an item from the previous lap, so the queue is full.
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(value);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pop an item. This must only be called from the consumer thread.
+  ///
+  /// \return Whether an item was popped.
+  bool TryPop(T *value) {
+    Slot &slot = slots_[dequeue_pos_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+      return false;
+    }
+    *value = std::move(slot.value);
+    slot.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+    dequeue_pos_++;
+    return true;
+  }
+
+  /// The number of items that were pushed so far, including the ones that were
+  /// popped.
+  size_t NumPushed() const { return enqueue_pos_.load(std::memory_order_relaxed); }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::vector<Slot> slots_;
+  size_t mask_;
+  /// Keep the positions on separate cache lines, since they are written by different
+  /// threads.
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) size_t dequeue_pos_ = 0;
+};
+
+/// What to do when a log message is written while the queue is full.
+enum class AsyncLogOverflowPolicy {
+  /// Drop the message. The number of dropped messages is logged later.
+  DROP,
+  /// Wait for the writer thread to make room in the queue.
+  BLOCK,
+};
+
+/// A spdlog sink that hands the log messages over to a dedicated writer thread, which
+/// writes them to the wrapped sinks. This keeps the file I/O off the threads that
+/// log, e.g. the event loop threads.
+class AsyncLogSink final : public spdlog::sinks::sink {
+ public:
+  /// \param sinks The sinks to write the messages to. Each sink only gets the
+  /// messages that pass its own level.
+  /// \param queue_size The maximum number of messages waiting to be written.
+  /// \param overflow_policy What to do when the queue is full.
+  AsyncLogSink(std::vector<spdlog::sink_ptr> sinks,
+               size_t queue_size,
+               AsyncLogOverflowPolicy overflow_policy);
+
+  /// Write the messages that are still queued and stop the writer thread.
+  ~AsyncLogSink() override;
+
+  /// Queue a message. The message is copied, so this doesn't wait for the write.
+  void log(const spdlog::details::log_msg &msg) override;
+
+  /// Wait for the messages queued so far to be written, and flush the sinks.
+  void flush() override;
+
+  void set_pattern(const std::string &pattern) override;
+
+  void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+  /// The number of messages dropped because the queue was full.
+  uint64_t NumDropped() const { return num_dropped_.load(std::memory_order_relaxed); }
+
+  /// The sinks that the messages are written to.
+  const std::vector<spdlog::sink_ptr> &Sinks() const { return sinks_; }
+
+ private:
+  void WriterLoop();
+
+  /// Write a message to the wrapped sinks.
+  void Write(const spdlog::details::log_msg &msg);
+
+  /// Write the dropped messages that weren't reported yet, if any.
+  void ReportDropped();
+
+  /// Wake up the writer thread if it's waiting for messages.
+  void WakeUpWriter();
+
+  const std::vector<spdlog::sink_ptr> sinks_;
+  const AsyncLogOverflowPolicy overflow_policy_;
+  BoundedMpscQueue<spdlog::details::log_msg_buffer> queue_;
+
+  std::atomic<uint64_t> num_dropped_{0};
+  /// Only accessed by the writer thread.
+  uint64_t num_dropped_reported_ = 0;
+
+  /// The number of messages written so far.
+  std::atomic<size_t> num_written_{0};
+
+  /// Used to wake up the writer thread, the threads waiting in flush(), and the
+  /// threads waiting for room in the queue with the BLOCK policy.
+  std::mutex mutex_;
+  std::condition_variable writer_cv_;
+  std::condition_variable flush_cv_;
+  std::condition_variable space_cv_;
+  std::atomic<bool> writer_waiting_{false};
+  std::atomic<int> num_flush_waiters_{0};
+  std::atomic<int> num_space_waiters_{0};
+  std::atomic<bool> stopped_{false};
+
+  std::thread writer_thread_;
+};
+
+}  // namespace ray
@@ -0,0 +1,280 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/async_log_sink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "ray/util/filesystem.h"
+#include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/ostream_sink.h"
+#include "spdlog/spdlog.h"
+
+namespace ray {
+
+namespace {
+
+/// A sink that blocks the writes until it's released.
+class BlockingSink : public spdlog::sinks::base_sink<std::mutex> {
+ public:
+  void Release() {
+    std::lock_guard<std::mutex> lock(release_mutex_);
+    released_ = true;
+    release_cv_.notify_all();
+  }
+
+  size_t NumLogged() const { return num_logged_; }
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg &msg) override {
+    std::unique_lock<std::mutex> lock(release_mutex_);
+    release_cv_.wait(lock, [this]() { return released_; });
+    num_logged_++;
+  }
+
+  void flush_() override {}
+
+ private:
+  std::mutex release_mutex_;
+  std::condition_variable release_cv_;
+  bool released_ = false;
+  std::atomic<size_t> num_logged_{0};
+};
+
+std::vector<std::string> SplitLines(const std::string &str) {
+  std::vector<std::string> lines;
+  std::istringstream stream(str);
+  std::string line;
+  while (std::getline(stream, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+}  // namespace
+
+TEST(BoundedMpscQueueTest, TestPushAndPop) {
+  BoundedMpscQueue<int> queue(3);
+  ASSERT_EQ(queue.Capacity(), 4);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(queue.TryPush(int(i)));
+  }
+  ASSERT_FALSE(queue.TryPush(4));
+  int value;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(queue.TryPop(&value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(queue.TryPop(&value));
+  ASSERT_TRUE(queue.TryPush(5));
+  ASSERT_TRUE(queue.TryPop(&value));
+  ASSERT_EQ(value, 5);
+  ASSERT_EQ(queue.NumPushed(), 5);
+}
+
+TEST(BoundedMpscQueueTest, TestMultipleProducers) {
+  const int kNumProducers = 4;
+  const int kNumItems = 10000;
+  BoundedMpscQueue<int> queue(64);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kNumItems; i++) {
+        while (!queue.TryPush(p * kNumItems + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  // The items of each producer are popped in order.
+  std::vector<int> next(kNumProducers, 0);
+  int value;
+  for (int i = 0; i < kNumProducers * kNumItems;) {
+    if (!queue.TryPop(&value)) {
+      continue;
+    }
+    int producer = value / kNumItems;
+    ASSERT_EQ(value % kNumItems, next[producer]++);
+    i++;
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  ASSERT_FALSE(queue.TryPop(&value));
+}
+
+TEST(AsyncLogSinkTest, TestWriteInOrder) {
+  std::ostringstream output;
+  auto ostream_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(output);
+  ostream_sink->set_pattern("%v");
+  auto sink = std::make_shared<AsyncLogSink>(
+      std::vector<spdlog::sink_ptr>{ostream_sink}, 16, AsyncLogOverflowPolicy::BLOCK);
+  spdlog::logger logger("async_log_sink_test", sink);
+  logger.set_pattern("%v");
+  for (int i = 0; i < 1000; i++) {
+    logger.info("message {}", i);
+  }
+  logger.flush();
+
+  auto lines = SplitLines(output.str());
+  ASSERT_EQ(lines.size(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(lines[i], "message " + std::to_string(i));
+  }
+  ASSERT_EQ(sink->NumDropped(), 0);
+}
+
+TEST(AsyncLogSinkTest, TestSinkLevel) {
+  std::ostringstream output;
+  auto ostream_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(output);
+  ostream_sink->set_level(spdlog::level::err);
+  auto sink = std::make_shared<AsyncLogSink>(
+      std::vector<spdlog::sink_ptr>{ostream_sink}, 16, AsyncLogOverflowPolicy::BLOCK);
+  spdlog::logger logger("async_log_sink_test", sink);
+  logger.set_pattern("%v");
+  logger.info("info");
+  logger.error("error");
+  logger.flush();
+  ASSERT_EQ(output.str(), "error\n");
+}
+
+TEST(AsyncLogSinkTest, TestDropWhenFull) {
+  auto blocking_sink = std::make_shared<BlockingSink>();
+  std::ostringstream output;
+  auto ostream_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(output);
+  auto sink = std::make_shared<AsyncLogSink>(
+      std::vector<spdlog::sink_ptr>{blocking_sink, ostream_sink},
+      4,
+      AsyncLogOverflowPolicy::DROP);
+  spdlog::logger logger("async_log_sink_test", sink);
+  logger.set_pattern("%v");
+  // The writer thread is stuck on the first message, so at most 4 more fit in the
+  // queue.
+  for (int i = 0; i < 100; i++) {
+    logger.info("message {}", i);
+  }
+  ASSERT_GE(sink->NumDropped(), 95);
+  blocking_sink->Release();
+  logger.flush();
+  // The report of the dropped messages is written too.
+  ASSERT_EQ(blocking_sink->NumLogged() + sink->NumDropped(), 101);
+  ASSERT_NE(output.str().find("Dropped " + std::to_string(sink->NumDropped()) +
+                              " log messages"),
+            std::string::npos);
+}
+
+TEST(AsyncLogSinkTest, TestBlockWhenFull) {
+  auto blocking_sink = std::make_shared<BlockingSink>();
+  auto sink = std::make_shared<AsyncLogSink>(
+      std::vector<spdlog::sink_ptr>{blocking_sink}, 4, AsyncLogOverflowPolicy::BLOCK);
+  spdlog::logger logger("async_log_sink_test", sink);
+  std::thread releaser([&blocking_sink]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    blocking_sink->Release();
+  });
+  for (int i = 0; i < 100; i++) {
+    logger.info("message {}", i);
+  }
+  logger.flush();
+  releaser.join();
+  ASSERT_EQ(blocking_sink->NumLogged(), 100);
+  ASSERT_EQ(sink->NumDropped(), 0);
+}
+
+TEST(AsyncLogSinkTest, TestWriteQueuedMessagesOnDestruction) {
+  std::ostringstream output;
+  auto ostream_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(output);
+  {
+    auto sink = std::make_shared<AsyncLogSink>(
+        std::vector<spdlog::sink_ptr>{ostream_sink}, 1024, AsyncLogOverflowPolicy::BLOCK);
+    spdlog::logger logger("async_log_sink_test", sink);
+    logger.set_pattern("%v");
+    for (int i = 0; i < 100; i++) {
+      logger.info("message {}", i);
+    }
+  }
+  ASSERT_EQ(SplitLines(output.str()).size(), 100);
+}
+
+// Compare the log calls per second and the latency seen by the callers, when several
+// threads log to a file synchronously and through the async sink.
+TEST(AsyncLogSinkTest, LogLatencyBenchmark) {
+  const int kNumThreads = 4;
+  const int kNumLogsPerThread = 100000;
+  const std::string log_path =
+      JoinPaths(GetUserTempDir(), "async_log_sink_benchmark_" + std::to_string(getpid()));
+
+  for (bool async : {false, true}) {
+    auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(
+        log_path, /*truncate=*/true);
+    spdlog::sink_ptr sink = file_sink;
+    if (async) {
+      sink = std::make_shared<AsyncLogSink>(std::vector<spdlog::sink_ptr>{file_sink},
+                                            8192,
+                                            AsyncLogOverflowPolicy::BLOCK);
+    }
+    spdlog::logger logger("async_log_sink_benchmark", sink);
+
+    std::vector<std::vector<int64_t>> latencies_ns(kNumThreads);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&logger, &latencies_ns, async, t]() {
+        latencies_ns[t].reserve(kNumLogsPerThread);
+        for (int i = 0; i < kNumLogsPerThread; i++) {
+          auto log_start = std::chrono::steady_clock::now();
+          logger.info("Failed to spill object {} of task {}, retrying.", i, t);
+          // The RAY_LOG messages used to be flushed one by one.
+          if (!async) {
+            logger.flush();
+          }
+          latencies_ns[t].push_back(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - log_start)
+                  .count());
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                   start)
+                         .count();
+    logger.flush();
+
+    std::vector<int64_t> all_latencies_ns;
+    for (const auto &latencies : latencies_ns) {
+      all_latencies_ns.insert(all_latencies_ns.end(), latencies.begin(), latencies.end());
+    }
+    std::sort(all_latencies_ns.begin(), all_latencies_ns.end());
+    std::cout << (async ? "async" : "sync") << ": "
+              << kNumThreads * kNumLogsPerThread / elapsed_s << " logs/s, p50 "
+              << all_latencies_ns[all_latencies_ns.size() / 2] << "ns, p99 "
+              << all_latencies_ns[all_latencies_ns.size() * 99 / 100] << "ns, max "
+              << all_latencies_ns.back() << "ns" << std::endl;
+  }
+  std::remove(log_path.c_str());
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
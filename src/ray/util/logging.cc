@@ -29,11 +29,13 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #include "absl/debugging/failure_signal_handler.h"
 #include "absl/debugging/stacktrace.h"
 #include "absl/debugging/symbolize.h"
+#include "ray/util/async_log_sink.h"
 #include "ray/util/event_label.h"
 #include "ray/util/filesystem.h"
 #include "spdlog/sinks/basic_file_sink.h"
@@ -55,6 +57,12 @@ long RayLog::log_rotation_file_num_ = 10;
 bool RayLog::is_failure_signal_handler_installed_ = false;
 std::atomic<bool> RayLog::initialized_ = false;
 
+/// The sink that writes the logs on a dedicated thread, if async logging is enabled.
+/// Guarded by async_log_sink_mutex.
+static std::shared_ptr<AsyncLogSink> async_log_sink = nullptr;
+static std::mutex async_log_sink_mutex;
+static std::atomic<bool> async_logging_enabled = false;
+
 std::ostream &operator<<(std::ostream &os, const StackTrace &stack_trace) {
   static constexpr int MAX_NUM_FRAMES = 64;
   char buf[16 * 1024];
@@ -163,7 +171,12 @@ class SpdLogMessage final {
     // NOTE(lingxuan.zlx): See more fmt by visiting https://github.com/fmtlib/fmt.
     logger->log(
         static_cast<spdlog::level::level_enum>(loglevel_), /*fmt*/ "{}", str_.str());
-    logger->flush();
+    // With async logging, the writer thread flushes the logs. Only wait for it if the
+    // process is about to crash.
+    if (!async_logging_enabled ||
+        loglevel_ == static_cast<int>(spdlog::level::critical)) {
+      logger->flush();
+    }
   }
 
   ~SpdLogMessage() { Flush(); }
@@ -304,6 +317,44 @@ void RayLog::StartRayLog(const std::string &app_name,
   err_sink->set_level(spdlog::level::err);
   sinks.push_back(err_sink);
 
+  // Write the logs on a dedicated thread if RAY_BACKEND_LOG_ASYNC is set, so that
+  // logging doesn't block the callers on file I/O.
+  bool async_logging = false;
+  if (const char *async_value = std::getenv("RAY_BACKEND_LOG_ASYNC")) {
+    std::string data = async_value;
+    std::transform(data.begin(), data.end(), data.begin(), ::tolower);
+    async_logging = data == "1" || data == "true";
+  }
+  if (async_logging) {
+    size_t queue_size = 8192;
+    if (std::getenv("RAY_BACKEND_LOG_ASYNC_QUEUE_SIZE")) {
+      long size = std::atol(std::getenv("RAY_BACKEND_LOG_ASYNC_QUEUE_SIZE"));
+      if (size > 0) {
+        queue_size = size;
+      }
+    }
+    auto overflow_policy = AsyncLogOverflowPolicy::BLOCK;
+    if (const char *policy_value = std::getenv("RAY_BACKEND_LOG_ASYNC_OVERFLOW_POLICY")) {
+      std::string data = policy_value;
+      std::transform(data.begin(), data.end(), data.begin(), ::tolower);
+      if (data == "drop") {
+        overflow_policy = AsyncLogOverflowPolicy::DROP;
+      } else if (data != "block") {
+        RAY_LOG(WARNING) << "Unrecognized setting of "
+                         << "RAY_BACKEND_LOG_ASYNC_OVERFLOW_POLICY=" << policy_value;
+      }
+    }
+    auto sink =
+        std::make_shared<AsyncLogSink>(std::move(sinks), queue_size, overflow_policy);
+    sinks = {sink};
+    std::lock_guard<std::mutex> lock(async_log_sink_mutex);
+    async_log_sink = std::move(sink);
+  } else {
+    std::lock_guard<std::mutex> lock(async_log_sink_mutex);
+    async_log_sink = nullptr;
+  }
+  async_logging_enabled = async_logging;
+
   // Set the combined logger.
   auto logger = std::make_shared<spdlog::logger>(
       RayLog::GetLoggerName(), sinks.begin(), sinks.end());
@@ -348,6 +399,23 @@ void RayLog::ShutDownRayLog() {
   if (spdlog::default_logger()) {
     spdlog::default_logger()->flush();
   }
+  std::shared_ptr<AsyncLogSink> sink;
+  {
+    std::lock_guard<std::mutex> lock(async_log_sink_mutex);
+    sink = std::move(async_log_sink);
+    async_log_sink = nullptr;
+  }
+  if (sink) {
+    // Log to the wrapped sinks directly from now on. The writer thread writes the
+    // messages that are still queued and stops once the async sink is released.
+    const auto &sinks = sink->Sinks();
+    auto logger = std::make_shared<spdlog::logger>(
+        RayLog::GetLoggerName(), sinks.begin(), sinks.end());
+    logger->set_level(static_cast<spdlog::level::level_enum>(severity_threshold_));
+    logger->set_pattern(log_format_pattern_);
+    spdlog::set_default_logger(logger);
+    async_logging_enabled = false;
+  }
   // NOTE(lingxuan.zlx) All loggers will be closed in shutdown but we don't need drop
   // console logger out because of some console logging might be used after shutdown ray
   // log. spdlog::shutdown();
@@ -401,6 +469,11 @@ std::string RayLog::GetLogFormatPattern() { return log_format_pattern_; }
 
 std::string RayLog::GetLoggerName() { return logger_name_; }
 
+uint64_t RayLog::NumDroppedLogMessages() {
+  std::lock_guard<std::mutex> lock(async_log_sink_mutex);
+  return async_log_sink ? async_log_sink->NumDropped() : 0;
+}
+
 void RayLog::AddFatalLogCallbacks(
     const std::vector<FatalLogCallback> &expose_log_callbacks) {
   fatal_log_callbacks_.insert(fatal_log_callbacks_.end(),
@@ -255,6 +255,11 @@ class RayLog : public RayLogBase {
 
   /// The init function of ray log for a program which should be called only once.
   ///
+  /// If the environment variable RAY_BACKEND_LOG_ASYNC is set to 1, the logs are
+  /// written by a dedicated thread. RAY_BACKEND_LOG_ASYNC_QUEUE_SIZE sets how many
+  /// logs can wait to be written, and RAY_BACKEND_LOG_ASYNC_OVERFLOW_POLICY sets
+  /// whether to "block" (default) or "drop" the logs when the queue is full.
+  ///
   /// \parem appName The app name which starts the log.
   /// \param severity_threshold Logging threshold for the program.
   /// \param logDir Logging output file name. If empty, the log won't output to file.
@@ -303,6 +308,9 @@ class RayLog : public RayLogBase {
 
   static std::string GetLoggerName();
 
+  /// Return the number of logs dropped because the async log queue was full.
+  static uint64_t NumDroppedLogMessages();
+
   /// Add callback functions that will be triggered to expose fatal log.
   static void AddFatalLogCallbacks(
       const std::vector<FatalLogCallback> &expose_log_callbacks);
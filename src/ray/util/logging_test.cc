@@ -21,7 +21,9 @@
 #include "absl/strings/str_format.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "ray/util/async_log_sink.h"
 #include "ray/util/filesystem.h"
+#include "spdlog/spdlog.h"
 
 using namespace testing;
 
@@ -195,6 +197,29 @@ TEST(PrintLogTest, LogTestWithInit) {
   RayLog::ShutDownRayLog();
 }
 
+#ifndef _WIN32
+TEST(PrintLogTest, TestAsyncLogShutdown) {
+  setenv("RAY_BACKEND_LOG_ASYNC", "1", /*overwrite=*/1);
+  RayLog::StartRayLog("", RayLogLevel::DEBUG, ray::GetUserTempDir());
+  unsetenv("RAY_BACKEND_LOG_ASYNC");
+  auto has_async_sink = []() {
+    for (const auto &sink : spdlog::get(RayLog::GetLoggerName())->sinks()) {
+      if (std::dynamic_pointer_cast<AsyncLogSink>(sink)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  ASSERT_TRUE(has_async_sink());
+  PrintLog();
+  RayLog::ShutDownRayLog();
+  // The writer thread is stopped, and the logs go to the wrapped sinks directly.
+  ASSERT_FALSE(has_async_sink());
+  ASSERT_EQ(RayLog::NumDroppedLogMessages(), 0);
+  RAY_LOG(INFO) << "This is logged after the shutdown.";
+}
+#endif
+
 // This test will output large amount of logs to stderr, should be disabled in travis.
 TEST(LogPerfTest, PerfTest) {
   RayLog::StartRayLog(
@@ -22,8 +22,10 @@
 #include <Winternl.h>
 #include <process.h>
 #else
+#include <fcntl.h>
 #include <poll.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stddef.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -97,6 +99,59 @@ class ProcessFD {
   intptr_t GetFD() const;
   pid_t GetId() const;
 
+#ifndef _WIN32
+  // posix_spawnp() doesn't copy the page tables of the parent like fork() does, which
+  // is slow and stalls the parent when it has a large RSS. glibc implements it with
+  // clone(CLONE_VM | CLONE_VFORK), and reports exec failures as errors. Returns -1 for
+  // the PID on failure.
+  static ProcessFD posix_spawnvpe(const char *argv[],
+                                  std::error_code &ec,
+                                  char **envp) {
+    int pipefds[2];  // Create pipe to track lifetime
+    if (pipe(pipefds) == -1) {
+      ec = std::error_code(errno, std::system_category());
+      return ProcessFD(-1, -1);
+    }
+    // The child only keeps the write end of the pipe, which closes when it exits.
+    // Mark the read end close-on-exec so that other spawned processes don't hold it.
+    fcntl(pipefds[0], F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    posix_spawn_file_actions_addclose(&file_actions, pipefds[0]);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    // Reset the SIGCHLD handler like the fork() path does.
+    sigset_t default_signals;
+    sigemptyset(&default_signals);
+    sigaddset(&default_signals, SIGCHLD);
+    posix_spawnattr_setsigdefault(&attr, &default_signals);
+    short flags = POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_USEVFORK
+    flags |= POSIX_SPAWN_USEVFORK;
+#endif
+    posix_spawnattr_setflags(&attr, flags);
+
+    pid_t pid;
+    int result = posix_spawnp(&pid,
+                              argv[0],
+                              &file_actions,
+                              &attr,
+                              const_cast<char *const *>(argv),
+                              envp);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&file_actions);
+    close(pipefds[1]);
+    if (result != 0) {
+      ec = std::error_code(result, std::system_category());
+      close(pipefds[0]);
+      return ProcessFD(-1, -1);
+    }
+    // Use pipe to track process lifetime. (The pipe closes when process terminates.)
+    return ProcessFD(pid, pipefds[0]);
+  }
+#endif
+
   // Fork + exec combo. Returns -1 for the PID on failure.
   static ProcessFD spawnvpe(const char *argv[],
                             std::error_code &ec,
@@ -168,8 +223,10 @@ class ProcessFD {
     new_env_ptrs.push_back(static_cast<char *>(NULL));
     char **envp = &new_env_ptrs[0];
 
-    // TODO(mehrdadn): Use clone() on Linux or posix_spawnp() on Mac to avoid duplicating
-    // file descriptors into the child process, as that can be problematic.
+    if (!decouple) {
+      return posix_spawnvpe(argv, ec, envp);
+    }
+    // Decoupled processes need a double fork, which posix_spawn() can't do.
     int pipefds[2];  // Create pipe to get PID & track lifetime
     if (pipe(pipefds) == -1) {
       pipefds[0] = pipefds[1] = -1;
@@ -0,0 +1,131 @@
+// Copyright 2023 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/process.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace {
+
+Process Spawn(std::vector<const char *> argv,
+              std::error_code &ec,
+              const ProcessEnvironment &env = {}) {
+  argv.push_back(NULL);
+  return Process(argv.data(), nullptr, ec, /*decouple=*/false, env);
+}
+
+}  // namespace
+
+TEST(ProcessTest, TestSpawnAndWait) {
+  std::error_code ec;
+  auto proc = Spawn({"true"}, ec);
+  ASSERT_FALSE(ec) << ec.message();
+  ASSERT_GT(proc.GetId(), 0);
+  ASSERT_EQ(proc.Wait(), 0);
+
+  // Wait() only waits for the lifetime pipe of the child to close, it doesn't reap
+  // the child, so get its exit status with waitpid().
+  proc = Spawn({"false"}, ec);
+  ASSERT_FALSE(ec) << ec.message();
+  ASSERT_EQ(proc.Wait(), 0);
+  int status;
+  ASSERT_EQ(waitpid(proc.GetId(), &status, 0), proc.GetId());
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_NE(WEXITSTATUS(status), 0);
+}
+
+TEST(ProcessTest, TestSpawnNonexistentBinary) {
+  std::error_code ec;
+  auto proc = Spawn({"/nonexistent/ray_process_test_binary"}, ec);
+  ASSERT_TRUE(ec);
+  ASSERT_FALSE(proc.IsValid());
+}
+
+TEST(ProcessTest, TestSpawnWithEnv) {
+  std::error_code ec;
+  auto proc = Spawn({"sh", "-c", "test \"$RAY_PROCESS_TEST\" = bar"},
+                    ec,
+                    {{"RAY_PROCESS_TEST", "bar"}});
+  ASSERT_FALSE(ec) << ec.message();
+  ASSERT_EQ(proc.Wait(), 0);
+}
+
+TEST(ProcessTest, TestIsAlive) {
+  std::error_code ec;
+  auto proc = Spawn({"sleep", "1000"}, ec);
+  ASSERT_FALSE(ec) << ec.message();
+  ASSERT_TRUE(proc.IsAlive());
+  proc.Kill();
+  proc.Wait();
+  ASSERT_FALSE(proc.IsAlive());
+}
+
+// Compare the spawn latency with a fork() + exec() baseline as the RSS of the parent
+// grows. The cost of fork() grows with the RSS because it copies the page tables.
+TEST(ProcessTest, SpawnLatencyBenchmark) {
+  const int kNumSpawns = 20;
+  for (size_t rss_mb : {0, 128, 512}) {
+    const size_t size = rss_mb << 20;
+    std::unique_ptr<char[]> memory(new char[size]);
+    // Touch the memory so that it's resident.
+    memset(memory.get(), 1, size);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kNumSpawns; i++) {
+      std::error_code ec;
+      auto proc = Spawn({"true"}, ec);
+      ASSERT_FALSE(ec) << ec.message();
+      proc.Wait();
+    }
+    auto spawn_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count() /
+                    kNumSpawns;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kNumSpawns; i++) {
+      pid_t pid = fork();
+      if (pid == 0) {
+        execlp("true", "true", NULL);
+        _exit(1);
+      }
+      ASSERT_GT(pid, 0);
+      int status;
+      waitpid(pid, &status, 0);
+    }
+    auto fork_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count() /
+                   kNumSpawns;
+    RAY_LOG(INFO) << "RSS " << rss_mb << "MB: spawn " << spawn_us << "us, fork+exec "
+                  << fork_us << "us";
+  }
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}